@@ -799,4 +799,16 @@ bool MessageLoopForIO::WatchFileDescriptor(int fd,
       delegate);
 }
 
+bool MessageLoopForIO::WatchFileDescriptorEdgeTriggered(
+    int fd,
+    Mode mode,
+    FileDescriptorWatcher* controller,
+    Watcher* delegate) {
+  return pump_libevent()->WatchFileDescriptorEdgeTriggered(
+      fd,
+      static_cast<base::MessagePumpLibevent::Mode>(mode),
+      controller,
+      delegate);
+}
+
 #endif
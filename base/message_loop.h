@@ -653,6 +653,20 @@ class BASE_EXPORT MessageLoopForIO : public MessageLoop {
                            FileDescriptorWatcher* controller,
                            Watcher* delegate);
 
+  // Please see MessagePumpLibevent for definition.
+  bool WatchFileDescriptorEdgeTriggered(int fd,
+                                        Mode mode,
+                                        FileDescriptorWatcher* controller,
+                                        Watcher* delegate);
+
+  // True if a WatchFileDescriptorEdgeTriggered() watch is only notified
+  // again once the fd becomes ready anew, so it can be kept across reads and
+  // writes instead of being stopped and re-armed.  See
+  // MessagePumpLibevent::BACKEND_EPOLL.
+  bool WatchesAreEdgeTriggered() {
+    return pump_io()->backend() == base::MessagePumpLibevent::BACKEND_EPOLL;
+  }
+
  private:
   base::MessagePumpLibevent* pump_io() {
     return static_cast<base::MessagePumpLibevent*>(pump_.get());
@@ -6,6 +6,13 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <string.h>
+#if defined(OS_LINUX)
+#include <sys/epoll.h>
+#endif
+
+#include <algorithm>
+#include <vector>
 
 #include "base/auto_reset.h"
 #include "base/compiler_specific.h"
@@ -16,6 +23,7 @@
 #endif
 #include "base/memory/scoped_ptr.h"
 #include "base/observer_list.h"
+#include "base/stl_util.h"
 #include "base/time.h"
 #if defined(USE_SYSTEM_LIBEVENT)
 #include <event.h>
@@ -47,6 +55,33 @@
 
 namespace base {
 
+namespace {
+
+MessagePumpLibevent::Backend g_default_backend =
+    MessagePumpLibevent::BACKEND_LIBEVENT;
+
+#if defined(OS_LINUX)
+// The most events taken from the kernel per epoll_wait().
+const int kMaxEpollEvents = 64;
+
+// An fd whose watchers are all edge-triggered is registered for both
+// directions for as long as one is attached; which watchers hear about an
+// edge is decided in userspace.
+const uint32 kEpollEdgeTriggeredInterest =
+    EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+#endif
+
+}  // namespace
+
+// The watchers attached to one fd under the epoll backend.
+struct MessagePumpLibevent::EpollFd {
+  EpollFd() : events(0) {}
+
+  std::vector<FileDescriptorWatcher*> watchers;
+  // What the fd is registered for; 0 if nothing (or not registered).
+  uint32 events;
+};
+
 // Return 0 on success
 // Too small a function to bother putting in a library?
 static int SetNonBlocking(int fd) {
@@ -59,6 +94,9 @@ static int SetNonBlocking(int fd) {
 MessagePumpLibevent::FileDescriptorWatcher::FileDescriptorWatcher()
     : is_persistent_(false),
       event_(NULL),
+      epoll_watched_fd_(-1),
+      epoll_mode_(0),
+      epoll_edge_triggered_(false),
       pump_(NULL),
       watcher_(NULL),
       ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
@@ -68,9 +106,20 @@ MessagePumpLibevent::FileDescriptorWatcher::~FileDescriptorWatcher() {
   if (event_) {
     StopWatchingFileDescriptor();
   }
+  if (epoll_watched_fd_ != -1 && pump_)
+    pump_->DetachEpollWatcher(this);
 }
 
 bool MessagePumpLibevent::FileDescriptorWatcher::StopWatchingFileDescriptor() {
+  if (epoll_watched_fd_ != -1) {
+    // Stay attached, so that watching this fd again can reuse its epoll
+    // registration.  Only a level-triggered registration needs changing.
+    epoll_mode_ = 0;
+    watcher_ = NULL;
+    pump_->UpdateEpollInterest(epoll_watched_fd_, false);
+    return true;
+  }
+
   event* e = ReleaseEvent();
   if (e == NULL)
     return true;
@@ -92,6 +141,19 @@ void MessagePumpLibevent::FileDescriptorWatcher::Init(event *e,
   event_ = e;
 }
 
+void MessagePumpLibevent::FileDescriptorWatcher::InitEpoll(
+    int fd,
+    int mode,
+    bool is_persistent,
+    bool edge_triggered) {
+  DCHECK(!event_);
+  DCHECK(epoll_watched_fd_ == -1 || epoll_watched_fd_ == fd);
+  epoll_watched_fd_ = fd;
+  epoll_mode_ = mode;
+  is_persistent_ = is_persistent;
+  epoll_edge_triggered_ = edge_triggered;
+}
+
 event *MessagePumpLibevent::FileDescriptorWatcher::ReleaseEvent() {
   struct event *e = event_;
   event_ = NULL;
@@ -121,18 +183,59 @@ MessagePumpLibevent::MessagePumpLibevent()
     : keep_running_(true),
       in_run_(false),
       processed_io_events_(false),
-      event_base_(event_base_new()),
+      event_base_(NULL),
       wakeup_pipe_in_(-1),
-      wakeup_pipe_out_(-1) {
-  if (!Init())
+      wakeup_pipe_out_(-1),
+      wakeup_event_(NULL),
+#if defined(OS_LINUX)
+      backend_(g_default_backend),
+#else
+      backend_(BACKEND_LIBEVENT),
+#endif
+      epoll_fd_(-1) {
+  if (backend_ == BACKEND_EPOLL ? !InitEpoll() : !Init())
+     NOTREACHED();
+}
+
+MessagePumpLibevent::MessagePumpLibevent(Backend backend)
+    : keep_running_(true),
+      in_run_(false),
+      processed_io_events_(false),
+      event_base_(NULL),
+      wakeup_pipe_in_(-1),
+      wakeup_pipe_out_(-1),
+      wakeup_event_(NULL),
+#if defined(OS_LINUX)
+      backend_(backend),
+#else
+      backend_(BACKEND_LIBEVENT),
+#endif
+      epoll_fd_(-1) {
+  if (backend_ == BACKEND_EPOLL ? !InitEpoll() : !Init())
      NOTREACHED();
 }
 
 MessagePumpLibevent::~MessagePumpLibevent() {
-  DCHECK(wakeup_event_);
-  DCHECK(event_base_);
-  event_del(wakeup_event_);
-  delete wakeup_event_;
+  if (backend_ == BACKEND_EPOLL) {
+    // Watchers that outlive the pump must not call back into it.
+    for (EpollFdMap::iterator it = epoll_fds_.begin();
+         it != epoll_fds_.end(); ++it) {
+      std::vector<FileDescriptorWatcher*>& watchers = it->second->watchers;
+      for (size_t i = 0; i < watchers.size(); ++i) {
+        watchers[i]->epoll_watched_fd_ = -1;
+        watchers[i]->epoll_mode_ = 0;
+        watchers[i]->pump_ = NULL;
+      }
+    }
+    STLDeleteValues(&epoll_fds_);
+    if (epoll_fd_ >= 0 && HANDLE_EINTR(close(epoll_fd_)) < 0)
+      DPLOG(ERROR) << "close";
+  } else {
+    DCHECK(wakeup_event_);
+    DCHECK(event_base_);
+    event_del(wakeup_event_);
+    delete wakeup_event_;
+  }
   if (wakeup_pipe_in_ >= 0) {
     if (HANDLE_EINTR(close(wakeup_pipe_in_)) < 0)
       DPLOG(ERROR) << "close";
@@ -141,7 +244,13 @@ MessagePumpLibevent::~MessagePumpLibevent() {
     if (HANDLE_EINTR(close(wakeup_pipe_out_)) < 0)
       DPLOG(ERROR) << "close";
   }
-  event_base_free(event_base_);
+  if (event_base_)
+    event_base_free(event_base_);
+}
+
+// static
+void MessagePumpLibevent::SetDefaultBackend(Backend backend) {
+  g_default_backend = backend;
 }
 
 bool MessagePumpLibevent::WatchFileDescriptor(int fd,
@@ -157,6 +266,11 @@ bool MessagePumpLibevent::WatchFileDescriptor(int fd,
   // threadsafe, and your watcher may never be registered.
   DCHECK(watch_file_descriptor_caller_checker_.CalledOnValidThread());
 
+  if (backend_ == BACKEND_EPOLL) {
+    return WatchFileDescriptorEpoll(fd, persistent, mode, controller, delegate,
+                                    false);
+  }
+
   int event_mask = persistent ? EV_PERSIST : 0;
   if ((mode & WATCH_READ) != 0) {
     event_mask |= EV_READ;
@@ -210,6 +324,22 @@ bool MessagePumpLibevent::WatchFileDescriptor(int fd,
   return true;
 }
 
+bool MessagePumpLibevent::WatchFileDescriptorEdgeTriggered(
+    int fd,
+    Mode mode,
+    FileDescriptorWatcher* controller,
+    Watcher* delegate) {
+  if (backend_ != BACKEND_EPOLL)
+    return WatchFileDescriptor(fd, true, mode, controller, delegate);
+
+  DCHECK_GE(fd, 0);
+  DCHECK(controller);
+  DCHECK(delegate);
+  DCHECK(mode == WATCH_READ || mode == WATCH_WRITE || mode == WATCH_READ_WRITE);
+  DCHECK(watch_file_descriptor_caller_checker_.CalledOnValidThread());
+  return WatchFileDescriptorEpoll(fd, true, mode, controller, delegate, true);
+}
+
 void MessagePumpLibevent::AddIOObserver(IOObserver *obs) {
   io_observers_.AddObserver(obs);
 }
@@ -229,6 +359,12 @@ void MessagePumpLibevent::Run(Delegate* delegate) {
   DCHECK(keep_running_) << "Quit must have been called outside of Run!";
   AutoReset<bool> auto_reset_in_run(&in_run_, true);
 
+  if (backend_ == BACKEND_EPOLL) {
+    RunEpoll(delegate);
+    keep_running_ = true;
+    return;
+  }
+
   // event_base_loopexit() + EVLOOP_ONCE is leaky, see http://crbug.com/25641.
   // Instead, make our own timer and reuse it on each call to event_base_loop().
   scoped_ptr<event> timer_event(new event);
@@ -320,6 +456,7 @@ void MessagePumpLibevent::DidProcessIOEvent() {
 }
 
 bool MessagePumpLibevent::Init() {
+  event_base_ = event_base_new();
   int fds[2];
   if (pipe(fds)) {
     DLOG(ERROR) << "pipe() failed, errno: " << errno;
@@ -382,4 +519,343 @@ void MessagePumpLibevent::OnWakeup(int socket, short flags, void* context) {
   event_base_loopbreak(that->event_base_);
 }
 
+#if defined(OS_LINUX)
+
+bool MessagePumpLibevent::InitEpoll() {
+  epoll_fd_ = epoll_create(kMaxEpollEvents);
+  if (epoll_fd_ < 0) {
+    DPLOG(ERROR) << "epoll_create";
+    return false;
+  }
+  if (fcntl(epoll_fd_, F_SETFD, FD_CLOEXEC) != 0)
+    DPLOG(ERROR) << "fcntl(FD_CLOEXEC)";
+
+  int fds[2];
+  if (pipe(fds)) {
+    DLOG(ERROR) << "pipe() failed, errno: " << errno;
+    return false;
+  }
+  if (SetNonBlocking(fds[0])) {
+    DLOG(ERROR) << "SetNonBlocking for pipe fd[0] failed, errno: " << errno;
+    return false;
+  }
+  if (SetNonBlocking(fds[1])) {
+    DLOG(ERROR) << "SetNonBlocking for pipe fd[1] failed, errno: " << errno;
+    return false;
+  }
+  wakeup_pipe_out_ = fds[0];
+  wakeup_pipe_in_ = fds[1];
+
+  // The wakeup pipe is level-triggered and drained when it fires.
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = wakeup_pipe_out_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_pipe_out_, &ev) != 0) {
+    DPLOG(ERROR) << "epoll_ctl";
+    return false;
+  }
+  return true;
+}
+
+bool MessagePumpLibevent::WatchFileDescriptorEpoll(
+    int fd,
+    bool persistent,
+    Mode mode,
+    FileDescriptorWatcher* controller,
+    Watcher* delegate,
+    bool edge_triggered) {
+  if (controller->epoll_watched_fd_ != -1 &&
+      (controller->epoll_watched_fd_ != fd || controller->pump_ != this)) {
+    // It's illegal to listen on 2 separate fds with the same |controller|
+    // at once, but a stopped controller may move on to another fd.
+    if (controller->epoll_mode_ != 0) {
+      NOTREACHED() << "FDs don't match" << controller->epoll_watched_fd_
+                   << "!=" << fd;
+      return false;
+    }
+    controller->pump_->DetachEpollWatcher(controller);
+  }
+
+  int combined_mode = mode;
+  if (controller->epoll_mode_ != 0) {
+    // Like libevent, watching again is cumulative.
+    combined_mode |= controller->epoll_mode_;
+    persistent |= controller->is_persistent_;
+    edge_triggered &= controller->epoll_edge_triggered_;
+  }
+
+  EpollFd*& entry = epoll_fds_[fd];
+  if (!entry)
+    entry = new EpollFd;
+
+  bool armed = false;
+  for (size_t i = 0; i < entry->watchers.size(); ++i)
+    armed |= entry->watchers[i]->epoll_mode_ != 0;
+
+  if (std::find(entry->watchers.begin(), entry->watchers.end(), controller) ==
+      entry->watchers.end()) {
+    entry->watchers.push_back(controller);
+  }
+  controller->InitEpoll(fd, combined_mode, persistent, edge_triggered);
+  controller->set_watcher(delegate);
+  controller->set_pump(this);
+
+  if (!UpdateEpollInterest(fd, !armed)) {
+    // As with libevent, a failed cumulative watch aborts the earlier one.
+    DetachEpollWatcher(controller);
+    return false;
+  }
+  return true;
+}
+
+void MessagePumpLibevent::DetachEpollWatcher(
+    FileDescriptorWatcher* controller) {
+  int fd = controller->epoll_watched_fd_;
+  controller->epoll_watched_fd_ = -1;
+  controller->epoll_mode_ = 0;
+  controller->epoll_edge_triggered_ = false;
+  controller->watcher_ = NULL;
+  controller->pump_ = NULL;
+
+  EpollFdMap::iterator it = epoll_fds_.find(fd);
+  if (it == epoll_fds_.end())
+    return;
+  std::vector<FileDescriptorWatcher*>& watchers = it->second->watchers;
+  watchers.erase(std::remove(watchers.begin(), watchers.end(), controller),
+                 watchers.end());
+  if (!watchers.empty()) {
+    UpdateEpollInterest(fd, false);
+    return;
+  }
+
+  delete it->second;
+  epoll_fds_.erase(it);
+  // The fd may already be closed, which removed it from the epoll set.
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, &ev);
+}
+
+bool MessagePumpLibevent::UpdateEpollInterest(int fd, bool rearmed) {
+  EpollFdMap::iterator it = epoll_fds_.find(fd);
+  if (it == epoll_fds_.end())
+    return true;
+  EpollFd* entry = it->second;
+
+  bool armed = false;
+  bool edge_triggered = true;
+  uint32 level_triggered_events = 0;
+  for (size_t i = 0; i < entry->watchers.size(); ++i) {
+    FileDescriptorWatcher* watcher = entry->watchers[i];
+    if (watcher->epoll_mode_ == 0)
+      continue;
+    armed = true;
+    edge_triggered &= watcher->epoll_edge_triggered_;
+    if (watcher->epoll_mode_ & WATCH_READ)
+      level_triggered_events |= EPOLLIN | EPOLLRDHUP;
+    if (watcher->epoll_mode_ & WATCH_WRITE)
+      level_triggered_events |= EPOLLOUT;
+  }
+
+  uint32 events;
+  if (!armed) {
+    // An edge-triggered registration is kept for the next watch to reuse;
+    // a level-triggered one would keep reporting what nobody waits for.
+    events = (entry->events & EPOLLET) ? entry->events : 0;
+  } else {
+    events = edge_triggered ? kEpollEdgeTriggeredInterest
+                            : level_triggered_events;
+  }
+
+  // Nothing was listening on an edge-triggered fd, so it may have been
+  // closed and its number reused since it was registered, and edges may
+  // have been ignored.  EPOLL_CTL_MOD both checks the registration and
+  // re-reports current readiness.
+  if (events == entry->events && !(rearmed && (events & EPOLLET)))
+    return true;
+
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = events;
+  ev.data.fd = fd;
+  if (events == 0) {
+    // Hangups and errors are reported whatever the interest, so drop the
+    // registration instead of emptying it; the fd may well be closed
+    // already.
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, &ev);
+    entry->events = 0;
+    return true;
+  }
+  int rv = epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+  // Only a new (or reused) fd needs EPOLL_CTL_ADD.
+  if (rv != 0 && errno == ENOENT)
+    rv = epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+  if (rv != 0) {
+    DPLOG(ERROR) << "epoll_ctl";
+    entry->events = 0;
+    return false;
+  }
+  entry->events = events;
+  return true;
+}
+
+void MessagePumpLibevent::RunEpoll(Delegate* delegate) {
+  for (;;) {
+    bool did_work = delegate->DoWork();
+    if (!keep_running_)
+      break;
+
+    WaitForEpollEvents(0);
+    did_work |= processed_io_events_;
+    processed_io_events_ = false;
+    if (!keep_running_)
+      break;
+
+    did_work |= delegate->DoDelayedWork(&delayed_work_time_);
+    if (!keep_running_)
+      break;
+
+    if (did_work)
+      continue;
+
+    did_work = delegate->DoIdleWork();
+    if (!keep_running_)
+      break;
+
+    if (did_work)
+      continue;
+
+    if (delayed_work_time_.is_null()) {
+      WaitForEpollEvents(-1);
+    } else {
+      TimeDelta delay = delayed_work_time_ - TimeTicks::Now();
+      if (delay > TimeDelta()) {
+        // Round up, so we don't wake up just before the work is due.
+        int64 timeout_ms = (delay.InMicroseconds() +
+                            Time::kMicrosecondsPerMillisecond - 1) /
+                           Time::kMicrosecondsPerMillisecond;
+        WaitForEpollEvents(static_cast<int>(
+            std::min<int64>(timeout_ms, kint32max)));
+      } else {
+        // It looks like delayed_work_time_ indicates a time in the past, so we
+        // need to call DoDelayedWork now.
+        delayed_work_time_ = TimeTicks();
+      }
+    }
+  }
+}
+
+void MessagePumpLibevent::WaitForEpollEvents(int timeout_ms) {
+  struct epoll_event events[kMaxEpollEvents];
+  int count = HANDLE_EINTR(epoll_wait(epoll_fd_, events, kMaxEpollEvents,
+                                      timeout_ms));
+  if (count < 0) {
+    DPLOG(ERROR) << "epoll_wait";
+    return;
+  }
+  for (int i = 0; i < count; ++i) {
+    int fd = events[i].data.fd;
+    if (fd == wakeup_pipe_out_) {
+      // Drain every wakeup that has accumulated.
+      char buf[64];
+      while (HANDLE_EINTR(read(wakeup_pipe_out_, buf, sizeof(buf))) > 0) {}
+      processed_io_events_ = true;
+      continue;
+    }
+    OnEpollNotification(fd, events[i].events);
+  }
+}
+
+void MessagePumpLibevent::OnEpollNotification(int fd, uint32 events) {
+  EpollFdMap::iterator it = epoll_fds_.find(fd);
+  if (it == epoll_fds_.end())
+    return;
+
+  bool can_write = (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) != 0;
+  bool can_read =
+      (events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) != 0;
+
+  // Callbacks may stop, delete or add watchers for this fd, so pick the
+  // armed ones up front and re-check each before calling it.
+  bool used_one_shot = false;
+  std::vector<WeakPtr<FileDescriptorWatcher> > armed;
+  std::vector<FileDescriptorWatcher*>& watchers = it->second->watchers;
+  for (size_t i = 0; i < watchers.size(); ++i) {
+    if (watchers[i]->epoll_mode_ != 0)
+      armed.push_back(watchers[i]->weak_factory_.GetWeakPtr());
+  }
+
+  for (size_t i = 0; i < armed.size(); ++i) {
+    FileDescriptorWatcher* controller = armed[i].get();
+    if (!controller || controller->epoll_watched_fd_ != fd)
+      continue;
+    int mode = controller->epoll_mode_;
+    bool notify_write = can_write && (mode & WATCH_WRITE);
+    bool notify_read = can_read && (mode & WATCH_READ);
+    if (!notify_write && !notify_read)
+      continue;
+
+    processed_io_events_ = true;
+    // A one-shot watch is used up by its first notification.
+    if (!controller->is_persistent_) {
+      controller->epoll_mode_ = 0;
+      used_one_shot = true;
+    }
+
+    if (notify_write)
+      controller->OnFileCanWriteWithoutBlocking(fd, this);
+    // Check |controller| in case it's been deleted or stopped in
+    // controller->OnFileCanWriteWithoutBlocking().
+    if (notify_read && armed[i].get() && controller->watcher_)
+      controller->OnFileCanReadWithoutBlocking(fd, this);
+  }
+
+  // A level-triggered fd must stop reporting what nobody waits for anymore.
+  if (used_one_shot)
+    UpdateEpollInterest(fd, false);
+}
+
+#else  // defined(OS_LINUX)
+
+bool MessagePumpLibevent::InitEpoll() {
+  NOTREACHED();
+  return false;
+}
+
+bool MessagePumpLibevent::WatchFileDescriptorEpoll(
+    int fd,
+    bool persistent,
+    Mode mode,
+    FileDescriptorWatcher* controller,
+    Watcher* delegate,
+    bool edge_triggered) {
+  NOTREACHED();
+  return false;
+}
+
+void MessagePumpLibevent::DetachEpollWatcher(
+    FileDescriptorWatcher* controller) {
+  NOTREACHED();
+}
+
+bool MessagePumpLibevent::UpdateEpollInterest(int fd, bool rearmed) {
+  NOTREACHED();
+  return false;
+}
+
+void MessagePumpLibevent::RunEpoll(Delegate* delegate) {
+  NOTREACHED();
+}
+
+void MessagePumpLibevent::WaitForEpollEvents(int timeout_ms) {
+  NOTREACHED();
+}
+
+void MessagePumpLibevent::OnEpollNotification(int fd, uint32 events) {
+  NOTREACHED();
+}
+
+#endif  // defined(OS_LINUX)
+
 }  // namespace base
@@ -8,6 +8,7 @@
 
 #include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "base/hash_tables.h"
 #include "base/memory/weak_ptr.h"
 #include "base/message_pump.h"
 #include "base/observer_list.h"
@@ -22,6 +23,19 @@ namespace base {
 
 // Class to monitor sockets and issue callbacks when sockets are ready for I/O
 // TODO(dkegel): add support for background file IO somehow
+//
+// On Linux the pump can instead be driven directly by epoll (BACKEND_EPOLL).
+// The interface is the same.  Watches made with
+// WatchFileDescriptorEdgeTriggered() are edge-triggered there: the file
+// descriptor stays registered with the kernel while any
+// FileDescriptorWatcher is attached to it, so StopWatchingFileDescriptor()
+// costs no syscall and watching again costs at most one, where libevent
+// pays an epoll_ctl() for each.  Such a watcher is only called again once
+// more data arrives (or more buffer space frees up); it must read, write or
+// accept until EAGAIN, or stop watching, before waiting for the next
+// notification.  All other watches are level-triggered, as with libevent,
+// and an fd is only registered edge-triggered while every watcher attached
+// to it asked for that.
 class BASE_EXPORT MessagePumpLibevent : public MessagePump {
  public:
   class IOObserver {
@@ -73,6 +87,9 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump {
     // object.
     void Init(event* e, bool is_persistent);
 
+    // Used by the epoll backend in place of Init().
+    void InitEpoll(int fd, int mode, bool is_persistent, bool edge_triggered);
+
     // Used by MessagePumpLibevent to take ownership of event_.
     event *ReleaseEvent();
 
@@ -86,6 +103,14 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump {
 
     bool is_persistent_;  // false if this event is one-shot.
     event* event_;
+    // With the epoll backend, the fd this watcher is attached to (or -1), and
+    // the WATCH_* directions it currently wants notifications for (0 while
+    // stopped).  It stays attached after StopWatchingFileDescriptor() so the
+    // fd's registration can be reused; see MessagePumpLibevent.
+    int epoll_watched_fd_;
+    int epoll_mode_;
+    // True if the watch was made with WatchFileDescriptorEdgeTriggered().
+    bool epoll_edge_triggered_;
     MessagePumpLibevent* pump_;
     Watcher* watcher_;
     base::WeakPtrFactory<FileDescriptorWatcher> weak_factory_;
@@ -99,9 +124,23 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump {
     WATCH_READ_WRITE = WATCH_READ | WATCH_WRITE
   };
 
+  enum Backend {
+    BACKEND_LIBEVENT,
+    // Only available on Linux; elsewhere it falls back to libevent.
+    BACKEND_EPOLL
+  };
+
   MessagePumpLibevent();
+  explicit MessagePumpLibevent(Backend backend);
   virtual ~MessagePumpLibevent();
 
+  // Selects the backend used by pumps created with the default constructor,
+  // which is how MessageLoopForIO creates them.  Call this before starting
+  // the IO threads.
+  static void SetDefaultBackend(Backend backend);
+
+  Backend backend() const { return backend_; }
+
   // Have the current thread's message loop watch for a a situation in which
   // reading/writing to the FD can be performed without blocking.
   // Callers must provide a preallocated FileDescriptorWatcher object which
@@ -120,6 +159,16 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump {
                            FileDescriptorWatcher *controller,
                            Watcher *delegate);
 
+  // Like a persistent WatchFileDescriptor(), for a |delegate| that reads,
+  // writes or accepts until EAGAIN each time it is notified, or stops
+  // watching.  With BACKEND_EPOLL the watch is edge-triggered (see above),
+  // so it may also be left armed while the caller has nothing to do; with
+  // libevent it is an ordinary persistent watch.
+  bool WatchFileDescriptorEdgeTriggered(int fd,
+                                        Mode mode,
+                                        FileDescriptorWatcher* controller,
+                                        Watcher* delegate);
+
   void AddIOObserver(IOObserver* obs);
   void RemoveIOObserver(IOObserver* obs);
 
@@ -138,6 +187,31 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump {
   // Risky part of constructor.  Returns true on success.
   bool Init();
 
+  // The epoll backend.  All registrations for one fd share an EpollFd.
+  struct EpollFd;
+  typedef hash_map<int, EpollFd*> EpollFdMap;
+
+  bool InitEpoll();
+  void RunEpoll(Delegate* delegate);
+  bool WatchFileDescriptorEpoll(int fd,
+                                bool persistent,
+                                Mode mode,
+                                FileDescriptorWatcher* controller,
+                                Watcher* delegate,
+                                bool edge_triggered);
+  // Detaches |controller| from its fd, dropping the fd's registration when
+  // it was the last watcher attached.
+  void DetachEpollWatcher(FileDescriptorWatcher* controller);
+  // Brings |fd|'s registration in line with the watchers attached to it.
+  // |rearmed| is true when a watcher was just armed on an fd none was armed
+  // on, which an edge-triggered registration must re-check.  Returns false
+  // if epoll_ctl() fails.
+  bool UpdateEpollInterest(int fd, bool rearmed);
+  // Waits up to |timeout_ms| (-1 for ever) and dispatches what is ready.
+  void WaitForEpollEvents(int timeout_ms);
+  // Delivers |events| (EPOLL* bits) to the watchers armed on |fd|.
+  void OnEpollNotification(int fd, uint32 events);
+
   // Called by libevent to tell us a registered FD can be read/written to.
   static void OnLibeventNotification(int fd, short flags,
                                      void* context);
@@ -169,6 +243,11 @@ class BASE_EXPORT MessagePumpLibevent : public MessagePump {
   // ... libevent wrapper for read end
   event* wakeup_event_;
 
+  const Backend backend_;
+  // The epoll set, or -1 when using libevent.
+  int epoll_fd_;
+  EpollFdMap epoll_fds_;
+
   ObserverList<IOObserver> io_observers_;
   ThreadChecker watch_file_descriptor_caller_checker_;
   DISALLOW_COPY_AND_ASSIGN(MessagePumpLibevent);
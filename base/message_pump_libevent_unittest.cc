@@ -5,6 +5,9 @@
 #include "base/message_pump_libevent.h"
 
 #include <unistd.h>
+#if defined(OS_LINUX)
+#include <sys/epoll.h>
+#endif
 
 #include "base/message_loop.h"
 #include "base/threading/thread.h"
@@ -42,6 +45,17 @@ class MessagePumpLibeventTest : public testing::Test {
     pump->OnLibeventNotification(0, EV_WRITE | EV_READ, controller);
   }
 
+#if defined(OS_LINUX)
+  void OnEpollNotification(MessagePumpLibevent* pump, int fd,
+                           uint32 events) {
+    pump->OnEpollNotification(fd, events);
+  }
+
+  void WaitForEpollEvents(MessagePumpLibevent* pump) {
+    pump->WaitForEpollEvents(0);
+  }
+#endif
+
   MessageLoop ui_loop_;
   Thread io_thread_;
 };
@@ -140,6 +154,192 @@ TEST_F(MessagePumpLibeventTest, StopWatcher) {
   OnLibeventNotification(pump, &watcher);
 }
 
+#if defined(OS_LINUX)
+
+class MessagePumpLibeventEpollTest : public MessagePumpLibeventTest {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    MessagePumpLibeventTest::SetUp();
+    ASSERT_EQ(0, pipe(pipe_fds_));
+    pump_ = new MessagePumpLibevent(MessagePumpLibevent::BACKEND_EPOLL);
+    ASSERT_EQ(MessagePumpLibevent::BACKEND_EPOLL, pump_->backend());
+  }
+
+  virtual void TearDown() OVERRIDE {
+    pump_ = NULL;
+    close(pipe_fds_[0]);
+    close(pipe_fds_[1]);
+  }
+
+  int read_fd() const { return pipe_fds_[0]; }
+  int write_fd() const { return pipe_fds_[1]; }
+
+  scoped_refptr<MessagePumpLibevent> pump_;
+  int pipe_fds_[2];
+};
+
+TEST_F(MessagePumpLibeventEpollTest, DeleteWatcher) {
+  MessagePumpLibevent::FileDescriptorWatcher* watcher =
+      new MessagePumpLibevent::FileDescriptorWatcher;
+  DeleteWatcher delegate(watcher);
+  ASSERT_TRUE(pump_->WatchFileDescriptor(
+      write_fd(), false, MessagePumpLibevent::WATCH_READ_WRITE, watcher,
+      &delegate));
+
+  // Spoof an epoll notification.
+  OnEpollNotification(pump_, write_fd(), EPOLLIN | EPOLLOUT);
+}
+
+TEST_F(MessagePumpLibeventEpollTest, StopWatcher) {
+  MessagePumpLibevent::FileDescriptorWatcher watcher;
+  StopWatcher delegate(&watcher);
+  ASSERT_TRUE(pump_->WatchFileDescriptor(
+      write_fd(), false, MessagePumpLibevent::WATCH_READ_WRITE, &watcher,
+      &delegate));
+
+  // Spoof an epoll notification.
+  OnEpollNotification(pump_, write_fd(), EPOLLIN | EPOLLOUT);
+}
+
+// Counts read notifications, without reading anything.
+class CountingWatcher : public MessagePumpLibevent::Watcher {
+ public:
+  CountingWatcher() : reads_(0) {}
+  virtual ~CountingWatcher() {}
+
+  // base:MessagePumpLibevent::Watcher interface
+  virtual void OnFileCanReadWithoutBlocking(int /* fd */) { ++reads_; }
+  virtual void OnFileCanWriteWithoutBlocking(int /* fd */) {}
+
+  int reads() const { return reads_; }
+
+ private:
+  int reads_;
+};
+
+TEST_F(MessagePumpLibeventEpollTest, EdgeTriggeredRead) {
+  MessagePumpLibevent::FileDescriptorWatcher watcher;
+  CountingWatcher delegate;
+  ASSERT_TRUE(pump_->WatchFileDescriptorEdgeTriggered(
+      read_fd(), MessagePumpLibevent::WATCH_READ, &watcher, &delegate));
+
+  WaitForEpollEvents(pump_);
+  EXPECT_EQ(0, delegate.reads());
+
+  char buf = 0;
+  ASSERT_EQ(1, write(write_fd(), &buf, 1));
+  WaitForEpollEvents(pump_);
+  EXPECT_EQ(1, delegate.reads());
+
+  // Unread data alone does not notify again.
+  WaitForEpollEvents(pump_);
+  EXPECT_EQ(1, delegate.reads());
+
+  // New data does.
+  ASSERT_EQ(1, write(write_fd(), &buf, 1));
+  WaitForEpollEvents(pump_);
+  EXPECT_EQ(2, delegate.reads());
+
+  // Watching again after a stop reports the data still pending.
+  EXPECT_TRUE(watcher.StopWatchingFileDescriptor());
+  ASSERT_TRUE(pump_->WatchFileDescriptorEdgeTriggered(
+      read_fd(), MessagePumpLibevent::WATCH_READ, &watcher, &delegate));
+  WaitForEpollEvents(pump_);
+  EXPECT_EQ(3, delegate.reads());
+}
+
+TEST_F(MessagePumpLibeventEpollTest, LevelTriggeredRead) {
+  MessagePumpLibevent::FileDescriptorWatcher watcher;
+  CountingWatcher delegate;
+  ASSERT_TRUE(pump_->WatchFileDescriptor(
+      read_fd(), true, MessagePumpLibevent::WATCH_READ, &watcher, &delegate));
+
+  char buf = 0;
+  ASSERT_EQ(1, write(write_fd(), &buf, 1));
+  WaitForEpollEvents(pump_);
+  EXPECT_EQ(1, delegate.reads());
+
+  // A watcher that didn't ask for edges hears about unread data again.
+  WaitForEpollEvents(pump_);
+  EXPECT_EQ(2, delegate.reads());
+
+  // Until it stops watching.
+  EXPECT_TRUE(watcher.StopWatchingFileDescriptor());
+  WaitForEpollEvents(pump_);
+  EXPECT_EQ(2, delegate.reads());
+}
+
+TEST_F(MessagePumpLibeventEpollTest, MixedWatchersAreLevelTriggered) {
+  MessagePumpLibevent::FileDescriptorWatcher edge_watcher;
+  MessagePumpLibevent::FileDescriptorWatcher level_watcher;
+  CountingWatcher edge_delegate;
+  CountingWatcher level_delegate;
+  ASSERT_TRUE(pump_->WatchFileDescriptorEdgeTriggered(
+      read_fd(), MessagePumpLibevent::WATCH_READ, &edge_watcher,
+      &edge_delegate));
+  ASSERT_TRUE(pump_->WatchFileDescriptor(
+      read_fd(), true, MessagePumpLibevent::WATCH_READ, &level_watcher,
+      &level_delegate));
+
+  char buf = 0;
+  ASSERT_EQ(1, write(write_fd(), &buf, 1));
+  WaitForEpollEvents(pump_);
+  WaitForEpollEvents(pump_);
+  EXPECT_EQ(2, edge_delegate.reads());
+  EXPECT_EQ(2, level_delegate.reads());
+
+  // Once only the edge-triggered watcher is left, so is the fd.
+  level_watcher.StopWatchingFileDescriptor();
+  WaitForEpollEvents(pump_);
+  WaitForEpollEvents(pump_);
+  EXPECT_EQ(3, edge_delegate.reads());
+  EXPECT_EQ(2, level_delegate.reads());
+}
+
+TEST_F(MessagePumpLibeventEpollTest, OneShotRead) {
+  MessagePumpLibevent::FileDescriptorWatcher watcher;
+  CountingWatcher delegate;
+  ASSERT_TRUE(pump_->WatchFileDescriptor(
+      read_fd(), false, MessagePumpLibevent::WATCH_READ, &watcher, &delegate));
+
+  char buf = 0;
+  ASSERT_EQ(1, write(write_fd(), &buf, 1));
+  WaitForEpollEvents(pump_);
+  EXPECT_EQ(1, delegate.reads());
+
+  ASSERT_EQ(1, write(write_fd(), &buf, 1));
+  WaitForEpollEvents(pump_);
+  EXPECT_EQ(1, delegate.reads());
+}
+
+TEST_F(MessagePumpLibeventEpollTest, SharedFd) {
+  MessagePumpLibevent::FileDescriptorWatcher watcher1;
+  MessagePumpLibevent::FileDescriptorWatcher watcher2;
+  CountingWatcher delegate1;
+  CountingWatcher delegate2;
+  ASSERT_TRUE(pump_->WatchFileDescriptor(
+      read_fd(), true, MessagePumpLibevent::WATCH_READ, &watcher1,
+      &delegate1));
+  ASSERT_TRUE(pump_->WatchFileDescriptor(
+      read_fd(), true, MessagePumpLibevent::WATCH_READ, &watcher2,
+      &delegate2));
+
+  char buf = 0;
+  ASSERT_EQ(1, write(write_fd(), &buf, 1));
+  WaitForEpollEvents(pump_);
+  EXPECT_EQ(1, delegate1.reads());
+  EXPECT_EQ(1, delegate2.reads());
+
+  // Only armed watchers are told.
+  EXPECT_TRUE(watcher1.StopWatchingFileDescriptor());
+  ASSERT_EQ(1, write(write_fd(), &buf, 1));
+  WaitForEpollEvents(pump_);
+  EXPECT_EQ(1, delegate1.reads());
+  EXPECT_EQ(2, delegate2.reads());
+}
+
+#endif  // defined(OS_LINUX)
+
 }  // namespace
 
 }  // namespace base
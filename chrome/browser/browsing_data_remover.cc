@@ -55,6 +55,8 @@
 #include "net/cookies/cookie_store.h"
 #include "net/disk_cache/disk_cache.h"
 #include "net/http/http_cache.h"
+#include "net/http/http_network_session.h"
+#include "net/socket/ssl_session_store.h"
 #include "net/url_request/url_request_context.h"
 #include "net/url_request/url_request_context_getter.h"
 #include "webkit/quota/quota_manager.h"
@@ -358,6 +360,17 @@ void BrowsingDataRemover::RemoveImpl(int remove_mask,
     }
   }
 
+  // SDCH dictionaries are cached content that also records which sites were
+  // visited.  They are shared by all profiles and carry no usable timestamp,
+  // so they are dropped altogether.
+  if ((remove_mask & (REMOVE_COOKIES | REMOVE_CACHE)) &&
+      g_browser_process->io_thread()) {
+    BrowserThread::PostTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&IOThread::ClearSdchDictionaries,
+                   base::Unretained(g_browser_process->io_thread())));
+  }
+
   if (remove_mask & REMOVE_CACHE) {
     // Tell the renderers to clear their cache.
     WebCacheManager::GetInstance()->ClearCache();
@@ -528,6 +541,12 @@ void BrowsingDataRemover::DoClearCache(int rv) {
         net::HttpTransactionFactory* factory =
             getter->GetURLRequestContext()->http_transaction_factory();
 
+        // Saved TLS sessions also record which servers were visited, so they
+        // go with the cache.
+        net::HttpNetworkSession* session = factory->GetSession();
+        if (session && session->params().ssl_session_store)
+          session->params().ssl_session_store->RemoveAllSessions();
+
         rv = factory->GetCache()->GetBackend(
             &cache_, base::Bind(&BrowsingDataRemover::DoClearCache,
                                 base::Unretained(this)));
@@ -105,6 +105,7 @@
 #include "grit/chromium_strings.h"
 #include "grit/generated_resources.h"
 #include "grit/platform_locale_settings.h"
+#include "net/base/bzip2_filter.h"
 #include "net/base/net_module.h"
 #include "net/base/sdch_manager.h"
 #include "net/cookies/cookie_monster.h"
@@ -113,6 +114,7 @@
 #include "net/http/http_stream_factory.h"
 #include "net/socket/client_socket_pool_base.h"
 #include "net/socket/client_socket_pool_manager.h"
+#include "net/socket/transport_client_socket_pool.h"
 #include "net/spdy/spdy_session.h"
 #include "net/spdy/spdy_session_pool.h"
 #include "net/url_request/url_request.h"
@@ -904,6 +906,37 @@ void ChromeBrowserMainParts::ConnectBackupJobsFieldTrial() {
   }
 }
 
+// If --connect-race-stagger-ms is not specified, run an A/B test for racing
+// TCP connects across all of a host's resolved addresses.
+void ChromeBrowserMainParts::ConnectRaceFieldTrial() {
+  if (parsed_command_line().HasSwitch(switches::kConnectRaceStaggerMs)) {
+    int stagger_ms = 0;
+    if (base::StringToInt(parsed_command_line().GetSwitchValueASCII(
+            switches::kConnectRaceStaggerMs), &stagger_ms) &&
+        stagger_ms >= 0) {
+      net::TransportConnectJob::set_connect_race_stagger_ms(stagger_ms);
+    }
+    return;
+  }
+
+  const base::FieldTrial::Probability kConnectRaceDivisor = 100;
+  // 1% probability for each racing group.
+  const base::FieldTrial::Probability kConnectRaceProbability = 1;
+  // After June 30, 2013 builds, it will always be in default group.
+  scoped_refptr<base::FieldTrial> trial(
+      new base::FieldTrial("ConnectRace", kConnectRaceDivisor,
+                           "ConnectRaceDisabled", 2013, 6, 30));
+  const int stagger_50ms = trial->AppendGroup("ConnectRaceStagger50ms",
+                                              kConnectRaceProbability);
+  const int stagger_300ms = trial->AppendGroup("ConnectRaceStagger300ms",
+                                               kConnectRaceProbability);
+  const int trial_group = trial->group();
+  if (trial_group == stagger_50ms)
+    net::TransportConnectJob::set_connect_race_stagger_ms(50);
+  else if (trial_group == stagger_300ms)
+    net::TransportConnectJob::set_connect_race_stagger_ms(300);
+}
+
 void ChromeBrowserMainParts::PredictorFieldTrial() {
   const base::FieldTrial::Probability kDivisor = 1000;
   // For each option (i.e., non-default), we have a fixed probability.
@@ -1046,6 +1079,7 @@ void ChromeBrowserMainParts::SetupFieldTrials(bool metrics_recording_enabled,
   InstantFieldTrial::Activate();
   SpdyFieldTrial();
   ConnectBackupJobsFieldTrial();
+  ConnectRaceFieldTrial();
   WarmConnectionFieldTrial();
   PredictorFieldTrial();
   DefaultAppsFieldTrial();
@@ -1679,6 +1713,9 @@ int ChromeBrowserMainParts::PreMainMessageLoopRunImpl() {
       net::SdchManager::EnableSdchSupport(false);
   }
 
+  if (parsed_command_line().HasSwitch(switches::kEnableBZip2Encoding))
+    net::BZip2Filter::EnableBZip2Support(true);
+
   if (parsed_command_line().HasSwitch(switches::kEnableWatchdog))
     InstallJankometer(parsed_command_line());
 
@@ -113,6 +113,10 @@ class ChromeBrowserMainParts : public content::BrowserMainParts {
   // specified timeout value is reached.
   void ConnectBackupJobsFieldTrial();
 
+  // A/B test for racing TCP connects across all of a host's addresses,
+  // unless --connect-race-stagger-ms is given.
+  void ConnectRaceFieldTrial();
+
   // Field trial to see what disabling DNS pre-resolution does to
   // latency of page loads.
   void PredictorFieldTrial();
@@ -6,6 +6,7 @@
 
 #include "base/bind.h"
 #include "base/bind_helpers.h"
+#include "base/command_line.h"
 #include "base/file_path.h"
 #include "base/file_util.h"
 #include "base/memory/ref_counted.h"
@@ -46,6 +47,7 @@
 #include "chrome/common/url_constants.h"
 #include "chrome/test/base/in_process_browser_test.h"
 #include "chrome/test/base/ui_test_utils.h"
+#include "chrome/test/perf/perf_test.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/download_item.h"
 #include "content/public/browser/download_manager.h"
@@ -55,8 +57,10 @@
 #include "content/public/browser/render_view_host.h"
 #include "content/public/browser/resource_context.h"
 #include "content/public/browser/web_contents.h"
+#include "content/public/common/content_switches.h"
 #include "content/public/common/context_menu_params.h"
 #include "content/public/common/page_transition_types.h"
+#include "content/test/net/url_request_large_body_job.h"
 #include "content/test/net/url_request_mock_http_job.h"
 #include "content/test/net/url_request_slow_download_job.h"
 #include "content/test/test_file_error_injector.h"
@@ -203,6 +207,9 @@ class TestRenderViewContextMenu : public RenderViewContextMenu {
   DISALLOW_COPY_AND_ASSIGN(TestRenderViewContextMenu);
 };
 
+// 32 megabytes, large enough that writing and hashing dominate.
+const int kThroughputDownloadSize = 32 * 1024 * 1024;
+
 }  // namespace
 
 // While an object of this class exists, it will mock out download
@@ -1501,6 +1508,57 @@ IN_PROC_BROWSER_TEST_F(DownloadTest, MultiDownload) {
   ASSERT_TRUE(file_util::ContentsEqual(OriginFile(file), file2));
 }
 
+// Runs several large downloads side by side and reports their combined rate.
+// All of them share the FILE thread, so this is mostly a measure of how much
+// work each write costs it.  Every download must still finish with all of
+// its bytes.
+IN_PROC_BROWSER_TEST_F(DownloadTest, ParallelDownloadThroughput) {
+  const int kDownloads = 4;
+
+  ASSERT_TRUE(InitialSetup(false));
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+                          base::Bind(&URLRequestLargeBodyJob::AddUrlHandler));
+  std::string download_url(
+      URLRequestLargeBodyJob::GetURL(kThroughputDownloadSize, true).spec());
+
+  DownloadManager* download_manager = DownloadManagerForBrowser(browser());
+  WebContents* web_contents = browser()->GetSelectedWebContents();
+  ASSERT_TRUE(web_contents);
+  scoped_ptr<DownloadTestObserver> observer(
+      CreateWaiter(browser(), kDownloads));
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kDownloads; ++i) {
+    content::DownloadSaveInfo save_info;
+    save_info.prompt_for_save_location = false;
+    scoped_refptr<DownloadTestItemCreationObserver> creation_observer(
+        new DownloadTestItemCreationObserver);
+    download_manager->DownloadUrl(
+        GURL(download_url + base::StringPrintf("/download-%d.lib", i)),
+        GURL(""), "", false, -1, save_info, web_contents,
+        creation_observer->callback());
+  }
+  observer->WaitForFinished();
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+  EXPECT_EQ(static_cast<size_t>(kDownloads),
+            observer->NumDownloadsSeenInState(DownloadItem::COMPLETE));
+
+  std::vector<DownloadItem*> downloads;
+  GetDownloads(browser(), &downloads);
+  ASSERT_EQ(static_cast<size_t>(kDownloads), downloads.size());
+  for (size_t i = 0; i < downloads.size(); ++i)
+    EXPECT_EQ(kThroughputDownloadSize, downloads[i]->GetReceivedBytes());
+
+  int64 total_kb = static_cast<int64>(kDownloads) * kThroughputDownloadSize /
+                   1024;
+  perf_test::PrintResult(
+      "download_throughput", "", base::StringPrintf("parallel_%d", kDownloads),
+      static_cast<size_t>(total_kb / elapsed.InSecondsF()), "KB/s", true);
+
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+      base::Bind(&URLRequestLargeBodyJob::RemoveUrlHandler));
+}
+
 IN_PROC_BROWSER_TEST_F(DownloadTest, DownloadCancelled) {
   ASSERT_TRUE(InitialSetup(false));
   EXPECT_EQ(1, browser()->tab_count());
@@ -2532,3 +2590,113 @@ IN_PROC_BROWSER_TEST_F(DownloadTest, TestFileDataBlocker) {
     DownloadManagerForBrowser(browser())->RemoveAllDownloads();
   }
 }
+
+// Runs downloads split into several byte-range requests.
+class ParallelRangeDownloadTest : public DownloadTest {
+ public:
+  virtual void SetUpCommandLine(CommandLine* command_line) OVERRIDE {
+    DownloadTest::SetUpCommandLine(command_line);
+    command_line->AppendSwitchASCII(switches::kParallelDownloadRequests, "4");
+  }
+
+ protected:
+  // Returns how many bytes URLRequestLargeBodyJob has served so far.
+  int64 GetLargeBodyBytesServed() {
+    int64 bytes = 0;
+    BrowserThread::PostTask(
+        BrowserThread::IO, FROM_HERE,
+        base::Bind(&GetLargeBodyBytesServedOnIO, &bytes));
+    MessageLoop::current()->Run();
+    return bytes;
+  }
+
+ private:
+  static void GetLargeBodyBytesServedOnIO(int64* bytes) {
+    *bytes = URLRequestLargeBodyJob::bytes_served();
+    BrowserThread::PostTask(
+        BrowserThread::UI, FROM_HERE, MessageLoop::QuitClosure());
+  }
+};
+
+// The test server answers range requests, so this file is fetched as three
+// ranges (it is under four times the minimum range size) that are written
+// into the file out of order.
+IN_PROC_BROWSER_TEST_F(ParallelRangeDownloadTest, DownloadInRanges) {
+  ASSERT_TRUE(InitialSetup(false));
+  ASSERT_TRUE(test_server()->Start());
+  FilePath file(FILE_PATH_LITERAL("History/HistoryNoSource"));
+  GURL url(test_server()->GetURL("files/History/HistoryNoSource"));
+
+  WebContents* web_contents = browser()->GetSelectedWebContents();
+  ASSERT_TRUE(web_contents);
+
+  ScopedTempDir other_directory;
+  ASSERT_TRUE(other_directory.CreateUniqueTempDir());
+  FilePath target_file_full_path =
+      other_directory.path().Append(file.BaseName());
+  content::DownloadSaveInfo save_info;
+  save_info.file_path = target_file_full_path;
+
+  scoped_ptr<DownloadTestObserver> observer(CreateWaiter(browser(), 1));
+  DownloadManagerForBrowser(browser())->DownloadUrl(
+      url, GURL(""), "", false, -1, save_info, web_contents,
+      DownloadManager::OnStartedCallback());
+  observer->WaitForFinished();
+  EXPECT_EQ(1u, observer->NumDownloadsSeenInState(DownloadItem::COMPLETE));
+
+  ASSERT_TRUE(CheckDownloadFullPaths(browser(),
+                                     target_file_full_path,
+                                     OriginFile(file)));
+}
+
+// Pausing a download that is split into ranges has to stop all of its
+// requests, and resuming it has to restart all of them.  The download is
+// paused as soon as it exists, so the range requests may start either before
+// or after the pause.
+IN_PROC_BROWSER_TEST_F(ParallelRangeDownloadTest, PauseStopsRanges) {
+  // Large enough that the download is nowhere near done when it is paused.
+  const int kDownloadSize = 64 * 1024 * 1024;
+
+  ASSERT_TRUE(InitialSetup(false));
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+                          base::Bind(&URLRequestLargeBodyJob::AddUrlHandler));
+
+  DownloadManager* download_manager = DownloadManagerForBrowser(browser());
+  WebContents* web_contents = browser()->GetSelectedWebContents();
+  ASSERT_TRUE(web_contents);
+  scoped_ptr<DownloadTestObserver> observer(CreateWaiter(browser(), 1));
+  content::DownloadSaveInfo save_info;
+  save_info.prompt_for_save_location = false;
+  scoped_refptr<DownloadTestItemCreationObserver> creation_observer(
+      new DownloadTestItemCreationObserver);
+  download_manager->DownloadUrl(
+      URLRequestLargeBodyJob::GetURL(kDownloadSize, true), GURL(""), "",
+      false, -1, save_info, web_contents, creation_observer->callback());
+  creation_observer->WaitForDownloadItemCreation();
+  ASSERT_TRUE(creation_observer->succeeded());
+  DownloadItem* download = download_manager->GetActiveDownloadItem(
+      creation_observer->download_id().local());
+  ASSERT_TRUE(download);
+
+  download->TogglePause();
+  ASSERT_TRUE(download->IsPaused());
+
+  // The pause reaches the IO thread before this does, and nothing should be
+  // read after it, however long we wait.
+  int64 bytes_at_pause = GetLargeBodyBytesServed();
+  EXPECT_LT(bytes_at_pause, kDownloadSize);
+  MessageLoop::current()->PostDelayedTask(
+      FROM_HERE, MessageLoop::QuitClosure(),
+      base::TimeDelta::FromMilliseconds(500));
+  MessageLoop::current()->Run();
+  EXPECT_EQ(bytes_at_pause, GetLargeBodyBytesServed());
+  EXPECT_EQ(DownloadItem::IN_PROGRESS, download->GetState());
+
+  download->TogglePause();
+  observer->WaitForFinished();
+  EXPECT_EQ(1u, observer->NumDownloadsSeenInState(DownloadItem::COMPLETE));
+  EXPECT_EQ(kDownloadSize, download->GetReceivedBytes());
+
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+      base::Bind(&URLRequestLargeBodyJob::RemoveUrlHandler));
+}
@@ -11,6 +11,7 @@
 #include "base/command_line.h"
 #include "base/debug/leak_tracker.h"
 #include "base/logging.h"
+#include "base/path_service.h"
 #include "base/stl_util.h"
 #include "base/string_number_conversions.h"
 #include "base/string_split.h"
@@ -28,6 +29,8 @@
 #include "chrome/browser/net/proxy_service_factory.h"
 #include "chrome/browser/net/sdch_dictionary_fetcher.h"
 #include "chrome/browser/prefs/pref_service.h"
+#include "chrome/common/chrome_constants.h"
+#include "chrome/common/chrome_paths.h"
 #include "chrome/common/chrome_switches.h"
 #include "chrome/common/pref_names.h"
 #include "content/public/browser/browser_thread.h"
@@ -39,6 +42,7 @@
 #include "net/base/host_resolver.h"
 #include "net/base/mapped_host_resolver.h"
 #include "net/base/net_util.h"
+#include "net/base/sdch_dictionary_file_store.h"
 #include "net/base/sdch_manager.h"
 #include "net/base/server_bound_cert_service.h"
 #include "net/cookies/cookie_monster.h"
@@ -527,6 +531,11 @@ void IOThread::ClearHostCache() {
     host_cache->clear();
 }
 
+void IOThread::ClearSdchDictionaries() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  sdch_manager_->ClearDictionaries();
+}
+
 net::SSLConfigService* IOThread::GetSSLConfigService() {
   return ssl_config_service_manager_->Get();
 }
@@ -601,4 +610,17 @@ void IOThread::InitSystemRequestContextOnIOThread() {
 
   sdch_manager_->set_sdch_fetcher(
       new SdchDictionaryFetcher(system_url_request_context_getter_.get()));
+
+  // Keep fetched dictionaries across restarts, so SDCH works from the first
+  // request of a session instead of after the dictionaries are fetched again.
+  // The manager is shared with incognito profiles, but keeps dictionaries
+  // fetched for their requests out of the store.
+  FilePath user_data_dir;
+  if (PathService::Get(chrome::DIR_USER_DATA, &user_data_dir)) {
+    sdch_manager_->set_sdch_dictionary_store(
+        new net::SdchDictionaryFileStore(
+            user_data_dir.Append(chrome::kSdchDictionariesDirname),
+            BrowserThread::GetMessageLoopProxyForThread(
+                BrowserThread::FILE)));
+  }
 }
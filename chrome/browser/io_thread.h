@@ -116,6 +116,10 @@ class IOThread : public content::BrowserThreadDelegate {
   // called on the IO thread.
   void ClearHostCache();
 
+  // Drops the SDCH dictionaries, in memory and on disk.  Must be called on the
+  // IO thread.
+  void ClearSdchDictionaries();
+
  private:
   // BrowserThreadDelegate implementation, runs on the IO thread.
   // This handles initialization and destruction of state that must
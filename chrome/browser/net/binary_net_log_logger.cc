@@ -0,0 +1,129 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/net/binary_net_log_logger.h"
+
+#include <stdio.h>
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/values.h"
+#include "chrome/browser/ui/webui/net_internals/net_internals_ui.h"
+#include "net/base/binary_net_log.h"
+
+namespace {
+
+// The most entries that may be waiting for the writer thread.  Entries added
+// while the queue is full are dropped.
+const size_t kMaxPendingEntries = 100000;
+
+}  // namespace
+
+BinaryNetLogLogger::Entry::Entry(net::NetLog::EventType type,
+                                 const base::TimeTicks& time,
+                                 const net::NetLog::Source& source,
+                                 net::NetLog::EventPhase phase,
+                                 net::NetLog::EventParameters* params)
+    : type(type),
+      time(time),
+      source(source),
+      phase(phase),
+      params(params) {
+}
+
+BinaryNetLogLogger::Entry::~Entry() {}
+
+BinaryNetLogLogger::BinaryNetLogLogger(const FilePath& log_path)
+    : writer_thread_("Chrome_NetLogWriterThread"),
+      dropped_entries_(0),
+      write_pending_(false) {
+  base::ThreadRestrictions::ScopedAllowIO allow_io;
+  file_.Set(file_util::OpenFile(log_path, "wb"));
+  if (!file_.get()) {
+    LOG(ERROR) << "Unable to create " << log_path.value();
+    return;
+  }
+
+  // As with NetLogLogger, the constants go first so captures can be
+  // converted by builds with different event and source types.
+  scoped_ptr<Value> value(NetInternalsUI::GetConstants());
+  std::string constants_json;
+  base::JSONWriter::Write(value.get(), &constants_json);
+  std::string header;
+  net::BinaryNetLogWriter::AppendHeader(constants_json, &header);
+  fwrite(header.data(), 1, header.size(), file_.get());
+
+  writer_thread_.Start();
+}
+
+BinaryNetLogLogger::~BinaryNetLogLogger() {
+  DCHECK(!net_log());
+  if (!writer_thread_.IsRunning())
+    return;
+  // Stopping the thread runs any WritePendingEntries() task already posted.
+  base::ThreadRestrictions::ScopedAllowIO allow_io;
+  writer_thread_.Stop();
+  WritePendingEntries();
+  if (dropped_entries_ > 0)
+    LOG(WARNING) << "Dropped " << dropped_entries_ << " NetLog entries";
+}
+
+int64 BinaryNetLogLogger::dropped_entries() const {
+  base::AutoLock lock(lock_);
+  return dropped_entries_;
+}
+
+void BinaryNetLogLogger::StartObserving(net::NetLog* net_log) {
+  if (!file_.get())
+    return;
+  net_log->AddThreadSafeObserver(this, net::NetLog::LOG_ALL_BUT_BYTES);
+}
+
+void BinaryNetLogLogger::OnAddEntry(net::NetLog::EventType type,
+                                    const base::TimeTicks& time,
+                                    const net::NetLog::Source& source,
+                                    net::NetLog::EventPhase phase,
+                                    net::NetLog::EventParameters* params) {
+  base::AutoLock lock(lock_);
+  if (pending_entries_.size() >= kMaxPendingEntries) {
+    ++dropped_entries_;
+    return;
+  }
+  pending_entries_.push_back(Entry(type, time, source, phase, params));
+  if (write_pending_)
+    return;
+  write_pending_ = true;
+  writer_thread_.message_loop_proxy()->PostTask(
+      FROM_HERE,
+      base::Bind(&BinaryNetLogLogger::WritePendingEntries,
+                 base::Unretained(this)));
+}
+
+void BinaryNetLogLogger::WritePendingEntries() {
+  std::vector<Entry> entries;
+  {
+    base::AutoLock lock(lock_);
+    entries.swap(pending_entries_);
+    write_pending_ = false;
+  }
+  if (entries.empty())
+    return;
+
+  std::string data;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const Entry& entry = entries[i];
+    std::string params_json;
+    if (entry.params) {
+      scoped_ptr<Value> params(entry.params->ToValue());
+      base::JSONWriter::Write(params.get(), &params_json);
+    }
+    net::BinaryNetLogWriter::AppendEntry(entry.type, entry.time, entry.source,
+                                         entry.phase, params_json, &data);
+  }
+  fwrite(data.data(), 1, data.size(), file_.get());
+}
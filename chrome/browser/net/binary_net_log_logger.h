@@ -0,0 +1,86 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CHROME_BROWSER_NET_BINARY_NET_LOG_LOGGER_H_
+#define CHROME_BROWSER_NET_BINARY_NET_LOG_LOGGER_H_
+#pragma once
+
+#include <vector>
+
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_handle.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread.h"
+#include "base/time.h"
+#include "net/base/net_log.h"
+
+class FilePath;
+
+// BinaryNetLogLogger writes the NetLog event stream to a file in the format
+// described in net/base/binary_net_log.h.  Unlike NetLogLogger, the thread an
+// event occurs on only queues the entry; parameter serialization and file
+// writes happen on a dedicated writer thread, which keeps capture cheap enough
+// to leave on while reproducing timing-sensitive bugs.  Use
+// net_log_converter to turn a capture into a log net-internals can load.
+class BinaryNetLogLogger : public net::NetLog::ThreadSafeObserver {
+ public:
+  // Nothing is logged if |log_path| can't be created.
+  explicit BinaryNetLogLogger(const FilePath& log_path);
+
+  // Writes out any queued entries, and logs how many were dropped.  Must no
+  // longer be observing a NetLog.
+  virtual ~BinaryNetLogLogger();
+
+  // Returns the number of entries dropped so far because too many were
+  // waiting to be written.
+  int64 dropped_entries() const;
+
+  // Starts observing specified NetLog.  Must not already be watching a NetLog.
+  // Separate from constructor to enforce thread safety.
+  void StartObserving(net::NetLog* net_log);
+
+  // net::NetLog::ThreadSafeObserver implementation:
+  virtual void OnAddEntry(net::NetLog::EventType type,
+                          const base::TimeTicks& time,
+                          const net::NetLog::Source& source,
+                          net::NetLog::EventPhase phase,
+                          net::NetLog::EventParameters* params) OVERRIDE;
+
+ private:
+  struct Entry {
+    Entry(net::NetLog::EventType type,
+          const base::TimeTicks& time,
+          const net::NetLog::Source& source,
+          net::NetLog::EventPhase phase,
+          net::NetLog::EventParameters* params);
+    ~Entry();
+
+    net::NetLog::EventType type;
+    base::TimeTicks time;
+    net::NetLog::Source source;
+    net::NetLog::EventPhase phase;
+    scoped_refptr<net::NetLog::EventParameters> params;
+  };
+
+  // Called on |writer_thread_|.  Serializes and writes all queued entries.
+  void WritePendingEntries();
+
+  ScopedStdioHandle file_;
+  base::Thread writer_thread_;
+
+  // Protects |pending_entries_|, |dropped_entries_| and |write_pending_|.
+  mutable base::Lock lock_;
+  // At most kMaxPendingEntries, so that a writer thread that can't keep up
+  // doesn't let the queue grow without bound.
+  std::vector<Entry> pending_entries_;
+  // Entries dropped because the queue was full.
+  int64 dropped_entries_;
+  // True if a WritePendingEntries() task has been posted but hasn't yet
+  // taken the queued entries.
+  bool write_pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryNetLogLogger);
+};
+
+#endif  // CHROME_BROWSER_NET_BINARY_NET_LOG_LOGGER_H_
@@ -4,11 +4,15 @@
 
 #include "chrome/browser/net/chrome_net_log.h"
 
+#include <algorithm>
+
 #include "base/command_line.h"
 #include "base/logging.h"
 #include "base/string_number_conversions.h"
 #include "base/string_util.h"
+#include "base/threading/platform_thread.h"
 #include "base/values.h"
+#include "chrome/browser/net/binary_net_log_logger.h"
 #include "chrome/browser/net/load_timing_observer.h"
 #include "chrome/browser/net/net_log_logger.h"
 #include "chrome/common/chrome_switches.h"
@@ -17,7 +21,12 @@ ChromeNetLog::ChromeNetLog()
     : last_id_(0),
       base_log_level_(LOG_BASIC),
       effective_log_level_(LOG_BASIC),
-      load_timing_observer_(new LoadTimingObserver()) {
+      load_timing_observer_(new LoadTimingObserver()),
+      observers_(reinterpret_cast<base::subtle::AtomicWord>(
+          new ObserverVector())),
+      reader_index_(0) {
+  readers_[0] = 0;
+  readers_[1] = 0;
   const CommandLine* command_line = CommandLine::ForCurrentProcess();
   // Adjust base log level based on command line switch, if present.
   // This is done before adding any observers so the call to UpdateLogLevel when
@@ -40,6 +49,12 @@ ChromeNetLog::ChromeNetLog()
         command_line->GetSwitchValuePath(switches::kLogNetLog)));
     net_log_logger_->StartObserving(this);
   }
+
+  if (command_line->HasSwitch(switches::kLogNetLogBinary)) {
+    binary_net_log_logger_.reset(new BinaryNetLogLogger(
+        command_line->GetSwitchValuePath(switches::kLogNetLogBinary)));
+    binary_net_log_logger_->StartObserving(this);
+  }
 }
 
 ChromeNetLog::~ChromeNetLog() {
@@ -47,6 +62,10 @@ ChromeNetLog::~ChromeNetLog() {
   RemoveThreadSafeObserver(load_timing_observer_.get());
   if (net_log_logger_.get())
     RemoveThreadSafeObserver(net_log_logger_.get());
+  if (binary_net_log_logger_.get())
+    RemoveThreadSafeObserver(binary_net_log_logger_.get());
+
+  delete current_observers();
 }
 
 void ChromeNetLog::AddEntry(
@@ -56,11 +75,17 @@ void ChromeNetLog::AddEntry(
     const scoped_refptr<EventParameters>& params) {
   base::TimeTicks time(base::TimeTicks::Now());
 
-  base::AutoLock lock(lock_);
+  // Count this call as a reader while it uses the observer list, so that
+  // WaitForReaders() knows when a replaced list is no longer in use.
+  base::subtle::Atomic32 index = base::subtle::Acquire_Load(&reader_index_);
+  base::subtle::Barrier_AtomicIncrement(&readers_[index], 1);
 
   // Notify all of the log observers.
-  FOR_EACH_OBSERVER(ThreadSafeObserver, observers_,
-                    OnAddEntry(type, time, source, phase, params));
+  const ObserverVector& observers = *current_observers();
+  for (size_t i = 0; i < observers.size(); ++i)
+    observers[i]->OnAddEntry(type, time, source, phase, params);
+
+  base::subtle::Barrier_AtomicIncrement(&readers_[index], -1);
 }
 
 uint32 ChromeNetLog::NextID() {
@@ -76,11 +101,18 @@ net::NetLog::LogLevel ChromeNetLog::GetLogLevel() const {
 void ChromeNetLog::AddThreadSafeObserver(
     net::NetLog::ThreadSafeObserver* observer,
     LogLevel log_level) {
-  base::AutoLock lock(lock_);
-
-  observers_.AddObserver(observer);
-  OnAddObserver(observer, log_level);
-  UpdateLogLevel();
+  ObserverVector* old_observers;
+  {
+    base::AutoLock lock(lock_);
+
+    ObserverVector* observers = new ObserverVector(*current_observers());
+    observers->push_back(observer);
+    OnAddObserver(observer, log_level);
+    old_observers = PublishObservers(observers);
+    UpdateLogLevel();
+  }
+  WaitForReaders();
+  delete old_observers;
 }
 
 void ChromeNetLog::SetObserverLogLevel(
@@ -88,19 +120,65 @@ void ChromeNetLog::SetObserverLogLevel(
     LogLevel log_level) {
   base::AutoLock lock(lock_);
 
-  DCHECK(observers_.HasObserver(observer));
+  DCHECK_EQ(this, observer->net_log());
   OnSetObserverLogLevel(observer, log_level);
   UpdateLogLevel();
 }
 
 void ChromeNetLog::RemoveThreadSafeObserver(
     net::NetLog::ThreadSafeObserver* observer) {
-  base::AutoLock lock(lock_);
+  ObserverVector* old_observers;
+  {
+    base::AutoLock lock(lock_);
+
+    ObserverVector* observers = new ObserverVector(*current_observers());
+    ObserverVector::iterator it =
+        std::find(observers->begin(), observers->end(), observer);
+    DCHECK(it != observers->end());
+    if (it != observers->end())
+      observers->erase(it);
+    old_observers = PublishObservers(observers);
+    OnRemoveObserver(observer);
+    UpdateLogLevel();
+  }
+  // |observer| may still be in the middle of an OnAddEntry() call.
+  WaitForReaders();
+  delete old_observers;
+}
 
-  DCHECK(observers_.HasObserver(observer));
-  observers_.RemoveObserver(observer);
-  OnRemoveObserver(observer);
-  UpdateLogLevel();
+ChromeNetLog::ObserverVector* ChromeNetLog::current_observers() const {
+  return reinterpret_cast<ObserverVector*>(
+      base::subtle::Acquire_Load(&observers_));
+}
+
+ChromeNetLog::ObserverVector* ChromeNetLog::PublishObservers(
+    ObserverVector* observers) {
+  lock_.AssertAcquired();
+
+  ObserverVector* old_observers = current_observers();
+  base::subtle::Release_Store(
+      &observers_, reinterpret_cast<base::subtle::AtomicWord>(observers));
+  return old_observers;
+}
+
+void ChromeNetLog::WaitForReaders() {
+  base::AutoLock lock(wait_for_readers_lock_);
+
+  // Pairs with the barrier in AddEntry(): a reader either counted itself
+  // before the new list was published, and is waited for below, or sees the
+  // new list.
+  base::subtle::MemoryBarrier();
+
+  // A reader may have loaded |reader_index_| long ago and only now be counting
+  // itself, so both halves have to drain.  Flipping the index before waiting
+  // on a half sends new readers to the other one.
+  for (int i = 0; i < 2; ++i) {
+    base::subtle::Atomic32 index = base::subtle::NoBarrier_Load(&reader_index_);
+    base::subtle::NoBarrier_Store(&reader_index_, index ^ 1);
+    base::subtle::MemoryBarrier();
+    while (base::subtle::Acquire_Load(&readers_[index]) != 0)
+      base::PlatformThread::YieldCurrentThread();
+  }
 }
 
 void ChromeNetLog::UpdateLogLevel() {
@@ -109,11 +187,10 @@ void ChromeNetLog::UpdateLogLevel() {
   // Look through all the observers and find the finest granularity
   // log level (higher values of the enum imply *lower* log levels).
   LogLevel new_effective_log_level = base_log_level_;
-  ObserverListBase<ThreadSafeObserver>::Iterator it(observers_);
-  ThreadSafeObserver* observer;
-  while ((observer = it.GetNext()) != NULL) {
+  const ObserverVector& observers = *current_observers();
+  for (size_t i = 0; i < observers.size(); ++i) {
     new_effective_log_level =
-        std::min(new_effective_log_level, observer->log_level());
+        std::min(new_effective_log_level, observers[i]->log_level());
   }
   base::subtle::NoBarrier_Store(&effective_log_level_,
                                 new_effective_log_level);
@@ -6,13 +6,15 @@
 #define CHROME_BROWSER_NET_CHROME_NET_LOG_H_
 #pragma once
 
+#include <vector>
+
 #include "base/atomicops.h"
 #include "base/memory/scoped_ptr.h"
-#include "base/observer_list.h"
 #include "base/synchronization/lock.h"
 #include "base/time.h"
 #include "net/base/net_log.h"
 
+class BinaryNetLogLogger;
 class LoadTimingObserver;
 class NetLogLogger;
 
@@ -22,6 +24,11 @@ class NetLogLogger;
 // All methods are thread safe, with the exception that no NetLog or
 // NetLog::ThreadSafeObserver functions may be called by an observer's
 // OnAddEntry() method.  Doing so will result in a deadlock.
+//
+// Adding entries does not take a lock: observers may be called concurrently
+// from several threads, and must handle that themselves.  Adding, removing and
+// changing observers is serialized by |lock_|.  Once RemoveThreadSafeObserver()
+// returns, the observer will not be called again.
 class ChromeNetLog : public net::NetLog {
  public:
   ChromeNetLog();
@@ -47,11 +54,28 @@ class ChromeNetLog : public net::NetLog {
                         EventPhase phase,
                         const scoped_refptr<EventParameters>& params) OVERRIDE;
 
+  // An immutable list of observers.  Replaced, never modified, when an
+  // observer is added or removed.
+  typedef std::vector<ThreadSafeObserver*> ObserverVector;
+
+  // Returns the current list of observers.
+  ObserverVector* current_observers() const;
+
+  // Makes |observers| the current list and returns the previous one, which
+  // AddEntry() may still be using until WaitForReaders() returns.  Must have
+  // acquired |lock_| prior to calling.
+  ObserverVector* PublishObservers(ObserverVector* observers);
+
+  // Waits until every AddEntry() call that might have seen an observer list
+  // replaced before this call has finished with it.  Must not be called with
+  // |lock_| held, so that log level changes are not held up meanwhile.
+  void WaitForReaders();
+
   // Called whenever an observer is added or removed, or has its log level
   // changed.  Must have acquired |lock_| prior to calling.
   void UpdateLogLevel();
 
-  // |lock_| protects access to |observers_|.
+  // |lock_| serializes changes to the observer list.
   base::Lock lock_;
 
   // Last assigned source ID.  Incremented to get the next one.
@@ -66,9 +90,19 @@ class ChromeNetLog : public net::NetLog {
 
   scoped_ptr<LoadTimingObserver> load_timing_observer_;
   scoped_ptr<NetLogLogger> net_log_logger_;
+  scoped_ptr<BinaryNetLogLogger> binary_net_log_logger_;
+
+  // The current ObserverVector*.  Only replaced under |lock_|.
+  base::subtle::AtomicWord observers_;
+
+  // AddEntry() calls in progress, split in two by which value of
+  // |reader_index_| they saw on entry.  WaitForReaders() flips the index so
+  // that the half it waits on drains even while entries keep being added.
+  base::subtle::Atomic32 reader_index_;
+  base::subtle::Atomic32 readers_[2];
 
-  // |lock_| must be acquired whenever reading or writing to this.
-  ObserverList<ThreadSafeObserver, true> observers_;
+  // Serializes WaitForReaders(), which flips |reader_index_|.
+  base::Lock wait_for_readers_lock_;
 
   DISALLOW_COPY_AND_ASSIGN(ChromeNetLog);
 };
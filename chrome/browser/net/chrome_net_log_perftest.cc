@@ -0,0 +1,89 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/net/chrome_net_log.h"
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/file_path.h"
+#include "base/perftimer.h"
+#include "base/scoped_temp_dir.h"
+#include "base/stringprintf.h"
+#include "base/threading/simple_thread.h"
+#include "chrome/browser/net/binary_net_log_logger.h"
+#include "chrome/browser/net/net_log_logger.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kThreads = 4;
+const int kEventsPerThread = 50000;
+
+// Adds |kEventsPerThread| events with a small parameter, about what a typical
+// socket or URLRequest event carries.
+class AddEventsDelegate : public base::DelegateSimpleThread::Delegate {
+ public:
+  explicit AddEventsDelegate(ChromeNetLog* net_log) : net_log_(net_log) {}
+
+  virtual void Run() OVERRIDE {
+    for (int i = 0; i < kEventsPerThread; ++i) {
+      net_log_->AddGlobalEntry(
+          net::NetLog::TYPE_CANCELLED,
+          make_scoped_refptr(new net::NetLogStringParameter(
+              "url", "http://www.google.com/search?q=net+log")));
+    }
+  }
+
+ private:
+  ChromeNetLog* const net_log_;
+
+  DISALLOW_COPY_AND_ASSIGN(AddEventsDelegate);
+};
+
+// Logs the rate at which |kThreads| threads can add events to |net_log|.
+void MeasureEventsPerSecond(const char* name, ChromeNetLog* net_log) {
+  AddEventsDelegate delegate(net_log);
+  base::DelegateSimpleThreadPool pool("ChromeNetLogPerfTest", kThreads);
+  pool.AddWork(&delegate, kThreads);
+
+  PerfTimer timer;
+  pool.Start();
+  pool.JoinAll();
+  double seconds = timer.Elapsed().InSecondsF();
+
+  LogPerfResult(base::StringPrintf("ChromeNetLog_%s", name).c_str(),
+                kThreads * kEventsPerThread / seconds, "events/s");
+}
+
+TEST(ChromeNetLogPerfTest, NoCapture) {
+  ChromeNetLog net_log;
+  MeasureEventsPerSecond("NoCapture", &net_log);
+}
+
+TEST(ChromeNetLogPerfTest, JSONCapture) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  ChromeNetLog net_log;
+  NetLogLogger logger(temp_dir.path().AppendASCII("net_log.json"));
+  logger.StartObserving(&net_log);
+  MeasureEventsPerSecond("JSONCapture", &net_log);
+  net_log.RemoveThreadSafeObserver(&logger);
+}
+
+TEST(ChromeNetLogPerfTest, BinaryCapture) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  ChromeNetLog net_log;
+  BinaryNetLogLogger logger(temp_dir.path().AppendASCII("net_log.bin"));
+  logger.StartObserving(&net_log);
+  MeasureEventsPerSecond("BinaryCapture", &net_log);
+  net_log.RemoveThreadSafeObserver(&logger);
+  // Entries the writer thread couldn't keep up with.
+  LogPerfResult("ChromeNetLog_BinaryCaptureDropped",
+                static_cast<double>(logger.dropped_entries()), "events");
+}
+
+}  // namespace
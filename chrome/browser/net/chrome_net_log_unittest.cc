@@ -4,6 +4,7 @@
 
 #include "chrome/browser/net/chrome_net_log.h"
 
+#include "base/atomicops.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/threading/simple_thread.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -27,13 +28,14 @@ class CountingObserver : public net::NetLog::ThreadSafeObserver {
                           const net::NetLog::Source& source,
                           net::NetLog::EventPhase phase,
                           net::NetLog::EventParameters* params) OVERRIDE {
-    ++count_;
+    // ChromeNetLog may call observers from several threads at once.
+    base::subtle::NoBarrier_AtomicIncrement(&count_, 1);
   }
 
-  int count() const { return count_; }
+  int count() const { return base::subtle::NoBarrier_Load(&count_); }
 
  private:
-  int count_;
+  base::subtle::Atomic32 count_;
 };
 
 void AddEvent(ChromeNetLog* net_log) {
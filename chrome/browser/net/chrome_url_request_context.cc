@@ -347,6 +347,10 @@ const std::string& ChromeURLRequestContext::GetUserAgent(
   return content::GetUserAgent(url);
 }
 
+bool ChromeURLRequestContext::IsOffTheRecord() const {
+  return is_incognito_;
+}
+
 void ChromeURLRequestContext::OnAcceptLanguageChange(
     const std::string& accept_language) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
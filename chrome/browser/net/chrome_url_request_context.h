@@ -38,6 +38,7 @@ class ChromeURLRequestContext : public net::URLRequestContext {
   }
 
   virtual const std::string& GetUserAgent(const GURL& url) const OVERRIDE;
+  virtual bool IsOffTheRecord() const OVERRIDE;
 
   // TODO(willchan): Get rid of the need for this accessor. Really, this should
   // move completely to ProfileIOData.
@@ -198,6 +198,7 @@ class ExperimentURLRequestContext : public net::URLRequestContext {
     proxy_service->reset(net::ProxyService::CreateUsingV8ProxyResolver(
         config_service.release(),
         0u,
+        false,
         new net::ProxyScriptFetcherImpl(proxy_request_context_),
         dhcp_factory.Create(proxy_request_context_),
         host_resolver(),
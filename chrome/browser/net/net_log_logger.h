@@ -19,8 +19,8 @@ class FilePath;
 // contain a single JSON object, with an extra comma on the end and missing
 // a terminal "]}".
 //
-// Relies on ChromeNetLog only calling an Observer once at a time for
-// thread-safety.
+// ChromeNetLog may call OnAddEntry() from several threads at once.  Each entry
+// is written with a single fprintf() call, which keeps lines intact.
 class NetLogLogger : public net::NetLog::ThreadSafeObserver {
  public:
   // If |log_path| is empty or file creation fails, writes to VLOG(1).
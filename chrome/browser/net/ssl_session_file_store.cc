@@ -0,0 +1,235 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/net/ssl_session_file_store.h"
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/file_util.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "base/sequenced_task_runner.h"
+#include "chrome/browser/password_manager/encryptor.h"
+#include "net/base/pickled_file_util.h"
+
+namespace {
+
+// Version of the session file format; see net/base/pickled_file_util.h.
+const int kFormatVersion = 1;
+
+// When there are more sessions than this the oldest are dropped.
+const int kMaxSessions = 1000;
+
+// NSS doesn't resume client sessions that are more than a day old, so older
+// ones aren't worth keeping.
+const int kMaxSessionAgeHours = 24;
+
+// Changes are written out this long after the first of them.
+const int kWriteDelaySeconds = 10;
+
+}  // namespace
+
+namespace chrome_browser_net {
+
+SSLSessionFileStore::SSLSessionFileStore(
+    const FilePath& path,
+    base::SequencedTaskRunner* file_task_runner)
+    : path_(path),
+      file_task_runner_(file_task_runner),
+      loaded_(false),
+      removed_all_before_load_(false),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
+  SessionMap* sessions = new SessionMap;
+  file_task_runner_->PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&SSLSessionFileStore::LoadOnFileThread, path_, sessions),
+      base::Bind(&SSLSessionFileStore::OnLoaded, weak_factory_.GetWeakPtr(),
+                 base::Owned(sessions)));
+}
+
+SSLSessionFileStore::~SSLSessionFileStore() {
+  DCHECK(CalledOnValidThread());
+  if (write_timer_.IsRunning() && loaded_) {
+    write_timer_.Stop();
+    Write();
+  }
+}
+
+bool SSLSessionFileStore::GetSession(const std::string& peer_id,
+                                     std::string* session) {
+  DCHECK(CalledOnValidThread());
+  SessionMap::const_iterator it = sessions_.find(peer_id);
+  if (it == sessions_.end())
+    return false;
+  *session = it->second.session;
+  return true;
+}
+
+void SSLSessionFileStore::SetSession(const std::string& peer_id,
+                                     const std::string& session) {
+  DCHECK(CalledOnValidThread());
+  StoredSession& stored = sessions_[peer_id];
+  stored.session = session;
+  stored.saved = base::Time::Now();
+
+  if (sessions_.size() > static_cast<size_t>(kMaxSessions)) {
+    SessionMap::iterator oldest = sessions_.begin();
+    for (SessionMap::iterator it = sessions_.begin(); it != sessions_.end();
+         ++it) {
+      if (it->second.saved < oldest->second.saved)
+        oldest = it;
+    }
+    sessions_.erase(oldest);
+  }
+  ScheduleWrite();
+}
+
+void SSLSessionFileStore::RemoveSession(const std::string& peer_id) {
+  DCHECK(CalledOnValidThread());
+  sessions_.erase(peer_id);
+  if (!loaded_)
+    removed_before_load_.insert(peer_id);
+  ScheduleWrite();
+}
+
+void SSLSessionFileStore::RemoveAllSessions() {
+  DCHECK(CalledOnValidThread());
+  sessions_.clear();
+  if (!loaded_) {
+    removed_before_load_.clear();
+    removed_all_before_load_ = true;
+  }
+  // This is how browsing data is cleared, so don't leave the file around
+  // until the next batch.
+  write_timer_.Stop();
+  Write();
+}
+
+// static
+void SSLSessionFileStore::Serialize(const SessionMap& sessions,
+                                    std::string* data) {
+  Pickle pickle;
+  net::WritePickledFileVersion(&pickle, kFormatVersion);
+  pickle.WriteInt(static_cast<int>(sessions.size()));
+  for (SessionMap::const_iterator it = sessions.begin(); it != sessions.end();
+       ++it) {
+    pickle.WriteString(it->first);
+    pickle.WriteString(it->second.session);
+    pickle.WriteInt64(it->second.saved.ToInternalValue());
+  }
+  data->assign(static_cast<const char*>(pickle.data()), pickle.size());
+}
+
+// static
+bool SSLSessionFileStore::Deserialize(const std::string& data,
+                                      SessionMap* sessions) {
+  Pickle pickle(data.data(), static_cast<int>(data.size()));
+  PickleIterator iter(pickle);
+  int count;
+  if (!net::ReadPickledFileVersion(pickle, &iter, kFormatVersion) ||
+      !pickle.ReadInt(&iter, &count) || count < 0 || count > kMaxSessions) {
+    return false;
+  }
+
+  for (int i = 0; i < count; ++i) {
+    std::string peer_id;
+    StoredSession stored;
+    int64 saved;
+    if (!pickle.ReadString(&iter, &peer_id) ||
+        !pickle.ReadString(&iter, &stored.session) ||
+        !pickle.ReadInt64(&iter, &saved)) {
+      return false;
+    }
+    stored.saved = base::Time::FromInternalValue(saved);
+    (*sessions)[peer_id] = stored;
+  }
+  return true;
+}
+
+// static
+void SSLSessionFileStore::LoadOnFileThread(const FilePath& path,
+                                           SessionMap* sessions) {
+  std::string ciphertext;
+  if (!file_util::ReadFileToString(path, &ciphertext))
+    return;
+  std::string plaintext;
+  if (!Encryptor::DecryptString(ciphertext, &plaintext) ||
+      !Deserialize(plaintext, sessions)) {
+    DVLOG(1) << "Discarding unreadable TLS sessions " << path.value();
+    sessions->clear();
+    file_util::Delete(path, false);
+  }
+}
+
+// static
+void SSLSessionFileStore::WriteOnFileThread(const FilePath& path,
+                                            const std::string& plaintext) {
+  std::string ciphertext;
+  if (!Encryptor::EncryptString(plaintext, &ciphertext)) {
+    // Don't leave sessions on disk that no longer match the ones in memory.
+    file_util::Delete(path, false);
+    return;
+  }
+  net::WriteFileAtomically(path, ciphertext);
+}
+
+void SSLSessionFileStore::OnLoaded(SessionMap* sessions) {
+  DCHECK(CalledOnValidThread());
+  loaded_ = true;
+
+  const base::Time cutoff =
+      base::Time::Now() - base::TimeDelta::FromHours(kMaxSessionAgeHours);
+  bool dropped = false;
+  if (removed_all_before_load_) {
+    dropped = !sessions->empty();
+  } else {
+    for (SessionMap::const_iterator it = sessions->begin();
+         it != sessions->end(); ++it) {
+      if (it->second.saved < cutoff || removed_before_load_.count(it->first)) {
+        dropped = true;
+        continue;
+      }
+      // A session saved since startup is newer than the one in the file, so
+      // insert() rightly keeps it.
+      sessions_.insert(*it);
+    }
+  }
+  removed_before_load_.clear();
+  removed_all_before_load_ = false;
+
+  if (dropped)
+    ScheduleWrite();
+}
+
+void SSLSessionFileStore::ScheduleWrite() {
+  if (write_timer_.IsRunning())
+    return;
+  write_timer_.Start(FROM_HERE,
+                     base::TimeDelta::FromSeconds(kWriteDelaySeconds),
+                     this, &SSLSessionFileStore::Write);
+}
+
+void SSLSessionFileStore::Write() {
+  // Writing before the file is loaded would lose what it holds.
+  if (!loaded_) {
+    ScheduleWrite();
+    return;
+  }
+
+  if (sessions_.empty()) {
+    file_task_runner_->PostTask(
+        FROM_HERE,
+        base::Bind(base::IgnoreResult(&file_util::Delete), path_, false));
+    return;
+  }
+
+  std::string plaintext;
+  Serialize(sessions_, &plaintext);
+  file_task_runner_->PostTask(
+      FROM_HERE,
+      base::Bind(&SSLSessionFileStore::WriteOnFileThread, path_, plaintext));
+}
+
+}  // namespace chrome_browser_net
@@ -0,0 +1,95 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CHROME_BROWSER_NET_SSL_SESSION_FILE_STORE_H_
+#define CHROME_BROWSER_NET_SSL_SESSION_FILE_STORE_H_
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "base/compiler_specific.h"
+#include "base/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/threading/non_thread_safe.h"
+#include "base/time.h"
+#include "base/timer.h"
+#include "net/socket/ssl_session_store.h"
+
+namespace base {
+class SequencedTaskRunner;
+}
+
+namespace chrome_browser_net {
+
+// An SSLSessionStore that keeps a profile's TLS sessions in a file, so that
+// the first connections after a restart can resume them.  Sessions carry
+// their master secret, so the file is encrypted with the Encryptor, as saved
+// passwords are.  Off-the-record profiles must not use one.
+//
+// The file is read once, when the store is created; GetSession() finds
+// nothing until it has been loaded.  Changes are written back in batches.
+class SSLSessionFileStore : public net::SSLSessionStore,
+                            public base::NonThreadSafe {
+ public:
+  // The file at |path| is read and written on |file_task_runner|.
+  SSLSessionFileStore(const FilePath& path,
+                      base::SequencedTaskRunner* file_task_runner);
+
+  // Writes out any changes that are still pending.
+  virtual ~SSLSessionFileStore();
+
+  // net::SSLSessionStore methods:
+  virtual bool GetSession(const std::string& peer_id,
+                          std::string* session) OVERRIDE;
+  virtual void SetSession(const std::string& peer_id,
+                          const std::string& session) OVERRIDE;
+  virtual void RemoveSession(const std::string& peer_id) OVERRIDE;
+  virtual void RemoveAllSessions() OVERRIDE;
+
+ private:
+  struct StoredSession {
+    std::string session;
+    base::Time saved;
+  };
+  typedef std::map<std::string, StoredSession> SessionMap;
+
+  // Serializes |sessions| to |data|, and back.
+  static void Serialize(const SessionMap& sessions, std::string* data);
+  static bool Deserialize(const std::string& data, SessionMap* sessions);
+
+  static void LoadOnFileThread(const FilePath& path, SessionMap* sessions);
+  static void WriteOnFileThread(const FilePath& path,
+                                const std::string& plaintext);
+
+  void OnLoaded(SessionMap* sessions);
+
+  // Writes |sessions_| after a delay, so that a burst of handshakes is
+  // written once.
+  void ScheduleWrite();
+  void Write();
+
+  const FilePath path_;
+  scoped_refptr<base::SequencedTaskRunner> file_task_runner_;
+
+  SessionMap sessions_;
+  bool loaded_;
+
+  // Removals made before the file was loaded, which must also apply to what
+  // it holds.
+  std::set<std::string> removed_before_load_;
+  bool removed_all_before_load_;
+
+  base::OneShotTimer<SSLSessionFileStore> write_timer_;
+
+  base::WeakPtrFactory<SSLSessionFileStore> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(SSLSessionFileStore);
+};
+
+}  // namespace chrome_browser_net
+
+#endif  // CHROME_BROWSER_NET_SSL_SESSION_FILE_STORE_H_
@@ -0,0 +1,113 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "chrome/browser/net/ssl_session_file_store.h"
+
+#include "base/file_util.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/message_loop_proxy.h"
+#include "base/scoped_temp_dir.h"
+#include "chrome/browser/password_manager/encryptor.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace chrome_browser_net {
+
+namespace {
+
+const char kPeerId[] = "www.example.com:443";
+const char kOtherPeerId[] = "www.example.org:443";
+const char kSession[] = "session with its master secret";
+
+}  // namespace
+
+class SSLSessionFileStoreTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+#if defined(OS_MACOSX)
+    Encryptor::UseMockKeychain(true);
+#endif
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.path().AppendASCII("TLS Sessions");
+  }
+
+  // Creates a store for |path_| and waits for it to load.
+  SSLSessionFileStore* CreateStore() {
+    SSLSessionFileStore* store = new SSLSessionFileStore(
+        path_, message_loop_.message_loop_proxy());
+    message_loop_.RunAllPending();
+    return store;
+  }
+
+  // Destroys |store|, which writes out its pending changes.
+  void DestroyStore(SSLSessionFileStore* store) {
+    delete store;
+    message_loop_.RunAllPending();
+  }
+
+  MessageLoop message_loop_;
+  ScopedTempDir temp_dir_;
+  FilePath path_;
+};
+
+TEST_F(SSLSessionFileStoreTest, SessionsOutliveTheStore) {
+  SSLSessionFileStore* store = CreateStore();
+  store->SetSession(kPeerId, kSession);
+  DestroyStore(store);
+
+  // The session is on disk, but not in the clear.
+  std::string contents;
+  ASSERT_TRUE(file_util::ReadFileToString(path_, &contents));
+  EXPECT_EQ(std::string::npos, contents.find(kSession));
+
+  scoped_ptr<SSLSessionFileStore> new_store(CreateStore());
+  std::string session;
+  ASSERT_TRUE(new_store->GetSession(kPeerId, &session));
+  EXPECT_EQ(kSession, session);
+  EXPECT_FALSE(new_store->GetSession(kOtherPeerId, &session));
+}
+
+TEST_F(SSLSessionFileStoreTest, RemoveAllSessionsDeletesTheFile) {
+  SSLSessionFileStore* store = CreateStore();
+  store->SetSession(kPeerId, kSession);
+  DestroyStore(store);
+  ASSERT_TRUE(file_util::PathExists(path_));
+
+  scoped_ptr<SSLSessionFileStore> new_store(CreateStore());
+  new_store->RemoveAllSessions();
+  message_loop_.RunAllPending();
+  EXPECT_FALSE(file_util::PathExists(path_));
+  std::string session;
+  EXPECT_FALSE(new_store->GetSession(kPeerId, &session));
+}
+
+TEST_F(SSLSessionFileStoreTest, RemoveBeforeLoad) {
+  SSLSessionFileStore* store = CreateStore();
+  store->SetSession(kPeerId, kSession);
+  store->SetSession(kOtherPeerId, kSession);
+  DestroyStore(store);
+
+  // The removal comes before the file is read, and still applies to it.
+  scoped_ptr<SSLSessionFileStore> new_store(new SSLSessionFileStore(
+      path_, message_loop_.message_loop_proxy()));
+  new_store->RemoveSession(kPeerId);
+  message_loop_.RunAllPending();
+
+  std::string session;
+  EXPECT_FALSE(new_store->GetSession(kPeerId, &session));
+  EXPECT_TRUE(new_store->GetSession(kOtherPeerId, &session));
+}
+
+TEST_F(SSLSessionFileStoreTest, UnreadableFileIsDiscarded) {
+  const char kGarbage[] = "not a session file";
+  ASSERT_EQ(static_cast<int>(sizeof(kGarbage)),
+            file_util::WriteFile(path_, kGarbage, sizeof(kGarbage)));
+
+  scoped_ptr<SSLSessionFileStore> store(CreateStore());
+  std::string session;
+  EXPECT_FALSE(store->GetSession(kPeerId, &session));
+  EXPECT_FALSE(file_util::PathExists(path_));
+}
+
+}  // namespace chrome_browser_net
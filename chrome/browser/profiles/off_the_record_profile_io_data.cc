@@ -19,6 +19,7 @@
 #include "chrome/common/url_constants.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/resource_context.h"
+#include "net/base/cert_verifier.h"
 #include "net/base/default_server_bound_cert_store.h"
 #include "net/base/server_bound_cert_service.h"
 #include "net/ftp/ftp_network_layer.h"
@@ -169,8 +170,10 @@ void OffTheRecordProfileIOData::LazyInitializeInternal(
 
   main_context->set_host_resolver(
       io_thread_globals->host_resolver.get());
-  main_context->set_cert_verifier(
-      io_thread_globals->cert_verifier.get());
+  // For incognito, we use a separate verifier, so that its results never
+  // reach the shared verifier's on-disk cache.
+  cert_verifier_.reset(net::CertVerifier::CreateDefault());
+  main_context->set_cert_verifier(cert_verifier_.get());
   main_context->set_http_auth_handler_factory(
       io_thread_globals->http_auth_handler_factory.get());
   main_context->set_fraudulent_certificate_reporter(
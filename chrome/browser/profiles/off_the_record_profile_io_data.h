@@ -18,6 +18,7 @@ class ChromeURLRequestContext;
 class ChromeURLRequestContextGetter;
 class Profile;
 namespace net {
+class CertVerifier;
 class HttpServerPropertiesImpl;
 }  // namespace net
 
@@ -108,6 +109,7 @@ class OffTheRecordProfileIOData : public ProfileIOData {
           scoped_refptr<ChromeURLRequestContext> main_context,
           const std::string& app_id) const OVERRIDE;
 
+  mutable scoped_ptr<net::CertVerifier> cert_verifier_;
   mutable scoped_ptr<net::HttpServerPropertiesImpl> http_server_properties_;
 
   mutable scoped_ptr<net::HttpTransactionFactory> main_http_factory_;
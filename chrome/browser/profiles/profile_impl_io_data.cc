@@ -17,6 +17,7 @@
 #include "chrome/browser/net/predictor.h"
 #include "chrome/browser/net/sqlite_persistent_cookie_store.h"
 #include "chrome/browser/net/sqlite_server_bound_cert_store.h"
+#include "chrome/browser/net/ssl_session_file_store.h"
 #include "chrome/browser/prefs/pref_member.h"
 #include "chrome/browser/profiles/profile.h"
 #include "chrome/common/chrome_constants.h"
@@ -25,6 +26,8 @@
 #include "chrome/common/url_constants.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/resource_context.h"
+#include "net/base/cert_verifier_cache_file_store.h"
+#include "net/base/multi_threaded_cert_verifier.h"
 #include "net/base/server_bound_cert_service.h"
 #include "net/ftp/ftp_network_layer.h"
 #include "net/http/http_cache.h"
@@ -39,6 +42,9 @@ void ClearNetworkingHistorySinceOnIOThread(
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
   io_data->transport_security_state()->DeleteSince(time);
   io_data->http_server_properties()->Clear();
+  // The cached verifications name the hosts that were visited.  They are
+  // all recent, so drop them regardless of |time|.
+  io_data->cert_verifier()->ClearCache();
 }
 
 }  // namespace
@@ -301,10 +307,15 @@ void ProfileImplIOData::LazyInitializeInternal(
       io_thread_globals->host_resolver.get());
   media_request_context_->set_host_resolver(
       io_thread_globals->host_resolver.get());
-  main_context->set_cert_verifier(
-      io_thread_globals->cert_verifier.get());
-  media_request_context_->set_cert_verifier(
-      io_thread_globals->cert_verifier.get());
+  // Keep verification results across restarts, so that the first handshakes
+  // of a session don't all wait on certificate path building.
+  cert_verifier_.reset(new net::MultiThreadedCertVerifier());
+  cert_verifier_->SetCacheStore(
+      new net::CertVerifierCacheFileStore(
+          profile_params->path.Append(chrome::kCertVerifierCacheFilename),
+          BrowserThread::GetMessageLoopProxyForThread(BrowserThread::FILE)));
+  main_context->set_cert_verifier(cert_verifier_.get());
+  media_request_context_->set_cert_verifier(cert_verifier_.get());
   main_context->set_http_auth_handler_factory(
       io_thread_globals->http_auth_handler_factory.get());
   media_request_context_->set_http_auth_handler_factory(
@@ -383,19 +394,31 @@ void ProfileImplIOData::LazyInitializeInternal(
           lazy_params_->cache_path,
           lazy_params_->cache_max_size,
           BrowserThread::GetMessageLoopProxyForThread(BrowserThread::CACHE));
-  net::HttpCache* main_cache = new net::HttpCache(
-      main_context->host_resolver(),
-      main_context->cert_verifier(),
-      main_context->server_bound_cert_service(),
-      main_context->transport_security_state(),
-      main_context->proxy_service(),
-      GetSSLSessionCacheShard(),
-      main_context->ssl_config_service(),
-      main_context->http_auth_handler_factory(),
-      main_context->network_delegate(),
-      main_context->http_server_properties(),
-      main_context->net_log(),
-      main_backend);
+  net::HttpNetworkSession::Params network_params;
+  network_params.host_resolver = main_context->host_resolver();
+  network_params.cert_verifier = main_context->cert_verifier();
+  network_params.server_bound_cert_service =
+      main_context->server_bound_cert_service();
+  network_params.transport_security_state =
+      main_context->transport_security_state();
+  network_params.proxy_service = main_context->proxy_service();
+  network_params.ssl_session_cache_shard = GetSSLSessionCacheShard();
+  network_params.ssl_config_service = main_context->ssl_config_service();
+  network_params.http_auth_handler_factory =
+      main_context->http_auth_handler_factory();
+  network_params.network_delegate = main_context->network_delegate();
+  network_params.http_server_properties =
+      main_context->http_server_properties();
+  network_params.net_log = main_context->net_log();
+  // Keep TLS sessions across restarts, except when recording or playing back,
+  // which start from a clean slate.
+  if (!record_mode && !playback_mode) {
+    ssl_session_store_.reset(new chrome_browser_net::SSLSessionFileStore(
+        profile_params->path.Append(chrome::kSSLSessionsFilename),
+        BrowserThread::GetMessageLoopProxyForThread(BrowserThread::FILE)));
+    network_params.ssl_session_store = ssl_session_store_.get();
+  }
+  net::HttpCache* main_cache = new net::HttpCache(network_params, main_backend);
 
   net::HttpCache::DefaultBackend* media_backend =
       new net::HttpCache::DefaultBackend(
@@ -15,11 +15,13 @@
 namespace chrome_browser_net {
 class HttpServerPropertiesManager;
 class Predictor;
+class SSLSessionFileStore;
 }
 
 namespace net {
 class HttpServerProperties;
 class HttpTransactionFactory;
+class MultiThreadedCertVerifier;
 }  // namespace net
 
 class ProfileImplIOData : public ProfileIOData {
@@ -102,6 +104,10 @@ class ProfileImplIOData : public ProfileIOData {
 
   net::HttpServerProperties* http_server_properties() const;
 
+  net::MultiThreadedCertVerifier* cert_verifier() const {
+    return cert_verifier_.get();
+  }
+
  private:
   friend class base::RefCountedThreadSafe<ProfileImplIOData>;
 
@@ -144,6 +150,14 @@ class ProfileImplIOData : public ProfileIOData {
   mutable scoped_ptr<chrome_browser_net::HttpServerPropertiesManager>
       http_server_properties_manager_;
 
+  // Keeps its results in the profile directory.
+  mutable scoped_ptr<net::MultiThreadedCertVerifier> cert_verifier_;
+
+  // Keeps TLS sessions in the profile directory.  Must outlive the HTTP
+  // factories below, whose sockets use it.
+  mutable scoped_ptr<chrome_browser_net::SSLSessionFileStore>
+      ssl_session_store_;
+
   mutable scoped_refptr<ChromeURLRequestContext> media_request_context_;
 
   mutable scoped_ptr<net::HttpTransactionFactory> main_http_factory_;
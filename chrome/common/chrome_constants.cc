@@ -130,6 +130,8 @@ const FilePath::CharType kMediaCacheDirname[] = FPL("Media Cache");
 const FilePath::CharType kOffTheRecordMediaCacheDirname[] =
     FPL("Incognito Media Cache");
 const FilePath::CharType kThemePackFilename[] = FPL("Cached Theme.pak");
+const FilePath::CharType kCertVerifierCacheFilename[] =
+    FPL("Certificate Verification Cache");
 const FilePath::CharType kCookieFilename[] = FPL("Cookies");
 const FilePath::CharType kOBCertFilename[] = FPL("Origin Bound Certs");
 const FilePath::CharType kExtensionsCookieFilename[] = FPL("Extension Cookies");
@@ -139,9 +141,12 @@ const FilePath::CharType kHistoryFilename[] = FPL("History");
 const FilePath::CharType kLocalStateFilename[] = FPL("Local State");
 const FilePath::CharType kPreferencesFilename[] = FPL("Preferences");
 const FilePath::CharType kSafeBrowsingBaseFilename[] = FPL("Safe Browsing");
+const FilePath::CharType kSdchDictionariesDirname[] =
+    FPL("SDCH Dictionaries");
 const FilePath::CharType kSingletonCookieFilename[] = FPL("SingletonCookie");
 const FilePath::CharType kSingletonSocketFilename[] = FPL("SingletonSocket");
 const FilePath::CharType kSingletonLockFilename[] = FPL("SingletonLock");
+const FilePath::CharType kSSLSessionsFilename[] = FPL("TLS Sessions");
 const FilePath::CharType kThumbnailsFilename[] = FPL("Thumbnails");
 const FilePath::CharType kNewTabThumbnailsFilename[] = FPL("Top Thumbnails");
 const FilePath::CharType kTopSitesFilename[] = FPL("Top Sites");
@@ -58,6 +58,7 @@ extern const FilePath::CharType kCRLSetFilename[];
 extern const FilePath::CharType kMediaCacheDirname[];
 extern const FilePath::CharType kOffTheRecordMediaCacheDirname[];
 extern const FilePath::CharType kThemePackFilename[];
+extern const FilePath::CharType kCertVerifierCacheFilename[];
 extern const FilePath::CharType kCookieFilename[];
 extern const FilePath::CharType kOBCertFilename[];
 extern const FilePath::CharType kExtensionsCookieFilename[];
@@ -67,9 +68,11 @@ extern const FilePath::CharType kHistoryFilename[];
 extern const FilePath::CharType kLocalStateFilename[];
 extern const FilePath::CharType kPreferencesFilename[];
 extern const FilePath::CharType kSafeBrowsingBaseFilename[];
+extern const FilePath::CharType kSdchDictionariesDirname[];
 extern const FilePath::CharType kSingletonCookieFilename[];
 extern const FilePath::CharType kSingletonSocketFilename[];
 extern const FilePath::CharType kSingletonLockFilename[];
+extern const FilePath::CharType kSSLSessionsFilename[];
 extern const FilePath::CharType kThumbnailsFilename[];
 extern const FilePath::CharType kNewTabThumbnailsFilename[];
 extern const FilePath::CharType kTopSitesFilename[];
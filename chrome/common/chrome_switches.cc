@@ -186,6 +186,10 @@ const char kComponentUpdaterDebug[]         = "component-updater-debug";
 // conflicts and warn the user.
 const char kConflictingModulesCheck[]       = "conflicting-modules-check";
 
+// Races TCP connects across all of a host's resolved addresses, starting a
+// new connect every given number of milliseconds.  0 turns racing off.
+const char kConnectRaceStaggerMs[]          = "connect-race-stagger-ms";
+
 // The Country we should use. This is normally obtained from the operating
 // system during first run and cached in the preferences afterwards. This is a
 // string value, the 2 letter code from ISO 3166-1.
@@ -471,6 +475,10 @@ const char kEnableAutologin[]               = "enable-autologin";
 // Enables the benchmarking extensions.
 const char kEnableBenchmarking[]            = "enable-benchmarking";
 
+// Advertises the bzip2 content encoding for HTTPS requests.  Off by default
+// while its impact is measured.
+const char kEnableBZip2Encoding[]           = "enable-bzip2-encoding";
+
 // Enables the bundled PPAPI version of Flash.
 const char kEnableBundledPpapiFlash[]       = "enable-bundled-ppapi-flash";
 
@@ -554,6 +562,10 @@ const char kEnableNpn[]                     = "enable-npn";
 // HTTP is still used for all requests.
 const char kEnableNpnHttpOnly[]             = "enable-npn-http";
 
+// Caches PAC script results per scheme, host and port, and memoizes the
+// script's DNS lookups. Only correct for PAC scripts that ignore the URL path.
+const char kEnablePacResultCache[]          = "enable-pac-result-cache";
+
 // Enables panels (always on-top docked pop-up windows).
 const char kEnablePanels[]                  = "enable-panels";
 
@@ -793,6 +805,10 @@ const char kLoadOpencryptoki[]              = "load-opencryptoki";
 // to a separate file if a file name is given.
 const char kLogNetLog[]                     = "log-net-log";
 
+// Writes net log events to the given file in the compact binary format read
+// by net_log_converter.  Cheaper than --log-net-log while capturing.
+const char kLogNetLogBinary[]               = "log-net-log-binary";
+
 // Uninstalls an extension with the specified extension id.
 const char kUninstallExtension[]            = "uninstall-extension";
 
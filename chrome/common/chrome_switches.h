@@ -64,6 +64,7 @@ extern const char kCloudPrintProxyId[];
 extern const char kCloudPrintServiceURL[];
 extern const char kComponentUpdaterDebug[];
 extern const char kConflictingModulesCheck[];
+extern const char kConnectRaceStaggerMs[];
 extern const char kCountry[];
 extern const char kCrashOnHangSeconds[];
 extern const char kCrashOnHangThreads[];
@@ -135,6 +136,7 @@ extern const char kEnableAuthNegotiatePort[];
 extern const char kEnableAutofillFeedback[];
 extern const char kEnableAutologin[];
 extern const char kEnableBenchmarking[];
+extern const char kEnableBZip2Encoding[];
 extern const char kEnableBundledPpapiFlash[];
 extern const char kEnableChromeToMobile[];
 extern const char kEnableCloudPrintProxy[];
@@ -157,6 +159,7 @@ extern const char kEnableNaClDebug[];
 extern const char kEnableNaClExceptionHandling[];
 extern const char kEnableNpn[];
 extern const char kEnableNpnHttpOnly[];
+extern const char kEnablePacResultCache[];
 extern const char kEnablePanels[];
 extern const char kEnablePasswordGeneration[];
 extern const char kEnablePlatformApps[];
@@ -217,6 +220,7 @@ extern const char kLoadExtension[];
 extern const char kLoadOpencryptoki[];
 extern const char kUninstallExtension[];
 extern const char kLogNetLog[];
+extern const char kLogNetLogBinary[];
 extern const char kMakeDefaultBrowser[];
 extern const char kManaged[];
 extern const char kMediaCacheSize[];
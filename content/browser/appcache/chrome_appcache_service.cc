@@ -4,10 +4,13 @@
 
 #include "content/browser/appcache/chrome_appcache_service.h"
 
+#include "base/command_line.h"
 #include "base/file_path.h"
 #include "base/file_util.h"
+#include "base/string_number_conversions.h"
 #include "content/public/browser/content_browser_client.h"
 #include "content/public/browser/resource_context.h"
+#include "content/public/common/content_switches.h"
 #include "net/base/net_errors.h"
 #include "webkit/quota/quota_manager.h"
 
@@ -37,6 +40,16 @@ void ChromeAppCacheService::InitializeOnIOThread(
       BrowserThread::GetMessageLoopProxyForThread(BrowserThread::CACHE));
   set_appcache_policy(this);
   set_special_storage_policy(special_storage_policy);
+
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  if (command_line.HasSwitch(switches::kAppCacheMaxConcurrentUpdateFetches)) {
+    size_t max_fetches = 0;
+    if (base::StringToSizeT(command_line.GetSwitchValueASCII(
+            switches::kAppCacheMaxConcurrentUpdateFetches), &max_fetches) &&
+        max_fetches > 0) {
+      set_max_concurrent_update_fetches(max_fetches);
+    }
+  }
 }
 
 ChromeAppCacheService::~ChromeAppCacheService() {
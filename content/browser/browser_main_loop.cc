@@ -55,6 +55,7 @@
 #endif
 
 #if defined(OS_LINUX)
+#include "base/message_pump_libevent.h"
 #include "content/browser/media_device_notifications_linux.h"
 #endif
 
@@ -282,6 +283,14 @@ void BrowserMainLoop::EarlyInitialization() {
   if (parsed_command_line_.HasSwitch(switches::kEnableTcpFastOpen))
     net::set_tcp_fastopen_enabled(true);
 
+#if defined(OS_LINUX)
+  // Must happen before the IO threads are started.
+  if (parsed_command_line_.HasSwitch(switches::kEnableEpollMessagePump)) {
+    base::MessagePumpLibevent::SetDefaultBackend(
+        base::MessagePumpLibevent::BACKEND_EPOLL);
+  }
+#endif
+
   if (parsed_command_line_.HasSwitch(switches::kRendererProcessLimit)) {
     std::string limit_string = parsed_command_line_.GetSwitchValueASCII(
         switches::kRendererProcessLimit);
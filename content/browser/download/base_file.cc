@@ -4,19 +4,28 @@
 
 #include "content/browser/download/base_file.h"
 
+#include <algorithm>
+#include <deque>
+
+#include "base/bind.h"
 #include "base/file_util.h"
 #include "base/format_macros.h"
 #include "base/logging.h"
 #include "base/pickle.h"
+#include "base/platform_file.h"
 #include "base/stringprintf.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/sequenced_worker_pool.h"
 #include "base/threading/thread_restrictions.h"
 #include "base/utf_string_conversions.h"
+#include "content/browser/download/download_buffer.h"
 #include "content/browser/download/download_net_log_parameters.h"
 #include "content/browser/download/download_stats.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/content_browser_client.h"
 #include "crypto/secure_hash.h"
 #include "net/base/file_stream.h"
+#include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 
 #if defined(OS_WIN)
@@ -26,6 +35,11 @@
 #include "content/browser/safe_util_win.h"
 #elif defined(OS_MACOSX)
 #include "content/browser/file_metadata_mac.h"
+#elif defined(OS_LINUX)
+#include <errno.h>
+#include <fcntl.h>
+
+#include "base/eintr_wrapper.h"
 #endif
 
 using content::BrowserThread;
@@ -196,8 +210,133 @@ net::Error RenameFileAndResetSecurityDescriptor(
 
 #endif
 
+// Once this much data is waiting to be hashed the FILE thread hashes it
+// itself, which keeps a slow hash from buffering an unbounded amount of the
+// download in memory.
+const size_t kMaxQueuedHashBytes = 4 * 1024 * 1024;
+
 }  // namespace
 
+// SHA-256 is slower than writing to disk, so with it inline the FILE thread,
+// which writes every download, becomes the bottleneck for concurrent large
+// downloads.  A HashStage instead queues each written buffer and hashes it
+// on the blocking pool, in order.  Anything that needs the hash state first
+// hashes whatever is still queued, on the calling thread.
+class BaseFile::HashStage
+    : public base::RefCountedThreadSafe<BaseFile::HashStage> {
+ public:
+  HashStage()
+      : secure_hash_(
+            crypto::SecureHash::Create(crypto::SecureHash::SHA256)),
+        queued_bytes_(0),
+        hash_task_posted_(false) {
+  }
+
+  // Queues the first |data_len| bytes of |buffer| to be hashed.  The buffer
+  // is referenced rather than copied, and must not be modified afterwards.
+  void Update(net::IOBuffer* buffer, size_t data_len) {
+    bool post_task = false;
+    bool catch_up = false;
+    {
+      base::AutoLock queue_lock(queue_lock_);
+      queue_.push_back(std::make_pair(make_scoped_refptr(buffer), data_len));
+      queued_bytes_ += data_len;
+      catch_up = queued_bytes_ > kMaxQueuedHashBytes;
+      if (!hash_task_posted_)
+        post_task = hash_task_posted_ = true;
+    }
+
+    // If the pool is shutting down the task is dropped, and the queue is
+    // hashed here instead.
+    if (post_task &&
+        !BrowserThread::GetBlockingPool()->PostWorkerTaskWithShutdownBehavior(
+            FROM_HERE,
+            base::Bind(&HashStage::HashQueuedData, this),
+            base::SequencedWorkerPool::SKIP_ON_SHUTDOWN)) {
+      catch_up = true;
+    }
+
+    if (catch_up) {
+      base::AutoLock hash_lock(hash_lock_);
+      HashQueuedBuffers();
+    }
+  }
+
+  void Finish(void* output, size_t len) {
+    base::AutoLock hash_lock(hash_lock_);
+    HashQueuedBuffers();
+    secure_hash_->Finish(output, len);
+  }
+
+  bool Serialize(Pickle* pickle) {
+    base::AutoLock hash_lock(hash_lock_);
+    HashQueuedBuffers();
+    return secure_hash_->Serialize(pickle);
+  }
+
+  bool Deserialize(PickleIterator* data_iterator) {
+    base::AutoLock hash_lock(hash_lock_);
+    return secure_hash_->Deserialize(data_iterator);
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<HashStage>;
+
+  ~HashStage() {}
+
+  // Runs on the blocking pool until the queue is empty.  |hash_lock_| is
+  // released between buffers, so a caller that needs the hash state only
+  // waits for the buffer being hashed.
+  void HashQueuedData() {
+    for (;;) {
+      {
+        base::AutoLock hash_lock(hash_lock_);
+        if (HashNextBuffer())
+          continue;
+      }
+      base::AutoLock queue_lock(queue_lock_);
+      if (queue_.empty()) {
+        hash_task_posted_ = false;
+        return;
+      }
+    }
+  }
+
+  // Hashes everything queued.  |hash_lock_| must be held.
+  void HashQueuedBuffers() {
+    while (HashNextBuffer()) {}
+  }
+
+  // Hashes the oldest queued buffer.  Returns false if there was none.
+  bool HashNextBuffer() {
+    hash_lock_.AssertAcquired();
+    content::ContentElement next;
+    {
+      base::AutoLock queue_lock(queue_lock_);
+      if (queue_.empty())
+        return false;
+      next = queue_.front();
+      queue_.pop_front();
+      queued_bytes_ -= next.second;
+    }
+    secure_hash_->Update(next.first->data(), next.second);
+    return true;
+  }
+
+  // Held while |secure_hash_| is in use, and always taken before
+  // |queue_lock_|.
+  base::Lock hash_lock_;
+  scoped_ptr<crypto::SecureHash> secure_hash_;
+
+  // Protects the members below.
+  base::Lock queue_lock_;
+  std::deque<content::ContentElement> queue_;
+  size_t queued_bytes_;
+  bool hash_task_posted_;
+
+  DISALLOW_COPY_AND_ASSIGN(HashStage);
+};
+
 // This will initialize the entire array to zero.
 const unsigned char BaseFile::kEmptySha256Hash[] = { 0 };
 
@@ -214,6 +353,7 @@ BaseFile::BaseFile(const FilePath& full_path,
       referrer_url_(referrer_url),
       file_stream_(file_stream),
       bytes_so_far_(received_bytes),
+      hashed_bytes_(received_bytes),
       start_tick_(base::TimeTicks::Now()),
       power_save_blocker_(PowerSaveBlocker::kPowerSaveBlockPreventSystemSleep),
       calculate_hash_(calculate_hash),
@@ -227,7 +367,7 @@ BaseFile::BaseFile(const FilePath& full_path,
   }
 
   if (calculate_hash_) {
-    secure_hash_.reset(crypto::SecureHash::Create(crypto::SecureHash::SHA256));
+    hash_stage_ = new HashStage;
     if ((bytes_so_far_ > 0) &&  // Not starting at the beginning.
         (hash_state != "") &&  // Reasonably sure we have a hash state.
         (!IsEmptyHash(hash_state))) {
@@ -262,7 +402,7 @@ net::Error BaseFile::Initialize() {
   return Open();
 }
 
-net::Error BaseFile::AppendDataToFile(const char* data, size_t data_len) {
+net::Error BaseFile::AppendDataToFile(net::IOBuffer* data, size_t data_len) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
   DCHECK(!detached_);
 
@@ -287,6 +427,90 @@ net::Error BaseFile::AppendDataToFile(const char* data, size_t data_len) {
   if (data_len == 0)
     return net::OK;
 
+  // Once ranges have been written the stream position can be anywhere, and
+  // appended data goes at the end of the data written from the start.
+  if (!written_ranges_.empty())
+    return WriteDataAt(contiguous_bytes(), data, data_len);
+
+  net::Error write_result = WriteToStream(data->data(), data_len);
+  if (write_result != net::OK)
+    return write_result;
+
+  hashed_bytes_ = bytes_so_far_;
+  if (calculate_hash_)
+    hash_stage_->Update(data, data_len);
+
+  return net::OK;
+}
+
+net::Error BaseFile::WriteDataAt(int64 offset,
+                                 net::IOBuffer* data,
+                                 size_t data_len) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
+  DCHECK(!detached_);
+  DCHECK_GE(offset, 0);
+
+  if (!file_stream_.get())
+    return LOG_ERROR("get", net::ERR_INVALID_HANDLE);
+
+  if (data_len == 0)
+    return net::OK;
+
+  // Whatever was written before the first range is one range at the start.
+  if (written_ranges_.empty() && bytes_so_far_ > 0)
+    written_ranges_[0] = bytes_so_far_;
+
+  int64 seek_result = file_stream_->Seek(net::FROM_BEGIN, offset);
+  if (seek_result < 0)
+    return LOG_ERROR("Seek", seek_result);
+
+  net::Error write_result = WriteToStream(data->data(), data_len);
+  if (write_result != net::OK)
+    return write_result;
+
+  // Record [offset, end), merging it with the ranges it touches.
+  int64 start = offset;
+  int64 end = offset + data_len;
+  std::map<int64, int64>::iterator next = written_ranges_.upper_bound(start);
+  if (next != written_ranges_.begin()) {
+    std::map<int64, int64>::iterator previous = next;
+    --previous;
+    DCHECK_LE(previous->second, start) << "Overlapping download ranges";
+    if (previous->second >= start) {
+      start = previous->first;
+      end = std::max(end, previous->second);
+      written_ranges_.erase(previous);
+    }
+  }
+  while (next != written_ranges_.end() && next->first <= end) {
+    end = std::max(end, next->second);
+    written_ranges_.erase(next++);
+  }
+  written_ranges_[start] = end;
+
+  if (!calculate_hash_) {
+    hashed_bytes_ = contiguous_bytes();
+    return net::OK;
+  }
+
+  // The common case is data arriving right where the hash is up to, which
+  // is hashed from memory.  Data that fills a gap before ranges that were
+  // written earlier has those ranges read back.
+  if (offset == hashed_bytes_) {
+    hash_stage_->Update(data, data_len);
+    hashed_bytes_ += data_len;
+  }
+  return HashWrittenRanges();
+}
+
+int64 BaseFile::contiguous_bytes() const {
+  if (written_ranges_.empty())
+    return bytes_so_far_;
+  std::map<int64, int64>::const_iterator first = written_ranges_.begin();
+  return first->first == 0 ? first->second : 0;
+}
+
+net::Error BaseFile::WriteToStream(const char* data, size_t data_len) {
   // The Write call below is not guaranteed to write all the data.
   size_t write_count = 0;
   size_t len = data_len;
@@ -318,12 +542,68 @@ net::Error BaseFile::AppendDataToFile(const char* data, size_t data_len) {
   download_stats::RecordDownloadWriteSize(data_len);
   download_stats::RecordDownloadWriteLoopCount(write_count);
 
-  if (calculate_hash_)
-    secure_hash_->Update(data, data_len);
-
   return net::OK;
 }
 
+net::Error BaseFile::HashWrittenRanges() {
+  int64 end = contiguous_bytes();
+  if (hashed_bytes_ >= end)
+    return net::OK;
+
+  base::PlatformFile file = base::CreatePlatformFile(
+      full_path_, base::PLATFORM_FILE_OPEN | base::PLATFORM_FILE_READ,
+      NULL, NULL);
+  if (file == base::kInvalidPlatformFileValue)
+    return LOG_ERROR("Open for hash", net::ERR_FILE_NOT_FOUND);
+
+  const int kReadSize = 64 * 1024;
+  net::Error result = net::OK;
+  while (hashed_bytes_ < end) {
+    int read_size =
+        static_cast<int>(std::min<int64>(kReadSize, end - hashed_bytes_));
+    // A new buffer each time, as the hash stage holds on to it.
+    scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(read_size));
+    int bytes_read = base::ReadPlatformFile(file, hashed_bytes_,
+                                            buffer->data(), read_size);
+    if (bytes_read <= 0) {
+      result = LOG_ERROR("Read for hash", net::ERR_FAILED);
+      break;
+    }
+    hash_stage_->Update(buffer, bytes_read);
+    hashed_bytes_ += bytes_read;
+  }
+  base::ClosePlatformFile(file);
+  return result;
+}
+
+void BaseFile::Preallocate(int64 total_bytes) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
+  DCHECK(!detached_);
+
+  if (!in_progress() || total_bytes <= bytes_so_far_)
+    return;
+
+#if defined(OS_LINUX)
+  // |file_stream_| doesn't expose its descriptor, so open the file again.
+  int fd = HANDLE_EINTR(open(full_path_.value().c_str(), O_WRONLY));
+  if (fd < 0) {
+    LOG_ERROR("open", net::MapSystemError(errno));
+    return;
+  }
+  // FALLOC_FL_KEEP_SIZE allocates blocks past the end of the file without
+  // moving the end, which is where Open() seeks to when the file is reopened
+  // and what a resumed download starts from.  Not every file system
+  // supports it, and that isn't an error.
+  if (HANDLE_EINTR(fallocate(fd, FALLOC_FL_KEEP_SIZE, bytes_so_far_,
+                             total_bytes - bytes_so_far_)) < 0 &&
+      errno != EOPNOTSUPP) {
+    LOG_ERROR("fallocate", net::MapSystemError(errno));
+  }
+  if (HANDLE_EINTR(close(fd)) < 0)
+    LOG_ERROR("close", net::MapSystemError(errno));
+#endif
+}
+
 net::Error BaseFile::Rename(const FilePath& new_path) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
 
@@ -426,7 +706,7 @@ void BaseFile::Finish() {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
 
   if (calculate_hash_)
-    secure_hash_->Finish(sha256_hash_, kSha256HashLen);
+    hash_stage_->Finish(sha256_hash_, kSha256HashLen);
 
   Close();
 }
@@ -443,7 +723,7 @@ std::string BaseFile::GetHashState() {
     return "";
 
   Pickle hash_state;
-  if (!secure_hash_->Serialize(&hash_state))
+  if (!hash_stage_->Serialize(&hash_state))
     return "";
 
   return std::string(reinterpret_cast<const char*>(hash_state.data()),
@@ -457,7 +737,7 @@ bool BaseFile::SetHashState(const std::string& hash_state_bytes) {
   Pickle hash_state(hash_state_bytes.c_str(), hash_state_bytes.size());
   PickleIterator data_iterator(hash_state);
 
-  return secure_hash_->Deserialize(&data_iterator);
+  return hash_stage_->Deserialize(&data_iterator);
 }
 
 bool BaseFile::IsEmptyHash(const std::string& hash) {
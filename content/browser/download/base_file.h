@@ -6,11 +6,13 @@
 #define CONTENT_BROWSER_DOWNLOAD_BASE_FILE_H_
 #pragma once
 
+#include <map>
 #include <string>
 
 #include "base/file_path.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/linked_ptr.h"
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/time.h"
 #include "content/browser/power_save_blocker.h"
@@ -20,11 +22,9 @@
 #include "net/base/net_errors.h"
 #include "net/base/net_log.h"
 
-namespace crypto {
-class SecureHash;
-}
 namespace net {
 class FileStream;
+class IOBuffer;
 }
 
 // File being downloaded and saved to disk. This is a base class
@@ -44,10 +44,23 @@ class CONTENT_EXPORT BaseFile {
   // Returns net::OK on success, or a network error code on failure.
   net::Error Initialize();
 
-  // Write a new chunk of data to the file.
+  // Write the first |data_len| bytes of |data| to the file.  |data| is kept
+  // until it has been hashed, so it must not be modified afterwards.
   // Returns net::OK on success (all bytes written to the file),
   // or a network error code on failure.
-  net::Error AppendDataToFile(const char* data, size_t data_len);
+  net::Error AppendDataToFile(net::IOBuffer* data, size_t data_len);
+
+  // Writes a chunk of data at |offset|, for downloads that receive
+  // separate byte ranges of the file at once.  Ranges must not overlap.
+  // |data| is kept as by AppendDataToFile().
+  // Returns net::OK on success, or a network error code on failure.
+  net::Error WriteDataAt(int64 offset, net::IOBuffer* data, size_t data_len);
+
+  // Reserves disk space for the rest of a file that is expected to be
+  // |total_bytes| long, so that the file system can lay it out in large
+  // extents rather than growing it one write at a time.  The file's size is
+  // unchanged.  Does nothing where this isn't supported.
+  void Preallocate(int64 total_bytes);
 
   // Rename the download file.
   // Returns net::OK on success, or a network error code on failure.
@@ -72,6 +85,10 @@ class CONTENT_EXPORT BaseFile {
   bool in_progress() const { return file_stream_ != NULL; }
   int64 bytes_so_far() const { return bytes_so_far_; }
 
+  // The length of the data written from the start of the file with no gaps.
+  // The same as bytes_so_far() unless WriteDataAt() has been used.
+  int64 contiguous_bytes() const;
+
   // Fills |hash| with the hash digest for the file.
   // Returns true if digest is successfully calculated.
   virtual bool GetHash(std::string* hash);
@@ -99,6 +116,9 @@ class CONTENT_EXPORT BaseFile {
   friend class BaseFileTest;
   FRIEND_TEST_ALL_PREFIXES(BaseFileTest, IsEmptyHash);
 
+  // Hashes the data written to the file on the blocking pool.
+  class HashStage;
+
   // Split out from CurrentSpeed to enable testing.
   int64 CurrentSpeedAtTime(base::TimeTicks current_time) const;
 
@@ -107,6 +127,13 @@ class CONTENT_EXPORT BaseFile {
 
   net::Error ClearStream(net::Error error);
 
+  // Writes |data| at the current position of |file_stream_|.
+  net::Error WriteToStream(const char* data, size_t data_len);
+
+  // Hashes the data in [|hashed_bytes_|, contiguous_bytes()) that was written
+  // ahead of the hash by WriteDataAt(), reading it back from the file.
+  net::Error HashWrittenRanges();
+
   static const size_t kSha256HashLen = 32;
   static const unsigned char kEmptySha256Hash[kSha256HashLen];
 
@@ -122,6 +149,14 @@ class CONTENT_EXPORT BaseFile {
   // Amount of data received up so far, in bytes.
   int64 bytes_so_far_;
 
+  // The ranges of the file written so far, as start -> end, once
+  // WriteDataAt() has been used.  Adjacent ranges are merged.
+  std::map<int64, int64> written_ranges_;
+
+  // Amount of data from the start of the file that has been hashed.  Only
+  // behind bytes_so_far_ when data has been written out of order.
+  int64 hashed_bytes_;
+
   // Start time for calculating speed.
   base::TimeTicks start_tick_;
 
@@ -133,7 +168,7 @@ class CONTENT_EXPORT BaseFile {
 
   // Used to calculate hash for the file when calculate_hash_
   // is set.
-  scoped_ptr<crypto::SecureHash> secure_hash_;
+  scoped_refptr<HashStage> hash_stage_;
 
   unsigned char sha256_hash_[kSha256HashLen];
 
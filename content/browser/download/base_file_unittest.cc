@@ -4,6 +4,8 @@
 
 #include "content/browser/download/base_file.h"
 
+#include <vector>
+
 #include "base/file_util.h"
 #include "base/logging.h"
 #include "base/message_loop.h"
@@ -13,6 +15,7 @@
 #include "content/browser/browser_thread_impl.h"
 #include "crypto/secure_hash.h"
 #include "net/base/file_stream.h"
+#include "net/base/io_buffer.h"
 #include "net/base/mock_file_stream.h"
 #include "net/base/net_errors.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -34,6 +37,11 @@ const int kElapsedTimeSeconds = 5;
 const base::TimeDelta kElapsedTimeDelta = base::TimeDelta::FromSeconds(
     kElapsedTimeSeconds);
 
+// BaseFile holds on to the data it is given until it has been hashed.
+scoped_refptr<net::IOBuffer> MakeBuffer(const std::string& data) {
+  return new net::StringIOBuffer(data);
+}
+
 }  // namespace
 
 class BaseFileTest : public testing::Test {
@@ -139,7 +147,8 @@ class BaseFileTest : public testing::Test {
     EXPECT_EQ(expect_in_progress_, base_file_->in_progress());
     expected_error_ = mock_file_stream_.get() &&
                       (mock_file_stream_->forced_error() != net::OK);
-    int appended = base_file_->AppendDataToFile(data.data(), data.size());
+    int appended =
+        base_file_->AppendDataToFile(MakeBuffer(data), data.size());
     if (appended == net::OK)
       EXPECT_TRUE(expect_in_progress_)
           << " appended = " << appended;
@@ -173,7 +182,8 @@ class BaseFileTest : public testing::Test {
     file_name = file.full_path();
     EXPECT_NE(FilePath::StringType(), file_name.value());
 
-    EXPECT_EQ(net::OK, file.AppendDataToFile(kTestData4, kTestDataLength4));
+    EXPECT_EQ(net::OK, file.AppendDataToFile(MakeBuffer(kTestData4),
+                                             kTestDataLength4));
 
     // Keep the file from getting deleted when existing_file_name is deleted.
     file.Detach();
@@ -195,7 +205,7 @@ class BaseFileTest : public testing::Test {
                             net::BoundNetLog());
     EXPECT_EQ(net::OK, duplicate_file.Initialize());
     // Write something into it.
-    duplicate_file.AppendDataToFile(kTestData4, kTestDataLength4);
+    duplicate_file.AppendDataToFile(MakeBuffer(kTestData4), kTestDataLength4);
     // Detach the file so it isn't deleted on destruction of |duplicate_file|.
     duplicate_file.Detach();
   }
@@ -416,7 +426,8 @@ TEST_F(BaseFileTest, MultipleWritesInterruptedWithHash) {
                        net::BoundNetLog());
   ASSERT_EQ(net::OK, second_file.Initialize());
   std::string data(kTestData3);
-  EXPECT_EQ(net::OK, second_file.AppendDataToFile(data.data(), data.size()));
+  EXPECT_EQ(net::OK,
+            second_file.AppendDataToFile(MakeBuffer(data), data.size()));
   second_file.Finish();
 
   std::string hash;
@@ -426,6 +437,116 @@ TEST_F(BaseFileTest, MultipleWritesInterruptedWithHash) {
                base::HexEncode(hash.data(), hash.size()).c_str());
 }
 
+// Write enough data that hashing falls behind the writes, so that some of it
+// is hashed on the blocking pool and some by the FILE thread catching up.
+TEST_F(BaseFileTest, ManyWritesWithHash) {
+  const int kWrites = 160;
+  const size_t kWriteSize = 64 * 1024;
+
+  ResetHash();
+  std::vector<std::string> blocks;
+  for (int i = 0; i < kWrites; ++i) {
+    blocks.push_back(std::string(kWriteSize, static_cast<char>('a' + i % 26)));
+    UpdateHash(blocks.back().data(), blocks.back().size());
+  }
+  std::string expected_hash = GetFinalHash();
+
+  MakeFileWithHash();
+  ASSERT_EQ(net::OK, base_file_->Initialize());
+  for (int i = 0; i < kWrites; ++i) {
+    ASSERT_EQ(net::OK, AppendDataToFile(blocks[i]));
+    // The hash state always covers everything written so far.
+    if (i == kWrites / 2)
+      EXPECT_STRNE(std::string().c_str(), base_file_->GetHashState().c_str());
+  }
+  base_file_->Finish();
+
+  std::string hash;
+  EXPECT_TRUE(base_file_->GetHash(&hash));
+  EXPECT_EQ(base::HexEncode(expected_hash.data(), expected_hash.size()),
+            base::HexEncode(hash.data(), hash.size()));
+}
+
+// Preallocating space doesn't change the file's size or what's written to it.
+TEST_F(BaseFileTest, Preallocate) {
+  ASSERT_EQ(net::OK, base_file_->Initialize());
+  ASSERT_EQ(net::OK, AppendDataToFile(kTestData1));
+  base_file_->Preallocate(1024 * 1024);
+  EXPECT_EQ(kTestDataLength1, base_file_->bytes_so_far());
+
+  int64 file_size = 0;
+  EXPECT_TRUE(file_util::GetFileSize(base_file_->full_path(), &file_size));
+  EXPECT_EQ(kTestDataLength1, file_size);
+
+  ASSERT_EQ(net::OK, AppendDataToFile(kTestData2));
+  base_file_->Finish();
+}
+
+// Write ranges of the file out of order.  Only the data with no gaps from the
+// start of the file counts as contiguous.
+TEST_F(BaseFileTest, WriteDataAtOutOfOrder) {
+  const int64 kOffset2 = kTestDataLength1;
+  const int64 kOffset3 = kOffset2 + kTestDataLength2;
+  ASSERT_EQ(net::OK, base_file_->Initialize());
+
+  ASSERT_EQ(net::OK, base_file_->WriteDataAt(kOffset3, MakeBuffer(kTestData3),
+                                             kTestDataLength3));
+  EXPECT_EQ(0, base_file_->contiguous_bytes());
+  EXPECT_EQ(kTestDataLength3, base_file_->bytes_so_far());
+
+  ASSERT_EQ(net::OK, base_file_->WriteDataAt(0, MakeBuffer(kTestData1),
+                                             kTestDataLength1));
+  EXPECT_EQ(kTestDataLength1, base_file_->contiguous_bytes());
+
+  ASSERT_EQ(net::OK, base_file_->WriteDataAt(kOffset2, MakeBuffer(kTestData2),
+                                             kTestDataLength2));
+  EXPECT_EQ(kOffset3 + kTestDataLength3, base_file_->contiguous_bytes());
+
+  set_expected_data(std::string(kTestData1) + kTestData2 + kTestData3);
+  base_file_->Finish();
+}
+
+// Once ranges have been written, appended data goes at the end of the data
+// from the start of the file.
+TEST_F(BaseFileTest, AppendAfterWriteDataAt) {
+  ASSERT_EQ(net::OK, base_file_->Initialize());
+  ASSERT_EQ(net::OK, base_file_->WriteDataAt(kTestDataLength1,
+                                             MakeBuffer(kTestData2),
+                                             kTestDataLength2));
+  ASSERT_EQ(net::OK, base_file_->AppendDataToFile(MakeBuffer(kTestData1),
+                                                  kTestDataLength1));
+  ASSERT_EQ(net::OK, base_file_->AppendDataToFile(MakeBuffer(kTestData3),
+                                                  kTestDataLength3));
+  EXPECT_EQ(base_file_->bytes_so_far(), base_file_->contiguous_bytes());
+
+  set_expected_data(std::string(kTestData1) + kTestData2 + kTestData3);
+  base_file_->Finish();
+}
+
+// The hash of a file written out of order is the hash of its contents.
+TEST_F(BaseFileTest, WriteDataAtWithHash) {
+  const int64 kOffset2 = kTestDataLength1;
+  const int64 kOffset3 = kOffset2 + kTestDataLength2;
+  MakeFileWithHash();
+  ASSERT_EQ(net::OK, base_file_->Initialize());
+
+  // The last range is hashed by reading it back once the gap before it is
+  // filled.
+  ASSERT_EQ(net::OK, base_file_->WriteDataAt(kOffset3, MakeBuffer(kTestData3),
+                                             kTestDataLength3));
+  ASSERT_EQ(net::OK, base_file_->WriteDataAt(0, MakeBuffer(kTestData1),
+                                             kTestDataLength1));
+  ASSERT_EQ(net::OK, base_file_->WriteDataAt(kOffset2, MakeBuffer(kTestData2),
+                                             kTestDataLength2));
+  set_expected_data(std::string(kTestData1) + kTestData2 + kTestData3);
+  base_file_->Finish();
+
+  std::string hash;
+  EXPECT_TRUE(base_file_->GetHash(&hash));
+  EXPECT_EQ("CBF68BF10F8003DB86B31343AFAC8C7175BD03FB5FC905650F8C80AF087443A8",
+            base::HexEncode(hash.data(), hash.size()));
+}
+
 // Rename the file after all writes to it.
 TEST_F(BaseFileTest, WriteThenRename) {
   ASSERT_EQ(net::OK, base_file_->Initialize());
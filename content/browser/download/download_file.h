@@ -14,6 +14,10 @@
 #include "content/public/browser/download_id.h"
 #include "net/base/net_errors.h"
 
+namespace net {
+class IOBuffer;
+}
+
 namespace content {
 
 class DownloadManager;
@@ -33,7 +37,18 @@ class CONTENT_EXPORT DownloadFile {
   // Write a new chunk of data to the file.
   // Returns net::OK on success (all bytes written to the file),
   // or a network error code on failure.
-  virtual net::Error AppendDataToFile(const char* data, size_t data_len) = 0;
+  // |data| is kept until it has been hashed, so it must not be modified
+  // afterwards.
+  virtual net::Error AppendDataToFile(net::IOBuffer* data,
+                                      size_t data_len) = 0;
+
+  // Write a chunk of data at |offset|, for downloads that are received as
+  // several byte ranges at once.
+  // Returns net::OK on success (all bytes written to the file),
+  // or a network error code on failure.
+  virtual net::Error WriteDataAt(int64 offset,
+                                 net::IOBuffer* data,
+                                 size_t data_len) = 0;
 
   // Rename the download file.
   // Returns net::OK on success, or a network error code on failure.
@@ -54,6 +69,9 @@ class CONTENT_EXPORT DownloadFile {
   virtual FilePath FullPath() const = 0;
   virtual bool InProgress() const = 0;
   virtual int64 BytesSoFar() const = 0;
+  // The length of the data received from the start of the file with no
+  // gaps, which is where an interrupted download can be resumed from.
+  virtual int64 ContiguousBytes() const = 0;
   virtual int64 CurrentSpeed() const = 0;
 
   // Set |hash| with sha256 digest for the file.
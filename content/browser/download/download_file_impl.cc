@@ -31,7 +31,8 @@ DownloadFileImpl::DownloadFileImpl(
                 bound_net_log),
           id_(info->download_id),
           request_handle_(request_handle),
-          download_manager_(download_manager) {
+          download_manager_(download_manager),
+          total_bytes_(info->total_bytes) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
 }
 
@@ -41,14 +42,23 @@ DownloadFileImpl::~DownloadFileImpl() {
 
 // BaseFile delegated functions.
 net::Error DownloadFileImpl::Initialize() {
-  return file_.Initialize();
+  net::Error result = file_.Initialize();
+  if (result == net::OK && total_bytes_ > 0)
+    file_.Preallocate(total_bytes_);
+  return result;
 }
 
-net::Error DownloadFileImpl::AppendDataToFile(const char* data,
+net::Error DownloadFileImpl::AppendDataToFile(net::IOBuffer* data,
                                               size_t data_len) {
   return file_.AppendDataToFile(data, data_len);
 }
 
+net::Error DownloadFileImpl::WriteDataAt(int64 offset,
+                                         net::IOBuffer* data,
+                                         size_t data_len) {
+  return file_.WriteDataAt(offset, data, data_len);
+}
+
 net::Error DownloadFileImpl::Rename(const FilePath& full_path) {
   return file_.Rename(full_path);
 }
@@ -81,6 +91,10 @@ int64 DownloadFileImpl::BytesSoFar() const {
   return file_.bytes_so_far();
 }
 
+int64 DownloadFileImpl::ContiguousBytes() const {
+  return file_.contiguous_bytes();
+}
+
 int64 DownloadFileImpl::CurrentSpeed() const {
   return file_.CurrentSpeed();
 }
@@ -31,8 +31,11 @@ class CONTENT_EXPORT DownloadFileImpl : virtual public content::DownloadFile {
 
   // DownloadFile functions.
   virtual net::Error Initialize() OVERRIDE;
-  virtual net::Error AppendDataToFile(const char* data,
+  virtual net::Error AppendDataToFile(net::IOBuffer* data,
                                       size_t data_len) OVERRIDE;
+  virtual net::Error WriteDataAt(int64 offset,
+                                 net::IOBuffer* data,
+                                 size_t data_len) OVERRIDE;
   virtual net::Error Rename(const FilePath& full_path) OVERRIDE;
   virtual void Detach() OVERRIDE;
   virtual void Cancel() OVERRIDE;
@@ -41,6 +44,7 @@ class CONTENT_EXPORT DownloadFileImpl : virtual public content::DownloadFile {
   virtual FilePath FullPath() const OVERRIDE;
   virtual bool InProgress() const OVERRIDE;
   virtual int64 BytesSoFar() const OVERRIDE;
+  virtual int64 ContiguousBytes() const OVERRIDE;
   virtual int64 CurrentSpeed() const OVERRIDE;
   virtual bool GetHash(std::string* hash) OVERRIDE;
   virtual std::string GetHashState() OVERRIDE;
@@ -65,6 +69,9 @@ class CONTENT_EXPORT DownloadFileImpl : virtual public content::DownloadFile {
   // DownloadManager this download belongs to.
   scoped_refptr<content::DownloadManager> download_manager_;
 
+  // Size of the whole download from the response headers, or 0 if unknown.
+  int64 total_bytes_;
+
   DISALLOW_COPY_AND_ASSIGN(DownloadFileImpl);
 };
 
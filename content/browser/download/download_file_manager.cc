@@ -164,13 +164,16 @@ void DownloadFileManager::UpdateInProgressDownloads() {
     DownloadFile* download_file = i->second;
     DownloadManager* manager = download_file->GetDownloadManager();
     if (manager) {
+      // Progress stops at the first range that hasn't arrived.  No hash
+      // state is sent: getting it would first hash everything still queued,
+      // on this thread.  Interrupts and completion carry it instead.
       BrowserThread::PostTask(BrowserThread::UI, FROM_HERE,
           base::Bind(&DownloadManager::UpdateDownload,
                      manager,
                      global_id.local(),
-                     download_file->BytesSoFar(),
+                     download_file->ContiguousBytes(),
                      download_file->CurrentSpeed(),
-                     download_file->GetHashState()));
+                     std::string()));
     }
   }
 }
@@ -202,50 +205,71 @@ void DownloadFileManager::StartDownload(
 // DownloadFile has been deleted.
 void DownloadFileManager::UpdateDownload(
     DownloadId global_id, content::DownloadBuffer* buffer) {
+  WriteBufferContents(global_id, -1, buffer);
+}
+
+void DownloadFileManager::UpdateDownloadAt(
+    DownloadId global_id, int64 offset, content::DownloadBuffer* buffer) {
+  DCHECK_GE(offset, 0);
+  WriteBufferContents(global_id, offset, buffer);
+}
+
+void DownloadFileManager::WriteBufferContents(
+    DownloadId global_id, int64 offset, content::DownloadBuffer* buffer) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
   scoped_ptr<content::ContentVector> contents(buffer->ReleaseContents());
 
   download_stats::RecordFileThreadReceiveBuffers(contents->size());
 
   DownloadFile* download_file = GetDownloadFile(global_id);
-  bool had_error = false;
-  for (size_t i = 0; i < contents->size(); ++i) {
-    net::IOBuffer* data = (*contents)[i].first;
-    const int data_len = (*contents)[i].second;
-    if (!had_error && download_file) {
-      net::Error write_result =
-          download_file->AppendDataToFile(data->data(), data_len);
-      if (write_result != net::OK) {
-        // Write failed: interrupt the download.
-        DownloadManager* download_manager =
-            download_file->GetDownloadManager();
-        had_error = true;
-
-        int64 bytes_downloaded = download_file->BytesSoFar();
-        std::string hash_state(download_file->GetHashState());
-
-        // Calling this here in case we get more data, to avoid
-        // processing data after an error.  That could lead to
-        // files that are corrupted if the later processing succeeded.
-        CancelDownload(global_id);
-        download_file = NULL;  // Was deleted in |CancelDownload|.
-
-        if (download_manager) {
-          BrowserThread::PostTask(
-              BrowserThread::UI, FROM_HERE,
-              base::Bind(&DownloadManager::OnDownloadInterrupted,
-                         download_manager,
-                         global_id.local(),
-                         bytes_downloaded,
-                         hash_state,
-                         content::ConvertNetErrorToInterruptReason(
-                             write_result,
-                             content::DOWNLOAD_INTERRUPT_FROM_DISK)));
-        }
+  if (download_file && !contents->empty()) {
+    // Write everything that has arrived since the last update with one call,
+    // rather than one per network read.  The file hashes |data| in place, so
+    // a single read is written and hashed without being copied.
+    scoped_refptr<net::IOBuffer> data;
+    size_t data_len = 0;
+    if (contents->size() == 1) {
+      data = contents->front().first;
+      data_len = contents->front().second;
+    } else {
+      data = content::AssembleData(*contents, &data_len);
+    }
+
+    net::Error write_result = net::OK;
+    if (data_len > 0 && offset < 0) {
+      write_result = download_file->AppendDataToFile(data, data_len);
+    } else if (data_len > 0) {
+      write_result = download_file->WriteDataAt(offset, data, data_len);
+    }
+    if (write_result != net::OK) {
+      // Write failed: interrupt the download.
+      DownloadManager* download_manager = download_file->GetDownloadManager();
+
+      int64 bytes_downloaded = download_file->ContiguousBytes();
+      std::string hash_state(download_file->GetHashState());
+
+      // Calling this here in case we get more data, to avoid
+      // processing data after an error.  That could lead to
+      // files that are corrupted if the later processing succeeded.
+      CancelDownload(global_id);  // Deletes |download_file|.
+
+      if (download_manager) {
+        BrowserThread::PostTask(
+            BrowserThread::UI, FROM_HERE,
+            base::Bind(&DownloadManager::OnDownloadInterrupted,
+                       download_manager,
+                       global_id.local(),
+                       bytes_downloaded,
+                       hash_state,
+                       content::ConvertNetErrorToInterruptReason(
+                           write_result,
+                           content::DOWNLOAD_INTERRUPT_FROM_DISK)));
       }
     }
-    data->Release();
   }
+
+  for (size_t i = 0; i < contents->size(); ++i)
+    (*contents)[i].first->Release();
 }
 
 void DownloadFileManager::OnResponseCompleted(
@@ -286,7 +310,7 @@ void DownloadFileManager::OnResponseCompleted(
         base::Bind(&DownloadManager::OnDownloadInterrupted,
                    download_manager,
                    global_id.local(),
-                   download_file->BytesSoFar(),
+                   download_file->ContiguousBytes(),
                    download_file->GetHashState(),
                    reason));
   }
@@ -469,7 +493,7 @@ void DownloadFileManager::CancelDownloadOnRename(
       base::Bind(&DownloadManager::OnDownloadInterrupted,
                  download_manager,
                  global_id.local(),
-                 download_file->BytesSoFar(),
+                 download_file->ContiguousBytes(),
                  download_file->GetHashState(),
                  content::ConvertNetErrorToInterruptReason(
                      rename_error,
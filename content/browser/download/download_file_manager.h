@@ -102,6 +102,14 @@ class CONTENT_EXPORT DownloadFileManager
   void UpdateDownload(content::DownloadId global_id,
                       content::DownloadBuffer* buffer);
 
+  // Like UpdateDownload, for one of the byte ranges of a download that is
+  // received over several requests.  The data in |buffer| is written to the
+  // file starting at |offset|, so a range's request posts one of these each
+  // time its buffer goes from empty to non-empty.
+  void UpdateDownloadAt(content::DownloadId global_id,
+                        int64 offset,
+                        content::DownloadBuffer* buffer);
+
   // |reason| is the reason for interruption, if one occurs.
   // |security_info| contains SSL information (cert_id, cert_status,
   // security_bits, ssl_connection_status), which can be used to
@@ -174,6 +182,12 @@ class CONTENT_EXPORT DownloadFileManager
                           bool hash_needed,
                           const net::BoundNetLog& bound_net_log);
 
+  // Writes out the contents of |buffer|, appending them to the file if
+  // |offset| is negative.  Interrupts the download on a write error.
+  void WriteBufferContents(content::DownloadId global_id,
+                           int64 offset,
+                           content::DownloadBuffer* buffer);
+
   // Called only on the download thread.
   content::DownloadFile* GetDownloadFile(content::DownloadId global_id);
 
@@ -29,12 +29,31 @@ using content::MockDownloadManager;
 
 using ::testing::_;
 using ::testing::AtLeast;
+using ::testing::Invoke;
 using ::testing::Mock;
 using ::testing::Return;
-using ::testing::StrEq;
 
 namespace {
 
+// Records what is appended to a MockDownloadFile.
+// Matches an IOBuffer that starts with the |length| bytes at |data|.
+MATCHER_P2(IOBufferStartsWith, data, length, "") {
+  return memcmp(arg->data(), data, length) == 0;
+}
+
+class AppendedData {
+ public:
+  net::Error Append(net::IOBuffer* data, size_t data_len) {
+    data_.append(data->data(), data_len);
+    return net::OK;
+  }
+
+  const std::string& data() const { return data_; }
+
+ private:
+  std::string data_;
+};
+
 class MockDownloadFileFactory :
     public DownloadFileManager::DownloadFileFactory {
 
@@ -230,7 +249,7 @@ class DownloadFileManagerTest : public testing::Test {
     //
     //    On error:
     //      DownloadFile::GetDownloadManager
-    //      DownloadFile::BytesSoFar
+    //      DownloadFile::ContiguousBytes
     //      CancelDownload
     //  Process one message in the message loop
     //      DownloadManager::OnDownloadInterrupted
@@ -239,19 +258,15 @@ class DownloadFileManagerTest : public testing::Test {
     ASSERT_TRUE(file != NULL);
     byte_count_[id] += length;
 
-    // Make sure our comparison string is NULL-terminated.
-    char* expected_data = new char[length + 1];
-    memcpy(expected_data, data, length);
-    expected_data[length] = 0;
-
-    EXPECT_CALL(*file, AppendDataToFile(StrEq(expected_data), length))
+    EXPECT_CALL(*file, AppendDataToFile(IOBufferStartsWith(data, length),
+                                        length))
         .Times(1)
         .WillOnce(Return(error_to_insert));
 
     if (error_to_insert != net::OK) {
       EXPECT_CALL(*file, GetDownloadManager())
           .Times(AtLeast(1));
-      EXPECT_CALL(*file, BytesSoFar())
+      EXPECT_CALL(*file, ContiguousBytes())
           .Times(AtLeast(1))
           .WillRepeatedly(Return(byte_count_[id]));
       EXPECT_CALL(*file, GetHashState())
@@ -307,7 +322,7 @@ class DownloadFileManagerTest : public testing::Test {
     //        No Manager:
     //          DownloadFile::CancelDownloadRequest/return
     //        Has Manager:
-    //          DownloadFile::BytesSoFar
+    //          DownloadFile::ContiguousBytes
     //  Process one message in the message loop
     //          DownloadManager::OnDownloadInterrupted
     //
@@ -327,7 +342,7 @@ class DownloadFileManagerTest : public testing::Test {
         .WillOnce(Return(rename_error));
 
     if (rename_error != net::OK) {
-      EXPECT_CALL(*file, BytesSoFar())
+      EXPECT_CALL(*file, ContiguousBytes())
           .Times(AtLeast(1))
           .WillRepeatedly(Return(byte_count_[id]));
       EXPECT_CALL(*file, GetHashState())
@@ -371,7 +386,7 @@ class DownloadFileManagerTest : public testing::Test {
     //    GetDownloadFile
     //    DownloadFile::Finish
     //    DownloadFile::GetDownloadManager
-    //    DownloadFile::BytesSoFar
+    //    DownloadFile::BytesSoFar, or ContiguousBytes on error
     //  Process one message in the message loop
     //
     //    OK:
@@ -388,12 +403,15 @@ class DownloadFileManagerTest : public testing::Test {
     if (reason == content::DOWNLOAD_INTERRUPT_REASON_NONE) {
       EXPECT_CALL(*file, GetHash(_))
           .WillOnce(Return(false));
+      EXPECT_CALL(*file, BytesSoFar())
+          .Times(AtLeast(1))
+          .WillRepeatedly(Return(byte_count_[id]));
     } else {
       EXPECT_CALL(*file, GetHashState());
+      EXPECT_CALL(*file, ContiguousBytes())
+          .Times(AtLeast(1))
+          .WillRepeatedly(Return(byte_count_[id]));
     }
-    EXPECT_CALL(*file, BytesSoFar())
-        .Times(AtLeast(1))
-        .WillRepeatedly(Return(byte_count_[id]));
 
     download_file_manager_->OnResponseCompleted(id, reason, security_string);
 
@@ -494,6 +512,33 @@ TEST_F(DownloadFileManagerTest, CancelBeforeFinished) {
   CleanUp(dummy_id);
 }
 
+// Buffers that arrive between updates are written to the file in one call.
+TEST_F(DownloadFileManagerTest, CoalescedWrites) {
+  DownloadCreateInfo* info = new DownloadCreateInfo;
+  DownloadId dummy_id(download_manager_.get(), kDummyDownloadId);
+
+  StartDownload(info, dummy_id);
+
+  EXPECT_TRUE(UpdateBuffer(kTestData1, strlen(kTestData1)));
+  EXPECT_TRUE(UpdateBuffer(kTestData2, strlen(kTestData2)));
+  EXPECT_TRUE(UpdateBuffer(kTestData3, strlen(kTestData3)));
+  std::string expected_data =
+      std::string(kTestData1) + kTestData2 + kTestData3;
+  byte_count_[dummy_id] += expected_data.size();
+
+  MockDownloadFile* file = download_file_factory_->GetExistingFile(dummy_id);
+  ASSERT_TRUE(file != NULL);
+  AppendedData appended;
+  EXPECT_CALL(*file, AppendDataToFile(_, expected_data.size()))
+      .Times(1)
+      .WillOnce(Invoke(&appended, &AppendedData::Append));
+  download_file_manager_->UpdateDownload(dummy_id, download_buffer_.get());
+  EXPECT_EQ(expected_data, appended.data());
+  ClearExpectations(dummy_id);
+
+  CleanUp(dummy_id);
+}
+
 TEST_F(DownloadFileManagerTest, DownloadWithError) {
   // Same as StartDownload, at first.
   DownloadCreateInfo* info = new DownloadCreateInfo;
@@ -12,6 +12,7 @@
 #include "content/public/browser/download_manager.h"
 #include "content/test/mock_download_manager.h"
 #include "net/base/file_stream.h"
+#include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -101,7 +102,8 @@ class DownloadFileTest : public testing::Test {
   void AppendDataToFile(scoped_ptr<DownloadFile>* file,
                         const std::string& data) {
     EXPECT_TRUE((*file)->InProgress());
-    (*file)->AppendDataToFile(data.data(), data.size());
+    (*file)->AppendDataToFile(make_scoped_refptr(new net::StringIOBuffer(data)),
+                              data.size());
     expected_data_ += data;
     EXPECT_EQ(static_cast<int64>(expected_data_.size()),
               (*file)->BytesSoFar());
@@ -320,7 +320,7 @@ class DownloadFileWithErrors : public DownloadFileImpl {
 
   // BaseFile delegated functions.
   virtual net::Error Initialize();
-  virtual net::Error AppendDataToFile(const char* data, size_t data_len);
+  virtual net::Error AppendDataToFile(net::IOBuffer* data, size_t data_len);
   virtual net::Error Rename(const FilePath& full_path);
 
   void set_forced_error(net::Error error) { forced_error_ = error; }
@@ -356,7 +356,7 @@ net::Error DownloadFileWithErrors::Initialize() {
   return ReturnError(DownloadFileImpl::Initialize());
 }
 
-net::Error DownloadFileWithErrors::AppendDataToFile(const char* data,
+net::Error DownloadFileWithErrors::AppendDataToFile(net::IOBuffer* data,
                                                     size_t data_len) {
   return ReturnError(DownloadFileImpl::AppendDataToFile(data, data_len));
 }
@@ -961,7 +961,8 @@ TEST_F(DownloadManagerTest, DownloadInterruptTest) {
   EXPECT_EQ(DownloadItem::IN_PROGRESS, download->GetState());
   scoped_ptr<ItemObserver> observer(new ItemObserver(download));
 
-  download_file->AppendDataToFile(kTestData, kTestDataLen);
+  download_file->AppendDataToFile(
+      make_scoped_refptr(new net::StringIOBuffer(kTestData)), kTestDataLen);
 
   ContinueDownloadWithPath(download, new_path);
   message_loop_.RunAllPending();
@@ -1109,7 +1110,8 @@ TEST_F(DownloadManagerTest, DownloadCancelTest) {
   message_loop_.RunAllPending();
   EXPECT_TRUE(GetActiveDownloadItem(0) != NULL);
 
-  download_file->AppendDataToFile(kTestData, kTestDataLen);
+  download_file->AppendDataToFile(
+      make_scoped_refptr(new net::StringIOBuffer(kTestData)), kTestDataLen);
 
   download->Cancel(false);
   message_loop_.RunAllPending();
@@ -1194,7 +1196,8 @@ TEST_F(DownloadManagerTest, MAYBE_DownloadOverwriteTest) {
   message_loop_.RunAllPending();
   EXPECT_TRUE(GetActiveDownloadItem(0) != NULL);
 
-  download_file->AppendDataToFile(kTestData, kTestDataLen);
+  download_file->AppendDataToFile(
+      make_scoped_refptr(new net::StringIOBuffer(kTestData)), kTestDataLen);
 
   // Finish the download.
   OnResponseCompleted(0, kTestDataLen, "");
@@ -1268,7 +1271,8 @@ TEST_F(DownloadManagerTest, MAYBE_DownloadRemoveTest) {
   message_loop_.RunAllPending();
   EXPECT_TRUE(GetActiveDownloadItem(0) != NULL);
 
-  download_file->AppendDataToFile(kTestData, kTestDataLen);
+  download_file->AppendDataToFile(
+      make_scoped_refptr(new net::StringIOBuffer(kTestData)), kTestDataLen);
 
   // Finish the download.
   OnResponseCompleted(0, kTestDataLen, "");
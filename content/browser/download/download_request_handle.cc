@@ -6,8 +6,10 @@
 
 #include "base/bind.h"
 #include "base/stringprintf.h"
+#include "content/browser/download/download_resource_handler.h"
 #include "content/browser/renderer_host/render_view_host_impl.h"
 #include "content/browser/renderer_host/resource_dispatcher_host_impl.h"
+#include "content/browser/renderer_host/resource_request_info_impl.h"
 #include "content/browser/tab_contents/tab_contents.h"
 #include "content/public/browser/browser_context.h"
 #include "content/public/browser/browser_thread.h"
@@ -16,6 +18,7 @@ using content::BrowserThread;
 using content::DownloadManager;
 using content::RenderViewHostImpl;
 using content::ResourceDispatcherHostImpl;
+using content::ResourceRequestInfoImpl;
 
 // IO Thread indirections to resource dispatcher host.
 // Provided as targets for PostTask from within this object
@@ -25,9 +28,21 @@ static void DoPauseRequest(
     int request_id,
     bool pause) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
-  ResourceDispatcherHostImpl::Get()->PauseRequest(process_unique_id,
-                                                  request_id,
-                                                  pause);
+  ResourceDispatcherHostImpl* resource_dispatcher_host =
+      ResourceDispatcherHostImpl::Get();
+  resource_dispatcher_host->PauseRequest(process_unique_id,
+                                         request_id,
+                                         pause);
+
+  // A download split into byte ranges has to pause its range requests too.
+  net::URLRequest* request = resource_dispatcher_host->GetURLRequest(
+      content::GlobalRequestID(process_unique_id, request_id));
+  if (!request)
+    return;
+  DownloadResourceHandler* handler =
+      ResourceRequestInfoImpl::ForRequest(request)->download_handler();
+  if (handler)
+    handler->PauseRangeRequests(pause);
 }
 
 static void DoCancelRequest(
@@ -7,9 +7,12 @@
 #include <string>
 
 #include "base/bind.h"
+#include "base/command_line.h"
 #include "base/logging.h"
 #include "base/metrics/histogram.h"
 #include "base/metrics/stats_counters.h"
+#include "base/string_number_conversions.h"
+#include "base/string_util.h"
 #include "base/stringprintf.h"
 #include "content/browser/download/download_buffer.h"
 #include "content/browser/download/download_create_info.h"
@@ -24,9 +27,12 @@
 #include "content/public/browser/download_interrupt_reasons.h"
 #include "content/public/browser/download_item.h"
 #include "content/public/browser/download_manager_delegate.h"
+#include "content/public/common/content_switches.h"
 #include "content/public/common/resource_response.h"
 #include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
+#include "net/http/http_byte_range.h"
+#include "net/http/http_request_headers.h"
 #include "net/http/http_response_headers.h"
 #include "net/url_request/url_request_context.h"
 
@@ -39,6 +45,9 @@ using content::ResourceRequestInfoImpl;
 
 namespace {
 
+// Ranges are no smaller than this, so small downloads aren't split.
+const int64 kMinRangeSize = 64 * 1024;
+
 void CallStartedCBOnUIThread(
     const DownloadResourceHandler::OnStartedCallback& started_cb,
     DownloadId id,
@@ -71,10 +80,50 @@ DownloadResourceHandler::DownloadResourceHandler(
       buffer_(new content::DownloadBuffer),
       is_paused_(false),
       last_buffer_size_(0),
-      bytes_read_(0) {
+      bytes_read_(0),
+      is_range_request_(false),
+      range_offset_(-1),
+      range_length_(0),
+      range_start_error_(content::DOWNLOAD_INTERRUPT_REASON_NONE),
+      user_pause_count_(0),
+      range_done_(false),
+      finishing_ranges_(false),
+      ranges_error_(content::DOWNLOAD_INTERRUPT_REASON_NONE) {
   download_stats::RecordDownloadCount(download_stats::UNTHROTTLED_COUNT);
 }
 
+DownloadResourceHandler::DownloadResourceHandler(
+    int render_process_host_id,
+    int render_view_id,
+    int request_id,
+    DownloadFileManager* download_file_manager,
+    net::URLRequest* request,
+    DownloadResourceHandler* parent,
+    int64 range_offset,
+    int64 range_length)
+    : download_id_(parent->download_id_),
+      global_id_(render_process_host_id, request_id),
+      render_view_id_(render_view_id),
+      content_length_(0),
+      download_file_manager_(download_file_manager),
+      request_(request),
+      buffer_(new content::DownloadBuffer),
+      is_paused_(false),
+      last_buffer_size_(0),
+      bytes_read_(0),
+      is_range_request_(true),
+      range_offset_(range_offset),
+      range_length_(range_length),
+      parent_(parent),
+      range_start_error_(content::DOWNLOAD_INTERRUPT_REASON_NONE),
+      user_pause_count_(0),
+      range_done_(false),
+      finishing_ranges_(false),
+      ranges_error_(content::DOWNLOAD_INTERRUPT_REASON_NONE) {
+  DCHECK(download_id_.IsValid());
+  DCHECK_GT(range_length, 0);
+}
+
 bool DownloadResourceHandler::OnUploadProgress(int request_id,
                                                uint64 position,
                                                uint64 size) {
@@ -87,6 +136,13 @@ bool DownloadResourceHandler::OnRequestRedirected(
     const GURL& url,
     content::ResourceResponse* response,
     bool* defer) {
+  // Range requests go straight to the URL the main request ended up at, and
+  // skip the checks the main request's redirects went through, so one that
+  // is redirected is not followed.
+  if (is_range_request()) {
+    range_start_error_ = content::DOWNLOAD_INTERRUPT_REASON_SERVER_FAILED;
+    return false;
+  }
   return true;
 }
 
@@ -98,6 +154,9 @@ bool DownloadResourceHandler::OnResponseStarted(
            << " request_id = " << request_id;
   download_start_time_ = base::TimeTicks::Now();
 
+  if (is_range_request())
+    return OnRangeResponseStarted(response);
+
   if (request_->url().scheme() == "file" ||
       request_->url().scheme() == "data") {
     CallStartedCB(download_id_, net::ERR_DISALLOWED_URL_SCHEME);
@@ -160,6 +219,8 @@ bool DownloadResourceHandler::OnResponseStarted(
     accept_ranges_ = "";
   }
 
+  SetUpRanges(response, headers);
+
   info->prompt_user_for_save_location =
       save_info_.prompt_for_save_location && save_info_.file_path.empty();
   info->referrer_charset = request_->context()->referrer_charset();
@@ -226,8 +287,19 @@ bool DownloadResourceHandler::OnReadCompleted(int request_id, int* bytes_read) {
   }
   last_read_time_ = now;
 
+  // The download file exists once the request has been resumed, so the
+  // range requests can start writing to it.
+  if (!ranges_to_start_.empty() && !StartRangeRequests())
+    return false;
+
+  // Drop anything past the end of this request's range; it belongs to
+  // another request.
+  if (range_offset_ >= 0 && bytes_read_ + *bytes_read > range_length_)
+    *bytes_read = static_cast<int>(range_length_ - bytes_read_);
+
   if (!*bytes_read)
     return true;
+  int64 write_offset = range_offset_ + bytes_read_;
   bytes_read_ += *bytes_read;
   DCHECK(read_buffer_);
   // Swap the data.
@@ -237,7 +309,13 @@ bool DownloadResourceHandler::OnReadCompleted(int request_id, int* bytes_read) {
   bool need_update = (vector_size == 1);  // Buffer was empty.
 
   // We are passing ownership of this buffer to the download file manager.
-  if (need_update) {
+  if (need_update && range_offset_ >= 0) {
+    BrowserThread::PostTask(
+        BrowserThread::FILE, FROM_HERE,
+        base::Bind(&DownloadFileManager::UpdateDownloadAt,
+                   download_file_manager_, download_id_, write_offset,
+                   buffer_));
+  } else if (need_update) {
     BrowserThread::PostTask(
         BrowserThread::FILE, FROM_HERE,
         base::Bind(&DownloadFileManager::UpdateDownload,
@@ -249,6 +327,23 @@ bool DownloadResourceHandler::OnReadCompleted(int request_id, int* bytes_read) {
   if (vector_size > kLoadsToWrite)
     StartPauseTimer();
 
+  // The main request of a split download stops once its own range is in,
+  // and ends when the range requests have finished too.
+  if (!is_range_request() && range_offset_ >= 0 &&
+      bytes_read_ == range_length_ && !range_done_) {
+    range_done_ = true;
+    if (range_request_ids_.empty() && ranges_to_start_.empty()) {
+      finishing_ranges_ = true;
+      return false;
+    }
+    if (!is_paused_) {
+      ResourceDispatcherHostImpl::Get()->PauseRequest(global_id_.child_id,
+                                                      global_id_.request_id,
+                                                      true);
+      is_paused_ = true;
+    }
+  }
+
   return true;
 }
 
@@ -260,7 +355,9 @@ bool DownloadResourceHandler::OnResponseCompleted(
            << " request_id = " << request_id
            << " status.status() = " << status.status()
            << " status.error() = " << status.error();
-  if (download_id_.IsValid()) {
+  if (is_range_request()) {
+    OnRangeResponseCompleted(status);
+  } else if (download_id_.IsValid()) {
     OnResponseCompletedInternal(request_id, status, security_info);
   } else {
     // We got cancelled before the task which sets the id ran on the IO thread.
@@ -284,18 +381,54 @@ void DownloadResourceHandler::OnResponseCompletedInternal(
            << " status.status() = " << status.status()
            << " status.error() = " << status.error();
   net::Error error_code = net::OK;
+  content::DownloadInterruptReason reason =
+      GetInterruptReason(status, &error_code);
+
+  if (range_offset_ >= 0) {
+    if (finishing_ranges_) {
+      // This request was ended here, once the ranges had finished or one of
+      // them had failed.
+      reason = ranges_error_;
+    } else {
+      // This request ended before the ranges did.
+      if (reason == content::DOWNLOAD_INTERRUPT_REASON_NONE)
+        reason = content::DOWNLOAD_INTERRUPT_REASON_NETWORK_FAILED;
+      CancelRangeRequests();
+    }
+  }
+
+  download_stats::RecordAcceptsRanges(accept_ranges_, bytes_read_);
+
+  // If the callback was already run on the UI thread, this will be a noop.
+  CallStartedCB(download_id_, error_code);
+
+  // We transfer ownership to |DownloadFileManager| to delete |buffer_|,
+  // so that any functions queued up on the FILE thread are executed
+  // before deletion.
+  BrowserThread::PostTask(
+      BrowserThread::FILE, FROM_HERE,
+      base::Bind(&DownloadFileManager::OnResponseCompleted,
+                 download_file_manager_, download_id_, reason, security_info));
+  buffer_ = NULL;  // The buffer is longer needed by |DownloadResourceHandler|.
+  read_buffer_ = NULL;
+}
+
+content::DownloadInterruptReason DownloadResourceHandler::GetInterruptReason(
+    const net::URLRequestStatus& status,
+    net::Error* error_code) {
+  *error_code = net::OK;
   if (status.status() == net::URLRequestStatus::FAILED)
-    error_code = static_cast<net::Error>(status.error());  // Normal case.
+    *error_code = static_cast<net::Error>(status.error());  // Normal case.
   // ERR_CONNECTION_CLOSED is allowed since a number of servers in the wild
   // advertise a larger Content-Length than the amount of bytes in the message
   // body, and then close the connection. Other browsers - IE8, Firefox 4.0.1,
   // and Safari 5.0.4 - treat the download as complete in this case, so we
   // follow their lead.
-  if (error_code == net::ERR_CONNECTION_CLOSED)
-    error_code = net::OK;
+  if (*error_code == net::ERR_CONNECTION_CLOSED)
+    *error_code = net::OK;
   content::DownloadInterruptReason reason =
       content::ConvertNetErrorToInterruptReason(
-        error_code, content::DOWNLOAD_INTERRUPT_FROM_NETWORK);
+        *error_code, content::DOWNLOAD_INTERRUPT_FROM_NETWORK);
 
   if ((status.status() == net::URLRequestStatus::CANCELED) &&
       (status.error() == net::ERR_ABORTED)) {
@@ -324,20 +457,7 @@ void DownloadResourceHandler::OnResponseCompletedInternal(
     }
   }
 
-  download_stats::RecordAcceptsRanges(accept_ranges_, bytes_read_);
-
-  // If the callback was already run on the UI thread, this will be a noop.
-  CallStartedCB(download_id_, error_code);
-
-  // We transfer ownership to |DownloadFileManager| to delete |buffer_|,
-  // so that any functions queued up on the FILE thread are executed
-  // before deletion.
-  BrowserThread::PostTask(
-      BrowserThread::FILE, FROM_HERE,
-      base::Bind(&DownloadFileManager::OnResponseCompleted,
-                 download_file_manager_, download_id_, reason, security_info));
-  buffer_ = NULL;  // The buffer is longer needed by |DownloadResourceHandler|.
-  read_buffer_ = NULL;
+  return reason;
 }
 
 void DownloadResourceHandler::OnRequestClosed() {
@@ -394,7 +514,8 @@ void DownloadResourceHandler::CheckWriteProgress() {
 
   size_t contents_size = buffer_->size();
 
-  bool should_pause = contents_size > kLoadsToWrite;
+  // A main request that has all of its range stays paused.
+  bool should_pause = contents_size > kLoadsToWrite || range_done_;
 
   // We'll come back later and see if it's okay to unpause the request.
   if (should_pause)
@@ -408,6 +529,227 @@ void DownloadResourceHandler::CheckWriteProgress() {
   }
 }
 
+void DownloadResourceHandler::OnRangeCompleted(
+    int request_id,
+    content::DownloadInterruptReason reason) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  range_request_ids_.erase(request_id);
+  if (finishing_ranges_ || !buffer_.get())
+    return;  // This request has already ended, or is ending.
+
+  if (reason != content::DOWNLOAD_INTERRUPT_REASON_NONE) {
+    // The file can't be completed, so interrupt the download with the first
+    // range's error.
+    ranges_error_ = reason;
+    finishing_ranges_ = true;
+    CancelRangeRequests();
+    ResourceDispatcherHostImpl::Get()->CancelRequest(global_id_.child_id,
+                                                     global_id_.request_id,
+                                                     false);
+    return;
+  }
+  MaybeFinishRanges();
+}
+
+bool DownloadResourceHandler::OnRangeResponseStarted(
+    content::ResourceResponse* response) {
+  request_->StopCaching();
+
+  // The server must send exactly the range that was asked for.  A 200 means
+  // the If-Range validator no longer matches, so the file has changed.
+  int64 first_byte = -1;
+  int64 last_byte = -1;
+  int64 instance_length = -1;
+  const net::HttpResponseHeaders* headers = request_->response_headers();
+  if (!headers || headers->response_code() != 206) {
+    range_start_error_ = content::DOWNLOAD_INTERRUPT_REASON_SERVER_PRECONDITION;
+    return false;
+  }
+  if (!headers->GetContentRange(&first_byte, &last_byte, &instance_length) ||
+      first_byte != range_offset_ ||
+      last_byte != range_offset_ + range_length_ - 1 ||
+      headers->HasHeader("Content-Encoding")) {
+    range_start_error_ = content::DOWNLOAD_INTERRUPT_REASON_SERVER_NO_RANGE;
+    return false;
+  }
+  return true;
+}
+
+void DownloadResourceHandler::OnRangeResponseCompleted(
+    const net::URLRequestStatus& status) {
+  net::Error error_code = net::OK;
+  content::DownloadInterruptReason reason =
+      GetInterruptReason(status, &error_code);
+  if (range_start_error_ != content::DOWNLOAD_INTERRUPT_REASON_NONE)
+    reason = range_start_error_;
+  else if (reason == content::DOWNLOAD_INTERRUPT_REASON_NONE &&
+           bytes_read_ != range_length_)
+    reason = content::DOWNLOAD_INTERRUPT_REASON_NETWORK_FAILED;
+
+  // Anything still queued for the FILE thread holds its own reference to
+  // |buffer_|, and is written before the parent's completion is handled.
+  buffer_ = NULL;
+  read_buffer_ = NULL;
+
+  scoped_refptr<DownloadResourceHandler> parent;
+  parent.swap(parent_);
+  parent->OnRangeCompleted(global_id_.request_id, reason);
+}
+
+void DownloadResourceHandler::SetUpRanges(
+    const content::ResourceResponse* response,
+    const net::HttpResponseHeaders* headers) {
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  int max_requests = 0;
+  if (!base::StringToInt(command_line.GetSwitchValueASCII(
+          switches::kParallelDownloadRequests), &max_requests) ||
+      max_requests < 2) {
+    return;
+  }
+
+  // Only a plain GET of a whole file, of known length.
+  if (!headers || request_->method() != "GET" || save_info_.offset != 0 ||
+      response->content_length <= 0) {
+    return;
+  }
+  range_validator_ = GetRangeValidator(*headers);
+  if (range_validator_.empty())
+    return;
+
+  int64 total = response->content_length;
+  int64 count = std::min<int64>(max_requests, total / kMinRangeSize);
+  if (count < 2)
+    return;
+  int64 range_size = total / count;
+  for (int64 i = 1; i < count; ++i) {
+    int64 offset = i * range_size;
+    int64 length = (i == count - 1) ? total - offset : range_size;
+    ranges_to_start_.push_back(std::make_pair(offset, length));
+  }
+  range_offset_ = 0;
+  range_length_ = range_size;
+
+  // Lets the user's pauses reach the range requests.
+  ResourceRequestInfoImpl::ForRequest(request_)->set_download_handler(this);
+}
+
+// static
+std::string DownloadResourceHandler::GetRangeValidator(
+    const net::HttpResponseHeaders& headers) {
+  // The server has to take byte ranges of the file as it is stored.  Ranges
+  // of a content-encoded response are ranges of the encoded body, and a
+  // server that encodes on the fly may encode each range differently, so the
+  // pieces wouldn't decode into the file.
+  std::string accept_ranges;
+  if (headers.response_code() != 200 ||
+      !headers.EnumerateHeader(NULL, "Accept-Ranges", &accept_ranges) ||
+      accept_ranges != "bytes" ||
+      headers.HasHeader("Content-Encoding")) {
+    return std::string();
+  }
+
+  // It also has to be able to say whether the file has changed since.
+  // If-Range takes a strong ETag or a date.
+  std::string etag;
+  std::string last_modified;
+  headers.EnumerateHeader(NULL, "ETag", &etag);
+  headers.EnumerateHeader(NULL, "Last-Modified", &last_modified);
+  if (!etag.empty() && !StartsWithASCII(etag, "W/", true))
+    return etag;
+  if (!last_modified.empty() && headers.HasStrongValidators())
+    return last_modified;
+  return std::string();
+}
+
+bool DownloadResourceHandler::StartRangeRequests() {
+  DCHECK(download_id_.IsValid());
+  const ResourceRequestInfoImpl* request_info =
+      ResourceRequestInfoImpl::ForRequest(request_);
+  ResourceDispatcherHostImpl* resource_dispatcher_host =
+      ResourceDispatcherHostImpl::Get();
+
+  std::vector<std::pair<int64, int64> > ranges;
+  ranges.swap(ranges_to_start_);
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    int64 offset = ranges[i].first;
+    int64 length = ranges[i].second;
+    scoped_ptr<net::URLRequest> request(
+        new net::URLRequest(request_->url(), resource_dispatcher_host));
+    request->set_referrer(request_->referrer());
+    request->set_first_party_for_cookies(
+        request_->first_party_for_cookies());
+    request->SetExtraRequestHeaderByName(
+        net::HttpRequestHeaders::kRange,
+        net::HttpByteRange::Bounded(offset, offset + length - 1)
+            .GetHeaderValue(),
+        true);
+    request->SetExtraRequestHeaderByName(
+        net::HttpRequestHeaders::kIfRange, range_validator_, true);
+
+    int request_id = 0;
+    net::Error result = resource_dispatcher_host->BeginDownloadRange(
+        request.Pass(), request_info->GetContext(), global_id_.child_id,
+        render_view_id_, this, offset, length, &request_id);
+    if (result != net::OK) {
+      // Without this range the file can't be completed.
+      ranges_error_ = content::ConvertNetErrorToInterruptReason(
+          result, content::DOWNLOAD_INTERRUPT_FROM_NETWORK);
+      finishing_ranges_ = true;
+      CancelRangeRequests();
+      return false;
+    }
+    range_request_ids_.insert(request_id);
+
+    // A range requested while the download is paused waits for it to be
+    // resumed.
+    for (int j = 0; j < user_pause_count_; ++j) {
+      resource_dispatcher_host->PauseRequest(global_id_.child_id, request_id,
+                                             true);
+    }
+  }
+  return true;
+}
+
+void DownloadResourceHandler::PauseRangeRequests(bool pause) {
+  if (pause) {
+    ++user_pause_count_;
+  } else if (user_pause_count_ > 0) {
+    --user_pause_count_;
+  } else {
+    NOTREACHED();  // Unbalanced call to pause.
+    return;
+  }
+  for (std::set<int>::iterator i = range_request_ids_.begin();
+       i != range_request_ids_.end(); ++i) {
+    ResourceDispatcherHostImpl::Get()->PauseRequest(global_id_.child_id, *i,
+                                                    pause);
+  }
+}
+
+void DownloadResourceHandler::CancelRangeRequests() {
+  ranges_to_start_.clear();
+  // Cancelling a request can complete it synchronously, which comes back
+  // here through OnRangeCompleted.
+  std::set<int> request_ids;
+  request_ids.swap(range_request_ids_);
+  for (std::set<int>::iterator i = request_ids.begin();
+       i != request_ids.end(); ++i) {
+    ResourceDispatcherHostImpl::Get()->CancelRequest(global_id_.child_id, *i,
+                                                     false);
+  }
+}
+
+void DownloadResourceHandler::MaybeFinishRanges() {
+  if (!range_done_ || !range_request_ids_.empty() || !ranges_to_start_.empty())
+    return;
+  // Everything has been received.  Ending this request hands the download
+  // to the FILE thread, after the range writes that are already queued.
+  finishing_ranges_ = true;
+  ResourceDispatcherHostImpl::Get()->CancelRequest(global_id_.child_id,
+                                                   global_id_.request_id,
+                                                   false);
+}
+
 DownloadResourceHandler::~DownloadResourceHandler() {
   // This won't do anything if the callback was called before.
   // If it goes through, it will likely be because OnWillStart() returned
@@ -6,7 +6,10 @@
 #define CONTENT_BROWSER_DOWNLOAD_DOWNLOAD_RESOURCE_HANDLER_H_
 #pragma once
 
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/callback.h"
 #include "base/memory/scoped_ptr.h"
@@ -14,6 +17,7 @@
 #include "content/browser/renderer_host/resource_handler.h"
 #include "content/public/browser/download_manager.h"
 #include "content/public/browser/download_id.h"
+#include "content/public/browser/download_interrupt_reasons.h"
 #include "content/public/browser/download_save_info.h"
 #include "content/public/browser/global_request_id.h"
 #include "net/base/net_errors.h"
@@ -27,6 +31,7 @@ class DownloadBuffer;
 }
 
 namespace net {
+class HttpResponseHeaders;
 class URLRequest;
 }  // namespace net
 
@@ -47,11 +52,23 @@ class DownloadResourceHandler : public ResourceHandler {
                           const OnStartedCallback& started_cb,
                           const content::DownloadSaveInfo& save_info);
 
+  // For one of the extra requests of a download that is received as several
+  // byte ranges at once.  The request receives [|range_offset|,
+  // |range_offset| + |range_length|) of the download handled by |parent|.
+  DownloadResourceHandler(int render_process_host_id,
+                          int render_view_id,
+                          int request_id,
+                          DownloadFileManager* download_file_manager,
+                          net::URLRequest* request,
+                          DownloadResourceHandler* parent,
+                          int64 range_offset,
+                          int64 range_length);
+
   virtual bool OnUploadProgress(int request_id,
                                 uint64 position,
                                 uint64 size) OVERRIDE;
 
-  // Not needed, as this event handler ought to be the final resource.
+  // Range requests fail if they are redirected; other requests follow.
   virtual bool OnRequestRedirected(int request_id,
                                    const GURL& url,
                                    content::ResourceResponse* response,
@@ -89,8 +106,24 @@ class DownloadResourceHandler : public ResourceHandler {
 
   void CheckWriteProgress();
 
+  // Called on the main request's handler when the range request
+  // |request_id| completes.  |reason| is DOWNLOAD_INTERRUPT_REASON_NONE if
+  // the whole range was received.
+  void OnRangeCompleted(int request_id,
+                        content::DownloadInterruptReason reason);
+
+  // Called on the main request's handler when the user pauses (resumes) the
+  // download, after the main request itself has been paused (resumed).  The
+  // range requests follow it, including those started while it is paused.
+  void PauseRangeRequests(bool pause);
+
   std::string DebugString() const;
 
+  // Returns the validator to send in If-Range when a response with |headers|
+  // is split into byte ranges, or an empty string if it can't be split.
+  // Exposed for testing.
+  static std::string GetRangeValidator(const net::HttpResponseHeaders& headers);
+
  private:
   virtual ~DownloadResourceHandler();
 
@@ -98,6 +131,33 @@ class DownloadResourceHandler : public ResourceHandler {
                                    const net::URLRequestStatus& status,
                                    const std::string& security_info);
 
+  // Works out how the request ended.  |error_code| is set to the network
+  // error, if any.
+  content::DownloadInterruptReason GetInterruptReason(
+      const net::URLRequestStatus& status,
+      net::Error* error_code);
+
+  // Range request versions of OnResponseStarted and OnResponseCompleted.
+  bool OnRangeResponseStarted(content::ResourceResponse* response);
+  void OnRangeResponseCompleted(const net::URLRequestStatus& status);
+
+  // If --parallel-download-requests allows it and the response supports it,
+  // splits the download into ranges.  This request keeps the first one, and
+  // the rest are started once the download file exists.
+  void SetUpRanges(const content::ResourceResponse* response,
+                   const net::HttpResponseHeaders* headers);
+
+  // Returns false, and ends the download, if a range request can't be
+  // started.
+  bool StartRangeRequests();
+  void CancelRangeRequests();
+
+  // Ends this request once its own range and all the range requests are done.
+  void MaybeFinishRanges();
+
+  // Whether this is one of the extra requests of a split download.
+  bool is_range_request() const { return is_range_request_; }
+
   void StartPauseTimer();
   void CallStartedCB(content::DownloadId id, net::Error error);
 
@@ -128,6 +188,41 @@ class DownloadResourceHandler : public ResourceHandler {
   int64 bytes_read_;
   std::string accept_ranges_;
 
+  // The part of the file this request receives when the download is split
+  // into ranges.  |range_offset_| is -1 otherwise.
+  const bool is_range_request_;
+  int64 range_offset_;
+  int64 range_length_;
+
+  // On a range request, the handler of the download's main request.  Dropped
+  // once the range completes.
+  scoped_refptr<DownloadResourceHandler> parent_;
+
+  // Why a range request was refused in OnResponseStarted, if it was.
+  content::DownloadInterruptReason range_start_error_;
+
+  // On the main request of a split download: the ranges still to be
+  // requested, as (offset, length), the ids of the range requests still
+  // running, and the validator they send in If-Range.
+  std::vector<std::pair<int64, int64> > ranges_to_start_;
+  std::set<int> range_request_ids_;
+  std::string range_validator_;
+
+  // How many times the user has paused the download without resuming it.
+  // Each range request is paused that many times on top of its own pauses.
+  int user_pause_count_;
+
+  // Set once this request has received all of its range.  It is then kept
+  // paused, and open so that cancelling the download still cancels it, until
+  // the range requests finish.
+  bool range_done_;
+
+  // Set when this request ends itself because the ranges have finished.
+  // |ranges_error_| is why, or DOWNLOAD_INTERRUPT_REASON_NONE if every range
+  // arrived.
+  bool finishing_ranges_;
+  content::DownloadInterruptReason ranges_error_;
+
   static const int kReadBufSize = 32768;  // bytes
   static const int kThrottleTimeMs = 200;  // milliseconds
 
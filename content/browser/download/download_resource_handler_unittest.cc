@@ -0,0 +1,75 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/download/download_resource_handler.h"
+
+#include <string>
+
+#include "base/memory/ref_counted.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// Returns the If-Range validator for a response with |raw_headers|, which
+// are separated by newlines.
+std::string GetRangeValidator(const char* raw_headers) {
+  std::string headers(raw_headers);
+  scoped_refptr<net::HttpResponseHeaders> parsed(
+      new net::HttpResponseHeaders(
+          net::HttpUtil::AssembleRawHeaders(headers.c_str(),
+                                            headers.size())));
+  return DownloadResourceHandler::GetRangeValidator(*parsed);
+}
+
+}  // namespace
+
+TEST(DownloadResourceHandlerTest, RangeValidator) {
+  EXPECT_EQ("\"abc\"", GetRangeValidator(
+      "HTTP/1.1 200 OK\n"
+      "Accept-Ranges: bytes\n"
+      "ETag: \"abc\"\n"));
+  EXPECT_EQ("Mon, 01 Jan 2007 00:00:00 GMT", GetRangeValidator(
+      "HTTP/1.1 200 OK\n"
+      "Accept-Ranges: bytes\n"
+      "Date: Tue, 02 Jan 2007 00:00:00 GMT\n"
+      "Last-Modified: Mon, 01 Jan 2007 00:00:00 GMT\n"));
+
+  // No byte ranges.
+  EXPECT_EQ("", GetRangeValidator(
+      "HTTP/1.1 200 OK\n"
+      "ETag: \"abc\"\n"));
+  EXPECT_EQ("", GetRangeValidator(
+      "HTTP/1.1 200 OK\n"
+      "Accept-Ranges: none\n"
+      "ETag: \"abc\"\n"));
+  // Not the whole file.
+  EXPECT_EQ("", GetRangeValidator(
+      "HTTP/1.1 206 Partial Content\n"
+      "Accept-Ranges: bytes\n"
+      "ETag: \"abc\"\n"));
+  // Weak validators can't be used in If-Range.
+  EXPECT_EQ("", GetRangeValidator(
+      "HTTP/1.1 200 OK\n"
+      "Accept-Ranges: bytes\n"
+      "ETag: W/\"abc\"\n"));
+  EXPECT_EQ("", GetRangeValidator(
+      "HTTP/1.1 200 OK\n"
+      "Accept-Ranges: bytes\n"));
+}
+
+// Ranges of a content-encoded body don't decode into ranges of the file.
+TEST(DownloadResourceHandlerTest, NoRangesForContentEncoding) {
+  EXPECT_EQ("", GetRangeValidator(
+      "HTTP/1.1 200 OK\n"
+      "Accept-Ranges: bytes\n"
+      "Content-Encoding: gzip\n"
+      "ETag: \"abc\"\n"));
+  EXPECT_EQ("", GetRangeValidator(
+      "HTTP/1.1 200 OK\n"
+      "Accept-Ranges: bytes\n"
+      "Content-Encoding: identity\n"
+      "ETag: \"abc\"\n"));
+}
@@ -27,7 +27,11 @@ class MockDownloadFile : virtual public content::DownloadFile {
 
   // DownloadFile functions.
   MOCK_METHOD0(Initialize, net::Error());
-  MOCK_METHOD2(AppendDataToFile, net::Error(const char* data, size_t data_len));
+  MOCK_METHOD2(AppendDataToFile, net::Error(net::IOBuffer* data,
+                                            size_t data_len));
+  MOCK_METHOD3(WriteDataAt, net::Error(int64 offset,
+                                       net::IOBuffer* data,
+                                       size_t data_len));
   MOCK_METHOD1(Rename, net::Error(const FilePath& full_path));
   MOCK_METHOD0(Detach, void());
   MOCK_METHOD0(Cancel, void());
@@ -36,6 +40,7 @@ class MockDownloadFile : virtual public content::DownloadFile {
   MOCK_CONST_METHOD0(FullPath, FilePath());
   MOCK_CONST_METHOD0(InProgress, bool());
   MOCK_CONST_METHOD0(BytesSoFar, int64());
+  MOCK_CONST_METHOD0(ContiguousBytes, int64());
   MOCK_CONST_METHOD0(CurrentSpeed, int64());
   MOCK_METHOD1(GetHash, bool(std::string* hash));
   MOCK_METHOD0(GetHashState, std::string());
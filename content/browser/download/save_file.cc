@@ -34,7 +34,7 @@ net::Error SaveFile::Initialize() {
   return file_.Initialize();
 }
 
-net::Error SaveFile::AppendDataToFile(const char* data, size_t data_len) {
+net::Error SaveFile::AppendDataToFile(net::IOBuffer* data, size_t data_len) {
   return file_.AppendDataToFile(data, data_len);
 }
 
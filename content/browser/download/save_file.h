@@ -26,7 +26,7 @@ class SaveFile {
 
   // BaseFile delegated functions.
   net::Error Initialize();
-  net::Error AppendDataToFile(const char* data, size_t data_len);
+  net::Error AppendDataToFile(net::IOBuffer* data, size_t data_len);
   net::Error Rename(const FilePath& full_path);
   void Detach();
   void Cancel();
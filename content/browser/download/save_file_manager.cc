@@ -239,8 +239,7 @@ void SaveFileManager::UpdateSaveProgress(int save_id,
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
   SaveFile* save_file = LookupSaveFile(save_id);
   if (save_file) {
-    net::Error write_success =
-        save_file->AppendDataToFile(data->data(), data_len);
+    net::Error write_success = save_file->AppendDataToFile(data, data_len);
     BrowserThread::PostTask(
         BrowserThread::UI, FROM_HERE,
         base::Bind(&SaveFileManager::OnUpdateSaveProgress,
@@ -5,6 +5,8 @@
 #include "content/browser/fileapi/chrome_blob_storage_context.h"
 
 #include "base/bind.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
 #include "content/public/browser/browser_context.h"
 #include "webkit/blob/blob_storage_controller.h"
 
@@ -15,6 +17,20 @@ using webkit_blob::BlobStorageController;
 
 static const char* kBlobStorageContextKeyName = "content_blob_storage_context";
 
+// Blob data beyond this much is kept in files in this directory of the
+// profile.
+static const int64 kBlobMemoryLimit = 500 * 1024 * 1024;
+static const FilePath::CharType kBlobSpillDirectoryName[] =
+    FILE_PATH_LITERAL("Blob Storage");
+
+// Spill files only live as long as the blobs in memory, so anything in the
+// directory was left behind by an earlier session.
+static void ResetSpillDirectory(const FilePath& directory) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::FILE));
+  file_util::Delete(directory, true);
+  file_util::CreateDirectory(directory);
+}
+
 ChromeBlobStorageContext* ChromeBlobStorageContext::GetFor(
     BrowserContext* context) {
   if (!context->GetUserData(kBlobStorageContextKeyName)) {
@@ -24,9 +40,14 @@ ChromeBlobStorageContext* ChromeBlobStorageContext::GetFor(
                          new UserDataAdapter<ChromeBlobStorageContext>(blob));
     // Check first to avoid memory leak in unittests.
     if (BrowserThread::IsMessageLoopValid(BrowserThread::IO)) {
+      // Off the record blobs must not reach the disk.
+      FilePath spill_directory;
+      if (!context->IsOffTheRecord())
+        spill_directory = context->GetPath().Append(kBlobSpillDirectoryName);
       BrowserThread::PostTask(
           BrowserThread::IO, FROM_HERE,
-          base::Bind(&ChromeBlobStorageContext::InitializeOnIOThread, blob));
+          base::Bind(&ChromeBlobStorageContext::InitializeOnIOThread, blob,
+                     spill_directory));
     }
   }
 
@@ -37,9 +58,22 @@ ChromeBlobStorageContext* ChromeBlobStorageContext::GetFor(
 ChromeBlobStorageContext::ChromeBlobStorageContext() {
 }
 
-void ChromeBlobStorageContext::InitializeOnIOThread() {
+void ChromeBlobStorageContext::InitializeOnIOThread(
+    const FilePath& spill_directory) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
   controller_.reset(new BlobStorageController());
+  if (spill_directory.empty())
+    return;
+
+  // Spill writes are posted to the FILE thread after the reset, so they
+  // never race with it.
+  if (BrowserThread::PostTask(
+          BrowserThread::FILE, FROM_HERE,
+          base::Bind(&ResetSpillDirectory, spill_directory))) {
+    controller_->EnableDiskSpill(
+        spill_directory, kBlobMemoryLimit,
+        BrowserThread::GetMessageLoopProxyForThread(BrowserThread::FILE));
+  }
 }
 
 ChromeBlobStorageContext::~ChromeBlobStorageContext() {
@@ -12,6 +12,8 @@
 #include "content/common/content_export.h"
 #include "content/public/browser/browser_thread.h"
 
+class FilePath;
+
 namespace content {
 class BrowserContext;
 }
@@ -39,7 +41,9 @@ class CONTENT_EXPORT ChromeBlobStorageContext
   ChromeBlobStorageContext();
   virtual ~ChromeBlobStorageContext();
 
-  void InitializeOnIOThread();
+  // Data of blobs beyond the memory limit is spilled to |spill_directory|,
+  // unless it is empty.
+  void InitializeOnIOThread(const FilePath& spill_directory);
 
   webkit_blob::BlobStorageController* controller() const {
     return controller_.get();
@@ -13,6 +13,7 @@
 #include "base/shared_memory.h"
 #include "content/browser/debugger/devtools_netlog_observer.h"
 #include "content/browser/host_zoom_map_impl.h"
+#include "content/browser/renderer_host/resource_data_buffer.h"
 #include "content/browser/renderer_host/resource_dispatcher_host_impl.h"
 #include "content/browser/renderer_host/resource_message_filter.h"
 #include "content/browser/resource_context_impl.h"
@@ -78,6 +79,39 @@ class SharedIOBuffer : public net::IOBuffer {
   int buffer_size_;
 };
 
+// An IOBuffer over one chunk of a ResourceDataBuffer.  Unless the chunk has
+// been handed to the child, it goes back to the buffer when the IOBuffer is
+// destroyed rather than when the request is done with it, so that a read
+// still pending on a cancelled request can't write into a chunk that has
+// since been given to another request.
+class DataChunkIOBuffer : public net::WrappedIOBuffer {
+ public:
+  DataChunkIOBuffer(ResourceDataBuffer* data_buffer, int chunk)
+      : net::WrappedIOBuffer(data_buffer->GetChunk(chunk)),
+        data_buffer_(data_buffer),
+        chunk_(chunk),
+        sent_(false) {}
+
+  int chunk() const { return chunk_; }
+  int size() const { return data_buffer_->chunk_size(); }
+
+  // Called once the chunk has been sent to the child, which now returns it.
+  void set_sent() {
+    data_buffer_->MarkChunkSent(chunk_);
+    sent_ = true;
+  }
+
+ private:
+  virtual ~DataChunkIOBuffer() {
+    if (!sent_)
+      data_buffer_->ReleaseUnsentChunk(chunk_);
+  }
+
+  scoped_refptr<ResourceDataBuffer> data_buffer_;
+  const int chunk_;
+  bool sent_;
+};
+
 AsyncResourceHandler::AsyncResourceHandler(
     ResourceMessageFilter* filter,
     int routing_id,
@@ -172,6 +206,19 @@ bool AsyncResourceHandler::OnWillStart(int request_id,
 bool AsyncResourceHandler::OnWillRead(int request_id, net::IOBuffer** buf,
                                       int* buf_size, int min_size) {
   DCHECK_EQ(-1, min_size);
+  DCHECK(!read_chunk_);
+
+  ResourceDataBuffer* data_buffer = filter_->GetDataBuffer();
+  if (data_buffer) {
+    int chunk = data_buffer->AllocateChunk(request_id);
+    if (chunk != -1) {
+      read_chunk_ = new DataChunkIOBuffer(data_buffer, chunk);
+      *buf = read_chunk_.get();
+      *buf_size = read_chunk_->size();
+      return true;
+    }
+    // Every chunk is in use; fall back to a segment of our own.
+  }
 
   if (g_spare_read_buffer) {
     DCHECK(!read_buffer_);
@@ -196,8 +243,15 @@ bool AsyncResourceHandler::OnWillRead(int request_id, net::IOBuffer** buf,
 }
 
 bool AsyncResourceHandler::OnReadCompleted(int request_id, int* bytes_read) {
-  if (!*bytes_read)
+  if (!*bytes_read) {
+    // Nothing to send, so the chunk can go straight back to the buffer.
+    read_chunk_ = NULL;
     return true;
+  }
+
+  if (read_chunk_.get())
+    return SendDataChunk(request_id, *bytes_read);
+
   DCHECK(read_buffer_.get());
 
   if (read_buffer_->buffer_size() == *bytes_read) {
@@ -237,6 +291,27 @@ bool AsyncResourceHandler::OnReadCompleted(int request_id, int* bytes_read) {
   return true;
 }
 
+bool AsyncResourceHandler::SendDataChunk(int request_id, int bytes_read) {
+  if (!rdh_->WillSendData(filter_->child_id(), request_id)) {
+    // We should not send this data now, we have too many pending requests.
+    // The data stays in the chunk until we are resumed.
+    return true;
+  }
+
+  net::URLRequest* request = rdh_->GetURLRequest(
+      GlobalRequestID(filter_->child_id(), request_id));
+  int encoded_data_length =
+      DevToolsNetLogObserver::GetAndResetEncodedDataLength(request);
+  filter_->Send(new ResourceMsg_DataReceivedInBuffer(
+      routing_id_, request_id, read_chunk_->chunk(), bytes_read,
+      encoded_data_length));
+
+  // The child returns the chunk with ResourceHostMsg_DataChunksConsumed.
+  read_chunk_->set_sent();
+  read_chunk_ = NULL;
+  return true;
+}
+
 void AsyncResourceHandler::OnDataDownloaded(
     int request_id, int bytes_downloaded) {
   filter_->Send(new ResourceMsg_DataDownloaded(
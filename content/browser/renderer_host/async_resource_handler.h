@@ -14,6 +14,7 @@
 class ResourceMessageFilter;
 
 namespace content {
+class DataChunkIOBuffer;
 class ResourceDispatcherHostImpl;
 class SharedIOBuffer;
 
@@ -57,6 +58,12 @@ class AsyncResourceHandler : public ResourceHandler {
  private:
   virtual ~AsyncResourceHandler();
 
+  // Sends the |bytes_read| bytes in |read_chunk_| to the child.
+  bool SendDataChunk(int request_id, int bytes_read);
+
+  // The chunk of the child's data buffer that the current read goes into.
+  // Reads use |read_buffer_| instead when no chunk is available.
+  scoped_refptr<DataChunkIOBuffer> read_chunk_;
   scoped_refptr<SharedIOBuffer> read_buffer_;
   scoped_refptr<ResourceMessageFilter> filter_;
   int routing_id_;
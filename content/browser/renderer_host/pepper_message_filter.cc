@@ -33,6 +33,7 @@
 #include "net/base/cert_verifier.h"
 #include "net/base/host_port_pair.h"
 #include "net/base/sys_addrinfo.h"
+#include "net/url_request/url_request_context.h"
 #include "ppapi/c/pp_errors.h"
 #include "ppapi/c/private/ppb_host_resolver_private.h"
 #include "ppapi/c/private/ppb_net_address_private.h"
@@ -152,6 +153,10 @@ net::HostResolver* PepperMessageFilter::GetHostResolver() {
 }
 
 net::CertVerifier* PepperMessageFilter::GetCertVerifier() {
+  // Share the profile's verifier, and with it the results it has cached.
+  if (resource_context_)
+    return resource_context_->GetRequestContext()->cert_verifier();
+
   if (!cert_verifier_.get())
     cert_verifier_.reset(net::CertVerifier::CreateDefault());
 
@@ -230,7 +230,8 @@ class PepperMessageFilter
   // The default SSL configuration settings are used, as opposed to Chrome's SSL
   // settings.
   net::SSLConfig ssl_config_;
-  // This is lazily created. Users should use GetCertVerifier to retrieve it.
+  // This is lazily created when there is no resource_context_. Users should
+  // use GetCertVerifier to retrieve it.
   scoped_ptr<net::CertVerifier> cert_verifier_;
 
   uint32 next_socket_id_;
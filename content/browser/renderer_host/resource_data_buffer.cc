@@ -0,0 +1,99 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/renderer_host/resource_data_buffer.h"
+
+#include "base/logging.h"
+
+namespace content {
+
+ResourceDataBuffer::ResourceDataBuffer(int chunk_size,
+                                       int chunk_count,
+                                       int max_chunks_per_request)
+    : chunk_size_(chunk_size),
+      chunk_count_(chunk_count),
+      max_chunks_per_request_(max_chunks_per_request),
+      chunks_(chunk_count) {
+  DCHECK_GT(chunk_size, 0);
+  DCHECK_GT(chunk_count, 0);
+  DCHECK_GT(max_chunks_per_request, 0);
+  free_chunks_.reserve(chunk_count);
+  // Hand out chunk 0 first.
+  for (int i = chunk_count - 1; i >= 0; --i)
+    free_chunks_.push_back(i);
+}
+
+ResourceDataBuffer::~ResourceDataBuffer() {
+}
+
+bool ResourceDataBuffer::Initialize() {
+  return shared_memory_.CreateAndMapAnonymous(chunk_size_ * chunk_count_);
+}
+
+bool ResourceDataBuffer::ShareToProcess(base::ProcessHandle process,
+                                        base::SharedMemoryHandle* new_handle) {
+  return shared_memory_.ShareToProcess(process, new_handle);
+}
+
+int ResourceDataBuffer::AllocateChunk(int request_id) {
+  if (free_chunks_.empty())
+    return -1;
+  int& held = chunks_per_request_[request_id];
+  if (held >= max_chunks_per_request_)
+    return -1;
+  ++held;
+
+  int chunk = free_chunks_.back();
+  free_chunks_.pop_back();
+  chunks_[chunk].state = CHUNK_READING;
+  chunks_[chunk].request_id = request_id;
+  return chunk;
+}
+
+void ResourceDataBuffer::MarkChunkSent(int chunk) {
+  DCHECK(chunk >= 0 && chunk < chunk_count_);
+  DCHECK_EQ(CHUNK_READING, chunks_[chunk].state);
+  chunks_[chunk].state = CHUNK_SENT;
+}
+
+bool ResourceDataBuffer::ReleaseChunk(int chunk, int* request_id) {
+  // Only a chunk the child was sent is the child's to return.  Returning one
+  // a request is still reading into would let it be handed out twice.
+  if (chunk < 0 || chunk >= chunk_count_ ||
+      chunks_[chunk].state != CHUNK_SENT) {
+    return false;
+  }
+
+  int owner = FreeChunk(chunk);
+  if (request_id)
+    *request_id = owner;
+  return true;
+}
+
+void ResourceDataBuffer::ReleaseUnsentChunk(int chunk) {
+  DCHECK(chunk >= 0 && chunk < chunk_count_);
+  DCHECK_EQ(CHUNK_READING, chunks_[chunk].state);
+  FreeChunk(chunk);
+}
+
+char* ResourceDataBuffer::GetChunk(int chunk) {
+  DCHECK(chunk >= 0 && chunk < chunk_count_);
+  DCHECK(shared_memory_.memory());
+  return static_cast<char*>(shared_memory_.memory()) + chunk * chunk_size_;
+}
+
+int ResourceDataBuffer::FreeChunk(int chunk) {
+  ChunkInfo& info = chunks_[chunk];
+  std::map<int, int>::iterator held =
+      chunks_per_request_.find(info.request_id);
+  DCHECK(held != chunks_per_request_.end());
+  if (--held->second == 0)
+    chunks_per_request_.erase(held);
+
+  info.state = CHUNK_FREE;
+  free_chunks_.push_back(chunk);
+  return info.request_id;
+}
+
+}  // namespace content
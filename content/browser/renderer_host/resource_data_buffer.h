@@ -0,0 +1,119 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_BROWSER_RENDERER_HOST_RESOURCE_DATA_BUFFER_H_
+#define CONTENT_BROWSER_RENDERER_HOST_RESOURCE_DATA_BUFFER_H_
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "base/basictypes.h"
+#include "base/memory/ref_counted.h"
+#include "base/process.h"
+#include "base/shared_memory.h"
+#include "content/common/content_export.h"
+
+namespace content {
+
+// A shared memory segment that is mapped into both the browser and one child
+// process, and that AsyncResourceHandler reads response bodies into.
+//
+// The segment is split into fixed-size chunks.  A request is given a chunk
+// for each read, the chunk is handed to the child along with the
+// ResourceMsg_DataReceivedInBuffer that describes it, and the child returns
+// it once the data has been consumed.  One segment serves every request from
+// the child, so no shared memory is created, mapped or sent per read.
+//
+// Chunks come back in whatever order the child's requests consume them,
+// so free chunks are kept on a list rather than as a single free region.
+//
+// Lives on the IO thread.
+class CONTENT_EXPORT ResourceDataBuffer
+    : public base::RefCountedThreadSafe<ResourceDataBuffer> {
+ public:
+  // No request is given more than |max_chunks_per_request| chunks at once,
+  // which keeps one fast response from starving the others.
+  ResourceDataBuffer(int chunk_size,
+                     int chunk_count,
+                     int max_chunks_per_request);
+
+  // Creates and maps the segment.  Returns false on failure.
+  bool Initialize();
+
+  // Duplicates a handle to the segment for |process|.
+  bool ShareToProcess(base::ProcessHandle process,
+                      base::SharedMemoryHandle* new_handle);
+
+  // Returns the index of a free chunk, now owned by |request_id|, or -1 if
+  // every chunk is in use or |request_id| already holds its share of them.
+  int AllocateChunk(int request_id);
+
+  // Records that |chunk| has been handed to the child, which from now on is
+  // the one to return it, with ReleaseChunk().
+  void MarkChunkSent(int chunk);
+
+  // Returns a chunk the child was sent to the free list.  If |request_id| is
+  // non-NULL it is set to the request that owned the chunk.  Returns false if
+  // |chunk| is not currently in the child's hands, which the caller should
+  // treat as a misbehaving child.
+  bool ReleaseChunk(int chunk, int* request_id);
+
+  // Returns a chunk that was never sent to the child to the free list.
+  void ReleaseUnsentChunk(int chunk);
+
+  // Returns the start of |chunk| in the browser's mapping.
+  char* GetChunk(int chunk);
+
+  int chunk_size() const { return chunk_size_; }
+  int chunk_count() const { return chunk_count_; }
+  int max_chunks_per_request() const { return max_chunks_per_request_; }
+  int allocated_chunks() const {
+    return chunk_count_ - static_cast<int>(free_chunks_.size());
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<ResourceDataBuffer>;
+
+  ~ResourceDataBuffer();
+
+  enum ChunkState {
+    CHUNK_FREE,
+    // Allocated to a request, which is reading into it.
+    CHUNK_READING,
+    // Sent to the child, which has yet to return it.
+    CHUNK_SENT,
+  };
+
+  // Where a chunk is, and which request it belongs to.
+  struct ChunkInfo {
+    ChunkInfo() : state(CHUNK_FREE), request_id(0) {}
+    ChunkState state;
+    int request_id;
+  };
+
+  // Puts an allocated |chunk| back on the free list, and returns the request
+  // that owned it.
+  int FreeChunk(int chunk);
+
+  base::SharedMemory shared_memory_;
+  const int chunk_size_;
+  const int chunk_count_;
+  const int max_chunks_per_request_;
+
+  std::vector<ChunkInfo> chunks_;
+
+  // Used as a stack so that the most recently returned, and so most likely
+  // still cached, chunk is the next one handed out.
+  std::vector<int> free_chunks_;
+
+  // Number of chunks held by each request that holds any.
+  std::map<int, int> chunks_per_request_;
+
+  DISALLOW_COPY_AND_ASSIGN(ResourceDataBuffer);
+};
+
+}  // namespace content
+
+#endif  // CONTENT_BROWSER_RENDERER_HOST_RESOURCE_DATA_BUFFER_H_
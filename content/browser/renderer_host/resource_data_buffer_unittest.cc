@@ -0,0 +1,108 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/renderer_host/resource_data_buffer.h"
+
+#include <string.h>
+
+#include <set>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace content {
+
+namespace {
+
+const int kChunkSize = 4096;
+const int kChunkCount = 8;
+
+}  // namespace
+
+TEST(ResourceDataBufferTest, AllocateAll) {
+  scoped_refptr<ResourceDataBuffer> buffer(
+      new ResourceDataBuffer(kChunkSize, kChunkCount, kChunkCount));
+  ASSERT_TRUE(buffer->Initialize());
+
+  std::set<int> chunks;
+  for (int i = 0; i < kChunkCount; ++i) {
+    int chunk = buffer->AllocateChunk(1);
+    ASSERT_GE(chunk, 0);
+    ASSERT_LT(chunk, kChunkCount);
+    EXPECT_TRUE(chunks.insert(chunk).second);
+    // Chunks don't overlap.
+    memset(buffer->GetChunk(chunk), chunk, kChunkSize);
+  }
+  EXPECT_EQ(kChunkCount, buffer->allocated_chunks());
+  EXPECT_EQ(-1, buffer->AllocateChunk(2));
+
+  for (int i = 0; i < kChunkCount; ++i) {
+    const char* data = buffer->GetChunk(i);
+    EXPECT_EQ(i, data[0]);
+    EXPECT_EQ(i, data[kChunkSize - 1]);
+  }
+}
+
+TEST(ResourceDataBufferTest, ReleaseReturnsOwner) {
+  scoped_refptr<ResourceDataBuffer> buffer(
+      new ResourceDataBuffer(kChunkSize, kChunkCount, kChunkCount));
+  ASSERT_TRUE(buffer->Initialize());
+
+  int first = buffer->AllocateChunk(1);
+  int second = buffer->AllocateChunk(2);
+  EXPECT_EQ(2, buffer->allocated_chunks());
+  buffer->MarkChunkSent(first);
+  buffer->MarkChunkSent(second);
+
+  int request_id = 0;
+  EXPECT_TRUE(buffer->ReleaseChunk(second, &request_id));
+  EXPECT_EQ(2, request_id);
+  EXPECT_TRUE(buffer->ReleaseChunk(first, &request_id));
+  EXPECT_EQ(1, request_id);
+  EXPECT_EQ(0, buffer->allocated_chunks());
+
+  // The most recently released chunk is reused first.
+  EXPECT_EQ(first, buffer->AllocateChunk(3));
+}
+
+TEST(ResourceDataBufferTest, ReleaseInvalidChunk) {
+  scoped_refptr<ResourceDataBuffer> buffer(
+      new ResourceDataBuffer(kChunkSize, kChunkCount, kChunkCount));
+  ASSERT_TRUE(buffer->Initialize());
+
+  int chunk = buffer->AllocateChunk(1);
+  EXPECT_FALSE(buffer->ReleaseChunk(-1, NULL));
+  EXPECT_FALSE(buffer->ReleaseChunk(kChunkCount, NULL));
+  EXPECT_FALSE(buffer->ReleaseChunk((chunk + 1) % kChunkCount, NULL));
+  // Not sent yet, so not the child's to return.
+  EXPECT_FALSE(buffer->ReleaseChunk(chunk, NULL));
+  EXPECT_EQ(1, buffer->allocated_chunks());
+  buffer->MarkChunkSent(chunk);
+  EXPECT_TRUE(buffer->ReleaseChunk(chunk, NULL));
+  // Already released.
+  EXPECT_FALSE(buffer->ReleaseChunk(chunk, NULL));
+  EXPECT_EQ(0, buffer->allocated_chunks());
+}
+
+TEST(ResourceDataBufferTest, PerRequestLimit) {
+  const int kMaxChunksPerRequest = 3;
+  scoped_refptr<ResourceDataBuffer> buffer(
+      new ResourceDataBuffer(kChunkSize, kChunkCount, kMaxChunksPerRequest));
+  ASSERT_TRUE(buffer->Initialize());
+
+  int chunk = -1;
+  for (int i = 0; i < kMaxChunksPerRequest; ++i) {
+    chunk = buffer->AllocateChunk(1);
+    EXPECT_NE(-1, chunk);
+  }
+  EXPECT_EQ(-1, buffer->AllocateChunk(1));
+
+  // Other requests still get chunks.
+  EXPECT_NE(-1, buffer->AllocateChunk(2));
+
+  // And request 1 gets one again once it returns one.
+  buffer->ReleaseUnsentChunk(chunk);
+  EXPECT_NE(-1, buffer->AllocateChunk(1));
+}
+
+}  // namespace content
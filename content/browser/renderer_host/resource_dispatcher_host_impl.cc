@@ -38,6 +38,7 @@
 #include "content/browser/renderer_host/doomed_resource_handler.h"
 #include "content/browser/renderer_host/redirect_to_file_resource_handler.h"
 #include "content/browser/renderer_host/render_view_host_impl.h"
+#include "content/browser/renderer_host/resource_data_buffer.h"
 #include "content/browser/renderer_host/resource_message_filter.h"
 #include "content/public/browser/resource_request_details.h"
 #include "content/browser/renderer_host/resource_request_info_impl.h"
@@ -59,6 +60,7 @@
 #include "content/public/browser/resource_dispatcher_host_delegate.h"
 #include "content/public/browser/resource_dispatcher_host_login_delegate.h"
 #include "content/public/browser/resource_throttle.h"
+#include "content/public/browser/user_metrics.h"
 #include "content/public/common/content_switches.h"
 #include "content/public/common/process_type.h"
 #include "content/public/common/url_constants.h"
@@ -520,6 +522,44 @@ net::Error ResourceDispatcherHostImpl::BeginDownload(
   return net::OK;
 }
 
+net::Error ResourceDispatcherHostImpl::BeginDownloadRange(
+    scoped_ptr<net::URLRequest> request,
+    ResourceContext* context,
+    int child_id,
+    int route_id,
+    DownloadResourceHandler* parent,
+    int64 offset,
+    int64 length,
+    int* request_id) {
+  if (is_shutdown_)
+    return net::ERR_INSUFFICIENT_RESOURCES;
+
+  // The download was already allowed when its main request started, so the
+  // delegate isn't asked again and no throttles are added.  The request is
+  // for the URL the main request ended up at, and the handler fails it if it
+  // is redirected, so it never reaches a URL the throttles haven't seen.
+  request->set_context(context->GetRequestContext());
+  request->set_load_flags(request->load_flags() | net::LOAD_IS_DOWNLOAD |
+                          net::LOAD_DISABLE_CACHE);
+
+  request_id_--;
+
+  scoped_refptr<ResourceHandler> handler(
+      new DownloadResourceHandler(child_id, route_id, request_id_,
+                                  download_file_manager_.get(), request.get(),
+                                  parent, offset, length));
+
+  ResourceRequestInfoImpl* extra_info =
+      CreateRequestInfo(handler, child_id, route_id, true, context);
+  extra_info->AssociateWithRequest(request.get());  // Request takes ownership.
+
+  request->set_delegate(this);
+  BeginRequestInternal(request.release());
+
+  *request_id = request_id_;
+  return net::OK;
+}
+
 void ResourceDispatcherHostImpl::ClearLoginDelegateForRequest(
     net::URLRequest* request) {
   ResourceRequestInfoImpl* info = ResourceRequestInfoImpl::ForRequest(request);
@@ -666,6 +706,8 @@ bool ResourceDispatcherHostImpl::OnMessageReceived(
     IPC_MESSAGE_HANDLER(ResourceHostMsg_ReleaseDownloadedFile,
                         OnReleaseDownloadedFile)
     IPC_MESSAGE_HANDLER(ResourceHostMsg_DataReceived_ACK, OnDataReceivedACK)
+    IPC_MESSAGE_HANDLER(ResourceHostMsg_DataChunksConsumed,
+                        OnDataChunksConsumed)
     IPC_MESSAGE_HANDLER(ResourceHostMsg_DataDownloaded_ACK, OnDataDownloadedACK)
     IPC_MESSAGE_HANDLER(ResourceHostMsg_UploadProgress_ACK, OnUploadProgressACK)
     IPC_MESSAGE_HANDLER(ResourceHostMsg_CancelRequest, OnCancelRequest)
@@ -948,6 +990,25 @@ void ResourceDispatcherHostImpl::OnDataReceivedACK(int request_id) {
   DataReceivedACK(filter_->child_id(), request_id);
 }
 
+void ResourceDispatcherHostImpl::OnDataChunksConsumed(
+    const std::vector<int>& chunks) {
+  ResourceDataBuffer* data_buffer = filter_->data_buffer();
+
+  // Each chunk returned is the ACK for the data message that carried it.
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    int request_id;
+    if (!data_buffer || !data_buffer->ReleaseChunk(chunks[i], &request_id)) {
+      // The child returned a chunk it was never sent, or one it already
+      // returned.  Either way its view of the buffer can't be trusted.
+      content::RecordAction(
+          content::UserMetricsAction("BadMessageTerminate_RDH"));
+      filter_->BadMessageReceived();
+      return;
+    }
+    DataReceivedACK(filter_->child_id(), request_id);
+  }
+}
+
 void ResourceDispatcherHostImpl::DataReceivedACK(int child_id,
                                                  int request_id) {
   PendingRequestList::iterator i = pending_requests_.find(
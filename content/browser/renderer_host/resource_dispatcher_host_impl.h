@@ -83,6 +83,19 @@ class CONTENT_EXPORT ResourceDispatcherHostImpl
   virtual void ClearLoginDelegateForRequest(net::URLRequest* request) OVERRIDE;
   virtual void MarkAsTransferredNavigation(net::URLRequest* request) OVERRIDE;
 
+  // Starts |request| as one of the extra byte-range requests of a download
+  // whose main request is handled by |parent|.  The range's data goes to
+  // |parent|'s download file at [|offset|, |offset| + |length|).  On success
+  // |request_id| is set to the new request's id.
+  net::Error BeginDownloadRange(scoped_ptr<net::URLRequest> request,
+                                ResourceContext* context,
+                                int child_id,
+                                int route_id,
+                                DownloadResourceHandler* parent,
+                                int64 offset,
+                                int64 length,
+                                int* request_id);
+
   // Puts the resource dispatcher host in an inactive state (unable to begin
   // new requests).  Cancels all pending requests.
   void Shutdown();
@@ -381,6 +394,7 @@ class CONTENT_EXPORT ResourceDispatcherHostImpl
                     IPC::Message* sync_result,  // only valid for sync
                     int route_id);  // only valid for async
   void OnDataReceivedACK(int request_id);
+  void OnDataChunksConsumed(const std::vector<int>& chunks);
   void OnDataDownloadedACK(int request_id);
   void OnUploadProgressACK(int request_id);
   void OnCancelRequest(int request_id);
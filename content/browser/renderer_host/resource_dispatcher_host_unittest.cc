@@ -8,11 +8,14 @@
 
 #include "base/bind.h"
 #include "base/file_path.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/memory/scoped_vector.h"
 #include "base/message_loop.h"
 #include "base/process_util.h"
+#include "base/shared_memory.h"
 #include "content/browser/browser_thread_impl.h"
 #include "content/browser/child_process_security_policy_impl.h"
+#include "content/browser/renderer_host/resource_data_buffer.h"
 #include "content/browser/renderer_host/resource_dispatcher_host_impl.h"
 #include "content/browser/renderer_host/resource_message_filter.h"
 #include "content/common/child_process_host_impl.h"
@@ -63,6 +66,7 @@ static int RequestIDForMessage(const IPC::Message& msg) {
     case ResourceMsg_ReceivedResponse::ID:
     case ResourceMsg_ReceivedRedirect::ID:
     case ResourceMsg_DataReceived::ID:
+    case ResourceMsg_DataReceivedInBuffer::ID:
     case ResourceMsg_RequestComplete::ID:
       request_id = IPC::MessageIterator(msg).NextInt();
       break;
@@ -167,8 +171,12 @@ class ForwardingFilter : public ResourceMessageFilter {
         resource_context,
         new MockURLRequestContextSelector(
             resource_context->GetRequestContext())),
-      dest_(dest) {
+      dest_(dest),
+      bad_messages_received_(0) {
     OnChannelConnected(base::GetCurrentProcId());
+    // Most tests read response data out of ResourceMsg_DataReceived.  The
+    // ones that cover the shared data buffer turn it back on.
+    set_use_data_buffer(false);
   }
 
   // ResourceMessageFilter override
@@ -178,8 +186,16 @@ class ForwardingFilter : public ResourceMessageFilter {
     return dest_->Send(msg);
   }
 
+  // The peer is this process, so count bad messages instead of killing it.
+  virtual void BadMessageReceived() OVERRIDE {
+    ++bad_messages_received_;
+  }
+
+  int bad_messages_received() const { return bad_messages_received_; }
+
  private:
   IPC::Message::Sender* dest_;
+  int bad_messages_received_;
 
   DISALLOW_COPY_AND_ASSIGN(ForwardingFilter);
 };
@@ -578,6 +594,120 @@ TEST_F(ResourceDispatcherHostTest, TestMany) {
   CheckSuccessfulRequest(msgs[2], net::URLRequestTestJob::test_data_3());
 }
 
+// Checks that |messages| are those of a successful request whose data came
+// in one chunk of the data buffer mapped at |data_buffer|, and returns the
+// chunk in |chunk|.
+void CheckSuccessfulRequestInBuffer(const std::vector<IPC::Message>& messages,
+                                    const std::string& reference_data,
+                                    const base::SharedMemory& data_buffer,
+                                    int chunk_size,
+                                    int* chunk) {
+  ASSERT_EQ(3U, messages.size());
+  ASSERT_EQ(ResourceMsg_ReceivedResponse::ID, messages[0].type());
+  ASSERT_EQ(ResourceMsg_DataReceivedInBuffer::ID, messages[1].type());
+
+  PickleIterator iter(messages[1]);
+  int request_id;
+  ASSERT_TRUE(IPC::ReadParam(&messages[1], &iter, &request_id));
+  ASSERT_TRUE(IPC::ReadParam(&messages[1], &iter, chunk));
+  int data_len;
+  ASSERT_TRUE(IPC::ReadParam(&messages[1], &iter, &data_len));
+
+  ASSERT_EQ(static_cast<int>(reference_data.size()), data_len);
+  const char* data =
+      static_cast<const char*>(data_buffer.memory()) + *chunk * chunk_size;
+  EXPECT_EQ(0, memcmp(reference_data.data(), data, data_len));
+
+  ASSERT_EQ(ResourceMsg_RequestComplete::ID, messages[2].type());
+}
+
+// Tests that response data goes through a single data buffer that is shared
+// by the child's requests, and that chunks come back when the child is done
+// with them.
+TEST_F(ResourceDispatcherHostTest, DataBuffer) {
+  filter_->set_use_data_buffer(true);
+
+  MakeTestRequest(0, 1, net::URLRequestTestJob::test_url_1());
+  MakeTestRequest(0, 2, net::URLRequestTestJob::test_url_2());
+
+  // flush all the pending requests
+  while (net::URLRequestTestJob::ProcessOnePendingMessage()) {}
+
+  ResourceDataBuffer* data_buffer = filter_->data_buffer();
+  ASSERT_TRUE(data_buffer);
+
+  // The buffer is sent exactly once, ahead of any data in it.  Map it the
+  // way the child would.
+  std::vector<IPC::Message>& messages = accum_.messages_;
+  scoped_ptr<base::SharedMemory> shared_memory;
+  int chunk_size = 0;
+  for (size_t i = 0; i < messages.size(); ++i) {
+    if (messages[i].type() == ResourceMsg_DataReceivedInBuffer::ID)
+      ASSERT_TRUE(shared_memory.get());
+    if (messages[i].type() != ResourceMsg_SetDataBuffer::ID)
+      continue;
+    ASSERT_FALSE(shared_memory.get());
+
+    base::SharedMemoryHandle handle;
+    int chunk_count;
+    PickleIterator iter(messages[i]);
+    ASSERT_TRUE(IPC::ReadParam(&messages[i], &iter, &handle));
+    ASSERT_TRUE(IPC::ReadParam(&messages[i], &iter, &chunk_size));
+    ASSERT_TRUE(IPC::ReadParam(&messages[i], &iter, &chunk_count));
+    EXPECT_EQ(data_buffer->chunk_size(), chunk_size);
+    EXPECT_EQ(data_buffer->chunk_count(), chunk_count);
+
+    shared_memory.reset(new base::SharedMemory(handle, true));  // read only
+    ASSERT_TRUE(shared_memory->Map(chunk_size * chunk_count));
+    messages.erase(messages.begin() + i);
+    --i;
+  }
+  ASSERT_TRUE(shared_memory.get());
+
+  ResourceIPCAccumulator::ClassifiedMessages msgs;
+  accum_.GetClassifiedMessages(&msgs);
+  ASSERT_EQ(2U, msgs.size());
+
+  std::vector<int> chunks(2);
+  CheckSuccessfulRequestInBuffer(msgs[0],
+                                 net::URLRequestTestJob::test_data_1(),
+                                 *shared_memory, chunk_size, &chunks[0]);
+  CheckSuccessfulRequestInBuffer(msgs[1],
+                                 net::URLRequestTestJob::test_data_2(),
+                                 *shared_memory, chunk_size, &chunks[1]);
+  EXPECT_NE(chunks[0], chunks[1]);
+
+  // Only the chunks holding data are still out; the ones the final empty
+  // reads went into are back already.
+  EXPECT_EQ(2, data_buffer->allocated_chunks());
+
+  ResourceHostMsg_DataChunksConsumed consumed(chunks);
+  bool msg_was_ok;
+  host_.OnMessageReceived(consumed, filter_.get(), &msg_was_ok);
+  EXPECT_EQ(0, data_buffer->allocated_chunks());
+  EXPECT_EQ(0, filter_->bad_messages_received());
+
+  // Returning a chunk the child no longer holds is a bad message.
+  ResourceHostMsg_DataChunksConsumed consumed_again(
+      std::vector<int>(1, chunks[0]));
+  host_.OnMessageReceived(consumed_again, filter_.get(), &msg_was_ok);
+  EXPECT_EQ(1, filter_->bad_messages_received());
+  EXPECT_EQ(0, data_buffer->allocated_chunks());
+
+  // The next request reuses the buffer without sending it again.
+  MakeTestRequest(0, 3, net::URLRequestTestJob::test_url_3());
+  while (net::URLRequestTestJob::ProcessOnePendingMessage()) {}
+  for (size_t i = 0; i < messages.size(); ++i)
+    EXPECT_NE(ResourceMsg_SetDataBuffer::ID, messages[i].type());
+  msgs.clear();
+  accum_.GetClassifiedMessages(&msgs);
+  ASSERT_EQ(1U, msgs.size());
+  int chunk;
+  CheckSuccessfulRequestInBuffer(msgs[0],
+                                 net::URLRequestTestJob::test_data_3(),
+                                 *shared_memory, chunk_size, &chunk);
+}
+
 // Tests whether messages get canceled properly. We issue three requests,
 // cancel one of them, and make sure that each sent the proper notifications.
 TEST_F(ResourceDispatcherHostTest, Cancel) {
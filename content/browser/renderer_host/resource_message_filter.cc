@@ -4,13 +4,28 @@
 
 #include "content/browser/renderer_host/resource_message_filter.h"
 
+#include "content/browser/renderer_host/resource_data_buffer.h"
 #include "content/browser/renderer_host/resource_dispatcher_host_impl.h"
+#include "content/common/resource_messages.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/resource_context.h"
 
 using content::BrowserMessageFilter;
+using content::ResourceDataBuffer;
 using content::ResourceDispatcherHostImpl;
 
+namespace {
+
+// The data buffer holds 32 chunks of 64 kilobytes; a chunk is the largest
+// read a request makes.  A request is allowed more chunks than the number of
+// unacknowledged data messages ResourceDispatcherHostImpl lets it have, so a
+// single fast response is paused by that limit before it runs out of chunks.
+const int kDataBufferChunkSize = 65536;
+const int kDataBufferChunkCount = 32;
+const int kMaxDataBufferChunksPerRequest = 24;
+
+}  // namespace
+
 ResourceMessageFilter::ResourceMessageFilter(
     int child_id,
     content::ProcessType process_type,
@@ -19,7 +34,8 @@ ResourceMessageFilter::ResourceMessageFilter(
     : child_id_(child_id),
       process_type_(process_type),
       resource_context_(resource_context),
-      url_request_context_selector_(url_request_context_selector) {
+      url_request_context_selector_(url_request_context_selector),
+      use_data_buffer_(true) {
   DCHECK(resource_context);
   DCHECK(url_request_context_selector);
 }
@@ -41,6 +57,27 @@ bool ResourceMessageFilter::OnMessageReceived(const IPC::Message& message,
       message, this, message_was_ok);
 }
 
+ResourceDataBuffer* ResourceMessageFilter::GetDataBuffer() {
+  if (data_buffer_.get() || !use_data_buffer_)
+    return data_buffer_.get();
+
+  scoped_refptr<ResourceDataBuffer> buffer(
+      new ResourceDataBuffer(kDataBufferChunkSize, kDataBufferChunkCount,
+                             kMaxDataBufferChunksPerRequest));
+  base::SharedMemoryHandle handle;
+  if (!buffer->Initialize() ||
+      !buffer->ShareToProcess(peer_handle(), &handle)) {
+    DLOG(ERROR) << "Couldn't set up the resource data buffer";
+    // Don't try again for every read.
+    use_data_buffer_ = false;
+    return NULL;
+  }
+  Send(new ResourceMsg_SetDataBuffer(handle, buffer->chunk_size(),
+                                     buffer->chunk_count()));
+  data_buffer_ = buffer;
+  return data_buffer_.get();
+}
+
 net::URLRequestContext* ResourceMessageFilter::GetURLRequestContext(
     ResourceType::Type type) {
   return url_request_context_selector_->GetRequestContext(type);
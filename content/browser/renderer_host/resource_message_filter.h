@@ -5,6 +5,7 @@
 #ifndef CONTENT_BROWSER_RENDERER_HOST_RESOURCE_MESSAGE_FILTER_H_
 #define CONTENT_BROWSER_RENDERER_HOST_RESOURCE_MESSAGE_FILTER_H_
 
+#include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "content/common/content_export.h"
 #include "content/public/browser/browser_message_filter.h"
@@ -13,6 +14,7 @@
 
 namespace content {
 class ResourceContext;
+class ResourceDataBuffer;
 }  // namespace content
 
 namespace net {
@@ -59,6 +61,22 @@ class CONTENT_EXPORT ResourceMessageFilter
   net::URLRequestContext* GetURLRequestContext(
       ResourceType::Type request_type);
 
+  // Returns the buffer that response data for this child is read into,
+  // creating it and sending it to the child on first use.  Returns NULL if
+  // the buffer is disabled or could not be set up, in which case the caller
+  // should send each read in its own shared memory segment.
+  content::ResourceDataBuffer* GetDataBuffer();
+
+  // Returns the data buffer if GetDataBuffer() has created one.
+  content::ResourceDataBuffer* data_buffer() const {
+    return data_buffer_.get();
+  }
+
+  // Enabled by default.  Must be set before the first GetDataBuffer().
+  void set_use_data_buffer(bool use_data_buffer) {
+    use_data_buffer_ = use_data_buffer;
+  }
+
   int child_id() const { return child_id_; }
   content::ProcessType process_type() const { return process_type_; }
 
@@ -77,6 +95,9 @@ class CONTENT_EXPORT ResourceMessageFilter
 
   const scoped_ptr<URLRequestContextSelector> url_request_context_selector_;
 
+  bool use_data_buffer_;
+  scoped_refptr<content::ResourceDataBuffer> data_buffer_;
+
   DISALLOW_IMPLICIT_CONSTRUCTORS(ResourceMessageFilter);
 };
 
@@ -19,6 +19,7 @@
 #include "net/base/load_states.h"
 #include "webkit/glue/resource_type.h"
 
+class DownloadResourceHandler;
 class ResourceHandler;
 class SSLClientAuthHandler;
 
@@ -99,6 +100,14 @@ class ResourceRequestInfoImpl : public ResourceRequestInfo,
     cross_site_handler_ = h;
   }
 
+  // DownloadResourceHandler for this request, if it is the main request of a
+  // download that is split into byte ranges.  (NULL otherwise.)  Like
+  // cross_site_handler, it is part of the chain and not owned by this class.
+  DownloadResourceHandler* download_handler() { return download_handler_; }
+  void set_download_handler(DownloadResourceHandler* h) {
+    download_handler_ = h;
+  }
+
   // Pointer to the login delegate, or NULL if there is none for this request.
   ResourceDispatcherHostLoginDelegate* login_delegate() const {
     return login_delegate_.get();
@@ -214,6 +223,7 @@ class ResourceRequestInfoImpl : public ResourceRequestInfo,
 
   // Non-owning, may be NULL.
   CrossSiteResourceHandler* cross_site_handler_;
+  DownloadResourceHandler* download_handler_;
 
   scoped_refptr<ResourceDispatcherHostLoginDelegate> login_delegate_;
   scoped_refptr<SSLClientAuthHandler> ssl_client_auth_handler_;
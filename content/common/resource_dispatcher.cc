@@ -277,6 +277,8 @@ void IPCResourceLoaderBridge::UpdateRoutingId(int new_routing_id) {
 
 ResourceDispatcher::ResourceDispatcher(IPC::Message::Sender* sender)
     : message_sender_(sender),
+      data_buffer_chunk_size_(0),
+      data_buffer_chunk_count_(0),
       ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)),
       delegate_(NULL) {
 }
@@ -287,6 +289,14 @@ ResourceDispatcher::~ResourceDispatcher() {
 // ResourceDispatcher implementation ------------------------------------------
 
 bool ResourceDispatcher::OnMessageReceived(const IPC::Message& message) {
+  // The data buffer isn't tied to a request.
+  if (message.type() == ResourceMsg_SetDataBuffer::ID) {
+    IPC_BEGIN_MESSAGE_MAP(ResourceDispatcher, message)
+      IPC_MESSAGE_HANDLER(ResourceMsg_SetDataBuffer, OnSetDataBuffer)
+    IPC_END_MESSAGE_MAP()
+    return true;
+  }
+
   if (!IsResourceDispatcherMessage(message)) {
     return false;
   }
@@ -403,6 +413,57 @@ void ResourceDispatcher::OnReceivedData(const IPC::Message& message,
   }
 }
 
+void ResourceDispatcher::OnSetDataBuffer(base::SharedMemoryHandle handle,
+                                         int chunk_size,
+                                         int chunk_count) {
+  DCHECK(!data_buffer_.get());
+  data_buffer_.reset(new base::SharedMemory(handle, true));  // read only
+  if (chunk_size <= 0 || chunk_count <= 0 ||
+      !data_buffer_->Map(chunk_size * chunk_count)) {
+    // The data sent in the buffer will be lost, but its chunks still go back
+    // so the browser doesn't stall.
+    LOG(ERROR) << "Couldn't map the resource data buffer";
+    data_buffer_.reset();
+    return;
+  }
+  data_buffer_chunk_size_ = chunk_size;
+  data_buffer_chunk_count_ = chunk_count;
+}
+
+void ResourceDispatcher::OnReceivedDataInBuffer(int request_id,
+                                                int chunk,
+                                                int data_len,
+                                                int encoded_data_length) {
+  PendingRequestInfo* request_info = GetPendingRequestInfo(request_id);
+  if (request_info && data_buffer_.get() &&
+      chunk >= 0 && chunk < data_buffer_chunk_count_ &&
+      data_len > 0 && data_len <= data_buffer_chunk_size_) {
+    const char* data = static_cast<char*>(data_buffer_->memory()) +
+                       chunk * data_buffer_chunk_size_;
+    request_info->peer->OnReceivedData(data, data_len, encoded_data_length);
+  }
+
+  // The peer has copied what it needs.
+  ReleaseDataChunk(chunk);
+}
+
+void ResourceDispatcher::ReleaseDataChunk(int chunk) {
+  if (consumed_data_chunks_.empty()) {
+    MessageLoop::current()->PostTask(FROM_HERE,
+        base::Bind(&ResourceDispatcher::SendConsumedDataChunks,
+                   weak_factory_.GetWeakPtr()));
+  }
+  consumed_data_chunks_.push_back(chunk);
+}
+
+void ResourceDispatcher::SendConsumedDataChunks() {
+  if (consumed_data_chunks_.empty())
+    return;
+  message_sender()->Send(
+      new ResourceHostMsg_DataChunksConsumed(consumed_data_chunks_));
+  consumed_data_chunks_.clear();
+}
+
 void ResourceDispatcher::OnDownloadedData(const IPC::Message& message,
                                           int request_id,
                                           int data_len) {
@@ -555,6 +616,8 @@ void ResourceDispatcher::DispatchMessage(const IPC::Message& message) {
                         OnReceivedCachedMetadata)
     IPC_MESSAGE_HANDLER(ResourceMsg_ReceivedRedirect, OnReceivedRedirect)
     IPC_MESSAGE_HANDLER(ResourceMsg_DataReceived, OnReceivedData)
+    IPC_MESSAGE_HANDLER(ResourceMsg_DataReceivedInBuffer,
+                        OnReceivedDataInBuffer)
     IPC_MESSAGE_HANDLER(ResourceMsg_DataDownloaded, OnDownloadedData)
     IPC_MESSAGE_HANDLER(ResourceMsg_RequestComplete, OnRequestComplete)
   IPC_END_MESSAGE_MAP()
@@ -663,6 +726,7 @@ bool ResourceDispatcher::IsResourceDispatcherMessage(
     case ResourceMsg_ReceivedCachedMetadata::ID:
     case ResourceMsg_ReceivedRedirect::ID:
     case ResourceMsg_DataReceived::ID:
+    case ResourceMsg_DataReceivedInBuffer::ID:
     case ResourceMsg_DataDownloaded::ID:
     case ResourceMsg_RequestComplete::ID:
       return true;
@@ -674,7 +738,6 @@ bool ResourceDispatcher::IsResourceDispatcherMessage(
   return false;
 }
 
-// static
 void ResourceDispatcher::ReleaseResourcesInDataMessage(
     const IPC::Message& message) {
   PickleIterator iter(message);
@@ -693,10 +756,13 @@ void ResourceDispatcher::ReleaseResourcesInDataMessage(
                                                          &shm_handle)) {
       base::SharedMemory::CloseHandle(shm_handle);
     }
+  } else if (message.type() == ResourceMsg_DataReceivedInBuffer::ID) {
+    int chunk;
+    if (message.ReadInt(&iter, &chunk))
+      ReleaseDataChunk(chunk);
   }
 }
 
-// static
 void ResourceDispatcher::ReleaseResourcesInMessageQueue(MessageQueue* queue) {
   while (!queue->empty()) {
     IPC::Message* message = queue->front();
@@ -10,9 +10,11 @@
 
 #include <deque>
 #include <string>
+#include <vector>
 
 #include "base/hash_tables.h"
 #include "base/memory/linked_ptr.h"
+#include "base/memory/scoped_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/shared_memory.h"
 #include "base/time.h"
@@ -122,6 +124,14 @@ class CONTENT_EXPORT ResourceDispatcher : public IPC::Channel::Listener {
       base::SharedMemoryHandle data,
       int data_len,
       int encoded_data_length);
+  void OnSetDataBuffer(base::SharedMemoryHandle handle,
+                       int chunk_size,
+                       int chunk_count);
+  void OnReceivedDataInBuffer(
+      int request_id,
+      int chunk,
+      int data_len,
+      int encoded_data_length);
   void OnDownloadedData(
       const IPC::Message& message,
       int request_id,
@@ -148,6 +158,14 @@ class CONTENT_EXPORT ResourceDispatcher : public IPC::Channel::Listener {
       const PendingRequestInfo& request_info,
       const base::TimeTicks& browser_completion_time) const;
 
+  // Queues |chunk| of the data buffer to be returned to the browser.  The
+  // chunks consumed while handling the messages already queued on this
+  // thread go back together in one ResourceHostMsg_DataChunksConsumed.
+  void ReleaseDataChunk(int chunk);
+
+  // Sends the chunks queued by ReleaseDataChunk().
+  void SendConsumedDataChunks();
+
   // Returns true if the message passed in is a resource related message.
   static bool IsResourceDispatcherMessage(const IPC::Message& message);
 
@@ -155,18 +173,28 @@ class CONTENT_EXPORT ResourceDispatcher : public IPC::Channel::Listener {
   // handle in it that we should cleanup it up nicely. This method accepts any
   // message and determine whether the message is
   // ViewHostMsg_Resource_DataReceived and clean up the shared memory handle.
-  static void ReleaseResourcesInDataMessage(const IPC::Message& message);
+  // A ResourceMsg_DataReceivedInBuffer has its chunk returned instead.
+  void ReleaseResourcesInDataMessage(const IPC::Message& message);
 
   // Iterate through a message queue and clean up the messages by calling
   // ReleaseResourcesInDataMessage and removing them from the queue. Intended
   // for use on deferred message queues that are no longer needed.
-  static void ReleaseResourcesInMessageQueue(MessageQueue* queue);
+  void ReleaseResourcesInMessageQueue(MessageQueue* queue);
 
   IPC::Message::Sender* message_sender_;
 
   // All pending requests issued to the host
   PendingRequestList pending_requests_;
 
+  // Our read-only mapping of the buffer the browser reads response data
+  // into, set by ResourceMsg_SetDataBuffer.
+  scoped_ptr<base::SharedMemory> data_buffer_;
+  int data_buffer_chunk_size_;
+  int data_buffer_chunk_count_;
+
+  // Chunks waiting to be returned by SendConsumedDataChunks().
+  std::vector<int> consumed_data_chunks_;
+
   base::WeakPtrFactory<ResourceDispatcher> weak_factory_;
 
   content::ResourceDispatcherDelegate* delegate_;
@@ -204,6 +204,77 @@ TEST_F(ResourceDispatcherTest, RoundTrip) {
   delete bridge;
 }
 
+// Tests that data sent in the shared data buffer reaches the peer, and that
+// the chunks it came in go back to the browser together once the messages
+// already queued have been handled, including chunks of dropped messages.
+TEST_F(ResourceDispatcherTest, DataBuffer) {
+  MessageLoop message_loop;
+  const int kChunkSize = 4096;
+  const int kChunkCount = 4;
+  const int kSplit = 10;
+
+  base::SharedMemory shared_mem;
+  ASSERT_TRUE(shared_mem.CreateAndMapAnonymous(kChunkSize * kChunkCount));
+  base::SharedMemoryHandle handle;
+  ASSERT_TRUE(shared_mem.ShareToProcess(base::Process::Current().handle(),
+                                        &handle));
+  EXPECT_TRUE(dispatcher_->OnMessageReceived(
+      ResourceMsg_SetDataBuffer(handle, kChunkSize, kChunkCount)));
+
+  TestRequestCallback callback;
+  ResourceLoaderBridge* bridge = CreateBridge();
+  bridge->Start(&callback);
+
+  ASSERT_EQ(1U, message_queue_.size());
+  int request_id;
+  ResourceHostMsg_Request request;
+  ASSERT_TRUE(ResourceHostMsg_RequestResource::Read(
+      &message_queue_[0], &request_id, &request));
+  message_queue_.clear();
+
+  content::ResourceResponseHead response;
+  std::string raw_headers(test_page_headers);
+  std::replace(raw_headers.begin(), raw_headers.end(), '\n', '\0');
+  response.headers = new net::HttpResponseHeaders(raw_headers);
+  response.mime_type = test_page_mime_type;
+  response.charset = test_page_charset;
+  EXPECT_TRUE(dispatcher_->OnMessageReceived(
+      ResourceMsg_ReceivedResponse(0, request_id, response)));
+
+  // Send the page in two chunks, out of order in the buffer.
+  char* data = static_cast<char*>(shared_mem.memory());
+  memcpy(data + 2 * kChunkSize, test_page_contents, kSplit);
+  memcpy(data + kChunkSize, test_page_contents + kSplit,
+         test_page_contents_len - kSplit);
+  EXPECT_TRUE(dispatcher_->OnMessageReceived(
+      ResourceMsg_DataReceivedInBuffer(0, request_id, 2, kSplit, kSplit)));
+  EXPECT_TRUE(dispatcher_->OnMessageReceived(
+      ResourceMsg_DataReceivedInBuffer(0, request_id, 1,
+                                       test_page_contents_len - kSplit,
+                                       test_page_contents_len - kSplit)));
+  EXPECT_EQ(test_page_contents, callback.data());
+
+  // Data for a request we no longer know about is dropped.
+  EXPECT_TRUE(dispatcher_->OnMessageReceived(
+      ResourceMsg_DataReceivedInBuffer(0, request_id + 1, 3, 1, 1)));
+
+  // Nothing goes back until the message loop gets around to it.
+  EXPECT_TRUE(message_queue_.empty());
+  message_loop.RunAllPending();
+
+  ASSERT_EQ(1U, message_queue_.size());
+  Tuple1<std::vector<int> > consumed;
+  ASSERT_TRUE(ResourceHostMsg_DataChunksConsumed::Read(&message_queue_[0],
+                                                       &consumed));
+  ASSERT_EQ(3U, consumed.a.size());
+  EXPECT_EQ(2, consumed.a[0]);
+  EXPECT_EQ(1, consumed.a[1]);
+  EXPECT_EQ(3, consumed.a[2]);
+  message_queue_.clear();
+
+  delete bridge;
+}
+
 // Tests that the request IDs are straight when there are multiple requests.
 TEST_F(ResourceDispatcherTest, MultipleRequests) {
   // FIXME
@@ -158,6 +158,25 @@ IPC_MESSAGE_ROUTED4(ResourceMsg_DataReceived,
                     int /* data_len */,
                     int /* encoded_data_length */)
 
+// Sent once to each child process, before the first
+// ResourceMsg_DataReceivedInBuffer, with the shared memory segment that the
+// browser reads response data into for that child.  The segment holds
+// |chunk_count| chunks of |chunk_size| bytes.
+IPC_MESSAGE_CONTROL3(ResourceMsg_SetDataBuffer,
+                     base::SharedMemoryHandle /* handle */,
+                     int /* chunk_size */,
+                     int /* chunk_count */)
+
+// Sent when some data from a resource request is ready in chunk |chunk| of
+// the data buffer.  The child owns the chunk until it returns it with
+// ResourceHostMsg_DataChunksConsumed, which also stands in for
+// ResourceHostMsg_DataReceived_ACK.
+IPC_MESSAGE_ROUTED4(ResourceMsg_DataReceivedInBuffer,
+                    int /* request_id */,
+                    int /* chunk */,
+                    int /* data_len */,
+                    int /* encoded_data_length */)
+
 // Sent when some data from a resource request has been downloaded to
 // file. This is only called in the 'download_to_file' case and replaces
 // ResourceMsg_DataReceived in the call sequence in that case.
@@ -208,6 +227,12 @@ IPC_SYNC_MESSAGE_ROUTED2_1(ResourceHostMsg_SyncLoad,
 IPC_MESSAGE_ROUTED1(ResourceHostMsg_DataReceived_ACK,
                     int /* request_id */)
 
+// Returns chunks of the data buffer whose ResourceMsg_DataReceivedInBuffer
+// messages the child has processed or dropped.  Chunks are returned in
+// batches rather than one message per chunk.
+IPC_MESSAGE_CONTROL1(ResourceHostMsg_DataChunksConsumed,
+                     std::vector<int> /* chunks */)
+
 // Sent when the renderer has processed a DataDownloaded message.
 IPC_MESSAGE_ROUTED1(ResourceHostMsg_DataDownloaded_ACK,
                     int /* request_id */)
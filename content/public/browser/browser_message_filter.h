@@ -72,9 +72,8 @@ class CONTENT_EXPORT BrowserMessageFilter :
   static bool CheckCanDispatchOnUI(const IPC::Message& message,
                                    IPC::Message::Sender* sender);
 
- protected:
-  // Call this if a message couldn't be deserialized.  This kills the renderer.
-  // Can be called on any thread.
+  // Call this if a message couldn't be deserialized, or its contents are
+  // invalid.  This kills the renderer.  Can be called on any thread.
   virtual void BadMessageReceived();
 
  private:
@@ -141,7 +141,8 @@ class CONTENT_EXPORT DownloadItem {
   // Called periodically from the download thread, or from the UI thread
   // for saving packages.
   // |bytes_so_far| is the number of bytes received so far.
-  // |hash_state| is the current hash state.
+  // |hash_state| is the current hash state; it is empty for the periodic
+  // updates of a download that is still in progress.
   virtual void UpdateProgress(int64 bytes_so_far,
                               int64 bytes_per_sec,
                               const std::string& hash_state) = 0;
@@ -272,6 +273,8 @@ class CONTENT_EXPORT DownloadItem {
   virtual int64 GetTotalBytes() const = 0;
   virtual void SetTotalBytes(int64 total_bytes) = 0;
   virtual int64 GetReceivedBytes() const = 0;
+  // Only set while the download is interrupted.  In-progress updates don't
+  // carry it, and completion replaces it with the final hash.
   virtual const std::string& GetHashState() const = 0;
   virtual int32 GetId() const = 0;
   virtual DownloadId GetGlobalId() const = 0;
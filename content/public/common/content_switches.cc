@@ -16,6 +16,10 @@ const char kAllowSandboxDebugging[]         = "allow-sandbox-debugging";
 // Allow compositing on chrome:// pages.
 const char kAllowWebUICompositing[]         = "allow-webui-compositing";
 
+// The number of resources an application cache update fetches at once.
+const char kAppCacheMaxConcurrentUpdateFetches[] =
+    "appcache-max-concurrent-update-fetches";
+
 // Enumerates and prints a child process' most dangerous handles when it
 // is terminated.
 const char kAuditHandles[]                  = "enable-handle-auditing";
@@ -248,6 +252,10 @@ const char kEnableCssShaders[]              = "enable-css-shaders";
 // Enables device motion events.
 const char kEnableDeviceMotion[]            = "enable-device-motion";
 
+// Runs the browser's IO message loops directly on epoll instead of libevent,
+// with edge-triggered watches for the sockets that ask for them.  Linux only.
+const char kEnableEpollMessagePump[]        = "enable-epoll-message-pump";
+
 // Enables the fastback page cache.
 const char kEnableFastback[]                = "enable-fastback";
 
@@ -442,6 +450,10 @@ const char kNoReferrers[]                   = "no-referrers";
 // Disables the sandbox for all process types that are normally sandboxed.
 const char kNoSandbox[]                     = "no-sandbox";
 
+// Splits downloads from servers that support byte ranges into up to this many
+// requests for separate ranges of the file, which are received at once.
+const char kParallelDownloadRequests[]      = "parallel-download-requests";
+
 // Read previously recorded data from the cache. Only cached data is read.
 // See kRecordMode.
 const char kPlaybackMode[]                  = "playback-mode";
@@ -16,6 +16,7 @@ namespace switches {
 CONTENT_EXPORT extern const char kAllowFileAccessFromFiles[];
 extern const char kAllowSandboxDebugging[];
 extern const char kAllowWebUICompositing[];
+extern const char kAppCacheMaxConcurrentUpdateFetches[];
 extern const char kAuditHandles[];
 extern const char kAuditAllHandles[];
 CONTENT_EXPORT extern const char kBrowserAssertTest[];
@@ -86,6 +87,7 @@ extern const char kEnableCssShaders[];
 CONTENT_EXPORT extern const char kEnableDeferred2dCanvas[];
 extern const char kEnableCompositeToTexture[];
 CONTENT_EXPORT extern const char kEnableDeviceMotion[];
+extern const char kEnableEpollMessagePump[];
 extern const char kEnableFastback[];
 CONTENT_EXPORT extern const char kEnableFixedLayout[];
 CONTENT_EXPORT extern const char kDisableFullScreen[];
@@ -137,6 +139,7 @@ CONTENT_EXPORT extern const char kNaClLoaderProcess[];
 extern const char kNoJsRandomness[];
 CONTENT_EXPORT extern const char kNoReferrers[];
 CONTENT_EXPORT extern const char kNoSandbox[];
+CONTENT_EXPORT extern const char kParallelDownloadRequests[];
 CONTENT_EXPORT extern const char kPlaybackMode[];
 extern const char kPluginLauncher[];
 CONTENT_EXPORT extern const char kPluginPath[];
@@ -0,0 +1,218 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/test/net/url_request_large_body_job.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/message_loop.h"
+#include "base/string_number_conversions.h"
+#include "base/string_util.h"
+#include "base/stringprintf.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/base/io_buffer.h"
+#include "net/http/http_byte_range.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_util.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_filter.h"
+
+using content::BrowserThread;
+
+namespace {
+
+const char kHostname[] = "large-body.test";
+const char kTextPath[] = "/text/";
+const char kDownloadPath[] = "/download/";
+
+const char kPageContent[] = "<html><body></body></html>";
+
+// Every download has the same contents, so they can share a strong ETag.
+const char kDownloadETag[] = "\"large-body\"";
+
+}  // namespace
+
+// static
+int64 URLRequestLargeBodyJob::bytes_served_ = 0;
+
+// static
+GURL URLRequestLargeBodyJob::GetURL(int size, bool is_download) {
+  return GURL(base::StringPrintf("http://%s%s%d", kHostname,
+                                 is_download ? kDownloadPath : kTextPath,
+                                 size));
+}
+
+// static
+int64 URLRequestLargeBodyJob::bytes_served() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  return bytes_served_;
+}
+
+// static
+void URLRequestLargeBodyJob::AddUrlHandler() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  net::URLRequestFilter::GetInstance()->AddHostnameHandler(
+      "http", kHostname, &URLRequestLargeBodyJob::Factory);
+}
+
+// static
+void URLRequestLargeBodyJob::RemoveUrlHandler() {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  net::URLRequestFilter::GetInstance()->RemoveHostnameHandler(
+      "http", kHostname);
+}
+
+// static
+net::URLRequestJob* URLRequestLargeBodyJob::Factory(
+    net::URLRequest* request,
+    const std::string& scheme) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
+  return new URLRequestLargeBodyJob(request);
+}
+
+URLRequestLargeBodyJob::URLRequestLargeBodyJob(net::URLRequest* request)
+    : net::URLRequestJob(request),
+      body_type_(BODY_PAGE),
+      body_size_(arraysize(kPageContent) - 1),
+      is_range_(false),
+      offset_(0),
+      length_(0),
+      bytes_sent_(0),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
+  const std::string path = request->url().path();
+  BodyType type = BODY_PAGE;
+  size_t size_start = std::string::npos;
+  if (StartsWithASCII(path, kTextPath, true)) {
+    type = BODY_TEXT;
+    size_start = arraysize(kTextPath) - 1;
+  } else if (StartsWithASCII(path, kDownloadPath, true)) {
+    type = BODY_DOWNLOAD;
+    size_start = arraysize(kDownloadPath) - 1;
+  }
+  if (size_start != std::string::npos) {
+    // Anything after the size is only there to name the file.
+    size_t size_end = path.find('/', size_start);
+    int size = 0;
+    if (base::StringToInt(path.substr(size_start, size_end - size_start),
+                          &size) &&
+        size >= 0) {
+      body_type_ = type;
+      body_size_ = size;
+    }
+  }
+  length_ = body_size_;
+}
+
+URLRequestLargeBodyJob::~URLRequestLargeBodyJob() {
+}
+
+void URLRequestLargeBodyJob::SetExtraRequestHeaders(
+    const net::HttpRequestHeaders& headers) {
+  if (body_type_ != BODY_DOWNLOAD)
+    return;
+
+  // Only a single range is supported, and only while the If-Range validator,
+  // if any, still matches.  Anything else gets the whole body.
+  std::string range_header;
+  std::string if_range;
+  std::vector<net::HttpByteRange> ranges;
+  if (!headers.GetHeader(net::HttpRequestHeaders::kRange, &range_header) ||
+      !net::HttpUtil::ParseRangeHeader(range_header, &ranges) ||
+      ranges.size() != 1 ||
+      !ranges[0].ComputeBounds(body_size_)) {
+    return;
+  }
+  if (headers.GetHeader(net::HttpRequestHeaders::kIfRange, &if_range) &&
+      if_range != kDownloadETag) {
+    return;
+  }
+  is_range_ = true;
+  offset_ = static_cast<int>(ranges[0].first_byte_position());
+  length_ = static_cast<int>(ranges[0].last_byte_position()) - offset_ + 1;
+}
+
+void URLRequestLargeBodyJob::Start() {
+  MessageLoop::current()->PostTask(
+      FROM_HERE,
+      base::Bind(&URLRequestLargeBodyJob::StartAsync,
+                 weak_factory_.GetWeakPtr()));
+}
+
+void URLRequestLargeBodyJob::StartAsync() {
+  set_expected_content_size(length_);
+  NotifyHeadersComplete();
+}
+
+bool URLRequestLargeBodyJob::ReadRawData(net::IOBuffer* buf,
+                                         int buf_size,
+                                         int* bytes_read) {
+  int bytes = std::min(buf_size, length_ - bytes_sent_);
+  if (body_type_ == BODY_PAGE)
+    memcpy(buf->data(), kPageContent + offset_ + bytes_sent_, bytes);
+  else
+    memset(buf->data(), 'x', bytes);
+  bytes_sent_ += bytes;
+  bytes_served_ += bytes;
+  *bytes_read = bytes;
+  return true;
+}
+
+// Public virtual version.
+void URLRequestLargeBodyJob::GetResponseInfo(net::HttpResponseInfo* info) {
+  // Forward to private const version.
+  GetResponseInfoConst(info);
+}
+
+// Private const version.
+void URLRequestLargeBodyJob::GetResponseInfoConst(
+    net::HttpResponseInfo* info) const {
+  std::string raw_headers(is_range_ ? "HTTP/1.1 206 Partial Content\n" :
+                                      "HTTP/1.1 200 OK\n");
+  switch (body_type_) {
+    case BODY_PAGE:
+      raw_headers.append("Content-type: text/html; charset=utf-8\n");
+      break;
+    case BODY_TEXT:
+      raw_headers.append("Content-type: text/plain; charset=utf-8\n");
+      break;
+    case BODY_DOWNLOAD:
+      raw_headers.append("Content-type: application/octet-stream\n"
+                         "Accept-Ranges: bytes\n");
+      raw_headers.append(base::StringPrintf("ETag: %s\n", kDownloadETag));
+      break;
+  }
+  if (is_range_) {
+    raw_headers.append(base::StringPrintf("Content-Range: bytes %d-%d/%d\n",
+                                          offset_, offset_ + length_ - 1,
+                                          body_size_));
+  }
+  raw_headers.append(base::StringPrintf("Content-Length: %d\n", length_));
+
+  // ParseRawHeaders expects \0 to end each header line.
+  ReplaceSubstringsAfterOffset(&raw_headers, 0, "\n", std::string("\0", 1));
+  info->headers = new net::HttpResponseHeaders(raw_headers);
+}
+
+bool URLRequestLargeBodyJob::GetMimeType(std::string* mime_type) const {
+  net::HttpResponseInfo info;
+  GetResponseInfoConst(&info);
+  return info.headers && info.headers->GetMimeType(mime_type);
+}
+
+bool URLRequestLargeBodyJob::GetCharset(std::string* charset) {
+  net::HttpResponseInfo info;
+  GetResponseInfoConst(&info);
+  return info.headers && info.headers->GetCharset(charset);
+}
+
+int URLRequestLargeBodyJob::GetResponseCode() const {
+  net::HttpResponseInfo info;
+  GetResponseInfoConst(&info);
+  return info.headers->response_code();
+}
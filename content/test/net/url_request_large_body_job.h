@@ -0,0 +1,85 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+// This class serves large response bodies from the browser process, so that
+// browser tests can time how quickly the browser moves data around rather
+// than how quickly the test server, which answers one request at a time,
+// sends it.
+
+#ifndef CONTENT_TEST_NET_URL_REQUEST_LARGE_BODY_JOB_H_
+#define CONTENT_TEST_NET_URL_REQUEST_LARGE_BODY_JOB_H_
+#pragma once
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/memory/weak_ptr.h"
+#include "googleurl/src/gurl.h"
+#include "net/url_request/url_request_job.h"
+
+class URLRequestLargeBodyJob : public net::URLRequestJob {
+ public:
+  // Returns the URL of a |size| byte body, served as text or, if
+  // |is_download|, as application/octet-stream.  Further path components
+  // may be appended, e.g. to give each download its own file name.  Any
+  // other URL on the same host, such as its root, is an empty HTML page.
+  // Downloads also answer single byte-range requests.
+  static GURL GetURL(int size, bool is_download);
+
+  // Returns how many body bytes all of the jobs have served so far.  Must be
+  // called on the IO thread.
+  static int64 bytes_served();
+
+  // Adds (removes) the handler for the URLs above to the
+  // net::URLRequestFilter.  Must be called on the IO thread.
+  static void AddUrlHandler();
+  static void RemoveUrlHandler();
+
+  static net::URLRequestJob* Factory(net::URLRequest* request,
+                                     const std::string& scheme);
+
+  // net::URLRequestJob methods
+  virtual void SetExtraRequestHeaders(
+      const net::HttpRequestHeaders& headers) OVERRIDE;
+  virtual void Start() OVERRIDE;
+  virtual bool GetMimeType(std::string* mime_type) const OVERRIDE;
+  virtual bool GetCharset(std::string* charset) OVERRIDE;
+  virtual void GetResponseInfo(net::HttpResponseInfo* info) OVERRIDE;
+  virtual int GetResponseCode() const OVERRIDE;
+  virtual bool ReadRawData(net::IOBuffer* buf,
+                           int buf_size,
+                           int* bytes_read) OVERRIDE;
+
+ private:
+  enum BodyType {
+    BODY_PAGE,
+    BODY_TEXT,
+    BODY_DOWNLOAD
+  };
+
+  explicit URLRequestLargeBodyJob(net::URLRequest* request);
+  virtual ~URLRequestLargeBodyJob();
+
+  void GetResponseInfoConst(net::HttpResponseInfo* info) const;
+  void StartAsync();
+
+  BodyType body_type_;
+  int body_size_;
+
+  // The part of the body this job sends: all of it, unless a byte range was
+  // asked for.
+  bool is_range_;
+  int offset_;
+  int length_;
+
+  int bytes_sent_;
+
+  static int64 bytes_served_;
+
+  base::WeakPtrFactory<URLRequestLargeBodyJob> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(URLRequestLargeBodyJob);
+};
+
+#endif  // CONTENT_TEST_NET_URL_REQUEST_LARGE_BODY_JOB_H_
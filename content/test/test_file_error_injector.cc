@@ -46,7 +46,7 @@ class DownloadFileWithErrors: public DownloadFileImpl {
 
   // DownloadFile interface.
   virtual net::Error Initialize() OVERRIDE;
-  virtual net::Error AppendDataToFile(const char* data,
+  virtual net::Error AppendDataToFile(net::IOBuffer* data,
                                       size_t data_len) OVERRIDE;
   virtual net::Error Rename(const FilePath& full_path) OVERRIDE;
 
@@ -100,7 +100,7 @@ net::Error DownloadFileWithErrors::Initialize() {
       DownloadFileImpl::Initialize());
 }
 
-net::Error DownloadFileWithErrors::AppendDataToFile(const char* data,
+net::Error DownloadFileWithErrors::AppendDataToFile(net::IOBuffer* data,
                                                     size_t data_len) {
   return ShouldReturnError(
       content::TestFileErrorInjector::FILE_OPERATION_WRITE,
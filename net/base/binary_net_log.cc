@@ -0,0 +1,178 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/binary_net_log.h"
+
+#include <string.h>
+
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/pickle.h"
+#include "base/values.h"
+
+namespace net {
+
+namespace {
+
+// Identifies a binary capture.  Bump the trailing version byte whenever the
+// record layout changes.
+const char kMagic[] = "NETLOGB\x01";
+const size_t kMagicLength = sizeof(kMagic) - 1;
+
+void AppendChunk(const char* chunk, uint32 length, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&length), sizeof(length));
+  out->append(chunk, length);
+}
+
+}  // namespace
+
+// static
+void BinaryNetLogWriter::AppendHeader(const std::string& constants_json,
+                                      std::string* out) {
+  out->append(kMagic, kMagicLength);
+  AppendChunk(constants_json.data(),
+              static_cast<uint32>(constants_json.size()), out);
+}
+
+// static
+void BinaryNetLogWriter::AppendEntry(NetLog::EventType type,
+                                     const base::TimeTicks& time,
+                                     const NetLog::Source& source,
+                                     NetLog::EventPhase phase,
+                                     const std::string& params_json,
+                                     std::string* out) {
+  Pickle pickle;
+  pickle.WriteInt(static_cast<int>(type));
+  pickle.WriteInt64(time.ToInternalValue());
+  pickle.WriteInt(static_cast<int>(source.type));
+  pickle.WriteUInt32(source.id);
+  pickle.WriteInt(static_cast<int>(phase));
+  pickle.WriteString(params_json);
+  AppendChunk(static_cast<const char*>(pickle.data()),
+              static_cast<uint32>(pickle.size()), out);
+}
+
+BinaryNetLogReader::Entry::Entry()
+    : type(NetLog::TYPE_CANCELLED),
+      phase(NetLog::PHASE_NONE) {
+}
+
+BinaryNetLogReader::Entry::~Entry() {}
+
+BinaryNetLogReader::BinaryNetLogReader(const std::string& data)
+    : data_(data),
+      offset_(0),
+      corrupt_(false) {
+}
+
+BinaryNetLogReader::~BinaryNetLogReader() {}
+
+bool BinaryNetLogReader::ReadHeader(std::string* constants_json) {
+  DCHECK_EQ(0u, offset_);
+  if (data_.size() < kMagicLength ||
+      data_.compare(0, kMagicLength, kMagic, kMagicLength) != 0) {
+    corrupt_ = true;
+    return false;
+  }
+  offset_ = kMagicLength;
+
+  const char* chunk;
+  uint32 length;
+  if (!ReadChunk(&chunk, &length))
+    return false;
+  constants_json->assign(chunk, length);
+  return true;
+}
+
+bool BinaryNetLogReader::ReadEntry(Entry* entry) {
+  DCHECK_GT(offset_, 0u);
+  if (corrupt_ || offset_ == data_.size())
+    return false;
+
+  const char* chunk;
+  uint32 length;
+  if (!ReadChunk(&chunk, &length))
+    return false;
+
+  Pickle pickle(chunk, static_cast<int>(length));
+  PickleIterator iter(pickle);
+  int type;
+  int64 time;
+  int source_type;
+  int phase;
+  if (!pickle.ReadInt(&iter, &type) ||
+      !pickle.ReadInt64(&iter, &time) ||
+      !pickle.ReadInt(&iter, &source_type) ||
+      !pickle.ReadUInt32(&iter, &entry->source.id) ||
+      !pickle.ReadInt(&iter, &phase) ||
+      !pickle.ReadString(&iter, &entry->params_json) ||
+      type < 0 || type >= NetLog::EVENT_COUNT ||
+      source_type < 0 || source_type >= NetLog::SOURCE_COUNT ||
+      phase < NetLog::PHASE_NONE || phase > NetLog::PHASE_END) {
+    corrupt_ = true;
+    return false;
+  }
+
+  entry->type = static_cast<NetLog::EventType>(type);
+  entry->time = base::TimeTicks::FromInternalValue(time);
+  entry->source.type = static_cast<NetLog::SourceType>(source_type);
+  entry->phase = static_cast<NetLog::EventPhase>(phase);
+  return true;
+}
+
+// static
+bool BinaryNetLogReader::ConvertToJSON(const std::string& data,
+                                       std::string* json) {
+  BinaryNetLogReader reader(data);
+  std::string constants_json;
+  if (!reader.ReadHeader(&constants_json))
+    return false;
+
+  json->clear();
+  json->append("{\"constants\": ");
+  json->append(constants_json);
+  json->append(",\n\"events\": [\n");
+
+  Entry entry;
+  bool first = true;
+  while (reader.ReadEntry(&entry)) {
+    scoped_ptr<base::Value> value(NetLog::EntryToDictionaryValue(
+        entry.type, entry.time, entry.source, entry.phase, NULL, false));
+    if (!entry.params_json.empty()) {
+      base::Value* params = base::JSONReader::Read(entry.params_json, false);
+      if (params)
+        static_cast<base::DictionaryValue*>(value.get())->Set("params", params);
+    }
+
+    std::string entry_json;
+    base::JSONWriter::Write(value.get(), &entry_json);
+    if (!first)
+      json->append(",\n");
+    json->append(entry_json);
+    first = false;
+  }
+
+  LOG_IF(WARNING, reader.corrupt()) << "Dropped a malformed NetLog record.";
+  json->append("\n]}\n");
+  return true;
+}
+
+bool BinaryNetLogReader::ReadChunk(const char** chunk, uint32* length) {
+  if (data_.size() - offset_ < sizeof(*length)) {
+    corrupt_ = true;
+    return false;
+  }
+  memcpy(length, data_.data() + offset_, sizeof(*length));
+  if (data_.size() - offset_ - sizeof(*length) < *length) {
+    corrupt_ = true;
+    return false;
+  }
+  *chunk = data_.data() + offset_ + sizeof(*length);
+  offset_ += sizeof(*length) + *length;
+  return true;
+}
+
+}  // namespace net
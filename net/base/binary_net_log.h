@@ -0,0 +1,94 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_BASE_BINARY_NET_LOG_H_
+#define NET_BASE_BINARY_NET_LOG_H_
+#pragma once
+
+#include <string>
+
+#include "base/basictypes.h"
+#include "base/time.h"
+#include "net/base/net_export.h"
+#include "net/base/net_log.h"
+
+namespace net {
+
+// Compact on-disk format for NetLog captures.  A capture is a short header
+// holding the NetLog constants as JSON, followed by one length-prefixed
+// record per entry.  Each record carries the entry's fixed fields in binary,
+// and its parameters (if any) as a JSON string, so converting a capture back
+// to the JSON format written by --log-net-log only has to assemble the entry
+// dictionaries.
+//
+// Records are appended to a std::string so callers can batch writes.
+class NET_EXPORT BinaryNetLogWriter {
+ public:
+  // Appends the file header to |out|.  |constants_json| is stored verbatim.
+  static void AppendHeader(const std::string& constants_json,
+                           std::string* out);
+
+  // Appends a single entry to |out|.  |params_json| is empty when the entry
+  // has no parameters.
+  static void AppendEntry(NetLog::EventType type,
+                          const base::TimeTicks& time,
+                          const NetLog::Source& source,
+                          NetLog::EventPhase phase,
+                          const std::string& params_json,
+                          std::string* out);
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(BinaryNetLogWriter);
+};
+
+// Parses a capture written with BinaryNetLogWriter.  |data| must outlive the
+// reader.
+class NET_EXPORT BinaryNetLogReader {
+ public:
+  struct NET_EXPORT Entry {
+    Entry();
+    ~Entry();
+
+    NetLog::EventType type;
+    base::TimeTicks time;
+    NetLog::Source source;
+    NetLog::EventPhase phase;
+    std::string params_json;
+  };
+
+  explicit BinaryNetLogReader(const std::string& data);
+  ~BinaryNetLogReader();
+
+  // Reads the header.  Must be called once, before ReadEntry().  Returns false
+  // if |data| is not a binary NetLog capture.
+  bool ReadHeader(std::string* constants_json);
+
+  // Reads the next entry.  Returns false once all entries have been read, or
+  // on a truncated or malformed record; in the latter case |corrupt()| is
+  // true.  A capture cut short by a crash typically ends with a partial
+  // record, so the entries read before it are still usable.
+  bool ReadEntry(Entry* entry);
+
+  bool corrupt() const { return corrupt_; }
+
+  // Converts a whole capture to the JSON format written by NetLogLogger.
+  // Unlike that format, the result is terminated, so it is valid JSON.
+  // Returns false if the header can't be read.  A corrupt trailing record is
+  // dropped.
+  static bool ConvertToJSON(const std::string& data, std::string* json);
+
+ private:
+  // Reads a length-prefixed chunk of |data_|, advancing |offset_|.
+  bool ReadChunk(const char** chunk, uint32* length);
+
+  const std::string& data_;
+  size_t offset_;
+  bool corrupt_;
+
+  DISALLOW_COPY_AND_ASSIGN(BinaryNetLogReader);
+};
+
+}  // namespace net
+
+#endif  // NET_BASE_BINARY_NET_LOG_H_
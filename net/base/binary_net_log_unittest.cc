@@ -0,0 +1,118 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/binary_net_log.h"
+
+#include "base/json/json_reader.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const char kConstants[] = "{\"logEventTypes\":{\"CANCELLED\":0}}";
+
+std::string MakeCapture() {
+  std::string data;
+  BinaryNetLogWriter::AppendHeader(kConstants, &data);
+  BinaryNetLogWriter::AppendEntry(
+      NetLog::TYPE_REQUEST_ALIVE,
+      base::TimeTicks() + base::TimeDelta::FromMilliseconds(1234),
+      NetLog::Source(NetLog::SOURCE_URL_REQUEST, 7),
+      NetLog::PHASE_BEGIN, "{\"url\":\"http://www.google.com/\"}", &data);
+  BinaryNetLogWriter::AppendEntry(
+      NetLog::TYPE_REQUEST_ALIVE,
+      base::TimeTicks() + base::TimeDelta::FromMilliseconds(1250),
+      NetLog::Source(NetLog::SOURCE_URL_REQUEST, 7),
+      NetLog::PHASE_END, "", &data);
+  return data;
+}
+
+TEST(BinaryNetLogTest, RoundTrip) {
+  std::string data = MakeCapture();
+  BinaryNetLogReader reader(data);
+
+  std::string constants;
+  ASSERT_TRUE(reader.ReadHeader(&constants));
+  EXPECT_EQ(kConstants, constants);
+
+  BinaryNetLogReader::Entry entry;
+  ASSERT_TRUE(reader.ReadEntry(&entry));
+  EXPECT_EQ(NetLog::TYPE_REQUEST_ALIVE, entry.type);
+  EXPECT_EQ(1234, (entry.time - base::TimeTicks()).InMilliseconds());
+  EXPECT_EQ(NetLog::SOURCE_URL_REQUEST, entry.source.type);
+  EXPECT_EQ(7u, entry.source.id);
+  EXPECT_EQ(NetLog::PHASE_BEGIN, entry.phase);
+  EXPECT_EQ("{\"url\":\"http://www.google.com/\"}", entry.params_json);
+
+  ASSERT_TRUE(reader.ReadEntry(&entry));
+  EXPECT_EQ(NetLog::PHASE_END, entry.phase);
+  EXPECT_EQ("", entry.params_json);
+
+  EXPECT_FALSE(reader.ReadEntry(&entry));
+  EXPECT_FALSE(reader.corrupt());
+}
+
+TEST(BinaryNetLogTest, BadHeader) {
+  std::string data = "{\"constants\": {}}";
+  BinaryNetLogReader reader(data);
+  std::string constants;
+  EXPECT_FALSE(reader.ReadHeader(&constants));
+  EXPECT_TRUE(reader.corrupt());
+}
+
+// A capture cut off mid-record keeps the entries before the partial one.
+TEST(BinaryNetLogTest, Truncated) {
+  std::string data = MakeCapture();
+  data.resize(data.size() - 3);
+  BinaryNetLogReader reader(data);
+
+  std::string constants;
+  ASSERT_TRUE(reader.ReadHeader(&constants));
+  BinaryNetLogReader::Entry entry;
+  EXPECT_TRUE(reader.ReadEntry(&entry));
+  EXPECT_FALSE(reader.ReadEntry(&entry));
+  EXPECT_TRUE(reader.corrupt());
+}
+
+TEST(BinaryNetLogTest, ConvertToJSON) {
+  std::string json;
+  ASSERT_TRUE(BinaryNetLogReader::ConvertToJSON(MakeCapture(), &json));
+
+  scoped_ptr<base::Value> value(base::JSONReader::Read(json, false));
+  ASSERT_TRUE(value.get());
+  base::DictionaryValue* dict;
+  ASSERT_TRUE(value->GetAsDictionary(&dict));
+
+  base::DictionaryValue* constants;
+  ASSERT_TRUE(dict->GetDictionary("constants", &constants));
+  base::ListValue* events;
+  ASSERT_TRUE(dict->GetList("events", &events));
+  ASSERT_EQ(2u, events->GetSize());
+
+  // Entries match the ones NetLog::EntryToDictionaryValue() builds.
+  base::DictionaryValue* event;
+  ASSERT_TRUE(events->GetDictionary(0, &event));
+  std::string time;
+  EXPECT_TRUE(event->GetString("time", &time));
+  EXPECT_EQ("1234", time);
+  int type;
+  EXPECT_TRUE(event->GetInteger("type", &type));
+  EXPECT_EQ(NetLog::TYPE_REQUEST_ALIVE, type);
+  int source_id;
+  EXPECT_TRUE(event->GetInteger("source.id", &source_id));
+  EXPECT_EQ(7, source_id);
+  std::string url;
+  EXPECT_TRUE(event->GetString("params.url", &url));
+  EXPECT_EQ("http://www.google.com/", url);
+
+  ASSERT_TRUE(events->GetDictionary(1, &event));
+  EXPECT_FALSE(event->HasKey("params"));
+}
+
+}  // namespace
+
+}  // namespace net
@@ -0,0 +1,109 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/bzip2_filter.h"
+
+#include "base/logging.h"
+
+namespace net {
+
+// static
+bool BZip2Filter::g_bzip2_enabled_ = false;
+
+BZip2Filter::BZip2Filter()
+    : decoding_status_(DECODING_UNINITIALIZED),
+      output_pending_(false) {
+}
+
+BZip2Filter::~BZip2Filter() {
+  if (bzip2_data_stream_.get() &&
+      decoding_status_ != DECODING_UNINITIALIZED) {
+    BZ2_bzDecompressEnd(bzip2_data_stream_.get());
+  }
+}
+
+// static
+void BZip2Filter::EnableBZip2Support(bool enabled) {
+  g_bzip2_enabled_ = enabled;
+}
+
+bool BZip2Filter::InitDecoding(bool use_small_memory) {
+  if (decoding_status_ != DECODING_UNINITIALIZED)
+    return false;
+
+  // Initialize bzip2 control block.
+  bzip2_data_stream_.reset(new bz_stream);
+  memset(bzip2_data_stream_.get(), 0, sizeof(bz_stream));
+
+  int result = BZ2_bzDecompressInit(bzip2_data_stream_.get(),
+                                    0,
+                                    use_small_memory ? 1 : 0);
+  if (result != BZ_OK)
+    return false;
+
+  decoding_status_ = DECODING_IN_PROGRESS;
+  return true;
+}
+
+Filter::FilterStatus BZip2Filter::ReadFilteredData(char* dest_buffer,
+                                                   int* dest_len) {
+  Filter::FilterStatus status = Filter::FILTER_ERROR;
+
+  // check output
+  if (!dest_buffer || !dest_len || *dest_len <= 0)
+    return status;
+
+  if (DECODING_DONE == decoding_status_) {
+    // This is to handle the situation that bzip2 decode ends before all the
+    // data from the server has been consumed. Just copy the rest out, the
+    // same way GZipFilter does with trailing data.
+    return CopyOut(dest_buffer, dest_len);
+  }
+
+  if (decoding_status_ != DECODING_IN_PROGRESS)
+    return status;
+
+  // Make sure we have valid input data, unless the previous call filled the
+  // output buffer and libbzip2 may still be holding decoded bytes.
+  if (!output_pending_ && (!next_stream_data_ || stream_data_len_ <= 0)) {
+    *dest_len = 0;
+    return Filter::FILTER_NEED_MORE_DATA;
+  }
+
+  // Fill in bzip2 control block.
+  int ret, output_len = *dest_len;
+  *dest_len = 0;
+
+  bzip2_data_stream_->next_in = next_stream_data_;
+  bzip2_data_stream_->avail_in = next_stream_data_ ? stream_data_len_ : 0;
+  bzip2_data_stream_->next_out = dest_buffer;
+  bzip2_data_stream_->avail_out = output_len;
+
+  ret = BZ2_bzDecompress(bzip2_data_stream_.get());
+
+  // get outputs
+  output_pending_ = bzip2_data_stream_->avail_out == 0;
+  output_len = output_len - bzip2_data_stream_->avail_out;
+  *dest_len = output_len;
+
+  // Update the remaining unprocessed input.
+  stream_data_len_ = bzip2_data_stream_->avail_in;
+  next_stream_data_ = stream_data_len_ ? bzip2_data_stream_->next_in : NULL;
+
+  if (BZ_STREAM_END == ret) {
+    status = Filter::FILTER_DONE;
+    decoding_status_ = DECODING_DONE;
+  } else if (BZ_OK == ret) {
+    if (stream_data_len_ || output_pending_)
+      status = Filter::FILTER_OK;
+    else
+      status = Filter::FILTER_NEED_MORE_DATA;
+  } else {
+    decoding_status_ = DECODING_ERROR;
+  }
+
+  return status;
+}
+
+}  // namespace net
@@ -0,0 +1,100 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// BZip2Filter applies bzip2 content encoding/decoding to a data stream.
+// There is no HTTP specification for the "bzip2" content coding, so
+// BZip2Filter expects the payload to be a single standard bzip2 stream, as
+// produced by the bzip2 command line tool.
+//
+// Internally BZip2Filter uses libbzip2 to do decoding.
+//
+// BZip2Filter is a subclass of Filter. See the latter's header file filter.h
+// for sample usage.
+
+#ifndef NET_BASE_BZIP2_FILTER_H_
+#define NET_BASE_BZIP2_FILTER_H_
+#pragma once
+
+#if defined(USE_SYSTEM_LIBBZ2)
+#include <bzlib.h>
+#else
+#include "third_party/bzip2/bzlib.h"
+#endif
+
+#include "base/basictypes.h"
+#include "base/memory/scoped_ptr.h"
+#include "net/base/filter.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+class BZip2Filter : public Filter {
+ public:
+  virtual ~BZip2Filter();
+
+  // Enables or disables advertising bzip2 in Accept-Encoding.  Disabled by
+  // default; responses that are bzip2 encoded anyway are still decoded.
+  NET_EXPORT static void EnableBZip2Support(bool enabled);
+
+  static bool bzip2_enabled() { return g_bzip2_enabled_; }
+
+  // Initializes filter decoding mode and internal control blocks.
+  // Parameter use_small_memory specifies whether use small memory
+  // to decompresss data. If small is nonzero, the bzip2 library will
+  // use an alternative decompression algorithm which uses less memory
+  // but at the cost of decompressing more slowly (roughly speaking,
+  // half the speed, but the maximum memory requirement drops to
+  // around 2300k). For more information, see doc in http://www.bzip.org.
+  // The function returns true if success and false otherwise.
+  // The filter can only be initialized once.
+  bool InitDecoding(bool use_small_memory);
+
+  // Decodes the pre-filter data and writes the output into the dest_buffer
+  // passed in.
+  // The function returns FilterStatus. See filter.h for its description.
+  //
+  // Since BZ2_bzDecompress checks some of the input data, it will not
+  // necessarily produce output as long as input is available. Upon entry,
+  // *dest_len is the total size (in number of chars) of the destination
+  // buffer. Upon exit, *dest_len is the actual number of chars written into
+  // the destination buffer.
+  virtual FilterStatus ReadFilteredData(char* dest_buffer,
+                                        int* dest_len) OVERRIDE;
+
+ private:
+  enum DecodingStatus {
+    DECODING_UNINITIALIZED,
+    DECODING_IN_PROGRESS,
+    DECODING_DONE,
+    DECODING_ERROR
+  };
+
+  // Only to be instantiated by Filter::Factory.
+  BZip2Filter();
+
+  // Advertise bzip2 compression in request headers.
+  static bool g_bzip2_enabled_;
+  friend class Filter;
+
+  // Tracks the status of decoding.
+  // This variable is initialized by InitDecoding and updated only by
+  // ReadFilteredData.
+  DecodingStatus decoding_status_;
+
+  // The control block of bzip which actually does the decoding.
+  // This data structure is initialized by InitDecoding and updated in
+  // ReadFilteredData.
+  scoped_ptr<bz_stream> bzip2_data_stream_;
+
+  // True if the last call to BZ2_bzDecompress filled the output buffer, in
+  // which case libbzip2 may have more decoded data to hand out even though
+  // all of the input has been consumed.
+  bool output_pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(BZip2Filter);
+};
+
+}  // namespace net
+
+#endif  // NET_BASE_BZIP2_FILTER_H_
@@ -0,0 +1,200 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <string>
+
+#if defined(USE_SYSTEM_LIBBZ2)
+#include <bzlib.h>
+#else
+#include "third_party/bzip2/bzlib.h"
+#endif
+
+#include "base/file_util.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/path_service.h"
+#include "net/base/bzip2_filter.h"
+#include "net/base/io_buffer.h"
+#include "net/base/mock_filter_context.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/platform_test.h"
+
+namespace {
+
+const int kDefaultBufferSize = 4096;
+const int kSmallBufferSize = 128;
+
+}  // namespace
+
+namespace net {
+
+// These tests use the path service, which uses autoreleased objects on the
+// Mac, so this needs to be a PlatformTest.
+class BZip2FilterUnitTest : public PlatformTest {
+ protected:
+  virtual void SetUp() {
+    PlatformTest::SetUp();
+
+    // Get the path of source data file.
+    FilePath file_path;
+    PathService::Get(base::DIR_SOURCE_ROOT, &file_path);
+    file_path = file_path.AppendASCII("net");
+    file_path = file_path.AppendASCII("data");
+    file_path = file_path.AppendASCII("filter_unittests");
+    file_path = file_path.AppendASCII("google.txt");
+
+    // Read data from the file into buffer.
+    ASSERT_TRUE(file_util::ReadFileToString(file_path, &source_buffer_));
+
+    // Encode the data with bzip2.
+    unsigned int encode_len = kDefaultBufferSize;
+    bzip2_encode_buffer_.resize(encode_len);
+    int code = BZ2_bzBuffToBuffCompress(
+        &bzip2_encode_buffer_[0], &encode_len,
+        const_cast<char*>(source_buffer_.data()), source_buffer_.size(),
+        9,    // blockSize100k
+        0,    // verbosity
+        0);   // workFactor (default)
+    ASSERT_EQ(BZ_OK, code);
+    ASSERT_GT(encode_len, 0U);
+    bzip2_encode_buffer_.resize(encode_len);
+  }
+
+  // Use filter to decode compressed data, and compare the decoding result with
+  // the orginal data. Output_buffer_size specifies the size of buffer to read
+  // out data from filter.
+  void DecodeAndCompareWithFilter(Filter* filter,
+                                  const std::string& source,
+                                  const std::string& encoded_source,
+                                  int output_buffer_size) {
+    std::string decoded;
+    const char* encode_next = encoded_source.data();
+    int encode_avail_size = static_cast<int>(encoded_source.size());
+    scoped_array<char> decode_buffer(new char[output_buffer_size]);
+
+    int code = Filter::FILTER_OK;
+    while (code != Filter::FILTER_DONE) {
+      int encode_data_len = std::min(encode_avail_size,
+                                     filter->stream_buffer_size());
+      if (encode_data_len > 0) {
+        memcpy(filter->stream_buffer()->data(), encode_next, encode_data_len);
+        filter->FlushStreamBuffer(encode_data_len);
+        encode_next += encode_data_len;
+        encode_avail_size -= encode_data_len;
+      }
+
+      while (1) {
+        int decode_data_len = output_buffer_size;
+        code = filter->ReadData(decode_buffer.get(), &decode_data_len);
+        decoded.append(decode_buffer.get(), decode_data_len);
+
+        ASSERT_NE(Filter::FILTER_ERROR, code);
+        if (code == Filter::FILTER_NEED_MORE_DATA ||
+            code == Filter::FILTER_DONE) {
+          break;
+        }
+      }
+      if (code == Filter::FILTER_NEED_MORE_DATA)
+        ASSERT_GT(encode_avail_size, 0);
+    }
+
+    EXPECT_EQ(source, decoded);
+  }
+
+  void InitFilterWithBufferSize(int buffer_size) {
+    std::vector<Filter::FilterType> filter_types;
+    filter_types.push_back(Filter::FILTER_TYPE_BZIP2);
+    filter_.reset(Filter::FactoryForTests(filter_types, filter_context_,
+                                          buffer_size));
+    ASSERT_TRUE(filter_.get());
+  }
+
+  scoped_ptr<Filter> filter_;
+  std::string source_buffer_;
+  std::string bzip2_encode_buffer_;
+
+ private:
+  MockFilterContext filter_context_;
+};
+
+// Basic scenario: decoding bzip2 data with big enough buffer.
+TEST_F(BZip2FilterUnitTest, DecodeBZip2) {
+  InitFilterWithBufferSize(kDefaultBufferSize);
+  memcpy(filter_->stream_buffer()->data(), bzip2_encode_buffer_.data(),
+         bzip2_encode_buffer_.size());
+  filter_->FlushStreamBuffer(static_cast<int>(bzip2_encode_buffer_.size()));
+
+  char decode_buffer[kDefaultBufferSize];
+  int decode_size = kDefaultBufferSize;
+  EXPECT_EQ(Filter::FILTER_DONE,
+            filter_->ReadData(decode_buffer, &decode_size));
+
+  // Compare the decoding result with source data.
+  EXPECT_EQ(source_buffer_, std::string(decode_buffer, decode_size));
+}
+
+// Tests we can call filter repeatedly to get all the data decoded.
+TEST_F(BZip2FilterUnitTest, DecodeWithSmallInputBuffer) {
+  InitFilterWithBufferSize(kSmallBufferSize);
+  EXPECT_EQ(kSmallBufferSize, filter_->stream_buffer_size());
+  DecodeAndCompareWithFilter(filter_.get(), source_buffer_,
+                             bzip2_encode_buffer_, kDefaultBufferSize);
+}
+
+// Tests we can decode when caller has small buffer to read out from filter.
+// libbzip2 keeps decoded bytes internally once the output buffer is full, so
+// the filter must keep handing them out after all input has been consumed.
+TEST_F(BZip2FilterUnitTest, DecodeWithSmallOutputBuffer) {
+  InitFilterWithBufferSize(kDefaultBufferSize);
+  DecodeAndCompareWithFilter(filter_.get(), source_buffer_,
+                             bzip2_encode_buffer_, kSmallBufferSize);
+}
+
+// Tests we can still decode with just 1 byte buffer in the filter and just 1
+// byte buffer in the caller.
+TEST_F(BZip2FilterUnitTest, DecodeWithOneByteInputAndOutputBuffer) {
+  InitFilterWithBufferSize(1);
+  EXPECT_EQ(1, filter_->stream_buffer_size());
+  DecodeAndCompareWithFilter(filter_.get(), source_buffer_,
+                             bzip2_encode_buffer_, 1);
+}
+
+// Data following the end of the bzip2 stream is passed through unchanged.
+TEST_F(BZip2FilterUnitTest, TrailingDataIsCopiedOut) {
+  const std::string kTrailer("trailer");
+  std::string encoded(bzip2_encode_buffer_ + kTrailer);
+  InitFilterWithBufferSize(kDefaultBufferSize);
+  memcpy(filter_->stream_buffer()->data(), encoded.data(), encoded.size());
+  filter_->FlushStreamBuffer(static_cast<int>(encoded.size()));
+
+  char decode_buffer[kDefaultBufferSize];
+  int decode_size = kDefaultBufferSize;
+  EXPECT_EQ(Filter::FILTER_DONE,
+            filter_->ReadData(decode_buffer, &decode_size));
+  EXPECT_EQ(source_buffer_, std::string(decode_buffer, decode_size));
+
+  decode_size = kDefaultBufferSize;
+  EXPECT_EQ(Filter::FILTER_NEED_MORE_DATA,
+            filter_->ReadData(decode_buffer, &decode_size));
+  EXPECT_EQ(kTrailer, std::string(decode_buffer, decode_size));
+}
+
+// Decoding bzip2 stream with corrupted data.
+TEST_F(BZip2FilterUnitTest, DecodeCorruptedData) {
+  std::string corrupt_data(bzip2_encode_buffer_);
+  // Damage the stream signature.
+  corrupt_data[0] = !corrupt_data[0];
+
+  InitFilterWithBufferSize(kDefaultBufferSize);
+  memcpy(filter_->stream_buffer()->data(), corrupt_data.data(),
+         corrupt_data.size());
+  filter_->FlushStreamBuffer(static_cast<int>(corrupt_data.size()));
+
+  char decode_buffer[kDefaultBufferSize];
+  int decode_size = kDefaultBufferSize;
+  EXPECT_EQ(Filter::FILTER_ERROR,
+            filter_->ReadData(decode_buffer, &decode_size));
+}
+
+}  // namespace net
@@ -0,0 +1,181 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/cert_verifier_cache_file_store.h"
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "base/sequenced_task_runner.h"
+#include "net/base/pickled_file_util.h"
+#include "net/base/x509_certificate.h"
+
+namespace {
+
+// Version of the cache file format; see pickled_file_util.h.
+const int kFormatVersion = 1;
+
+// The cache holds at most a few hundred entries; anything claiming more than
+// this is corrupt.
+const int kMaxStoredResults = 4096;
+
+void WriteFingerprint(Pickle* pickle, const net::SHA1Fingerprint& fingerprint) {
+  pickle->WriteBytes(fingerprint.data, sizeof(fingerprint.data));
+}
+
+bool ReadFingerprint(const Pickle& pickle,
+                     PickleIterator* iter,
+                     net::SHA1Fingerprint* fingerprint) {
+  const char* data;
+  if (!pickle.ReadBytes(iter, &data, sizeof(fingerprint->data)))
+    return false;
+  memcpy(fingerprint->data, data, sizeof(fingerprint->data));
+  return true;
+}
+
+}  // namespace
+
+namespace net {
+
+CertVerifierCacheFileStore::CertVerifierCacheFileStore(
+    const FilePath& path,
+    base::SequencedTaskRunner* file_task_runner)
+    : path_(path),
+      file_task_runner_(file_task_runner),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
+}
+
+CertVerifierCacheFileStore::~CertVerifierCacheFileStore() {
+}
+
+void CertVerifierCacheFileStore::Load(const LoadedCallback& loaded_callback) {
+  StoredResults* results = new StoredResults;
+  file_task_runner_->PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&CertVerifierCacheFileStore::LoadOnFileThread,
+                 path_, results),
+      base::Bind(&CertVerifierCacheFileStore::OnLoaded,
+                 weak_factory_.GetWeakPtr(), loaded_callback,
+                 base::Owned(results)));
+}
+
+void CertVerifierCacheFileStore::Save(const StoredResults& results) {
+  // Serialize on the calling thread, so the file thread only deals with bytes.
+  std::string data;
+  Serialize(results, &data);
+  file_task_runner_->PostTask(
+      FROM_HERE,
+      base::Bind(&CertVerifierCacheFileStore::WriteOnFileThread,
+                 path_, data));
+}
+
+// static
+void CertVerifierCacheFileStore::Serialize(const StoredResults& results,
+                                           std::string* data) {
+  Pickle pickle;
+  WritePickledFileVersion(&pickle, kFormatVersion);
+  pickle.WriteInt(static_cast<int>(results.size()));
+  for (StoredResults::const_iterator it = results.begin();
+       it != results.end(); ++it) {
+    const CertVerifyResult& result = it->result;
+    WriteFingerprint(&pickle, it->cert_fingerprint);
+    WriteFingerprint(&pickle, it->ca_fingerprint);
+    pickle.WriteString(it->hostname);
+    pickle.WriteInt(it->flags);
+    pickle.WriteUInt32(it->crl_set_sequence);
+    pickle.WriteInt64(it->expiration.ToInternalValue());
+    result.verified_cert->Persist(&pickle);
+    pickle.WriteUInt32(result.cert_status);
+    pickle.WriteBool(result.has_md5);
+    pickle.WriteBool(result.has_md2);
+    pickle.WriteBool(result.has_md4);
+    pickle.WriteBool(result.has_md5_ca);
+    pickle.WriteBool(result.has_md2_ca);
+    pickle.WriteBool(result.is_issued_by_known_root);
+    pickle.WriteInt(static_cast<int>(result.public_key_hashes.size()));
+    for (size_t i = 0; i < result.public_key_hashes.size(); ++i)
+      WriteFingerprint(&pickle, result.public_key_hashes[i]);
+  }
+  data->assign(static_cast<const char*>(pickle.data()), pickle.size());
+}
+
+// static
+bool CertVerifierCacheFileStore::Deserialize(const std::string& data,
+                                             StoredResults* results) {
+  Pickle pickle(data.data(), static_cast<int>(data.size()));
+  PickleIterator iter(pickle);
+  int count;
+  if (!ReadPickledFileVersion(pickle, &iter, kFormatVersion) ||
+      !pickle.ReadInt(&iter, &count) || count < 0 ||
+      count > kMaxStoredResults) {
+    return false;
+  }
+
+  results->resize(count);
+  for (int i = 0; i < count; ++i) {
+    StoredResult& stored = (*results)[i];
+    CertVerifyResult& result = stored.result;
+    int64 expiration;
+    uint32 cert_status;
+    int hash_count;
+    if (!ReadFingerprint(pickle, &iter, &stored.cert_fingerprint) ||
+        !ReadFingerprint(pickle, &iter, &stored.ca_fingerprint) ||
+        !pickle.ReadString(&iter, &stored.hostname) ||
+        !pickle.ReadInt(&iter, &stored.flags) ||
+        !pickle.ReadUInt32(&iter, &stored.crl_set_sequence) ||
+        !pickle.ReadInt64(&iter, &expiration)) {
+      return false;
+    }
+    result.verified_cert = X509Certificate::CreateFromPickle(
+        pickle, &iter, X509Certificate::PICKLETYPE_CERTIFICATE_CHAIN);
+    if (!result.verified_cert ||
+        !pickle.ReadUInt32(&iter, &cert_status) ||
+        !pickle.ReadBool(&iter, &result.has_md5) ||
+        !pickle.ReadBool(&iter, &result.has_md2) ||
+        !pickle.ReadBool(&iter, &result.has_md4) ||
+        !pickle.ReadBool(&iter, &result.has_md5_ca) ||
+        !pickle.ReadBool(&iter, &result.has_md2_ca) ||
+        !pickle.ReadBool(&iter, &result.is_issued_by_known_root) ||
+        !pickle.ReadInt(&iter, &hash_count) || hash_count < 0 ||
+        hash_count > kMaxStoredResults) {
+      return false;
+    }
+    stored.expiration = base::Time::FromInternalValue(expiration);
+    result.cert_status = cert_status;
+    result.public_key_hashes.resize(hash_count);
+    for (int j = 0; j < hash_count; ++j) {
+      if (!ReadFingerprint(pickle, &iter, &result.public_key_hashes[j]))
+        return false;
+    }
+  }
+  return true;
+}
+
+// static
+void CertVerifierCacheFileStore::LoadOnFileThread(const FilePath& path,
+                                                  StoredResults* results) {
+  std::string data;
+  if (!file_util::ReadFileToString(path, &data))
+    return;
+  if (!Deserialize(data, results)) {
+    DVLOG(1) << "Discarding unreadable certificate cache " << path.value();
+    results->clear();
+    file_util::Delete(path, false);
+  }
+}
+
+// static
+void CertVerifierCacheFileStore::WriteOnFileThread(const FilePath& path,
+                                                   const std::string& data) {
+  WriteFileAtomically(path, data);
+}
+
+void CertVerifierCacheFileStore::OnLoaded(const LoadedCallback& loaded_callback,
+                                          StoredResults* results) {
+  loaded_callback.Run(*results);
+}
+
+}  // namespace net
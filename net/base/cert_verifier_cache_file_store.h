@@ -0,0 +1,57 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// CertVerifierCacheFileStore persists the certificate verification cache as a
+// single file.  All disk access happens on the supplied file task runner.
+
+#ifndef NET_BASE_CERT_VERIFIER_CACHE_FILE_STORE_H_
+#define NET_BASE_CERT_VERIFIER_CACHE_FILE_STORE_H_
+#pragma once
+
+#include <string>
+
+#include "base/compiler_specific.h"
+#include "base/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "net/base/multi_threaded_cert_verifier.h"
+#include "net/base/net_export.h"
+
+namespace base {
+class SequencedTaskRunner;
+}
+
+namespace net {
+
+class NET_EXPORT CertVerifierCacheFileStore : public CertVerifierCacheStore {
+ public:
+  CertVerifierCacheFileStore(const FilePath& path,
+                             base::SequencedTaskRunner* file_task_runner);
+  virtual ~CertVerifierCacheFileStore();
+
+  // CertVerifierCacheStore implementation.
+  virtual void Load(const LoadedCallback& loaded_callback) OVERRIDE;
+  virtual void Save(const StoredResults& results) OVERRIDE;
+
+  // Serializes |results| to |data|, and back.  Exposed for testing.
+  static void Serialize(const StoredResults& results, std::string* data);
+  static bool Deserialize(const std::string& data, StoredResults* results);
+
+ private:
+  // These run on the file task runner.
+  static void LoadOnFileThread(const FilePath& path, StoredResults* results);
+  static void WriteOnFileThread(const FilePath& path, const std::string& data);
+
+  void OnLoaded(const LoadedCallback& loaded_callback, StoredResults* results);
+
+  const FilePath path_;
+  scoped_refptr<base::SequencedTaskRunner> file_task_runner_;
+  base::WeakPtrFactory<CertVerifierCacheFileStore> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(CertVerifierCacheFileStore);
+};
+
+}  // namespace net
+
+#endif  // NET_BASE_CERT_VERIFIER_CACHE_FILE_STORE_H_
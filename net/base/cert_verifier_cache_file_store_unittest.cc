@@ -0,0 +1,141 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/cert_verifier_cache_file_store.h"
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/message_loop_proxy.h"
+#include "base/scoped_temp_dir.h"
+#include "net/base/cert_test_util.h"
+#include "net/base/x509_certificate.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+void CopyResults(CertVerifierCacheStore::StoredResults* out,
+                 const CertVerifierCacheStore::StoredResults& in) {
+  *out = in;
+}
+
+}  // namespace
+
+class CertVerifierCacheFileStoreTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.path().AppendASCII("cache");
+    cert_ = ImportCertFromFile(GetTestCertsDirectory(), "ok_cert.pem");
+    ASSERT_NE(static_cast<X509Certificate*>(NULL), cert_);
+  }
+
+  CertVerifierCacheFileStore* NewStore() {
+    return new CertVerifierCacheFileStore(
+        path_, base::MessageLoopProxy::current());
+  }
+
+  CertVerifierCacheStore::StoredResults LoadAll(
+      CertVerifierCacheStore* store) {
+    CertVerifierCacheStore::StoredResults results;
+    store->Load(base::Bind(&CopyResults, &results));
+    MessageLoop::current()->RunAllPending();
+    return results;
+  }
+
+  CertVerifierCacheStore::StoredResult MakeResult(const std::string& host) {
+    CertVerifierCacheStore::StoredResult stored;
+    stored.cert_fingerprint = cert_->fingerprint();
+    stored.ca_fingerprint = cert_->ca_fingerprint();
+    stored.hostname = host;
+    stored.flags = 3;
+    stored.crl_set_sequence = 42;
+    stored.expiration = base::Time::FromInternalValue(1234567);
+    stored.result.verified_cert = cert_;
+    stored.result.cert_status = CERT_STATUS_REV_CHECKING_ENABLED;
+    stored.result.is_issued_by_known_root = true;
+    stored.result.public_key_hashes.push_back(cert_->fingerprint());
+    return stored;
+  }
+
+  MessageLoop message_loop_;
+  ScopedTempDir temp_dir_;
+  FilePath path_;
+  scoped_refptr<X509Certificate> cert_;
+};
+
+TEST_F(CertVerifierCacheFileStoreTest, SerializeRoundTrip) {
+  CertVerifierCacheStore::StoredResults results;
+  results.push_back(MakeResult("www.example.com"));
+
+  std::string data;
+  CertVerifierCacheFileStore::Serialize(results, &data);
+  CertVerifierCacheStore::StoredResults parsed;
+  ASSERT_TRUE(CertVerifierCacheFileStore::Deserialize(data, &parsed));
+  ASSERT_EQ(1u, parsed.size());
+
+  const CertVerifierCacheStore::StoredResult& stored = parsed[0];
+  EXPECT_TRUE(stored.cert_fingerprint.Equals(cert_->fingerprint()));
+  EXPECT_TRUE(stored.ca_fingerprint.Equals(cert_->ca_fingerprint()));
+  EXPECT_EQ("www.example.com", stored.hostname);
+  EXPECT_EQ(3, stored.flags);
+  EXPECT_EQ(42u, stored.crl_set_sequence);
+  EXPECT_EQ(1234567, stored.expiration.ToInternalValue());
+  ASSERT_TRUE(stored.result.verified_cert);
+  EXPECT_TRUE(stored.result.verified_cert->Equals(cert_));
+  EXPECT_EQ(CERT_STATUS_REV_CHECKING_ENABLED, stored.result.cert_status);
+  EXPECT_TRUE(stored.result.is_issued_by_known_root);
+  EXPECT_FALSE(stored.result.has_md5);
+  ASSERT_EQ(1u, stored.result.public_key_hashes.size());
+  EXPECT_TRUE(stored.result.public_key_hashes[0].Equals(cert_->fingerprint()));
+}
+
+TEST_F(CertVerifierCacheFileStoreTest, DeserializeTruncated) {
+  CertVerifierCacheStore::StoredResults results;
+  results.push_back(MakeResult("www.example.com"));
+
+  std::string data;
+  CertVerifierCacheFileStore::Serialize(results, &data);
+  data.resize(data.size() / 2);
+  CertVerifierCacheStore::StoredResults parsed;
+  EXPECT_FALSE(CertVerifierCacheFileStore::Deserialize(data, &parsed));
+}
+
+TEST_F(CertVerifierCacheFileStoreTest, SaveAndLoad) {
+  scoped_ptr<CertVerifierCacheFileStore> store(NewStore());
+  EXPECT_TRUE(LoadAll(store.get()).empty());
+
+  CertVerifierCacheStore::StoredResults results;
+  results.push_back(MakeResult("a.example.com"));
+  results.push_back(MakeResult("b.example.com"));
+  store->Save(results);
+  MessageLoop::current()->RunAllPending();
+
+  // A new store, as after a restart, sees the saved results.
+  store.reset(NewStore());
+  CertVerifierCacheStore::StoredResults loaded = LoadAll(store.get());
+  ASSERT_EQ(2u, loaded.size());
+  EXPECT_EQ("a.example.com", loaded[0].hostname);
+  EXPECT_EQ("b.example.com", loaded[1].hostname);
+
+  // Saving again replaces the previous contents.
+  store->Save(CertVerifierCacheStore::StoredResults());
+  MessageLoop::current()->RunAllPending();
+  EXPECT_TRUE(LoadAll(store.get()).empty());
+}
+
+TEST_F(CertVerifierCacheFileStoreTest, CorruptFileDiscarded) {
+  const char kGarbage[] = "not a pickle";
+  ASSERT_EQ(static_cast<int>(sizeof(kGarbage)),
+            file_util::WriteFile(path_, kGarbage, sizeof(kGarbage)));
+
+  scoped_ptr<CertVerifierCacheFileStore> store(NewStore());
+  EXPECT_TRUE(LoadAll(store.get()).empty());
+  EXPECT_FALSE(file_util::PathExists(path_));
+}
+
+}  // namespace net
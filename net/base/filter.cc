@@ -6,6 +6,7 @@
 
 #include "base/file_path.h"
 #include "base/string_util.h"
+#include "net/base/bzip2_filter.h"
 #include "net/base/gzip_filter.h"
 #include "net/base/io_buffer.h"
 #include "net/base/mime_util.h"
@@ -14,6 +15,8 @@
 namespace {
 
 // Filter types (using canonical lower case only):
+const char kBZip2[]        = "bzip2";
+const char kXBZip2[]       = "x-bzip2";
 const char kDeflate[]      = "deflate";
 const char kGZip[]         = "gzip";
 const char kXGZip[]        = "x-gzip";
@@ -141,7 +144,10 @@ bool Filter::FlushStreamBuffer(int stream_data_len) {
 Filter::FilterType Filter::ConvertEncodingToType(
     const std::string& filter_type) {
   FilterType type_id;
-  if (LowerCaseEqualsASCII(filter_type, kDeflate)) {
+  if (LowerCaseEqualsASCII(filter_type, kBZip2) ||
+      LowerCaseEqualsASCII(filter_type, kXBZip2)) {
+    type_id = FILTER_TYPE_BZIP2;
+  } else if (LowerCaseEqualsASCII(filter_type, kDeflate)) {
     type_id = FILTER_TYPE_DEFLATE;
   } else if (LowerCaseEqualsASCII(filter_type, kGZip) ||
              LowerCaseEqualsASCII(filter_type, kXGZip)) {
@@ -346,6 +352,14 @@ Filter::FilterStatus Filter::CopyOut(char* dest_buffer, int* dest_len) {
   }
 }
 
+// static
+Filter* Filter::InitBZip2Filter(FilterType type_id, int buffer_size) {
+  DCHECK_EQ(FILTER_TYPE_BZIP2, type_id);
+  scoped_ptr<BZip2Filter> bzip2_filter(new BZip2Filter());
+  bzip2_filter->InitBuffer(buffer_size);
+  return bzip2_filter->InitDecoding(false) ? bzip2_filter.release() : NULL;
+}
+
 // static
 Filter* Filter::InitGZipFilter(FilterType type_id, int buffer_size) {
   scoped_ptr<GZipFilter> gz_filter(new GZipFilter());
@@ -369,6 +383,9 @@ Filter* Filter::PrependNewFilter(FilterType type_id,
                                  Filter* filter_list) {
   scoped_ptr<Filter> first_filter;  // Soon to be start of chain.
   switch (type_id) {
+    case FILTER_TYPE_BZIP2:
+      first_filter.reset(InitBZip2Filter(type_id, buffer_size));
+      break;
     case FILTER_TYPE_GZIP_HELPING_SDCH:
     case FILTER_TYPE_DEFLATE:
     case FILTER_TYPE_GZIP:
@@ -121,6 +121,7 @@ class NET_EXPORT_PRIVATE Filter {
 
   // Specifies type of filters that can be created.
   enum FilterType {
+    FILTER_TYPE_BZIP2,
     FILTER_TYPE_DEFLATE,
     FILTER_TYPE_GZIP,
     FILTER_TYPE_GZIP_HELPING_SDCH,  // Gzip possible, but pass through allowed.
@@ -198,6 +199,7 @@ class NET_EXPORT_PRIVATE Filter {
                                  std::vector<FilterType>* encoding_types);
 
  protected:
+  friend class BZip2FilterUnitTest;
   friend class GZipUnitTest;
   friend class SdchFilterChainingTest;
 
@@ -249,6 +251,7 @@ class NET_EXPORT_PRIVATE Filter {
 
   // Helper methods for PrependNewFilter. If initialization is successful,
   // they return a fully initialized Filter. Otherwise, return NULL.
+  static Filter* InitBZip2Filter(FilterType type_id, int buffer_size);
   static Filter* InitGZipFilter(FilterType type_id, int buffer_size);
   static Filter* InitSdchFilter(FilterType type_id,
                                 const FilterContext& filter_context,
@@ -0,0 +1,151 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#if defined(USE_SYSTEM_LIBBZ2)
+#include <bzlib.h>
+#else
+#include "third_party/bzip2/bzlib.h"
+#endif
+
+#if defined(USE_SYSTEM_ZLIB)
+#include <zlib.h>
+#else
+#include "third_party/zlib/zlib.h"
+#endif
+
+#include "base/file_util.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/path_service.h"
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "net/base/filter.h"
+#include "net/base/io_buffer.h"
+#include "net/base/mock_filter_context.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// Number of copies of the source file in the corpus, and number of times the
+// encoded corpus is decoded per measurement.
+const int kCorpusCopies = 256;
+const int kDecodeIterations = 20;
+
+const int kReadBufferSize = 32 * 1024;
+
+}  // namespace
+
+namespace net {
+
+class FilterPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    FilePath file_path;
+    PathService::Get(base::DIR_SOURCE_ROOT, &file_path);
+    file_path = file_path.AppendASCII("net");
+    file_path = file_path.AppendASCII("data");
+    file_path = file_path.AppendASCII("filter_unittests");
+    file_path = file_path.AppendASCII("google.txt");
+
+    std::string source;
+    ASSERT_TRUE(file_util::ReadFileToString(file_path, &source));
+
+    // Number each copy so the corpus is not trivially repetitive.
+    for (int i = 0; i < kCorpusCopies; ++i) {
+      corpus_ += base::StringPrintf("<!-- %d -->\n", i);
+      corpus_ += source;
+    }
+
+    ASSERT_TRUE(GZipEncode(corpus_, &gzip_encoded_));
+    ASSERT_TRUE(BZip2Encode(corpus_, &bzip2_encoded_));
+  }
+
+  static bool GZipEncode(const std::string& input, std::string* output) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // Window bits of 16 + MAX_WBITS asks zlib to write a gzip wrapper.
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS,
+                     8, Z_DEFAULT_STRATEGY) != Z_OK) {
+      return false;
+    }
+    output->resize(deflateBound(&stream, input.size()));
+    stream.next_in = bit_cast<Bytef*>(input.data());
+    stream.avail_in = input.size();
+    stream.next_out = bit_cast<Bytef*>(&(*output)[0]);
+    stream.avail_out = output->size();
+    int code = deflate(&stream, Z_FINISH);
+    output->resize(output->size() - stream.avail_out);
+    deflateEnd(&stream);
+    return code == Z_STREAM_END;
+  }
+
+  static bool BZip2Encode(const std::string& input, std::string* output) {
+    // Worst case expansion documented by libbzip2: 1% plus 600 bytes.
+    unsigned int output_len = input.size() + input.size() / 100 + 600;
+    output->resize(output_len);
+    int code = BZ2_bzBuffToBuffCompress(&(*output)[0], &output_len,
+                                        const_cast<char*>(input.data()),
+                                        input.size(), 9, 0, 0);
+    output->resize(output_len);
+    return code == BZ_OK;
+  }
+
+  // Decodes |encoded| with a filter of |type| kDecodeIterations times and logs
+  // the elapsed time under |name|, together with the compression ratio.
+  void RunDecode(const char* name,
+                 Filter::FilterType type,
+                 const std::string& encoded) {
+    MockFilterContext filter_context;
+    std::vector<Filter::FilterType> filter_types;
+    filter_types.push_back(type);
+    scoped_array<char> read_buffer(new char[kReadBufferSize]);
+
+    LogPerfResult(base::StringPrintf("%s_ratio", name).c_str(),
+                  100.0 * encoded.size() / corpus_.size(), "%");
+
+    PerfTimeLogger timer(name);
+    for (int i = 0; i < kDecodeIterations; ++i) {
+      scoped_ptr<Filter> filter(Filter::Factory(filter_types, filter_context));
+      ASSERT_TRUE(filter.get());
+
+      size_t encoded_pos = 0;
+      size_t decoded_len = 0;
+      Filter::FilterStatus status = Filter::FILTER_NEED_MORE_DATA;
+      while (status != Filter::FILTER_DONE) {
+        if (status == Filter::FILTER_NEED_MORE_DATA) {
+          ASSERT_LT(encoded_pos, encoded.size());
+          int len = std::min(static_cast<int>(encoded.size() - encoded_pos),
+                             filter->stream_buffer_size());
+          memcpy(filter->stream_buffer()->data(), encoded.data() + encoded_pos,
+                 len);
+          filter->FlushStreamBuffer(len);
+          encoded_pos += len;
+        }
+        int read_len = kReadBufferSize;
+        status = filter->ReadData(read_buffer.get(), &read_len);
+        ASSERT_NE(Filter::FILTER_ERROR, status);
+        decoded_len += read_len;
+      }
+      EXPECT_EQ(corpus_.size(), decoded_len);
+    }
+    timer.Done();
+  }
+
+  std::string corpus_;
+  std::string gzip_encoded_;
+  std::string bzip2_encoded_;
+};
+
+TEST_F(FilterPerfTest, DecodeGZip) {
+  RunDecode("Filter_decode_gzip", Filter::FILTER_TYPE_GZIP, gzip_encoded_);
+}
+
+TEST_F(FilterPerfTest, DecodeBZip2) {
+  RunDecode("Filter_decode_bzip2", Filter::FILTER_TYPE_BZIP2, bzip2_encoded_);
+}
+
+}  // namespace net
@@ -13,6 +13,12 @@ class FilterTest : public testing::Test {
 
 TEST(FilterTest, ContentTypeId) {
   // Check for basic translation of Content-Encoding, including case variations.
+  EXPECT_EQ(Filter::FILTER_TYPE_BZIP2,
+            Filter::ConvertEncodingToType("bzip2"));
+  EXPECT_EQ(Filter::FILTER_TYPE_BZIP2,
+            Filter::ConvertEncodingToType("BZip2"));
+  EXPECT_EQ(Filter::FILTER_TYPE_BZIP2,
+            Filter::ConvertEncodingToType("x-bzip2"));
   EXPECT_EQ(Filter::FILTER_TYPE_DEFLATE,
             Filter::ConvertEncodingToType("deflate"));
   EXPECT_EQ(Filter::FILTER_TYPE_DEFLATE,
@@ -125,6 +125,9 @@ SOCKET ListenSocket::Listen(std::string ip, int port) {
       close(s);
 #endif
       s = kInvalidSocket;
+    } else {
+      // Accept() takes connections until none is left.
+      SetNonBlocking(s);
     }
   }
   return s;
@@ -181,8 +184,15 @@ void ListenSocket::Listen() {
 }
 
 void ListenSocket::Accept() {
-  SOCKET conn = Accept(socket_);
-  if (conn != kInvalidSocket) {
+  // The watch is edge-triggered (see WatchSocket()), so connections left in
+  // the backlog would not be reported again.
+  for (;;) {
+    SOCKET conn = Accept(socket_);
+    if (conn == kInvalidSocket) {
+      // The backlog is empty.
+      // TODO(ibrar): some error handling required here
+      break;
+    }
     scoped_refptr<ListenSocket> sock(
         new ListenSocket(conn, socket_delegate_));
     // it's up to the delegate to AddRef if it wants to keep it around
@@ -190,8 +200,6 @@ void ListenSocket::Accept() {
     sock->WatchSocket(WAITING_READ);
 #endif
     socket_delegate_->DidAccept(this, sock);
-  } else {
-    // TODO(ibrar): some error handling required here
   }
 }
 
@@ -225,6 +233,8 @@ void ListenSocket::Read() {
       buf[len] = 0;  // already create a buffer with +1 length
       socket_delegate_->DidRead(this, buf, len);
     }
+    // A short read emptied the socket, so an edge-triggered watch hears
+    // about whatever arrives next.
   } while (len == kReadBufSize);
 }
 
@@ -254,9 +264,10 @@ void ListenSocket::WatchSocket(WaitState state) {
   WSAEventSelect(socket_, socket_event_, FD_ACCEPT | FD_CLOSE | FD_READ);
   watcher_.StartWatching(socket_event_, this);
 #elif defined(OS_POSIX)
-  // Implicitly calls StartWatchingFileDescriptor().
-  MessageLoopForIO::current()->WatchFileDescriptor(
-      socket_, true, MessageLoopForIO::WATCH_READ, &watcher_, this);
+  // Implicitly calls StartWatchingFileDescriptor().  Accept() and Read()
+  // both run until the socket has nothing more for them.
+  MessageLoopForIO::current()->WatchFileDescriptorEdgeTriggered(
+      socket_, MessageLoopForIO::WATCH_READ, &watcher_, this);
   wait_state_ = state;
 #endif
 }
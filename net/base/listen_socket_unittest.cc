@@ -7,8 +7,11 @@
 #include <fcntl.h>
 #include <sys/types.h>
 
+#include <vector>
+
 #include "base/bind.h"
 #include "base/eintr_wrapper.h"
+#include "base/message_pump_libevent.h"
 #include "base/sys_byteorder.h"
 #include "net/base/net_util.h"
 #include "testing/platform_test.h"
@@ -245,4 +248,76 @@ TEST_F(ListenSocketTest, ServerSend) {
   tester_->TestServerSend();
 }
 
+#if defined(OS_LINUX)
+
+namespace {
+
+// Keeps every connection it is handed.
+class AcceptingDelegate : public ListenSocket::ListenSocketDelegate {
+ public:
+  AcceptingDelegate() {}
+
+  const std::vector<scoped_refptr<ListenSocket> >& connections() const {
+    return connections_;
+  }
+
+  // ListenSocket::ListenSocketDelegate:
+  virtual void DidAccept(ListenSocket* server,
+                         ListenSocket* connection) OVERRIDE {
+    connections_.push_back(connection);
+  }
+  virtual void DidRead(ListenSocket* connection,
+                       const char* data,
+                       int len) OVERRIDE {}
+  virtual void DidClose(ListenSocket* sock) OVERRIDE {}
+
+ private:
+  std::vector<scoped_refptr<ListenSocket> > connections_;
+
+  DISALLOW_COPY_AND_ASSIGN(AcceptingDelegate);
+};
+
+}  // namespace
+
+// With an edge-triggered pump, connections that queue up together are only
+// reported once, so all of them have to be accepted then.
+TEST(ListenSocketEpollTest, AcceptsWholeBacklog) {
+  base::MessagePumpLibevent::SetDefaultBackend(
+      base::MessagePumpLibevent::BACKEND_EPOLL);
+  MessageLoop loop(MessageLoop::TYPE_IO);
+  base::MessagePumpLibevent::SetDefaultBackend(
+      base::MessagePumpLibevent::BACKEND_LIBEVENT);
+  ASSERT_TRUE(MessageLoopForIO::current()->WatchesAreEdgeTriggered());
+
+  AcceptingDelegate delegate;
+  scoped_refptr<ListenSocket> server(
+      ListenSocket::Listen(kLoopback, ListenSocketTester::kTestPort,
+                           &delegate));
+  ASSERT_TRUE(server.get());
+
+  // Both connections complete in the kernel before the pump looks.
+  const int kConnections = 2;
+  SOCKET clients[kConnections];
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = inet_addr(kLoopback);
+  addr.sin_port = base::HostToNet16(ListenSocketTester::kTestPort);
+  for (int i = 0; i < kConnections; ++i) {
+    clients[i] = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    ASSERT_NE(INVALID_SOCKET, clients[i]);
+    ASSERT_EQ(0, HANDLE_EINTR(connect(
+        clients[i], reinterpret_cast<sockaddr*>(&addr), sizeof(addr))));
+  }
+
+  loop.RunAllPending();
+  EXPECT_EQ(static_cast<size_t>(kConnections),
+            delegate.connections().size());
+
+  for (int i = 0; i < kConnections; ++i)
+    EXPECT_EQ(0, HANDLE_EINTR(close(clients[i])));
+}
+
+#endif  // defined(OS_LINUX)
+
 }  // namespace net
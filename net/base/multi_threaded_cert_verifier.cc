@@ -12,9 +12,11 @@
 #include "base/message_loop.h"
 #include "base/metrics/histogram.h"
 #include "base/stl_util.h"
+#include "base/string_number_conversions.h"
 #include "base/synchronization/lock.h"
 #include "base/time.h"
 #include "base/threading/worker_pool.h"
+#include "base/values.h"
 #include "net/base/cert_verify_proc.h"
 #include "net/base/crl_set.h"
 #include "net/base/net_errors.h"
@@ -77,9 +79,68 @@ const unsigned kMaxCacheEntries = 256;
 // The number of seconds for which we'll cache a cache entry.
 const unsigned kTTLSecs = 1800;  // 30 minutes.
 
+// How long to wait after a new result before writing the cache to the store.
+const unsigned kSaveDelaySecs = 10;
+
+uint32 GetCRLSetSequence(const CRLSet* crl_set) {
+  return crl_set ? crl_set->sequence() : 0;
+}
+
+// Parameters for CERT_VERIFIER_CACHE_LOOKUP events.
+class CacheLookupParameters : public NetLog::EventParameters {
+ public:
+  CacheLookupParameters(bool cache_hit,
+                        bool restored,
+                        uint64 requests,
+                        uint64 cache_hits,
+                        uint64 restored_cache_hits)
+      : cache_hit_(cache_hit),
+        restored_(restored),
+        requests_(requests),
+        cache_hits_(cache_hits),
+        restored_cache_hits_(restored_cache_hits) {
+  }
+
+  virtual Value* ToValue() const OVERRIDE {
+    DictionaryValue* dict = new DictionaryValue();
+    dict->SetBoolean("cache_hit", cache_hit_);
+    if (cache_hit_)
+      dict->SetBoolean("restored", restored_);
+    // Use strings, since the counters can exceed the range of an int.
+    dict->SetString("requests", base::Uint64ToString(requests_));
+    dict->SetString("cache_hits", base::Uint64ToString(cache_hits_));
+    dict->SetString("restored_cache_hits",
+                    base::Uint64ToString(restored_cache_hits_));
+    return dict;
+  }
+
+ private:
+  virtual ~CacheLookupParameters() {}
+
+  const bool cache_hit_;
+  const bool restored_;
+  const uint64 requests_;
+  const uint64 cache_hits_;
+  const uint64 restored_cache_hits_;
+
+  DISALLOW_COPY_AND_ASSIGN(CacheLookupParameters);
+};
+
 }  // namespace
 
-MultiThreadedCertVerifier::CachedResult::CachedResult() : error(ERR_FAILED) {}
+CertVerifierCacheStore::StoredResult::StoredResult()
+    : flags(0),
+      crl_set_sequence(0) {
+}
+
+CertVerifierCacheStore::StoredResult::~StoredResult() {}
+
+MultiThreadedCertVerifier::CachedResult::CachedResult()
+    : error(ERR_FAILED),
+      crl_set_sequence(0),
+      trust_generation(0),
+      restored(false) {
+}
 
 MultiThreadedCertVerifier::CachedResult::~CachedResult() {}
 
@@ -138,12 +199,14 @@ class CertVerifierWorker {
                      const std::string& hostname,
                      int flags,
                      CRLSet* crl_set,
+                     uint32 trust_generation,
                      MultiThreadedCertVerifier* cert_verifier)
       : verify_proc_(verify_proc),
         cert_(cert),
         hostname_(hostname),
         flags_(flags),
         crl_set_(crl_set),
+        trust_generation_(trust_generation),
         origin_loop_(MessageLoop::current()),
         cert_verifier_(cert_verifier),
         canceled_(false),
@@ -198,8 +261,9 @@ class CertVerifierWorker {
       // memory leaks or worse errors.
       base::AutoLock locked(lock_);
       if (!canceled_) {
-        cert_verifier_->HandleResult(cert_, hostname_, flags_,
-                                     error_, verify_result_);
+        cert_verifier_->HandleResult(cert_, hostname_, flags_, crl_set_,
+                                     trust_generation_, error_,
+                                     verify_result_);
       }
     }
     delete this;
@@ -237,6 +301,7 @@ class CertVerifierWorker {
   const std::string hostname_;
   const int flags_;
   scoped_refptr<CRLSet> crl_set_;
+  const uint32 trust_generation_;
   MessageLoop* const origin_loop_;
   MultiThreadedCertVerifier* const cert_verifier_;
 
@@ -331,14 +396,23 @@ MultiThreadedCertVerifier::MultiThreadedCertVerifier()
     : cache_(kMaxCacheEntries),
       requests_(0),
       cache_hits_(0),
+      restored_cache_hits_(0),
       inflight_joins_(0),
-      verify_proc_(CertVerifyProc::CreateDefault()) {
+      trust_generation_(0),
+      verify_proc_(CertVerifyProc::CreateDefault()),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
   CertDatabase::AddObserver(this);
 }
 
 MultiThreadedCertVerifier::~MultiThreadedCertVerifier() {
   STLDeleteValues(&inflight_);
 
+  // Don't lose the results that arrived since the last write.
+  if (save_timer_.IsRunning()) {
+    save_timer_.Stop();
+    SaveCache();
+  }
+
   CertDatabase::RemoveObserver(this);
 }
 
@@ -363,8 +437,24 @@ int MultiThreadedCertVerifier::Verify(X509Certificate* cert,
                           hostname, flags);
   const CertVerifierCache::value_type* cached_entry =
       cache_.Get(key, base::TimeTicks::Now());
+  // A result is only good for the CRLSet and the trust settings it was
+  // checked against; a newer CRLSet may revoke something in the chain.
+  if (cached_entry &&
+      (cached_entry->crl_set_sequence != GetCRLSetSequence(crl_set) ||
+       cached_entry->trust_generation != trust_generation_)) {
+    cached_entry = NULL;
+  }
   if (cached_entry) {
     ++cache_hits_;
+    if (cached_entry->restored)
+      ++restored_cache_hits_;
+  }
+  net_log.AddEvent(
+      NetLog::TYPE_CERT_VERIFIER_CACHE_LOOKUP,
+      make_scoped_refptr(new CacheLookupParameters(
+          cached_entry != NULL, cached_entry && cached_entry->restored,
+          requests_, cache_hits_, restored_cache_hits_)));
+  if (cached_entry) {
     *out_req = NULL;
     *verify_result = cached_entry->result;
     return cached_entry->error;
@@ -383,7 +473,9 @@ int MultiThreadedCertVerifier::Verify(X509Certificate* cert,
     // Need to make a new request.
     CertVerifierWorker* worker = new CertVerifierWorker(verify_proc_, cert,
                                                         hostname, flags,
-                                                        crl_set, this);
+                                                        crl_set,
+                                                        trust_generation_,
+                                                        this);
     job = new CertVerifierJob(
         worker,
         BoundNetLog::Make(net_log.net_log(), NetLog::SOURCE_CERT_VERIFIER_JOB));
@@ -417,6 +509,8 @@ void MultiThreadedCertVerifier::HandleResult(
     X509Certificate* cert,
     const std::string& hostname,
     int flags,
+    CRLSet* crl_set,
+    uint32 trust_generation,
     int error,
     const CertVerifyResult& verify_result) {
   DCHECK(CalledOnValidThread());
@@ -427,8 +521,16 @@ void MultiThreadedCertVerifier::HandleResult(
   CachedResult cached_result;
   cached_result.error = error;
   cached_result.result = verify_result;
-  cache_.Put(key, cached_result, base::TimeTicks::Now(),
-             base::TimeDelta::FromSeconds(kTTLSecs));
+  cached_result.crl_set_sequence = GetCRLSetSequence(crl_set);
+  cached_result.trust_generation = trust_generation;
+  // A job that started before the cache was cleared may have used the old
+  // trust settings; its waiting requests get the result, but it isn't kept.
+  if (trust_generation == trust_generation_) {
+    cache_.Put(key, cached_result, base::TimeTicks::Now(),
+               base::TimeDelta::FromSeconds(kTTLSecs));
+    if (error == OK)
+      ScheduleSaveCache();
+  }
 
   std::map<RequestParams, CertVerifierJob*>::iterator j;
   j = inflight_.find(key);
@@ -443,11 +545,113 @@ void MultiThreadedCertVerifier::HandleResult(
   delete job;
 }
 
+void MultiThreadedCertVerifier::ClearCache() {
+  DCHECK(CalledOnValidThread());
+
+  cache_.Clear();
+  // Results still being verified, and results still being read from
+  // |store_|, are from before the clear and must not be cached.
+  ++trust_generation_;
+  // Write the empty cache now, so nothing from before the clear survives a
+  // crash.
+  if (store_.get()) {
+    save_timer_.Stop();
+    SaveCache();
+  }
+}
+
 void MultiThreadedCertVerifier::OnCertTrustChanged(
     const X509Certificate* cert) {
+  ClearCache();
+}
+
+void MultiThreadedCertVerifier::SetCacheStore(CertVerifierCacheStore* store) {
   DCHECK(CalledOnValidThread());
+  DCHECK(!store_.get());
+  store_.reset(store);
+  store_->Load(base::Bind(&MultiThreadedCertVerifier::OnCacheStoreLoaded,
+                          weak_factory_.GetWeakPtr(), trust_generation_));
+}
 
-  ClearCache();
+void MultiThreadedCertVerifier::OnCacheStoreLoaded(
+    uint32 trust_generation,
+    const CertVerifierCacheStore::StoredResults& results) {
+  DCHECK(CalledOnValidThread());
+
+  // The trust settings changed, or the cache was cleared, while the results
+  // were being read.
+  if (trust_generation != trust_generation_) {
+    UMA_HISTOGRAM_COUNTS("Net.CertVerifier_CacheRestored", 0);
+    return;
+  }
+
+  const base::Time now = base::Time::Now();
+  const base::TimeTicks now_ticks = base::TimeTicks::Now();
+  const base::TimeDelta max_ttl = base::TimeDelta::FromSeconds(kTTLSecs);
+  size_t restored = 0;
+  for (CertVerifierCacheStore::StoredResults::const_iterator it =
+           results.begin(); it != results.end(); ++it) {
+    // The clock may have been set back, so don't trust an expiration that is
+    // further away than a fresh entry's would be.
+    base::TimeDelta ttl = it->expiration - now;
+    if (ttl <= base::TimeDelta() || !it->result.verified_cert)
+      continue;
+    if (ttl > max_ttl)
+      ttl = max_ttl;
+
+    const RequestParams key(it->cert_fingerprint, it->ca_fingerprint,
+                            it->hostname, it->flags);
+    // Anything verified since startup is at least as fresh.
+    if (cache_.Get(key, now_ticks))
+      continue;
+
+    CachedResult cached_result;
+    cached_result.error = OK;
+    cached_result.result = it->result;
+    cached_result.crl_set_sequence = it->crl_set_sequence;
+    cached_result.trust_generation = trust_generation_;
+    cached_result.restored = true;
+    cache_.Put(key, cached_result, now_ticks, ttl);
+    ++restored;
+  }
+  UMA_HISTOGRAM_COUNTS("Net.CertVerifier_CacheRestored", restored);
+}
+
+void MultiThreadedCertVerifier::ScheduleSaveCache() {
+  if (!store_.get() || save_timer_.IsRunning())
+    return;
+  save_timer_.Start(FROM_HERE, base::TimeDelta::FromSeconds(kSaveDelaySecs),
+                    this, &MultiThreadedCertVerifier::SaveCache);
+}
+
+void MultiThreadedCertVerifier::SaveCache() {
+  DCHECK(CalledOnValidThread());
+  if (!store_.get())
+    return;
+
+  const base::Time now = base::Time::Now();
+  const base::TimeTicks now_ticks = base::TimeTicks::Now();
+  CertVerifierCacheStore::StoredResults results;
+  for (CertVerifierCache::Iterator it(cache_); it.HasNext(); it.Advance()) {
+    const CachedResult& cached_result = it.value();
+    // Only successes are kept; a failure is cheap to rediscover and may be
+    // transient.
+    if (cached_result.error != OK || !cached_result.result.verified_cert ||
+        cached_result.trust_generation != trust_generation_ ||
+        it.expiration() <= now_ticks) {
+      continue;
+    }
+    CertVerifierCacheStore::StoredResult stored;
+    stored.cert_fingerprint = it.key().cert_fingerprint;
+    stored.ca_fingerprint = it.key().ca_fingerprint;
+    stored.hostname = it.key().hostname;
+    stored.flags = it.key().flags;
+    stored.result = cached_result.result;
+    stored.crl_set_sequence = cached_result.crl_set_sequence;
+    stored.expiration = now + (it.expiration() - now_ticks);
+    results.push_back(stored);
+  }
+  store_->Save(results);
 }
 
 void MultiThreadedCertVerifier::SetCertVerifyProc(CertVerifyProc* verify_proc) {
@@ -8,12 +8,17 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
+#include "base/callback.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
 #include "base/threading/non_thread_safe.h"
+#include "base/time.h"
+#include "base/timer.h"
 #include "net/base/cert_database.h"
 #include "net/base/cert_verifier.h"
 #include "net/base/cert_verify_result.h"
@@ -28,6 +33,46 @@ class CertVerifierJob;
 class CertVerifierRequest;
 class CertVerifierWorker;
 class CertVerifyProc;
+class CRLSet;
+
+// CertVerifierCacheStore is an interface for keeping successful certificate
+// verification results across restarts.  MultiThreadedCertVerifier reads the
+// stored results once when the store is registered, and periodically hands
+// back a snapshot of its cache.
+class NET_EXPORT CertVerifierCacheStore {
+ public:
+  // A successful verification, together with what it was checked against.
+  struct NET_EXPORT_PRIVATE StoredResult {
+    StoredResult();
+    ~StoredResult();
+
+    SHA1Fingerprint cert_fingerprint;
+    SHA1Fingerprint ca_fingerprint;
+    std::string hostname;
+    int flags;
+    CertVerifyResult result;
+    // The sequence number of the CRLSet the result was verified against, or
+    // 0 if there was none.  The result is not used with any other CRLSet.
+    uint32 crl_set_sequence;
+    // The result is not used after this time.
+    base::Time expiration;
+  };
+  typedef std::vector<StoredResult> StoredResults;
+  typedef base::Callback<void(const StoredResults&)> LoadedCallback;
+
+  CertVerifierCacheStore() {}
+  virtual ~CertVerifierCacheStore() {}
+
+  // Reads the stored results, then runs |loaded_callback| on the calling
+  // thread.  The callback is not run if the store is destroyed first.
+  virtual void Load(const LoadedCallback& loaded_callback) = 0;
+
+  // Replaces everything in the store with |results|.
+  virtual void Save(const StoredResults& results) = 0;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(CertVerifierCacheStore);
+};
 
 // MultiThreadedCertVerifier is a CertVerifier implementation that runs
 // synchronous CertVerifier implementations on worker threads.
@@ -54,6 +99,14 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier :
 
   virtual void CancelRequest(CertVerifier::RequestHandle req) OVERRIDE;
 
+  // Registers |store| to persist the verification cache, and restores the
+  // results in it.  Takes ownership of |store|.  May be called at most once.
+  void SetCacheStore(CertVerifierCacheStore* store);
+
+  // Drops every cached result, including the ones in |store_|.  Results of
+  // verifications that are still running are not cached.
+  void ClearCache();
+
  private:
   friend class CertVerifierWorker;  // Calls HandleResult.
   friend class CertVerifierRequest;
@@ -65,6 +118,10 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier :
   FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest, CancelRequest);
   FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest,
                            RequestParamsComparators);
+  FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest, CacheStoreRestore);
+  FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest, CacheStoreExpired);
+  FRIEND_TEST_ALL_PREFIXES(MultiThreadedCertVerifierTest,
+                           ClearCacheDropsInflightResult);
 
   // Input parameters of a certificate verification request.
   struct RequestParams {
@@ -107,21 +164,40 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier :
 
     int error;  // The return value of CertVerifier::Verify.
     CertVerifyResult result;  // The output of CertVerifier::Verify.
+    // The sequence number of the CRLSet used for verification, or 0.
+    uint32 crl_set_sequence;
+    // The |trust_generation_| the verification started in.  The result is
+    // only used in that generation.
+    uint32 trust_generation;
+    // True if the result was read back from |store_|.
+    bool restored;
   };
 
   void HandleResult(X509Certificate* cert,
                     const std::string& hostname,
                     int flags,
+                    CRLSet* crl_set,
+                    uint32 trust_generation,
                     int error,
                     const CertVerifyResult& verify_result);
 
   // CertDatabase::Observer methods:
   virtual void OnCertTrustChanged(const X509Certificate* cert) OVERRIDE;
 
+  // Adds the results read from |store_| to |cache_|, unless the cache was
+  // cleared since |trust_generation| was current.
+  void OnCacheStoreLoaded(uint32 trust_generation,
+                          const CertVerifierCacheStore::StoredResults& results);
+
+  // Writes |cache_| to |store_| after a delay, so that a burst of
+  // verifications only costs one write.
+  void ScheduleSaveCache();
+  void SaveCache();
+
   // For unit testing.
-  void ClearCache() { cache_.Clear(); }
   size_t GetCacheSize() const { return cache_.size(); }
   uint64 cache_hits() const { return cache_hits_; }
+  uint64 restored_cache_hits() const { return restored_cache_hits_; }
   uint64 requests() const { return requests_; }
   uint64 inflight_joins() const { return inflight_joins_; }
   void SetCertVerifyProc(CertVerifyProc* verify_proc);
@@ -136,10 +212,19 @@ class NET_EXPORT_PRIVATE MultiThreadedCertVerifier :
 
   uint64 requests_;
   uint64 cache_hits_;
+  uint64 restored_cache_hits_;
   uint64 inflight_joins_;
 
+  // Incremented whenever the cache is cleared, which includes every change
+  // to the trust settings.
+  uint32 trust_generation_;
+
   scoped_refptr<CertVerifyProc> verify_proc_;
 
+  scoped_ptr<CertVerifierCacheStore> store_;
+  base::OneShotTimer<MultiThreadedCertVerifier> save_timer_;
+  base::WeakPtrFactory<MultiThreadedCertVerifier> weak_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(MultiThreadedCertVerifier);
 };
 
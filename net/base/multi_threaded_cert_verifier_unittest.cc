@@ -45,6 +45,45 @@ class MockCertVerifyProc : public CertVerifyProc {
   }
 };
 
+// A CertVerifierCacheStore that hands out a fixed set of results and keeps
+// the last snapshot it was given.
+class MockCacheStore : public CertVerifierCacheStore {
+ public:
+  explicit MockCacheStore(const StoredResults& results)
+      : results_(results), save_count_(0) {}
+  virtual ~MockCacheStore() {}
+
+  virtual void Load(const LoadedCallback& loaded_callback) OVERRIDE {
+    loaded_callback.Run(results_);
+  }
+
+  virtual void Save(const StoredResults& results) OVERRIDE {
+    results_ = results;
+    ++save_count_;
+  }
+
+  const StoredResults& results() const { return results_; }
+  int save_count() const { return save_count_; }
+
+ private:
+  StoredResults results_;
+  int save_count_;
+};
+
+CertVerifierCacheStore::StoredResult MakeStoredResult(
+    X509Certificate* cert,
+    const std::string& hostname,
+    base::TimeDelta lifetime) {
+  CertVerifierCacheStore::StoredResult stored;
+  stored.cert_fingerprint = cert->fingerprint();
+  stored.ca_fingerprint = cert->ca_fingerprint();
+  stored.hostname = hostname;
+  stored.flags = 0;
+  stored.result.verified_cert = cert;
+  stored.expiration = base::Time::Now() + lifetime;
+  return stored;
+}
+
 }  // namespace
 
 class MultiThreadedCertVerifierTest : public ::testing::Test {
@@ -332,4 +371,110 @@ TEST_F(MultiThreadedCertVerifierTest, RequestParamsComparators) {
   }
 }
 
+// Tests that results from a CertVerifierCacheStore are used without
+// re-verification, but only with the CRLSet they were verified against.
+TEST_F(MultiThreadedCertVerifierTest, CacheStoreRestore) {
+  FilePath certs_dir = GetTestCertsDirectory();
+  scoped_refptr<X509Certificate> test_cert(
+      ImportCertFromFile(certs_dir, "ok_cert.pem"));
+  ASSERT_NE(static_cast<X509Certificate*>(NULL), test_cert);
+
+  CertVerifierCacheStore::StoredResults stored;
+  stored.push_back(MakeStoredResult(test_cert, "www.example.com",
+                                    base::TimeDelta::FromHours(1)));
+  stored.push_back(MakeStoredResult(test_cert, "crlset.example.com",
+                                    base::TimeDelta::FromHours(1)));
+  stored.back().crl_set_sequence = 5;
+  MockCacheStore* store = new MockCacheStore(stored);
+  verifier_.SetCacheStore(store);
+  ASSERT_EQ(2u, verifier_.GetCacheSize());
+
+  int error;
+  CertVerifyResult verify_result;
+  TestCompletionCallback callback;
+  CertVerifier::RequestHandle request_handle;
+
+  error = verifier_.Verify(test_cert, "www.example.com", 0, NULL,
+                           &verify_result, callback.callback(),
+                           &request_handle, BoundNetLog());
+  ASSERT_EQ(OK, error);
+  ASSERT_TRUE(request_handle == NULL);
+  EXPECT_EQ(1u, verifier_.cache_hits());
+  EXPECT_EQ(1u, verifier_.restored_cache_hits());
+
+  // Verified against a different CRLSet, so it must be verified again.
+  error = verifier_.Verify(test_cert, "crlset.example.com", 0, NULL,
+                           &verify_result, callback.callback(),
+                           &request_handle, BoundNetLog());
+  ASSERT_EQ(ERR_IO_PENDING, error);
+  error = callback.WaitForResult();
+  ASSERT_TRUE(IsCertificateError(error));
+  EXPECT_EQ(1u, verifier_.cache_hits());
+
+  // Only the remaining success is written back.
+  verifier_.SaveCache();
+  ASSERT_EQ(1u, store->results().size());
+  EXPECT_EQ("www.example.com", store->results()[0].hostname);
+  EXPECT_TRUE(store->results()[0].expiration <=
+              base::Time::Now() + base::TimeDelta::FromMinutes(30));
+
+  // A trust change clears the stored results right away.
+  int save_count = store->save_count();
+  verifier_.OnCertTrustChanged(NULL);
+  EXPECT_EQ(save_count + 1, store->save_count());
+  EXPECT_TRUE(store->results().empty());
+}
+
+// Tests that expired results from a CertVerifierCacheStore are dropped.
+TEST_F(MultiThreadedCertVerifierTest, CacheStoreExpired) {
+  FilePath certs_dir = GetTestCertsDirectory();
+  scoped_refptr<X509Certificate> test_cert(
+      ImportCertFromFile(certs_dir, "ok_cert.pem"));
+  ASSERT_NE(static_cast<X509Certificate*>(NULL), test_cert);
+
+  CertVerifierCacheStore::StoredResults stored;
+  stored.push_back(MakeStoredResult(test_cert, "www.example.com",
+                                    base::TimeDelta::FromMinutes(-1)));
+  verifier_.SetCacheStore(new MockCacheStore(stored));
+  EXPECT_EQ(0u, verifier_.GetCacheSize());
+}
+
+// Tests that a verification that was running when the cache was cleared
+// isn't cached or stored, but still completes.
+TEST_F(MultiThreadedCertVerifierTest, ClearCacheDropsInflightResult) {
+  FilePath certs_dir = GetTestCertsDirectory();
+  scoped_refptr<X509Certificate> test_cert(
+      ImportCertFromFile(certs_dir, "ok_cert.pem"));
+  ASSERT_NE(static_cast<X509Certificate*>(NULL), test_cert);
+
+  MockCacheStore* store =
+      new MockCacheStore(CertVerifierCacheStore::StoredResults());
+  verifier_.SetCacheStore(store);
+
+  int error;
+  CertVerifyResult verify_result;
+  TestCompletionCallback callback;
+  CertVerifier::RequestHandle request_handle;
+
+  error = verifier_.Verify(test_cert, "www.example.com", 0, NULL,
+                           &verify_result, callback.callback(),
+                           &request_handle, BoundNetLog());
+  ASSERT_EQ(ERR_IO_PENDING, error);
+  int save_count = store->save_count();
+  verifier_.ClearCache();
+  EXPECT_EQ(save_count + 1, store->save_count());
+  error = callback.WaitForResult();
+  ASSERT_TRUE(IsCertificateError(error));
+  EXPECT_EQ(0u, verifier_.GetCacheSize());
+
+  // Verifications started after the clear are cached again.
+  error = verifier_.Verify(test_cert, "www.example.com", 0, NULL,
+                           &verify_result, callback.callback(),
+                           &request_handle, BoundNetLog());
+  ASSERT_EQ(ERR_IO_PENDING, error);
+  error = callback.WaitForResult();
+  ASSERT_TRUE(IsCertificateError(error));
+  EXPECT_EQ(1u, verifier_.GetCacheSize());
+}
+
 }  // namespace net
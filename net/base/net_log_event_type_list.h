@@ -329,6 +329,10 @@ EVENT_TYPE(WAITING_FOR_PROXY_RESOLVER_THREAD)
 //   }
 EVENT_TYPE(SUBMITTED_TO_RESOLVER_THREAD)
 
+// The MultiThreadedProxyResolver answered a request from its result cache
+// without running the PAC script.
+EVENT_TYPE(PROXY_RESOLVER_RESULT_CACHE_HIT)
+
 // ------------------------------------------------------------------------
 // Socket (Shared by stream and datagram sockets)
 // ------------------------------------------------------------------------
@@ -498,6 +502,18 @@ EVENT_TYPE(SSL_SNAP_START)
 // we merged the verification with the SSLHostInfo.
 EVENT_TYPE(SSL_VERIFICATION_MERGED)
 
+// A TLS session saved in the SSLSessionStore was added to NSS's client
+// session cache and will be offered for resumption.
+EVENT_TYPE(SSL_SESSION_IMPORTED)
+
+// The handshake completed. Records whether the session was resumed and
+// whether the offered session had been restored from the SSLSessionStore:
+//   {
+//     "resumed": <True if the server accepted the offered session>,
+//     "restored_session": <True if a saved session was imported>,
+//   }
+EVENT_TYPE(SSL_SESSION_RESUMPTION)
+
 // An SSL error occurred while calling an NSS function not directly related to
 // one of the above activities.  Can also be used when more information than
 // is provided by just an error code is needed:
@@ -1421,6 +1437,20 @@ EVENT_TYPE(CERT_VERIFIER_JOB)
 //   }
 EVENT_TYPE(CERT_VERIFIER_REQUEST_BOUND_TO_JOB)
 
+// This event is emitted when a CertVerifier request is looked up in the
+// verification cache.
+//
+// The event parameters are:
+//   {
+//      "cache_hit": <True if the result was taken from the cache>,
+//      "restored": <Only present on a hit. True if the cached result was
+//                   read back from disk rather than verified this session>,
+//      "requests": <Number of requests this CertVerifier has seen>,
+//      "cache_hits": <Number of those that were cache hits>,
+//      "restored_cache_hits": <Number of hits on results read from disk>,
+//   }
+EVENT_TYPE(CERT_VERIFIER_CACHE_LOOKUP)
+
 // ------------------------------------------------------------------------
 // HttpPipelinedConnection
 // ------------------------------------------------------------------------
@@ -0,0 +1,37 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/pickled_file_util.h"
+
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/pickle.h"
+
+namespace net {
+
+void WritePickledFileVersion(Pickle* pickle, int version) {
+  pickle->WriteInt(version);
+}
+
+bool ReadPickledFileVersion(const Pickle& pickle,
+                            PickleIterator* iter,
+                            int version) {
+  int stored_version;
+  return pickle.ReadInt(iter, &stored_version) && stored_version == version;
+}
+
+bool WriteFileAtomically(const FilePath& path, const std::string& data) {
+  FilePath temp_path;
+  if (!file_util::CreateTemporaryFileInDir(path.DirName(), &temp_path))
+    return false;
+  int size = static_cast<int>(data.size());
+  if (file_util::WriteFile(temp_path, data.data(), size) != size ||
+      !file_util::ReplaceFile(temp_path, path)) {
+    file_util::Delete(temp_path, false);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace net
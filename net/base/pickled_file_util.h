@@ -0,0 +1,40 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Helpers for small on-disk stores that keep their data as a Pickle which
+// starts with a format version, and replace a file as a whole on every write.
+// Readers discard files written in any other version, so a store bumps its
+// version whenever it changes what it pickles.
+
+#ifndef NET_BASE_PICKLED_FILE_UTIL_H_
+#define NET_BASE_PICKLED_FILE_UTIL_H_
+
+#include <string>
+
+#include "net/base/net_export.h"
+
+class FilePath;
+class Pickle;
+class PickleIterator;
+
+namespace net {
+
+// Starts |pickle| with |version|.
+NET_EXPORT_PRIVATE void WritePickledFileVersion(Pickle* pickle, int version);
+
+// Reads the version written by WritePickledFileVersion().  Returns false if
+// it is missing or isn't |version|.
+NET_EXPORT_PRIVATE bool ReadPickledFileVersion(const Pickle& pickle,
+                                               PickleIterator* iter,
+                                               int version);
+
+// Writes |data| to |path| through a temporary file in the same directory, so
+// that a crash never leaves a partial file under |path|.  Returns false on
+// failure, in which case |path| is untouched.
+NET_EXPORT_PRIVATE bool WriteFileAtomically(const FilePath& path,
+                                            const std::string& data);
+
+}  // namespace net
+
+#endif  // NET_BASE_PICKLED_FILE_UTIL_H_
@@ -0,0 +1,52 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/pickled_file_util.h"
+
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/pickle.h"
+#include "base/scoped_temp_dir.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+TEST(PickledFileUtilTest, Version) {
+  Pickle pickle;
+  WritePickledFileVersion(&pickle, 3);
+
+  PickleIterator iter(pickle);
+  EXPECT_TRUE(ReadPickledFileVersion(pickle, &iter, 3));
+  PickleIterator other_iter(pickle);
+  EXPECT_FALSE(ReadPickledFileVersion(pickle, &other_iter, 4));
+
+  Pickle empty;
+  PickleIterator empty_iter(empty);
+  EXPECT_FALSE(ReadPickledFileVersion(empty, &empty_iter, 3));
+}
+
+TEST(PickledFileUtilTest, WriteFileAtomically) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath path = temp_dir.path().AppendASCII("data");
+
+  ASSERT_TRUE(WriteFileAtomically(path, "first"));
+  ASSERT_TRUE(WriteFileAtomically(path, "second"));
+  std::string data;
+  ASSERT_TRUE(file_util::ReadFileToString(path, &data));
+  EXPECT_EQ("second", data);
+
+  // No temporary files are left behind.
+  file_util::FileEnumerator enumerator(temp_dir.path(), false,
+                                       file_util::FileEnumerator::FILES);
+  EXPECT_EQ(path, enumerator.Next());
+  EXPECT_TRUE(enumerator.Next().empty());
+
+  // A write into a missing directory fails without creating anything.
+  EXPECT_FALSE(WriteFileAtomically(
+      temp_dir.path().AppendASCII("missing").AppendASCII("data"), "x"));
+  EXPECT_FALSE(file_util::PathExists(temp_dir.path().AppendASCII("missing")));
+}
+
+}  // namespace net
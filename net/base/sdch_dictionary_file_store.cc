@@ -0,0 +1,182 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/sdch_dictionary_file_store.h"
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "base/sequenced_task_runner.h"
+#include "base/string_util.h"
+#include "net/base/pickled_file_util.h"
+
+namespace {
+
+// Version of the dictionary file format; see pickled_file_util.h.
+const int kFormatVersion = 1;
+
+const FilePath::CharType kDictionaryExtension[] = FILE_PATH_LITERAL(".sdch");
+const FilePath::CharType kDictionaryPattern[] = FILE_PATH_LITERAL("*.sdch");
+
+// Server hashes are URL safe base64, so they are always usable as file names,
+// but don't trust a name that came from somewhere else.
+bool IsValidServerHash(const std::string& server_hash) {
+  if (server_hash.empty())
+    return false;
+  for (size_t i = 0; i < server_hash.size(); ++i) {
+    char c = server_hash[i];
+    if (!IsAsciiAlpha(c) && !IsAsciiDigit(c) && c != '-' && c != '_')
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+namespace net {
+
+SdchDictionaryFileStore::SdchDictionaryFileStore(
+    const FilePath& directory,
+    base::SequencedTaskRunner* file_task_runner)
+    : directory_(directory),
+      file_task_runner_(file_task_runner),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
+}
+
+SdchDictionaryFileStore::~SdchDictionaryFileStore() {
+}
+
+void SdchDictionaryFileStore::Load(const LoadedCallback& loaded_callback) {
+  StoredDictionaries* dictionaries = new StoredDictionaries;
+  file_task_runner_->PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&SdchDictionaryFileStore::LoadOnFileThread,
+                 directory_, dictionaries),
+      base::Bind(&SdchDictionaryFileStore::OnLoaded,
+                 weak_factory_.GetWeakPtr(), loaded_callback,
+                 base::Owned(dictionaries)));
+}
+
+void SdchDictionaryFileStore::AddDictionary(
+    const StoredDictionary& dictionary) {
+  if (!IsValidServerHash(dictionary.server_hash)) {
+    NOTREACHED();
+    return;
+  }
+  file_task_runner_->PostTask(
+      FROM_HERE,
+      base::Bind(&SdchDictionaryFileStore::WriteOnFileThread,
+                 directory_, dictionary));
+}
+
+void SdchDictionaryFileStore::DeleteDictionary(
+    const std::string& server_hash) {
+  if (!IsValidServerHash(server_hash))
+    return;
+  file_task_runner_->PostTask(
+      FROM_HERE,
+      base::Bind(&SdchDictionaryFileStore::DeleteOnFileThread,
+                 GetDictionaryPath(directory_, server_hash)));
+}
+
+void SdchDictionaryFileStore::DeleteAllDictionaries() {
+  file_task_runner_->PostTask(
+      FROM_HERE,
+      base::Bind(&SdchDictionaryFileStore::DeleteAllOnFileThread,
+                 directory_));
+}
+
+// static
+void SdchDictionaryFileStore::Serialize(const StoredDictionary& dictionary,
+                                        std::string* data) {
+  Pickle pickle;
+  WritePickledFileVersion(&pickle, kFormatVersion);
+  pickle.WriteString(dictionary.url.spec());
+  pickle.WriteInt64(dictionary.expiration.ToInternalValue());
+  pickle.WriteString(dictionary.text);
+  data->assign(static_cast<const char*>(pickle.data()), pickle.size());
+}
+
+// static
+bool SdchDictionaryFileStore::Deserialize(const std::string& data,
+                                          StoredDictionary* dictionary) {
+  Pickle pickle(data.data(), static_cast<int>(data.size()));
+  PickleIterator iter(pickle);
+  std::string url;
+  int64 expiration;
+  if (!ReadPickledFileVersion(pickle, &iter, kFormatVersion) ||
+      !pickle.ReadString(&iter, &url) ||
+      !pickle.ReadInt64(&iter, &expiration) ||
+      !pickle.ReadString(&iter, &dictionary->text)) {
+    return false;
+  }
+  dictionary->url = GURL(url);
+  dictionary->expiration = base::Time::FromInternalValue(expiration);
+  return dictionary->url.is_valid();
+}
+
+// static
+FilePath SdchDictionaryFileStore::GetDictionaryPath(
+    const FilePath& directory,
+    const std::string& server_hash) {
+  return directory.AppendASCII(server_hash).ReplaceExtension(kDictionaryExtension);
+}
+
+// static
+void SdchDictionaryFileStore::LoadOnFileThread(
+    const FilePath& directory,
+    StoredDictionaries* dictionaries) {
+  file_util::FileEnumerator enumerator(directory, false,
+                                       file_util::FileEnumerator::FILES,
+                                       kDictionaryPattern);
+  for (FilePath path = enumerator.Next(); !path.empty();
+       path = enumerator.Next()) {
+    std::string data;
+    StoredDictionary dictionary;
+    // The name is the server hash; SdchManager checks it against the text.
+    dictionary.server_hash = path.BaseName().RemoveExtension().MaybeAsASCII();
+    if (!IsValidServerHash(dictionary.server_hash) ||
+        !file_util::ReadFileToString(path, &data) ||
+        !Deserialize(data, &dictionary)) {
+      DVLOG(1) << "Discarding unreadable SDCH dictionary " << path.value();
+      file_util::Delete(path, false);
+      continue;
+    }
+    dictionaries->push_back(dictionary);
+  }
+}
+
+// static
+void SdchDictionaryFileStore::WriteOnFileThread(
+    const FilePath& directory,
+    const StoredDictionary& dictionary) {
+  if (!file_util::CreateDirectory(directory))
+    return;
+
+  std::string data;
+  Serialize(dictionary, &data);
+  WriteFileAtomically(GetDictionaryPath(directory, dictionary.server_hash),
+                      data);
+}
+
+// static
+void SdchDictionaryFileStore::DeleteOnFileThread(const FilePath& path) {
+  file_util::Delete(path, false);
+}
+
+// static
+void SdchDictionaryFileStore::DeleteAllOnFileThread(
+    const FilePath& directory) {
+  // This also takes any temporary file of an interrupted write.
+  file_util::Delete(directory, true);
+}
+
+void SdchDictionaryFileStore::OnLoaded(const LoadedCallback& loaded_callback,
+                                       StoredDictionaries* dictionaries) {
+  loaded_callback.Run(*dictionaries);
+}
+
+}  // namespace net
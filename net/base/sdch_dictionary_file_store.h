@@ -0,0 +1,69 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// SdchDictionaryFileStore persists SDCH dictionaries as one file per
+// dictionary in a directory, named after the dictionary's server hash.  All
+// disk access happens on the supplied file task runner.
+
+#ifndef NET_BASE_SDCH_DICTIONARY_FILE_STORE_H_
+#define NET_BASE_SDCH_DICTIONARY_FILE_STORE_H_
+#pragma once
+
+#include "base/compiler_specific.h"
+#include "base/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "net/base/net_export.h"
+#include "net/base/sdch_manager.h"
+
+namespace base {
+class SequencedTaskRunner;
+}
+
+namespace net {
+
+class NET_EXPORT SdchDictionaryFileStore : public SdchDictionaryStore {
+ public:
+  // Dictionaries are kept in |directory|, which is created if needed.
+  SdchDictionaryFileStore(const FilePath& directory,
+                          base::SequencedTaskRunner* file_task_runner);
+  virtual ~SdchDictionaryFileStore();
+
+  // SdchDictionaryStore implementation.
+  virtual void Load(const LoadedCallback& loaded_callback) OVERRIDE;
+  virtual void AddDictionary(const StoredDictionary& dictionary) OVERRIDE;
+  virtual void DeleteDictionary(const std::string& server_hash) OVERRIDE;
+  virtual void DeleteAllDictionaries() OVERRIDE;
+
+  // Serializes |dictionary| to |data|, and back.  Exposed for testing.
+  static void Serialize(const StoredDictionary& dictionary, std::string* data);
+  static bool Deserialize(const std::string& data,
+                          StoredDictionary* dictionary);
+
+ private:
+  // Returns the file that holds the dictionary with |server_hash|.
+  static FilePath GetDictionaryPath(const FilePath& directory,
+                                    const std::string& server_hash);
+
+  // These run on the file task runner.
+  static void LoadOnFileThread(const FilePath& directory,
+                               StoredDictionaries* dictionaries);
+  static void WriteOnFileThread(const FilePath& directory,
+                                const StoredDictionary& dictionary);
+  static void DeleteOnFileThread(const FilePath& path);
+  static void DeleteAllOnFileThread(const FilePath& directory);
+
+  void OnLoaded(const LoadedCallback& loaded_callback,
+                StoredDictionaries* dictionaries);
+
+  const FilePath directory_;
+  scoped_refptr<base::SequencedTaskRunner> file_task_runner_;
+  base::WeakPtrFactory<SdchDictionaryFileStore> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(SdchDictionaryFileStore);
+};
+
+}  // namespace net
+
+#endif  // NET_BASE_SDCH_DICTIONARY_FILE_STORE_H_
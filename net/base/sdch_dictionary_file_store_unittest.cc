@@ -0,0 +1,221 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/base/sdch_dictionary_file_store.h"
+
+#include "base/bind.h"
+#include "base/file_util.h"
+#include "base/message_loop.h"
+#include "base/message_loop_proxy.h"
+#include "base/scoped_temp_dir.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const char kSampleDomain[] = "sdchtest.com";
+const char kVcdiffDictionary[] = "DictionaryFor"
+    "SdchCompression1SdchCompression2SdchCompression3SdchCompression\n";
+
+std::string NewSdchDictionary(const std::string& domain) {
+  std::string dictionary("Domain: ");
+  dictionary.append(domain);
+  dictionary.append("\n\n");
+  dictionary.append(kVcdiffDictionary);
+  return dictionary;
+}
+
+void CopyDictionaries(SdchDictionaryStore::StoredDictionaries* out,
+                      const SdchDictionaryStore::StoredDictionaries& in) {
+  *out = in;
+}
+
+// Accepts every fetch; the test adds the dictionary itself.
+class NullFetcher : public SdchFetcher {
+ public:
+  NullFetcher() {}
+  virtual void Schedule(const GURL& dictionary_url) OVERRIDE {}
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(NullFetcher);
+};
+
+}  // namespace
+
+class SdchDictionaryFileStoreTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    SdchManager::EnableSdchSupport(true);
+  }
+
+  SdchDictionaryFileStore* NewStore() {
+    return new SdchDictionaryFileStore(
+        temp_dir_.path(), base::MessageLoopProxy::current());
+  }
+
+  SdchDictionaryStore::StoredDictionaries LoadAll(SdchDictionaryStore* store) {
+    SdchDictionaryStore::StoredDictionaries dictionaries;
+    store->Load(base::Bind(&CopyDictionaries, &dictionaries));
+    MessageLoop::current()->RunAllPending();
+    return dictionaries;
+  }
+
+  MessageLoop message_loop_;
+  ScopedTempDir temp_dir_;
+};
+
+TEST_F(SdchDictionaryFileStoreTest, SerializeRoundTrip) {
+  SdchDictionaryStore::StoredDictionary dictionary;
+  dictionary.text = NewSdchDictionary(kSampleDomain);
+  dictionary.url = GURL("http://sdchtest.com/dict");
+  dictionary.expiration = base::Time::Now();
+
+  std::string data;
+  SdchDictionaryFileStore::Serialize(dictionary, &data);
+  SdchDictionaryStore::StoredDictionary result;
+  ASSERT_TRUE(SdchDictionaryFileStore::Deserialize(data, &result));
+  EXPECT_EQ(dictionary.text, result.text);
+  EXPECT_EQ(dictionary.url, result.url);
+  EXPECT_EQ(dictionary.expiration, result.expiration);
+
+  // A truncated record is rejected.
+  EXPECT_FALSE(SdchDictionaryFileStore::Deserialize(
+      data.substr(0, data.size() / 2), &result));
+}
+
+TEST_F(SdchDictionaryFileStoreTest, AddLoadDelete) {
+  scoped_ptr<SdchDictionaryFileStore> store(NewStore());
+  SdchDictionaryStore::StoredDictionary dictionary;
+  dictionary.text = NewSdchDictionary(kSampleDomain);
+  std::string client_hash;
+  SdchManager::GenerateHash(dictionary.text, &client_hash,
+                            &dictionary.server_hash);
+  dictionary.url = GURL("http://sdchtest.com/dict");
+  dictionary.expiration = base::Time::Now() + base::TimeDelta::FromDays(1);
+  store->AddDictionary(dictionary);
+  MessageLoop::current()->RunAllPending();
+
+  SdchDictionaryStore::StoredDictionaries loaded = LoadAll(store.get());
+  ASSERT_EQ(1U, loaded.size());
+  EXPECT_EQ(dictionary.server_hash, loaded[0].server_hash);
+  EXPECT_EQ(dictionary.text, loaded[0].text);
+
+  store->DeleteDictionary(dictionary.server_hash);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_TRUE(LoadAll(store.get()).empty());
+}
+
+TEST_F(SdchDictionaryFileStoreTest, UnreadableFileIsDiscarded) {
+  FilePath path = temp_dir_.path().AppendASCII("AAAAAAAA.sdch");
+  ASSERT_EQ(3, file_util::WriteFile(path, "bad", 3));
+
+  scoped_ptr<SdchDictionaryFileStore> store(NewStore());
+  EXPECT_TRUE(LoadAll(store.get()).empty());
+  EXPECT_FALSE(file_util::PathExists(path));
+}
+
+// Dictionaries added to one SdchManager are available to the next one that
+// uses the same store directory.
+TEST_F(SdchDictionaryFileStoreTest, ManagerRestoresDictionaries) {
+  std::string dictionary(NewSdchDictionary(kSampleDomain));
+  std::string client_hash, server_hash;
+  SdchManager::GenerateHash(dictionary, &client_hash, &server_hash);
+  GURL url("http://sdchtest.com");
+
+  {
+    SdchManager manager;
+    manager.set_sdch_dictionary_store(NewStore());
+    MessageLoop::current()->RunAllPending();
+    EXPECT_TRUE(manager.AddSdchDictionary(dictionary, url));
+    MessageLoop::current()->RunAllPending();
+  }
+
+  SdchManager manager;
+  SdchManager::Dictionary* found = NULL;
+  manager.GetVcdiffDictionary(server_hash, url, &found);
+  EXPECT_FALSE(found);
+
+  manager.set_sdch_dictionary_store(NewStore());
+  MessageLoop::current()->RunAllPending();
+  manager.GetVcdiffDictionary(server_hash, url, &found);
+  EXPECT_TRUE(found);
+}
+
+// A stored dictionary whose text no longer matches its hash is dropped.
+TEST_F(SdchDictionaryFileStoreTest, ManagerRejectsHashMismatch) {
+  std::string dictionary(NewSdchDictionary(kSampleDomain));
+  std::string client_hash, server_hash;
+  SdchManager::GenerateHash(dictionary, &client_hash, &server_hash);
+
+  SdchDictionaryStore::StoredDictionary stored;
+  stored.server_hash = server_hash;
+  stored.text = dictionary + "tampered";
+  stored.url = GURL("http://sdchtest.com");
+  stored.expiration = base::Time::Now() + base::TimeDelta::FromDays(1);
+  scoped_ptr<SdchDictionaryFileStore> store(NewStore());
+  store->AddDictionary(stored);
+  MessageLoop::current()->RunAllPending();
+  store.reset();
+
+  SdchManager manager;
+  manager.set_sdch_dictionary_store(NewStore());
+  MessageLoop::current()->RunAllPending();
+  SdchManager::Dictionary* found = NULL;
+  manager.GetVcdiffDictionary(server_hash, stored.url, &found);
+  EXPECT_FALSE(found);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_TRUE(file_util::IsDirectoryEmpty(temp_dir_.path()));
+}
+
+// A dictionary fetched for an off the record request is usable, but never
+// reaches the store.
+TEST_F(SdchDictionaryFileStoreTest, ManagerDoesNotStoreOffTheRecord) {
+  std::string dictionary(NewSdchDictionary(kSampleDomain));
+  std::string client_hash, server_hash;
+  SdchManager::GenerateHash(dictionary, &client_hash, &server_hash);
+  GURL page_url("http://sdchtest.com/page");
+  GURL dictionary_url("http://sdchtest.com/dict");
+
+  SdchManager manager;
+  manager.set_sdch_fetcher(new NullFetcher);
+  manager.set_sdch_dictionary_store(NewStore());
+  MessageLoop::current()->RunAllPending();
+  manager.FetchDictionary(page_url, dictionary_url, true);
+  EXPECT_TRUE(manager.AddSdchDictionary(dictionary, dictionary_url));
+  MessageLoop::current()->RunAllPending();
+
+  SdchManager::Dictionary* found = NULL;
+  manager.GetVcdiffDictionary(server_hash, page_url, &found);
+  EXPECT_TRUE(found);
+  EXPECT_TRUE(file_util::IsDirectoryEmpty(temp_dir_.path()));
+}
+
+// Clearing drops the dictionaries from memory and from the store.
+TEST_F(SdchDictionaryFileStoreTest, ManagerClearDictionaries) {
+  std::string dictionary(NewSdchDictionary(kSampleDomain));
+  std::string client_hash, server_hash;
+  SdchManager::GenerateHash(dictionary, &client_hash, &server_hash);
+  GURL url("http://sdchtest.com");
+
+  SdchManager manager;
+  manager.set_sdch_dictionary_store(NewStore());
+  MessageLoop::current()->RunAllPending();
+  EXPECT_TRUE(manager.AddSdchDictionary(dictionary, url));
+  MessageLoop::current()->RunAllPending();
+  EXPECT_FALSE(file_util::IsDirectoryEmpty(temp_dir_.path()));
+
+  manager.ClearDictionaries();
+  MessageLoop::current()->RunAllPending();
+  SdchManager::Dictionary* found = NULL;
+  manager.GetVcdiffDictionary(server_hash, url, &found);
+  EXPECT_FALSE(found);
+
+  scoped_ptr<SdchDictionaryFileStore> store(NewStore());
+  EXPECT_TRUE(LoadAll(store.get()).empty());
+}
+
+}  // namespace net
@@ -0,0 +1,134 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/perftimer.h"
+#include "googleurl/src/gurl.h"
+#include "net/base/filter.h"
+#include "net/base/io_buffer.h"
+#include "net/base/mock_filter_context.h"
+#include "net/base/sdch_manager.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// The same sample dictionary and VCDIFF data as sdch_filter_unittest.cc.
+const char kTestVcdiffDictionary[] = "DictionaryFor"
+    "SdchCompression1SdchCompression2SdchCompression3SdchCompression\n";
+const char kTestData[] = "0000000000000000000000000000000000000000000000"
+    "0000000000000000000000000000TestData "
+    "SdchCompression1SdchCompression2SdchCompression3SdchCompression"
+    "00000000000000000000000000000000000000000000000000000000000000000000000000"
+    "000000000000000000000000000000000000000\n";
+const char kSdchCompressedTestData[] =
+    "\326\303\304\0\0\001M\0\201S\202\004\0\201E\006\001"
+    "00000000000000000000000000000000000000000000000000000000000000000000000000"
+    "TestData 00000000000000000000000000000000000000000000000000000000000000000"
+    "000000000000000000000000000000000000000000000000\n\001S\023\077\001r\r";
+
+const char kSampleDomain[] = "sdchtest.com";
+
+// Number of responses decoded per measurement.
+const int kResponses = 20000;
+
+// Number of extra dictionaries loaded, so lookups don't hit a lone entry.
+const int kExtraDictionaries = 15;
+
+const int kReadBufferSize = 4096;
+
+}  // namespace
+
+namespace net {
+
+class SdchFilterPerfTest : public testing::Test {
+ protected:
+  SdchFilterPerfTest() : url_(std::string("http://") + kSampleDomain) {
+  }
+
+  virtual void SetUp() {
+    SdchManager::EnableSdchSupport(true);
+    dictionary_ = MakeDictionary("");
+    ASSERT_TRUE(sdch_manager_.AddSdchDictionary(dictionary_, url_));
+    for (int i = 0; i < kExtraDictionaries; ++i) {
+      ASSERT_TRUE(sdch_manager_.AddSdchDictionary(
+          MakeDictionary(std::string(i + 1, '.')), url_));
+    }
+
+    std::string client_hash;
+    SdchManager::GenerateHash(dictionary_, &client_hash, &server_hash_);
+    compressed_ = server_hash_;
+    compressed_.append("\0", 1);
+    compressed_.append(kSdchCompressedTestData,
+                       sizeof(kSdchCompressedTestData) - 1);
+  }
+
+  // Builds an SDCH dictionary; |suffix| makes the hashes distinct.
+  static std::string MakeDictionary(const std::string& suffix) {
+    std::string dictionary("Domain: ");
+    dictionary.append(kSampleDomain);
+    dictionary.append("\n\n");
+    dictionary.append(kTestVcdiffDictionary,
+                      sizeof(kTestVcdiffDictionary) - 1);
+    dictionary.append(suffix);
+    return dictionary;
+  }
+
+  SdchManager sdch_manager_;
+  const GURL url_;
+  std::string dictionary_;
+  std::string server_hash_;
+  std::string compressed_;
+};
+
+TEST_F(SdchFilterPerfTest, DictionaryLookup) {
+  PerfTimeLogger timer("Sdch_dictionary_lookup");
+  for (int i = 0; i < kResponses; ++i) {
+    SdchManager::Dictionary* dictionary = NULL;
+    sdch_manager_.GetVcdiffDictionary(server_hash_, url_, &dictionary);
+    ASSERT_TRUE(dictionary);
+  }
+  timer.Done();
+}
+
+TEST_F(SdchFilterPerfTest, DecodeThroughput) {
+  MockFilterContext filter_context;
+  filter_context.SetURL(url_);
+  std::vector<Filter::FilterType> filter_types;
+  filter_types.push_back(Filter::FILTER_TYPE_SDCH);
+  scoped_array<char> read_buffer(new char[kReadBufferSize]);
+  const size_t expected_len = sizeof(kTestData) - 1;
+
+  PerfTimer timer;
+  for (int i = 0; i < kResponses; ++i) {
+    scoped_ptr<Filter> filter(Filter::Factory(filter_types, filter_context));
+    ASSERT_TRUE(filter.get());
+    ASSERT_LE(static_cast<int>(compressed_.size()),
+              filter->stream_buffer_size());
+    memcpy(filter->stream_buffer()->data(), compressed_.data(),
+           compressed_.size());
+    filter->FlushStreamBuffer(static_cast<int>(compressed_.size()));
+
+    size_t decoded_len = 0;
+    Filter::FilterStatus status;
+    do {
+      int read_len = kReadBufferSize;
+      status = filter->ReadData(read_buffer.get(), &read_len);
+      ASSERT_NE(Filter::FILTER_ERROR, status);
+      decoded_len += read_len;
+    } while (status == Filter::FILTER_OK);
+    ASSERT_EQ(expected_len, decoded_len);
+  }
+  base::TimeDelta elapsed = timer.Elapsed();
+  LogPerfResult("Sdch_decode_time", elapsed.InMillisecondsF(), "ms");
+  LogPerfResult("Sdch_decode_responses_per_sec",
+                kResponses / elapsed.InSecondsF(), "responses/s");
+  LogPerfResult("Sdch_decode_output_MB_per_sec",
+                kResponses * expected_len / elapsed.InSecondsF() / (1 << 20),
+                "MB/s");
+}
+
+}  // namespace net
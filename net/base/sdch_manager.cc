@@ -5,6 +5,7 @@
 #include "net/base/sdch_manager.h"
 
 #include "base/base64.h"
+#include "base/bind.h"
 #include "base/logging.h"
 #include "base/metrics/histogram.h"
 #include "base/string_number_conversions.h"
@@ -28,6 +29,13 @@ SdchManager* SdchManager::global_ = NULL;
 // static
 bool SdchManager::g_sdch_enabled_ = true;
 
+//------------------------------------------------------------------------------
+SdchDictionaryStore::StoredDictionary::StoredDictionary() {
+}
+
+SdchDictionaryStore::StoredDictionary::~StoredDictionary() {
+}
+
 //------------------------------------------------------------------------------
 SdchManager::Dictionary::Dictionary(const std::string& dictionary_text,
                                     size_t offset,
@@ -204,7 +212,8 @@ bool SdchManager::Dictionary::DomainMatch(const GURL& gurl,
 }
 
 //------------------------------------------------------------------------------
-SdchManager::SdchManager() {
+SdchManager::SdchManager()
+    : ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
   DCHECK(!global_);
   DCHECK(CalledOnValidThread());
   global_ = this;
@@ -216,7 +225,7 @@ SdchManager::~SdchManager() {
   while (!dictionaries_.empty()) {
     DictionaryMap::iterator it = dictionaries_.begin();
     it->second->Release();
-    dictionaries_.erase(it->first);
+    dictionaries_.erase(it);
   }
   global_ = NULL;
 }
@@ -227,6 +236,7 @@ void SdchManager::Shutdown() {
   if (!global_ )
     return;
   global_->set_sdch_fetcher(NULL);
+  global_->set_sdch_dictionary_store(NULL);
 }
 
 // static
@@ -244,6 +254,15 @@ void SdchManager::set_sdch_fetcher(SdchFetcher* fetcher) {
   fetcher_.reset(fetcher);
 }
 
+void SdchManager::set_sdch_dictionary_store(SdchDictionaryStore* store) {
+  DCHECK(CalledOnValidThread());
+  dictionary_store_.reset(store);
+  if (dictionary_store_.get()) {
+    dictionary_store_->Load(base::Bind(&SdchManager::OnDictionariesLoaded,
+                                       weak_factory_.GetWeakPtr()));
+  }
+}
+
 // static
 void SdchManager::EnableSdchSupport(bool enabled) {
   g_sdch_enabled_ = enabled;
@@ -330,11 +349,15 @@ bool SdchManager::IsInSupportedDomain(const GURL& url) {
 }
 
 void SdchManager::FetchDictionary(const GURL& request_url,
-                                  const GURL& dictionary_url) {
+                                  const GURL& dictionary_url,
+                                  bool off_the_record) {
   DCHECK(CalledOnValidThread());
   if (SdchManager::Global()->CanFetchDictionary(request_url, dictionary_url) &&
-      fetcher_.get())
+      fetcher_.get()) {
+    if (off_the_record)
+      off_the_record_dictionary_urls_.insert(dictionary_url);
     fetcher_->Schedule(dictionary_url);
+  }
 }
 
 bool SdchManager::CanFetchDictionary(const GURL& referring_url,
@@ -373,6 +396,48 @@ bool SdchManager::CanFetchDictionary(const GURL& referring_url,
 bool SdchManager::AddSdchDictionary(const std::string& dictionary_text,
     const GURL& dictionary_url) {
   DCHECK(CalledOnValidThread());
+  // Whether or not the dictionary is accepted, an off the record fetch of
+  // |dictionary_url| has now completed.
+  bool off_the_record =
+      off_the_record_dictionary_urls_.erase(dictionary_url) > 0;
+  std::string server_hash;
+  if (!AddSdchDictionaryInternal(dictionary_text, dictionary_url, base::Time(),
+                                 &server_hash)) {
+    return false;
+  }
+
+  if (dictionary_store_.get() && !off_the_record) {
+    SdchDictionaryStore::StoredDictionary stored;
+    stored.server_hash = server_hash;
+    stored.text = dictionary_text;
+    stored.url = dictionary_url;
+    stored.expiration = dictionaries_[server_hash]->expiration();
+    dictionary_store_->AddDictionary(stored);
+  }
+  return true;
+}
+
+void SdchManager::ClearDictionaries() {
+  DCHECK(CalledOnValidThread());
+  for (DictionaryMap::iterator it = dictionaries_.begin();
+       it != dictionaries_.end(); ++it) {
+    it->second->Release();
+  }
+  dictionaries_.clear();
+  allow_latency_experiment_.clear();
+
+  if (dictionary_store_.get()) {
+    // A load still in flight would bring the deleted dictionaries back.
+    weak_factory_.InvalidateWeakPtrs();
+    dictionary_store_->DeleteAllDictionaries();
+  }
+}
+
+bool SdchManager::AddSdchDictionaryInternal(
+    const std::string& dictionary_text,
+    const GURL& dictionary_url,
+    const base::Time& stored_expiration,
+    std::string* server_hash_out) {
   std::string client_hash;
   std::string server_hash;
   GenerateHash(dictionary_text, &client_hash, &server_hash);
@@ -458,6 +523,9 @@ bool SdchManager::AddSdchDictionary(const std::string& dictionary_text,
     return false;
   }
 
+  if (!stored_expiration.is_null())
+    expiration = stored_expiration;
+
   UMA_HISTOGRAM_COUNTS("Sdch3.Dictionary size loaded", dictionary_text.size());
   DVLOG(1) << "Loaded dictionary with client hash " << client_hash
            << " and server hash " << server_hash;
@@ -466,9 +534,48 @@ bool SdchManager::AddSdchDictionary(const std::string& dictionary_text,
                      dictionary_url, domain, path, expiration, ports);
   dictionary->AddRef();
   dictionaries_[server_hash] = dictionary;
+  *server_hash_out = server_hash;
   return true;
 }
 
+void SdchManager::OnDictionariesLoaded(
+    const SdchDictionaryStore::StoredDictionaries& dictionaries) {
+  DCHECK(CalledOnValidThread());
+  int loaded_count = 0;
+  base::Time now = base::Time::Now();
+  for (SdchDictionaryStore::StoredDictionaries::const_iterator it =
+           dictionaries.begin();
+       it != dictionaries.end(); ++it) {
+    // The text on disk may have been damaged, so it only counts if it still
+    // hashes to the name it was stored under.
+    std::string client_hash;
+    std::string server_hash;
+    GenerateHash(it->text, &client_hash, &server_hash);
+    if (server_hash != it->server_hash) {
+      SdchErrorRecovery(DICTIONARY_STORED_HASH_MISMATCH);
+      dictionary_store_->DeleteDictionary(it->server_hash);
+      continue;
+    }
+    if (it->expiration < now) {
+      SdchErrorRecovery(DICTIONARY_STORED_EXPIRED);
+      dictionary_store_->DeleteDictionary(it->server_hash);
+      continue;
+    }
+    // A fetch may have already supplied this dictionary.
+    if (dictionaries_.find(server_hash) != dictionaries_.end())
+      continue;
+    // Run the stored dictionary through the same checks as a fetched one,
+    // since blacklisting or limits may have changed since it was stored.
+    if (!AddSdchDictionaryInternal(it->text, it->url, it->expiration,
+                                   &server_hash)) {
+      dictionary_store_->DeleteDictionary(it->server_hash);
+      continue;
+    }
+    ++loaded_count;
+  }
+  UMA_HISTOGRAM_COUNTS_100("Sdch3.Dictionaries_Restored", loaded_count);
+}
+
 void SdchManager::GetVcdiffDictionary(const std::string& server_hash,
     const GURL& referring_url, Dictionary** dictionary) {
   DCHECK(CalledOnValidThread());
@@ -11,7 +11,8 @@
 // The SdchManager maintains a collection of memory resident dictionaries.  It
 // can find a dictionary (based on a server specification of a hash), store a
 // dictionary, and make judgements about what URLs can use, set, etc. a
-// dictionary.
+// dictionary.  If an SdchDictionaryStore is registered, dictionaries are also
+// written to it, and read back from it at startup.
 
 // These dictionaries are acquired over the net, and include a header
 // (containing metadata) as well as a VCDIFF dictionary (for use by a VCDIFF
@@ -24,10 +25,14 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
+#include "base/callback.h"
 #include "base/gtest_prod_util.h"
+#include "base/hash_tables.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/weak_ptr.h"
 #include "base/time.h"
 #include "base/threading/non_thread_safe.h"
 #include "googleurl/src/gurl.h"
@@ -54,6 +59,52 @@ class SdchFetcher {
   DISALLOW_COPY_AND_ASSIGN(SdchFetcher);
 };
 
+//------------------------------------------------------------------------------
+// An interface for keeping SDCH dictionaries across restarts, so that they
+// need not be re-fetched before SDCH pays off again.  The SdchManager class
+// allows registration of one store, and only ever calls it on its own thread.
+// Implementations must not block that thread on disk access.
+class NET_EXPORT SdchDictionaryStore {
+ public:
+  // A dictionary as it arrived from the server, plus the metadata that can't
+  // be derived from its text again.
+  struct NET_EXPORT_PRIVATE StoredDictionary {
+    StoredDictionary();
+    ~StoredDictionary();
+
+    // The server hash the dictionary was stored under.  It is checked against
+    // the hash of |text| when the dictionary is loaded.
+    std::string server_hash;
+    // The complete dictionary, including the metadata headers.
+    std::string text;
+    // The URL the dictionary was fetched from.
+    GURL url;
+    // The absolute expiration, since max-age is relative to the fetch time.
+    base::Time expiration;
+  };
+  typedef std::vector<StoredDictionary> StoredDictionaries;
+  typedef base::Callback<void(const StoredDictionaries&)> LoadedCallback;
+
+  SdchDictionaryStore() {}
+  virtual ~SdchDictionaryStore() {}
+
+  // Reads every stored dictionary, then runs |loaded_callback| on the calling
+  // thread.  The callback is not run if the store is destroyed first.
+  virtual void Load(const LoadedCallback& loaded_callback) = 0;
+
+  // Stores |dictionary|, replacing any dictionary with the same server hash.
+  virtual void AddDictionary(const StoredDictionary& dictionary) = 0;
+
+  // Removes the dictionary with the given |server_hash|, if any.
+  virtual void DeleteDictionary(const std::string& server_hash) = 0;
+
+  // Removes every stored dictionary.
+  virtual void DeleteAllDictionaries() = 0;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SdchDictionaryStore);
+};
+
 //------------------------------------------------------------------------------
 
 class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
@@ -107,6 +158,8 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
     DICTIONARY_COUNT_EXCEEDED = 35,
     DICTIONARY_ALREADY_SCHEDULED_TO_DOWNLOAD = 36,
     DICTIONARY_ALREADY_TRIED_TO_DOWNLOAD = 37,
+    DICTIONARY_STORED_HASH_MISMATCH = 38,
+    DICTIONARY_STORED_EXPIRED = 39,
 
     // Failsafe hack.
     ATTEMPT_TO_DECODE_NON_HTTP_DATA = 40,
@@ -188,6 +241,7 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
 
     const GURL& url() const { return url_; }
     const std::string& client_hash() const { return client_hash_; }
+    const base::Time& expiration() const { return expiration_; }
 
     // Security method to check if we can advertise this dictionary for use
     // if the |target_url| returns SDCH compressed data.
@@ -247,6 +301,11 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
   // Register a fetcher that this class can use to obtain dictionaries.
   void set_sdch_fetcher(SdchFetcher* fetcher);
 
+  // Register a store that this class uses to persist dictionaries, and start
+  // loading the dictionaries it already holds.  Takes ownership of |store|.
+  // Dictionaries added from now on are written to the store as well.
+  void set_sdch_dictionary_store(SdchDictionaryStore* store);
+
   // Enables or disables SDCH compression.
   static void EnableSdchSupport(bool enabled);
 
@@ -287,8 +346,10 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
   // Schedule the URL fetching to load a dictionary. This will always return
   // before the dictionary is actually loaded and added.
   // After the implied task does completes, the dictionary will have been
-  // cached in memory.
-  void FetchDictionary(const GURL& request_url, const GURL& dictionary_url);
+  // cached in memory.  If |off_the_record| is true, the dictionary was
+  // suggested to an off the record request and is never persisted.
+  void FetchDictionary(const GURL& request_url, const GURL& dictionary_url,
+                       bool off_the_record);
 
   // Security test function used before initiating a FetchDictionary.
   // Return true if fetch is legal.
@@ -301,6 +362,11 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
   bool AddSdchDictionary(const std::string& dictionary_text,
                          const GURL& dictionary_url);
 
+  // Drops every dictionary, both in memory and in the dictionary store, along
+  // with the hosts allowed to run latency experiments.  Used when the user
+  // clears browsing data.
+  void ClearDictionaries();
+
   // Find the vcdiff dictionary (the body of the sdch dictionary that appears
   // after the meta-data headers like Domain:...) with the given |server_hash|
   // to use to decompreses data that arrived as SDCH encoded content.  Check to
@@ -337,7 +403,8 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
   typedef std::set<std::string> ExperimentSet;
 
   // A map of dictionaries info indexed by the hash that the server provides.
-  typedef std::map<std::string, Dictionary*> DictionaryMap;
+  // Every SDCH response is looked up here, so use a hash table.
+  typedef base::hash_map<std::string, Dictionary*> DictionaryMap;
 
   // The one global instance of that holds all the data.
   static SdchManager* global_;
@@ -348,11 +415,32 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
   // A simple implementation of a RFC 3548 "URL safe" base64 encoder.
   static void UrlSafeBase64Encode(const std::string& input,
                                   std::string* output);
+
+  // Parses |dictionary_text| and adds it to dictionaries_, as
+  // AddSdchDictionary() does.  If |stored_expiration| is not null it overrides
+  // the expiration derived from the max-age header.  On success, the server
+  // hash of the new dictionary is returned in |server_hash|.
+  bool AddSdchDictionaryInternal(const std::string& dictionary_text,
+                                 const GURL& dictionary_url,
+                                 const base::Time& stored_expiration,
+                                 std::string* server_hash);
+
+  // Called by the dictionary store with the dictionaries it persisted.
+  void OnDictionariesLoaded(
+      const SdchDictionaryStore::StoredDictionaries& dictionaries);
+
   DictionaryMap dictionaries_;
 
   // An instance that can fetch a dictionary given a URL.
   scoped_ptr<SdchFetcher> fetcher_;
 
+  // An optional instance that persists dictionaries across restarts.
+  scoped_ptr<SdchDictionaryStore> dictionary_store_;
+
+  // Dictionary URLs that were fetched on behalf of off the record requests.
+  // Dictionaries from these URLs are kept out of |dictionary_store_|.
+  std::set<GURL> off_the_record_dictionary_urls_;
+
   // List domains where decode failures have required disabling sdch, along with
   // count of how many additonal uses should be blacklisted.
   DomainCounter blacklisted_domains_;
@@ -365,6 +453,8 @@ class NET_EXPORT SdchManager : public NON_EXPORTED_BASE(base::NonThreadSafe) {
   // round trip test has recently passed).
   ExperimentSet allow_latency_experiment_;
 
+  base::WeakPtrFactory<SdchManager> weak_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(SdchManager);
 };
 
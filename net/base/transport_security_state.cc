@@ -21,6 +21,7 @@
 #include "base/base64.h"
 #include "base/json/json_reader.h"
 #include "base/json/json_writer.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/metrics/histogram.h"
@@ -106,7 +107,7 @@ bool TransportSecurityState::DeleteHost(const std::string& host) {
   if (canonicalized_host.empty())
     return false;
 
-  std::map<std::string, DomainState>::iterator i = enabled_hosts_.find(
+  DomainStateMap::iterator i = enabled_hosts_.find(
       HashHost(canonicalized_host));
   if (i != enabled_hosts_.end()) {
     enabled_hosts_.erase(i);
@@ -158,7 +159,11 @@ bool TransportSecurityState::HasMetadata(DomainState* result,
       return true;
     }
 
-    std::map<std::string, DomainState>::iterator j =
+    // Most profiles have no dynamic entries; don't hash for nothing.
+    if (enabled_hosts_.empty())
+      continue;
+
+    DomainStateMap::iterator j =
         enabled_hosts_.find(HashHost(host_sub_chunk));
     if (j == enabled_hosts_.end())
       continue;
@@ -191,7 +196,7 @@ void TransportSecurityState::DeleteSince(const base::Time& time) {
 
   bool dirtied = false;
 
-  std::map<std::string, DomainState>::iterator i = enabled_hosts_.begin();
+  DomainStateMap::iterator i = enabled_hosts_.begin();
   while (i != enabled_hosts_.end()) {
     if (i->second.created >= time) {
       dirtied = true;
@@ -841,7 +846,7 @@ bool TransportSecurityState::Serialise(std::string* output) {
 
   DictionaryValue toplevel;
   base::Time now = base::Time::Now();
-  for (std::map<std::string, DomainState>::const_iterator
+  for (DomainStateMap::const_iterator
        i = enabled_hosts_.begin(); i != enabled_hosts_.end(); ++i) {
     DictionaryValue* state = new DictionaryValue;
     state->SetBoolean("include_subdomains", i->second.include_subdomains);
@@ -916,7 +921,7 @@ static void SPKIHashesFromListValue(FingerprintVector* hashes,
 bool TransportSecurityState::Deserialise(
     const std::string& input,
     bool* dirty,
-    std::map<std::string, DomainState>* out) {
+    DomainStateMap* out) {
   scoped_ptr<Value> value(
       base::JSONReader::Read(input, false /* do not allow trailing commas */));
   if (!value.get() || !value->IsType(Value::TYPE_DICTIONARY))
@@ -1111,43 +1116,6 @@ struct HSTSPreload {
   SecondLevelDomainName second_level_domain_name;
 };
 
-static bool HasPreload(const struct HSTSPreload* entries, size_t num_entries,
-                       const std::string& canonicalized_host, size_t i,
-                       TransportSecurityState::DomainState* out, bool* ret) {
-  for (size_t j = 0; j < num_entries; j++) {
-    if (entries[j].length == canonicalized_host.size() - i &&
-        memcmp(entries[j].dns_name, &canonicalized_host[i],
-               entries[j].length) == 0) {
-      if (!entries[j].include_subdomains && i != 0) {
-        *ret = false;
-      } else {
-        out->include_subdomains = entries[j].include_subdomains;
-        *ret = true;
-        if (!entries[j].https_required)
-          out->mode = TransportSecurityState::DomainState::MODE_PINNING_ONLY;
-        if (entries[j].pins.required_hashes) {
-          const char* const* hash = entries[j].pins.required_hashes;
-          while (*hash) {
-            bool ok = AddHash(*hash, &out->preloaded_spki_hashes);
-            DCHECK(ok) << " failed to parse " << *hash;
-            hash++;
-          }
-        }
-        if (entries[j].pins.excluded_hashes) {
-          const char* const* hash = entries[j].pins.excluded_hashes;
-          while (*hash) {
-            bool ok = AddHash(*hash, &out->bad_preloaded_spki_hashes);
-            DCHECK(ok) << " failed to parse " << *hash;
-            hash++;
-          }
-        }
-      }
-      return true;
-    }
-  }
-  return false;
-}
-
 // kNoRejectedPublicKeys is a placeholder for when no public keys are rejected.
 static const char* const kNoRejectedPublicKeys[] = {
   NULL,
@@ -1492,7 +1460,104 @@ static const struct HSTSPreload kPreloadedSNISTS[] = {
 };
 static const size_t kNumPreloadedSNISTS = ARRAYSIZE_UNSAFE(kPreloadedSNISTS);
 
-// Returns the HSTSPreload entry for the |canonicalized_host| in |entries|,
+namespace {
+
+// PreloadIndex maps the DNS form names of a preload list to their entries,
+// and keeps each entry's pins already decoded. A lookup is then one hash probe
+// per label instead of a scan of the list plus base64 decoding of the pins.
+class PreloadIndex {
+ public:
+  struct Entry {
+    Entry() : preload(NULL) {}
+
+    const struct HSTSPreload* preload;
+    FingerprintVector required_hashes;
+    FingerprintVector excluded_hashes;
+  };
+
+  PreloadIndex(const struct HSTSPreload* entries, size_t num_entries)
+      : entries_(num_entries) {
+    for (size_t j = 0; j < num_entries; j++) {
+      Entry* entry = &entries_[j];
+      entry->preload = &entries[j];
+      DecodeHashes(entries[j].pins.required_hashes, &entry->required_hashes);
+      DecodeHashes(entries[j].pins.excluded_hashes, &entry->excluded_hashes);
+      // insert() keeps the first entry for a name, like the linear scan did.
+      names_.insert(std::make_pair(
+          std::string(entries[j].dns_name, entries[j].length), j));
+    }
+  }
+
+  // Returns the entry whose name is exactly |dns_name|, or NULL.
+  const Entry* Find(const std::string& dns_name) const {
+    base::hash_map<std::string, size_t>::const_iterator i =
+        names_.find(dns_name);
+    return i == names_.end() ? NULL : &entries_[i->second];
+  }
+
+ private:
+  static void DecodeHashes(const char* const* hashes, FingerprintVector* out) {
+    if (!hashes)
+      return;
+    for (; *hashes; hashes++) {
+      bool ok = AddHash(*hashes, out);
+      DCHECK(ok) << " failed to parse " << *hashes;
+    }
+  }
+
+  std::vector<Entry> entries_;
+  base::hash_map<std::string, size_t> names_;
+
+  DISALLOW_COPY_AND_ASSIGN(PreloadIndex);
+};
+
+// The indexes over kPreloadedSTS and kPreloadedSNISTS. They are immutable once
+// built, so may be shared by every TransportSecurityState on every thread.
+struct PreloadIndexes {
+  PreloadIndexes()
+      : sts(kPreloadedSTS, kNumPreloadedSTS),
+        sni_sts(kPreloadedSNISTS, kNumPreloadedSNISTS) {
+  }
+
+  const PreloadIndex sts;
+  const PreloadIndex sni_sts;
+};
+
+base::LazyInstance<PreloadIndexes>::Leaky g_preload_indexes =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+// Looks up |host_sub_chunk|, which starts at offset |i| of the canonicalized
+// host, in |index|. Returns false if there is no entry for it. Otherwise
+// returns true and sets |*ret| to whether the entry applies to the host, in
+// which case |*out| is updated from the entry.
+static bool HasPreload(const PreloadIndex& index,
+                       const std::string& host_sub_chunk, size_t i,
+                       TransportSecurityState::DomainState* out, bool* ret) {
+  const PreloadIndex::Entry* entry = index.Find(host_sub_chunk);
+  if (!entry)
+    return false;
+
+  if (!entry->preload->include_subdomains && i != 0) {
+    *ret = false;
+  } else {
+    out->include_subdomains = entry->preload->include_subdomains;
+    *ret = true;
+    if (!entry->preload->https_required)
+      out->mode = TransportSecurityState::DomainState::MODE_PINNING_ONLY;
+    out->preloaded_spki_hashes.insert(out->preloaded_spki_hashes.end(),
+                                      entry->required_hashes.begin(),
+                                      entry->required_hashes.end());
+    out->bad_preloaded_spki_hashes.insert(
+        out->bad_preloaded_spki_hashes.end(),
+        entry->excluded_hashes.begin(),
+        entry->excluded_hashes.end());
+  }
+  return true;
+}
+
+// Returns the HSTSPreload entry for the |canonicalized_host| in |index|,
 // or NULL if there is none. Prefers exact hostname matches to those that
 // match only because HSTSPreload.include_subdomains is true.
 //
@@ -1500,20 +1565,17 @@ static const size_t kNumPreloadedSNISTS = ARRAYSIZE_UNSAFE(kPreloadedSNISTS);
 // CanonicalizeHost.
 static const struct HSTSPreload* GetHSTSPreload(
     const std::string& canonicalized_host,
-    const struct HSTSPreload* entries,
-    size_t num_entries) {
+    const PreloadIndex& index) {
   for (size_t i = 0; canonicalized_host[i]; i += canonicalized_host[i] + 1) {
-    for (size_t j = 0; j < num_entries; j++) {
-      const struct HSTSPreload* entry = entries + j;
+    const PreloadIndex::Entry* entry = index.Find(
+        std::string(&canonicalized_host[i], canonicalized_host.size() - i));
+    if (!entry)
+      continue;
 
-      if (i != 0 && !entry->include_subdomains)
-        continue;
+    if (i != 0 && !entry->preload->include_subdomains)
+      continue;
 
-      if (entry->length == canonicalized_host.size() - i &&
-          memcmp(entry->dns_name, &canonicalized_host[i], entry->length) == 0) {
-        return entry;
-      }
-    }
+    return entry->preload;
   }
 
   return NULL;
@@ -1524,14 +1586,14 @@ bool TransportSecurityState::IsGooglePinnedProperty(const std::string& host,
                                                     bool sni_available) {
   std::string canonicalized_host = CanonicalizeHost(host);
   const struct HSTSPreload* entry =
-      GetHSTSPreload(canonicalized_host, kPreloadedSTS, kNumPreloadedSTS);
+      GetHSTSPreload(canonicalized_host, g_preload_indexes.Get().sts);
 
   if (entry && entry->pins.required_hashes == kGoogleAcceptableCerts)
     return true;
 
   if (sni_available) {
-    entry = GetHSTSPreload(canonicalized_host, kPreloadedSNISTS,
-                           kNumPreloadedSNISTS);
+    entry = GetHSTSPreload(canonicalized_host,
+                           g_preload_indexes.Get().sni_sts);
     if (entry && entry->pins.required_hashes == kGoogleAcceptableCerts)
       return true;
   }
@@ -1544,11 +1606,11 @@ void TransportSecurityState::ReportUMAOnPinFailure(const std::string& host) {
   std::string canonicalized_host = CanonicalizeHost(host);
 
   const struct HSTSPreload* entry =
-      GetHSTSPreload(canonicalized_host, kPreloadedSTS, kNumPreloadedSTS);
+      GetHSTSPreload(canonicalized_host, g_preload_indexes.Get().sts);
 
   if (!entry) {
-    entry = GetHSTSPreload(canonicalized_host, kPreloadedSNISTS,
-                           kNumPreloadedSNISTS);
+    entry = GetHSTSPreload(canonicalized_host,
+                           g_preload_indexes.Get().sni_sts);
   }
 
   DCHECK(entry);
@@ -1571,25 +1633,26 @@ bool TransportSecurityState::IsPreloadedSTS(
   out->mode = DomainState::MODE_STRICT;
   out->include_subdomains = false;
 
+  const PreloadIndexes& indexes = g_preload_indexes.Get();
   for (size_t i = 0; canonicalized_host[i]; i += canonicalized_host[i] + 1) {
     std::string host_sub_chunk(&canonicalized_host[i],
                                canonicalized_host.size() - i);
     out->domain = DNSDomainToString(host_sub_chunk);
-    std::string hashed_host(HashHost(host_sub_chunk));
-    if (forced_hosts_.find(hashed_host) != forced_hosts_.end()) {
-      *out = forced_hosts_[hashed_host];
-      out->domain = DNSDomainToString(host_sub_chunk);
-      out->preloaded = true;
-      return true;
+    if (!forced_hosts_.empty()) {
+      std::string hashed_host(HashHost(host_sub_chunk));
+      DomainStateMap::const_iterator forced = forced_hosts_.find(hashed_host);
+      if (forced != forced_hosts_.end()) {
+        *out = forced->second;
+        out->domain = DNSDomainToString(host_sub_chunk);
+        out->preloaded = true;
+        return true;
+      }
     }
     bool ret;
-    if (HasPreload(kPreloadedSTS, kNumPreloadedSTS, canonicalized_host, i, out,
-                   &ret)) {
+    if (HasPreload(indexes.sts, host_sub_chunk, i, out, &ret))
       return ret;
-    }
     if (sni_available &&
-        HasPreload(kPreloadedSNISTS, kNumPreloadedSNISTS, canonicalized_host, i,
-                   out, &ret)) {
+        HasPreload(indexes.sni_sts, host_sub_chunk, i, out, &ret)) {
       return ret;
     }
   }
@@ -12,6 +12,7 @@
 
 #include "base/basictypes.h"
 #include "base/gtest_prod_util.h"
+#include "base/hash_tables.h"
 #include "base/threading/non_thread_safe.h"
 #include "base/time.h"
 #include "net/base/net_export.h"
@@ -249,6 +250,9 @@ class NET_EXPORT TransportSecurityState
  private:
   FRIEND_TEST_ALL_PREFIXES(TransportSecurityStateTest, IsPreloaded);
 
+  // Keyed by SHA256(DNSForm(domain)); see |enabled_hosts_|.
+  typedef base::hash_map<std::string, DomainState> DomainStateMap;
+
   // If we have a callback configured, call it to let our serialiser know that
   // our state is dirty.
   void DirtyNotify();
@@ -259,16 +263,16 @@ class NET_EXPORT TransportSecurityState
   static std::string CanonicalizeHost(const std::string& host);
   static bool Deserialise(const std::string& state,
                           bool* dirty,
-                          std::map<std::string, DomainState>* out);
+                          DomainStateMap* out);
 
   // The set of hosts that have enabled TransportSecurity. The keys here
   // are SHA256(DNSForm(domain)) where DNSForm converts from dotted form
   // ('www.google.com') to the form used in DNS: "\x03www\x06google\x03com"
-  std::map<std::string, DomainState> enabled_hosts_;
+  DomainStateMap enabled_hosts_;
 
   // These hosts are extra rules to treat as built-in, passed in the
   // constructor (typically originating from the command line).
-  std::map<std::string, DomainState> forced_hosts_;
+  DomainStateMap forced_hosts_;
 
   // Our delegate who gets notified when we are dirtied, or NULL.
   Delegate* delegate_;
@@ -0,0 +1,89 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "net/base/transport_security_state.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const int kLookups = 100000;
+
+// Number of dynamic entries added for the dynamic lookup tests.
+const int kDynamicHosts = 1000;
+
+// A mix of preloaded hosts, subdomains of preloaded hosts and hosts that are
+// not in any list; most requests are for the last kind.
+const char* const kHosts[] = {
+  "www.google.com",
+  "mail.google.com",
+  "docs.google.com",
+  "www.paypal.com",
+  "a.b.c.twitter.com",
+  "www.example.com",
+  "images.example.org",
+  "cdn.static.example.net",
+  "localhost",
+  "a.very.deeply.nested.subdomain.example.co.uk",
+};
+
+}  // namespace
+
+namespace net {
+
+class TransportSecurityStatePerfTest : public testing::Test {
+ protected:
+  TransportSecurityStatePerfTest() : state_("") {}
+
+  void AddDynamicHosts() {
+    TransportSecurityState::DomainState domain_state;
+    domain_state.expiry = base::Time::Now() + base::TimeDelta::FromDays(1000);
+    domain_state.include_subdomains = true;
+    for (int i = 0; i < kDynamicHosts; ++i)
+      state_.EnableHost(base::StringPrintf("host%d.example.com", i),
+                        domain_state);
+  }
+
+  void RunLookups(const char* name) {
+    int found = 0;
+    PerfTimeLogger timer(name);
+    for (int i = 0; i < kLookups; ++i) {
+      TransportSecurityState::DomainState domain_state;
+      if (state_.GetDomainState(&domain_state,
+                                kHosts[i % arraysize(kHosts)], true)) {
+        ++found;
+      }
+    }
+    timer.Done();
+    EXPECT_GT(found, 0);
+  }
+
+  TransportSecurityState state_;
+};
+
+TEST_F(TransportSecurityStatePerfTest, PreloadedLookup) {
+  RunLookups("TransportSecurityState_preloaded_lookup");
+}
+
+TEST_F(TransportSecurityStatePerfTest, DynamicLookup) {
+  AddDynamicHosts();
+  RunLookups("TransportSecurityState_dynamic_lookup");
+}
+
+TEST_F(TransportSecurityStatePerfTest, PinLookup) {
+  int found = 0;
+  PerfTimeLogger timer("TransportSecurityState_pin_lookup");
+  for (int i = 0; i < kLookups; ++i) {
+    TransportSecurityState::DomainState domain_state;
+    if (state_.HasPinsForHost(&domain_state, "mail.google.com", true))
+      ++found;
+  }
+  timer.Done();
+  EXPECT_EQ(kLookups, found);
+}
+
+}  // namespace net
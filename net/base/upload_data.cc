@@ -33,6 +33,7 @@ UploadData::Element::Element()
     : type_(TYPE_BYTES),
       file_range_offset_(0),
       file_range_length_(kuint64max),
+      shared_bytes_length_(0),
       is_last_chunk_(false),
       override_content_length_(false),
       content_length_computed_(false),
@@ -51,11 +52,42 @@ UploadData::Element::~Element() {
   }
 }
 
+const char* UploadData::Element::bytes_data() const {
+  if (shared_bytes_)
+    return shared_bytes_->data();
+  return bytes_.empty() ? NULL : &bytes_[0];
+}
+
+int UploadData::Element::bytes_length() const {
+  if (shared_bytes_)
+    return shared_bytes_length_;
+  return static_cast<int>(bytes_.size());
+}
+
+void UploadData::Element::SetToSharedBytes(IOBuffer* buffer, int buffer_len) {
+  DCHECK(buffer);
+  DCHECK_GE(buffer_len, 0);
+  type_ = TYPE_BYTES;
+  bytes_.clear();
+  shared_bytes_ = buffer;
+  shared_bytes_length_ = buffer_len;
+}
+
 void UploadData::Element::SetToChunk(const char* bytes,
                                      int bytes_len,
                                      bool is_last_chunk) {
   bytes_.clear();
   bytes_.insert(bytes_.end(), bytes, bytes + bytes_len);
+  shared_bytes_ = NULL;
+  shared_bytes_length_ = 0;
+  type_ = TYPE_CHUNK;
+  is_last_chunk_ = is_last_chunk;
+}
+
+void UploadData::Element::SetToSharedChunk(IOBuffer* buffer,
+                                           int buffer_len,
+                                           bool is_last_chunk) {
+  SetToSharedBytes(buffer, buffer_len);
   type_ = TYPE_CHUNK;
   is_last_chunk_ = is_last_chunk;
 }
@@ -65,7 +97,7 @@ uint64 UploadData::Element::GetContentLength() {
     return content_length_;
 
   if (type_ == TYPE_BYTES || type_ == TYPE_CHUNK)
-    return static_cast<uint64>(bytes_.size());
+    return static_cast<uint64>(bytes_length());
   else if (type_ == TYPE_BLOB)
     // The blob reference will be resolved later.
     return 0;
@@ -145,11 +177,10 @@ int UploadData::Element::ReadFromMemorySync(char* buf, int buf_len) {
   const size_t num_bytes_to_read = std::min(BytesRemaining(),
                                             static_cast<uint64>(buf_len));
 
-  // Check if we have anything to copy first, because we are getting
-  // the address of an element in |bytes_| and that will throw an
-  // exception if |bytes_| is an empty vector.
+  // Check if we have anything to copy first, because bytes_data() is NULL
+  // for an empty element.
   if (num_bytes_to_read > 0) {
-    memcpy(buf, &bytes_[offset_], num_bytes_to_read);
+    memcpy(buf, bytes_data() + offset_, num_bytes_to_read);
   }
 
   offset_ += num_bytes_to_read;
@@ -207,6 +238,14 @@ void UploadData::AppendBytes(const char* bytes, int bytes_len) {
   }
 }
 
+void UploadData::AppendSharedBytes(IOBuffer* bytes, int bytes_len) {
+  DCHECK(!is_chunked_);
+  if (bytes_len > 0) {
+    elements_.push_back(Element());
+    elements_.back().SetToSharedBytes(bytes, bytes_len);
+  }
+}
+
 void UploadData::AppendFileRange(const FilePath& file_path,
                                  uint64 offset, uint64 length,
                                  const base::Time& expected_modification_time) {
@@ -232,6 +271,16 @@ void UploadData::AppendChunk(const char* bytes,
     chunk_callback_->OnChunkAvailable();
 }
 
+void UploadData::AppendSharedChunk(IOBuffer* bytes,
+                                   int bytes_len,
+                                   bool is_last_chunk) {
+  DCHECK(is_chunked_);
+  elements_.push_back(Element());
+  elements_.back().SetToSharedChunk(bytes, bytes_len, is_last_chunk);
+  if (chunk_callback_)
+    chunk_callback_->OnChunkAvailable();
+}
+
 void UploadData::set_chunk_callback(ChunkCallback* callback) {
   chunk_callback_ = callback;
 }
@@ -6,6 +6,7 @@
 #define NET_BASE_UPLOAD_DATA_H_
 #pragma once
 
+#include <algorithm>
 #include <vector>
 
 #include "base/basictypes.h"
@@ -16,6 +17,7 @@
 #include "base/supports_user_data.h"
 #include "base/time.h"
 #include "googleurl/src/gurl.h"
+#include "net/base/io_buffer.h"
 #include "net/base/net_export.h"
 
 namespace net {
@@ -66,7 +68,13 @@ class NET_EXPORT UploadData
       type_ = type;
     }
 
+    // Only holds the data of elements set with SetToBytes() or SetToChunk().
+    // Use bytes_data() and bytes_length() to also handle shared buffers.
     const std::vector<char>& bytes() const { return bytes_; }
+    // Returns the data of a TYPE_BYTES or TYPE_CHUNK element, whether it was
+    // copied in or references a shared buffer.
+    const char* bytes_data() const;
+    int bytes_length() const;
     const FilePath& file_path() const { return file_path_; }
     uint64 file_range_offset() const { return file_range_offset_; }
     uint64 file_range_length() const { return file_range_length_; }
@@ -79,8 +87,15 @@ class NET_EXPORT UploadData
     void SetToBytes(const char* bytes, int bytes_len) {
       type_ = TYPE_BYTES;
       bytes_.assign(bytes, bytes + bytes_len);
+      shared_bytes_ = NULL;
+      shared_bytes_length_ = 0;
     }
 
+    // Like SetToBytes(), but references the first |buffer_len| bytes of
+    // |buffer| rather than copying them.  The caller must not modify them
+    // until the upload is done.
+    void SetToSharedBytes(IOBuffer* buffer, int buffer_len);
+
     void SetToFilePath(const FilePath& path) {
       SetToFilePathRange(path, 0, kuint64max, base::Time());
     }
@@ -110,6 +125,10 @@ class NET_EXPORT UploadData
     // is available.
     void SetToChunk(const char* bytes, int bytes_len, bool is_last_chunk);
 
+    // Like SetToChunk(), but references |buffer| as SetToSharedBytes() does.
+    void SetToSharedChunk(IOBuffer* buffer, int buffer_len,
+                          bool is_last_chunk);
+
     bool is_last_chunk() const { return is_last_chunk_; }
     // Sets whether this is the last chunk. Used during IPC marshalling.
     void set_is_last_chunk(bool is_last_chunk) {
@@ -153,6 +172,9 @@ class NET_EXPORT UploadData
 
     Type type_;
     std::vector<char> bytes_;
+    // Set instead of |bytes_| for elements that reference caller-owned data.
+    scoped_refptr<IOBuffer> shared_bytes_;
+    int shared_bytes_length_;
     FilePath file_path_;
     uint64 file_range_offset_;
     uint64 file_range_length_;
@@ -185,6 +207,10 @@ class NET_EXPORT UploadData
 
   void AppendBytes(const char* bytes, int bytes_len);
 
+  // Appends the first |bytes_len| bytes of |bytes| without copying them.  See
+  // Element::SetToSharedBytes().
+  void AppendSharedBytes(IOBuffer* bytes, int bytes_len);
+
   void AppendFileRange(const FilePath& file_path,
                        uint64 offset, uint64 length,
                        const base::Time& expected_modification_time);
@@ -195,6 +221,9 @@ class NET_EXPORT UploadData
   // encoding.
   void AppendChunk(const char* bytes, int bytes_len, bool is_last_chunk);
 
+  // Like AppendChunk(), but references |bytes| rather than copying it.
+  void AppendSharedChunk(IOBuffer* bytes, int bytes_len, bool is_last_chunk);
+
   // Sets the callback to be invoked when a new chunk is available to upload.
   void set_chunk_callback(ChunkCallback* callback);
 
@@ -262,8 +291,11 @@ inline bool operator==(const UploadData::Element& a,
                        const UploadData::Element& b) {
   if (a.type() != b.type())
     return false;
-  if (a.type() == UploadData::TYPE_BYTES)
-    return a.bytes() == b.bytes();
+  if (a.type() == UploadData::TYPE_BYTES) {
+    return a.bytes_length() == b.bytes_length() &&
+           std::equal(a.bytes_data(), a.bytes_data() + a.bytes_length(),
+                      b.bytes_data());
+  }
   if (a.type() == UploadData::TYPE_FILE) {
     return a.file_path() == b.file_path() &&
            a.file_range_offset() == b.file_range_offset() &&
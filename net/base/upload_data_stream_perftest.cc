@@ -0,0 +1,69 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/base/upload_data.h"
+#include "net/base/upload_data_stream.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+// 128MB, sent in 64KB chunks and read in the 16KB pieces HttpStreamParser
+// uses.
+const int kChunkSize = 64 * 1024;
+const int kChunks = 2048;
+const int kReadBufferSize = 16 * 1024;
+
+// Appends |kChunks| chunks of |chunk| to a chunked upload, either copying
+// them or referencing |chunk|, and reads the whole upload back.  Logs the
+// throughput in MB/s.
+void RunChunkedUpload(const char* name, bool shared) {
+  scoped_refptr<IOBuffer> chunk(new IOBuffer(kChunkSize));
+  memset(chunk->data(), 'a', kChunkSize);
+  scoped_refptr<IOBuffer> read_buf(new IOBuffer(kReadBufferSize));
+
+  PerfTimer timer;
+  scoped_refptr<UploadData> upload_data(new UploadData);
+  upload_data->set_is_chunked(true);
+  for (int i = 0; i < kChunks; ++i) {
+    bool is_last_chunk = i == kChunks - 1;
+    if (shared)
+      upload_data->AppendSharedChunk(chunk, kChunkSize, is_last_chunk);
+    else
+      upload_data->AppendChunk(chunk->data(), kChunkSize, is_last_chunk);
+  }
+
+  UploadDataStream stream(upload_data);
+  ASSERT_EQ(OK, stream.Init());
+  int64 total = 0;
+  while (!stream.IsEOF()) {
+    int rv = stream.Read(read_buf, kReadBufferSize);
+    ASSERT_LT(0, rv);
+    total += rv;
+  }
+  double seconds = timer.Elapsed().InSecondsF();
+
+  EXPECT_EQ(static_cast<int64>(kChunkSize) * kChunks, total);
+  LogPerfResult(base::StringPrintf("UploadDataStream_%s", name).c_str(),
+                total / (1024.0 * 1024.0) / seconds, "MB/s");
+}
+
+}  // namespace
+
+TEST(UploadDataStreamPerfTest, CopiedChunks) {
+  RunChunkedUpload("CopiedChunks", false);
+}
+
+TEST(UploadDataStreamPerfTest, SharedChunks) {
+  RunChunkedUpload("SharedChunks", true);
+}
+
+}  // namespace net
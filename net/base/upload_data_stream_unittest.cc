@@ -4,6 +4,7 @@
 
 #include "net/base/upload_data_stream.h"
 
+#include <string>
 #include <vector>
 
 #include "base/basictypes.h"
@@ -67,6 +68,25 @@ TEST_F(UploadDataStreamTest, ConsumeAll) {
   ASSERT_TRUE(stream->IsEOF());
 }
 
+// Shared bytes are read from the caller's buffer, which is not copied when the
+// element is added.
+TEST_F(UploadDataStreamTest, ConsumeAllSharedBytes) {
+  scoped_refptr<IOBuffer> data(new StringIOBuffer(kTestData));
+  upload_data_->AppendSharedBytes(data, kTestDataSize);
+  upload_data_->AppendBytes(kTestData, kTestDataSize);
+  EXPECT_EQ(data->data(), upload_data_->elements()->at(0).bytes_data());
+
+  scoped_ptr<UploadDataStream> stream(new UploadDataStream(upload_data_));
+  ASSERT_EQ(OK, stream->Init());
+  EXPECT_EQ(2 * kTestDataSize, stream->size());
+  scoped_refptr<IOBuffer> buf = new IOBuffer(kTestBufferSize);
+  EXPECT_EQ(static_cast<int>(2 * kTestDataSize),
+            stream->Read(buf, kTestBufferSize));
+  EXPECT_EQ(std::string(kTestData) + kTestData,
+            std::string(buf->data(), 2 * kTestDataSize));
+  EXPECT_TRUE(stream->IsEOF());
+}
+
 TEST_F(UploadDataStreamTest, FileSmallerThanLength) {
   FilePath temp_file_path;
   ASSERT_TRUE(file_util::CreateTemporaryFile(&temp_file_path));
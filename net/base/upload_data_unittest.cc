@@ -13,6 +13,7 @@
 #include "base/threading/thread_restrictions.h"
 #include "base/time.h"
 #include "googleurl/src/gurl.h"
+#include "net/base/io_buffer.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/platform_test.h"
 
@@ -96,6 +97,12 @@ TEST_F(UploadDataTest, IsInMemory_Bytes) {
   ASSERT_TRUE(upload_data_->IsInMemory());
 }
 
+TEST_F(UploadDataTest, IsInMemory_SharedBytes) {
+  scoped_refptr<IOBuffer> buf(new StringIOBuffer("123"));
+  upload_data_->AppendSharedBytes(buf, 3);
+  ASSERT_TRUE(upload_data_->IsInMemory());
+}
+
 TEST_F(UploadDataTest, IsInMemory_File) {
   upload_data_->AppendFileRange(
       FilePath(FILE_PATH_LITERAL("random_file_name.txt")),
@@ -6,6 +6,8 @@
 #define NET_HTTP_HTTP_BYTE_RANGE_H_
 #pragma once
 
+#include <string>
+
 #include "base/basictypes.h"
 #include "net/base/net_export.h"
 
@@ -20,6 +22,12 @@ class NET_EXPORT HttpByteRange {
 
   // Since this class is POD, we use constructor, assignment operator
   // and destructor provided by compiler.
+
+  // Returns the range of bytes |first_byte_position| through
+  // |last_byte_position|, inclusive.
+  static HttpByteRange Bounded(int64 first_byte_position,
+                               int64 last_byte_position);
+
   int64 first_byte_position() const { return first_byte_position_; }
   void set_first_byte_position(int64 value) { first_byte_position_ =  value; }
 
@@ -39,6 +47,11 @@ class NET_EXPORT HttpByteRange {
   // Returns true if this range is valid.
   bool IsValid() const;
 
+  // Returns the value of a Range request header asking for this range, for
+  // example "bytes=0-499", "bytes=500-" or "bytes=-500".  The range must be
+  // valid.
+  std::string GetHeaderValue() const;
+
   // A method that when given the size in bytes of a file, adjust the internal
   // |first_byte_position_| and |last_byte_position_| values according to the
   // range specified by this object. If the range specified is invalid with
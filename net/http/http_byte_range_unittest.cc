@@ -76,3 +76,19 @@ TEST(HttpByteRangeTest, SetInstanceSize) {
     }
   }
 }
+
+TEST(HttpByteRangeTest, GetHeaderValue) {
+  EXPECT_EQ("bytes=0-99", net::HttpByteRange::Bounded(0, 99).GetHeaderValue());
+  EXPECT_EQ("bytes=4294967296-4294967395",
+            net::HttpByteRange::Bounded(GG_INT64_C(4294967296),
+                                        GG_INT64_C(4294967395))
+                .GetHeaderValue());
+
+  net::HttpByteRange open_ended;
+  open_ended.set_first_byte_position(100);
+  EXPECT_EQ("bytes=100-", open_ended.GetHeaderValue());
+
+  net::HttpByteRange suffix;
+  suffix.set_suffix_length(50);
+  EXPECT_EQ("bytes=-50", suffix.GetHeaderValue());
+}
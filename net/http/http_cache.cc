@@ -71,6 +71,14 @@ HttpNetworkSession* CreateNetworkSession(
   return new HttpNetworkSession(params);
 }
 
+HttpNetworkSession* CreateNetworkSessionWithHostInfo(
+    const HttpNetworkSession::Params& params,
+    SSLHostInfoFactory* ssl_host_info_factory) {
+  HttpNetworkSession::Params session_params(params);
+  session_params.ssl_host_info_factory = ssl_host_info_factory;
+  return new HttpNetworkSession(session_params);
+}
+
 }  // namespace
 
 HttpCache::DefaultBackend::DefaultBackend(CacheType type,
@@ -332,6 +340,20 @@ HttpCache::HttpCache(HostResolver* host_resolver,
                   net_log))) {
 }
 
+HttpCache::HttpCache(const HttpNetworkSession::Params& params,
+                     BackendFactory* backend_factory)
+    : net_log_(params.net_log),
+      backend_factory_(backend_factory),
+      building_backend_(false),
+      mode_(NORMAL),
+      ssl_host_info_factory_(new SSLHostInfoFactoryAdaptor(
+          params.cert_verifier,
+          ALLOW_THIS_IN_INITIALIZER_LIST(this))),
+      network_layer_(
+          new HttpNetworkLayer(
+              CreateNetworkSessionWithHostInfo(
+                  params, ssl_host_info_factory_.get()))) {
+}
 
 HttpCache::HttpCache(HttpNetworkSession* session,
                      BackendFactory* backend_factory)
@@ -31,6 +31,7 @@
 #include "net/base/completion_callback.h"
 #include "net/base/load_states.h"
 #include "net/base/net_export.h"
+#include "net/http/http_network_session.h"
 #include "net/http/http_transaction_factory.h"
 
 class GURL;
@@ -45,7 +46,6 @@ namespace net {
 class CertVerifier;
 class HostResolver;
 class HttpAuthHandlerFactory;
-class HttpNetworkSession;
 class HttpResponseInfo;
 class HttpServerProperties;
 class IOBuffer;
@@ -132,6 +132,13 @@ class NET_EXPORT HttpCache : public HttpTransactionFactory,
             NetLog* net_log,
             BackendFactory* backend_factory);
 
+  // The disk cache is initialized lazily (by CreateTransaction) in this case.
+  // The network session is created from |params|, with the cache's own
+  // SSLHostInfoFactory. The HttpCache takes ownership of the
+  // |backend_factory|.
+  HttpCache(const HttpNetworkSession::Params& params,
+            BackendFactory* backend_factory);
+
   // The disk cache is initialized lazily (by CreateTransaction) in  this case.
   // Provide an existing HttpNetworkSession, the cache can construct a
   // network layer with a shared HttpNetworkSession in order for multiple
@@ -38,6 +38,7 @@ net::ClientSocketPoolManager* CreateSocketPoolManager(
       params.transport_security_state,
       params.ssl_host_info_factory,
       params.ssl_session_cache_shard,
+      params.ssl_session_store,
       params.proxy_service,
       params.ssl_config_service,
       pool_type);
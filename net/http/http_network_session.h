@@ -41,6 +41,7 @@ class SOCKSClientSocketPool;
 class SSLClientSocketPool;
 class SSLConfigService;
 class SSLHostInfoFactory;
+class SSLSessionStore;
 class TransportClientSocketPool;
 class TransportSecurityState;
 
@@ -58,6 +59,7 @@ class NET_EXPORT HttpNetworkSession
           transport_security_state(NULL),
           proxy_service(NULL),
           ssl_host_info_factory(NULL),
+          ssl_session_store(NULL),
           ssl_config_service(NULL),
           http_auth_handler_factory(NULL),
           network_delegate(NULL),
@@ -73,6 +75,7 @@ class NET_EXPORT HttpNetworkSession
     ProxyService* proxy_service;
     SSLHostInfoFactory* ssl_host_info_factory;
     std::string ssl_session_cache_shard;
+    SSLSessionStore* ssl_session_store;
     SSLConfigService* ssl_config_service;
     HttpAuthHandlerFactory* http_auth_handler_factory;
     NetworkDelegate* network_delegate;
@@ -74,6 +74,7 @@ class HttpProxyClientSocketPoolSpdy21Test : public TestWithHttpParam {
                          NULL /* transport_security_state */,
                          NULL /* ssl_host_info_factory */,
                          ""   /* ssl_session_cache_shard */,
+                         NULL /* ssl_session_store */,
                          &socket_factory_,
                          &transport_socket_pool_,
                          NULL,
@@ -275,7 +275,8 @@ template<>
 CapturePreconnectsSSLSocketPool::CapturePreconnectsSocketPool(
     HostResolver* host_resolver, CertVerifier* cert_verifier)
     : SSLClientSocketPool(0, 0, NULL, host_resolver, cert_verifier, NULL,
-                          NULL, NULL, "", NULL, NULL, NULL, NULL, NULL, NULL),
+                          NULL, NULL, "", NULL, NULL, NULL, NULL, NULL,
+                          NULL, NULL),
       last_num_streams_(-1) {}
 
 TEST(HttpStreamFactoryTest, PreconnectDirect) {
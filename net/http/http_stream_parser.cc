@@ -24,6 +24,9 @@ namespace {
 const size_t kMaxMergedHeaderAndBodySize = 1400;
 const size_t kRequestBodyBufferSize = 1 << 14;  // 16KB
 
+// Max length of a chunk header: 8 hex chars + CRLF.
+const int kMaxChunkHeaderSize = 10;
+
 std::string GetResponseHeaderLines(const net::HttpResponseHeaders& headers) {
   std::string raw_headers = headers.raw_headers();
   const char* null_separated_headers = raw_headers.c_str();
@@ -219,13 +222,8 @@ int HttpStreamParser::SendRequest(const std::string& request_line,
   request_body_.reset(request_body);
   if (request_body_ != NULL) {
     request_body_buf_ = new SeekableIOBuffer(kRequestBodyBufferSize);
-    if (request_body_->is_chunked()) {
+    if (request_body_->is_chunked())
       request_body_->set_chunk_callback(this);
-      // The chunk buffer is adjusted to guarantee that |request_body_buf_|
-      // is large enough to hold the encoded chunk.
-      chunk_buf_ = new IOBufferWithSize(kRequestBodyBufferSize -
-                                        kChunkHeaderFooterSize);
-    }
   }
 
   io_state_ = STATE_SENDING_HEADERS;
@@ -455,23 +453,30 @@ int HttpStreamParser::DoSendChunkedBody(int result) {
     return OK;
   }
 
-  const int consumed = request_body_->Read(chunk_buf_, chunk_buf_->size());
+  // Read the payload straight into |request_body_buf_|, leaving room in front
+  // of it for the chunk header, so the data is only copied once on its way to
+  // the socket.
+  request_body_buf_->Clear();
+  char* payload = request_body_buf_->data() + kMaxChunkHeaderSize;
+  scoped_refptr<IOBuffer> payload_buf(new WrappedIOBuffer(payload));
+  const int consumed = request_body_->Read(
+      payload_buf, kRequestBodyBufferSize - kChunkHeaderFooterSize);
   if (consumed == 0) {  // Reached the end.
     DCHECK(request_body_->IsEOF());
-    request_body_buf_->Clear();
     const int chunk_length = EncodeChunk(base::StringPiece(),
                                          request_body_buf_->data(),
                                          request_body_buf_->capacity());
     request_body_buf_->DidAppend(chunk_length);
     sent_last_chunk_ = true;
   } else if (consumed > 0) {
-    // Encode and send the buffer as 1 chunk.
-    const base::StringPiece payload(chunk_buf_->data(), consumed);
-    request_body_buf_->Clear();
-    const int chunk_length = EncodeChunk(payload,
-                                         request_body_buf_->data(),
-                                         request_body_buf_->capacity());
-    request_body_buf_->DidAppend(chunk_length);
+    // Frame the payload as 1 chunk, in place.
+    char header[kMaxChunkHeaderSize + 1];
+    const int header_length = base::snprintf(header, sizeof(header), "%X\r\n",
+                                             consumed);
+    memcpy(payload - header_length, header, header_length);
+    memcpy(payload + consumed, "\r\n", 2);
+    request_body_buf_->DidAppend(kMaxChunkHeaderSize + consumed + 2);
+    request_body_buf_->SetOffset(kMaxChunkHeaderSize - header_length);
   } else if (consumed == ERR_IO_PENDING) {
     // Nothing to send. More POST data is yet to come.
     return ERR_IO_PENDING;
@@ -25,7 +25,6 @@ struct HttpRequestInfo;
 class HttpRequestHeaders;
 class HttpResponseInfo;
 class IOBuffer;
-class IOBufferWithSize;
 class SSLCertRequestInfo;
 class SSLInfo;
 
@@ -223,10 +222,8 @@ class NET_EXPORT_PRIVATE HttpStreamParser  : public ChunkCallback {
   // Callback to be used when doing IO.
   CompletionCallback io_callback_;
 
-  // Stores an encoded chunk for chunked uploads.
-  // Note: This should perhaps be improved to not create copies of the data.
-  scoped_refptr<IOBufferWithSize> chunk_buf_;
-  // Temporary buffer to read the request body from UploadDataStream.
+  // Temporary buffer to read the request body from UploadDataStream.  For
+  // chunked uploads, each chunk is encoded in place in this buffer.
   scoped_refptr<SeekableIOBuffer> request_body_buf_;
   size_t chunk_length_without_encoding_;
   bool sent_last_chunk_;
@@ -34,6 +34,7 @@
         '../sdch/sdch.gyp:sdch',
         '../third_party/icu/icu.gyp:icui18n',
         '../third_party/icu/icu.gyp:icuuc',
+        '../third_party/bzip2/bzip2.gyp:bzip2',
         '../third_party/zlib/zlib.gyp:zlib',
         '../v8/tools/gyp/v8.gyp:v8',
         'net_resources',
@@ -57,6 +58,10 @@
         'base/bandwidth_metrics.h',
         'base/big_endian.cc',
         'base/big_endian.h',
+        'base/binary_net_log.cc',
+        'base/binary_net_log.h',
+        'base/bzip2_filter.cc',
+        'base/bzip2_filter.h',
         'base/cache_type.h',
         'base/capturing_net_log.cc',
         'base/capturing_net_log.h',
@@ -70,6 +75,8 @@
         'base/cert_status_flags.h',
         'base/cert_verifier.cc',
         'base/cert_verifier.h',
+        'base/cert_verifier_cache_file_store.cc',
+        'base/cert_verifier_cache_file_store.h',
         'base/cert_verify_proc.cc',
         'base/cert_verify_proc.h',
         'base/cert_verify_proc_mac.cc',
@@ -204,6 +211,8 @@
         'base/openssl_private_key_store_android.cc',
         'base/pem_tokenizer.cc',
         'base/pem_tokenizer.h',
+        'base/pickled_file_util.cc',
+        'base/pickled_file_util.h',
         'base/platform_mime_util.h',
         # TODO(tc): gnome-vfs? xdgmime? /etc/mime.types?
         'base/platform_mime_util_linux.cc',
@@ -216,6 +225,8 @@
         'base/registry_controlled_domain.cc',
         'base/registry_controlled_domain.h',
         'base/request_priority.h',
+        'base/sdch_dictionary_file_store.cc',
+        'base/sdch_dictionary_file_store.h',
         'base/sdch_filter.cc',
         'base/sdch_filter.h',
         'base/sdch_manager.cc',
@@ -522,6 +533,8 @@
         'http/url_security_manager_win.cc',
         'ocsp/nss_ocsp.cc',
         'ocsp/nss_ocsp.h',
+        'proxy/caching_sync_host_resolver.cc',
+        'proxy/caching_sync_host_resolver.h',
         'proxy/dhcp_proxy_script_adapter_fetcher_win.cc',
         'proxy/dhcp_proxy_script_adapter_fetcher_win.h',
         'proxy/dhcp_proxy_script_fetcher.cc',
@@ -629,6 +642,7 @@
         'socket/ssl_server_socket_nss.cc',
         'socket/ssl_server_socket_nss.h',
         'socket/ssl_server_socket_openssl.cc',
+        'socket/ssl_session_store.h',
         'socket/ssl_socket.h',
         'socket/stream_socket.cc',
         'socket/stream_socket.h',
@@ -1029,6 +1043,7 @@
       'target_name': 'net_unittests',
       'type': 'executable',
       'dependencies': [
+        'http_server',
         'net',
         'net_test_support',
         '../base/base.gyp:base',
@@ -1038,13 +1053,17 @@
         '../crypto/crypto.gyp:crypto',
         '../testing/gmock.gyp:gmock',
         '../testing/gtest.gyp:gtest',
+        '../third_party/bzip2/bzip2.gyp:bzip2',
         '../third_party/zlib/zlib.gyp:zlib',
       ],
       'sources': [
         'base/address_list_unittest.cc',
         'base/backoff_entry_unittest.cc',
         'base/big_endian_unittest.cc',
+        'base/binary_net_log_unittest.cc',
+        'base/bzip2_filter_unittest.cc',
         'base/cert_database_nss_unittest.cc',
+        'base/cert_verifier_cache_file_store_unittest.cc',
         'base/crl_set_unittest.cc',
         'base/data_url_unittest.cc',
         'base/default_server_bound_cert_store_unittest.cc',
@@ -1078,10 +1097,12 @@
         'base/network_change_notifier_linux_unittest.cc',
         'base/network_change_notifier_win_unittest.cc',
         'base/pem_tokenizer_unittest.cc',
+        'base/pickled_file_util_unittest.cc',
         'base/prioritized_dispatcher_unittest.cc',
         'base/priority_queue_unittest.cc',
         'base/registry_controlled_domain_unittest.cc',
         'base/run_all_unittests.cc',
+        'base/sdch_dictionary_file_store_unittest.cc',
         'base/sdch_filter_unittest.cc',
         'base/server_bound_cert_service_unittest.cc',
         'base/single_request_host_resolver_unittest.cc',
@@ -1182,6 +1203,7 @@
         'http/mock_sspi_library_win.h',
         'http/mock_sspi_library_win.cc',
         'http/url_security_manager_unittest.cc',
+        'proxy/caching_sync_host_resolver_unittest.cc',
         'proxy/dhcp_proxy_script_adapter_fetcher_win_unittest.cc',
         'proxy/dhcp_proxy_script_fetcher_factory_unittest.cc',
         'proxy/dhcp_proxy_script_fetcher_win_unittest.cc',
@@ -1199,6 +1221,7 @@
         'proxy/proxy_server_unittest.cc',
         'proxy/proxy_service_unittest.cc',
         'proxy/sync_host_resolver_bridge_unittest.cc',
+        'server/http_server_unittest.cc',
         'socket/buffered_write_stream_socket_unittest.cc',
         'socket/client_socket_pool_base_unittest.cc',
         'socket/deterministic_socket_data_unittest.cc',
@@ -1448,11 +1471,21 @@
         '../base/base.gyp:test_support_perf',
         '../build/temp_gyp/googleurl.gyp:googleurl',
         '../testing/gtest.gyp:gtest',
+        '../third_party/bzip2/bzip2.gyp:bzip2',
+        '../third_party/zlib/zlib.gyp:zlib',
       ],
       'sources': [
+        'base/filter_perftest.cc',
+        'base/mock_filter_context.cc',
+        'base/mock_filter_context.h',
+        'base/sdch_filter_perftest.cc',
+        'base/transport_security_state_perftest.cc',
+        'base/upload_data_stream_perftest.cc',
         'cookies/cookie_monster_perftest.cc',
         'disk_cache/disk_cache_perftest.cc',
         'proxy/proxy_resolver_perftest.cc',
+        'socket/tcp_socket_echo_perftest.cc',
+        'udp/udp_socket_perftest.cc',
       ],
       'conditions': [
         # This is needed to trigger the dll copy step on windows.
@@ -1713,6 +1746,17 @@
         'tools/crl_set_dump/crl_set_dump.cc',
       ],
     },
+    {
+      'target_name': 'net_log_converter',
+      'type': 'executable',
+      'dependencies': [
+        'net',
+        '../base/base.gyp:base',
+      ],
+      'sources': [
+        'tools/net_log_converter/net_log_converter.cc',
+      ],
+    },
     {
       'target_name': 'ssl_false_start_blacklist_process',
       'type': 'executable',
@@ -1805,6 +1849,63 @@
              'tools/flip_server/string_piece_utils.h',
            ],
          },
+         {
+           'target_name': 'balsa_frame_benchmark',
+           'type': 'executable',
+           'dependencies': [
+             '../base/base.gyp:base',
+           ],
+           'sources': [
+             'tools/flip_server/balsa_enums.h',
+             'tools/flip_server/balsa_frame.cc',
+             'tools/flip_server/balsa_frame.h',
+             'tools/flip_server/balsa_frame_benchmark.cc',
+             'tools/flip_server/balsa_headers.cc',
+             'tools/flip_server/balsa_headers.h',
+             'tools/flip_server/balsa_visitor_interface.h',
+             'tools/flip_server/buffer_interface.h',
+             'tools/flip_server/simple_buffer.cc',
+             'tools/flip_server/simple_buffer.h',
+             'tools/flip_server/split.cc',
+             'tools/flip_server/split.h',
+             'tools/flip_server/string_piece_utils.h',
+           ],
+         },
+         {
+           'target_name': 'http_load_client',
+           'type': 'static_library',
+           'dependencies': [
+             '../base/base.gyp:base',
+           ],
+           'sources': [
+             'tools/http_load_client/http_load_client.cc',
+             'tools/http_load_client/http_load_client.h',
+           ],
+         },
+         {
+           'target_name': 'http_server_load_test',
+           'type': 'executable',
+           'dependencies': [
+             '../base/base.gyp:base',
+             'http_load_client',
+             'http_server',
+             'net',
+           ],
+           'sources': [
+             'tools/http_server_load_test/http_server_load_test.cc',
+           ],
+         },
+         {
+           'target_name': 'flip_load_generator',
+           'type': 'executable',
+           'dependencies': [
+             '../base/base.gyp:base',
+             'http_load_client',
+           ],
+           'sources': [
+             'tools/flip_server/flip_load_generator.cc',
+           ],
+         },
          {
            'target_name': 'curvecp',
            'type': 'static_library',
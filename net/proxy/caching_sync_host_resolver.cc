@@ -0,0 +1,53 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/proxy/caching_sync_host_resolver.h"
+
+#include "net/base/host_cache.h"
+#include "net/base/net_errors.h"
+
+namespace net {
+
+CachingSyncHostResolver::CachingSyncHostResolver(
+    SyncHostResolver* host_resolver,
+    size_t max_entries,
+    base::TimeDelta ttl)
+    : host_resolver_(host_resolver),
+      max_entries_(max_entries),
+      ttl_(ttl) {
+  DCHECK(host_resolver);
+}
+
+CachingSyncHostResolver::~CachingSyncHostResolver() {}
+
+int CachingSyncHostResolver::Resolve(const HostResolver::RequestInfo& info,
+                                     AddressList* addresses,
+                                     const BoundNetLog& net_log) {
+  if (!cache_.get())
+    cache_.reset(new HostCache(max_entries_));
+
+  HostCache::Key key(info.hostname(),
+                     info.address_family(),
+                     info.host_resolver_flags());
+  base::TimeTicks now = base::TimeTicks::Now();
+  const HostCache::Entry* entry = cache_->Lookup(key, now);
+  if (entry) {
+    if (entry->error == OK)
+      *addresses = entry->addrlist;
+    return entry->error;
+  }
+
+  int rv = host_resolver_->Resolve(info, addresses, net_log);
+
+  // A resolve that was aborted by Shutdown() says nothing about the host.
+  if (rv != ERR_ABORTED)
+    cache_->Set(key, rv, rv == OK ? *addresses : AddressList(), now, ttl_);
+  return rv;
+}
+
+void CachingSyncHostResolver::Shutdown() {
+  host_resolver_->Shutdown();
+}
+
+}  // namespace net
@@ -0,0 +1,54 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_PROXY_CACHING_SYNC_HOST_RESOLVER_H_
+#define NET_PROXY_CACHING_SYNC_HOST_RESOLVER_H_
+#pragma once
+
+#include "base/compiler_specific.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/time.h"
+#include "net/proxy/sync_host_resolver.h"
+
+namespace net {
+
+class HostCache;
+
+// Wraps a SyncHostResolver and memoizes its results, including failures, for
+// |ttl|. This lets a PAC script that calls dnsResolve() on the same hosts for
+// every URL skip the round trip to the host resolver's thread.
+//
+// Resolve() must always be called on the same thread (the PAC thread), but
+// that thread need not be the one that created this object. Shutdown() may be
+// called from any thread, as it is only forwarded to the wrapped resolver.
+class NET_EXPORT_PRIVATE CachingSyncHostResolver : public SyncHostResolver {
+ public:
+  // Takes ownership of |host_resolver|.
+  CachingSyncHostResolver(SyncHostResolver* host_resolver,
+                          size_t max_entries,
+                          base::TimeDelta ttl);
+
+  virtual ~CachingSyncHostResolver();
+
+  // SyncHostResolver methods:
+  virtual int Resolve(const HostResolver::RequestInfo& info,
+                      AddressList* addresses,
+                      const BoundNetLog& net_log) OVERRIDE;
+  virtual void Shutdown() OVERRIDE;
+
+ private:
+  scoped_ptr<SyncHostResolver> host_resolver_;
+  const size_t max_entries_;
+  const base::TimeDelta ttl_;
+
+  // Created lazily by the first Resolve(), so that it is bound to the thread
+  // that runs the PAC script.
+  scoped_ptr<HostCache> cache_;
+
+  DISALLOW_COPY_AND_ASSIGN(CachingSyncHostResolver);
+};
+
+}  // namespace net
+
+#endif  // NET_PROXY_CACHING_SYNC_HOST_RESOLVER_H_
@@ -0,0 +1,78 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/proxy/caching_sync_host_resolver.h"
+
+#include "base/compiler_specific.h"
+#include "net/base/address_list.h"
+#include "net/base/net_errors.h"
+#include "net/base/net_log.h"
+#include "net/base/net_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+// Resolves "ok.com" to 1.2.3.4 and fails everything else, counting calls.
+class CountingSyncHostResolver : public SyncHostResolver {
+ public:
+  explicit CountingSyncHostResolver(int* num_resolves)
+      : num_resolves_(num_resolves) {
+  }
+
+  virtual int Resolve(const HostResolver::RequestInfo& info,
+                      AddressList* addresses,
+                      const BoundNetLog& net_log) OVERRIDE {
+    ++*num_resolves_;
+    if (info.hostname() != "ok.com")
+      return ERR_NAME_NOT_RESOLVED;
+    IPAddressNumber ip;
+    EXPECT_TRUE(ParseIPLiteralToNumber("1.2.3.4", &ip));
+    *addresses = AddressList::CreateFromIPAddress(ip, info.port());
+    return OK;
+  }
+
+  virtual void Shutdown() OVERRIDE {}
+
+ private:
+  int* num_resolves_;
+};
+
+TEST(CachingSyncHostResolverTest, MemoizesResults) {
+  int num_resolves = 0;
+  CachingSyncHostResolver resolver(
+      new CountingSyncHostResolver(&num_resolves), 10,
+      base::TimeDelta::FromMinutes(1));
+
+  HostResolver::RequestInfo ok_info(HostPortPair("ok.com", 80));
+  HostResolver::RequestInfo bad_info(HostPortPair("bad.com", 80));
+
+  for (int i = 0; i < 3; ++i) {
+    AddressList addresses;
+    EXPECT_EQ(OK, resolver.Resolve(ok_info, &addresses, BoundNetLog()));
+    EXPECT_EQ("1.2.3.4", NetAddressToString(addresses.head()));
+    EXPECT_EQ(ERR_NAME_NOT_RESOLVED,
+              resolver.Resolve(bad_info, &addresses, BoundNetLog()));
+  }
+
+  // Each host only reached the wrapped resolver once.
+  EXPECT_EQ(2, num_resolves);
+}
+
+TEST(CachingSyncHostResolverTest, ZeroTTL) {
+  int num_resolves = 0;
+  CachingSyncHostResolver resolver(
+      new CountingSyncHostResolver(&num_resolves), 10, base::TimeDelta());
+
+  HostResolver::RequestInfo info(HostPortPair("ok.com", 80));
+  AddressList addresses;
+  EXPECT_EQ(OK, resolver.Resolve(info, &addresses, BoundNetLog()));
+  EXPECT_EQ(OK, resolver.Resolve(info, &addresses, BoundNetLog()));
+  EXPECT_EQ(2, num_resolves);
+}
+
+}  // namespace
+
+}  // namespace net
@@ -22,6 +22,19 @@ namespace net {
 
 namespace {
 
+// Bounds on the optional result cache. Results expire so that scripts which
+// depend on DNS or on the time of day are still re-evaluated periodically.
+const size_t kMaxCachedResults = 500;
+const int kCachedResultTTLSeconds = 60;
+
+// Returns the key used by the result cache for |url|, or an empty string if
+// results for |url| should not be cached.
+std::string GetResultCacheKey(const GURL& url) {
+  if (!url.is_valid() || !url.has_host())
+    return std::string();
+  return url.GetOrigin().spec();
+}
+
 class PurgeMemoryTask : public base::RefCountedThreadSafe<PurgeMemoryTask> {
  public:
   explicit PurgeMemoryTask(ProxyResolver* resolver) : resolver_(resolver) {}
@@ -68,6 +81,8 @@ class MultiThreadedProxyResolver::Executor
 
   int thread_number() const { return thread_number_; }
 
+  MultiThreadedProxyResolver* coordinator() { return coordinator_; }
+
  private:
   friend class base::RefCountedThreadSafe<Executor>;
   ~Executor();
@@ -273,6 +288,7 @@ class MultiThreadedProxyResolver::GetProxyForURLJob
     if (!was_cancelled()) {
       if (result_code >= OK) {  // Note: unit-tests use values > 0.
         results_->Use(results_buf_);
+        executor()->coordinator()->OnResultAvailable(url_, results_buf_);
       }
       RunUserCallback(result_code);
     }
@@ -404,6 +420,16 @@ int MultiThreadedProxyResolver::GetProxyForURL(
   DCHECK(current_script_data_.get())
       << "Resolver is un-initialized. Must call SetPacScript() first!";
 
+  if (result_cache_.get()) {
+    const std::string* pac_string = result_cache_->Get(
+        GetResultCacheKey(url), base::TimeTicks::Now());
+    if (pac_string) {
+      net_log.AddEvent(NetLog::TYPE_PROXY_RESOLVER_RESULT_CACHE_HIT, NULL);
+      results->UsePacString(*pac_string);
+      return OK;
+    }
+  }
+
   scoped_refptr<GetProxyForURLJob> job(
       new GetProxyForURLJob(url, results, callback, net_log));
 
@@ -482,12 +508,16 @@ void MultiThreadedProxyResolver::CancelSetPacScript() {
   // Defensively clear some data which shouldn't be getting used
   // anymore.
   current_script_data_ = NULL;
+  if (result_cache_.get())
+    result_cache_->Clear();
 
   ReleaseAllExecutors();
 }
 
 void MultiThreadedProxyResolver::PurgeMemory() {
   DCHECK(CalledOnValidThread());
+  if (result_cache_.get())
+    result_cache_->Clear();
   for (ExecutorList::iterator it = executors_.begin();
        it != executors_.end(); ++it) {
     Executor* executor = *it;
@@ -504,6 +534,10 @@ int MultiThreadedProxyResolver::SetPacScript(
   // Save the script details, so we can provision new executors later.
   current_script_data_ = script_data;
 
+  // Results from the previous script no longer apply.
+  if (result_cache_.get())
+    result_cache_->Clear();
+
   // The user should not have any outstanding requests when they call
   // SetPacScript().
   CheckNoOutstandingUserRequests();
@@ -518,6 +552,12 @@ int MultiThreadedProxyResolver::SetPacScript(
   return ERR_IO_PENDING;
 }
 
+void MultiThreadedProxyResolver::EnableResultCache() {
+  DCHECK(CalledOnValidThread());
+  if (!result_cache_.get())
+    result_cache_.reset(new ResultCache(kMaxCachedResults));
+}
+
 void MultiThreadedProxyResolver::CheckNoOutstandingUserRequests() const {
   DCHECK(CalledOnValidThread());
   CHECK_EQ(0u, pending_jobs_.size());
@@ -583,4 +623,17 @@ void MultiThreadedProxyResolver::OnExecutorReady(Executor* executor) {
   executor->StartJob(job);
 }
 
+void MultiThreadedProxyResolver::OnResultAvailable(const GURL& url,
+                                                   const ProxyInfo& results) {
+  DCHECK(CalledOnValidThread());
+  if (!result_cache_.get())
+    return;
+
+  std::string key = GetResultCacheKey(url);
+  if (key.empty())
+    return;
+  result_cache_->Put(key, results.ToPacString(), base::TimeTicks::Now(),
+                     base::TimeDelta::FromSeconds(kCachedResultTTLSeconds));
+}
+
 }  // namespace net
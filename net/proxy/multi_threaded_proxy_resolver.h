@@ -7,12 +7,14 @@
 #pragma once
 
 #include <deque>
+#include <string>
 #include <vector>
 
 #include "base/basictypes.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/threading/non_thread_safe.h"
+#include "net/base/expiring_cache.h"
 #include "net/base/net_export.h"
 #include "net/proxy/proxy_resolver.h"
 
@@ -72,6 +74,10 @@ class ProxyResolverFactory {
 //     a global counter and using that to make a decision. In the
 //     multi-threaded model, each thread may have a different value for this
 //     counter, so it won't globally be seen as monotonically increasing!
+//
+// Optionally (see EnableResultCache()), results can be cached per origin, so
+// that only the first URL for a given scheme, host and port within the cache
+// TTL has to run the script.
 class NET_EXPORT_PRIVATE MultiThreadedProxyResolver
     : public ProxyResolver,
       NON_EXPORTED_BASE(public base::NonThreadSafe) {
@@ -107,6 +113,14 @@ class NET_EXPORT_PRIVATE MultiThreadedProxyResolver
       const scoped_refptr<ProxyResolverScriptData>& script_data,
       const CompletionCallback& callback) OVERRIDE;
 
+  // Starts caching successful results, keyed on the scheme, host and port of
+  // the URL. Subsequent requests for the same origin complete synchronously
+  // until the entry expires or the PAC script is set again.
+  //
+  // This is only correct for PAC scripts whose FindProxyForURL() does not
+  // look at the URL's path or query, so it must be explicitly opted into.
+  void EnableResultCache();
+
  private:
   class Executor;
   class Job;
@@ -116,6 +130,8 @@ class NET_EXPORT_PRIVATE MultiThreadedProxyResolver
   // TODO(eroman): Make this priority queue.
   typedef std::deque<scoped_refptr<Job> > PendingJobsQueue;
   typedef std::vector<scoped_refptr<Executor> > ExecutorList;
+  // Maps the origin of a URL to the PAC string that the script returned.
+  typedef ExpiringCache<std::string, std::string> ResultCache;
 
   // Asserts that there are no outstanding user-initiated jobs on any of the
   // worker threads.
@@ -134,11 +150,17 @@ class NET_EXPORT_PRIVATE MultiThreadedProxyResolver
   // Starts the next job from |pending_jobs_| if possible.
   void OnExecutorReady(Executor* executor);
 
+  // Called by GetProxyForURLJob on the origin thread when |url| resolved
+  // successfully to |results|.
+  void OnResultAvailable(const GURL& url, const ProxyInfo& results);
+
   const scoped_ptr<ProxyResolverFactory> resolver_factory_;
   const size_t max_num_threads_;
   PendingJobsQueue pending_jobs_;
   ExecutorList executors_;
   scoped_refptr<ProxyResolverScriptData> current_script_data_;
+  // NULL unless EnableResultCache() was called.
+  scoped_ptr<ResultCache> result_cache_;
 };
 
 }  // namespace net
@@ -793,6 +793,76 @@ TEST(MultiThreadedProxyResolverTest, OneThreadBlocked) {
   EXPECT_EQ(3, factory->resolvers()[1]->request_count());
 }
 
+// Tests that with the result cache enabled, repeated requests for an origin are
+// answered synchronously, and that setting a new script drops the results.
+TEST(MultiThreadedProxyResolverTest, ResultCache) {
+  const size_t kNumThreads = 1u;
+  scoped_ptr<MockProxyResolver> mock(new MockProxyResolver);
+  MultiThreadedProxyResolver resolver(
+      new ForwardingProxyResolverFactory(mock.get()), kNumThreads);
+  resolver.EnableResultCache();
+
+  TestCompletionCallback set_script_callback;
+  int rv = resolver.SetPacScript(
+      ProxyResolverScriptData::FromUTF8("pac script bytes"),
+      set_script_callback.callback());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(OK, set_script_callback.WaitForResult());
+
+  // The first request for the origin runs the script.
+  TestCompletionCallback callback0;
+  ProxyInfo results0;
+  rv = resolver.GetProxyForURL(GURL("http://request0/a"), &results0,
+                               callback0.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(0, callback0.WaitForResult());
+  EXPECT_EQ("PROXY request0:80", results0.ToPacString());
+
+  // Other paths on the same origin are served from the cache.
+  TestCompletionCallback callback1;
+  CapturingBoundNetLog log1(CapturingNetLog::kUnbounded);
+  ProxyInfo results1;
+  rv = resolver.GetProxyForURL(GURL("http://request0/b?c"), &results1,
+                               callback1.callback(), NULL, log1.bound());
+  EXPECT_EQ(OK, rv);
+  EXPECT_EQ("PROXY request0:80", results1.ToPacString());
+  net::CapturingNetLog::EntryList entries1;
+  log1.GetEntries(&entries1);
+  ASSERT_EQ(1u, entries1.size());
+  EXPECT_EQ(NetLog::TYPE_PROXY_RESOLVER_RESULT_CACHE_HIT, entries1[0].type);
+
+  // A different scheme or port is a different origin.
+  TestCompletionCallback callback2;
+  ProxyInfo results2;
+  rv = resolver.GetProxyForURL(GURL("https://request0/a"), &results2,
+                               callback2.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(1, callback2.WaitForResult());
+
+  TestCompletionCallback callback3;
+  ProxyInfo results3;
+  rv = resolver.GetProxyForURL(GURL("http://request0:8080/a"), &results3,
+                               callback3.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(2, callback3.WaitForResult());
+  EXPECT_EQ(3, mock->request_count());
+
+  // Setting the script again empties the cache.
+  rv = resolver.SetPacScript(
+      ProxyResolverScriptData::FromUTF8("new pac script bytes"),
+      set_script_callback.callback());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(OK, set_script_callback.WaitForResult());
+
+  TestCompletionCallback callback4;
+  ProxyInfo results4;
+  rv = resolver.GetProxyForURL(GURL("http://request0/a"), &results4,
+                               callback4.callback(), NULL, BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+  EXPECT_EQ(3, callback4.WaitForResult());
+  EXPECT_EQ(4, mock->request_count());
+}
+
 }  // namespace
 
 }  // namespace net
@@ -5,11 +5,15 @@
 #include "base/base_paths.h"
 #include "base/compiler_specific.h"
 #include "base/file_util.h"
+#include "base/message_loop.h"
 #include "base/path_service.h"
 #include "base/perftimer.h"
 #include "base/string_util.h"
 #include "net/base/mock_host_resolver.h"
 #include "net/base/net_errors.h"
+#include "net/base/test_completion_callback.h"
+#include "net/proxy/caching_sync_host_resolver.h"
+#include "net/proxy/multi_threaded_proxy_resolver.h"
 #include "net/proxy/proxy_info.h"
 #include "net/proxy/proxy_resolver_js_bindings.h"
 #include "net/proxy/proxy_resolver_v8.h"
@@ -46,8 +50,11 @@ struct PacQuery {
 // Entry listing which PAC scripts to load, and which URLs to try resolving.
 // |queries| should be terminated by {NULL, NULL}. A sentinel is used
 // rather than a length, to simplify using initializer lists.
+// |depends_only_on_host| is true if the script's result for a URL only
+// depends on its host, making it safe to run with the result cache enabled.
 struct PacPerfTest {
   const char* pac_name;
+  bool depends_only_on_host;
   PacQuery queries[100];
 
   // Returns the actual number of entries in |queries| (assumes NULL sentinel).
@@ -60,6 +67,7 @@ static PacPerfTest kPerfTests[] = {
   // regular expression oriented, and has no dependencies on the current
   // IP address, or DNS resolving of hosts.
   { "no-ads.pac",
+    false,
     { // queries:
       {"http://www.google.com", "DIRECT"},
       {"http://www.imdb.com/photos/cmsicons/x", "PROXY 0.0.0.0:3421"},
@@ -75,6 +83,31 @@ static PacPerfTest kPerfTests[] = {
       {NULL, NULL}
     },
   },
+  // This test uses a long list of host rules, and falls back to DNS (through
+  // isInNet()) for hosts that match none of them, like many corporate PAC
+  // scripts do.
+  { "host-rules.pac",
+    true,
+    { // queries:
+      {"http://intranet", "DIRECT"},
+      {"http://wiki.site3.internal.example.com/a", "DIRECT"},
+      {"http://wiki.site3.internal.example.com/b", "DIRECT"},
+      {"http://build.site42.internal.example.com/", "DIRECT"},
+      {"https://www.partner7.example.net/x",
+       "PROXY proxy.corp.example.com:8080"},
+      {"https://www.partner7.example.net/y",
+       "PROXY proxy.corp.example.com:8080"},
+      {"http://www.google.com/search?q=1", "PROXY proxy.corp.example.com:8080"},
+      {"http://www.google.com/search?q=2", "PROXY proxy.corp.example.com:8080"},
+      {"http://www.foobar.com/",
+       "PROXY proxy.corp.example.com:8080;DIRECT"},
+      {"http://www.foobar.com/index.html",
+       "PROXY proxy.corp.example.com:8080;DIRECT"},
+      {"http://www.testurl1.com/index.html",
+       "PROXY proxy.corp.example.com:8080;DIRECT"},
+      {NULL, NULL}
+    },
+  },
 };
 
 int PacPerfTest::NumQueries() const {
@@ -89,15 +122,42 @@ int PacPerfTest::NumQueries() const {
 // The number of URLs to resolve when testing a PAC script.
 const int kNumIterations = 500;
 
+// Creates ProxyResolverV8s for MultiThreadedProxyResolver, optionally with
+// memoized DNS lookups.
+class PerfProxyResolverFactoryForV8 : public net::ProxyResolverFactory {
+ public:
+  explicit PerfProxyResolverFactoryForV8(bool cache_dns_results)
+      : net::ProxyResolverFactory(true /*expects_pac_bytes*/),
+        cache_dns_results_(cache_dns_results) {
+  }
+
+  virtual net::ProxyResolver* CreateProxyResolver() OVERRIDE {
+    net::SyncHostResolver* host_resolver = new MockSyncHostResolver;
+    if (cache_dns_results_) {
+      host_resolver = new net::CachingSyncHostResolver(
+          host_resolver, 100, base::TimeDelta::FromMinutes(1));
+    }
+    return new net::ProxyResolverV8(
+        net::ProxyResolverJSBindings::CreateDefault(host_resolver, NULL, NULL));
+  }
+
+ private:
+  const bool cache_dns_results_;
+};
+
 // Helper class to run through all the performance tests using the specified
 // proxy resolver implementation.
 class PacPerfSuiteRunner {
  public:
-  // |resolver_name| is the label used when logging the results.
+  // |resolver_name| is the label used when logging the results. If
+  // |only_host_dependent_scripts| is true, scripts whose results depend on
+  // more than the host are skipped.
   PacPerfSuiteRunner(net::ProxyResolver* resolver,
-                     const std::string& resolver_name)
+                     const std::string& resolver_name,
+                     bool only_host_dependent_scripts)
       : resolver_(resolver),
         resolver_name_(resolver_name),
+        only_host_dependent_scripts_(only_host_dependent_scripts),
         test_server_(
             net::TestServer::TYPE_HTTP,
             net::TestServer::kLocalhost,
@@ -108,6 +168,8 @@ class PacPerfSuiteRunner {
     ASSERT_TRUE(test_server_.Start());
     for (size_t i = 0; i < arraysize(kPerfTests); ++i) {
       const PacPerfTest& test_data = kPerfTests[i];
+      if (only_host_dependent_scripts_ && !test_data.depends_only_on_host)
+        continue;
       RunTest(test_data.pac_name,
               test_data.queries,
               test_data.NumQueries());
@@ -121,10 +183,7 @@ class PacPerfSuiteRunner {
     if (!resolver_->expects_pac_bytes()) {
       GURL pac_url =
           test_server_.GetURL(std::string("files/") + script_name);
-      int rv = resolver_->SetPacScript(
-          net::ProxyResolverScriptData::FromURL(pac_url),
-          net::CompletionCallback());
-      EXPECT_EQ(net::OK, rv);
+      SetPacScript(net::ProxyResolverScriptData::FromURL(pac_url));
     } else {
       LoadPacScriptIntoResolver(script_name);
     }
@@ -134,15 +193,14 @@ class PacPerfSuiteRunner {
     // the PAC script.
     {
       net::ProxyInfo proxy_info;
-      int result = resolver_->GetProxyForURL(
-          GURL("http://www.warmup.com"), &proxy_info, net::CompletionCallback(),
-          NULL, net::BoundNetLog());
+      int result = Resolve(GURL("http://www.warmup.com"), &proxy_info);
       ASSERT_EQ(net::OK, result);
     }
 
     // Start the perf timer.
     std::string perf_test_name = resolver_name_ + "_" + script_name;
     PerfTimeLogger timer(perf_test_name.c_str());
+    base::TimeTicks start_time = base::TimeTicks::Now();
 
     for (int i = 0; i < kNumIterations; ++i) {
       // Round-robin between URLs to resolve.
@@ -150,9 +208,7 @@ class PacPerfSuiteRunner {
 
       // Resolve.
       net::ProxyInfo proxy_info;
-      int result = resolver_->GetProxyForURL(
-          GURL(query.query_url), &proxy_info, net::CompletionCallback(), NULL,
-          net::BoundNetLog());
+      int result = Resolve(GURL(query.query_url), &proxy_info);
 
       // Check that the result was correct. Note that ToPacString() and
       // ASSERT_EQ() are fast, so they won't skew the results.
@@ -160,8 +216,27 @@ class PacPerfSuiteRunner {
       ASSERT_EQ(query.expected_result, proxy_info.ToPacString());
     }
 
-    // Print how long the test ran for.
+    // Print how long the test ran for, and the average latency per URL.
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start_time;
     timer.Done();
+    double per_url_us =
+        elapsed.InMicroseconds() / static_cast<double>(kNumIterations);
+    LogPerfResult((perf_test_name + "_per_url").c_str(), per_url_us, "us");
+  }
+
+  // Resolves |url|, waiting for the result if |resolver_| is asynchronous.
+  int Resolve(const GURL& url, net::ProxyInfo* proxy_info) {
+    net::TestCompletionCallback callback;
+    int rv = resolver_->GetProxyForURL(url, proxy_info, callback.callback(),
+                                       NULL, net::BoundNetLog());
+    return callback.GetResult(rv);
+  }
+
+  void SetPacScript(
+      const scoped_refptr<net::ProxyResolverScriptData>& script_data) {
+    net::TestCompletionCallback callback;
+    int rv = resolver_->SetPacScript(script_data, callback.callback());
+    EXPECT_EQ(net::OK, callback.GetResult(rv));
   }
 
   // Read the PAC script from disk and initialize the proxy resolver with it.
@@ -182,27 +257,25 @@ class PacPerfSuiteRunner {
     ASSERT_TRUE(ok);
 
     // Load the PAC script into the ProxyResolver.
-    int rv = resolver_->SetPacScript(
-        net::ProxyResolverScriptData::FromUTF8(file_contents),
-        net::CompletionCallback());
-    EXPECT_EQ(net::OK, rv);
+    SetPacScript(net::ProxyResolverScriptData::FromUTF8(file_contents));
   }
 
   net::ProxyResolver* resolver_;
   std::string resolver_name_;
+  bool only_host_dependent_scripts_;
   net::TestServer test_server_;
 };
 
 #if defined(OS_WIN)
 TEST(ProxyResolverPerfTest, ProxyResolverWinHttp) {
   net::ProxyResolverWinHttp resolver;
-  PacPerfSuiteRunner runner(&resolver, "ProxyResolverWinHttp");
+  PacPerfSuiteRunner runner(&resolver, "ProxyResolverWinHttp", false);
   runner.RunAllTests();
 }
 #elif defined(OS_MACOSX)
 TEST(ProxyResolverPerfTest, ProxyResolverMac) {
   net::ProxyResolverMac resolver;
-  PacPerfSuiteRunner runner(&resolver, "ProxyResolverMac");
+  PacPerfSuiteRunner runner(&resolver, "ProxyResolverMac", false);
   runner.RunAllTests();
 }
 #endif
@@ -213,7 +286,26 @@ TEST(ProxyResolverPerfTest, ProxyResolverV8) {
           new MockSyncHostResolver, NULL, NULL);
 
   net::ProxyResolverV8 resolver(js_bindings);
-  PacPerfSuiteRunner runner(&resolver, "ProxyResolverV8");
+  PacPerfSuiteRunner runner(&resolver, "ProxyResolverV8", false);
+  runner.RunAllTests();
+}
+
+TEST(ProxyResolverPerfTest, MultiThreadedProxyResolverV8) {
+  MessageLoop message_loop;
+  net::MultiThreadedProxyResolver resolver(
+      new PerfProxyResolverFactoryForV8(false), 1);
+  PacPerfSuiteRunner runner(&resolver, "MultiThreadedProxyResolverV8", false);
+  runner.RunAllTests();
+}
+
+// Same as above, with the result cache and the memoized DNS lookups enabled.
+TEST(ProxyResolverPerfTest, MultiThreadedProxyResolverV8Cached) {
+  MessageLoop message_loop;
+  net::MultiThreadedProxyResolver resolver(
+      new PerfProxyResolverFactoryForV8(true), 1);
+  resolver.EnableResultCache();
+  PacPerfSuiteRunner runner(
+      &resolver, "MultiThreadedProxyResolverV8Cached", true);
   runner.RunAllTests();
 }
 
@@ -20,6 +20,7 @@
 #include "net/base/net_errors.h"
 #include "net/base/net_log.h"
 #include "net/base/net_util.h"
+#include "net/proxy/caching_sync_host_resolver.h"
 #include "net/proxy/dhcp_proxy_script_fetcher.h"
 #include "net/proxy/multi_threaded_proxy_resolver.h"
 #include "net/proxy/network_delegate_error_observer.h"
@@ -52,6 +53,13 @@ namespace {
 const size_t kMaxNumNetLogEntries = 100;
 const size_t kDefaultNumPacThreads = 4;
 
+// Bounds on the DNS results memoized by each PAC thread when PAC result
+// caching is enabled. The host resolver's own cache is flushed on network
+// changes; these entries go away with the PAC threads, which are recreated
+// whenever the script is (re)applied.
+const size_t kMaxCachedPacDnsResults = 100;
+const int kCachedPacDnsResultTTLSeconds = 60;
+
 // When the IP address changes we don't immediately re-run proxy auto-config.
 // Instead, we  wait for |kDelayAfterNetworkChangesMs| before
 // attempting to re-valuate proxy auto-config.
@@ -261,24 +269,33 @@ class ProxyResolverFactoryForV8 : public ProxyResolverFactory {
   // valid for the duration of our lifetime.
   // |async_host_resolver| will only be operated on |io_loop|.
   // TODO(willchan): remove io_loop and replace it with origin_loop.
+  // If |cache_dns_results| is true, each PAC thread memoizes the results of
+  // its DNS lookups for a short while.
   ProxyResolverFactoryForV8(HostResolver* async_host_resolver,
                             MessageLoop* io_loop,
                             base::MessageLoopProxy* origin_loop,
                             NetLog* net_log,
-                            NetworkDelegate* network_delegate)
+                            NetworkDelegate* network_delegate,
+                            bool cache_dns_results)
       : ProxyResolverFactory(true /*expects_pac_bytes*/),
         async_host_resolver_(async_host_resolver),
         io_loop_(io_loop),
         origin_loop_(origin_loop),
         net_log_(net_log),
-        network_delegate_(network_delegate) {
+        network_delegate_(network_delegate),
+        cache_dns_results_(cache_dns_results) {
   }
 
   virtual ProxyResolver* CreateProxyResolver() OVERRIDE {
     // Create a synchronous host resolver wrapper that operates
     // |async_host_resolver_| on |io_loop_|.
-    SyncHostResolverBridge* sync_host_resolver =
+    SyncHostResolver* sync_host_resolver =
         new SyncHostResolverBridge(async_host_resolver_, io_loop_);
+    if (cache_dns_results_) {
+      sync_host_resolver = new CachingSyncHostResolver(
+          sync_host_resolver, kMaxCachedPacDnsResults,
+          base::TimeDelta::FromSeconds(kCachedPacDnsResultTTLSeconds));
+    }
 
     NetworkDelegateErrorObserver* error_observer =
         new NetworkDelegateErrorObserver(
@@ -300,6 +317,7 @@ class ProxyResolverFactoryForV8 : public ProxyResolverFactory {
   scoped_refptr<base::MessageLoopProxy> origin_loop_;
   NetLog* net_log_;
   NetworkDelegate* network_delegate_;
+  const bool cache_dns_results_;
 };
 
 // Creates ProxyResolvers using a platform-specific implementation.
@@ -913,6 +931,7 @@ ProxyService::ProxyService(ProxyConfigService* config_service,
 ProxyService* ProxyService::CreateUsingV8ProxyResolver(
     ProxyConfigService* proxy_config_service,
     size_t num_pac_threads,
+    bool cache_pac_results,
     ProxyScriptFetcher* proxy_script_fetcher,
     DhcpProxyScriptFetcher* dhcp_proxy_script_fetcher,
     HostResolver* host_resolver,
@@ -932,10 +951,13 @@ ProxyService* ProxyService::CreateUsingV8ProxyResolver(
           MessageLoop::current(),
           base::MessageLoopProxy::current(),
           net_log,
-          network_delegate);
+          network_delegate,
+          cache_pac_results);
 
-  ProxyResolver* proxy_resolver =
+  MultiThreadedProxyResolver* proxy_resolver =
       new MultiThreadedProxyResolver(sync_resolver_factory, num_pac_threads);
+  if (cache_pac_results)
+    proxy_resolver->EnableResultCache();
 
   ProxyService* proxy_service =
       new ProxyService(proxy_config_service, proxy_resolver, net_log);
@@ -4,6 +4,12 @@
 
 #include "net/server/http_connection.h"
 
+#include <algorithm>
+
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "base/string_number_conversions.h"
 #include "base/string_util.h"
 #include "base/stringprintf.h"
 #include "net/base/listen_socket.h"
@@ -12,17 +18,31 @@
 
 namespace net {
 
+namespace {
+
+// Writes at least this large bypass |pending_output_| and are sent from the
+// caller's buffer, after flushing whatever was batched before them.
+const int kMaxBatchedWriteSize = 16 * 1024;
+
+// ListenSocket takes int lengths, so larger files go out in pieces.
+const int64 kMaxFileChunkSize = kint32max;
+
+}  // namespace
+
 int HttpConnection::last_id_ = 0;
 
 void HttpConnection::Send(const std::string& data) {
-  if (!socket_)
-    return;
-  socket_->Send(data);
+  Send(data.data(), static_cast<int>(data.length()));
 }
 
 void HttpConnection::Send(const char* bytes, int len) {
   if (!socket_)
     return;
+  if (batch_depth_ > 0 && len < kMaxBatchedWriteSize) {
+    pending_output_.append(bytes, len);
+    return;
+  }
+  FlushPendingOutput();
   socket_->Send(bytes, len);
 }
 
@@ -30,29 +50,59 @@ void HttpConnection::Send200(const std::string& data,
                              const std::string& content_type) {
   if (!socket_)
     return;
-  socket_->Send(base::StringPrintf(
+  BeginBatch();
+  Send(base::StringPrintf(
       "HTTP/1.1 200 OK\r\n"
       "Content-Type:%s\r\n"
       "Content-Length:%d\r\n"
       "\r\n",
       content_type.c_str(),
       static_cast<int>(data.length())));
-  socket_->Send(data);
+  Send(data);
+  EndBatch();
 }
 
 void HttpConnection::Send404() {
   if (!socket_)
     return;
-  socket_->Send(
+  Send(
       "HTTP/1.1 404 Not Found\r\n"
       "Content-Length: 0\r\n"
       "\r\n");
 }
 
+void HttpConnection::SendFile(const FilePath& path,
+                              const std::string& content_type) {
+  if (!socket_)
+    return;
+  file_util::MemoryMappedFile file;
+  if (!file.Initialize(path)) {
+    Send404();
+    return;
+  }
+  const char* data = reinterpret_cast<const char*>(file.data());
+  const int64 length = static_cast<int64>(file.length());
+  BeginBatch();
+  Send(base::StringPrintf(
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Type:%s\r\n"
+      "Content-Length:%s\r\n"
+      "\r\n",
+      content_type.c_str(),
+      base::Int64ToString(length).c_str()));
+  for (int64 offset = 0; offset < length; ) {
+    int chunk_size = static_cast<int>(
+        std::min(length - offset, kMaxFileChunkSize));
+    Send(data + offset, chunk_size);
+    offset += chunk_size;
+  }
+  EndBatch();
+}
+
 void HttpConnection::Send500(const std::string& message) {
   if (!socket_)
     return;
-  socket_->Send(base::StringPrintf(
+  Send(base::StringPrintf(
       "HTTP/1.1 500 Internal Error\r\n"
       "Content-Type:text/html\r\n"
       "Content-Length:%d\r\n"
@@ -64,7 +114,8 @@ void HttpConnection::Send500(const std::string& message) {
 
 HttpConnection::HttpConnection(HttpServer* server, ListenSocket* sock)
     : server_(server),
-      socket_(sock) {
+      socket_(sock),
+      batch_depth_(0) {
   id_ = last_id_++;
 }
 
@@ -77,8 +128,26 @@ void HttpConnection::DetachSocket() {
   socket_ = NULL;
 }
 
+void HttpConnection::BeginBatch() {
+  ++batch_depth_;
+}
+
+void HttpConnection::EndBatch() {
+  DCHECK_GT(batch_depth_, 0);
+  if (--batch_depth_ == 0)
+    FlushPendingOutput();
+}
+
+void HttpConnection::FlushPendingOutput() {
+  if (pending_output_.empty())
+    return;
+  if (socket_)
+    socket_->Send(pending_output_);
+  pending_output_.clear();
+}
+
 void HttpConnection::Shift(int num_bytes) {
-  recv_data_ = recv_data_.substr(num_bytes);
+  recv_data_.erase(0, num_bytes);
 }
 
 }  // namespace net
@@ -12,6 +12,8 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 
+class FilePath;
+
 namespace net {
 
 class HttpServer;
@@ -25,6 +27,9 @@ class HttpConnection {
   void Send200(const std::string& data, const std::string& content_type);
   void Send404();
   void Send500(const std::string& message);
+  // Sends the contents of |path| as a 200 response straight from a memory
+  // mapping of the file, or a 404 if it cannot be mapped.
+  void SendFile(const FilePath& path, const std::string& content_type);
 
   void Shift(int num_bytes);
 
@@ -40,10 +45,20 @@ class HttpConnection {
 
   void DetachSocket();
 
+  // Between BeginBatch() and the matching EndBatch(), small writes are
+  // collected in |pending_output_| and go out in a single send when the
+  // outermost batch ends.  HttpServer batches all the responses produced
+  // while handling one read, so pipelined requests are answered together.
+  void BeginBatch();
+  void EndBatch();
+  void FlushPendingOutput();
+
   HttpServer* server_;
   scoped_refptr<ListenSocket> socket_;
   scoped_ptr<WebSocket> web_socket_;
   std::string recv_data_;
+  std::string pending_output_;
+  int batch_depth_;
   int id_;
   DISALLOW_COPY_AND_ASSIGN(HttpConnection);
 };
@@ -6,6 +6,7 @@
 
 #include "base/compiler_specific.h"
 #include "base/logging.h"
+#include "base/string_number_conversions.h"
 #include "base/string_util.h"
 #include "base/stringprintf.h"
 #include "base/sys_byteorder.h"
@@ -69,12 +70,24 @@ void HttpServer::Send500(int connection_id, const std::string& message) {
   connection->Send500(message);
 }
 
+void HttpServer::SendFile(int connection_id,
+                          const FilePath& path,
+                          const std::string& content_type) {
+  HttpConnection* connection = FindConnection(connection_id);
+  if (connection == NULL)
+    return;
+  connection->SendFile(path, content_type);
+}
+
 void HttpServer::Close(int connection_id)
 {
   HttpConnection* connection = FindConnection(connection_id);
   if (connection == NULL)
     return;
 
+  // Don't drop responses batched before the close.
+  connection->FlushPendingOutput();
+
   // Initiating close from server-side does not lead to the DidClose call.
   // Do it manually here.
   DidClose(connection->socket_);
@@ -146,13 +159,16 @@ bool HttpServer::ParseHeaders(HttpConnection* connection,
                               HttpServerRequestInfo* info,
                               size_t* ppos) {
   size_t& pos = *ppos;
-  size_t data_len = connection->recv_data_.length();
+  const std::string& data = connection->recv_data_;
+  size_t data_len = data.length();
   int state = ST_METHOD;
-  std::string buffer;
+  // Tokens are contiguous in |data|, so rather than accumulating them a
+  // character at a time only remember where the current one began.
+  size_t token_begin = pos;
   std::string header_name;
-  std::string header_value;
   while (pos < data_len) {
-    char ch = connection->recv_data_[pos++];
+    size_t ch_pos = pos++;
+    char ch = data[ch_pos];
     int input = charToInput(ch);
     int next_state = parser_state[state][input];
 
@@ -161,44 +177,33 @@ bool HttpServer::ParseHeaders(HttpConnection* connection,
       // Do any actions based on state transitions.
       switch (state) {
         case ST_METHOD:
-          info->method = buffer;
-          buffer.clear();
+          info->method.assign(data, token_begin, ch_pos - token_begin);
           break;
         case ST_URL:
-          info->path = buffer;
-          buffer.clear();
+          info->path.assign(data, token_begin, ch_pos - token_begin);
           break;
         case ST_PROTO:
           // TODO(mbelshe): Deal better with parsing protocol.
-          DCHECK(buffer == "HTTP/1.1");
-          buffer.clear();
+          DCHECK(data.compare(token_begin, ch_pos - token_begin,
+                              "HTTP/1.1") == 0);
           break;
         case ST_NAME:
-          header_name = buffer;
-          buffer.clear();
+          header_name.assign(data, token_begin, ch_pos - token_begin);
           break;
         case ST_VALUE:
-          header_value = buffer;
           // TODO(mbelshe): Deal better with duplicate headers
           DCHECK(info->headers.find(header_name) == info->headers.end());
-          info->headers[header_name] = header_value;
-          buffer.clear();
-          break;
-        case ST_SEPARATOR:
-          buffer.append(&ch, 1);
+          info->headers[header_name].assign(data, token_begin,
+                                            ch_pos - token_begin);
           break;
       }
+      // A value starts with the character that ends the separator; every
+      // other token starts after the character that began the new state.
+      token_begin = (state == ST_SEPARATOR) ? ch_pos : pos;
       state = next_state;
     } else {
       // Do any actions based on current state
       switch (state) {
-        case ST_METHOD:
-        case ST_URL:
-        case ST_PROTO:
-        case ST_VALUE:
-        case ST_NAME:
-          buffer.append(&ch, 1);
-          break;
         case ST_DONE:
           DCHECK(input == INPUT_LF);
           return true;
@@ -225,10 +230,21 @@ void HttpServer::DidRead(ListenSocket* socket,
   DCHECK(connection != NULL);
   if (connection == NULL)
     return;
+  const int connection_id = connection->id();
 
   connection->recv_data_.append(data, len);
-  while (connection->recv_data_.length()) {
+
+  // Everything the delegate sends while we work through this read goes out
+  // in one write, and the parsed requests are shifted out of recv_data_ in
+  // one go rather than one at a time.
+  connection->BeginBatch();
+  size_t consumed = 0;
+  bool close = false;
+  while (consumed < connection->recv_data_.length()) {
     if (connection->web_socket_.get()) {
+      // WebSocket shifts recv_data_ itself.
+      connection->Shift(consumed);
+      consumed = 0;
       std::string message;
       WebSocket::ParseResult result = connection->web_socket_->Read(&message);
       if (result == WebSocket::FRAME_INCOMPLETE)
@@ -236,34 +252,62 @@ void HttpServer::DidRead(ListenSocket* socket,
 
       if (result == WebSocket::FRAME_CLOSE ||
           result == WebSocket::FRAME_ERROR) {
-        Close(connection->id());
+        close = true;
         break;
       }
-      delegate_->OnWebSocketMessage(connection->id(), message);
+      delegate_->OnWebSocketMessage(connection_id, message);
+      // The delegate may have closed the connection.
+      if (FindConnection(connection_id) == NULL)
+        return;
       continue;
     }
 
     HttpServerRequestInfo request;
-    size_t pos = 0;
+    size_t pos = consumed;
     if (!ParseHeaders(connection, &request, &pos))
       break;
 
     std::string connection_header = request.GetHeaderValue("Connection");
     if (connection_header == "Upgrade") {
+      connection->Shift(consumed);
+      pos -= consumed;
+      consumed = 0;
       connection->web_socket_.reset(WebSocket::CreateWebSocket(connection,
                                                                request,
                                                                &pos));
 
       if (!connection->web_socket_.get())  // Not enought data was received.
         break;
-      delegate_->OnWebSocketRequest(connection->id(), request);
+      delegate_->OnWebSocketRequest(connection_id, request);
+      if (FindConnection(connection_id) == NULL)
+        return;
       connection->Shift(pos);
       continue;
     }
-    // Request body is not supported. It is always empty.
-    delegate_->OnHttpRequest(connection->id(), request);
-    connection->Shift(pos);
+
+    // Wait for the whole body before dispatching, so that pipelined requests
+    // which carry one are split correctly.
+    std::string content_length = request.GetHeaderValue("Content-Length");
+    if (!content_length.empty()) {
+      size_t body_length = 0;
+      if (!base::StringToSizeT(content_length, &body_length)) {
+        close = true;
+        break;
+      }
+      if (connection->recv_data_.length() - pos < body_length)
+        break;
+      request.data.assign(connection->recv_data_, pos, body_length);
+      pos += body_length;
+    }
+    consumed = pos;
+    delegate_->OnHttpRequest(connection_id, request);
+    if (FindConnection(connection_id) == NULL)
+      return;
   }
+  connection->Shift(consumed);
+  connection->EndBatch();
+  if (close)
+    Close(connection_id);
 }
 
 void HttpServer::DidClose(ListenSocket* socket) {
@@ -13,6 +13,8 @@
 #include "base/memory/ref_counted.h"
 #include "net/base/listen_socket.h"
 
+class FilePath;
+
 namespace net {
 
 class HttpConnection;
@@ -51,6 +53,11 @@ class HttpServer : public ListenSocket::ListenSocketDelegate,
                const std::string& mime_type);
   void Send404(int connection_id);
   void Send500(int connection_id, const std::string& message);
+  // Serves |path| without reading it into memory; see
+  // HttpConnection::SendFile().
+  void SendFile(int connection_id,
+                const FilePath& path,
+                const std::string& content_type);
   void Close(int connection_id);
 
 private:
@@ -64,9 +71,9 @@ private:
                        int len) OVERRIDE;
   virtual void DidClose(ListenSocket* socket) OVERRIDE;
 
-  // Expects the raw data to be stored in recv_data_. If parsing is successful,
-  // will remove the data parsed from recv_data_, leaving only the unused
-  // recv data.
+  // Parses the request starting at |*pos| in the connection's recv_data_.
+  // If parsing is successful, advances |*pos| past the headers; the caller
+  // shifts the consumed data out of recv_data_.
   bool ParseHeaders(HttpConnection* connection,
                     HttpServerRequestInfo* info,
                     size_t* pos);
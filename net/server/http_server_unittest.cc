@@ -0,0 +1,199 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/memory/ref_counted.h"
+#include "base/message_loop.h"
+#include "base/scoped_temp_dir.h"
+#include "net/base/listen_socket.h"
+#include "net/server/http_server.h"
+#include "net/server/http_server_request_info.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+// A connected socket that records what is sent to it instead of touching the
+// network.  Reads are delivered by calling the server's DidRead() directly.
+class TestConnectionSocket : public ListenSocket {
+ public:
+  explicit TestConnectionSocket(ListenSocketDelegate* del)
+      : ListenSocket(kInvalidSocket, del),
+        send_count_(0) {
+  }
+
+  const std::string& sent_data() const { return sent_data_; }
+  int send_count() const { return send_count_; }
+
+ protected:
+  virtual ~TestConnectionSocket() {}
+
+  virtual void SendInternal(const char* bytes, int len) OVERRIDE {
+    sent_data_.append(bytes, len);
+    ++send_count_;
+  }
+
+ private:
+  std::string sent_data_;
+  int send_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestConnectionSocket);
+};
+
+class TestDelegate : public HttpServer::Delegate {
+ public:
+  TestDelegate()
+      : server_(NULL),
+        close_on_request_(false),
+        last_connection_id_(-1),
+        close_count_(0) {
+  }
+
+  void set_server(HttpServer* server) { server_ = server; }
+  void set_close_on_request(bool close) { close_on_request_ = close; }
+
+  const std::vector<HttpServerRequestInfo>& requests() const {
+    return requests_;
+  }
+  int last_connection_id() const { return last_connection_id_; }
+  int close_count() const { return close_count_; }
+
+  virtual void OnHttpRequest(int connection_id,
+                             const HttpServerRequestInfo& info) OVERRIDE {
+    requests_.push_back(info);
+    last_connection_id_ = connection_id;
+    server_->Send200(connection_id, info.path + info.data, "text/plain");
+    if (close_on_request_)
+      server_->Close(connection_id);
+  }
+
+  virtual void OnWebSocketRequest(int connection_id,
+                                  const HttpServerRequestInfo& info) OVERRIDE {
+  }
+
+  virtual void OnWebSocketMessage(int connection_id,
+                                  const std::string& data) OVERRIDE {
+  }
+
+  virtual void OnClose(int connection_id) OVERRIDE {
+    ++close_count_;
+  }
+
+ private:
+  HttpServer* server_;
+  bool close_on_request_;
+  std::vector<HttpServerRequestInfo> requests_;
+  int last_connection_id_;
+  int close_count_;
+};
+
+}  // namespace
+
+class HttpServerTest : public testing::Test {
+ protected:
+  HttpServerTest() : message_loop_(MessageLoop::TYPE_IO) {}
+
+  virtual void SetUp() OVERRIDE {
+    server_ = new HttpServer("127.0.0.1", 0, &delegate_);
+    delegate_.set_server(server_);
+    socket_ = new TestConnectionSocket(server_.get());
+    server_delegate()->DidAccept(NULL, socket_);
+  }
+
+  virtual void TearDown() OVERRIDE {
+    server_ = NULL;
+  }
+
+  ListenSocket::ListenSocketDelegate* server_delegate() {
+    return server_.get();
+  }
+
+  void Read(const std::string& data) {
+    server_delegate()->DidRead(socket_, data.data(),
+                               static_cast<int>(data.length()));
+  }
+
+  MessageLoop message_loop_;
+  TestDelegate delegate_;
+  scoped_refptr<HttpServer> server_;
+  scoped_refptr<TestConnectionSocket> socket_;
+};
+
+TEST_F(HttpServerTest, PipelinedRequests) {
+  Read("GET /first HTTP/1.1\r\n\r\n"
+       "GET /second HTTP/1.1\r\n\r\n");
+  ASSERT_EQ(2u, delegate_.requests().size());
+  EXPECT_EQ("GET", delegate_.requests()[0].method);
+  EXPECT_EQ("/first", delegate_.requests()[0].path);
+  EXPECT_EQ("/second", delegate_.requests()[1].path);
+
+  // Both responses are written, in order, with a single send.
+  EXPECT_EQ(1, socket_->send_count());
+  const std::string& sent = socket_->sent_data();
+  size_t first = sent.find("/first");
+  size_t second = sent.find("/second");
+  ASSERT_NE(std::string::npos, first);
+  ASSERT_NE(std::string::npos, second);
+  EXPECT_LT(first, second);
+}
+
+TEST_F(HttpServerTest, BodySplitAcrossReads) {
+  Read("POST /post HTTP/1.1\r\n"
+       "Content-Length: 11\r\n"
+       "\r\n"
+       "hello");
+  EXPECT_EQ(0u, delegate_.requests().size());
+  EXPECT_EQ(0, socket_->send_count());
+
+  // The rest of the body arrives along with the next pipelined request.
+  Read(" world"
+       "GET /next HTTP/1.1\r\n\r\n");
+  ASSERT_EQ(2u, delegate_.requests().size());
+  EXPECT_EQ("POST", delegate_.requests()[0].method);
+  EXPECT_EQ("hello world", delegate_.requests()[0].data);
+  EXPECT_EQ("GET", delegate_.requests()[1].method);
+  EXPECT_EQ("/next", delegate_.requests()[1].path);
+  EXPECT_EQ("", delegate_.requests()[1].data);
+}
+
+TEST_F(HttpServerTest, DelegateClosesMidPipeline) {
+  delegate_.set_close_on_request(true);
+  Read("GET /first HTTP/1.1\r\n\r\n"
+       "GET /second HTTP/1.1\r\n\r\n");
+
+  // The connection is gone after the first request, but its response still
+  // went out.
+  ASSERT_EQ(1u, delegate_.requests().size());
+  EXPECT_EQ("/first", delegate_.requests()[0].path);
+  EXPECT_EQ(1, delegate_.close_count());
+  EXPECT_NE(std::string::npos, socket_->sent_data().find("/first"));
+  EXPECT_EQ(std::string::npos, socket_->sent_data().find("/second"));
+}
+
+TEST_F(HttpServerTest, SendFile) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath path = temp_dir.path().AppendASCII("file.txt");
+  const std::string contents("file contents");
+  ASSERT_EQ(static_cast<int>(contents.length()),
+            file_util::WriteFile(path, contents.data(), contents.length()));
+
+  Read("GET /file HTTP/1.1\r\n\r\n");
+  const int connection_id = delegate_.last_connection_id();
+  server_->SendFile(connection_id, path, "text/plain");
+  const std::string& sent = socket_->sent_data();
+  EXPECT_NE(std::string::npos, sent.find("Content-Length:13\r\n"));
+  EXPECT_EQ(contents, sent.substr(sent.length() - contents.length()));
+
+  server_->SendFile(connection_id, temp_dir.path().AppendASCII("missing.txt"),
+                    "text/plain");
+  EXPECT_NE(std::string::npos, socket_->sent_data().find("404 Not Found"));
+}
+
+}  // namespace net
@@ -42,6 +42,7 @@ ClientSocketPoolManagerImpl::ClientSocketPoolManagerImpl(
     TransportSecurityState* transport_security_state,
     SSLHostInfoFactory* ssl_host_info_factory,
     const std::string& ssl_session_cache_shard,
+    SSLSessionStore* ssl_session_store,
     ProxyService* proxy_service,
     SSLConfigService* ssl_config_service,
     HttpNetworkSession::SocketPoolType pool_type)
@@ -53,6 +54,7 @@ ClientSocketPoolManagerImpl::ClientSocketPoolManagerImpl(
       transport_security_state_(transport_security_state),
       ssl_host_info_factory_(ssl_host_info_factory),
       ssl_session_cache_shard_(ssl_session_cache_shard),
+      ssl_session_store_(ssl_session_store),
       proxy_service_(proxy_service),
       ssl_config_service_(ssl_config_service),
       pool_type_(pool_type),
@@ -73,6 +75,7 @@ ClientSocketPoolManagerImpl::ClientSocketPoolManagerImpl(
           transport_security_state,
           ssl_host_info_factory,
           ssl_session_cache_shard,
+          ssl_session_store,
           socket_factory,
           transport_socket_pool_.get(),
           NULL /* no socks proxy */,
@@ -293,6 +296,7 @@ ClientSocketPoolManagerImpl::GetSocketPoolForHTTPProxy(
                   transport_security_state_,
                   ssl_host_info_factory_,
                   ssl_session_cache_shard_,
+                  ssl_session_store_,
                   socket_factory_,
                   tcp_https_ret.first->second /* https proxy */,
                   NULL /* no socks proxy */,
@@ -333,6 +337,7 @@ SSLClientSocketPool* ClientSocketPoolManagerImpl::GetSocketPoolForSSLWithProxy(
       transport_security_state_,
       ssl_host_info_factory_,
       ssl_session_cache_shard_,
+      ssl_session_store_,
       socket_factory_,
       NULL, /* no tcp pool, we always go through a proxy */
       GetSocketPoolForSOCKSProxy(proxy_server),
@@ -33,6 +33,7 @@ class SOCKSClientSocketPool;
 class SSLClientSocketPool;
 class SSLConfigService;
 class SSLHostInfoFactory;
+class SSLSessionStore;
 class TransportClientSocketPool;
 class TransportSecurityState;
 
@@ -66,6 +67,7 @@ class ClientSocketPoolManagerImpl : public base::NonThreadSafe,
                               TransportSecurityState* transport_security_state,
                               SSLHostInfoFactory* ssl_host_info_factory,
                               const std::string& ssl_session_cache_shard,
+                              SSLSessionStore* ssl_session_store,
                               ProxyService* proxy_service,
                               SSLConfigService* ssl_config_service,
                               HttpNetworkSession::SocketPoolType pool_type);
@@ -113,6 +115,7 @@ class ClientSocketPoolManagerImpl : public base::NonThreadSafe,
   TransportSecurityState* const transport_security_state_;
   SSLHostInfoFactory* const ssl_host_info_factory_;
   const std::string ssl_session_cache_shard_;
+  SSLSessionStore* const ssl_session_store_;
   ProxyService* const proxy_service_;
   const scoped_refptr<SSLConfigService> ssl_config_service_;
   const HttpNetworkSession::SocketPoolType pool_type_;
@@ -23,6 +23,7 @@ class SSLCertRequestInfo;
 class SSLHostInfo;
 class SSLHostInfoFactory;
 class SSLInfo;
+class SSLSessionStore;
 class TransportSecurityState;
 
 // This struct groups together several fields which are used by various
@@ -32,18 +33,21 @@ struct SSLClientSocketContext {
       : cert_verifier(NULL),
         server_bound_cert_service(NULL),
         transport_security_state(NULL),
-        ssl_host_info_factory(NULL) {}
+        ssl_host_info_factory(NULL),
+        ssl_session_store(NULL) {}
 
   SSLClientSocketContext(CertVerifier* cert_verifier_arg,
                          ServerBoundCertService* server_bound_cert_service_arg,
                          TransportSecurityState* transport_security_state_arg,
                          SSLHostInfoFactory* ssl_host_info_factory_arg,
-                         const std::string& ssl_session_cache_shard_arg)
+                         const std::string& ssl_session_cache_shard_arg,
+                         SSLSessionStore* ssl_session_store_arg)
       : cert_verifier(cert_verifier_arg),
         server_bound_cert_service(server_bound_cert_service_arg),
         transport_security_state(transport_security_state_arg),
         ssl_host_info_factory(ssl_host_info_factory_arg),
-        ssl_session_cache_shard(ssl_session_cache_shard_arg) {}
+        ssl_session_cache_shard(ssl_session_cache_shard_arg),
+        ssl_session_store(ssl_session_store_arg) {}
 
   CertVerifier* cert_verifier;
   ServerBoundCertService* server_bound_cert_service;
@@ -53,6 +57,8 @@ struct SSLClientSocketContext {
   // SSL session cache. SSL sockets with the same ssl_session_cache_shard may
   // resume each other's SSL sessions but we'll never sessions between shards.
   const std::string ssl_session_cache_shard;
+  // ssl_session_store, if non-NULL, keeps sessions across restarts.
+  SSLSessionStore* ssl_session_store;
 };
 
 // A client socket that uses SSL as the transport layer.
@@ -101,6 +101,7 @@
 #include "net/socket/nss_ssl_util.h"
 #include "net/socket/ssl_error_params.h"
 #include "net/socket/ssl_host_info.h"
+#include "net/socket/ssl_session_store.h"
 
 #if defined(OS_WIN)
 #include <windows.h>
@@ -428,6 +429,41 @@ DNSValidationResult CheckDNSSECChain(
   return r;
 }
 
+// Values of the Net.SSLSessionResumption histogram. Do not reorder.
+enum SessionResumption {
+  SESSION_FULL = 0,
+  // A session restored from the SSLSessionStore was offered but the server
+  // declined it.
+  SESSION_FULL_RESTORED_REJECTED = 1,
+  SESSION_RESUMED = 2,
+  // The server resumed a session that was restored from the SSLSessionStore.
+  SESSION_RESUMED_RESTORED = 3,
+  SESSION_RESUMPTION_MAX,
+};
+
+class SessionResumptionParameters : public NetLog::EventParameters {
+ public:
+  SessionResumptionParameters(bool resumed, bool restored_session)
+      : resumed_(resumed),
+        restored_session_(restored_session) {
+  }
+
+  virtual Value* ToValue() const OVERRIDE {
+    DictionaryValue* dict = new DictionaryValue();
+    dict->SetBoolean("resumed", resumed_);
+    dict->SetBoolean("restored_session", restored_session_);
+    return dict;
+  }
+
+ private:
+  virtual ~SessionResumptionParameters() {}
+
+  const bool resumed_;
+  const bool restored_session_;
+
+  DISALLOW_COPY_AND_ASSIGN(SessionResumptionParameters);
+};
+
 }  // namespace
 
 SSLClientSocketNSS::SSLClientSocketNSS(ClientSocketHandle* transport_socket,
@@ -455,6 +491,8 @@ SSLClientSocketNSS::SSLClientSocketNSS(ClientSocketHandle* transport_socket,
       handshake_callback_called_(false),
       completed_handshake_(false),
       ssl_session_cache_shard_(context.ssl_session_cache_shard),
+      ssl_session_store_(context.ssl_session_store),
+      restored_session_(false),
       eset_mitm_detected_(false),
       predicted_cert_chain_correct_(false),
       next_handshake_state_(STATE_NONE),
@@ -657,6 +695,7 @@ void SSLClientSocketNSS::Disconnect() {
   eset_mitm_detected_    = false;
   start_cert_verification_time_ = base::TimeTicks();
   predicted_cert_chain_correct_ = false;
+  restored_session_      = false;
   nss_bufs_              = NULL;
   client_certs_.clear();
   client_auth_cert_needed_ = false;
@@ -1052,17 +1091,20 @@ int SSLClientSocketNSS::InitializeSSLPeerName() {
   // Set the peer ID for session reuse.  This is necessary when we create an
   // SSL tunnel through a proxy -- GetPeerName returns the proxy's address
   // rather than the destination server's address in that case.
-  std::string peer_id = host_and_port_.ToString();
+  peer_id_ = host_and_port_.ToString();
   // If the ssl_session_cache_shard_ is non-empty, we append it to the peer id.
   // This will cause session cache misses between sockets with different values
   // of ssl_session_cache_shard_ and this is used to partition the session cache
   // for incognito mode.
   if (!ssl_session_cache_shard_.empty()) {
-    peer_id += "/" + ssl_session_cache_shard_;
+    peer_id_ += "/" + ssl_session_cache_shard_;
   }
-  SECStatus rv = SSL_SetSockPeerID(nss_fd_, const_cast<char*>(peer_id.c_str()));
+  SECStatus rv = SSL_SetSockPeerID(nss_fd_,
+                                   const_cast<char*>(peer_id_.c_str()));
   if (rv != SECSuccess)
-    LogFailedNSSFunction(net_log_, "SSL_SetSockPeerID", peer_id.c_str());
+    LogFailedNSSFunction(net_log_, "SSL_SetSockPeerID", peer_id_.c_str());
+
+  RestoreSession();
 
   return OK;
 }
@@ -1518,6 +1560,8 @@ int SSLClientSocketNSS::DoHandshake() {
         }
 #endif
 
+        RecordSessionResumption();
+        SaveSession();
         SaveSSLHostInfo();
         // SSL handshake is completed. Let's verify the certificate.
         GotoState(STATE_VERIFY_DNSSEC);
@@ -1965,6 +2009,64 @@ void SSLClientSocketNSS::SaveSSLHostInfo() {
   ssl_host_info_->Persist();
 }
 
+void SSLClientSocketNSS::RestoreSession() {
+  std::string saved;
+  if (!ssl_session_store_ || !ssl_session_store_->GetSession(peer_id_, &saved))
+    return;
+
+  SECItem session;
+  session.type = siBuffer;
+  session.data = const_cast<uint8*>(reinterpret_cast<const uint8*>(
+      saved.data()));
+  session.len = saved.size();
+  PRBool imported = PR_FALSE;
+  if (SSL_ImportClientSessionID(nss_fd_, &session, &imported) != SECSuccess) {
+    LogFailedNSSFunction(net_log_, "SSL_ImportClientSessionID", "");
+    ssl_session_store_->RemoveSession(peer_id_);
+    return;
+  }
+  if (imported) {
+    restored_session_ = true;
+    net_log_.AddEvent(NetLog::TYPE_SSL_SESSION_IMPORTED, NULL);
+  }
+}
+
+void SSLClientSocketNSS::SaveSession() {
+  if (!ssl_session_store_)
+    return;
+
+  // If NSS has nothing resumable (for example, the server sent no session ID,
+  // or a client certificate was used) then any earlier session is dropped.
+  SECItem session = {siBuffer, NULL, 0};
+  if (SSL_ExportClientSessionID(nss_fd_, &session) != SECSuccess) {
+    ssl_session_store_->RemoveSession(peer_id_);
+    return;
+  }
+  ssl_session_store_->SetSession(
+      peer_id_,
+      std::string(reinterpret_cast<char*>(session.data), session.len));
+  SECITEM_FreeItem(&session, PR_FALSE);
+}
+
+void SSLClientSocketNSS::RecordSessionResumption() {
+  PRBool resumed = PR_FALSE;
+  if (SSL_HandshakeResumedSession(nss_fd_, &resumed) != SECSuccess)
+    return;
+
+  SessionResumption sample;
+  if (resumed) {
+    sample = restored_session_ ? SESSION_RESUMED_RESTORED : SESSION_RESUMED;
+  } else {
+    sample = restored_session_ ? SESSION_FULL_RESTORED_REJECTED : SESSION_FULL;
+  }
+  UMA_HISTOGRAM_ENUMERATION("Net.SSLSessionResumption", sample,
+                            SESSION_RESUMPTION_MAX);
+  net_log_.AddEvent(
+      NetLog::TYPE_SSL_SESSION_RESUMPTION,
+      make_scoped_refptr(new SessionResumptionParameters(
+          resumed == PR_TRUE, restored_session_)));
+}
+
 void SSLClientSocketNSS::UncorkAfterTimeout() {
   corked_ = false;
   int nsent;
@@ -38,6 +38,7 @@ class ClientSocketHandle;
 class ServerBoundCertService;
 class SingleRequestCertVerifier;
 class SSLHostInfo;
+class SSLSessionStore;
 class TransportSecurityState;
 class X509Certificate;
 
@@ -147,6 +148,15 @@ class SSLClientSocketNSS : public SSLClientSocket {
   int DoPayloadWrite();
   void LogConnectionTypeMetrics() const;
   void SaveSSLHostInfo();
+
+  // Imports the session saved in |ssl_session_store_| for |peer_id_|, if any,
+  // into NSS's client session cache so that the handshake can resume it.
+  void RestoreSession();
+  // Saves the session of the completed handshake in |ssl_session_store_|.
+  void SaveSession();
+  // Records whether the completed handshake resumed a session.
+  void RecordSessionResumption();
+
   void UncorkAfterTimeout();
 
   bool DoTransportIO();
@@ -275,6 +285,18 @@ class SSLClientSocketNSS : public SSLClientSocket {
   // resume on the socket with a different value.
   const std::string ssl_session_cache_shard_;
 
+  // ssl_session_store_, if non-NULL, keeps this socket's sessions across
+  // restarts.
+  SSLSessionStore* const ssl_session_store_;
+
+  // The peer ID handed to NSS for session caching, which is also the key in
+  // |ssl_session_store_|.
+  std::string peer_id_;
+
+  // True iff a session from |ssl_session_store_| was imported into NSS's
+  // client session cache before the handshake.
+  bool restored_session_;
+
   // True iff we believe that the user has an ESET product intercepting our
   // HTTPS connections.
   bool eset_mitm_detected_;
@@ -32,6 +32,7 @@ class SOCKSClientSocketPool;
 class SOCKSSocketParams;
 class SSLClientSocket;
 class SSLHostInfoFactory;
+class SSLSessionStore;
 class TransportClientSocketPool;
 class TransportSecurityState;
 class TransportSocketParams;
@@ -180,6 +181,7 @@ class NET_EXPORT_PRIVATE SSLClientSocketPool
       TransportSecurityState* transport_security_state,
       SSLHostInfoFactory* ssl_host_info_factory,
       const std::string& ssl_session_cache_shard,
+      SSLSessionStore* ssl_session_store,
       ClientSocketFactory* client_socket_factory,
       TransportClientSocketPool* transport_pool,
       SOCKSClientSocketPool* socks_pool,
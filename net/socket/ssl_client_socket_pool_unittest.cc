@@ -100,6 +100,7 @@ class SSLClientSocketPoolTest : public testing::Test {
         NULL /* transport_security_state */,
         NULL /* ssl_host_info_factory */,
         ""   /* ssl_session_cache_shard */,
+        NULL /* ssl_session_store */,
         &socket_factory_,
         transport_pool ? &transport_socket_pool_ : NULL,
         socks_pool ? &socks_socket_pool_ : NULL,
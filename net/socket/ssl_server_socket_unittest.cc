@@ -17,6 +17,7 @@
 
 #include <stdlib.h>
 
+#include <map>
 #include <queue>
 
 #include "base/compiler_specific.h"
@@ -41,6 +42,8 @@
 #include "net/socket/client_socket_factory.h"
 #include "net/socket/socket_test_util.h"
 #include "net/socket/ssl_client_socket.h"
+#include "net/socket/ssl_host_info.h"
+#include "net/socket/ssl_session_store.h"
 #include "net/socket/stream_socket.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/platform_test.h"
@@ -242,17 +245,98 @@ TEST(FakeSocketTest, DataTransfer) {
   EXPECT_EQ(0, memcmp(kTestData, read_buf->data(), read));
 }
 
+// An SSLHostInfo that "persists" to a string owned by the test, standing in
+// for the disk cache across a restart.
+class MemorySSLHostInfo : public SSLHostInfo {
+ public:
+  MemorySSLHostInfo(const std::string& hostname,
+                    const SSLConfig& ssl_config,
+                    CertVerifier* cert_verifier,
+                    std::string* storage)
+      : SSLHostInfo(hostname, ssl_config, cert_verifier),
+        storage_(storage) {
+    Parse(*storage_);
+  }
+
+  virtual void Start() OVERRIDE {}
+
+  virtual int WaitForDataReady(const CompletionCallback& callback) OVERRIDE {
+    return OK;
+  }
+
+  virtual void Persist() OVERRIDE {
+    *storage_ = Serialize();
+  }
+
+ private:
+  std::string* storage_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemorySSLHostInfo);
+};
+
+// An SSLSessionStore that outlives the sockets of a test, standing in for a
+// store on disk across a restart.
+class MemorySSLSessionStore : public SSLSessionStore {
+ public:
+  MemorySSLSessionStore() {}
+  virtual ~MemorySSLSessionStore() {}
+
+  virtual bool GetSession(const std::string& peer_id,
+                          std::string* session) OVERRIDE {
+    std::map<std::string, std::string>::const_iterator it =
+        sessions_.find(peer_id);
+    if (it == sessions_.end())
+      return false;
+    *session = it->second;
+    return true;
+  }
+
+  virtual void SetSession(const std::string& peer_id,
+                          const std::string& session) OVERRIDE {
+    sessions_[peer_id] = session;
+  }
+
+  virtual void RemoveSession(const std::string& peer_id) OVERRIDE {
+    sessions_.erase(peer_id);
+  }
+
+  virtual void RemoveAllSessions() OVERRIDE {
+    sessions_.clear();
+  }
+
+  size_t size() const { return sessions_.size(); }
+
+ private:
+  std::map<std::string, std::string> sessions_;
+
+  DISALLOW_COPY_AND_ASSIGN(MemorySSLSessionStore);
+};
+
 class SSLServerSocketTest : public PlatformTest {
  public:
   SSLServerSocketTest()
       : socket_factory_(net::ClientSocketFactory::GetDefaultFactory()),
-        cert_verifier_(net::CertVerifier::CreateDefault()) {
+        cert_verifier_(net::CertVerifier::CreateDefault()),
+        ssl_session_store_(NULL) {
   }
 
  protected:
   void Initialize() {
-    FakeSocket* fake_client_socket = new FakeSocket(&channel_1_, &channel_2_);
-    FakeSocket* fake_server_socket = new FakeSocket(&channel_2_, &channel_1_);
+    InitializeWithHostInfo(NULL);
+  }
+
+  // Creates a fresh pair of connected client and server sockets. If
+  // |ssl_host_info| is non-NULL then the client socket takes ownership of it
+  // and has cached info enabled.
+  void InitializeWithHostInfo(SSLHostInfo* ssl_host_info) {
+    client_socket_.reset();
+    server_socket_.reset();
+    channel_1_.reset(new FakeDataChannel());
+    channel_2_.reset(new FakeDataChannel());
+    FakeSocket* fake_client_socket =
+        new FakeSocket(channel_1_.get(), channel_2_.get());
+    FakeSocket* fake_server_socket =
+        new FakeSocket(channel_2_.get(), channel_1_.get());
 
     FilePath certs_dir;
     PathService::Get(base::DIR_SOURCE_ROOT, &certs_dir);
@@ -280,7 +364,7 @@ class SSLServerSocketTest : public PlatformTest {
         crypto::RSAPrivateKey::CreateFromPrivateKeyInfo(key_vector));
 
     net::SSLConfig ssl_config;
-    ssl_config.cached_info_enabled = false;
+    ssl_config.cached_info_enabled = ssl_host_info != NULL;
     ssl_config.false_start_enabled = false;
     ssl_config.domain_bound_certs_enabled = false;
     ssl_config.ssl3_enabled = true;
@@ -295,20 +379,43 @@ class SSLServerSocketTest : public PlatformTest {
     net::HostPortPair host_and_pair("unittest", 0);
     net::SSLClientSocketContext context;
     context.cert_verifier = cert_verifier_.get();
+    context.ssl_session_store = ssl_session_store_;
     client_socket_.reset(
         socket_factory_->CreateSSLClientSocket(
-            fake_client_socket, host_and_pair, ssl_config, NULL, context));
+            fake_client_socket, host_and_pair, ssl_config, ssl_host_info,
+            context));
     server_socket_.reset(net::CreateSSLServerSocket(fake_server_socket,
                                                     cert, private_key.get(),
                                                     net::SSLConfig()));
   }
 
-  FakeDataChannel channel_1_;
-  FakeDataChannel channel_2_;
+  // Performs the handshake between |client_socket_| and |server_socket_|.
+  void Handshake() {
+    TestCompletionCallback connect_callback;
+    TestCompletionCallback handshake_callback;
+
+    int server_ret = server_socket_->Handshake(handshake_callback.callback());
+    EXPECT_TRUE(server_ret == net::OK || server_ret == net::ERR_IO_PENDING);
+
+    int client_ret = client_socket_->Connect(connect_callback.callback());
+    EXPECT_TRUE(client_ret == net::OK || client_ret == net::ERR_IO_PENDING);
+
+    if (client_ret == net::ERR_IO_PENDING) {
+      EXPECT_EQ(net::OK, connect_callback.WaitForResult());
+    }
+    if (server_ret == net::ERR_IO_PENDING) {
+      EXPECT_EQ(net::OK, handshake_callback.WaitForResult());
+    }
+  }
+
+  scoped_ptr<FakeDataChannel> channel_1_;
+  scoped_ptr<FakeDataChannel> channel_2_;
   scoped_ptr<net::SSLClientSocket> client_socket_;
   scoped_ptr<net::SSLServerSocket> server_socket_;
   net::ClientSocketFactory* socket_factory_;
   scoped_ptr<net::CertVerifier> cert_verifier_;
+  // If non-NULL, used by the client sockets that Initialize() creates.
+  net::SSLSessionStore* ssl_session_store_;
 };
 
 // SSLServerSocket is only implemented using NSS.
@@ -476,6 +583,67 @@ TEST_F(SSLServerSocketTest, ExportKeyingMaterial) {
   ASSERT_EQ(rv, net::OK);
   EXPECT_TRUE(memcmp(server_out, client_bad, sizeof(server_out)) != 0);
 }
+
+// The SSLHostInfo may be written to disk, so it must not carry the session.
+// This test saves the host info of a first connection, clears the in-memory
+// session cache, as a restart would, and checks that a second connection
+// cannot resume.
+TEST_F(SSLServerSocketTest, SavedHostInfoCannotResume) {
+  std::string saved_host_info;
+  SSLConfig ssl_config;
+
+  InitializeWithHostInfo(new MemorySSLHostInfo(
+      "unittest", ssl_config, cert_verifier_.get(), &saved_host_info));
+  Handshake();
+
+  SSLInfo ssl_info;
+  client_socket_->GetSSLInfo(&ssl_info);
+  EXPECT_EQ(SSLInfo::HANDSHAKE_FULL, ssl_info.handshake_type);
+  ASSERT_FALSE(saved_host_info.empty());
+
+  SSLClientSocket::ClearSessionCache();
+
+  InitializeWithHostInfo(new MemorySSLHostInfo(
+      "unittest", ssl_config, cert_verifier_.get(), &saved_host_info));
+  Handshake();
+
+  client_socket_->GetSSLInfo(&ssl_info);
+  EXPECT_EQ(SSLInfo::HANDSHAKE_FULL, ssl_info.handshake_type);
+}
+
+// This test saves the session of a first connection in an SSLSessionStore,
+// clears the in-memory session cache and creates new sockets, as a restart
+// would, and checks that a second connection resumes the saved session.
+TEST_F(SSLServerSocketTest, ResumeFromSessionStore) {
+  MemorySSLSessionStore session_store;
+  ssl_session_store_ = &session_store;
+
+  Initialize();
+  Handshake();
+
+  SSLInfo ssl_info;
+  client_socket_->GetSSLInfo(&ssl_info);
+  EXPECT_EQ(SSLInfo::HANDSHAKE_FULL, ssl_info.handshake_type);
+  ASSERT_EQ(1u, session_store.size());
+
+  SSLClientSocket::ClearSessionCache();
+
+  Initialize();
+  Handshake();
+
+  client_socket_->GetSSLInfo(&ssl_info);
+  EXPECT_EQ(SSLInfo::HANDSHAKE_RESUME, ssl_info.handshake_type);
+
+  // Without the store there is nothing left to resume.
+  SSLClientSocket::ClearSessionCache();
+  session_store.RemoveAllSessions();
+
+  Initialize();
+  Handshake();
+
+  client_socket_->GetSSLInfo(&ssl_info);
+  EXPECT_EQ(SSLInfo::HANDSHAKE_FULL, ssl_info.handshake_type);
+}
 #endif
 
 }  // namespace net
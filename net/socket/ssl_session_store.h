@@ -0,0 +1,46 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_SOCKET_SSL_SESSION_STORE_H_
+#define NET_SOCKET_SSL_SESSION_STORE_H_
+
+#include <string>
+
+#include "net/base/net_export.h"
+
+namespace net {
+
+// SSLSessionStore keeps resumable TLS client sessions for longer than the SSL
+// library's in-memory session cache, so that the first connection to a server
+// after a restart can resume instead of doing a full handshake.
+//
+// Sessions are opaque strings keyed by the peer ID that the socket gives the
+// SSL library, which names the host, port and session cache shard.  They
+// contain the session's master secret, so an implementation that keeps them
+// on disk must encrypt them, and off-the-record contexts must not have one.
+//
+// All methods are called on the network thread.
+class NET_EXPORT SSLSessionStore {
+ public:
+  virtual ~SSLSessionStore() {}
+
+  // Sets |*session| to the session saved for |peer_id| and returns true, or
+  // returns false if there is none.
+  virtual bool GetSession(const std::string& peer_id,
+                          std::string* session) = 0;
+
+  // Saves |session| for |peer_id|, replacing any earlier one.
+  virtual void SetSession(const std::string& peer_id,
+                          const std::string& session) = 0;
+
+  // Forgets the session saved for |peer_id|, if any.
+  virtual void RemoveSession(const std::string& peer_id) = 0;
+
+  // Forgets every saved session.
+  virtual void RemoveAllSessions() = 0;
+};
+
+}  // namespace net
+
+#endif  // NET_SOCKET_SSL_SESSION_STORE_H_
@@ -13,6 +13,8 @@
 #include <netinet/in.h>
 #endif
 
+#include <algorithm>
+
 #include "base/eintr_wrapper.h"
 #include "base/logging.h"
 #include "base/message_loop.h"
@@ -27,12 +29,20 @@
 #include "net/base/net_util.h"
 #include "net/base/network_change_notifier.h"
 
+// MSG_FASTOPEN is newer than the system headers on most build machines.
+#if defined(OS_LINUX) && !defined(MSG_FASTOPEN)
+#define MSG_FASTOPEN 0x20000000
+#endif
+
 namespace net {
 
 namespace {
 
 const int kInvalidSocket = -1;
 
+// The most data sent with the SYN of a TCP Fast Open connect.
+const int kMaxFastOpenSendLength = 1420;
+
 // DisableNagle turns off buffering in the kernel. By default, TCP sockets will
 // wait up to 200ms for more data to complete a packet before transmitting.
 // After calling this function, the kernel will not wait. See TCP_NODELAY in
@@ -130,6 +140,8 @@ TCPClientSocketLibevent::TCPClientSocketLibevent(
       current_ai_(NULL),
       read_watcher_(this),
       write_watcher_(this),
+      keep_read_watch_(false),
+      keep_write_watch_(false),
       next_connect_state_(CONNECT_STATE_NONE),
       connect_os_error_(0),
       net_log_(BoundNetLog::Make(net_log, NetLog::SOURCE_SOCKET)),
@@ -142,8 +154,10 @@ TCPClientSocketLibevent::TCPClientSocketLibevent(
     params = new NetLogSourceParameter("source_dependency", source);
   net_log_.BeginEvent(NetLog::TYPE_SOCKET_ALIVE, params);
 
+#if defined(OS_LINUX)
   if (is_tcp_fastopen_enabled())
     use_tcp_fastopen_ = true;
+#endif
 }
 
 TCPClientSocketLibevent::~TCPClientSocketLibevent() {
@@ -304,7 +318,9 @@ int TCPClientSocketLibevent::DoConnect() {
       return OK;
     }
   } else {
-    // With TCP FastOpen, we pretend that the socket is connected.
+    // With TCP FastOpen, we pretend that the socket is connected.  The
+    // connect happens with the first Write(), or the first Read() if that
+    // comes first.
     DCHECK(!tcp_fastopen_connected_);
     return OK;
   }
@@ -372,6 +388,8 @@ void TCPClientSocketLibevent::DoDisconnect() {
   DCHECK(ok);
   ok = write_socket_watcher_.StopWatchingFileDescriptor();
   DCHECK(ok);
+  keep_read_watch_ = false;
+  keep_write_watch_ = false;
   if (HANDLE_EINTR(close(socket_)) < 0)
     PLOG(ERROR) << "close";
   socket_ = kInvalidSocket;
@@ -436,6 +454,14 @@ int TCPClientSocketLibevent::Read(IOBuffer* buf,
   DCHECK(!callback.is_null());
   DCHECK_GT(buf_len, 0);
 
+  if (use_tcp_fastopen_ && !tcp_fastopen_connected_) {
+    // There is nothing to send with the SYN, so connect plainly.  read()
+    // reports EAGAIN until the connect completes.
+    int os_error = FastOpenFallbackConnect();
+    if (os_error)
+      return MapConnectError(os_error);
+  }
+
   int nread = HANDLE_EINTR(read(socket_, buf->data(), buf_len));
   if (nread >= 0) {
     base::StatsCounter read_bytes("tcp.read_bytes");
@@ -452,11 +478,14 @@ int TCPClientSocketLibevent::Read(IOBuffer* buf,
     return MapSystemError(errno);
   }
 
-  if (!MessageLoopForIO::current()->WatchFileDescriptor(
-          socket_, true, MessageLoopForIO::WATCH_READ,
-          &read_socket_watcher_, &read_watcher_)) {
-    DVLOG(1) << "WatchFileDescriptor failed on read, errno " << errno;
-    return MapSystemError(errno);
+  if (!keep_read_watch_) {
+    if (!MessageLoopForIO::current()->WatchFileDescriptorEdgeTriggered(
+            socket_, MessageLoopForIO::WATCH_READ,
+            &read_socket_watcher_, &read_watcher_)) {
+      DVLOG(1) << "WatchFileDescriptor failed on read, errno " << errno;
+      return MapSystemError(errno);
+    }
+    keep_read_watch_ = MessageLoopForIO::current()->WatchesAreEdgeTriggered();
   }
 
   read_buf_ = buf;
@@ -489,11 +518,15 @@ int TCPClientSocketLibevent::Write(IOBuffer* buf,
   if (errno != EAGAIN && errno != EWOULDBLOCK)
     return MapSystemError(errno);
 
-  if (!MessageLoopForIO::current()->WatchFileDescriptor(
-          socket_, true, MessageLoopForIO::WATCH_WRITE,
-          &write_socket_watcher_, &write_watcher_)) {
-    DVLOG(1) << "WatchFileDescriptor failed on write, errno " << errno;
-    return MapSystemError(errno);
+  if (!keep_write_watch_) {
+    if (!MessageLoopForIO::current()->WatchFileDescriptorEdgeTriggered(
+            socket_, MessageLoopForIO::WATCH_WRITE,
+            &write_socket_watcher_, &write_watcher_)) {
+      DVLOG(1) << "WatchFileDescriptor failed on write, errno " << errno;
+      return MapSystemError(errno);
+    }
+    keep_write_watch_ =
+        MessageLoopForIO::current()->WatchesAreEdgeTriggered();
   }
 
   write_buf_ = buf;
@@ -503,35 +536,63 @@ int TCPClientSocketLibevent::Write(IOBuffer* buf,
 }
 
 int TCPClientSocketLibevent::InternalWrite(IOBuffer* buf, int buf_len) {
-  int nwrite;
   if (use_tcp_fastopen_ && !tcp_fastopen_connected_) {
+#if defined(OS_LINUX)
+    tcp_fastopen_connected_ = true;
+    connect_start_time_ = base::TimeTicks::Now();
     // We have a limited amount of data to send in the SYN packet.
-    int kMaxFastOpenSendLength = 1420;
-
     buf_len = std::min(kMaxFastOpenSendLength, buf_len);
-
-    int flags = 0x20000000;  // Magic flag to enable TCP_FASTOPEN
-    nwrite = HANDLE_EINTR(sendto(socket_,
-                                 buf->data(),
-                                 buf_len,
-                                 flags,
-                                 current_ai_->ai_addr,
-                                 static_cast<int>(current_ai_->ai_addrlen)));
-    tcp_fastopen_connected_ = true;
-
-    if (nwrite < 0) {
-      // Non-blocking mode is returning EINPROGRESS rather than EAGAIN.
-      if (errno == EINPROGRESS)
-         errno = EAGAIN;
-
-      // Unlike "normal" nonblocking sockets, the data is already queued,
-      // so tell the app that we've consumed it.
-      return buf_len;
+    int nwrite = HANDLE_EINTR(sendto(socket_,
+                                     buf->data(),
+                                     buf_len,
+                                     MSG_FASTOPEN,
+                                     current_ai_->ai_addr,
+                                     current_ai_->ai_addrlen));
+    // On success the data is in the SYN, or queued behind it if the kernel
+    // has no Fast Open cookie for the server yet.
+    if (nwrite >= 0)
+      return nwrite;
+    if (errno == EINPROGRESS) {
+      // The SYN went out without data.  Write once the connect completes.
+      errno = EAGAIN;
+      return -1;
     }
-  } else {
-    nwrite = HANDLE_EINTR(write(socket_, buf->data(), buf_len));
+    if (errno != EOPNOTSUPP && errno != EPIPE && errno != ENOTCONN)
+      return -1;
+
+    // The kernel doesn't do Fast Open (older kernels ignore MSG_FASTOPEN
+    // and fail the send on an unconnected socket).  Stop trying, and connect
+    // this socket plainly.
+    DVLOG(1) << "TCP Fast Open unavailable, errno " << errno;
+    set_tcp_fastopen_enabled(false);
+    tcp_fastopen_connected_ = false;
+    int os_error = FastOpenFallbackConnect();
+    if (os_error) {
+      errno = os_error;
+      return -1;
+    }
+#else
+    NOTREACHED();
+#endif
+  }
+  return HANDLE_EINTR(write(socket_, buf->data(), buf_len));
+}
+
+int TCPClientSocketLibevent::FastOpenFallbackConnect() {
+  DCHECK(use_tcp_fastopen_);
+  DCHECK(!tcp_fastopen_connected_);
+  tcp_fastopen_connected_ = true;
+  connect_start_time_ = base::TimeTicks::Now();
+  if (!HANDLE_EINTR(connect(socket_, current_ai_->ai_addr,
+                            static_cast<int>(current_ai_->ai_addrlen)))) {
+    return 0;
+  }
+  // Reads and writes wait for the connect to complete.
+  if (errno == EINPROGRESS) {
+    errno = EAGAIN;
+    return 0;
   }
-  return nwrite;
+  return errno;
 }
 
 bool TCPClientSocketLibevent::SetReceiveBufferSize(int32 size) {
@@ -647,8 +708,10 @@ void TCPClientSocketLibevent::DidCompleteRead() {
   if (result != ERR_IO_PENDING) {
     read_buf_ = NULL;
     read_buf_len_ = 0;
-    bool ok = read_socket_watcher_.StopWatchingFileDescriptor();
-    DCHECK(ok);
+    if (!keep_read_watch_) {
+      bool ok = read_socket_watcher_.StopWatchingFileDescriptor();
+      DCHECK(ok);
+    }
     DoReadCallback(result);
   }
 }
@@ -674,7 +737,8 @@ void TCPClientSocketLibevent::DidCompleteWrite() {
   if (result != ERR_IO_PENDING) {
     write_buf_ = NULL;
     write_buf_len_ = 0;
-    write_socket_watcher_.StopWatchingFileDescriptor();
+    if (!keep_write_watch_)
+      write_socket_watcher_.StopWatchingFileDescriptor();
     DoWriteCallback(result);
   }
 }
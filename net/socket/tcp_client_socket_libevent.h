@@ -142,6 +142,10 @@ class NET_EXPORT_PRIVATE TCPClientSocketLibevent : public StreamSocket,
   // Internal function to write to a socket.
   int InternalWrite(IOBuffer* buf, int buf_len);
 
+  // Connects a TCP Fast Open socket without sending data.  Returns the OS
+  // error code, or 0 if the connect finished or is in progress.
+  int FastOpenFallbackConnect();
+
   int socket_;
 
   // Local IP address and port we are bound to. Set to NULL if Bind()
@@ -165,6 +169,14 @@ class NET_EXPORT_PRIVATE TCPClientSocketLibevent : public StreamSocket,
   ReadWatcher read_watcher_;
   WriteWatcher write_watcher_;
 
+  // True once the read (write) watch has been made on an edge-triggered
+  // pump.  It is then kept until the socket is closed, so a Read() (Write())
+  // that has to wait costs no syscall beyond the read() (write()) itself.
+  // The watchers ignore the notifications that arrive while nothing is
+  // pending; an edge always follows the EAGAIN a later call gets.
+  bool keep_read_watch_;
+  bool keep_write_watch_;
+
   // The buffer used by OnSocketReady to retry Read requests
   scoped_refptr<IOBuffer> read_buf_;
   int read_buf_len_;
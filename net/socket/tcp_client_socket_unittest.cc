@@ -8,6 +8,15 @@
 
 #include "net/socket/tcp_client_socket.h"
 
+#include <string.h>
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/message_loop.h"
+#include "base/message_pump_libevent.h"
+#include "base/threading/thread.h"
+#include "net/base/io_buffer.h"
 #include "net/base/ip_endpoint.h"
 #include "net/base/net_errors.h"
 #include "net/base/net_util.h"
@@ -105,6 +114,155 @@ TEST(TCPClientSocketTest, BindLoopbackToIPv6) {
   EXPECT_NE(OK, result);
 }
 
+#if defined(OS_LINUX)
+
+// Connects a TCP Fast Open socket to a local listener and exchanges
+// |message| both ways, writing first from the client if |client_first|.
+// Works whether or not the kernel supports Fast Open, since the socket falls
+// back to a plain connect.
+void FastOpenExchange(bool client_first) {
+  const char kMessage[] = "hello";
+  const int kMessageLength = strlen(kMessage);
+
+  set_tcp_fastopen_enabled(true);
+
+  IPAddressNumber lo_address;
+  ASSERT_TRUE(ParseIPLiteralToNumber("127.0.0.1", &lo_address));
+  TCPServerSocket server(NULL, NetLog::Source());
+  ASSERT_EQ(OK, server.Listen(IPEndPoint(lo_address, 0), 1));
+  IPEndPoint server_address;
+  ASSERT_EQ(OK, server.GetLocalAddress(&server_address));
+
+  TCPClientSocket socket(
+      AddressList::CreateFromIPAddress(server_address.address(),
+                                       server_address.port()),
+      NULL, NetLog::Source());
+  EXPECT_TRUE(socket.UsingTCPFastOpen());
+
+  // The connect itself is put off until the first read or write.
+  TestCompletionCallback connect_callback;
+  EXPECT_EQ(OK, socket.Connect(connect_callback.callback()));
+  EXPECT_TRUE(socket.IsConnected());
+
+  scoped_refptr<StringIOBuffer> message(
+      new StringIOBuffer(std::string(kMessage)));
+  scoped_refptr<IOBuffer> read_buf(new IOBuffer(kMessageLength));
+  TestCompletionCallback write_callback;
+  TestCompletionCallback read_callback;
+  int read_result = ERR_IO_PENDING;
+  if (client_first) {
+    EXPECT_EQ(kMessageLength, write_callback.GetResult(
+        socket.Write(message, kMessageLength, write_callback.callback())));
+  } else {
+    read_result = socket.Read(read_buf, kMessageLength,
+                              read_callback.callback());
+    EXPECT_EQ(ERR_IO_PENDING, read_result);
+  }
+
+  TestCompletionCallback accept_callback;
+  scoped_ptr<StreamSocket> accepted_socket;
+  ASSERT_EQ(OK, accept_callback.GetResult(
+      server.Accept(&accepted_socket, accept_callback.callback())));
+
+  scoped_refptr<IOBuffer> server_buf(new IOBuffer(kMessageLength));
+  TestCompletionCallback server_callback;
+  if (client_first) {
+    ASSERT_EQ(kMessageLength, server_callback.GetResult(
+        accepted_socket->Read(server_buf, kMessageLength,
+                              server_callback.callback())));
+    EXPECT_EQ(0, memcmp(kMessage, server_buf->data(), kMessageLength));
+  }
+  ASSERT_EQ(kMessageLength, server_callback.GetResult(
+      accepted_socket->Write(message, kMessageLength,
+                             server_callback.callback())));
+
+  if (client_first) {
+    read_result = socket.Read(read_buf, kMessageLength,
+                              read_callback.callback());
+  }
+  ASSERT_EQ(kMessageLength, read_callback.GetResult(read_result));
+  EXPECT_EQ(0, memcmp(kMessage, read_buf->data(), kMessageLength));
+
+  set_tcp_fastopen_enabled(false);
+}
+
+TEST(TCPClientSocketTest, FastOpenWriteFirst) {
+  FastOpenExchange(true);
+}
+
+TEST(TCPClientSocketTest, FastOpenReadFirst) {
+  FastOpenExchange(false);
+}
+
+// Runs on an IO thread with an edge-triggered pump, where the socket keeps
+// its read watch between reads.  Each message is read a byte at a time, so
+// only the first Read() of a message waits; the kept watch must still
+// report the next message.
+void EdgeTriggeredReads() {
+  const char kMessage[] = "hello";
+  const int kMessageLength = strlen(kMessage);
+  MessageLoop::ScopedNestableTaskAllower allow(MessageLoop::current());
+  ASSERT_TRUE(MessageLoopForIO::current()->WatchesAreEdgeTriggered());
+
+  IPAddressNumber lo_address;
+  ASSERT_TRUE(ParseIPLiteralToNumber("127.0.0.1", &lo_address));
+  TCPServerSocket server(NULL, NetLog::Source());
+  ASSERT_EQ(OK, server.Listen(IPEndPoint(lo_address, 0), 1));
+  IPEndPoint server_address;
+  ASSERT_EQ(OK, server.GetLocalAddress(&server_address));
+
+  TCPClientSocket socket(
+      AddressList::CreateFromIPAddress(server_address.address(),
+                                       server_address.port()),
+      NULL, NetLog::Source());
+  TestCompletionCallback connect_callback;
+  int connect_result = socket.Connect(connect_callback.callback());
+  TestCompletionCallback accept_callback;
+  scoped_ptr<StreamSocket> accepted_socket;
+  ASSERT_EQ(OK, accept_callback.GetResult(
+      server.Accept(&accepted_socket, accept_callback.callback())));
+  ASSERT_EQ(OK, connect_callback.GetResult(connect_result));
+
+  scoped_refptr<StringIOBuffer> message(
+      new StringIOBuffer(std::string(kMessage)));
+  scoped_refptr<IOBuffer> read_buf(new IOBuffer(1));
+  for (int round = 0; round < 3; ++round) {
+    TestCompletionCallback read_callback;
+    ASSERT_EQ(ERR_IO_PENDING,
+              socket.Read(read_buf, 1, read_callback.callback()));
+
+    TestCompletionCallback write_callback;
+    ASSERT_EQ(kMessageLength, write_callback.GetResult(
+        accepted_socket->Write(message, kMessageLength,
+                               write_callback.callback())));
+
+    ASSERT_EQ(1, read_callback.WaitForResult());
+    EXPECT_EQ(kMessage[0], read_buf->data()[0]);
+    for (int i = 1; i < kMessageLength; ++i) {
+      ASSERT_EQ(1, socket.Read(read_buf, 1, read_callback.callback()));
+      EXPECT_EQ(kMessage[i], read_buf->data()[0]);
+    }
+  }
+}
+
+TEST(TCPClientSocketTest, EdgeTriggeredReads) {
+  // The thread's MessageLoopForIO picks up the default backend.
+  base::MessagePumpLibevent::SetDefaultBackend(
+      base::MessagePumpLibevent::BACKEND_EPOLL);
+  base::Thread thread("EdgeTriggeredIOThread");
+  bool started = thread.StartWithOptions(
+      base::Thread::Options(MessageLoop::TYPE_IO, 0));
+  base::MessagePumpLibevent::SetDefaultBackend(
+      base::MessagePumpLibevent::BACKEND_LIBEVENT);
+  ASSERT_TRUE(started);
+
+  thread.message_loop()->PostTask(FROM_HERE,
+                                  base::Bind(&EdgeTriggeredReads));
+  thread.Stop();
+}
+
+#endif  // defined(OS_LINUX)
+
 }  // namespace
 
 }  // namespace net
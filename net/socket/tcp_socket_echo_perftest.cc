@@ -0,0 +1,180 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include "base/bind.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/message_pump_libevent.h"
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "net/base/address_list.h"
+#include "net/base/io_buffer.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_errors.h"
+#include "net/base/net_util.h"
+#include "net/base/test_completion_callback.h"
+#include "net/socket/tcp_client_socket.h"
+#include "net/socket/tcp_server_socket.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+const int kRoundTrips = 20000;
+const int kMessageSize = 64;
+
+// Bounces a message between a client and an accepted loopback socket
+// |kRoundTrips| times.  Every round trip is one Write() and one Read() on
+// each socket, and each Read() finds nothing to read and has to wait for the
+// message loop, which is the pattern a request/response protocol produces.
+class EchoDriver {
+ public:
+  EchoDriver(StreamSocket* client, StreamSocket* server)
+      : client_(client),
+        server_(server),
+        message_(new IOBuffer(kMessageSize)),
+        client_buf_(new IOBuffer(kMessageSize)),
+        server_buf_(new IOBuffer(kMessageSize)),
+        round_trips_(0),
+        error_(OK) {
+    memset(message_->data(), 'e', kMessageSize);
+  }
+
+  // Runs the current message loop until every round trip is done.  Returns
+  // a net error code.
+  int Run() {
+    ServerRead();
+    ClientWrite();
+    MessageLoop::current()->Run();
+    return error_;
+  }
+
+ private:
+  void ClientWrite() {
+    int rv = client_->Write(message_, kMessageSize,
+                            base::Bind(&EchoDriver::OnClientWrite,
+                                       base::Unretained(this)));
+    if (rv != ERR_IO_PENDING)
+      OnClientWrite(rv);
+  }
+
+  void OnClientWrite(int rv) {
+    if (!Check(rv))
+      return;
+    ClientRead();
+  }
+
+  void ClientRead() {
+    int rv = client_->Read(client_buf_, kMessageSize,
+                           base::Bind(&EchoDriver::OnClientRead,
+                                      base::Unretained(this)));
+    if (rv != ERR_IO_PENDING)
+      OnClientRead(rv);
+  }
+
+  void OnClientRead(int rv) {
+    if (!Check(rv))
+      return;
+    if (++round_trips_ == kRoundTrips) {
+      MessageLoop::current()->Quit();
+      return;
+    }
+    ClientWrite();
+  }
+
+  void ServerRead() {
+    int rv = server_->Read(server_buf_, kMessageSize,
+                           base::Bind(&EchoDriver::OnServerRead,
+                                      base::Unretained(this)));
+    if (rv != ERR_IO_PENDING)
+      OnServerRead(rv);
+  }
+
+  void OnServerRead(int rv) {
+    if (!Check(rv))
+      return;
+    rv = server_->Write(server_buf_, rv,
+                        base::Bind(&EchoDriver::OnServerWrite,
+                                   base::Unretained(this)));
+    if (rv != ERR_IO_PENDING)
+      OnServerWrite(rv);
+  }
+
+  void OnServerWrite(int rv) {
+    if (!Check(rv))
+      return;
+    ServerRead();
+  }
+
+  // Messages are small enough that loopback never splits them.
+  bool Check(int rv) {
+    if (rv == kMessageSize)
+      return true;
+    error_ = rv < 0 ? rv : ERR_UNEXPECTED;
+    MessageLoop::current()->Quit();
+    return false;
+  }
+
+  StreamSocket* const client_;
+  StreamSocket* const server_;
+  scoped_refptr<IOBuffer> message_;
+  scoped_refptr<IOBuffer> client_buf_;
+  scoped_refptr<IOBuffer> server_buf_;
+  int round_trips_;
+  int error_;
+
+  DISALLOW_COPY_AND_ASSIGN(EchoDriver);
+};
+
+void RunEcho(base::MessagePumpLibevent::Backend backend, const char* name) {
+  // MessageLoopForIO creates its pump with the default backend.
+  base::MessagePumpLibevent::SetDefaultBackend(backend);
+  MessageLoop loop(MessageLoop::TYPE_IO);
+  base::MessagePumpLibevent::SetDefaultBackend(
+      base::MessagePumpLibevent::BACKEND_LIBEVENT);
+
+  IPAddressNumber localhost;
+  ASSERT_TRUE(ParseIPLiteralToNumber("127.0.0.1", &localhost));
+  TCPServerSocket listener(NULL, NetLog::Source());
+  ASSERT_EQ(OK, listener.Listen(IPEndPoint(localhost, 0), 1));
+  IPEndPoint address;
+  ASSERT_EQ(OK, listener.GetLocalAddress(&address));
+
+  TCPClientSocket client(
+      AddressList::CreateFromIPAddress(address.address(), address.port()),
+      NULL, NetLog::Source());
+  TestCompletionCallback connect_callback;
+  int connect_result = client.Connect(connect_callback.callback());
+
+  TestCompletionCallback accept_callback;
+  scoped_ptr<StreamSocket> server;
+  ASSERT_EQ(OK, accept_callback.GetResult(
+      listener.Accept(&server, accept_callback.callback())));
+  ASSERT_EQ(OK, connect_callback.GetResult(connect_result));
+
+  EchoDriver driver(&client, server.get());
+  PerfTimer timer;
+  ASSERT_EQ(OK, driver.Run());
+  double seconds = timer.Elapsed().InSecondsF();
+
+  LogPerfResult(base::StringPrintf("TCPSocketEcho_%s", name).c_str(),
+                kRoundTrips / seconds, "roundtrips/s");
+}
+
+}  // namespace
+
+TEST(TCPSocketEchoPerfTest, Libevent) {
+  RunEcho(base::MessagePumpLibevent::BACKEND_LIBEVENT, "libevent");
+}
+
+#if defined(OS_LINUX)
+TEST(TCPSocketEchoPerfTest, Epoll) {
+  RunEcho(base::MessagePumpLibevent::BACKEND_EPOLL, "epoll");
+}
+#endif
+
+}  // namespace net
@@ -4,6 +4,8 @@
 
 #include "net/socket/transport_client_socket_pool.h"
 
+#include <algorithm>
+
 #include "base/compiler_specific.h"
 #include "base/logging.h"
 #include "base/message_loop.h"
@@ -31,6 +33,12 @@ const int TransportConnectJob::kIPv6FallbackTimerInMs = 300;
 
 namespace {
 
+// Connect racing is off by default.
+int g_connect_race_stagger_ms = 0;
+
+// The largest race winner index recorded separately in histograms.
+const int kMaxRaceWinnerIndex = 8;
+
 bool AddressListStartsWithIPv6AndHasAnIPv4Addr(const AddressList& addrlist) {
   const struct addrinfo* ai = addrlist.head();
   if (ai->ai_family != AF_INET6)
@@ -100,7 +108,11 @@ TransportConnectJob::TransportConnectJob(
       params_(params),
       client_socket_factory_(client_socket_factory),
       resolver_(host_resolver),
-      next_state_(STATE_NONE) {
+      next_state_(STATE_NONE),
+      racing_(false),
+      pending_race_connects_(0),
+      last_race_error_(ERR_FAILED),
+      race_winner_(0) {
 }
 
 TransportConnectJob::~TransportConnectJob() {
@@ -154,6 +166,44 @@ void TransportConnectJob::MakeAddrListStartWithIPv4(AddressList* addrlist) {
   FreeCopyOfAddrinfo(head);
 }
 
+// static
+void TransportConnectJob::GetRaceOrder(const AddressList& addrlist,
+                                       std::vector<AddressList>* race_order) {
+  std::vector<const struct addrinfo*> same_family;
+  std::vector<const struct addrinfo*> other_family;
+  const struct addrinfo* head = addrlist.head();
+  for (const struct addrinfo* ai = head; ai; ai = ai->ai_next) {
+    if (ai->ai_family == head->ai_family)
+      same_family.push_back(ai);
+    else
+      other_family.push_back(ai);
+  }
+
+  race_order->clear();
+  size_t count = std::max(same_family.size(), other_family.size());
+  for (size_t i = 0; i < count; ++i) {
+    if (i < same_family.size()) {
+      race_order->push_back(
+          AddressList::CreateByCopyingFirstAddress(same_family[i]));
+    }
+    if (i < other_family.size()) {
+      race_order->push_back(
+          AddressList::CreateByCopyingFirstAddress(other_family[i]));
+    }
+  }
+}
+
+// static
+void TransportConnectJob::set_connect_race_stagger_ms(int stagger_ms) {
+  DCHECK_GE(stagger_ms, 0);
+  g_connect_race_stagger_ms = stagger_ms;
+}
+
+// static
+int TransportConnectJob::connect_race_stagger_ms() {
+  return g_connect_race_stagger_ms;
+}
+
 void TransportConnectJob::OnIOComplete(int result) {
   int rv = DoLoop(result);
   if (rv != ERR_IO_PENDING)
@@ -208,6 +258,13 @@ int TransportConnectJob::DoResolveHostComplete(int result) {
 
 int TransportConnectJob::DoTransportConnect() {
   next_state_ = STATE_TRANSPORT_CONNECT_COMPLETE;
+  if (g_connect_race_stagger_ms > 0 && addresses_.head()->ai_next) {
+    racing_ = true;
+    GetRaceOrder(addresses_, &race_addresses_);
+    connect_start_time_ = base::TimeTicks::Now();
+    return StartNextRaceConnect();
+  }
+
   transport_socket_.reset(client_socket_factory_->CreateTransportClientSocket(
         addresses_, net_log().net_log(), net_log().source()));
   connect_start_time_ = base::TimeTicks::Now();
@@ -224,7 +281,9 @@ int TransportConnectJob::DoTransportConnect() {
 
 int TransportConnectJob::DoTransportConnectComplete(int result) {
   if (result == OK) {
-    bool is_ipv4 = addresses_.head()->ai_family != AF_INET6;
+    bool is_ipv4 = racing_ ?
+        race_addresses_[race_winner_].head()->ai_family != AF_INET6 :
+        addresses_.head()->ai_family != AF_INET6;
     DCHECK(connect_start_time_ != base::TimeTicks());
     DCHECK(start_time_ != base::TimeTicks());
     base::TimeTicks now = base::TimeTicks::Now();
@@ -243,7 +302,31 @@ int TransportConnectJob::DoTransportConnectComplete(int result) {
         base::TimeDelta::FromMinutes(10),
         100);
 
-    if (is_ipv4) {
+    if (racing_) {
+      // |connect_duration| runs from the first connect of the race.
+      UMA_HISTOGRAM_CUSTOM_TIMES("Net.TCP_Connection_Latency_Race",
+                                 connect_duration,
+                                 base::TimeDelta::FromMilliseconds(1),
+                                 base::TimeDelta::FromMinutes(10),
+                                 100);
+      if (is_ipv4) {
+        UMA_HISTOGRAM_CUSTOM_TIMES("Net.TCP_Connection_Latency_Race_IPv4_Wins",
+                                   connect_duration,
+                                   base::TimeDelta::FromMilliseconds(1),
+                                   base::TimeDelta::FromMinutes(10),
+                                   100);
+      } else {
+        UMA_HISTOGRAM_CUSTOM_TIMES("Net.TCP_Connection_Latency_Race_IPv6_Wins",
+                                   connect_duration,
+                                   base::TimeDelta::FromMilliseconds(1),
+                                   base::TimeDelta::FromMinutes(10),
+                                   100);
+      }
+      UMA_HISTOGRAM_ENUMERATION(
+          "Net.TCP_Connection_Race_Winner",
+          std::min(static_cast<int>(race_winner_), kMaxRaceWinnerIndex),
+          kMaxRaceWinnerIndex + 1);
+    } else if (is_ipv4) {
       UMA_HISTOGRAM_CUSTOM_TIMES("Net.TCP_Connection_Latency_IPv4_No_Race",
                                  connect_duration,
                                  base::TimeDelta::FromMilliseconds(1),
@@ -266,6 +349,9 @@ int TransportConnectJob::DoTransportConnectComplete(int result) {
     }
     set_socket(transport_socket_.release());
     fallback_timer_.Stop();
+  } else if (racing_) {
+    race_timer_.Stop();
+    race_sockets_.reset();
   } else {
     // Be a bit paranoid and kill off the fallback members to prevent reuse.
     fallback_transport_socket_.reset();
@@ -346,6 +432,71 @@ void TransportConnectJob::DoIPv6FallbackTransportConnectComplete(int result) {
   NotifyDelegateOfCompletion(result);  // Deletes |this|
 }
 
+int TransportConnectJob::StartNextRaceConnect() {
+  DCHECK(racing_);
+  while (race_sockets_.size() < race_addresses_.size()) {
+    size_t index = race_sockets_.size();
+    race_sockets_.push_back(
+        client_socket_factory_->CreateTransportClientSocket(
+            race_addresses_[index], net_log().net_log(), net_log().source()));
+    int rv = race_sockets_[index]->Connect(
+        base::Bind(&TransportConnectJob::OnRaceConnectComplete,
+                   base::Unretained(this), index));
+    if (rv == OK) {
+      FinishRace(index);
+      return OK;
+    }
+    if (rv == ERR_IO_PENDING) {
+      ++pending_race_connects_;
+      if (race_sockets_.size() < race_addresses_.size()) {
+        race_timer_.Start(FROM_HERE,
+            base::TimeDelta::FromMilliseconds(g_connect_race_stagger_ms),
+            this, &TransportConnectJob::OnRaceTimer);
+      }
+      return ERR_IO_PENDING;
+    }
+    // Failed right away; go straight on to the next address.
+    last_race_error_ = rv;
+  }
+  return pending_race_connects_ > 0 ? ERR_IO_PENDING : last_race_error_;
+}
+
+void TransportConnectJob::OnRaceTimer() {
+  DCHECK_EQ(STATE_TRANSPORT_CONNECT_COMPLETE, next_state_);
+  int rv = StartNextRaceConnect();
+  if (rv != ERR_IO_PENDING)
+    OnIOComplete(rv);  // Deletes |this|
+}
+
+void TransportConnectJob::OnRaceConnectComplete(size_t index, int result) {
+  DCHECK_EQ(STATE_TRANSPORT_CONNECT_COMPLETE, next_state_);
+  DCHECK_NE(ERR_IO_PENDING, result);
+  --pending_race_connects_;
+  if (result == OK) {
+    FinishRace(index);
+    OnIOComplete(OK);  // Deletes |this|
+    return;
+  }
+
+  // A failed connect makes way for the next one without waiting out the
+  // stagger.
+  last_race_error_ = result;
+  race_timer_.Stop();
+  int rv = StartNextRaceConnect();
+  if (rv != ERR_IO_PENDING)
+    OnIOComplete(rv);  // Deletes |this|
+}
+
+void TransportConnectJob::FinishRace(size_t index) {
+  race_timer_.Stop();
+  race_winner_ = index;
+  transport_socket_.reset(race_sockets_[index]);
+  race_sockets_[index] = NULL;
+  // Destroying the other sockets cancels their connects.
+  race_sockets_.reset();
+  pending_race_connects_ = 0;
+}
+
 int TransportConnectJob::ConnectInternal() {
   next_state_ = STATE_RESOLVE_HOST;
   start_time_ = base::TimeTicks::Now();
@@ -7,10 +7,12 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "base/basictypes.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/memory/scoped_vector.h"
 #include "base/time.h"
 #include "base/timer.h"
 #include "net/base/host_port_pair.h"
@@ -55,6 +57,11 @@ class NET_EXPORT_PRIVATE TransportSocketParams
 // (kIPv6FallbackTimerInMs) and start a connect() to a IPv4 address if the timer
 // fires. Then we race the IPv4 connect() against the IPv6 connect() (which has
 // a headstart) and return the one that completes first to the socket pool.
+//
+// When connect racing is enabled (see set_connect_race_stagger_ms()), the
+// fallback timer is replaced by a race across every resolved address: a
+// connect to each address is started in turn, a stagger apart, and the first
+// one to complete wins.
 class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
  public:
   TransportConnectJob(const std::string& group_name,
@@ -76,6 +83,19 @@ class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
   // hack.  It is a public method for the unit tests.
   static void MakeAddrListStartWithIPv4(AddressList* addrlist);
 
+  // Splits |addrlist| into single-address lists in the order they are raced:
+  // alternating address families, starting with the family of the first
+  // address, and otherwise in resolver order.  Public for the unit tests.
+  static void GetRaceOrder(const AddressList& addrlist,
+                           std::vector<AddressList>* race_order);
+
+  // Enables connect racing.  A connect to the next address starts
+  // |stagger_ms| after the previous one, or as soon as a started connect
+  // fails.  The losing connects are cancelled when one succeeds.  0, the
+  // default, disables racing.
+  static void set_connect_race_stagger_ms(int stagger_ms);
+  static int connect_race_stagger_ms();
+
   static const int kIPv6FallbackTimerInMs;
 
  private:
@@ -101,6 +121,16 @@ class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
   void DoIPv6FallbackTransportConnect();
   void DoIPv6FallbackTransportConnectComplete(int result);
 
+  // Connect racing.  StartNextRaceConnect() starts connects until one is
+  // pending or the addresses run out.  It returns OK if one connected
+  // synchronously, ERR_IO_PENDING while any connect is pending, and
+  // otherwise the last connect's error.
+  int StartNextRaceConnect();
+  void OnRaceTimer();
+  void OnRaceConnectComplete(size_t index, int result);
+  // Makes the connect to |race_addresses_[index]| the winner.
+  void FinishRace(size_t index);
+
   // Begins the host resolution and the TCP connect.  Returns OK on success
   // and ERR_IO_PENDING if it cannot immediately service the request.
   // Otherwise, it returns a net error code.
@@ -125,6 +155,16 @@ class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
   base::TimeTicks fallback_connect_start_time_;
   base::OneShotTimer<TransportConnectJob> fallback_timer_;
 
+  // Connect racing state.  |race_sockets_| has an entry per started connect;
+  // failed connects keep theirs until the job is done.
+  bool racing_;
+  std::vector<AddressList> race_addresses_;
+  ScopedVector<StreamSocket> race_sockets_;
+  int pending_race_connects_;
+  int last_race_error_;
+  size_t race_winner_;
+  base::OneShotTimer<TransportConnectJob> race_timer_;
+
   DISALLOW_COPY_AND_ASSIGN(TransportConnectJob);
 };
 
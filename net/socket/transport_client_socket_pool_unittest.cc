@@ -389,6 +389,7 @@ class TransportClientSocketPoolTest : public testing::Test {
   ~TransportClientSocketPoolTest() {
     internal::ClientSocketPoolBaseHelper::set_connect_backup_jobs_enabled(
         connect_backup_jobs_enabled_);
+    TransportConnectJob::set_connect_race_stagger_ms(0);
   }
 
   int StartRequest(const std::string& group_name, RequestPriority priority) {
@@ -506,6 +507,37 @@ TEST(TransportConnectJobTest, MakeAddrListStartWithIPv4) {
   EXPECT_TRUE(ai->ai_next == NULL);
 }
 
+TEST(TransportConnectJobTest, GetRaceOrder) {
+  IPAddressNumber ip_number;
+  ASSERT_TRUE(ParseIPLiteralToNumber("2001:4860:b006::64", &ip_number));
+  AddressList addrlist = AddressList::CreateFromIPAddress(ip_number, 80);
+  ASSERT_TRUE(ParseIPLiteralToNumber("2001:4860:b006::66", &ip_number));
+  addrlist.Append(AddressList::CreateFromIPAddress(ip_number, 80).head());
+  ASSERT_TRUE(ParseIPLiteralToNumber("2001:4860:b006::68", &ip_number));
+  addrlist.Append(AddressList::CreateFromIPAddress(ip_number, 80).head());
+  ASSERT_TRUE(ParseIPLiteralToNumber("192.168.1.1", &ip_number));
+  addrlist.Append(AddressList::CreateFromIPAddress(ip_number, 80).head());
+  ASSERT_TRUE(ParseIPLiteralToNumber("192.168.1.2", &ip_number));
+  addrlist.Append(AddressList::CreateFromIPAddress(ip_number, 80).head());
+
+  // Families alternate, starting with the first address's, and each family
+  // keeps its own order.
+  std::vector<AddressList> race_order;
+  TransportConnectJob::GetRaceOrder(addrlist, &race_order);
+  ASSERT_EQ(5u, race_order.size());
+  const char* const kExpected[] = {
+    "[2001:4860:b006::64]:80",
+    "192.168.1.1:80",
+    "[2001:4860:b006::66]:80",
+    "192.168.1.2:80",
+    "[2001:4860:b006::68]:80",
+  };
+  for (size_t i = 0; i < race_order.size(); ++i) {
+    EXPECT_TRUE(race_order[i].head()->ai_next == NULL);
+    EXPECT_EQ(kExpected[i], NetAddressToStringWithPort(race_order[i].head()));
+  }
+}
+
 TEST_F(TransportClientSocketPoolTest, Basic) {
   TestCompletionCallback callback;
   ClientSocketHandle handle;
@@ -1261,6 +1293,102 @@ TEST_F(TransportClientSocketPoolTest, IPv4HasNoFallback) {
   EXPECT_EQ(1, client_socket_factory_.allocation_count());
 }
 
+// With racing on, a stalled first address loses to the second one, which
+// starts after the stagger.
+TEST_F(TransportClientSocketPoolTest, RaceSecondAddressWins) {
+  ClientSocketPoolBaseHelper::set_connect_backup_jobs_enabled(false);
+  TransportConnectJob::set_connect_race_stagger_ms(10);
+  TransportClientSocketPool pool(kMaxSockets,
+                                 kMaxSocketsPerGroup,
+                                 histograms_.get(),
+                                 host_resolver_.get(),
+                                 &client_socket_factory_,
+                                 NULL);
+
+  MockClientSocketFactory::ClientSocketType case_types[] = {
+    MockClientSocketFactory::MOCK_STALLED_CLIENT_SOCKET,
+    MockClientSocketFactory::MOCK_PENDING_CLIENT_SOCKET,
+  };
+  client_socket_factory_.set_client_socket_types(case_types, 2);
+
+  // Two IPv4 addresses, so only racing (not the IPv6 fallback) can help.
+  host_resolver_->rules()->AddIPLiteralRule("*", "1.1.1.1,2.2.2.2", "");
+
+  TestCompletionCallback callback;
+  ClientSocketHandle handle;
+  int rv = handle.Init("a", low_params_, LOW, callback.callback(), &pool,
+                       BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+
+  EXPECT_EQ(OK, callback.WaitForResult());
+  EXPECT_TRUE(handle.is_initialized());
+  EXPECT_TRUE(handle.socket());
+  EXPECT_EQ(2, client_socket_factory_.allocation_count());
+}
+
+// A connect that fails starts the next one without waiting for the stagger.
+TEST_F(TransportClientSocketPoolTest, RaceFailureStartsNextAddress) {
+  ClientSocketPoolBaseHelper::set_connect_backup_jobs_enabled(false);
+  // Long enough that the test would time out waiting for it.
+  TransportConnectJob::set_connect_race_stagger_ms(1000000);
+  TransportClientSocketPool pool(kMaxSockets,
+                                 kMaxSocketsPerGroup,
+                                 histograms_.get(),
+                                 host_resolver_.get(),
+                                 &client_socket_factory_,
+                                 NULL);
+
+  MockClientSocketFactory::ClientSocketType case_types[] = {
+    MockClientSocketFactory::MOCK_PENDING_FAILING_CLIENT_SOCKET,
+    MockClientSocketFactory::MOCK_FAILING_CLIENT_SOCKET,
+    MockClientSocketFactory::MOCK_PENDING_CLIENT_SOCKET,
+  };
+  client_socket_factory_.set_client_socket_types(case_types, 3);
+
+  // The IPv4 address is raced second, the second IPv6 address third.
+  host_resolver_->rules()->AddIPLiteralRule(
+      "*", "2:abcd::3:4:ff,3:abcd::3:4:ff,2.2.2.2", "");
+
+  TestCompletionCallback callback;
+  ClientSocketHandle handle;
+  int rv = handle.Init("a", low_params_, LOW, callback.callback(), &pool,
+                       BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+
+  EXPECT_EQ(OK, callback.WaitForResult());
+  EXPECT_TRUE(handle.socket());
+  IPEndPoint endpoint;
+  handle.socket()->GetLocalAddress(&endpoint);
+  EXPECT_EQ(kIPv6AddressSize, endpoint.address().size());
+  EXPECT_EQ(3, client_socket_factory_.allocation_count());
+}
+
+TEST_F(TransportClientSocketPoolTest, RaceAllAddressesFail) {
+  ClientSocketPoolBaseHelper::set_connect_backup_jobs_enabled(false);
+  TransportConnectJob::set_connect_race_stagger_ms(10);
+  TransportClientSocketPool pool(kMaxSockets,
+                                 kMaxSocketsPerGroup,
+                                 histograms_.get(),
+                                 host_resolver_.get(),
+                                 &client_socket_factory_,
+                                 NULL);
+
+  client_socket_factory_.set_client_socket_type(
+      MockClientSocketFactory::MOCK_PENDING_FAILING_CLIENT_SOCKET);
+  host_resolver_->rules()->AddIPLiteralRule(
+      "*", "2:abcd::3:4:ff,2.2.2.2,3.3.3.3", "");
+
+  TestCompletionCallback callback;
+  ClientSocketHandle handle;
+  int rv = handle.Init("a", low_params_, LOW, callback.callback(), &pool,
+                       BoundNetLog());
+  EXPECT_EQ(ERR_IO_PENDING, rv);
+
+  EXPECT_EQ(ERR_CONNECTION_FAILED, callback.WaitForResult());
+  EXPECT_FALSE(handle.socket());
+  EXPECT_EQ(3, client_socket_factory_.allocation_count());
+}
+
 }  // namespace
 
 }  // namespace net
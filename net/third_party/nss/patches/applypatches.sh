@@ -32,3 +32,5 @@ patch -p6 < $patches_dir/getrequestedclientcerttypes.patch
 patch -p6 < $patches_dir/restartclientauth.patch
 
 patch -p6 < $patches_dir/encryptedclientcerts.patch
+
+patch -p6 < $patches_dir/sessionexport.patch
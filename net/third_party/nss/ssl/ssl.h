@@ -941,6 +941,29 @@ SSL_IMPORT SECStatus SSL_HandshakeNegotiatedExtension(PRFileDesc * socket,
 SSL_IMPORT SECStatus SSL_HandshakeResumedSession(PRFileDesc *fd,
                                                  PRBool *last_handshake_resumed);
 
+/*
+** Serializes the client session that was established or resumed by the last
+** handshake on |fd|, including its master secret and any session ticket, into
+** |out|.  The caller must free |out->data| with SECITEM_FreeItem(out,
+** PR_FALSE).  Fails with SSL_ERROR_SESSION_NOT_FOUND if the session can't be
+** resumed, or if it used a client certificate.
+**
+** The output contains the session's master secret in the clear; the caller is
+** responsible for protecting it.
+*/
+SSL_IMPORT SECStatus SSL_ExportClientSessionID(PRFileDesc *fd, SECItem *out);
+
+/*
+** Adds a session from SSL_ExportClientSessionID to the client session cache,
+** so that the next handshake on |fd| will try to resume it.  Must be called
+** after the peer address, peer ID and URL of |fd| are set and before the
+** handshake.  |*imported| is set to PR_FALSE if the session has expired or
+** the cache already holds a session for this peer.
+*/
+SSL_IMPORT SECStatus SSL_ImportClientSessionID(PRFileDesc *fd,
+                                               const SECItem *data,
+                                               PRBool *imported);
+
 /*
  * Return a boolean that indicates whether the underlying library
  * will perform as the caller expects.
@@ -40,6 +40,7 @@
 
 #include "cert.h"
 #include "pk11pub.h"
+#include "secmod.h"
 #include "secitem.h"
 #include "ssl.h"
 #include "nss.h"
@@ -535,3 +536,408 @@ ssl3_SetSIDSessionTicket(sslSessionID *sid, NewSessionTicket *session_ticket)
     UNLOCK_CACHE;
     return SECSuccess;
 }
+
+/*
+** Client session export and import, so that an application can keep
+** resumable sessions across restarts.
+*/
+
+#define SSL_SESSION_EXPORT_VERSION 1
+
+static SECStatus
+ssl_AppendSessionNumber(sslBuffer *b, PRUint32 num, unsigned int bytes)
+{
+    unsigned char buf[4];
+    unsigned int i;
+
+    PORT_Assert(bytes <= sizeof(buf));
+    for (i = 0; i < bytes; i++)
+	buf[i] = (unsigned char)(num >> (8 * (bytes - 1 - i)));
+    return sslBuffer_Append(b, buf, bytes);
+}
+
+static SECStatus
+ssl_AppendSessionItem(sslBuffer *b, const unsigned char *data,
+		      unsigned int len)
+{
+    if (ssl_AppendSessionNumber(b, len, 4) != SECSuccess)
+	return SECFailure;
+    return len ? sslBuffer_Append(b, data, len) : SECSuccess;
+}
+
+static SECStatus
+ssl_ReadSessionNumber(SECItem *in, PRUint32 *num, unsigned int bytes)
+{
+    unsigned int i;
+
+    if (in->len < bytes)
+	return SECFailure;
+    *num = 0;
+    for (i = 0; i < bytes; i++)
+	*num = (*num << 8) | in->data[i];
+    in->data += bytes;
+    in->len -= bytes;
+    return SECSuccess;
+}
+
+/* Sets |out| to point at the next item in |in|; nothing is copied. */
+static SECStatus
+ssl_ReadSessionItem(SECItem *in, SECItem *out)
+{
+    PRUint32 len;
+
+    if (ssl_ReadSessionNumber(in, &len, 4) != SECSuccess || in->len < len)
+	return SECFailure;
+    out->type = siBuffer;
+    out->data = in->data;
+    out->len = len;
+    in->data += len;
+    in->len -= len;
+    return SECSuccess;
+}
+
+/* Copies the master secret of |sid| into |out|, unwrapping it if needed. */
+static SECStatus
+ssl_GetSIDMasterSecret(sslSessionID *sid, void *pwArg,
+		       unsigned char *out, unsigned int *outLen)
+{
+    PK11SlotInfo *slot;
+    PK11SymKey *  wrapKey;
+    PK11SymKey *  masterSecret;
+    SECItem       wrappedMS;
+    SECItem *     raw;
+    SECStatus     rv = SECFailure;
+
+    if (!sid->u.ssl3.keys.msIsWrapped) {
+	if (sid->u.ssl3.keys.wrapped_master_secret_len >
+	    SSL3_MASTER_SECRET_LENGTH)
+	    return SECFailure;
+	PORT_Memcpy(out, sid->u.ssl3.keys.wrapped_master_secret,
+		    sid->u.ssl3.keys.wrapped_master_secret_len);
+	*outLen = sid->u.ssl3.keys.wrapped_master_secret_len;
+	return SECSuccess;
+    }
+
+    slot = SECMOD_LookupSlot(sid->u.ssl3.masterModuleID,
+			     sid->u.ssl3.masterSlotID);
+    if (slot == NULL)
+	return SECFailure;
+    wrapKey = PK11_GetWrapKey(slot, sid->u.ssl3.masterWrapIndex,
+			      sid->u.ssl3.masterWrapMech,
+			      sid->u.ssl3.masterWrapSeries, pwArg);
+    PK11_FreeSlot(slot);
+    if (wrapKey == NULL)
+	return SECFailure;
+
+    wrappedMS.type = siBuffer;
+    wrappedMS.data = sid->u.ssl3.keys.wrapped_master_secret;
+    wrappedMS.len  = sid->u.ssl3.keys.wrapped_master_secret_len;
+    masterSecret = PK11_UnwrapSymKey(wrapKey, sid->u.ssl3.masterWrapMech,
+				     NULL, &wrappedMS,
+				     CKM_SSL3_MASTER_KEY_DERIVE, CKA_DERIVE,
+				     SSL3_MASTER_SECRET_LENGTH);
+    PK11_FreeSymKey(wrapKey);
+    if (masterSecret == NULL)
+	return SECFailure;
+
+    if (PK11_ExtractKeyValue(masterSecret) == SECSuccess) {
+	raw = PK11_GetKeyData(masterSecret);
+	if (raw && raw->len <= SSL3_MASTER_SECRET_LENGTH) {
+	    PORT_Memcpy(out, raw->data, raw->len);
+	    *outLen = raw->len;
+	    rv = SECSuccess;
+	}
+    }
+    PK11_FreeSymKey(masterSecret);
+    return rv;
+}
+
+SECStatus
+SSL_ExportClientSessionID(PRFileDesc *fd, SECItem *out)
+{
+    sslSocket *    ss = ssl_FindSocket(fd);
+    sslSessionID * sid;
+    sslBuffer      b;
+    unsigned char  masterSecret[SSL3_MASTER_SECRET_LENGTH];
+    unsigned int   masterSecretLen = 0;
+    unsigned int   numCerts;
+    unsigned int   i;
+    SECStatus      rv = SECSuccess;
+
+    if (!ss || !out) {
+	PORT_SetError(SEC_ERROR_INVALID_ARGS);
+	return SECFailure;
+    }
+    sid = ss->sec.ci.sid;
+    /* Sessions that used a client certificate aren't exported, since the
+     * certificate and key may not be available when the session is restored.
+     */
+    if (ss->sec.isServer || !sid || sid->version < SSL_LIBRARY_VERSION_3_0 ||
+	!sid->u.ssl3.keys.resumable || !sid->u.ssl3.masterValid ||
+	!sid->peerCert || sid->localCert) {
+	PORT_SetError(SSL_ERROR_SESSION_NOT_FOUND);
+	return SECFailure;
+    }
+
+    if (ssl_GetSIDMasterSecret(sid, ss->pkcs11PinArg, masterSecret,
+			       &masterSecretLen) != SECSuccess) {
+	PORT_SetError(SSL_ERROR_SESSION_NOT_FOUND);
+	return SECFailure;
+    }
+
+    PORT_Memset(&b, 0, sizeof(b));
+
+    /* The ticket may be replaced while the sid is in the cache. */
+    LOCK_CACHE;
+    rv |= ssl_AppendSessionNumber(&b, SSL_SESSION_EXPORT_VERSION, 4);
+    rv |= ssl_AppendSessionNumber(&b, sid->version, 2);
+    rv |= ssl_AppendSessionNumber(&b, sid->u.ssl3.cipherSuite, 2);
+    rv |= ssl_AppendSessionNumber(&b, sid->u.ssl3.compression, 1);
+    rv |= ssl_AppendSessionNumber(&b, sid->u.ssl3.policy, 4);
+    rv |= ssl_AppendSessionNumber(&b, sid->u.ssl3.exchKeyType, 4);
+#ifdef NSS_ENABLE_ECC
+    rv |= ssl_AppendSessionNumber(&b, sid->u.ssl3.negotiatedECCurves, 4);
+#else
+    rv |= ssl_AppendSessionNumber(&b, 0, 4);
+#endif
+    rv |= ssl_AppendSessionNumber(&b, sid->authAlgorithm, 4);
+    rv |= ssl_AppendSessionNumber(&b, sid->authKeyBits, 4);
+    rv |= ssl_AppendSessionNumber(&b, sid->keaType, 4);
+    rv |= ssl_AppendSessionNumber(&b, sid->keaKeyBits, 4);
+    rv |= ssl_AppendSessionNumber(&b, sid->creationTime, 4);
+    rv |= ssl_AppendSessionNumber(&b, sid->expirationTime, 4);
+    rv |= ssl_AppendSessionItem(&b, sid->u.ssl3.sessionID,
+				sid->u.ssl3.sessionIDLength);
+    rv |= ssl_AppendSessionItem(&b, masterSecret, masterSecretLen);
+    rv |= ssl_AppendSessionNumber(
+	&b, sid->u.ssl3.sessionTicket.received_timestamp, 4);
+    rv |= ssl_AppendSessionNumber(
+	&b, sid->u.ssl3.sessionTicket.ticket_lifetime_hint, 4);
+    rv |= ssl_AppendSessionItem(&b, sid->u.ssl3.sessionTicket.ticket.data,
+				sid->u.ssl3.sessionTicket.ticket.len);
+    rv |= ssl_AppendSessionItem(&b, sid->u.ssl3.srvName.data,
+				sid->u.ssl3.srvName.len);
+    /* The leaf certificate, then the rest of the chain. */
+    for (numCerts = 0; numCerts < MAX_PEER_CERT_CHAIN_SIZE &&
+	 sid->peerCertChain[numCerts]; numCerts++) {
+    }
+    rv |= ssl_AppendSessionNumber(&b, numCerts + 1, 1);
+    rv |= ssl_AppendSessionItem(&b, sid->peerCert->derCert.data,
+				sid->peerCert->derCert.len);
+    for (i = 0; i < numCerts; i++) {
+	rv |= ssl_AppendSessionItem(&b, sid->peerCertChain[i]->derCert.data,
+				    sid->peerCertChain[i]->derCert.len);
+    }
+    UNLOCK_CACHE;
+
+    PORT_Memset(masterSecret, 0, sizeof(masterSecret));
+    if (rv != SECSuccess) {
+	if (b.buf) {
+	    PORT_ZFree(b.buf, b.space);
+	}
+	PORT_SetError(SEC_ERROR_NO_MEMORY);
+	return SECFailure;
+    }
+
+    out->type = siBuffer;
+    out->data = b.buf;
+    out->len = b.len;
+    return SECSuccess;
+}
+
+/* Reads the session in |data| into a new, uncached sid. */
+static sslSessionID *
+ssl_ParseClientSessionID(const SECItem *data)
+{
+    sslSessionID * sid;
+    SECItem        in = *data;
+    SECItem        item;
+    PRUint32       num;
+    PRUint32       numCerts;
+    PRUint32       i;
+    CERTCertificate *cert;
+
+    if (ssl_ReadSessionNumber(&in, &num, 4) != SECSuccess ||
+	num != SSL_SESSION_EXPORT_VERSION)
+	return NULL;
+
+    sid = PORT_ZNew(sslSessionID);
+    if (sid == NULL)
+	return NULL;
+    sid->references = 1;
+    sid->cached = never_cached;
+
+    if (ssl_ReadSessionNumber(&in, &num, 2) != SECSuccess ||
+	num < SSL_LIBRARY_VERSION_3_0)
+	goto loser;
+    sid->version = (SSL3ProtocolVersion)num;
+    if (ssl_ReadSessionNumber(&in, &num, 2) != SECSuccess)
+	goto loser;
+    sid->u.ssl3.cipherSuite = (ssl3CipherSuite)num;
+    if (ssl_ReadSessionNumber(&in, &num, 1) != SECSuccess)
+	goto loser;
+    sid->u.ssl3.compression = (SSLCompressionMethod)num;
+    if (ssl_ReadSessionNumber(&in, &num, 4) != SECSuccess)
+	goto loser;
+    sid->u.ssl3.policy = (int)num;
+    if (ssl_ReadSessionNumber(&in, &num, 4) != SECSuccess)
+	goto loser;
+    sid->u.ssl3.exchKeyType = (SSL3KEAType)num;
+    if (ssl_ReadSessionNumber(&in, &num, 4) != SECSuccess)
+	goto loser;
+#ifdef NSS_ENABLE_ECC
+    sid->u.ssl3.negotiatedECCurves = num;
+#endif
+    if (ssl_ReadSessionNumber(&in, &num, 4) != SECSuccess)
+	goto loser;
+    sid->authAlgorithm = (SSLSignType)num;
+    if (ssl_ReadSessionNumber(&in, &sid->authKeyBits, 4) != SECSuccess)
+	goto loser;
+    if (ssl_ReadSessionNumber(&in, &num, 4) != SECSuccess)
+	goto loser;
+    sid->keaType = (SSLKEAType)num;
+    if (ssl_ReadSessionNumber(&in, &sid->keaKeyBits, 4) != SECSuccess ||
+	ssl_ReadSessionNumber(&in, &sid->creationTime, 4) != SECSuccess ||
+	ssl_ReadSessionNumber(&in, &sid->expirationTime, 4) != SECSuccess)
+	goto loser;
+
+    if (ssl_ReadSessionItem(&in, &item) != SECSuccess ||
+	item.len > SSL3_SESSIONID_BYTES)
+	goto loser;
+    PORT_Memcpy(sid->u.ssl3.sessionID, item.data, item.len);
+    sid->u.ssl3.sessionIDLength = (uint8)item.len;
+
+    /* The master secret is kept unwrapped, as for a PKCS #11 bypass session;
+     * ssl3_InitPendingCipherSpec imports it into the internal slot.
+     */
+    if (ssl_ReadSessionItem(&in, &item) != SECSuccess ||
+	item.len != SSL3_MASTER_SECRET_LENGTH)
+	goto loser;
+    PORT_Memcpy(sid->u.ssl3.keys.wrapped_master_secret, item.data, item.len);
+    sid->u.ssl3.keys.wrapped_master_secret_len = (PRUint16)item.len;
+    sid->u.ssl3.keys.msIsWrapped = PR_FALSE;
+    sid->u.ssl3.keys.resumable = PR_TRUE;
+    sid->u.ssl3.masterValid = PR_TRUE;
+
+    if (ssl_ReadSessionNumber(
+	    &in, &sid->u.ssl3.sessionTicket.received_timestamp, 4) !=
+	    SECSuccess ||
+	ssl_ReadSessionNumber(
+	    &in, &sid->u.ssl3.sessionTicket.ticket_lifetime_hint, 4) !=
+	    SECSuccess ||
+	ssl_ReadSessionItem(&in, &item) != SECSuccess)
+	goto loser;
+    if (item.len &&
+	SECITEM_CopyItem(NULL, &sid->u.ssl3.sessionTicket.ticket, &item) !=
+	    SECSuccess)
+	goto loser;
+
+    if (ssl_ReadSessionItem(&in, &item) != SECSuccess)
+	goto loser;
+    if (item.len &&
+	SECITEM_CopyItem(NULL, &sid->u.ssl3.srvName, &item) != SECSuccess)
+	goto loser;
+
+    if (ssl_ReadSessionNumber(&in, &numCerts, 1) != SECSuccess ||
+	numCerts < 1 || numCerts > MAX_PEER_CERT_CHAIN_SIZE + 1)
+	goto loser;
+    for (i = 0; i < numCerts; i++) {
+	if (ssl_ReadSessionItem(&in, &item) != SECSuccess)
+	    goto loser;
+	cert = CERT_NewTempCertificate(CERT_GetDefaultCertDB(), &item,
+				       NULL, PR_FALSE, PR_TRUE);
+	if (cert == NULL)
+	    goto loser;
+	if (i == 0)
+	    sid->peerCert = cert;
+	else
+	    sid->peerCertChain[i - 1] = cert;
+    }
+
+    if (in.len != 0)
+	goto loser;
+    return sid;
+
+loser:
+    ssl_FreeSID(sid);
+    return NULL;
+}
+
+SECStatus
+SSL_ImportClientSessionID(PRFileDesc *fd, const SECItem *data,
+			  PRBool *imported)
+{
+    sslSocket *    ss = ssl_FindSocket(fd);
+    sslSessionID * sid;
+    sslSessionID * existing;
+    PRFileDesc *   osfd;
+    PRNetAddr      peer;
+    PRIPv6Addr     addr;
+    PRUint16       port;
+
+    if (!ss || !data || !imported) {
+	PORT_SetError(SEC_ERROR_INVALID_ARGS);
+	return SECFailure;
+    }
+    *imported = PR_FALSE;
+    if (ss->sec.isServer || ss->opt.noCache || !ss->url) {
+	PORT_SetError(SEC_ERROR_INVALID_ARGS);
+	return SECFailure;
+    }
+
+    /* Key the session the way ssl3_SendClientHello will look it up.  This
+     * reads the peer address directly, since ssl_GetPeerInfo would mark the
+     * socket as connected.
+     */
+    osfd = ss->fd->lower;
+    PORT_Memset(&peer, 0, sizeof(peer));
+    if (osfd->methods->getpeername(osfd, &peer) != PR_SUCCESS)
+	return SECFailure;
+    if (peer.inet.family == PR_AF_INET) {
+	PR_ConvertIPv4AddrToIPv6(peer.inet.ip, &addr);
+	port = peer.inet.port;
+    } else if (peer.ipv6.family == PR_AF_INET6) {
+	addr = peer.ipv6.ip;
+	port = peer.ipv6.port;
+    } else {
+	PORT_SetError(PR_ADDRESS_NOT_SUPPORTED_ERROR);
+	return SECFailure;
+    }
+
+    sid = ssl_ParseClientSessionID(data);
+    if (sid == NULL) {
+	PORT_SetError(SEC_ERROR_BAD_DATA);
+	return SECFailure;
+    }
+    if (sid->expirationTime < ssl_Time()) {
+	ssl_FreeSID(sid);
+	return SECSuccess;
+    }
+
+    /* Don't shadow a session that this process already has. */
+    existing = ssl_LookupSID(&addr, port, ss->peerID, ss->url);
+    if (existing) {
+	ssl_FreeSID(existing);
+	ssl_FreeSID(sid);
+	return SECSuccess;
+    }
+
+    sid->addr = addr;
+    sid->port = port;
+    sid->lastAccessTime = ssl_Time();
+    if (ss->peerID) {
+	sid->peerID = PORT_Strdup(ss->peerID);
+    }
+    sid->urlSvrName = PORT_Strdup(ss->url);
+    if ((ss->peerID && !sid->peerID) || !sid->urlSvrName) {
+	ssl_FreeSID(sid);
+	PORT_SetError(SEC_ERROR_NO_MEMORY);
+	return SECFailure;
+    }
+
+    CacheSID(sid);
+    /* The cache holds the only remaining reference. */
+    ssl_FreeSID(sid);
+    *imported = PR_TRUE;
+    return SECSuccess;
+}
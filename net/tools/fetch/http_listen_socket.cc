@@ -1,4 +1,4 @@
-// Copyright (c) 2011 The Chromium Authors. All rights reserved.
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
@@ -29,11 +29,13 @@ void HttpListenSocket::Listen() {
 }
 
 void HttpListenSocket::Accept() {
-  SOCKET conn = net::ListenSocket::Accept(socket_);
-  DCHECK_NE(conn, net::ListenSocket::kInvalidSocket);
-  if (conn == net::ListenSocket::kInvalidSocket) {
-    // TODO
-  } else {
+  // Like net::ListenSocket::Accept(), empty the backlog.
+  for (;;) {
+    SOCKET conn = net::ListenSocket::Accept(socket_);
+    if (conn == net::ListenSocket::kInvalidSocket) {
+      // TODO
+      break;
+    }
     scoped_refptr<HttpListenSocket> sock(
         new HttpListenSocket(conn, delegate_));
     // it's up to the delegate to AddRef if it wants to keep it around
@@ -4,14 +4,19 @@
 
 #include "net/tools/flip_server/acceptor_thread.h"
 
+#include <errno.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>  // For TCP_NODELAY
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <string.h>
+#include <unistd.h>
 
 #include <string>
 
+#include "base/eintr_wrapper.h"
 #include "net/tools/flip_server/constants.h"
+#include "net/tools/flip_server/create_listener.h"
 #include "net/tools/flip_server/flip_config.h"
 #include "net/tools/flip_server/sm_connection.h"
 #include "net/tools/flip_server/spdy_ssl.h"
@@ -20,13 +25,30 @@
 
 namespace net {
 
+namespace {
+
+// A connection passed through the handoff pipe.  Small enough for the write
+// to be atomic.
+struct HandedOffConnection {
+  int fd;
+  struct sockaddr_in remote_addr;
+};
+
+}  // namespace
+
 SMAcceptorThread::SMAcceptorThread(FlipAcceptor *acceptor,
-                                   MemoryCache* memory_cache)
+                                   MemoryCache* memory_cache,
+                                   int listen_fd)
     : SimpleThread("SMAcceptorThread"),
       acceptor_(acceptor),
+      listen_fd_(listen_fd),
+      handoff_read_fd_(-1),
+      handoff_write_fd_(-1),
+      next_handoff_thread_(0),
       ssl_state_(NULL),
       use_ssl_(false),
       idle_socket_timeout_s_(acceptor->idle_socket_timeout_s_),
+      oldest_connection_time_(time(NULL)),
       quitting_(false),
       memory_cache_(memory_cache) {
   if (!acceptor->ssl_cert_filename_.empty() &&
@@ -44,6 +66,21 @@ SMAcceptorThread::SMAcceptorThread(FlipAcceptor *acceptor,
             acceptor_->ssl_disable_compression_);
     use_ssl_ = true;
   }
+
+  // Threads with a listening socket of their own, the first one or all of
+  // them with SO_REUSEPORT, are never handed connections.
+  if (listen_fd_ == -1) {
+    int fds[2];
+    if (pipe(fds) == 0) {
+      handoff_read_fd_ = fds[0];
+      handoff_write_fd_ = fds[1];
+      SetNonBlocking(handoff_read_fd_);
+      // A worker that falls behind must not hold up the accepting thread.
+      SetNonBlocking(handoff_write_fd_);
+    } else {
+      LOG(ERROR) << "pipe() failed: " << strerror(errno);
+    }
+  }
 }
 
 SMAcceptorThread::~SMAcceptorThread() {
@@ -54,6 +91,10 @@ SMAcceptorThread::~SMAcceptorThread() {
     delete *i;
   }
   delete ssl_state_;
+  if (handoff_read_fd_ != -1) {
+    close(handoff_read_fd_);
+    close(handoff_write_fd_);
+  }
 }
 
 SMConnection* SMAcceptorThread::NewConnection() {
@@ -77,7 +118,10 @@ SMConnection* SMAcceptorThread::FindOrMakeNewSMConnection() {
 }
 
 void SMAcceptorThread::InitWorker() {
-  epoll_server_.RegisterFD(acceptor_->listen_fd_, this, EPOLLIN | EPOLLET);
+  if (listen_fd_ != -1)
+    epoll_server_.RegisterFD(listen_fd_, this, EPOLLIN | EPOLLET);
+  if (handoff_read_fd_ != -1)
+    epoll_server_.RegisterFD(handoff_read_fd_, this, EPOLLIN | EPOLLET);
 }
 
 void SMAcceptorThread::HandleConnection(int server_fd,
@@ -111,44 +155,103 @@ void SMAcceptorThread::HandleConnection(int server_fd,
     active_server_connections_.push_back(server_connection);
 }
 
+bool SMAcceptorThread::HandOffConnection(
+    int server_fd, const struct sockaddr_in& remote_addr) {
+  if (handoff_write_fd_ == -1)
+    return false;
+  HandedOffConnection connection;
+  connection.fd = server_fd;
+  connection.remote_addr = remote_addr;
+  ssize_t rv = HANDLE_EINTR(write(handoff_write_fd_, &connection,
+                                  sizeof(connection)));
+  if (rv == static_cast<ssize_t>(sizeof(connection)))
+    return true;
+  // Writes of this size are atomic, so nothing was queued.
+  if (rv == -1 && errno == EAGAIN) {
+    VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Handoff pipe full for fd "
+            << server_fd;
+  } else {
+    LOG(ERROR) << "Unable to hand off fd " << server_fd;
+  }
+  return false;
+}
+
+void SMAcceptorThread::DispatchConnection(int server_fd,
+                                          struct sockaddr_in *remote_addr) {
+  if (handoff_threads_.empty()) {
+    HandleConnection(server_fd, remote_addr);
+    return;
+  }
+  // Go round-robin, skipping threads whose pipe is full.
+  for (size_t i = 0; i < handoff_threads_.size(); ++i) {
+    SMAcceptorThread* thread =
+        handoff_threads_[next_handoff_thread_++ % handoff_threads_.size()];
+    if (thread == this) {
+      HandleConnection(server_fd, remote_addr);
+      return;
+    }
+    if (thread->HandOffConnection(server_fd, *remote_addr))
+      return;
+  }
+  VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Acceptor: Closing fd " << server_fd
+          << ", no thread can take it";
+  close(server_fd);
+}
+
+void SMAcceptorThread::ReadHandedOffConnections() {
+  while (true) {
+    HandedOffConnection connection;
+    ssize_t rv = HANDLE_EINTR(read(handoff_read_fd_, &connection,
+                                   sizeof(connection)));
+    if (rv != static_cast<ssize_t>(sizeof(connection))) {
+      // Writes of this size are atomic, so anything else means the pipe is
+      // drained.
+      DCHECK_LE(rv, 0);
+      break;
+    }
+    VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Handed off connection";
+    HandleConnection(connection.fd, &connection.remote_addr);
+  }
+}
+
 void SMAcceptorThread::AcceptFromListenFD() {
   if (acceptor_->accepts_per_wake_ > 0) {
     for (int i = 0; i < acceptor_->accepts_per_wake_; ++i) {
       struct sockaddr address;
       socklen_t socklen = sizeof(address);
-      int fd = accept(acceptor_->listen_fd_, &address, &socklen);
+      int fd = accept(listen_fd_, &address, &socklen);
       if (fd == -1) {
         if (errno != 11) {
           VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Acceptor: accept fail("
-                  << acceptor_->listen_fd_ << "): " << errno << ": "
+                  << listen_fd_ << "): " << errno << ": "
                   << strerror(errno);
         }
         break;
       }
       VLOG(1) << ACCEPTOR_CLIENT_IDENT << " Accepted connection";
-      HandleConnection(fd, (struct sockaddr_in *)&address);
+      DispatchConnection(fd, (struct sockaddr_in *)&address);
     }
   } else {
     while (true) {
       struct sockaddr address;
       socklen_t socklen = sizeof(address);
-      int fd = accept(acceptor_->listen_fd_, &address, &socklen);
+      int fd = accept(listen_fd_, &address, &socklen);
       if (fd == -1) {
         if (errno != 11) {
           VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Acceptor: accept fail("
-                  << acceptor_->listen_fd_ << "): " << errno << ": "
+                  << listen_fd_ << "): " << errno << ": "
                   << strerror(errno);
         }
         break;
       }
       VLOG(1) << ACCEPTOR_CLIENT_IDENT << "Accepted connection";
-      HandleConnection(fd, (struct sockaddr_in *)&address);
+      DispatchConnection(fd, (struct sockaddr_in *)&address);
     }
   }
 }
 
 void SMAcceptorThread::HandleConnectionIdleTimeout() {
-  static time_t oldest_time = time(NULL);
+  time_t& oldest_time = oldest_connection_time_;
 
   int cur_time = time(NULL);
   // Only iterate the list if we speculate that a connection is ready to be
@@ -193,11 +296,15 @@ void SMAcceptorThread::Run() {
 }
 
 void SMAcceptorThread::OnEvent(int fd, EpollEvent* event) {
-  if (event->in_events | EPOLLIN) {
-    VLOG(2) << ACCEPTOR_CLIENT_IDENT
-            << "Acceptor: Accepting based upon epoll events";
-    AcceptFromListenFD();
+  if (!(event->in_events & EPOLLIN))
+    return;
+  if (fd == handoff_read_fd_) {
+    ReadHandedOffConnections();
+    return;
   }
+  VLOG(2) << ACCEPTOR_CLIENT_IDENT
+          << "Acceptor: Accepting based upon epoll events";
+  AcceptFromListenFD();
 }
 
 void SMAcceptorThread::SMConnectionDone(SMConnection* sc) {
@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 
+#include "base/atomicops.h"
 #include "base/compiler_specific.h"
 #include "base/threading/simple_thread.h"
 #include "net/tools/flip_server/epoll_server.h"
@@ -24,29 +25,30 @@ class MemoryCache;
 class SMConnection;
 struct SSLState;
 
-// TODO(mbelshe):  Get rid of this class; we don't need a lock just to set
-//    a bool cross threads - especially one which only is set once...
+// A flag set once by one thread and polled by another.
 class Notification {
  public:
    explicit Notification(bool value) : value_(value) {}
 
    void Notify() {
-     base::AutoLock al(lock_);
-     value_ = true;
+     base::subtle::Release_Store(&value_, 1);
    }
    bool HasBeenNotified() {
-     base::AutoLock al(lock_);
-     return value_;
+     return base::subtle::Acquire_Load(&value_) != 0;
    }
-   bool value_;
-   base::Lock lock_;
+
+ private:
+   base::subtle::Atomic32 value_;
 };
 
 class SMAcceptorThread : public base::SimpleThread,
                          public EpollCallbackInterface,
                          public SMConnectionPoolInterface {
  public:
-  SMAcceptorThread(FlipAcceptor *acceptor, MemoryCache* memory_cache);
+  // Accepts connections on |listen_fd|, or, if it is -1, only serves the
+  // ones handed off by another thread through HandOffConnection().
+  SMAcceptorThread(FlipAcceptor *acceptor, MemoryCache* memory_cache,
+                   int listen_fd);
   virtual ~SMAcceptorThread();
 
   // EpollCallbackInteface interface
@@ -68,6 +70,19 @@ class SMAcceptorThread : public base::SimpleThread,
   void HandleConnection(int server_fd, struct sockaddr_in *remote_addr);
   void AcceptFromListenFD();
 
+  // Spreads the connections this thread accepts round-robin over |threads|,
+  // which may include this thread.  Must be called before Start().
+  void set_handoff_threads(const std::vector<SMAcceptorThread*>& threads) {
+    handoff_threads_ = threads;
+  }
+
+  // Passes an accepted connection to this thread.  May be called from any
+  // thread.  The connection goes through a non-blocking pipe, so neither side
+  // locks or waits.  Returns false, leaving |server_fd| to the caller, if
+  // this thread has no pipe (it has a listening socket of its own) or the
+  // pipe is full.
+  bool HandOffConnection(int server_fd, const struct sockaddr_in& remote_addr);
+
   // Notify the Accept thread that it is time to terminate.
   void Quit() { quitting_.Notify(); }
 
@@ -78,8 +93,21 @@ class SMAcceptorThread : public base::SimpleThread,
   virtual void Run() OVERRIDE;
 
  private:
+  // Accepts or hands off a connection accepted by this thread.
+  void DispatchConnection(int server_fd, struct sockaddr_in *remote_addr);
+
+  // Handles the connections queued by HandOffConnection().
+  void ReadHandedOffConnections();
+
   EpollServer epoll_server_;
   FlipAcceptor* acceptor_;
+  int listen_fd_;
+  // Pipe carrying connections from HandOffConnection() to this thread.  Only
+  // created for threads without a listening socket.
+  int handoff_read_fd_;
+  int handoff_write_fd_;
+  std::vector<SMAcceptorThread*> handoff_threads_;
+  size_t next_handoff_thread_;
   SSLState* ssl_state_;
   bool use_ssl_;
   int idle_socket_timeout_s_;
@@ -88,6 +116,9 @@ class SMAcceptorThread : public base::SimpleThread,
   std::vector<SMConnection*> tmp_unused_server_connections_;
   std::vector<SMConnection*> allocated_server_connections_;
   std::list<SMConnection*> active_server_connections_;
+  // Used by HandleConnectionIdleTimeout() to skip scanning the connections
+  // when none can have expired yet.
+  time_t oldest_connection_time_;
   Notification quitting_;
   MemoryCache* memory_cache_;
 };
@@ -35,6 +35,31 @@ static const size_t kContentLengthSize = sizeof(kContentLength) - 1;
 static const char kTransferEncoding[] = "transfer-encoding";
 static const size_t kTransferEncodingSize = sizeof(kTransferEncoding) - 1;
 
+// Returns a pointer to the first '\r' or '\n' in [begin, end), or end if
+// there is none.  With SSE2 this compares 16 bytes at a time.
+static inline const char* FindCarriageReturnOrNewline(const char* begin,
+                                                      const char* end) {
+#if __SSE2__
+  const __m128i newlines = _mm_set1_epi8('\n');
+  const __m128i carriage_returns = _mm_set1_epi8('\r');
+  while (end - begin >= 16) {
+    __m128i bytes =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+    int msk = _mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(bytes, newlines),
+                     _mm_cmpeq_epi8(bytes, carriage_returns)));
+    if (msk != 0)
+      return begin + (ffs(msk) - 1);
+    begin += 16;
+  }
+#endif  // __SSE2__
+  for (; begin < end; ++begin) {
+    if (*begin == '\r' || *begin == '\n')
+      return begin;
+  }
+  return end;
+}
+
 BalsaFrame::BalsaFrame()
     : last_char_was_slash_r_(false),
       saw_non_newline_char_(false),
@@ -1392,20 +1417,24 @@ size_t BalsaFrame::ProcessInput(const char* input, size_t size) {
  label_reading_chunk_extension:
       case BalsaFrameEnums::READING_CHUNK_EXTENSION:
         {
-          // TODO(phython): Convert this scanning to be 16 bytes at a time if
-          // there is data to be read.
           const char* extensions_start = current;
           size_t extensions_length = 0;
           while (current < end) {
-            const char c = *current;
-            if (c == '\r' || c == '\n') {
-              extensions_length =
-                  (extensions_start == current) ?
-                  0 :
-                  current - extensions_start - 1;
+            // Skip straight to the next line delimiter; extensions are
+            // opaque to us until the line is complete.
+            const char* const delimiter =
+                FindCarriageReturnOrNewline(current, end);
+            if (delimiter == end) {
+              current = end;
+              break;
             }
+            const char c = *delimiter;
+            extensions_length =
+                (extensions_start == delimiter) ?
+                0 :
+                delimiter - extensions_start - 1;
 
-            ++current;
+            current = delimiter + 1;
             if (c == '\n') {
               chunk_length_character_extracted_ = false;
               visitor_->ProcessChunkExtensions(
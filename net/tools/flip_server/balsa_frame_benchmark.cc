@@ -0,0 +1,182 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Microbenchmark for BalsaFrame request parsing.  It frames a corpus of
+// pipelined HTTP requests over and over, the way one SMConnection frames the
+// requests arriving on a keep-alive connection, and prints the parse rate.
+//
+// The corpus defaults to a handful of requests captured from a desktop
+// browser.  --corpus=<file> replaces it with a raw capture of the client side
+// of a connection (requests back to back, e.g. as saved by tcpflow).
+// --fresh-headers uses a new BalsaHeaders for every message, which shows what
+// reusing the header arena across messages saves.
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/basictypes.h"
+#include "base/command_line.h"
+#include "base/file_path.h"
+#include "base/file_util.h"
+#include "base/logging.h"
+#include "base/string_number_conversions.h"
+#include "base/time.h"
+#include "net/tools/flip_server/balsa_frame.h"
+#include "net/tools/flip_server/balsa_headers.h"
+
+namespace {
+
+const char* const kDefaultCorpus[] = {
+  "GET / HTTP/1.1\r\n"
+  "Host: www.example.com\r\n"
+  "Connection: keep-alive\r\n"
+  "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/535.19 "
+  "(KHTML, like Gecko) Chrome/18.0.1025.142 Safari/535.19\r\n"
+  "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,"
+  "*/*;q=0.8\r\n"
+  "Accept-Encoding: gzip,deflate,sdch\r\n"
+  "Accept-Language: en-US,en;q=0.8\r\n"
+  "Accept-Charset: ISO-8859-1,utf-8;q=0.7,*;q=0.3\r\n"
+  "Cookie: PREF=ID=1f2e3d4c5b6a7980:U=0123456789abcdef:FF=0:TM=1334000000:"
+  "LM=1334000001:S=AbCdEfGhIjKlMnOp; NID=58=aBcDeFgHiJkLmNoPqRsTuVwXyZ012345"
+  "6789aBcDeFgHiJkLmNoPqRsTuVwXyZ\r\n"
+  "\r\n",
+
+  "GET /images/srpr/logo3w.png HTTP/1.1\r\n"
+  "Host: www.example.com\r\n"
+  "Connection: keep-alive\r\n"
+  "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/535.19 "
+  "(KHTML, like Gecko) Chrome/18.0.1025.142 Safari/535.19\r\n"
+  "Accept: */*\r\n"
+  "Referer: http://www.example.com/\r\n"
+  "Accept-Encoding: gzip,deflate,sdch\r\n"
+  "Accept-Language: en-US,en;q=0.8\r\n"
+  "Accept-Charset: ISO-8859-1,utf-8;q=0.7,*;q=0.3\r\n"
+  "If-Modified-Since: Mon, 02 Apr 2012 02:13:37 GMT\r\n"
+  "\r\n",
+
+  "GET /extern_js/f/CgJlbhICdXMrMEU4ACwrMFo4ACwrMA44ACwrMBc4ACwrMDw4ACw"
+  "rMFE4ACwrMFk4ACwrMAo4AEAvmgICcHMsKzAWOAAsKzAZOAAsKzAlOM-IASwrMCo4ACw/"
+  "rt=j/ver=SmmOdc1Pm5c.en_US./sv=1/am=!ZrwoD-mgkjrbRy6oRg/d=1/ HTTP/1.1\r\n"
+  "Host: www.example.com\r\n"
+  "Connection: keep-alive\r\n"
+  "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/535.19 "
+  "(KHTML, like Gecko) Chrome/18.0.1025.142 Safari/535.19\r\n"
+  "Accept: */*\r\n"
+  "Referer: http://www.example.com/\r\n"
+  "Accept-Encoding: gzip,deflate,sdch\r\n"
+  "Accept-Language: en-US,en;q=0.8\r\n"
+  "Accept-Charset: ISO-8859-1,utf-8;q=0.7,*;q=0.3\r\n"
+  "\r\n",
+
+  "POST /gen_204?atyp=i&ct=slh&cad=&ei=AbCdEf HTTP/1.1\r\n"
+  "Host: www.example.com\r\n"
+  "Connection: keep-alive\r\n"
+  "Origin: http://www.example.com\r\n"
+  "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/535.19 "
+  "(KHTML, like Gecko) Chrome/18.0.1025.142 Safari/535.19\r\n"
+  "Content-Type: application/x-www-form-urlencoded\r\n"
+  "Transfer-Encoding: chunked\r\n"
+  "Accept: */*\r\n"
+  "Referer: http://www.example.com/\r\n"
+  "Accept-Encoding: gzip,deflate,sdch\r\n"
+  "Accept-Language: en-US,en;q=0.8\r\n"
+  "\r\n"
+  "19; name=\"ext\"\r\n"
+  "q=flip+server&oq=flip+ser\r\n"
+  "0\r\n"
+  "\r\n",
+};
+
+// Frames every message in |corpus| once with |framer|.  Returns the number
+// of messages, or -1 if the corpus did not parse.
+int FrameCorpus(const std::string& corpus,
+                bool fresh_headers,
+                net::BalsaFrame* framer,
+                net::BalsaHeaders* headers) {
+  const char* current = corpus.data();
+  const char* const end = current + corpus.size();
+  int messages = 0;
+  while (current < end) {
+    size_t consumed = framer->ProcessInput(current, end - current);
+    if (framer->Error() || consumed == 0)
+      return -1;
+    current += consumed;
+    if (framer->MessageFullyRead()) {
+      ++messages;
+      if (fresh_headers) {
+        net::BalsaHeaders new_headers;
+        headers->Swap(&new_headers);
+      }
+      framer->Reset();
+    }
+  }
+  return messages;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  base::AtExitManager exit_manager;
+  CommandLine::Init(argc, argv);
+  const CommandLine& cl = *CommandLine::ForCurrentProcess();
+
+  if (cl.HasSwitch("help")) {
+    printf("Usage: %s [--corpus=<file>] [--iterations=<n>] "
+           "[--fresh-headers]\n", argv[0]);
+    return 0;
+  }
+
+  std::string corpus;
+  if (cl.HasSwitch("corpus")) {
+    FilePath path = cl.GetSwitchValuePath("corpus");
+    if (!file_util::ReadFileToString(path, &corpus) || corpus.empty()) {
+      LOG(ERROR) << "Unable to read corpus " << path.value();
+      return 1;
+    }
+  } else {
+    for (size_t i = 0; i < arraysize(kDefaultCorpus); ++i)
+      corpus += kDefaultCorpus[i];
+  }
+
+  int iterations = 100000;
+  if (cl.HasSwitch("iterations") &&
+      !base::StringToInt(cl.GetSwitchValueASCII("iterations"), &iterations)) {
+    LOG(ERROR) << "Invalid --iterations";
+    return 1;
+  }
+  bool fresh_headers = cl.HasSwitch("fresh-headers");
+
+  net::BalsaHeaders headers;
+  net::BalsaFrame framer;
+  framer.set_balsa_headers(&headers);
+  framer.set_is_request(true);
+
+  // One untimed pass to validate the corpus and warm up the arena.
+  int messages_per_pass =
+      FrameCorpus(corpus, fresh_headers, &framer, &headers);
+  if (messages_per_pass <= 0) {
+    LOG(ERROR) << "Corpus did not frame cleanly: "
+               << net::BalsaFrameEnums::ErrorCodeToString(framer.ErrorCode());
+    return 1;
+  }
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < iterations; ++i)
+    FrameCorpus(corpus, fresh_headers, &framer, &headers);
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+
+  double seconds = elapsed.InSecondsF();
+  double messages = static_cast<double>(messages_per_pass) * iterations;
+  double bytes = static_cast<double>(corpus.size()) * iterations;
+  printf("%d messages/pass, %d passes, %s headers\n", messages_per_pass,
+         iterations, fresh_headers ? "fresh" : "reused");
+  printf("%.1f ns/message, %.0f messages/s, %.1f MB/s\n",
+         seconds * 1e9 / messages, messages / seconds,
+         bytes / seconds / (1024 * 1024));
+  return 0;
+}
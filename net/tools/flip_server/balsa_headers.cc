@@ -161,13 +161,26 @@ char* BalsaBuffer::Reserve(size_t size,
 
 void BalsaBuffer::Clear() {
   CHECK(!blocks_.empty());
-  if (blocksize_ == blocks_[0].buffer_size) {
-    CleanupBlocksStartingFrom(1);
-    blocks_[0].bytes_free = blocks_[0].buffer_size;
+  // Keep the arena around so that a connection parsing one message after
+  // another stops allocating once it has seen its largest headers.  The first
+  // block is kept even if WriteToContiguousBuffer() grew it (the framer bounds
+  // that by max_header_length), as are the default sized blocks; only the
+  // oversized blocks made for single large Write()s are released.
+  if (blocks_[0].buffer == NULL) {
+    blocks_[0] = AllocBlock();
   } else {
-    CleanupBlocksStartingFrom(0);
-    blocks_.push_back(AllocBlock());
+    blocks_[0].bytes_free = blocks_[0].buffer_size;
+  }
+  Blocks::size_type kept = 1;
+  for (Blocks::size_type i = 1; i < blocks_.size(); ++i) {
+    if (blocks_[i].buffer_size == blocksize_) {
+      blocks_[i].bytes_free = blocks_[i].buffer_size;
+      blocks_[kept++] = blocks_[i];
+    } else {
+      delete[] blocks_[i].buffer;
+    }
   }
+  blocks_.resize(kept);
   DCHECK_GE(blocks_.size(), 1u);
   can_write_to_contiguous_buffer_ = true;
 }
@@ -4,8 +4,46 @@
 
 #include "net/tools/flip_server/flip_config.h"
 
+#include <unistd.h>
+
 namespace net {
 
+namespace {
+
+// Creates a non-blocking listening socket for |acceptor|'s address.  If
+// |wait_for_iface|, retries until the interface is up.  Returns false on
+// failure.
+bool Listen(const FlipAcceptor& acceptor, bool wait_for_iface, int* fd) {
+  while (1) {
+    int ret = CreateListeningSocket(acceptor.listen_ip_,
+                                    acceptor.listen_port_,
+                                    true,
+                                    acceptor.accept_backlog_size_,
+                                    true,
+                                    acceptor.reuseport_,
+                                    wait_for_iface,
+                                    acceptor.disable_nagle_,
+                                    fd);
+    if ( ret == 0 ) {
+      break;
+    } else if ( ret == -3 && wait_for_iface ) {
+      // Binding error EADDRNOTAVAIL was encounted. We need
+      // to wait for the interfaces to raised. try again.
+      usleep(200000);
+    } else {
+      LOG(ERROR) << "Unable to create listening socket for: ret = " << ret
+                 << ": " << acceptor.listen_ip_.c_str() << ":"
+                 << acceptor.listen_port_.c_str();
+      return false;
+    }
+  }
+
+  SetNonBlocking(*fd);
+  return true;
+}
+
+}  // namespace
+
 FlipAcceptor::FlipAcceptor(enum FlipHandlerType flip_handler_type,
                            std::string listen_ip,
                            std::string listen_port,
@@ -19,6 +57,7 @@ FlipAcceptor::FlipAcceptor(enum FlipHandlerType flip_handler_type,
                            int accept_backlog_size,
                            bool disable_nagle,
                            int accepts_per_wake,
+                           int accept_threads,
                            bool reuseport,
                            bool wait_for_iface,
                            void *memory_cache)
@@ -35,6 +74,9 @@ FlipAcceptor::FlipAcceptor(enum FlipHandlerType flip_handler_type,
       accept_backlog_size_(accept_backlog_size),
       disable_nagle_(disable_nagle),
       accepts_per_wake_(accepts_per_wake),
+      accept_threads_(accept_threads),
+      reuseport_(reuseport),
+      listen_fd_(-1),
       memory_cache_(memory_cache),
       ssl_session_expiry_(300),  // TODO(mbelshe):  Hook these up!
       ssl_disable_compression_(false),
@@ -46,31 +88,17 @@ FlipAcceptor::FlipAcceptor(enum FlipHandlerType flip_handler_type,
   if (!https_server_port_.size())
     https_server_port_ = http_server_port_;
 
-  while (1) {
-    int ret = CreateListeningSocket(listen_ip_,
-                                    listen_port_,
-                                    true,
-                                    accept_backlog_size_,
-                                    true,
-                                    reuseport,
-                                    wait_for_iface,
-                                    disable_nagle_,
-                                    &listen_fd_);
-    if ( ret == 0 ) {
-      break;
-    } else if ( ret == -3 && wait_for_iface ) {
-      // Binding error EADDRNOTAVAIL was encounted. We need
-      // to wait for the interfaces to raised. try again.
-      usleep(200000);
-    } else {
-      LOG(ERROR) << "Unable to create listening socket for: ret = " << ret
-                 << ": " << listen_ip_.c_str() << ":"
-                 << listen_port_.c_str();
-      return;
+  if (!Listen(*this, wait_for_iface, &listen_fd_))
+    return;
+  if (reuseport_) {
+    for (int i = 1; i < accept_threads_; ++i) {
+      int fd;
+      if (!Listen(*this, wait_for_iface, &fd))
+        break;
+      reuseport_listen_fds_.push_back(fd);
     }
   }
 
-  SetNonBlocking(listen_fd_);
   VLOG(1) << "Listening on socket: ";
   if (flip_handler_type == FLIP_HANDLER_PROXY)
     VLOG(1) << "\tType         : Proxy";
@@ -80,6 +108,8 @@ FlipAcceptor::FlipAcceptor(enum FlipHandlerType flip_handler_type,
     VLOG(1) << "\tType         : HTTP Server";
   VLOG(1) << "\tIP           : " << listen_ip_;
   VLOG(1) << "\tPort         : " << listen_port_;
+  VLOG(1) << "\tThreads      : " << accept_threads_
+          << (reuseport_ ? " (SO_REUSEPORT)" : "");
   VLOG(1) << "\tHTTP Server  : " << http_server_ip_ << ":"
           << http_server_port_;
   VLOG(1) << "\tHTTPS Server : " << https_server_ip_ << ":"
@@ -114,6 +144,7 @@ void FlipConfig::AddAcceptor(enum FlipHandlerType flip_handler_type,
                              int accept_backlog_size,
                              bool disable_nagle,
                              int accepts_per_wake,
+                             int accept_threads,
                              bool reuseport,
                              bool wait_for_iface,
                              void *memory_cache) {
@@ -131,6 +162,7 @@ void FlipConfig::AddAcceptor(enum FlipHandlerType flip_handler_type,
                                         accept_backlog_size,
                                         disable_nagle,
                                         accepts_per_wake,
+                                        accept_threads,
                                         reuseport,
                                         wait_for_iface,
                                         memory_cache));
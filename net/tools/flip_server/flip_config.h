@@ -37,6 +37,7 @@ class FlipAcceptor {
                int accept_backlog_size,
                bool disable_nagle,
                int accepts_per_wake,
+               int accept_threads,
                bool reuseport,
                bool wait_for_iface,
                void *memory_cache);
@@ -55,7 +56,16 @@ class FlipAcceptor {
   int accept_backlog_size_;
   bool disable_nagle_;
   int accepts_per_wake_;
+  // Number of SMAcceptorThreads, each with its own EpollServer, serving this
+  // acceptor.
+  int accept_threads_;
+  bool reuseport_;
   int listen_fd_;
+  // With |reuseport_|, one more listening socket per accept thread after the
+  // first, all bound to the same address so the kernel spreads incoming
+  // connections over them.  Otherwise the thread listening on |listen_fd_|
+  // hands connections off to the others.
+  std::vector<int> reuseport_listen_fds_;
   void* memory_cache_;
   int ssl_session_expiry_;
   bool ssl_disable_compression_;
@@ -80,6 +90,7 @@ class FlipConfig {
                    int accept_backlog_size,
                    bool disable_nagle,
                    int accepts_per_wake,
+                   int accept_threads,
                    bool reuseport,
                    bool wait_for_iface,
                    void *memory_cache);
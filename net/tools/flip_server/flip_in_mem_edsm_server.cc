@@ -7,6 +7,7 @@
 #include <sys/file.h>
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -46,6 +47,9 @@ int32 FLAGS_accept_backlog_size = 1024;
 //  SO_REUSEPORT);
 bool FLAGS_reuseport = false;
 
+// The number of accept threads, each with its own epoll loop, per acceptor.
+int32 FLAGS_accept_threads = 1;
+
 // Flag to force spdy, even if NPN is not negotiated.
 bool FLAGS_force_spdy = false;
 
@@ -204,6 +208,14 @@ int main (int argc, char**argv)
     cout << "\t--ssl-session-expiry=<seconds> (default is 300)\n";
     cout << "\t--ssl-disable-compression\n";
     cout << "\t--idle-timeout=<seconds> (default is 300)\n";
+    cout << "\t--accept-threads=<count> (default is 1)\n";
+    cout << "\t  * Each listening port is served by this many threads, each"
+         << " with its own\n"
+         << "\t    event loop.\n";
+    cout << "\t--reuseport\n";
+    cout << "\t  * Give each accept thread its own SO_REUSEPORT listening"
+         << " socket,\n"
+         << "\t    instead of handing connections off from one thread.\n";
     cout << "\t--pidfile=<filepath> (default /var/run/flip-server.pid)\n";
     cout << "\t--help\n";
     exit(0);
@@ -269,6 +281,14 @@ int main (int argc, char**argv)
       atoi(cl.GetSwitchValueASCII("idle-timeout").c_str());
   }
 
+  if (cl.HasSwitch("accept-threads")) {
+    FLAGS_accept_threads =
+      std::max(1, atoi(cl.GetSwitchValueASCII("accept-threads").c_str()));
+  }
+
+  if (cl.HasSwitch("reuseport"))
+    FLAGS_reuseport = true;
+
   if (cl.HasSwitch("force_spdy"))
     net::SMConnection::set_force_spdy(true);
 
@@ -291,6 +311,7 @@ int main (int argc, char**argv)
             << (FLAGS_disable_nagle?"true":"false");
   LOG(INFO) << "Reuseport               : "
             << (FLAGS_reuseport?"true":"false");
+  LOG(INFO) << "Accept threads          : " << FLAGS_accept_threads;
   LOG(INFO) << "Force SPDY              : "
             << (FLAGS_force_spdy?"true":"false");
   LOG(INFO) << "SSL session expiry      : "
@@ -323,6 +344,7 @@ int main (int argc, char**argv)
                                FLAGS_accept_backlog_size,
                                FLAGS_disable_nagle,
                                FLAGS_accepts_per_wake,
+                               FLAGS_accept_threads,
                                FLAGS_reuseport,
                                wait_for_iface,
                                NULL);
@@ -344,6 +366,7 @@ int main (int argc, char**argv)
                                FLAGS_accept_backlog_size,
                                FLAGS_disable_nagle,
                                FLAGS_accepts_per_wake,
+                               FLAGS_accept_threads,
                                FLAGS_reuseport,
                                wait_for_iface,
                                &spdy_memory_cache);
@@ -365,6 +388,7 @@ int main (int argc, char**argv)
                                FLAGS_accept_backlog_size,
                                FLAGS_disable_nagle,
                                FLAGS_accepts_per_wake,
+                               FLAGS_accept_threads,
                                FLAGS_reuseport,
                                wait_for_iface,
                                &http_memory_cache);
@@ -375,19 +399,33 @@ int main (int argc, char**argv)
   for (i = 0; i < g_proxy_config.acceptors_.size(); i++) {
     net::FlipAcceptor *acceptor = g_proxy_config.acceptors_[i];
 
-    sm_worker_threads_.push_back(
-        new net::SMAcceptorThread(acceptor,
-                                  (net::MemoryCache *)acceptor->memory_cache_));
-    // Note that spdy_memory_cache is not threadsafe, it is merely
-    // thread compatible. Thus, if ever we are to spawn multiple threads,
-    // we either must make the MemoryCache threadsafe, or use
-    // a separate MemoryCache for each thread.
-    //
-    // The latter is what is currently being done as we spawn
-    // a separate thread for each http and spdy server acceptor.
-
-    sm_worker_threads_.back()->InitWorker();
-    sm_worker_threads_.back()->Start();
+    // The set of files in a MemoryCache does not change once AddFiles()
+    // returns, and entries lock themselves while they are lazily loaded, so
+    // the accept threads of an acceptor share one cache.
+    std::vector<net::SMAcceptorThread*> acceptor_threads;
+    for (int t = 0; t < acceptor->accept_threads_; ++t) {
+      // With SO_REUSEPORT every thread accepts on its own socket.  Otherwise
+      // only the first one accepts, and hands connections off to the rest.
+      int listen_fd = -1;
+      if (t == 0)
+        listen_fd = acceptor->listen_fd_;
+      else if (t - 1 < static_cast<int>(acceptor->reuseport_listen_fds_.size()))
+        listen_fd = acceptor->reuseport_listen_fds_[t - 1];
+      acceptor_threads.push_back(
+          new net::SMAcceptorThread(acceptor,
+                                    (net::MemoryCache *)acceptor->memory_cache_,
+                                    listen_fd));
+    }
+    if (acceptor_threads.size() > acceptor->reuseport_listen_fds_.size() + 1)
+      acceptor_threads[0]->set_handoff_threads(acceptor_threads);
+
+    for (size_t t = 0; t < acceptor_threads.size(); ++t) {
+      acceptor_threads[t]->InitWorker();
+      acceptor_threads[t]->Start();
+    }
+    sm_worker_threads_.insert(sm_worker_threads_.end(),
+                              acceptor_threads.begin(),
+                              acceptor_threads.end());
   }
 
   while (!wantExit) {
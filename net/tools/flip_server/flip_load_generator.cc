@@ -0,0 +1,105 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Load generator for flip_in_mem_edsm_server's --http-server mode.  Each
+// client thread keeps one HTTP/1.1 keep-alive connection and sends requests
+// back to back.  For every thread count in --threads it runs for --duration
+// seconds and prints requests/sec and the median and 99th percentile
+// latency, to show how the server scales with --accept-threads.
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/basictypes.h"
+#include "base/command_line.h"
+#include "base/string_number_conversions.h"
+#include "base/string_split.h"
+#include "base/time.h"
+#include "net/tools/http_load_client/http_load_client.h"
+
+namespace {
+
+// Runs |threads| clients for |duration| and prints one row of results.
+void RunLoad(const std::string& host,
+             const std::string& port,
+             const std::string& request,
+             int threads,
+             base::TimeDelta duration) {
+  std::vector<net::HttpLoadThread*> clients;
+  for (int i = 0; i < threads; ++i)
+    clients.push_back(new net::HttpLoadThread(host, port, request, 1));
+  double seconds = net::RunHttpLoadThreads(clients, duration);
+
+  std::vector<int64> latencies_us;
+  int errors = 0;
+  for (size_t i = 0; i < clients.size(); ++i) {
+    latencies_us.insert(latencies_us.end(),
+                        clients[i]->latencies_us().begin(),
+                        clients[i]->latencies_us().end());
+    errors += clients[i]->errors();
+    delete clients[i];
+  }
+
+  std::sort(latencies_us.begin(), latencies_us.end());
+  double p50_ms = 0;
+  double p99_ms = 0;
+  if (!latencies_us.empty()) {
+    p50_ms = latencies_us[latencies_us.size() / 2] / 1000.0;
+    p99_ms = latencies_us[latencies_us.size() * 99 / 100] / 1000.0;
+  }
+  printf("%7d %12.0f %10.3f %10.3f %8d\n", threads,
+         latencies_us.size() / seconds, p50_ms, p99_ms, errors);
+  fflush(stdout);
+}
+
+int Usage(const char* argv0) {
+  fprintf(stderr,
+          "Usage: %s --host=<ip> --port=<port> [--path=/]"
+          " [--threads=1,2,4,8] [--duration=<seconds>]\n", argv0);
+  return 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit_manager;
+  CommandLine::Init(argc, argv);
+  const CommandLine& cl = *CommandLine::ForCurrentProcess();
+
+  std::string host = cl.GetSwitchValueASCII("host");
+  std::string port = cl.GetSwitchValueASCII("port");
+  if (host.empty() || port.empty())
+    return Usage(argv[0]);
+
+  std::string path = cl.HasSwitch("path") ? cl.GetSwitchValueASCII("path")
+                                          : "/";
+  std::string request = "GET " + path + " HTTP/1.1\r\nHost: " + host +
+                        "\r\nConnection: keep-alive\r\n\r\n";
+
+  std::vector<std::string> thread_counts;
+  base::SplitString(cl.HasSwitch("threads") ?
+                        cl.GetSwitchValueASCII("threads") : "1,2,4,8",
+                    ',', &thread_counts);
+
+  int duration_s = 10;
+  if (cl.HasSwitch("duration") &&
+      !base::StringToInt(cl.GetSwitchValueASCII("duration"), &duration_s)) {
+    return Usage(argv[0]);
+  }
+
+  printf("%7s %12s %10s %10s %8s\n",
+         "threads", "requests/s", "p50 ms", "p99 ms", "errors");
+  for (size_t i = 0; i < thread_counts.size(); ++i) {
+    int threads;
+    if (!base::StringToInt(thread_counts[i], &threads) || threads <= 0)
+      return Usage(argv[0]);
+    RunLoad(host, port, request, threads,
+            base::TimeDelta::FromSeconds(duration_s));
+  }
+  return 0;
+}
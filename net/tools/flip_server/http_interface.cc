@@ -317,6 +317,30 @@ void HttpSM::SendDataFrameImpl(uint32 stream_id, const char* data, int64 len,
   EnqueueDataFrame(df);
 }
 
+void HttpSM::SendCachedDataFrame(uint32 stream_id, const char* data,
+                                 int64 len) {
+  char chunk_buf[128];
+  int chunk_buf_len =
+      snprintf(chunk_buf, sizeof(chunk_buf), "%x\r\n", (unsigned int)len);
+  DataFrame* df = new DataFrame;
+  char* buffer = new char[chunk_buf_len];
+  memcpy(buffer, chunk_buf, chunk_buf_len);
+  df->data = buffer;
+  df->size = chunk_buf_len;
+  df->delete_when_done = true;
+  EnqueueDataFrame(df);
+
+  df = new DataFrame;
+  df->data = data;
+  df->size = len;
+  EnqueueDataFrame(df);
+
+  df = new DataFrame;
+  df->data = "\r\n";
+  df->size = 2;
+  EnqueueDataFrame(df);
+}
+
 void HttpSM::EnqueueDataFrame(DataFrame* df) {
   VLOG(2) << ACCEPTOR_CLIENT_IDENT << "HttpSM: Enqueue data frame: stream "
           << stream_id_;
@@ -350,10 +374,10 @@ void HttpSM::GetOutput() {
   if (num_to_write > mci->max_segment_size)
     num_to_write = mci->max_segment_size;
 
-  SendDataFrame(mci->stream_id,
-                mci->file_data->body.data() + mci->body_bytes_consumed,
-                num_to_write, 0, true);
-  VLOG(2) << ACCEPTOR_CLIENT_IDENT << "HttpSM: GetOutput SendDataFrame["
+  SendCachedDataFrame(mci->stream_id,
+                      mci->file_data->body.data() + mci->body_bytes_consumed,
+                      num_to_write);
+  VLOG(2) << ACCEPTOR_CLIENT_IDENT << "HttpSM: GetOutput SendCachedDataFrame["
           << mci->stream_id << "]: " << num_to_write;
   mci->body_bytes_consumed += num_to_write;
   mci->bytes_sent += num_to_write;
@@ -115,6 +115,10 @@ class HttpSM : public BalsaVisitorInterface,
   size_t SendSynStreamImpl(uint32 stream_id, const BalsaHeaders& headers);
   void SendDataFrameImpl(uint32 stream_id, const char* data, int64 len,
                          uint32 flags, bool compress);
+  // Like SendDataFrameImpl(), but queues |data| by reference instead of
+  // copying it.  |data| must outlive the connection, as MemoryCache bodies
+  // do.
+  void SendCachedDataFrame(uint32 stream_id, const char* data, int64 len);
   void EnqueueDataFrame(DataFrame* df);
   virtual void GetOutput() OVERRIDE;
 
@@ -8,11 +8,15 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include <deque>
 
+#include "base/eintr_wrapper.h"
+#include "base/stl_util.h"
 #include "base/string_piece.h"
 #include "net/tools/dump_cache/url_to_filename_encoder.h"
 #include "net/tools/dump_cache/url_utilities.h"
@@ -26,6 +30,17 @@ namespace net {
 
 void StoreBodyAndHeadersVisitor::ProcessBodyData(const char *input,
                                                  size_t size) {
+  if (body.empty()) {
+    if (body_input.empty()) {
+      body_input.set(input, size);
+      return;
+    }
+    if (input == body_input.data() + body_input.size()) {
+      body_input.set(body_input.data(), body_input.size() + size);
+      return;
+    }
+    body_input.CopyToString(&body);
+  }
   body.append(input, size);
 }
 
@@ -45,35 +60,24 @@ void StoreBodyAndHeadersVisitor::HandleBodyError(BalsaFrame* framer) {
   HandleError();
 }
 
-FileData::FileData(BalsaHeaders* h, const std::string& b)
-    : headers(h), body(b) {
+FileData::FileData(const std::string& p)
+    : headers(NULL),
+      path(p),
+      mapping(NULL),
+      mapping_size(0),
+      load_state(MemoryCache::LOAD_PENDING) {
 }
 
-FileData::FileData() {}
-
-FileData::~FileData() {}
-
-void FileData::CopyFrom(const FileData& file_data) {
-    headers = new BalsaHeaders;
-    headers->CopyFrom(*(file_data.headers));
-    filename = file_data.filename;
-    related_files = file_data.related_files;
-    body = file_data.body;
-  }
+FileData::~FileData() {
+  delete headers;
+  if (mapping)
+    munmap(mapping, mapping_size);
+}
 
 MemoryCache::MemoryCache() {}
 
-MemoryCache::~MemoryCache() {}
-
-void MemoryCache::CloneFrom(const MemoryCache& mc) {
-  for (Files::const_iterator i = mc.files_.begin();
-       i != mc.files_.end();
-       ++i) {
-    Files::iterator out_i =
-        files_.insert(make_pair(i->first, FileData())).first;
-    out_i->second.CopyFrom(i->second);
-    cwd_ = mc.cwd_;
-  }
+MemoryCache::~MemoryCache() {
+  STLDeleteValues(&files_);
 }
 
 void MemoryCache::AddFiles() {
@@ -103,7 +107,7 @@ void MemoryCache::AddFiles() {
             current_dir_name + "/" + dir_data->d_name;
           if (dir_data->d_type == DT_REG) {
             VLOG(1) << "Found file: " << current_entry_name;
-            ReadAndStoreFileContents(current_entry_name.c_str());
+            AddFile(current_entry_name);
           } else if (dir_data->d_type == DT_DIR) {
             VLOG(1) << "Found subdir: " << current_entry_name;
             if (std::string(dir_data->d_name) != "." &&
@@ -119,60 +123,78 @@ void MemoryCache::AddFiles() {
       }
     }
   }
+  LOG(INFO) << "Registered " << files_.size() << " files for lazy loading";
 }
 
-void MemoryCache::ReadToString(const char* filename, std::string* output) {
-  output->clear();
-  int fd = open(filename, 0, "r");
-  if (fd == -1)
+void MemoryCache::AddFile(const std::string& path) {
+  std::string filename_stripped = path.substr(cwd_.size() + 1);
+  FileData*& file_data = files_[filename_stripped];
+  if (file_data)
     return;
-  char buffer[4096];
-  ssize_t read_status = read(fd, buffer, sizeof(buffer));
-  while (read_status > 0) {
-    output->append(buffer, static_cast<size_t>(read_status));
-    do {
-      read_status = read(fd, buffer, sizeof(buffer));
-    } while (read_status <= 0 && errno == EINTR);
-  }
-  close(fd);
+  file_data = new FileData(path);
+  file_data->filename = std::string(filename_stripped,
+                                    filename_stripped.find_first_of('/'));
 }
 
-void MemoryCache::ReadAndStoreFileContents(const char* filename) {
+bool MemoryCache::LoadFileData(FileData* file_data) {
+  const char* filename = file_data->path.c_str();
+  int fd = HANDLE_EINTR(open(filename, O_RDONLY));
+  if (fd == -1) {
+    PLOG(ERROR) << "Unable to open " << filename;
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+    LOG(ERROR) << "Unable to stat, or empty file: " << filename;
+    HANDLE_EINTR(close(fd));
+    return false;
+  }
+  size_t file_size = static_cast<size_t>(file_stat.st_size);
+  void* mapping = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps its own reference to the file.
+  HANDLE_EINTR(close(fd));
+  if (mapping == MAP_FAILED) {
+    PLOG(ERROR) << "Unable to mmap " << filename;
+    return false;
+  }
+  file_data->mapping = mapping;
+  file_data->mapping_size = file_size;
+  madvise(mapping, file_size, MADV_SEQUENTIAL);
+  const char* contents = static_cast<const char*>(mapping);
+
   StoreBodyAndHeadersVisitor visitor;
   BalsaFrame framer;
   framer.set_balsa_visitor(&visitor);
   framer.set_balsa_headers(&(visitor.headers));
-  std::string filename_contents;
-  ReadToString(filename, &filename_contents);
-
-  // Ugly hack to make everything look like 1.1.
-  if (filename_contents.find("HTTP/1.0") == 0)
-    filename_contents[7] = '1';
 
   size_t pos = 0;
   size_t old_pos = 0;
   while (true) {
     old_pos = pos;
-    pos += framer.ProcessInput(filename_contents.data() + pos,
-                               filename_contents.size() - pos);
+    pos += framer.ProcessInput(contents + pos, file_size - pos);
     if (framer.Error() || pos == old_pos) {
       LOG(ERROR) << "Unable to make forward progress, or error"
         " framing file: " << filename;
       if (framer.Error()) {
         LOG(INFO) << "********************************************ERROR!";
-        return;
+        return false;
       }
-      return;
+      return false;
     }
     if (framer.MessageFullyRead()) {
       // If no Content-Length or Transfer-Encoding was captured in the
       // file, then the rest of the data is the body.  Many of the captures
       // from within Chrome don't have content-lengths.
-      if (!visitor.body.length())
-        visitor.body = filename_contents.substr(pos);
+      if (visitor.body_input.empty() && visitor.body.empty())
+        visitor.body_input.set(contents + pos, file_size - pos);
       break;
     }
   }
+
+  // Ugly hack to make everything look like 1.1.
+  if (visitor.headers.response_version() == "HTTP/1.0")
+    visitor.headers.SetResponseVersion("HTTP/1.1");
+
   visitor.headers.RemoveAllOfHeader("content-length");
   visitor.headers.RemoveAllOfHeader("transfer-encoding");
   visitor.headers.RemoveAllOfHeader("connection");
@@ -191,16 +213,32 @@ void MemoryCache::ReadAndStoreFileContents(const char* filename) {
                                "Fri, 30 Aug, 2019 12:00:00 GMT");
   }
 #endif
-  BalsaHeaders* headers = new BalsaHeaders;
-  headers->CopyFrom(visitor.headers);
-  std::string filename_stripped = std::string(filename).substr(cwd_.size() + 1);
-  LOG(INFO) << "Adding file (" << visitor.body.length() << " bytes): "
-            << filename_stripped;
-  files_[filename_stripped] = FileData();
-  FileData& fd = files_[filename_stripped];
-  fd = FileData(headers, visitor.body);
-  fd.filename = std::string(filename_stripped,
-                            filename_stripped.find_first_of('/'));
+  file_data->headers = new BalsaHeaders;
+  file_data->headers->CopyFrom(visitor.headers);
+  if (visitor.body.empty()) {
+    file_data->body = visitor.body_input;
+  } else {
+    // Chunk-encoded captures have to be reassembled.
+    file_data->body_storage.swap(visitor.body);
+    file_data->body = file_data->body_storage;
+  }
+  VLOG(1) << "Loaded file (" << file_data->body.size() << " bytes): "
+          << filename;
+  return true;
+}
+
+FileData* MemoryCache::EnsureLoaded(FileData* file_data) {
+  base::subtle::Atomic32 state =
+      base::subtle::Acquire_Load(&file_data->load_state);
+  if (state == LOAD_PENDING) {
+    base::AutoLock lock(file_data->load_lock);
+    state = base::subtle::NoBarrier_Load(&file_data->load_state);
+    if (state == LOAD_PENDING) {
+      state = LoadFileData(file_data) ? LOAD_DONE : LOAD_FAILED;
+      base::subtle::Release_Store(&file_data->load_state, state);
+    }
+  }
+  return state == LOAD_DONE ? file_data : NULL;
 }
 
 FileData* MemoryCache::GetFileData(const std::string& filename) {
@@ -216,7 +254,7 @@ FileData* MemoryCache::GetFileData(const std::string& filename) {
   if (fi == files_.end()) {
     return NULL;
   }
-  return &(fi->second);
+  return EnsureLoaded(fi->second);
 }
 
 bool MemoryCache::AssignFileData(const std::string& filename,
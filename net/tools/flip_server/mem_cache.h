@@ -5,11 +5,15 @@
 #ifndef NET_TOOLS_FLIP_SERVER_MEM_CACHE_H_
 #define NET_TOOLS_FLIP_SERVER_MEM_CACHE_H_
 
-#include <map>
 #include <string>
 #include <vector>
 
+#include "base/atomicops.h"
+#include "base/basictypes.h"
 #include "base/compiler_specific.h"
+#include "base/hash_tables.h"
+#include "base/string_piece.h"
+#include "base/synchronization/lock.h"
 #include "net/tools/flip_server/balsa_headers.h"
 #include "net/tools/flip_server/balsa_visitor_interface.h"
 #include "net/tools/flip_server/constants.h"
@@ -56,23 +60,46 @@ class StoreBodyAndHeadersVisitor: public BalsaVisitorInterface {
   virtual void HandleBodyError(BalsaFrame* framer) OVERRIDE;
 
   BalsaHeaders headers;
+  // Body bytes which arrived as one contiguous run of the framer's input.
+  // They are only copied into |body| once a discontinuity (e.g. chunk
+  // framing) shows up, so identity bodies can be served from the input.
+  base::StringPiece body_input;
   std::string body;
   bool error_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// A cached response.  Entries are created by MemoryCache::AddFiles() without
+// touching the file; the file is mmap()ed and its headers parsed the first
+// time the entry is looked up.  Once loaded, |body| points into the mapping
+// (or into |body_storage| for chunk-encoded captures) and stays valid until
+// the MemoryCache is destroyed, so connections may send it by reference.
 struct FileData {
-  FileData();
-  FileData(BalsaHeaders* h, const std::string& b);
+  explicit FileData(const std::string& p);
   ~FileData();
-  void CopyFrom(const FileData& file_data);
 
   BalsaHeaders* headers;
   std::string filename;
   // priority, filename
   std::vector< std::pair<int, std::string> > related_files;
-  std::string body;
+  base::StringPiece body;
+
+  // Path of the capture on disk.
+  std::string path;
+  // Owned copy of the body, used when it could not be mapped in place.
+  std::string body_storage;
+  // The read-only mapping of |path|, or NULL.
+  void* mapping;
+  size_t mapping_size;
+
+  // One of MemoryCache::LoadState.  Only moves away from LOAD_PENDING while
+  // holding |load_lock|.
+  base::subtle::Atomic32 load_state;
+  base::Lock load_lock;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(FileData);
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -106,28 +133,47 @@ class MemCacheIter {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// The set of files is fixed once AddFiles() returns, so lookups take no lock
+// and the cache may be shared by all the accept threads of an acceptor.
+// Loading an entry only locks that entry.
 class MemoryCache {
  public:
-  typedef std::map<std::string, FileData> Files;
+  typedef base::hash_map<std::string, FileData*> Files;
+
+  enum LoadState {
+    LOAD_PENDING,
+    LOAD_DONE,
+    LOAD_FAILED
+  };
 
  public:
   MemoryCache();
   ~MemoryCache();
 
-  void CloneFrom(const MemoryCache& mc);
-
+  // Registers every file under FLAGS_cache_base_dir/GET_.  Only directories
+  // are read; file contents are loaded on first use.
   void AddFiles();
 
-  void ReadToString(const char* filename, std::string* output);
-
-  void ReadAndStoreFileContents(const char* filename);
-
+  // Returns the loaded entry for |filename|, or NULL if there is none or it
+  // could not be parsed.
   FileData* GetFileData(const std::string& filename);
 
   bool AssignFileData(const std::string& filename, MemCacheIter* mci);
 
   Files files_;
   std::string cwd_;
+
+ private:
+  void AddFile(const std::string& path);
+
+  // Maps and frames |file_data->path|.  Returns false if the file could not
+  // be read or framed.
+  bool LoadFileData(FileData* file_data);
+
+  // Returns |file_data| once it is loaded, loading it if needed.
+  FileData* EnsureLoaded(FileData* file_data);
+
+  DISALLOW_COPY_AND_ASSIGN(MemoryCache);
 };
 
 class NotifierInterface {
@@ -7,7 +7,9 @@
 #include <errno.h>
 #include <netinet/tcp.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
+#include <algorithm>
 #include <list>
 #include <string>
 
@@ -20,6 +22,13 @@
 
 namespace net {
 
+namespace {
+
+// The most frames gathered into one sendmsg() call.
+const int kMaxIovecs = 64;
+
+}  // namespace
+
 // static
 bool SMConnection::force_spdy_ = false;
 
@@ -224,6 +233,45 @@ int SMConnection::Send(const char* data, int len, int flags) {
   return rv;
 }
 
+ssize_t SMConnection::SendOutputList(int flags) {
+  DCHECK(!ssl_);
+  struct iovec iov[kMaxIovecs];
+  int iov_count = 0;
+  for (OutputList::iterator i = output_list_.begin();
+       i != output_list_.end() && iov_count < kMaxIovecs;
+       ++i) {
+    DataFrame* data_frame = *i;
+    if (data_frame->index >= data_frame->size)
+      continue;
+    iov[iov_count].iov_base =
+        const_cast<char*>(data_frame->data + data_frame->index);
+    iov[iov_count].iov_len = data_frame->size - data_frame->index;
+    ++iov_count;
+  }
+
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = iov_count;
+  CorkSocket();
+  ssize_t rv = sendmsg(fd_, &msg, flags);
+  if (rv > 0) {
+    size_t remaining = rv;
+    for (OutputList::iterator i = output_list_.begin();
+         i != output_list_.end() && remaining > 0;
+         ++i) {
+      DataFrame* data_frame = *i;
+      size_t consumed = std::min(remaining,
+                                 data_frame->size - data_frame->index);
+      data_frame->index += consumed;
+      remaining -= consumed;
+    }
+  }
+  if (!(flags & MSG_MORE))
+    UncorkSocket();
+  return rv;
+}
+
 void SMConnection::OnRegistration(EpollServer* eps, int fd, int event_mask) {
   registered_in_epoll_server_ = true;
 }
@@ -574,8 +622,17 @@ bool SMConnection::DoWrite() {
               << ": Adding MSG_MORE flag";
       flags |= MSG_MORE;
     }
-    VLOG(2) << log_prefix_ << "Attempting to send " << size << " bytes.";
-    ssize_t bytes_written = Send(bytes, size, flags);
+    // Without SSL, the frames behind |this| one go out in the same call.
+    bool gathered = !ssl_ && output_list_.size() > 1;
+    ssize_t bytes_written;
+    if (gathered) {
+      VLOG(2) << log_prefix_ << "Attempting to send up to "
+              << output_list_.size() << " frames.";
+      bytes_written = SendOutputList(flags);
+    } else {
+      VLOG(2) << log_prefix_ << "Attempting to send " << size << " bytes.";
+      bytes_written = Send(bytes, size, flags);
+    }
     int stored_errno = errno;
     if (bytes_written == -1) {
       switch (stored_errno) {
@@ -597,7 +654,8 @@ bool SMConnection::DoWrite() {
     } else if (bytes_written > 0) {
       VLOG(2) << log_prefix_ << ACCEPTOR_CLIENT_IDENT << "Wrote: "
               << bytes_written << " bytes";
-      data_frame->index += bytes_written;
+      if (!gathered)
+        data_frame->index += bytes_written;
       bytes_sent += bytes_written;
       continue;
     } else if (bytes_written == -2) {
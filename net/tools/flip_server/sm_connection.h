@@ -78,6 +78,11 @@ class SMConnection : public SMConnectionInterface,
   void UncorkSocket();
 
   int Send(const char* data, int len, int flags);
+  // Writes as many queued frames as possible with a single sendmsg() and
+  // advances their indices.  Only used for non-SSL connections, where the
+  // frames (including bodies referenced from the MemoryCache) go straight
+  // from their buffers to the socket.
+  ssize_t SendOutputList(int flags);
 
   // EpollCallbackInterface interface.
   virtual void OnRegistration(EpollServer* eps,
@@ -489,6 +489,33 @@ void SpdySM::SendDataFrameImpl(uint32 stream_id, const char* data, int64 len,
   }
 }
 
+void SpdySM::SendCachedDataFrame(uint32 stream_id, const char* data,
+                                 int64 len) {
+  while (len > 0) {
+    int64 size = std::min(len, static_cast<int64>(kSpdySegmentSize));
+
+    // Build a frame with no payload and then fix up its length.  Only the
+    // frame header is built here, and the payload is queued behind it.
+    SpdyDataFrame* fdf = buffered_spdy_framer_->CreateDataFrame(
+        stream_id, NULL, 0, DATA_FLAG_NONE);
+    fdf->set_length(size);
+    DataFrame* df = new SpdyFrameDataFrame(fdf);
+    df->size = SpdyDataFrame::size();
+    EnqueueDataFrame(df);
+
+    df = new DataFrame;
+    df->data = data;
+    df->size = size;
+    EnqueueDataFrame(df);
+
+    VLOG(2) << ACCEPTOR_CLIENT_IDENT << "SpdySM: Sending cached data frame "
+            << stream_id << " [" << size << "]";
+
+    data += size;
+    len -= size;
+  }
+}
+
 void SpdySM::EnqueueDataFrame(DataFrame* df) {
   connection_->EnqueueDataFrame(df);
 }
@@ -534,20 +561,10 @@ void SpdySM::GetOutput() {
     if (num_to_write > mci->max_segment_size)
       num_to_write = mci->max_segment_size;
 
-    bool should_compress = false;
-    if (!mci->file_data->headers->HasHeader("content-encoding")) {
-      if (mci->file_data->headers->HasHeader("content-type")) {
-        std::string content_type =
-            mci->file_data->headers->GetHeader("content-type").as_string();
-        if (content_type.find("image") == content_type.npos)
-          should_compress = true;
-      }
-    }
-
-    SendDataFrame(mci->stream_id,
-                  mci->file_data->body.data() + mci->body_bytes_consumed,
-                  num_to_write, 0, should_compress);
-    VLOG(2) << ACCEPTOR_CLIENT_IDENT << "SpdySM: GetOutput SendDataFrame["
+    SendCachedDataFrame(mci->stream_id,
+                        mci->file_data->body.data() + mci->body_bytes_consumed,
+                        num_to_write);
+    VLOG(2) << ACCEPTOR_CLIENT_IDENT << "SpdySM: GetOutput SendCachedDataFrame["
             << mci->stream_id << "]: " << num_to_write;
     mci->body_bytes_consumed += num_to_write;
     mci->bytes_sent += num_to_write;
@@ -135,6 +135,10 @@ class SpdySM : public BufferedSpdyFramerVisitorInterface,
   size_t SendSynReplyImpl(uint32 stream_id, const BalsaHeaders& headers);
   void SendDataFrameImpl(uint32 stream_id, const char* data, int64 len,
                          SpdyDataFlags flags, bool compress);
+  // Like SendDataFrameImpl(), but queues |data| by reference instead of
+  // copying it.  |data| must outlive the connection, as MemoryCache bodies
+  // do.
+  void SendCachedDataFrame(uint32 stream_id, const char* data, int64 len);
   void EnqueueDataFrame(DataFrame* df);
   virtual void GetOutput() OVERRIDE;
  private:
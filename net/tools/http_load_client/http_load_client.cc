@@ -0,0 +1,229 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/http_load_client/http_load_client.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "base/eintr_wrapper.h"
+#include "base/string_number_conversions.h"
+#include "base/string_util.h"
+
+namespace net {
+
+namespace {
+
+const char kContentLength[] = "content-length:";
+const char kChunked[] = "transfer-encoding: chunked";
+
+// Opens a blocking TCP connection to |host|:|port|.  Returns -1 on failure.
+int Connect(const std::string& host, const std::string& port) {
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* results = NULL;
+  if (getaddrinfo(host.c_str(), port.c_str(), &hints, &results) != 0)
+    return -1;
+
+  int fd = socket(results->ai_family, results->ai_socktype,
+                  results->ai_protocol);
+  if (fd != -1 &&
+      HANDLE_EINTR(connect(fd, results->ai_addr, results->ai_addrlen)) != 0) {
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(results);
+  if (fd == -1)
+    return -1;
+
+  int on = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+  return fd;
+}
+
+}  // namespace
+
+HttpLoadConnection::HttpLoadConnection(const std::string& host,
+                                       const std::string& port)
+    : host_(host),
+      port_(port),
+      fd_(-1) {
+}
+
+HttpLoadConnection::~HttpLoadConnection() {
+  Close();
+}
+
+bool HttpLoadConnection::Send(const std::string& data) {
+  if (fd_ == -1) {
+    fd_ = Connect(host_, port_);
+    if (fd_ == -1)
+      return false;
+  }
+  if (HANDLE_EINTR(write(fd_, data.data(), data.size())) !=
+      static_cast<ssize_t>(data.size())) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+bool HttpLoadConnection::ReadResponse() {
+  size_t header_end;
+  while ((header_end = buffer_.find("\r\n\r\n")) == std::string::npos) {
+    if (!ReadMore())
+      return false;
+  }
+  header_end += 4;
+
+  std::string headers = StringToLowerASCII(buffer_.substr(0, header_end));
+  size_t response_end = header_end;
+  if (headers.find(kChunked) != std::string::npos) {
+    if (!SkipChunkedBody(&response_end))
+      return false;
+  } else {
+    size_t length_pos = headers.find(kContentLength);
+    if (length_pos == std::string::npos) {
+      Close();
+      return false;
+    }
+    length_pos += arraysize(kContentLength) - 1;
+    size_t length_end = headers.find("\r\n", length_pos);
+    std::string length_value;
+    TrimWhitespaceASCII(headers.substr(length_pos, length_end - length_pos),
+                        TRIM_ALL, &length_value);
+    int content_length = 0;
+    if (!base::StringToInt(length_value, &content_length) ||
+        content_length < 0) {
+      Close();
+      return false;
+    }
+    response_end += content_length;
+    while (buffer_.size() < response_end) {
+      if (!ReadMore())
+        return false;
+    }
+  }
+  buffer_.erase(0, response_end);
+  return true;
+}
+
+void HttpLoadConnection::Close() {
+  if (fd_ != -1)
+    close(fd_);
+  fd_ = -1;
+  buffer_.clear();
+}
+
+bool HttpLoadConnection::ReadMore() {
+  char buf[16 * 1024];
+  ssize_t rv = HANDLE_EINTR(read(fd_, buf, sizeof(buf)));
+  if (rv <= 0) {
+    Close();
+    return false;
+  }
+  buffer_.append(buf, rv);
+  return true;
+}
+
+bool HttpLoadConnection::FindLineEnd(size_t pos, size_t* line_end) {
+  while ((*line_end = buffer_.find("\r\n", pos)) == std::string::npos) {
+    if (!ReadMore())
+      return false;
+  }
+  return true;
+}
+
+bool HttpLoadConnection::SkipChunkedBody(size_t* pos) {
+  while (true) {
+    size_t line_end;
+    if (!FindLineEnd(*pos, &line_end))
+      return false;
+    // Ignore any chunk extensions.
+    std::string size_line = buffer_.substr(*pos, line_end - *pos);
+    size_line = size_line.substr(0, size_line.find(';'));
+    TrimWhitespaceASCII(size_line, TRIM_ALL, &size_line);
+    int chunk_size = 0;
+    if (!base::HexStringToInt(size_line, &chunk_size) || chunk_size < 0) {
+      Close();
+      return false;
+    }
+    *pos = line_end + 2;
+
+    if (chunk_size == 0) {
+      // Skip the trailers, which end with an empty line.
+      while (true) {
+        if (!FindLineEnd(*pos, &line_end))
+          return false;
+        bool empty_line = line_end == *pos;
+        *pos = line_end + 2;
+        if (empty_line)
+          return true;
+      }
+    }
+
+    // The chunk data is followed by a CRLF.
+    *pos += chunk_size + 2;
+    while (buffer_.size() < *pos) {
+      if (!ReadMore())
+        return false;
+    }
+  }
+}
+
+HttpLoadThread::HttpLoadThread(const std::string& host,
+                               const std::string& port,
+                               const std::string& requests,
+                               int responses_per_send)
+    : base::SimpleThread("HttpLoadThread"),
+      connection_(host, port),
+      requests_data_(requests),
+      responses_per_send_(responses_per_send),
+      stop_(0),
+      requests_(0),
+      errors_(0) {
+}
+
+HttpLoadThread::~HttpLoadThread() {}
+
+void HttpLoadThread::Stop() {
+  base::subtle::Release_Store(&stop_, 1);
+}
+
+void HttpLoadThread::Run() {
+  while (!base::subtle::Acquire_Load(&stop_)) {
+    base::TimeTicks start = base::TimeTicks::Now();
+    bool ok = connection_.Send(requests_data_);
+    for (int i = 0; ok && i < responses_per_send_; ++i)
+      ok = connection_.ReadResponse();
+    if (!ok) {
+      ++errors_;
+      connection_.Close();
+      continue;
+    }
+    latencies_us_.push_back((base::TimeTicks::Now() - start).InMicroseconds());
+    requests_ += responses_per_send_;
+  }
+}
+
+double RunHttpLoadThreads(const std::vector<HttpLoadThread*>& threads,
+                          base::TimeDelta duration) {
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i]->Start();
+  usleep(duration.InMicroseconds());
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i]->Stop();
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i]->Join();
+  return (base::TimeTicks::Now() - start).InSecondsF();
+}
+
+}  // namespace net
@@ -0,0 +1,103 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Client side of the HTTP load tools (http_server_load_test and
+// flip_load_generator): blocking keep-alive connections driven in a loop by
+// one thread each.
+
+#ifndef NET_TOOLS_HTTP_LOAD_CLIENT_HTTP_LOAD_CLIENT_H_
+#define NET_TOOLS_HTTP_LOAD_CLIENT_HTTP_LOAD_CLIENT_H_
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/basictypes.h"
+#include "base/compiler_specific.h"
+#include "base/threading/simple_thread.h"
+#include "base/time.h"
+
+namespace net {
+
+// A blocking HTTP/1.1 client connection.  Responses may be delimited by a
+// chunked body or by Content-Length.
+class HttpLoadConnection {
+ public:
+  HttpLoadConnection(const std::string& host, const std::string& port);
+  ~HttpLoadConnection();
+
+  // Writes |data|, connecting first if needed.  Returns false on failure,
+  // after which the connection is closed.
+  bool Send(const std::string& data);
+
+  // Reads one response.  Whatever follows it stays buffered for the next
+  // call, so pipelined responses are read in turn.  Returns false on failure,
+  // after which the connection is closed.
+  bool ReadResponse();
+
+  void Close();
+
+ private:
+  // Reads more data into |buffer_|.  Returns false at EOF or on error.
+  bool ReadMore();
+
+  // Sets |*line_end| to the CRLF that ends the line starting at |pos|,
+  // reading as needed.
+  bool FindLineEnd(size_t pos, size_t* line_end);
+
+  // Reads past the chunked body starting at |*pos|, through the zero-length
+  // chunk and the trailers after it.
+  bool SkipChunkedBody(size_t* pos);
+
+  const std::string host_;
+  const std::string port_;
+  int fd_;
+  std::string buffer_;
+
+  DISALLOW_COPY_AND_ASSIGN(HttpLoadConnection);
+};
+
+// Sends |requests| over one connection and reads |responses_per_send|
+// responses, over and over until Stop() is called.  A connection that fails
+// counts as an error and is reopened.
+class HttpLoadThread : public base::SimpleThread {
+ public:
+  HttpLoadThread(const std::string& host,
+                 const std::string& port,
+                 const std::string& requests,
+                 int responses_per_send);
+  virtual ~HttpLoadThread();
+
+  // May be called from any thread.
+  void Stop();
+
+  virtual void Run() OVERRIDE;
+
+  // How long each successful round trip took.
+  const std::vector<int64>& latencies_us() const { return latencies_us_; }
+  // The number of responses read.
+  int64 requests() const { return requests_; }
+  int errors() const { return errors_; }
+
+ private:
+  HttpLoadConnection connection_;
+  const std::string requests_data_;
+  const int responses_per_send_;
+  base::subtle::Atomic32 stop_;
+  std::vector<int64> latencies_us_;
+  int64 requests_;
+  int errors_;
+
+  DISALLOW_COPY_AND_ASSIGN(HttpLoadThread);
+};
+
+// Starts |threads|, stops them after |duration| and waits for them to finish.
+// Returns how long they ran, in seconds.
+double RunHttpLoadThreads(const std::vector<HttpLoadThread*>& threads,
+                          base::TimeDelta duration);
+
+}  // namespace net
+
+#endif  // NET_TOOLS_HTTP_LOAD_CLIENT_HTTP_LOAD_CLIENT_H_
@@ -0,0 +1,154 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Local load test for net::HttpServer.  It starts an HttpServer on an IO
+// thread that answers every request with a small 200 response, then runs
+// --connections client threads against it for --duration seconds.  Each
+// client keeps one keep-alive connection and writes --pipeline requests at a
+// time before reading their responses.  Prints requests/sec.
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/basictypes.h"
+#include "base/bind.h"
+#include "base/command_line.h"
+#include "base/compiler_specific.h"
+#include "base/memory/ref_counted.h"
+#include "base/message_loop.h"
+#include "base/string_number_conversions.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/thread.h"
+#include "base/time.h"
+#include "net/server/http_server.h"
+#include "net/server/http_server_request_info.h"
+#include "net/tools/http_load_client/http_load_client.h"
+
+namespace {
+
+const char kHost[] = "127.0.0.1";
+const char kResponseBody[] = "ok";
+
+class OkDelegate : public net::HttpServer::Delegate {
+ public:
+  OkDelegate() : server_(NULL) {}
+
+  void set_server(net::HttpServer* server) { server_ = server; }
+
+  virtual void OnHttpRequest(
+      int connection_id,
+      const net::HttpServerRequestInfo& info) OVERRIDE {
+    server_->Send200(connection_id, kResponseBody, "text/plain");
+  }
+
+  virtual void OnWebSocketRequest(
+      int connection_id,
+      const net::HttpServerRequestInfo& info) OVERRIDE {
+    server_->Send404(connection_id);
+  }
+
+  virtual void OnWebSocketMessage(int connection_id,
+                                  const std::string& data) OVERRIDE {}
+
+  virtual void OnClose(int connection_id) OVERRIDE {}
+
+ private:
+  net::HttpServer* server_;
+
+  DISALLOW_COPY_AND_ASSIGN(OkDelegate);
+};
+
+// Owns the server; created and destroyed on the IO thread.
+scoped_refptr<net::HttpServer> g_server;
+
+void StartServer(OkDelegate* delegate, int port,
+                 base::WaitableEvent* started) {
+  g_server = new net::HttpServer(kHost, port, delegate);
+  delegate->set_server(g_server.get());
+  started->Signal();
+}
+
+void StopServer(base::WaitableEvent* stopped) {
+  g_server = NULL;
+  stopped->Signal();
+}
+
+int Usage(const char* argv0) {
+  fprintf(stderr,
+          "Usage: %s [--port=9331] [--connections=8] [--pipeline=1]"
+          " [--duration=<seconds>]\n", argv0);
+  return 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit_manager;
+  CommandLine::Init(argc, argv);
+  const CommandLine& cl = *CommandLine::ForCurrentProcess();
+
+  int port = 9331;
+  int connections = 8;
+  int pipeline = 1;
+  int duration_s = 10;
+  if ((cl.HasSwitch("port") &&
+       !base::StringToInt(cl.GetSwitchValueASCII("port"), &port)) ||
+      (cl.HasSwitch("connections") &&
+       !base::StringToInt(cl.GetSwitchValueASCII("connections"),
+                          &connections)) ||
+      (cl.HasSwitch("pipeline") &&
+       !base::StringToInt(cl.GetSwitchValueASCII("pipeline"), &pipeline)) ||
+      (cl.HasSwitch("duration") &&
+       !base::StringToInt(cl.GetSwitchValueASCII("duration"), &duration_s)) ||
+      connections <= 0 || pipeline <= 0) {
+    return Usage(argv[0]);
+  }
+
+  base::Thread io_thread("HttpServerLoadTestIO");
+  if (!io_thread.StartWithOptions(
+          base::Thread::Options(MessageLoop::TYPE_IO, 0))) {
+    fprintf(stderr, "Unable to start the IO thread\n");
+    return 1;
+  }
+
+  OkDelegate delegate;
+  base::WaitableEvent server_event(false, false);
+  io_thread.message_loop()->PostTask(
+      FROM_HERE, base::Bind(&StartServer, &delegate, port, &server_event));
+  server_event.Wait();
+
+  std::string request = std::string("GET /ok HTTP/1.1\r\nHost: ") + kHost +
+                        "\r\nConnection: keep-alive\r\n\r\n";
+  std::string requests;
+  for (int i = 0; i < pipeline; ++i)
+    requests += request;
+
+  std::vector<net::HttpLoadThread*> clients;
+  for (int i = 0; i < connections; ++i) {
+    clients.push_back(new net::HttpLoadThread(kHost, base::IntToString(port),
+                                              requests, pipeline));
+  }
+  double seconds = net::RunHttpLoadThreads(
+      clients, base::TimeDelta::FromSeconds(duration_s));
+
+  int64 requests_done = 0;
+  int errors = 0;
+  for (size_t i = 0; i < clients.size(); ++i) {
+    requests_done += clients[i]->requests();
+    errors += clients[i]->errors();
+    delete clients[i];
+  }
+
+  io_thread.message_loop()->PostTask(
+      FROM_HERE, base::Bind(&StopServer, &server_event));
+  server_event.Wait();
+  io_thread.Stop();
+
+  printf("%d connections, pipeline depth %d: %.0f requests/s, %d errors\n",
+         connections, pipeline, requests_done / seconds, errors);
+  return errors ? 1 : 0;
+}
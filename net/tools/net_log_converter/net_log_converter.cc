@@ -0,0 +1,51 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This utility converts a capture written with --log-net-log-binary into the
+// JSON format written by --log-net-log, which about:net-internals can load.
+
+#include <stdio.h>
+
+#include <string>
+
+#include "base/at_exit.h"
+#include "base/file_util.h"
+#include "net/base/binary_net_log.h"
+
+static int Usage(const char* argv0) {
+  fprintf(stderr, "Usage: %s <binary net log> [<output file>]\n", argv0);
+  return 1;
+}
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit_manager;
+
+  if (argc < 2 || argc > 3)
+    return Usage(argv[0]);
+
+  std::string data;
+  if (!file_util::ReadFileToString(FilePath::FromUTF8Unsafe(argv[1]), &data)) {
+    fprintf(stderr, "Failed to read %s\n", argv[1]);
+    return 1;
+  }
+
+  std::string json;
+  if (!net::BinaryNetLogReader::ConvertToJSON(data, &json)) {
+    fprintf(stderr, "%s is not a binary net log\n", argv[1]);
+    return 1;
+  }
+
+  if (argc < 3) {
+    fwrite(json.data(), 1, json.size(), stdout);
+    return 0;
+  }
+
+  FilePath output_filename = FilePath::FromUTF8Unsafe(argv[2]);
+  if (file_util::WriteFile(output_filename, json.data(), json.size()) !=
+      static_cast<int>(json.size())) {
+    fprintf(stderr, "Failed to write %s\n", argv[2]);
+    return 1;
+  }
+  return 0;
+}
@@ -7,8 +7,16 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <netdb.h>
+#include <string.h>
 #include <sys/socket.h>
+#if defined(OS_LINUX)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
 
+#include "base/atomicops.h"
 #include "base/eintr_wrapper.h"
 #include "base/logging.h"
 #include "base/message_loop.h"
@@ -30,10 +38,105 @@ static const int kBindRetries = 10;
 static const int kPortStart = 1024;
 static const int kPortEnd = 65535;
 
+// The most datagrams moved by one recvmmsg()/sendmmsg() call.
+static const int kMaxDatagramsPerSyscall = 64;
+
+#if defined(OS_LINUX)
+// Cleared the first time the kernel reports recvmmsg()/sendmmsg() missing;
+// from then on batches fall back to a syscall per datagram.  Any thread may
+// clear them; one that still sees the old value only makes one more call
+// that fails with ENOSYS.
+base::subtle::Atomic32 g_have_recvmmsg = 1;
+base::subtle::Atomic32 g_have_sendmmsg = 1;
+
+// The kernel's struct mmsghdr.  glibc only declares it, recvmmsg() and
+// sendmmsg() from 2.12 and 2.14 on, so the syscalls are made directly; a
+// build without the syscall numbers behaves like a kernel without the calls.
+struct MMsgHdr {
+  struct msghdr msg_hdr;
+  unsigned int msg_len;
+};
+
+int RecvMMsg(int fd, MMsgHdr* msgs, unsigned int count) {
+#if defined(__NR_recvmmsg)
+  return syscall(__NR_recvmmsg, fd, msgs, count, 0, NULL);
+#else
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+int SendMMsg(int fd, MMsgHdr* msgs, unsigned int count) {
+#if defined(__NR_sendmmsg)
+  return syscall(__NR_sendmmsg, fd, msgs, count, 0);
+#else
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+#endif
+
 }  // namespace net
 
 namespace net {
 
+DatagramBatch::DatagramBatch(int capacity, int max_datagram_size)
+    : buffer_(new IOBuffer(capacity * max_datagram_size)),
+      capacity_(capacity),
+      max_datagram_size_(max_datagram_size),
+      size_(0),
+      lengths_(capacity),
+      addresses_(capacity),
+      address_lengths_(capacity) {
+  DCHECK_GT(capacity, 0);
+  DCHECK_GT(max_datagram_size, 0);
+}
+
+DatagramBatch::~DatagramBatch() {}
+
+char* DatagramBatch::data(int index) const {
+  DCHECK_LT(index, size_);
+  return buffer_->data() + index * max_datagram_size_;
+}
+
+bool DatagramBatch::GetAddress(int index, IPEndPoint* address) const {
+  DCHECK_LT(index, size_);
+  if (address_lengths_[index] == 0)
+    return false;
+  return address->FromSockAddr(
+      reinterpret_cast<const struct sockaddr*>(&addresses_[index]),
+      address_lengths_[index]);
+}
+
+bool DatagramBatch::Append(const char* data, int len,
+                           const IPEndPoint& address) {
+  if (size_ == capacity_)
+    return false;
+  size_t addr_len = sizeof(addresses_[size_]);
+  if (!address.ToSockAddr(
+          reinterpret_cast<struct sockaddr*>(&addresses_[size_]), &addr_len)) {
+    return false;
+  }
+  if (!Append(data, len))
+    return false;
+  address_lengths_[size_ - 1] = addr_len;
+  return true;
+}
+
+bool DatagramBatch::Append(const char* data, int len) {
+  if (size_ == capacity_ || len < 0 || len > max_datagram_size_)
+    return false;
+  memcpy(buffer_->data() + size_ * max_datagram_size_, data, len);
+  lengths_[size_] = len;
+  address_lengths_[size_] = 0;
+  ++size_;
+  return true;
+}
+
+void DatagramBatch::Clear() {
+  size_ = 0;
+}
+
 UDPSocketLibevent::UDPSocketLibevent(
     DatagramSocket::BindType bind_type,
     const RandIntCallback& rand_int_cb,
@@ -47,6 +150,9 @@ UDPSocketLibevent::UDPSocketLibevent(
           read_buf_len_(0),
           recv_from_address_(NULL),
           write_buf_len_(0),
+          read_batch_(NULL),
+          write_batch_(NULL),
+          write_batch_sent_(0),
           net_log_(BoundNetLog::Make(net_log, NetLog::SOURCE_UDP_SOCKET)) {
   scoped_refptr<NetLog::EventParameters> params;
   if (source.is_valid())
@@ -76,6 +182,9 @@ void UDPSocketLibevent::Close() {
   write_buf_len_ = 0;
   write_callback_.Reset();
   send_to_address_.reset();
+  read_batch_ = NULL;
+  write_batch_ = NULL;
+  write_batch_sent_ = 0;
 
   bool ok = read_socket_watcher_.StopWatchingFileDescriptor();
   DCHECK(ok);
@@ -153,8 +262,8 @@ int UDPSocketLibevent::RecvFrom(IOBuffer* buf,
   if (nread != ERR_IO_PENDING)
     return nread;
 
-  if (!MessageLoopForIO::current()->WatchFileDescriptor(
-          socket_, true, MessageLoopForIO::WATCH_READ,
+  if (!MessageLoopForIO::current()->WatchFileDescriptorEdgeTriggered(
+          socket_, MessageLoopForIO::WATCH_READ,
           &read_socket_watcher_, &read_watcher_)) {
     PLOG(ERROR) << "WatchFileDescriptor failed on read";
     int result = MapSystemError(errno);
@@ -196,8 +305,8 @@ int UDPSocketLibevent::SendToOrWrite(IOBuffer* buf,
   if (result != ERR_IO_PENDING)
     return result;
 
-  if (!MessageLoopForIO::current()->WatchFileDescriptor(
-          socket_, true, MessageLoopForIO::WATCH_WRITE,
+  if (!MessageLoopForIO::current()->WatchFileDescriptorEdgeTriggered(
+          socket_, MessageLoopForIO::WATCH_WRITE,
           &write_socket_watcher_, &write_watcher_)) {
     DVLOG(1) << "WatchFileDescriptor failed on write, errno " << errno;
     int result = MapSystemError(errno);
@@ -215,6 +324,61 @@ int UDPSocketLibevent::SendToOrWrite(IOBuffer* buf,
   return ERR_IO_PENDING;
 }
 
+int UDPSocketLibevent::RecvBatch(DatagramBatch* batch,
+                                 const CompletionCallback& callback) {
+  DCHECK(CalledOnValidThread());
+  DCHECK_NE(kInvalidSocket, socket_);
+  DCHECK(read_callback_.is_null());
+  DCHECK(!callback.is_null());  // Synchronous operation not supported
+
+  int nread = InternalRecvBatch(batch);
+  if (nread != ERR_IO_PENDING)
+    return nread;
+
+  if (!MessageLoopForIO::current()->WatchFileDescriptorEdgeTriggered(
+          socket_, MessageLoopForIO::WATCH_READ,
+          &read_socket_watcher_, &read_watcher_)) {
+    PLOG(ERROR) << "WatchFileDescriptor failed on read";
+    int result = MapSystemError(errno);
+    LogRead(result, NULL, 0, NULL);
+    return result;
+  }
+
+  read_batch_ = batch;
+  read_callback_ = callback;
+  return ERR_IO_PENDING;
+}
+
+int UDPSocketLibevent::SendBatch(DatagramBatch* batch,
+                                 const CompletionCallback& callback) {
+  DCHECK(CalledOnValidThread());
+  DCHECK_NE(kInvalidSocket, socket_);
+  DCHECK(write_callback_.is_null());
+  DCHECK(!callback.is_null());  // Synchronous operation not supported
+  DCHECK_GT(batch->size(), 0);
+
+  write_batch_ = batch;
+  write_batch_sent_ = 0;
+  int result = InternalSendBatch();
+  if (result != ERR_IO_PENDING) {
+    write_batch_ = NULL;
+    return result;
+  }
+
+  if (!MessageLoopForIO::current()->WatchFileDescriptorEdgeTriggered(
+          socket_, MessageLoopForIO::WATCH_WRITE,
+          &write_socket_watcher_, &write_watcher_)) {
+    DVLOG(1) << "WatchFileDescriptor failed on write, errno " << errno;
+    write_batch_ = NULL;
+    int result = MapSystemError(errno);
+    LogWrite(result, NULL, NULL);
+    return result;
+  }
+
+  write_callback_ = callback;
+  return ERR_IO_PENDING;
+}
+
 int UDPSocketLibevent::Connect(const IPEndPoint& address) {
   net_log_.BeginEvent(
       NetLog::TYPE_UDP_CONNECT,
@@ -315,6 +479,16 @@ void UDPSocketLibevent::DidCompleteRead() {
   }
 }
 
+void UDPSocketLibevent::DidCompleteRecvBatch() {
+  int result = InternalRecvBatch(read_batch_);
+  if (result != ERR_IO_PENDING) {
+    read_batch_ = NULL;
+    bool ok = read_socket_watcher_.StopWatchingFileDescriptor();
+    DCHECK(ok);
+    DoReadCallback(result);
+  }
+}
+
 void UDPSocketLibevent::LogRead(int result,
                                 const char* bytes,
                                 socklen_t addr_len,
@@ -367,6 +541,16 @@ void UDPSocketLibevent::DidCompleteWrite() {
   }
 }
 
+void UDPSocketLibevent::DidCompleteSendBatch() {
+  int result = InternalSendBatch();
+  if (result != ERR_IO_PENDING) {
+    write_batch_ = NULL;
+    write_batch_sent_ = 0;
+    write_socket_watcher_.StopWatchingFileDescriptor();
+    DoWriteCallback(result);
+  }
+}
+
 void UDPSocketLibevent::LogWrite(int result,
                                  const char* bytes,
                                  const IPEndPoint* address) const {
@@ -447,6 +631,175 @@ int UDPSocketLibevent::InternalSendTo(IOBuffer* buf, int buf_len,
   return result;
 }
 
+int UDPSocketLibevent::InternalRecvBatch(DatagramBatch* batch) {
+  batch->Clear();
+  int result = OK;
+  bool truncated = false;
+  while (batch->size_ < batch->capacity_) {
+    int first = batch->size_;
+    int count = std::min(batch->capacity_ - first, kMaxDatagramsPerSyscall);
+    int received = -1;
+    int msg_flags[kMaxDatagramsPerSyscall];
+    bool batched = false;
+#if defined(OS_LINUX)
+    if (base::subtle::NoBarrier_Load(&g_have_recvmmsg)) {
+      MMsgHdr msgs[kMaxDatagramsPerSyscall];
+      struct iovec iovs[kMaxDatagramsPerSyscall];
+      memset(msgs, 0, count * sizeof(msgs[0]));
+      for (int i = 0; i < count; ++i) {
+        iovs[i].iov_base =
+            batch->buffer_->data() + (first + i) * batch->max_datagram_size_;
+        iovs[i].iov_len = batch->max_datagram_size_;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &batch->addresses_[first + i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(batch->addresses_[first + i]);
+      }
+      received = HANDLE_EINTR(RecvMMsg(socket_, msgs, count));
+      if (received < 0 && errno == ENOSYS) {
+        base::subtle::NoBarrier_Store(&g_have_recvmmsg, 0);
+      } else {
+        batched = true;
+        for (int i = 0; i < received; ++i) {
+          batch->lengths_[first + i] = msgs[i].msg_len;
+          batch->address_lengths_[first + i] = msgs[i].msg_hdr.msg_namelen;
+          msg_flags[i] = msgs[i].msg_hdr.msg_flags;
+        }
+      }
+    }
+    if (!batched)
+#endif
+    {
+      // recvmsg() rather than recvfrom(), for MSG_TRUNC in msg_flags.
+      struct iovec iov;
+      iov.iov_base = batch->buffer_->data() + first * batch->max_datagram_size_;
+      iov.iov_len = batch->max_datagram_size_;
+      struct msghdr msg;
+      memset(&msg, 0, sizeof(msg));
+      msg.msg_iov = &iov;
+      msg.msg_iovlen = 1;
+      msg.msg_name = &batch->addresses_[first];
+      msg.msg_namelen = sizeof(batch->addresses_[first]);
+      received = HANDLE_EINTR(recvmsg(socket_, &msg, 0));
+      if (received >= 0) {
+        batch->lengths_[first] = received;
+        batch->address_lengths_[first] = msg.msg_namelen;
+        msg_flags[0] = msg.msg_flags;
+        received = 1;
+      }
+    }
+
+    if (received < 0) {
+      result = MapSystemError(errno);
+      break;
+    }
+    // Drop truncated datagrams, moving the ones after them down.
+    int kept = first;
+    for (int i = first; i < first + received; ++i) {
+      if (msg_flags[i - first] & MSG_TRUNC) {
+        truncated = true;
+        continue;
+      }
+      if (kept != i) {
+        memcpy(batch->buffer_->data() + kept * batch->max_datagram_size_,
+               batch->buffer_->data() + i * batch->max_datagram_size_,
+               batch->lengths_[i]);
+        batch->lengths_[kept] = batch->lengths_[i];
+        batch->addresses_[kept] = batch->addresses_[i];
+        batch->address_lengths_[kept] = batch->address_lengths_[i];
+      }
+      LogRead(batch->lengths_[kept], batch->buffer_->data() +
+                  kept * batch->max_datagram_size_,
+              batch->address_lengths_[kept],
+              reinterpret_cast<const struct sockaddr*>(
+                  &batch->addresses_[kept]));
+      ++kept;
+    }
+    batch->size_ = kept;
+    // A short batch means the queue is empty.  Without recvmmsg() keep
+    // going until recvmsg() says so.
+    if (batched && received < count)
+      break;
+  }
+
+  if (truncated) {
+    // The truncated datagrams are off the queue, so this is the only chance
+    // to report them; |batch| keeps the ones that fit.
+    result = ERR_MSG_TOO_BIG;
+  } else if (batch->size_ > 0) {
+    // Datagrams already taken off the queue are delivered even if a later
+    // call failed; the error, if it persists, is reported by the next call.
+    return batch->size_;
+  }
+  if (result != ERR_IO_PENDING)
+    LogRead(result, NULL, 0, NULL);
+  return result;
+}
+
+int UDPSocketLibevent::InternalSendBatch() {
+  DatagramBatch* batch = write_batch_;
+  while (write_batch_sent_ < batch->size_) {
+    int first = write_batch_sent_;
+    int count = std::min(batch->size_ - first, kMaxDatagramsPerSyscall);
+    int sent = -1;
+    bool batched = false;
+#if defined(OS_LINUX)
+    if (base::subtle::NoBarrier_Load(&g_have_sendmmsg)) {
+      MMsgHdr msgs[kMaxDatagramsPerSyscall];
+      struct iovec iovs[kMaxDatagramsPerSyscall];
+      memset(msgs, 0, count * sizeof(msgs[0]));
+      for (int i = 0; i < count; ++i) {
+        iovs[i].iov_base =
+            batch->buffer_->data() + (first + i) * batch->max_datagram_size_;
+        iovs[i].iov_len = batch->lengths_[first + i];
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        if (batch->address_lengths_[first + i]) {
+          msgs[i].msg_hdr.msg_name = &batch->addresses_[first + i];
+          msgs[i].msg_hdr.msg_namelen = batch->address_lengths_[first + i];
+        }
+      }
+      sent = HANDLE_EINTR(SendMMsg(socket_, msgs, count));
+      if (sent < 0 && errno == ENOSYS)
+        base::subtle::NoBarrier_Store(&g_have_sendmmsg, 0);
+      else
+        batched = true;
+    }
+    if (!batched)
+#endif
+    {
+      socklen_t addr_len = batch->address_lengths_[first];
+      sent = HANDLE_EINTR(sendto(
+          socket_,
+          batch->buffer_->data() + first * batch->max_datagram_size_,
+          batch->lengths_[first],
+          0,
+          addr_len ? reinterpret_cast<struct sockaddr*>(
+                         &batch->addresses_[first]) : NULL,
+          addr_len));
+      if (sent >= 0)
+        sent = 1;
+    }
+
+    if (sent < 0) {
+      int result = MapSystemError(errno);
+      if (result != ERR_IO_PENDING)
+        LogWrite(result, NULL, NULL);
+      return result;
+    }
+    for (int i = first; i < first + sent; ++i) {
+      IPEndPoint address;
+      bool has_address = net_log_.IsLoggingAllEvents() &&
+          batch->GetAddress(i, &address);
+      LogWrite(batch->lengths_[i],
+               batch->buffer_->data() + i * batch->max_datagram_size_,
+               has_address ? &address : NULL);
+    }
+    write_batch_sent_ += sent;
+  }
+  return batch->size_;
+}
+
 int UDPSocketLibevent::DoBind(const IPEndPoint& address) {
   struct sockaddr_storage addr_storage;
   size_t addr_len = sizeof(addr_storage);
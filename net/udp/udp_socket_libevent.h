@@ -6,6 +6,10 @@
 #define NET_UDP_UDP_SOCKET_LIBEVENT_H_
 #pragma once
 
+#include <sys/socket.h>
+
+#include <vector>
+
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/message_loop.h"
@@ -15,12 +19,62 @@
 #include "net/base/rand_callback.h"
 #include "net/base/io_buffer.h"
 #include "net/base/ip_endpoint.h"
+#include "net/base/net_export.h"
 #include "net/base/net_log.h"
 #include "net/udp/datagram_socket.h"
 
 namespace net {
 
-class UDPSocketLibevent : public base::NonThreadSafe {
+// A set of datagrams sent or received with one UDPSocketLibevent call.  All
+// the datagrams share one preallocated buffer of |capacity| slots of
+// |max_datagram_size| bytes, so a batch can be reused for any number of calls
+// without allocating.
+class NET_EXPORT_PRIVATE DatagramBatch {
+ public:
+  DatagramBatch(int capacity, int max_datagram_size);
+  ~DatagramBatch();
+
+  int capacity() const { return capacity_; }
+  int max_datagram_size() const { return max_datagram_size_; }
+
+  // The number of datagrams in the batch.
+  int size() const { return size_; }
+
+  // The payload of datagram |index|.
+  char* data(int index) const;
+  int length(int index) const { return lengths_[index]; }
+
+  // Copies the peer address of datagram |index| into |address|.  Returns
+  // false if the datagram has no address (i.e. it is for a connected
+  // socket).
+  bool GetAddress(int index, IPEndPoint* address) const;
+
+  // Adds a datagram to send, copying |len| bytes of |data| into the batch.
+  // |address| is the destination; the second form is for connected sockets.
+  // Returns false if the batch is full, |len| is more than
+  // max_datagram_size(), or |address| can't be converted.
+  bool Append(const char* data, int len, const IPEndPoint& address);
+  bool Append(const char* data, int len);
+
+  // Empties the batch, keeping its buffer.
+  void Clear();
+
+ private:
+  friend class UDPSocketLibevent;
+
+  scoped_refptr<IOBuffer> buffer_;
+  const int capacity_;
+  const int max_datagram_size_;
+  int size_;
+  std::vector<int> lengths_;
+  std::vector<struct sockaddr_storage> addresses_;
+  // 0 for datagrams without an address.
+  std::vector<socklen_t> address_lengths_;
+
+  DISALLOW_COPY_AND_ASSIGN(DatagramBatch);
+};
+
+class NET_EXPORT_PRIVATE UDPSocketLibevent : public base::NonThreadSafe {
  public:
   UDPSocketLibevent(DatagramSocket::BindType bind_type,
                     const RandIntCallback& rand_int_cb,
@@ -93,6 +147,27 @@ class UDPSocketLibevent : public base::NonThreadSafe {
              const IPEndPoint& address,
              const CompletionCallback& callback);
 
+  // Batched IO, for sockets that move bursts of small datagrams.  Where the
+  // platform has recvmmsg()/sendmmsg() a whole batch costs one syscall;
+  // elsewhere these still fill or send the whole batch, with one recvmsg()
+  // or sendto() per datagram.
+  //
+  // Receives as many datagrams as are queued, up to |batch|->capacity(),
+  // replacing the contents of |batch|.  Returns the number received, or
+  // ERR_IO_PENDING if none are queued, in which case |callback| is called
+  // with the number received once at least one arrives.  Datagrams longer
+  // than max_datagram_size() are dropped, and ERR_MSG_TOO_BIG is returned
+  // with the datagrams that did fit left in |batch|.  |batch| must stay alive
+  // until the callback is called.
+  int RecvBatch(DatagramBatch* batch, const CompletionCallback& callback);
+
+  // Sends every datagram in |batch|.  Returns |batch|->size(), a net error
+  // code, or ERR_IO_PENDING, in which case |callback| is called with the
+  // result once the send buffer has drained enough to finish.  On error the
+  // datagrams before the failing one have been sent.  |batch| must stay
+  // alive, and unchanged, until the callback is called.
+  int SendBatch(DatagramBatch* batch, const CompletionCallback& callback);
+
   // Set the receive buffer size (in bytes) for the socket.
   bool SetReceiveBufferSize(int32 size);
 
@@ -114,7 +189,11 @@ class UDPSocketLibevent : public base::NonThreadSafe {
     // MessageLoopForIO::Watcher methods
 
     virtual void OnFileCanReadWithoutBlocking(int /* fd */) OVERRIDE {
-      if (!socket_->read_callback_.is_null())
+      if (socket_->read_callback_.is_null())
+        return;
+      if (socket_->read_batch_)
+        socket_->DidCompleteRecvBatch();
+      else
         socket_->DidCompleteRead();
     }
 
@@ -135,7 +214,11 @@ class UDPSocketLibevent : public base::NonThreadSafe {
     virtual void OnFileCanReadWithoutBlocking(int /* fd */) OVERRIDE {}
 
     virtual void OnFileCanWriteWithoutBlocking(int /* fd */) OVERRIDE {
-      if (!socket_->write_callback_.is_null())
+      if (socket_->write_callback_.is_null())
+        return;
+      if (socket_->write_batch_)
+        socket_->DidCompleteSendBatch();
+      else
         socket_->DidCompleteWrite();
     }
 
@@ -149,6 +232,8 @@ class UDPSocketLibevent : public base::NonThreadSafe {
   void DoWriteCallback(int rv);
   void DidCompleteRead();
   void DidCompleteWrite();
+  void DidCompleteRecvBatch();
+  void DidCompleteSendBatch();
 
   // Handles stats and logging. |result| is the number of bytes transferred, on
   // success, or the net error code on failure. On success, LogRead takes in a
@@ -172,6 +257,10 @@ class UDPSocketLibevent : public base::NonThreadSafe {
   int InternalConnect(const IPEndPoint& address);
   int InternalRecvFrom(IOBuffer* buf, int buf_len, IPEndPoint* address);
   int InternalSendTo(IOBuffer* buf, int buf_len, const IPEndPoint* address);
+  int InternalRecvBatch(DatagramBatch* batch);
+  // Sends the datagrams of |write_batch_| from |write_batch_sent_| on.
+  // Returns the batch size once all are sent.
+  int InternalSendBatch();
 
   int DoBind(const IPEndPoint& address);
   int RandomBind(const IPEndPoint& address);
@@ -208,6 +297,12 @@ class UDPSocketLibevent : public base::NonThreadSafe {
   int write_buf_len_;
   scoped_ptr<IPEndPoint> send_to_address_;
 
+  // The batch of a pending RecvBatch() or SendBatch(), and how many of the
+  // latter's datagrams have gone out so far.
+  DatagramBatch* read_batch_;
+  DatagramBatch* write_batch_;
+  int write_batch_sent_;
+
   // External callback; called when read is complete.
   CompletionCallback read_callback_;
 
@@ -0,0 +1,138 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string.h>
+
+#include "base/message_loop.h"
+#include "base/perftimer.h"
+#include "base/stringprintf.h"
+#include "net/base/io_buffer.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_errors.h"
+#include "net/base/net_util.h"
+#include "net/base/test_completion_callback.h"
+#include "net/udp/udp_socket.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+// Bursts of DNS-sized datagrams, echoed over loopback.  A burst stays well
+// under the default socket buffers, so nothing is dropped.
+const int kRounds = 2000;
+const int kBurst = 32;
+const int kDatagramSize = 128;
+
+class UDPSocketPerfTest : public testing::Test {
+ protected:
+  UDPSocketPerfTest()
+      : loop_(MessageLoop::TYPE_IO),
+        server_(DatagramSocket::DEFAULT_BIND, RandIntCallback(), NULL,
+                NetLog::Source()),
+        client_(DatagramSocket::DEFAULT_BIND, RandIntCallback(), NULL,
+                NetLog::Source()) {}
+
+  virtual void SetUp() OVERRIDE {
+    IPAddressNumber localhost;
+    ASSERT_TRUE(ParseIPLiteralToNumber("127.0.0.1", &localhost));
+    ASSERT_EQ(OK, server_.Bind(IPEndPoint(localhost, 0)));
+    IPEndPoint server_address;
+    ASSERT_EQ(OK, server_.GetLocalAddress(&server_address));
+    ASSERT_EQ(OK, client_.Connect(server_address));
+  }
+
+  void LogPacketRate(const char* name, double seconds) {
+    // Each round sends and receives every datagram twice.
+    LogPerfResult(base::StringPrintf("UDPSocketEcho_%s", name).c_str(),
+                  4.0 * kRounds * kBurst / seconds, "packets/s");
+  }
+
+  MessageLoop loop_;
+  UDPSocket server_;
+  UDPSocket client_;
+};
+
+// One recvfrom()/sendto() per datagram.
+TEST_F(UDPSocketPerfTest, PerDatagram) {
+  scoped_refptr<IOBuffer> message(new IOBuffer(kDatagramSize));
+  memset(message->data(), 'u', kDatagramSize);
+  scoped_refptr<IOBuffer> buf(new IOBuffer(kDatagramSize));
+  IPEndPoint from;
+  TestCompletionCallback callback;
+
+  PerfTimer timer;
+  for (int round = 0; round < kRounds; ++round) {
+    for (int i = 0; i < kBurst; ++i) {
+      ASSERT_EQ(kDatagramSize, callback.GetResult(
+          client_.Write(message, kDatagramSize, callback.callback())));
+    }
+    for (int i = 0; i < kBurst; ++i) {
+      int rv = callback.GetResult(server_.RecvFrom(
+          buf, kDatagramSize, &from, callback.callback()));
+      ASSERT_EQ(kDatagramSize, rv);
+      ASSERT_EQ(kDatagramSize, callback.GetResult(
+          server_.SendTo(buf, rv, from, callback.callback())));
+    }
+    for (int i = 0; i < kBurst; ++i) {
+      ASSERT_EQ(kDatagramSize, callback.GetResult(
+          client_.Read(buf, kDatagramSize, callback.callback())));
+    }
+  }
+  LogPacketRate("PerDatagram", timer.Elapsed().InSecondsF());
+}
+
+#if defined(OS_POSIX)
+// Receives into |batch| until |count| datagrams have arrived.  The batch
+// ends up holding the last ones received.
+void RecvAll(UDPSocket* socket, DatagramBatch* batch, int count) {
+  TestCompletionCallback callback;
+  for (int received = 0; received < count;) {
+    int rv = callback.GetResult(socket->RecvBatch(batch, callback.callback()));
+    ASSERT_GT(rv, 0);
+    received += rv;
+  }
+}
+
+// recvmmsg()/sendmmsg() for each burst.
+TEST_F(UDPSocketPerfTest, Batched) {
+  char message[kDatagramSize];
+  memset(message, 'u', kDatagramSize);
+  DatagramBatch client_batch(kBurst, kDatagramSize);
+  for (int i = 0; i < kBurst; ++i)
+    ASSERT_TRUE(client_batch.Append(message, kDatagramSize));
+  DatagramBatch server_batch(kBurst, kDatagramSize);
+  DatagramBatch echo_batch(kBurst, kDatagramSize);
+  DatagramBatch read_batch(kBurst, kDatagramSize);
+  TestCompletionCallback callback;
+
+  PerfTimer timer;
+  for (int round = 0; round < kRounds; ++round) {
+    ASSERT_EQ(kBurst, callback.GetResult(
+        client_.SendBatch(&client_batch, callback.callback())));
+
+    echo_batch.Clear();
+    while (echo_batch.size() < kBurst) {
+      int rv = callback.GetResult(
+          server_.RecvBatch(&server_batch, callback.callback()));
+      ASSERT_GT(rv, 0);
+      for (int i = 0; i < rv; ++i) {
+        IPEndPoint from;
+        ASSERT_TRUE(server_batch.GetAddress(i, &from));
+        ASSERT_TRUE(echo_batch.Append(server_batch.data(i),
+                                      server_batch.length(i), from));
+      }
+    }
+    ASSERT_EQ(kBurst, callback.GetResult(
+        server_.SendBatch(&echo_batch, callback.callback())));
+
+    RecvAll(&client_, &read_batch, kBurst);
+  }
+  LogPacketRate("Batched", timer.Elapsed().InSecondsF());
+}
+#endif  // defined(OS_POSIX)
+
+}  // namespace
+
+}  // namespace net
@@ -4,6 +4,7 @@
 
 #include "net/udp/udp_client_socket.h"
 #include "net/udp/udp_server_socket.h"
+#include "net/udp/udp_socket.h"
 
 #include "base/basictypes.h"
 #include "base/bind.h"
@@ -444,6 +445,152 @@ TEST_F(UDPSocketTest, CloseWithPendingRead) {
   EXPECT_FALSE(callback.have_result());
 }
 
+#if defined(OS_POSIX)
+
+// Receives datagrams into |batch| until it holds |count| of them.  Returns
+// false on error.
+bool RecvBatchFully(UDPSocket* socket, DatagramBatch* batch, int count,
+                    std::vector<std::string>* datagrams,
+                    std::vector<IPEndPoint>* addresses) {
+  while (static_cast<int>(datagrams->size()) < count) {
+    TestCompletionCallback callback;
+    int rv = callback.GetResult(socket->RecvBatch(batch, callback.callback()));
+    if (rv <= 0)
+      return false;
+    EXPECT_EQ(rv, batch->size());
+    for (int i = 0; i < batch->size(); ++i) {
+      datagrams->push_back(std::string(batch->data(i), batch->length(i)));
+      IPEndPoint address;
+      EXPECT_TRUE(batch->GetAddress(i, &address));
+      addresses->push_back(address);
+    }
+  }
+  return true;
+}
+
+TEST_F(UDPSocketTest, SendAndRecvBatch) {
+  const char* const kMessages[] = { "one", "two", "three" };
+  const int kCount = arraysize(kMessages);
+
+  IPEndPoint bind_address;
+  CreateUDPAddress("127.0.0.1", 0, &bind_address);
+  UDPSocket server(DatagramSocket::DEFAULT_BIND, RandIntCallback(), NULL,
+                   NetLog::Source());
+  ASSERT_EQ(OK, server.Bind(bind_address));
+  IPEndPoint server_address;
+  ASSERT_EQ(OK, server.GetLocalAddress(&server_address));
+
+  UDPSocket client(DatagramSocket::DEFAULT_BIND, RandIntCallback(), NULL,
+                   NetLog::Source());
+  ASSERT_EQ(OK, client.Connect(server_address));
+  IPEndPoint client_address;
+  ASSERT_EQ(OK, client.GetLocalAddress(&client_address));
+
+  // The client's socket is connected, so its datagrams have no address.
+  DatagramBatch batch(4, kMaxRead);
+  for (int i = 0; i < kCount; ++i)
+    EXPECT_TRUE(batch.Append(kMessages[i], strlen(kMessages[i])));
+  EXPECT_FALSE(batch.GetAddress(0, &bind_address));
+  TestCompletionCallback send_callback;
+  EXPECT_EQ(kCount, send_callback.GetResult(
+      client.SendBatch(&batch, send_callback.callback())));
+
+  std::vector<std::string> datagrams;
+  std::vector<IPEndPoint> addresses;
+  ASSERT_TRUE(RecvBatchFully(&server, &batch, kCount, &datagrams,
+                             &addresses));
+  ASSERT_EQ(static_cast<size_t>(kCount), datagrams.size());
+  for (int i = 0; i < kCount; ++i) {
+    EXPECT_EQ(kMessages[i], datagrams[i]);
+    EXPECT_TRUE(client_address == addresses[i]);
+  }
+
+  // Echo them back, addressed this time.
+  batch.Clear();
+  for (int i = 0; i < kCount; ++i) {
+    EXPECT_TRUE(batch.Append(datagrams[i].data(), datagrams[i].size(),
+                             addresses[i]));
+  }
+  TestCompletionCallback echo_callback;
+  EXPECT_EQ(kCount, echo_callback.GetResult(
+      server.SendBatch(&batch, echo_callback.callback())));
+
+  datagrams.clear();
+  addresses.clear();
+  ASSERT_TRUE(RecvBatchFully(&client, &batch, kCount, &datagrams,
+                             &addresses));
+  for (int i = 0; i < kCount; ++i) {
+    EXPECT_EQ(kMessages[i], datagrams[i]);
+    EXPECT_TRUE(server_address == addresses[i]);
+  }
+}
+
+TEST_F(UDPSocketTest, DatagramBatchLimits) {
+  DatagramBatch batch(2, 4);
+  EXPECT_EQ(0, batch.size());
+  EXPECT_FALSE(batch.Append("toolong", 7));
+  EXPECT_TRUE(batch.Append("a", 1));
+  EXPECT_TRUE(batch.Append("bcde", 4));
+  EXPECT_FALSE(batch.Append("f", 1));
+  EXPECT_EQ(2, batch.size());
+  EXPECT_EQ(std::string("bcde"), std::string(batch.data(1), batch.length(1)));
+  batch.Clear();
+  EXPECT_EQ(0, batch.size());
+  EXPECT_TRUE(batch.Append("f", 1));
+}
+
+// Datagrams too long for the batch's slots are dropped and reported.
+TEST_F(UDPSocketTest, RecvBatchTruncated) {
+  const char* const kMessages[] = { "ok", "toolong", "fine" };
+  const int kCount = arraysize(kMessages);
+
+  IPEndPoint bind_address;
+  CreateUDPAddress("127.0.0.1", 0, &bind_address);
+  UDPSocket server(DatagramSocket::DEFAULT_BIND, RandIntCallback(), NULL,
+                   NetLog::Source());
+  ASSERT_EQ(OK, server.Bind(bind_address));
+  IPEndPoint server_address;
+  ASSERT_EQ(OK, server.GetLocalAddress(&server_address));
+
+  UDPSocket client(DatagramSocket::DEFAULT_BIND, RandIntCallback(), NULL,
+                   NetLog::Source());
+  ASSERT_EQ(OK, client.Connect(server_address));
+
+  DatagramBatch send_batch(4, kMaxRead);
+  for (int i = 0; i < kCount; ++i)
+    EXPECT_TRUE(send_batch.Append(kMessages[i], strlen(kMessages[i])));
+  TestCompletionCallback send_callback;
+  EXPECT_EQ(kCount, send_callback.GetResult(
+      client.SendBatch(&send_batch, send_callback.callback())));
+
+  DatagramBatch batch(4, 4);
+  TestCompletionCallback callback;
+  EXPECT_EQ(ERR_MSG_TOO_BIG,
+            callback.GetResult(server.RecvBatch(&batch, callback.callback())));
+  ASSERT_EQ(2, batch.size());
+  EXPECT_EQ(std::string("ok"), std::string(batch.data(0), batch.length(0)));
+  EXPECT_EQ(std::string("fine"), std::string(batch.data(1), batch.length(1)));
+}
+
+// Close the socket while a batched read is pending.
+TEST_F(UDPSocketTest, CloseWithPendingRecvBatch) {
+  IPEndPoint bind_address;
+  CreateUDPAddress("127.0.0.1", 0, &bind_address);
+  UDPSocket server(DatagramSocket::DEFAULT_BIND, RandIntCallback(), NULL,
+                   NetLog::Source());
+  ASSERT_EQ(OK, server.Bind(bind_address));
+
+  DatagramBatch batch(4, kMaxRead);
+  TestCompletionCallback callback;
+  EXPECT_EQ(ERR_IO_PENDING, server.RecvBatch(&batch, callback.callback()));
+
+  server.Close();
+
+  EXPECT_FALSE(callback.have_result());
+}
+
+#endif  // defined(OS_POSIX)
+
 }  // namespace
 
 }  // namespace net
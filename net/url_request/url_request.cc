@@ -206,6 +206,15 @@ void URLRequest::AppendChunkToUpload(const char* bytes,
   upload_->AppendChunk(bytes, bytes_len, is_last_chunk);
 }
 
+void URLRequest::AppendSharedChunkToUpload(IOBuffer* bytes,
+                                           int bytes_len,
+                                           bool is_last_chunk) {
+  DCHECK(upload_);
+  DCHECK(upload_->is_chunked());
+  DCHECK_GT(bytes_len, 0);
+  upload_->AppendSharedChunk(bytes, bytes_len, is_last_chunk);
+}
+
 void URLRequest::set_upload(UploadData* upload) {
   upload_ = upload;
 }
@@ -365,6 +365,13 @@ class NET_EXPORT URLRequest : NON_EXPORTED_BASE(public base::NonThreadSafe),
                            int bytes_len,
                            bool is_last_chunk);
 
+  // Like AppendChunkToUpload(), but references the first |bytes_len| bytes of
+  // |bytes| instead of taking a copy.  They must not be modified until the
+  // request completes.
+  void AppendSharedChunkToUpload(IOBuffer* bytes,
+                                 int bytes_len,
+                                 bool is_last_chunk);
+
   // Set the upload data directly.
   void set_upload(UploadData* upload);
 
@@ -62,6 +62,10 @@ const std::string& URLRequestContext::GetUserAgent(const GURL& url) const {
   return EmptyString();
 }
 
+bool URLRequestContext::IsOffTheRecord() const {
+  return false;
+}
+
 URLRequestContext::~URLRequestContext() {
 }
 
@@ -177,6 +177,11 @@ class NET_EXPORT URLRequestContext
   // method to provide a UA string.
   virtual const std::string& GetUserAgent(const GURL& url) const;
 
+  // Returns true if nothing learned from this context's requests may outlive
+  // the session, e.g. because it belongs to an incognito profile.  Subclasses
+  // override this; the default is false.
+  virtual bool IsOffTheRecord() const;
+
   // In general, referrer_charset is not known when URLRequestContext is
   // constructed. So, we need a setter.
   const std::string& referrer_charset() const { return referrer_charset_; }
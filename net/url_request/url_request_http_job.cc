@@ -17,6 +17,7 @@
 #include "base/rand_util.h"
 #include "base/string_util.h"
 #include "base/time.h"
+#include "net/base/bzip2_filter.h"
 #include "net/base/cert_status_flags.h"
 #include "net/base/filter.h"
 #include "net/base/host_port_pair.h"
@@ -175,6 +176,7 @@ URLRequestHttpJob::URLRequestHttpJob(URLRequest* request)
           base::Bind(&URLRequestHttpJob::NotifyBeforeSendHeadersCallback,
                      base::Unretained(this)))),
       read_in_progress_(false),
+      sdch_dictionary_off_the_record_(false),
       transaction_(NULL),
       throttling_entry_(URLRequestThrottlerManager::GetInstance()->
           RegisterRequestUrl(request->url())),
@@ -234,6 +236,8 @@ void URLRequestHttpJob::NotifyHeadersComplete() {
       DCHECK_EQ(request_->url(), request_info_.url);
       // Resolve suggested URL relative to request url.
       sdch_dictionary_url_ = request_info_.url.Resolve(url_text);
+      sdch_dictionary_off_the_record_ =
+          request_->context() && request_->context()->IsOffTheRecord();
     }
   }
 
@@ -393,14 +397,20 @@ void URLRequestHttpJob::AddExtraHeaders() {
     // easier to filter and analyze the streams to assure that a proxy has not
     // damaged these headers.  Some proxies deliberately corrupt Accept-Encoding
     // headers.
+    // bzip2 is only advertised when enabled, and then only over secure
+    // connections, where intermediaries cannot mangle the Accept-Encoding
+    // header or the encoded payload.
+    std::string accept_encoding("gzip,deflate");
+    if (BZip2Filter::bzip2_enabled() && request_->url().SchemeIsSecure())
+      accept_encoding += ",bzip2";
     if (!advertise_sdch) {
       // Tell the server what compression formats we support (other than SDCH).
       request_info_.extra_headers.SetHeader(
-          HttpRequestHeaders::kAcceptEncoding, "gzip,deflate");
+          HttpRequestHeaders::kAcceptEncoding, accept_encoding);
     } else {
       // Include SDCH in acceptable list.
       request_info_.extra_headers.SetHeader(
-          HttpRequestHeaders::kAcceptEncoding, "gzip,deflate,sdch");
+          HttpRequestHeaders::kAcceptEncoding, accept_encoding + ",sdch");
       if (!avail_dictionaries.empty()) {
         request_info_.extra_headers.SetHeader(
             kAvailDictionaryHeader,
@@ -1186,7 +1196,8 @@ URLRequestHttpJob::~URLRequestHttpJob() {
     // coding to assure that IF the system is shutting down, we don't have any
     // problem if the manager was deleted ahead of time.
     if (manager)  // Defensive programming.
-      manager->FetchDictionary(request_info_.url, sdch_dictionary_url_);
+      manager->FetchDictionary(request_info_.url, sdch_dictionary_url_,
+                               sdch_dictionary_off_the_record_);
   }
   DoneWithRequest(ABORTED);
 }
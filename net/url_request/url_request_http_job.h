@@ -115,6 +115,9 @@ class URLRequestHttpJob : public URLRequestJob {
 
   // An URL for an SDCH dictionary as suggested in a Get-Dictionary HTTP header.
   GURL sdch_dictionary_url_;
+  // True if |sdch_dictionary_url_| was suggested to an off the record context,
+  // in which case the dictionary must not be persisted.
+  bool sdch_dictionary_off_the_record_;
 
   scoped_ptr<HttpTransaction> transaction_;
 
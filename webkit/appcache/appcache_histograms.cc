@@ -47,4 +47,28 @@ void AppCacheHistograms::AddCompletionRunTimeSample(
   UMA_HISTOGRAM_TIMES("appcache.CompletionRunTime", duration);
 }
 
+// static
+void AppCacheHistograms::AddUpdateJobTimeSample(
+    const base::TimeDelta& duration) {
+  UMA_HISTOGRAM_LONG_TIMES("appcache.UpdateJobTime", duration);
+}
+
+// static
+void AppCacheHistograms::AddUpdateFetchTimeSample(
+    const base::TimeDelta& duration) {
+  UMA_HISTOGRAM_TIMES("appcache.UpdateFetchTime", duration);
+}
+
+// static
+void AppCacheHistograms::AddUpdateDownloadedBytesSample(int64 bytes) {
+  UMA_HISTOGRAM_COUNTS("appcache.UpdateDownloadedKB",
+                       static_cast<int>(bytes / 1024));
+}
+
+// static
+void AppCacheHistograms::AddUpdateReusedBytesSample(int64 bytes) {
+  UMA_HISTOGRAM_COUNTS("appcache.UpdateReusedKB",
+                       static_cast<int>(bytes / 1024));
+}
+
 }  // namespace appcache
@@ -34,6 +34,14 @@ class AppCacheHistograms {
   static void AddCompletionQueueTimeSample(const base::TimeDelta& duration);
   static void AddCompletionRunTimeSample(const base::TimeDelta& duration);
 
+  // Samples recorded by the update job. Resources reused from the previous
+  // cache, either unexpired or revalidated with a 304, count as reused
+  // rather than downloaded.
+  static void AddUpdateJobTimeSample(const base::TimeDelta& duration);
+  static void AddUpdateFetchTimeSample(const base::TimeDelta& duration);
+  static void AddUpdateDownloadedBytesSample(int64 bytes);
+  static void AddUpdateReusedBytesSample(int64 bytes);
+
  private:
   DISALLOW_IMPLICIT_CONSTRUCTORS(AppCacheHistograms);
 };
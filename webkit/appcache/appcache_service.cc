@@ -26,6 +26,8 @@ namespace appcache {
 
 namespace {
 
+const size_t kDefaultMaxConcurrentUpdateFetches = 2;
+
 void DeferredCallback(const net::CompletionCallback& callback, int rv) {
   callback.Run(rv);
 }
@@ -467,7 +469,9 @@ void AppCacheService::CheckResponseHelper::OnReadDataComplete(int result) {
 AppCacheService::AppCacheService(quota::QuotaManagerProxy* quota_manager_proxy)
     : appcache_policy_(NULL), quota_client_(NULL),
       quota_manager_proxy_(quota_manager_proxy),
-      request_context_(NULL), clear_local_state_on_exit_(false),
+      request_context_(NULL),
+      max_concurrent_update_fetches_(kDefaultMaxConcurrentUpdateFetches),
+      clear_local_state_on_exit_(false),
       save_session_state_(false) {
   if (quota_manager_proxy_) {
     quota_client_ = new AppCacheQuotaClient(this);
@@ -9,6 +9,7 @@
 #include <set>
 
 #include "base/gtest_prod_util.h"
+#include "base/logging.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/time.h"
@@ -108,6 +109,16 @@ class APPCACHE_EXPORT AppCacheService {
     request_context_ = context;
   }
 
+  // The number of resources an update job fetches at once.  Must be at
+  // least one.
+  size_t max_concurrent_update_fetches() const {
+    return max_concurrent_update_fetches_;
+  }
+  void set_max_concurrent_update_fetches(size_t max_fetches) {
+    DCHECK_GT(max_fetches, 0u);
+    max_concurrent_update_fetches_ = max_fetches;
+  }
+
   // The appcache policy, may be null, in which case access is always allowed.
   // The service does NOT assume ownership of the policy, it is the callers
   // responsibility to ensure that the pointer remains valid while set.
@@ -177,6 +188,7 @@ class APPCACHE_EXPORT AppCacheService {
   BackendMap backends_;  // One 'backend' per child process.
   // Context for use during cache updates.
   net::URLRequestContext* request_context_;
+  size_t max_concurrent_update_fetches_;
   bool clear_local_state_on_exit_;
   // If true, nothing (not even session-only data) should be deleted on exit.
   bool save_session_state_;
@@ -42,6 +42,9 @@ static const int kMaxMemDiskCacheSize = 10 * 1024 * 1024;
 static const FilePath::CharType kDiskCacheDirectoryName[] =
     FILE_PATH_LITERAL("Cache");
 
+// Enough for a few large offline apps.
+static const size_t kMaxWarmCacheEntries = 20000;
+
 namespace {
 
 // Helper with no return value for use with base::Bind.
@@ -366,6 +369,11 @@ void AppCacheStorageImpl::GetAllInfoTask::RunCompleted() {
 // StoreOrLoadTask -------
 
 class AppCacheStorageImpl::StoreOrLoadTask : public DatabaseTask {
+ public:
+  // Takes the records from, or gives them to, the storage's warm caches.
+  void CopyRecordsFromWarmCache(const WarmCache& warm_cache);
+  void MoveRecordsToWarmCache();
+
  protected:
   explicit StoreOrLoadTask(AppCacheStorageImpl* storage)
       : DatabaseTask(storage) {}
@@ -395,6 +403,29 @@ bool AppCacheStorageImpl::StoreOrLoadTask::FindRelatedCacheRecords(
              cache_id, &online_whitelist_records_);
 }
 
+void AppCacheStorageImpl::StoreOrLoadTask::CopyRecordsFromWarmCache(
+    const WarmCache& warm_cache) {
+  group_record_ = warm_cache.group_record;
+  cache_record_ = warm_cache.cache_record;
+  entry_records_ = warm_cache.entry_records;
+  intercept_namespace_records_ = warm_cache.intercept_namespace_records;
+  fallback_namespace_records_ = warm_cache.fallback_namespace_records;
+  online_whitelist_records_ = warm_cache.online_whitelist_records;
+}
+
+void AppCacheStorageImpl::StoreOrLoadTask::MoveRecordsToWarmCache() {
+  if (storage_->GetWarmCache(cache_record_.cache_id))
+    return;
+  WarmCache* warm_cache = new WarmCache;
+  warm_cache->group_record = group_record_;
+  warm_cache->cache_record = cache_record_;
+  warm_cache->entry_records.swap(entry_records_);
+  warm_cache->intercept_namespace_records.swap(intercept_namespace_records_);
+  warm_cache->fallback_namespace_records.swap(fallback_namespace_records_);
+  warm_cache->online_whitelist_records.swap(online_whitelist_records_);
+  storage_->AddWarmCache(warm_cache);
+}
+
 void AppCacheStorageImpl::StoreOrLoadTask::CreateCacheAndGroupFromRecords(
     scoped_refptr<AppCache>* cache, scoped_refptr<AppCacheGroup>* group) {
   DCHECK(storage_ && cache && group);
@@ -478,6 +509,7 @@ void AppCacheStorageImpl::CacheLoadTask::RunCompleted() {
   if (success_ && !storage_->is_disabled()) {
     DCHECK(cache_record_.cache_id == cache_id_);
     CreateCacheAndGroupFromRecords(&cache, &group);
+    MoveRecordsToWarmCache();
   }
   FOR_EACH_DELEGATE(delegates_, OnCacheLoaded(cache, cache_id_));
 }
@@ -516,6 +548,7 @@ void AppCacheStorageImpl::GroupLoadTask::RunCompleted() {
     if (success_) {
       DCHECK(group_record_.manifest_url == manifest_url_);
       CreateCacheAndGroupFromRecords(&cache, &group);
+      MoveRecordsToWarmCache();
     } else {
       group = storage_->working_set_.GetGroup(manifest_url_);
       if (!group) {
@@ -715,6 +748,11 @@ void AppCacheStorageImpl::StoreGroupAndCacheTask::RunCompleted() {
     if (group_->creation_time().is_null())
       group_->set_creation_time(group_record_.creation_time);
     group_->AddNewlyDeletableResponseIds(&newly_deletable_response_ids_);
+    if (!storage_->is_disabled()) {
+      group_record_.creation_time = group_->creation_time();
+      storage_->RemoveWarmCachesForGroup(group_record_.group_id);
+      MoveRecordsToWarmCache();
+    }
   }
   FOR_EACH_DELEGATE(delegates_,
                     OnGroupAndNewestCacheStored(group_, cache_, success_,
@@ -1105,6 +1143,8 @@ void AppCacheStorageImpl::MakeGroupObsoleteTask::RunCompleted() {
     if (!storage_->is_disabled()) {
       storage_->UpdateUsageMapAndNotify(origin_, new_origin_usage_);
       group_->AddNewlyDeletableResponseIds(&newly_deletable_response_ids_);
+      // A load that was queued ahead of this task may have warmed it again.
+      storage_->RemoveWarmCachesForGroup(group_id_);
 
       // Also remove from the working set, caches for an 'obsolete' group
       // may linger in use, but the group itself cannot be looked up by
@@ -1191,6 +1231,14 @@ class AppCacheStorageImpl::UpdateGroupLastAccessTimeTask
     storage->NotifyStorageAccessed(group->manifest_url().GetOrigin());
   }
 
+  // For groups loaded without a database query, which have already
+  // notified of the access.
+  UpdateGroupLastAccessTimeTask(
+      AppCacheStorageImpl* storage, int64 group_id, base::Time time)
+      : DatabaseTask(storage), group_id_(group_id),
+        last_access_time_(time) {
+  }
+
   virtual void Run();
 
   int64 group_id_;
@@ -1208,6 +1256,7 @@ AppCacheStorageImpl::AppCacheStorageImpl(AppCacheService* service)
     : AppCacheStorage(service), is_incognito_(false),
       is_response_deletion_scheduled_(false),
       did_start_deleting_responses_(false),
+      warm_entry_count_(0),
       last_deletable_response_rowid_(0),
       database_(NULL), is_disabled_(false),
       ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
@@ -1220,6 +1269,7 @@ AppCacheStorageImpl::~AppCacheStorageImpl() {
   std::for_each(scheduled_database_tasks_.begin(),
                 scheduled_database_tasks_.end(),
                 std::mem_fun(&DatabaseTask::CancelCompletion));
+  ClearWarmCaches();
 
   if (database_ &&
       !db_thread_->PostTask(
@@ -1257,6 +1307,7 @@ void AppCacheStorageImpl::Disable() {
     return;
   VLOG(1) << "Disabling appcache storage.";
   is_disabled_ = true;
+  ClearWarmCaches();
   ClearUsageMapAndNotify();
   working_set()->Disable();
   if (disk_cache_.get())
@@ -1295,6 +1346,21 @@ void AppCacheStorageImpl::LoadCache(int64 id, Delegate* delegate) {
     task->AddDelegate(GetOrCreateDelegateReference(delegate));
     return;
   }
+
+  WarmCache* warm_cache = GetWarmCache(id);
+  if (warm_cache) {
+    int64 group_id = warm_cache->group_record.group_id;
+    task = new CacheLoadTask(id, this);
+    task->AddDelegate(GetOrCreateDelegateReference(delegate));
+    task->CopyRecordsFromWarmCache(*warm_cache);
+    task->success_ = true;
+    task->RunCompleted();
+    scoped_refptr<DatabaseTask> update_task(
+        new UpdateGroupLastAccessTimeTask(this, group_id, base::Time::Now()));
+    update_task->Schedule();
+    return;
+  }
+
   task = new CacheLoadTask(id, this);
   task->AddDelegate(GetOrCreateDelegateReference(delegate));
   task->Schedule();
@@ -1325,6 +1391,20 @@ void AppCacheStorageImpl::LoadOrCreateGroup(
     return;
   }
 
+  WarmCache* warm_cache = GetWarmCacheForManifest(manifest_url);
+  if (warm_cache) {
+    int64 group_id = warm_cache->group_record.group_id;
+    task = new GroupLoadTask(manifest_url, this);
+    task->AddDelegate(GetOrCreateDelegateReference(delegate));
+    task->CopyRecordsFromWarmCache(*warm_cache);
+    task->success_ = true;
+    task->RunCompleted();
+    scoped_refptr<DatabaseTask> update_task(
+        new UpdateGroupLastAccessTimeTask(this, group_id, base::Time::Now()));
+    update_task->Schedule();
+    return;
+  }
+
   if (usage_map_.find(manifest_url.GetOrigin()) == usage_map_.end()) {
     // No need to query the database, return a new group immediately.
     scoped_refptr<AppCacheGroup> group(new AppCacheGroup(
@@ -1347,6 +1427,8 @@ void AppCacheStorageImpl::StoreGroupAndNewestCache(
   // the simple update case in a very heavy weight way (delete all and
   // the reinsert all over again).
   DCHECK(group && delegate && newest_cache);
+  // The records are replaced once the store completes.
+  RemoveWarmCachesForGroup(group->group_id());
   scoped_refptr<StoreGroupAndCacheTask> task(
       new StoreGroupAndCacheTask(this, group, newest_cache));
   task->AddDelegate(GetOrCreateDelegateReference(delegate));
@@ -1495,6 +1577,15 @@ void AppCacheStorageImpl::MarkEntryAsForeign(
     if (entry)
       entry->add_types(AppCacheEntry::FOREIGN);
   }
+  WarmCache* warm_cache = GetWarmCache(cache_id);
+  if (warm_cache) {
+    std::vector<AppCacheDatabase::EntryRecord>& entries =
+        warm_cache->entry_records;
+    for (size_t i = 0; i < entries.size(); ++i) {
+      if (entries[i].url == entry_url)
+        entries[i].flags |= AppCacheEntry::FOREIGN;
+    }
+  }
   scoped_refptr<MarkEntryAsForeignTask> task(
       new MarkEntryAsForeignTask(this, entry_url, cache_id));
   task->Schedule();
@@ -1504,6 +1595,7 @@ void AppCacheStorageImpl::MarkEntryAsForeign(
 void AppCacheStorageImpl::MakeGroupObsolete(
     AppCacheGroup* group, Delegate* delegate) {
   DCHECK(group && delegate);
+  RemoveWarmCachesForGroup(group->group_id());
   scoped_refptr<MakeGroupObsoleteTask> task(
       new MakeGroupObsoleteTask(this, group));
   task->AddDelegate(GetOrCreateDelegateReference(delegate));
@@ -1547,10 +1639,77 @@ void AppCacheStorageImpl::DeleteResponses(
 }
 
 void AppCacheStorageImpl::PurgeMemory() {
+  ClearWarmCaches();
   scoped_refptr<CloseConnectionTask> task(new CloseConnectionTask(this));
   task->Schedule();
 }
 
+AppCacheStorageImpl::WarmCache::WarmCache() {
+}
+
+AppCacheStorageImpl::WarmCache::~WarmCache() {
+}
+
+AppCacheStorageImpl::WarmCache* AppCacheStorageImpl::GetWarmCache(
+    int64 cache_id) {
+  WarmCacheMap::iterator found = warm_caches_.find(cache_id);
+  if (found == warm_caches_.end())
+    return NULL;
+  warm_cache_lru_.remove(cache_id);
+  warm_cache_lru_.push_front(cache_id);
+  return found->second.get();
+}
+
+AppCacheStorageImpl::WarmCache* AppCacheStorageImpl::GetWarmCacheForManifest(
+    const GURL& manifest_url) {
+  for (WarmCacheMap::iterator iter = warm_caches_.begin();
+       iter != warm_caches_.end(); ++iter) {
+    if (iter->second->group_record.manifest_url == manifest_url)
+      return GetWarmCache(iter->first);
+  }
+  return NULL;
+}
+
+void AppCacheStorageImpl::AddWarmCache(WarmCache* warm_cache) {
+  linked_ptr<WarmCache> owned(warm_cache);
+  int64 cache_id = warm_cache->cache_record.cache_id;
+  DCHECK(warm_caches_.find(cache_id) == warm_caches_.end());
+  size_t entry_count = warm_cache->entry_records.size();
+  if (is_disabled_ || entry_count > kMaxWarmCacheEntries)
+    return;
+  while (warm_entry_count_ + entry_count > kMaxWarmCacheEntries)
+    RemoveWarmCache(warm_cache_lru_.back());
+  warm_caches_[cache_id] = owned;
+  warm_cache_lru_.push_front(cache_id);
+  warm_entry_count_ += entry_count;
+}
+
+void AppCacheStorageImpl::RemoveWarmCache(int64 cache_id) {
+  WarmCacheMap::iterator found = warm_caches_.find(cache_id);
+  if (found == warm_caches_.end())
+    return;
+  warm_entry_count_ -= found->second->entry_records.size();
+  warm_caches_.erase(found);
+  warm_cache_lru_.remove(cache_id);
+}
+
+void AppCacheStorageImpl::RemoveWarmCachesForGroup(int64 group_id) {
+  std::vector<int64> cache_ids;
+  for (WarmCacheMap::iterator iter = warm_caches_.begin();
+       iter != warm_caches_.end(); ++iter) {
+    if (iter->second->group_record.group_id == group_id)
+      cache_ids.push_back(iter->first);
+  }
+  for (size_t i = 0; i < cache_ids.size(); ++i)
+    RemoveWarmCache(cache_ids[i]);
+}
+
+void AppCacheStorageImpl::ClearWarmCaches() {
+  warm_caches_.clear();
+  warm_cache_lru_.clear();
+  warm_entry_count_ = 0;
+}
+
 void AppCacheStorageImpl::DelayedStartDeletingUnusedResponses() {
   // Only if we haven't already begun.
   if (!did_start_deleting_responses_) {
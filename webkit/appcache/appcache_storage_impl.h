@@ -6,6 +6,7 @@
 #define WEBKIT_APPCACHE_APPCACHE_STORAGE_IMPL_H_
 
 #include <deque>
+#include <list>
 #include <map>
 #include <set>
 #include <utility>
@@ -13,6 +14,7 @@
 
 #include "base/callback.h"
 #include "base/file_path.h"
+#include "base/memory/linked_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/message_loop_proxy.h"
 #include "webkit/appcache/appcache_database.h"
@@ -91,6 +93,26 @@ class AppCacheStorageImpl : public AppCacheStorage {
   typedef std::deque<std::pair<GURL, int64> > PendingForeignMarkings;
   typedef std::set<StoreGroupAndCacheTask*> PendingQuotaQueries;
 
+  // The records of a recently loaded or stored cache and its group.  They
+  // are kept after the cache leaves the working set, so that loading it
+  // again, typically when the next page of an offline app is opened, needs
+  // no database query.
+  struct WarmCache {
+    WarmCache();
+    ~WarmCache();
+
+    AppCacheDatabase::GroupRecord group_record;
+    AppCacheDatabase::CacheRecord cache_record;
+    std::vector<AppCacheDatabase::EntryRecord> entry_records;
+    std::vector<AppCacheDatabase::NamespaceRecord>
+        intercept_namespace_records;
+    std::vector<AppCacheDatabase::NamespaceRecord>
+        fallback_namespace_records;
+    std::vector<AppCacheDatabase::OnlineWhiteListRecord>
+        online_whitelist_records;
+  };
+  typedef std::map<int64, linked_ptr<WarmCache> > WarmCacheMap;
+
   bool IsInitTaskComplete() {
     return last_cache_id_ != AppCacheStorage::kUnitializedId;
   }
@@ -100,6 +122,15 @@ class AppCacheStorageImpl : public AppCacheStorage {
   void GetPendingForeignMarkingsForCache(
       int64 cache_id, std::vector<GURL>* urls);
 
+  // The warm caches are bounded by their total number of entries, and the
+  // least recently used ones are dropped first.  Lookups count as uses.
+  WarmCache* GetWarmCache(int64 cache_id);
+  WarmCache* GetWarmCacheForManifest(const GURL& manifest_url);
+  void AddWarmCache(WarmCache* warm_cache);  // Takes ownership.
+  void RemoveWarmCache(int64 cache_id);
+  void RemoveWarmCachesForGroup(int64 group_id);
+  void ClearWarmCaches();
+
   void ScheduleSimpleTask(const base::Closure& task);
   void RunOnePendingSimpleTask();
 
@@ -146,6 +177,11 @@ class AppCacheStorageImpl : public AppCacheStorage {
   PendingForeignMarkings pending_foreign_markings_;
   PendingQuotaQueries pending_quota_queries_;
 
+  // Most recently used first.
+  WarmCacheMap warm_caches_;
+  std::list<int64> warm_cache_lru_;
+  size_t warm_entry_count_;
+
   // Structures to keep track of lazy response deletion.
   std::deque<int64> deletable_response_ids_;
   std::vector<int64> deleted_response_ids_;
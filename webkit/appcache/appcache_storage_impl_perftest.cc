@@ -0,0 +1,167 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <vector>
+
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/message_loop_proxy.h"
+#include "base/perftimer.h"
+#include "base/scoped_temp_dir.h"
+#include "base/stringprintf.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webkit/appcache/appcache.h"
+#include "webkit/appcache/appcache_database.h"
+#include "webkit/appcache/appcache_entry.h"
+#include "webkit/appcache/appcache_group.h"
+#include "webkit/appcache/appcache_interfaces.h"
+#include "webkit/appcache/appcache_service.h"
+#include "webkit/appcache/appcache_storage.h"
+
+namespace appcache {
+
+namespace {
+
+// A large offline app.
+const int kEntryCount = 5000;
+const int kLoads = 20;
+const int64 kGroupId = 1;
+const int64 kCacheId = 1;
+const char kManifestUrl[] = "http://perf.example.com/manifest";
+
+GURL EntryUrl(int i) {
+  return GURL(base::StringPrintf("http://perf.example.com/entry%d", i));
+}
+
+class MockStorageDelegate : public AppCacheStorage::Delegate {
+ public:
+  MockStorageDelegate() : found_cache_id_(kNoCacheId) {}
+
+  virtual void OnCacheLoaded(AppCache* cache, int64 cache_id) OVERRIDE {
+    loaded_cache_ = cache;
+  }
+
+  virtual void OnMainResponseFound(
+      const GURL& url, const AppCacheEntry& entry,
+      const GURL& namespace_entry_url, const AppCacheEntry& fallback_entry,
+      int64 cache_id, int64 group_id, const GURL& manifest_url) OVERRIDE {
+    found_cache_id_ = cache_id;
+  }
+
+  scoped_refptr<AppCache> loaded_cache_;
+  int64 found_cache_id_;
+};
+
+}  // namespace
+
+class AppCacheStorageImplPerfTest : public testing::Test {
+ protected:
+  AppCacheStorageImplPerfTest() : message_loop_(MessageLoop::TYPE_IO) {}
+
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    {
+      AppCacheDatabase database(
+          temp_dir_.path().Append(kAppCacheDatabaseName));
+      AppCacheDatabase::GroupRecord group_record;
+      group_record.group_id = kGroupId;
+      group_record.manifest_url = GURL(kManifestUrl);
+      group_record.origin = group_record.manifest_url.GetOrigin();
+      ASSERT_TRUE(database.InsertGroup(&group_record));
+      AppCacheDatabase::CacheRecord cache_record;
+      cache_record.cache_id = kCacheId;
+      cache_record.group_id = kGroupId;
+      cache_record.online_wildcard = false;
+      cache_record.cache_size = kEntryCount;
+      ASSERT_TRUE(database.InsertCache(&cache_record));
+      std::vector<AppCacheDatabase::EntryRecord> entry_records(kEntryCount);
+      for (int i = 0; i < kEntryCount; ++i) {
+        entry_records[i].cache_id = kCacheId;
+        entry_records[i].url = EntryUrl(i);
+        entry_records[i].flags = AppCacheEntry::EXPLICIT;
+        entry_records[i].response_id = i + 1;
+        entry_records[i].response_size = 1;
+      }
+      ASSERT_TRUE(database.InsertEntryRecords(entry_records));
+    }
+
+    // The database "thread" is this one, so tasks complete within
+    // RunAllPending().
+    service_.reset(new AppCacheService(NULL));
+    service_->Initialize(temp_dir_.path(),
+                         base::MessageLoopProxy::current(),
+                         base::MessageLoopProxy::current());
+    MessageLoop::current()->RunAllPending();
+  }
+
+  virtual void TearDown() OVERRIDE {
+    service_.reset();
+    MessageLoop::current()->RunAllPending();
+  }
+
+  AppCacheStorage* storage() { return service_->storage(); }
+
+  void LoadCache() {
+    storage()->LoadCache(kCacheId, &delegate_);
+    MessageLoop::current()->RunAllPending();
+    ASSERT_TRUE(delegate_.loaded_cache_);
+  }
+
+  MessageLoop message_loop_;
+  ScopedTempDir temp_dir_;
+  scoped_ptr<AppCacheService> service_;
+  MockStorageDelegate delegate_;
+};
+
+TEST_F(AppCacheStorageImplPerfTest, LoadCache) {
+  // The page's own lookup, before its cache is loaded, is a query for just
+  // that url.
+  PerfTimer find_timer;
+  storage()->FindResponseForMainRequest(EntryUrl(kEntryCount - 1), GURL(),
+                                        &delegate_);
+  MessageLoop::current()->RunAllPending();
+  LogPerfResult("AppCache_FindMainResponse",
+                find_timer.Elapsed().InMillisecondsF(), "ms");
+  EXPECT_EQ(kCacheId, delegate_.found_cache_id_);
+
+  // Every load reads the whole cache from the database.
+  PerfTimer database_timer;
+  for (int i = 0; i < kLoads; ++i) {
+    service_->PurgeMemory();
+    LoadCache();
+    delegate_.loaded_cache_ = NULL;
+  }
+  LogPerfResult("AppCacheLoad_Database",
+                database_timer.Elapsed().InMillisecondsF() / kLoads, "ms");
+
+  // Loads after the first are served from the warm records.
+  LoadCache();
+  delegate_.loaded_cache_ = NULL;
+  PerfTimer warm_timer;
+  for (int i = 0; i < kLoads; ++i) {
+    LoadCache();
+    delegate_.loaded_cache_ = NULL;
+  }
+  LogPerfResult("AppCacheLoad_Warm",
+                warm_timer.Elapsed().InMillisecondsF() / kLoads, "ms");
+
+  LoadCache();
+  PerfTimer lookup_timer;
+  for (int i = 0; i < kEntryCount; ++i) {
+    AppCacheEntry found_entry;
+    AppCacheEntry found_fallback_entry;
+    bool found_network_namespace = false;
+    storage()->FindResponseForSubRequest(
+        delegate_.loaded_cache_, EntryUrl(i), &found_entry,
+        &found_fallback_entry, &found_network_namespace);
+    ASSERT_TRUE(found_entry.has_response_id());
+  }
+  LogPerfResult("AppCache_FindSubResponse",
+                kEntryCount / lookup_timer.Elapsed().InSecondsF(),
+                "lookups/s");
+  delegate_.loaded_cache_ = NULL;
+}
+
+}  // namespace appcache
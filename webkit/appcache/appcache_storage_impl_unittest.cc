@@ -451,6 +451,46 @@ class AppCacheStorageImplTest : public testing::Test {
     TestFinished();
   }
 
+  // LoadCache_WarmHit  --------------------------------------
+
+  void LoadCache_WarmHit() {
+    PushNextTask(base::Bind(&AppCacheStorageImplTest::Verify_LoadCache_WarmHit,
+                            base::Unretained(this)));
+
+    // Load a stored cache that is not in use, which warms its records.
+    MakeCacheAndGroup(kManifestUrl, 1, 1, true);
+    group_ = NULL;
+    cache_ = NULL;
+    storage()->LoadCache(1, delegate());
+  }
+
+  void Verify_LoadCache_WarmHit() {
+    EXPECT_TRUE(delegate()->loaded_cache_);
+    delegate()->loaded_cache_ = NULL;
+
+    // Loading it again is served from the warm records, synchronously and
+    // without reading the database.
+    EXPECT_TRUE(database()->DeleteCache(1));
+    storage()->LoadCache(1, delegate());
+    ASSERT_TRUE(delegate()->loaded_cache_);
+    EXPECT_TRUE(delegate()->loaded_cache_->HasOneRef());
+    EXPECT_TRUE(delegate()->loaded_cache_->GetEntry(kDefaultEntryUrl));
+    EXPECT_EQ(1, delegate()->loaded_cache_->owning_group()->group_id());
+    delegate()->loaded_cache_ = NULL;
+
+    // Until memory is purged.
+    PushNextTask(base::Bind(
+        &AppCacheStorageImplTest::Verify_LoadCache_WarmMiss,
+        base::Unretained(this)));
+    storage()->PurgeMemory();
+    storage()->LoadCache(1, delegate());
+  }
+
+  void Verify_LoadCache_WarmMiss() {
+    EXPECT_FALSE(delegate()->loaded_cache_);
+    TestFinished();
+  }
+
   // StoreNewGroup  --------------------------------------
 
   void StoreNewGroup() {
@@ -1329,6 +1369,10 @@ TEST_F(AppCacheStorageImplTest, LoadGroupAndCache_FarHit) {
   RunTestOnIOThread(&AppCacheStorageImplTest::LoadGroupAndCache_FarHit);
 }
 
+TEST_F(AppCacheStorageImplTest, LoadCache_WarmHit) {
+  RunTestOnIOThread(&AppCacheStorageImplTest::LoadCache_WarmHit);
+}
+
 TEST_F(AppCacheStorageImplTest, StoreNewGroup) {
   RunTestOnIOThread(&AppCacheStorageImplTest::StoreNewGroup);
 }
@@ -16,11 +16,11 @@
 #include "net/http/http_request_headers.h"
 #include "net/http/http_response_headers.h"
 #include "webkit/appcache/appcache_group.h"
+#include "webkit/appcache/appcache_histograms.h"
 
 namespace appcache {
 
 static const int kBufferSize = 32768;
-static const size_t kMaxConcurrentUrlFetches = 2;
 static const int kMax503Retries = 3;
 
 // Helper class for collecting hosts per frontend when sending notifications
@@ -110,6 +110,7 @@ void AppCacheUpdateJob::URLFetcher::Start() {
                            net::LOAD_DISABLE_INTERCEPT);
   if (existing_response_headers_)
     AddConditionalHeaders(existing_response_headers_);
+  start_time_ = base::TimeTicks::Now();
   request_->Start();
 }
 
@@ -260,6 +261,11 @@ void AppCacheUpdateJob::URLFetcher::OnResponseCompleted() {
     return;
   }
 
+  if (fetch_type_ == URL_FETCH || fetch_type_ == MASTER_ENTRY_FETCH) {
+    AppCacheHistograms::AddUpdateFetchTimeSample(
+        base::TimeTicks::Now() - start_time_);
+  }
+
   switch (fetch_type_) {
     case MANIFEST_FETCH:
       job_->HandleManifestFetchCompleted(this);
@@ -300,7 +306,10 @@ AppCacheUpdateJob::AppCacheUpdateJob(AppCacheService* service,
       master_entries_completed_(0),
       url_fetches_completed_(0),
       manifest_fetcher_(NULL),
-      stored_state_(UNSTORED) {
+      stored_state_(UNSTORED),
+      start_time_(base::TimeTicks::Now()),
+      downloaded_bytes_(0),
+      reused_bytes_(0) {
   DCHECK(group_);
   manifest_url_ = group_->manifest_url();
 }
@@ -548,6 +557,7 @@ void AppCacheUpdateJob::HandleUrlFetchCompleted(URLFetcher* fetcher) {
     DCHECK(fetcher->response_writer());
     entry.set_response_id(fetcher->response_writer()->response_id());
     entry.set_response_size(fetcher->response_writer()->amount_written());
+    downloaded_bytes_ += entry.response_size();
     if (!inprogress_cache_->AddOrModifyEntry(url, entry))
       duplicate_response_ids_.push_back(entry.response_id());
 
@@ -570,6 +580,7 @@ void AppCacheUpdateJob::HandleUrlFetchCompleted(URLFetcher* fetcher) {
         // Keep the existing response.
         entry.set_response_id(fetcher->existing_entry().response_id());
         entry.set_response_size(fetcher->existing_entry().response_size());
+        reused_bytes_ += entry.response_size();
         inprogress_cache_->AddOrModifyEntry(url, entry);
       } else {
         const char* kFormatString = "Resource fetch failed (%d) %s";
@@ -588,6 +599,7 @@ void AppCacheUpdateJob::HandleUrlFetchCompleted(URLFetcher* fetcher) {
       // of the cache. Impossible to know one way or the other.
       entry.set_response_id(fetcher->existing_entry().response_id());
       entry.set_response_size(fetcher->existing_entry().response_size());
+      reused_bytes_ += entry.response_size();
       inprogress_cache_->AddOrModifyEntry(url, entry);
     }
   }
@@ -628,6 +640,7 @@ void AppCacheUpdateJob::HandleMasterEntryFetchCompleted(
     AppCacheEntry master_entry(AppCacheEntry::MASTER,
                                fetcher->response_writer()->response_id(),
                                fetcher->response_writer()->amount_written());
+    downloaded_bytes_ += master_entry.response_size();
     if (cache->AddOrModifyEntry(url, master_entry))
       added_master_entries_.push_back(url);
     else
@@ -921,7 +934,8 @@ void AppCacheUpdateJob::FetchUrls() {
   // Fetch each URL in the list according to section 6.9.4 step 17.1-17.3.
   // Fetch up to the concurrent limit. Other fetches will be triggered as each
   // each fetch completes.
-  while (pending_url_fetches_.size() < kMaxConcurrentUrlFetches &&
+  while (pending_url_fetches_.size() <
+             service_->max_concurrent_update_fetches() &&
          !urls_to_fetch_.empty()) {
     UrlToFetch url_to_fetch = urls_to_fetch_.front();
     urls_to_fetch_.pop_front();
@@ -1039,7 +1053,8 @@ void AppCacheUpdateJob::FetchMasterEntries() {
 
   // Fetch each master entry in the list, up to the concurrent limit.
   // Additional fetches will be triggered as each fetch completes.
-  while (master_entry_fetches_.size() < kMaxConcurrentUrlFetches &&
+  while (master_entry_fetches_.size() <
+             service_->max_concurrent_update_fetches() &&
          !master_entries_to_fetch_.empty()) {
     const GURL& url = *master_entries_to_fetch_.begin();
 
@@ -1173,6 +1188,7 @@ void AppCacheUpdateJob::OnResponseInfoLoaded(
       AppCacheEntry& entry = it->second;
       entry.set_response_id(response_id);
       entry.set_response_size(copy_me->response_size());
+      reused_bytes_ += entry.response_size();
       inprogress_cache_->AddOrModifyEntry(url, entry);
       NotifyAllProgress(url);
       ++url_fetches_completed_;
@@ -1233,6 +1249,10 @@ void AppCacheUpdateJob::MaybeCompleteUpdate() {
       else
         NotifyAllAssociatedHosts(UPDATE_READY_EVENT);
       DiscardDuplicateResponses();
+      AppCacheHistograms::AddUpdateJobTimeSample(
+          base::TimeTicks::Now() - start_time_);
+      AppCacheHistograms::AddUpdateDownloadedBytesSample(downloaded_bytes_);
+      AppCacheHistograms::AddUpdateReusedBytesSample(reused_bytes_);
       internal_state_ = COMPLETED;
       break;
     case CACHE_FAILURE:
@@ -13,6 +13,7 @@
 
 #include "base/gtest_prod_util.h"
 #include "base/memory/ref_counted.h"
+#include "base/time.h"
 #include "googleurl/src/gurl.h"
 #include "net/base/completion_callback.h"
 #include "net/http/http_response_headers.h"
@@ -136,6 +137,7 @@ class APPCACHE_EXPORT AppCacheUpdateJob : public AppCacheStorage::Delegate,
     AppCacheUpdateJob* job_;
     FetchType fetch_type_;
     int retry_503_attempts_;
+    base::TimeTicks start_time_;
     scoped_refptr<net::IOBuffer> buffer_;
     scoped_ptr<net::URLRequest> request_;
     AppCacheEntry existing_entry_;
@@ -299,6 +301,11 @@ class APPCACHE_EXPORT AppCacheUpdateJob : public AppCacheStorage::Delegate,
   // Whether we've stored the resulting group/cache yet.
   StoredState stored_state_;
 
+  // For the histograms recorded when a new cache has been stored.
+  base::TimeTicks start_time_;
+  int64 downloaded_bytes_;
+  int64 reused_bytes_;
+
   FRIEND_TEST_ALL_PREFIXES(AppCacheGroupTest, QueueUpdate);
 
   DISALLOW_COPY_AND_ASSIGN(AppCacheUpdateJob);
@@ -515,6 +515,22 @@ std::string HttpHeadersRequestTestJob::expect_if_none_match_;
 bool HttpHeadersRequestTestJob::saw_if_none_match_ = false;
 bool HttpHeadersRequestTestJob::already_checked_ = false;
 
+// Runs a callback before creating each mock server job.
+class CallbackJobFactory : public net::URLRequestJobFactory::ProtocolHandler {
+ public:
+  explicit CallbackJobFactory(const base::Closure& callback)
+      : callback_(callback) {
+  }
+
+  virtual net::URLRequestJob* MaybeCreateJob(net::URLRequest* request) const {
+    callback_.Run();
+    return MockHttpServer::JobFactory(request);
+  }
+
+ private:
+  const base::Closure callback_;
+};
+
 class IfModifiedSinceJobFactory
     : public net::URLRequestJobFactory::ProtocolHandler {
  public:
@@ -572,7 +588,8 @@ class AppCacheUpdateJobTest : public testing::Test,
         expect_newest_cache_(NULL),
         expect_non_null_update_time_(false),
         tested_manifest_(NONE),
-        tested_manifest_path_override_(NULL) {
+        tested_manifest_path_override_(NULL),
+        serial_fetch_jobs_(0) {
     io_thread_.reset(new IOThread("AppCacheUpdateJob IO test thread"));
     base::Thread::Options options(MessageLoop::TYPE_IO, 0);
     io_thread_->StartWithOptions(options);
@@ -1024,6 +1041,53 @@ class AppCacheUpdateJobTest : public testing::Test,
     WaitForUpdateToFinish();
   }
 
+  void SerialFetchCacheAttemptTest() {
+    ASSERT_EQ(MessageLoop::TYPE_IO, MessageLoop::current()->type());
+
+    GURL manifest_url = MockHttpServer::GetMockUrl("files/manifest1");
+
+    net::URLRequestJobFactory* new_factory(new net::URLRequestJobFactory);
+    new_factory->SetProtocolHandler(
+        "http",
+        new CallbackJobFactory(
+            base::Bind(&AppCacheUpdateJobTest::CheckNoFetchPending,
+                       base::Unretained(this))));
+    io_thread_->SetNewJobFactory(new_factory);
+
+    MakeService();
+    service_->set_max_concurrent_update_fetches(1);
+    group_ = new AppCacheGroup(
+        service_.get(), manifest_url,
+        service_->storage()->NewGroupId());
+    AppCacheUpdateJob* update = new AppCacheUpdateJob(service_.get(), group_);
+    group_->update_job_ = update;
+
+    MockFrontend* frontend = MakeMockFrontend();
+    AppCacheHost* host = MakeHost(1, frontend);
+    update->StartUpdate(host, GURL());
+
+    // Set up checks for when update job finishes.
+    do_checks_after_update_finished_ = true;
+    expect_group_obsolete_ = false;
+    expect_group_has_cache_ = true;
+    tested_manifest_ = MANIFEST1;
+    frontend->AddExpectedEvent(MockFrontend::HostIds(1, host->host_id()),
+                               CHECKING_EVENT);
+
+    WaitForUpdateToFinish();
+  }
+
+  // Called as each request of SerialFetchCacheAttemptTest starts.  A fetch
+  // is only added to the pending ones after its request starts, so with a
+  // limit of one there must be none.
+  void CheckNoFetchPending() {
+    AppCacheUpdateJob* update = group_->update_job_;
+    ASSERT_TRUE(update);
+    EXPECT_TRUE(update->pending_url_fetches_.empty());
+    EXPECT_TRUE(update->master_entry_fetches_.empty());
+    ++serial_fetch_jobs_;
+  }
+
   void DownloadInterceptEntriesTest() {
     // Ensures we download intercept entries too.
     ASSERT_EQ(MessageLoop::TYPE_IO, MessageLoop::current()->type());
@@ -3248,6 +3312,8 @@ class AppCacheUpdateJobTest : public testing::Test,
   const char* tested_manifest_path_override_;
   AppCache::EntryMap expect_extra_entries_;
   std::map<GURL, int64> expect_response_ids_;
+  // The number of requests SerialFetchCacheAttemptTest made.
+  int serial_fetch_jobs_;
 };
 
 TEST_F(AppCacheUpdateJobTest, AlreadyChecking) {
@@ -3360,6 +3426,12 @@ TEST_F(AppCacheUpdateJobTest, BasicCacheAttemptSuccess) {
   RunTestOnIOThread(&AppCacheUpdateJobTest::BasicCacheAttemptSuccessTest);
 }
 
+TEST_F(AppCacheUpdateJobTest, SerialFetchCacheAttempt) {
+  RunTestOnIOThread(&AppCacheUpdateJobTest::SerialFetchCacheAttemptTest);
+  // The manifest, its refetch, explicit1 and fallback1a.
+  EXPECT_EQ(4, serial_fetch_jobs_);
+}
+
 TEST_F(AppCacheUpdateJobTest, DownloadInterceptEntriesTest) {
   RunTestOnIOThread(&AppCacheUpdateJobTest::DownloadInterceptEntriesTest);
 }
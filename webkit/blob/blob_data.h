@@ -5,6 +5,8 @@
 #ifndef WEBKIT_BLOB_BLOB_DATA_H_
 #define WEBKIT_BLOB_BLOB_DATA_H_
 
+#include <string.h>
+
 #include <vector>
 
 #include "base/basictypes.h"
@@ -12,6 +14,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/time.h"
 #include "googleurl/src/gurl.h"
+#include "net/base/io_buffer.h"
 #include "webkit/blob/blob_export.h"
 #include "webkit/blob/shareable_file_reference.h"
 
@@ -41,10 +44,27 @@ class BLOB_EXPORT BlobData : public base::RefCounted<BlobData> {
     void SetToData(const char* data, size_t length) {
       type = TYPE_DATA;
       this->data.assign(data, length);
+      this->shared_data = NULL;
       this->offset = 0;
       this->length = length;
     }
 
+    // Refers to |length| bytes at |offset| in |shared_data| rather than
+    // holding a copy, so that slices of a blob share the same storage.
+    void SetToSharedData(net::IOBufferWithSize* shared_data,
+                         uint64 offset, uint64 length) {
+      type = TYPE_DATA;
+      this->data.clear();
+      this->shared_data = shared_data;
+      this->offset = offset;
+      this->length = length;
+    }
+
+    // The start of the storage for Data type; |offset| is relative to this.
+    const char* bytes() const {
+      return shared_data ? shared_data->data() : data.data();
+    }
+
     void SetToDataExternal(const char* data, size_t length) {
       type = TYPE_DATA_EXTERNAL;
       this->data_external = data;
@@ -70,6 +90,7 @@ class BLOB_EXPORT BlobData : public base::RefCounted<BlobData> {
 
     Type type;
     std::string data;  // For Data type.
+    scoped_refptr<net::IOBufferWithSize> shared_data;  // Also for Data type.
     const char* data_external;  // For DataExternal type.
     GURL blob_url;  // For Blob type.
     FilePath file_path;  // For File type.
@@ -92,6 +113,14 @@ class BLOB_EXPORT BlobData : public base::RefCounted<BlobData> {
     }
   }
 
+  void AppendSharedData(net::IOBufferWithSize* shared_data,
+                        uint64 offset, uint64 length) {
+    if (length > 0) {
+      items_.push_back(Item());
+      items_.back().SetToSharedData(shared_data, offset, length);
+    }
+  }
+
   void AppendFile(const FilePath& file_path, uint64 offset, uint64 length,
                   const base::Time& expected_modification_time) {
     items_.push_back(Item());
@@ -122,12 +151,14 @@ class BLOB_EXPORT BlobData : public base::RefCounted<BlobData> {
     content_disposition_ = content_disposition;
   }
 
+  // Items that share storage are each counted in full, so this may
+  // overestimate the memory actually held.
   int64 GetMemoryUsage() const {
     int64 memory = 0;
     for (std::vector<Item>::const_iterator iter = items_.begin();
          iter != items_.end(); ++iter) {
       if (iter->type == TYPE_DATA)
-        memory += iter->data.size();
+        memory += iter->shared_data ? iter->length : iter->data.size();
     }
     return memory;
   }
@@ -150,9 +181,11 @@ inline bool operator==(const BlobData::Item& a, const BlobData::Item& b) {
   if (a.type != b.type)
     return false;
   if (a.type == BlobData::TYPE_DATA) {
-    return a.data == b.data &&
-           a.offset == b.offset &&
-           a.length == b.length;
+    // Compare the bytes referred to, which may be held in either |data| or
+    // |shared_data|.
+    return a.length == b.length &&
+           !memcmp(a.bytes() + a.offset, b.bytes() + b.offset,
+                   static_cast<size_t>(a.length));
   }
   if (a.type == BlobData::TYPE_FILE) {
     return a.file_path == b.file_path &&
@@ -4,8 +4,16 @@
 
 #include "webkit/blob/blob_storage_controller.h"
 
+#include <algorithm>
+
+#include "base/bind.h"
+#include "base/location.h"
 #include "base/logging.h"
+#include "base/message_loop_proxy.h"
+#include "base/platform_file.h"
+#include "base/string_number_conversions.h"
 #include "googleurl/src/gurl.h"
+#include "net/base/io_buffer.h"
 #include "net/base/upload_data.h"
 #include "webkit/blob/blob_data.h"
 
@@ -33,11 +41,79 @@ static const int64 kMaxMemoryUsage = 1024 * 1024 * 1024;  // 1G
 
 }  // namespace
 
+// Created on the IO thread, but only used on the file thread, where the
+// writes of a file are run in the order they were posted.
+class BlobStorageController::SpillFileWriter
+    : public base::RefCountedThreadSafe<SpillFileWriter> {
+ public:
+  explicit SpillFileWriter(const FilePath& path)
+      : path_(path),
+        file_(base::kInvalidPlatformFileValue) {
+  }
+
+  void Write(net::IOBufferWithSize* buffer, int64 offset, bool* success) {
+    *success = false;
+    if (file_ == base::kInvalidPlatformFileValue) {
+      file_ = base::CreatePlatformFile(
+          path_, base::PLATFORM_FILE_CREATE_ALWAYS | base::PLATFORM_FILE_WRITE,
+          NULL, NULL);
+      if (file_ == base::kInvalidPlatformFileValue)
+        return;
+    }
+    *success = base::WritePlatformFile(file_, offset, buffer->data(),
+                                       buffer->size()) == buffer->size();
+  }
+
+  void Close() {
+    if (file_ == base::kInvalidPlatformFileValue)
+      return;
+    base::ClosePlatformFile(file_);
+    file_ = base::kInvalidPlatformFileValue;
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<SpillFileWriter>;
+
+  ~SpillFileWriter() {
+    DCHECK_EQ(base::kInvalidPlatformFileValue, file_);
+  }
+
+  const FilePath path_;
+  base::PlatformFile file_;
+
+  DISALLOW_COPY_AND_ASSIGN(SpillFileWriter);
+};
+
+BlobStorageController::SpillFile::SpillFile()
+    : length(0),
+      pending_writes(0),
+      failed(false),
+      finish_pending(false) {
+}
+
+BlobStorageController::SpillFile::~SpillFile() {}
+
 BlobStorageController::BlobStorageController()
-    : memory_usage_(0) {
+    : memory_usage_(0),
+      spill_memory_limit_(kMaxMemoryUsage),
+      spill_file_count_(0),
+      ALLOW_THIS_IN_INITIALIZER_LIST(weak_factory_(this)) {
 }
 
 BlobStorageController::~BlobStorageController() {
+  while (!spill_files_.empty())
+    CloseSpillFile(GURL(spill_files_.begin()->first));
+}
+
+void BlobStorageController::EnableDiskSpill(
+    const FilePath& directory,
+    int64 memory_limit,
+    base::MessageLoopProxy* file_thread_proxy) {
+  DCHECK(!directory.empty());
+  DCHECK(file_thread_proxy);
+  spill_directory_ = directory;
+  spill_memory_limit_ = std::min(memory_limit, kMaxMemoryUsage);
+  file_thread_proxy_ = file_thread_proxy;
 }
 
 void BlobStorageController::StartBuildingBlob(const GURL& url) {
@@ -58,8 +134,6 @@ void BlobStorageController::AppendBlobDataItem(
   BlobData* target_blob_data = found->second;
   DCHECK(target_blob_data);
 
-  memory_usage_ -= target_blob_data->GetMemoryUsage();
-
   // The blob data is stored in the "canonical" way. That is, it only contains a
   // list of Data and File items.
   // 1) The Data item is denoted by the raw data and the range.
@@ -72,11 +146,12 @@ void BlobStorageController::AppendBlobDataItem(
     case BlobData::TYPE_DATA:
       // WebBlobData does not allow partial data.
       DCHECK(!(item.offset) && item.length == item.data.size());
-      target_blob_data->AppendData(item.data.c_str(), item.data.size());
+      AppendDataItem(url, target_blob_data, item.data.data(),
+                     item.data.size());
       break;
     case BlobData::TYPE_DATA_EXTERNAL:
       DCHECK(!item.offset);
-      target_blob_data->AppendData(item.data_external, item.length);
+      AppendDataItem(url, target_blob_data, item.data_external, item.length);
       break;
     case BlobData::TYPE_FILE:
       AppendFileItem(target_blob_data,
@@ -96,11 +171,8 @@ void BlobStorageController::AppendBlobDataItem(
       break;
   }
 
-  memory_usage_ += target_blob_data->GetMemoryUsage();
-
-  // If we're using too much memory, drop this blob.
-  // TODO(michaeln): Blob memory storage does not yet spill over to disk,
-  // until it does, we'll prevent memory usage over a max amount.
+  // If we're using too much memory, drop this blob.  With disk spill enabled
+  // this only happens if the spill writes fall far behind.
   if (memory_usage_ > kMaxMemoryUsage)
     RemoveBlob(url);
 }
@@ -109,12 +181,33 @@ void BlobStorageController::FinishBuildingBlob(
     const GURL& url, const std::string& content_type) {
   DCHECK(url.SchemeIs("blob"));
   DCHECK(!BlobUrlHasRef(url));
+  if (unfinalized_blob_map_.find(url.spec()) == unfinalized_blob_map_.end())
+    return;
+
+  // The blob is not handed out before its spilled data is on disk.
+  SpillFileMap::iterator spill = spill_files_.find(url.spec());
+  if (spill != spill_files_.end() && spill->second.pending_writes) {
+    spill->second.finish_pending = true;
+    spill->second.content_type = content_type;
+    return;
+  }
+  FinalizeBlob(url, content_type);
+}
+
+void BlobStorageController::FinalizeBlob(
+    const GURL& url, const std::string& content_type) {
   BlobMap::iterator found = unfinalized_blob_map_.find(url.spec());
-  if (found == unfinalized_blob_map_.end())
+  DCHECK(found != unfinalized_blob_map_.end());
+  SpillFileMap::iterator spill = spill_files_.find(url.spec());
+  if (spill != spill_files_.end() && spill->second.failed) {
+    // Part of the blob's data is missing.
+    RemoveBlob(url);
     return;
+  }
   found->second->set_content_type(content_type);
   blob_map_[url.spec()] = found->second;
   unfinalized_blob_map_.erase(found);
+  CloseSpillFile(url);
 }
 
 void BlobStorageController::AddFinishedBlob(const GURL& url,
@@ -146,7 +239,9 @@ void BlobStorageController::RemoveBlob(const GURL& url) {
   DCHECK(url.SchemeIs("blob"));
   DCHECK(!BlobUrlHasRef(url));
 
-  if (!RemoveFromMapHelper(&unfinalized_blob_map_, url))
+  if (RemoveFromMapHelper(&unfinalized_blob_map_, url))
+    CloseSpillFile(url);
+  else
     RemoveFromMapHelper(&blob_map_, url);
 }
 
@@ -156,7 +251,7 @@ bool BlobStorageController::RemoveFromMapHelper(
   if (found == map->end())
     return false;
   if (DecrementBlobDataUsage(found->second))
-    memory_usage_ -= found->second->GetMemoryUsage();
+    ReleaseSharedBuffers(found->second);
   map->erase(found);
   return true;
 }
@@ -212,11 +307,11 @@ void BlobStorageController::ResolveBlobReferencesInUploadData(
       const BlobData::Item& item = blob_data->items().at(i - 1);
       switch (item.type) {
         case BlobData::TYPE_DATA:
-          // TODO(jianli): Figure out how to avoid copying the data.
-          // TODO(michaeln): Now that blob_data surives for the duration,
-          // maybe UploadData could take a raw ptr without having to copy.
-          iter->SetToBytes(
-              &item.data.at(0) + static_cast<int>(item.offset),
+          // The blob data survives for the duration of the upload, so the
+          // element can refer to its bytes rather than copy them.
+          iter->SetToSharedBytes(
+              new net::WrappedIOBuffer(
+                  item.bytes() + static_cast<size_t>(item.offset)),
               static_cast<int>(item.length));
           break;
         case BlobData::TYPE_FILE:
@@ -255,9 +350,11 @@ void BlobStorageController::AppendStorageItems(
     uint64 current_length = iter->length - offset;
     uint64 new_length = current_length > length ? length : current_length;
     if (iter->type == BlobData::TYPE_DATA) {
-      target_blob_data->AppendData(
-          iter->data.c_str() + static_cast<size_t>(iter->offset + offset),
-          static_cast<uint32>(new_length));
+      // Share the source's storage rather than copying a slice of it.
+      DCHECK(iter->shared_data);
+      target_blob_data->AppendSharedData(
+          iter->shared_data, iter->offset + offset, new_length);
+      AddSharedBufferUsage(iter->shared_data);
     } else {
       DCHECK(iter->type == BlobData::TYPE_FILE);
       AppendFileItem(target_blob_data,
@@ -285,6 +382,111 @@ void BlobStorageController::AppendFileItem(
     target_blob_data->AttachShareableFileReference(shareable_file);
 }
 
+void BlobStorageController::AppendDataItem(
+    const GURL& url, BlobData* target_blob_data,
+    const char* data, uint64 length) {
+  if (!length)
+    return;
+
+  if (!spill_directory_.empty() &&
+      memory_usage_ + static_cast<int64>(length) > spill_memory_limit_) {
+    SpillData(url, target_blob_data, data, length);
+    return;
+  }
+
+  // Copied once into a buffer that slices of this blob and uploads of it
+  // refer to from then on.
+  scoped_refptr<net::IOBufferWithSize> buffer(
+      new net::IOBufferWithSize(static_cast<int>(length)));
+  memcpy(buffer->data(), data, static_cast<size_t>(length));
+  target_blob_data->AppendSharedData(buffer, 0, length);
+  AddSharedBufferUsage(buffer);
+}
+
+void BlobStorageController::SpillData(
+    const GURL& url, BlobData* target_blob_data,
+    const char* data, uint64 length) {
+  SpillFile& spill = spill_files_[url.spec()];
+  if (!spill.writer) {
+    FilePath path = spill_directory_.AppendASCII(
+        base::Int64ToString(++spill_file_count_));
+    spill.reference = ShareableFileReference::GetOrCreate(
+        path, ShareableFileReference::DELETE_ON_FINAL_RELEASE,
+        file_thread_proxy_);
+    spill.writer = new SpillFileWriter(path);
+    target_blob_data->AttachShareableFileReference(spill.reference);
+  }
+
+  // The copy is held in memory, and counted as such, until it is written.
+  scoped_refptr<net::IOBufferWithSize> buffer(
+      new net::IOBufferWithSize(static_cast<int>(length)));
+  memcpy(buffer->data(), data, static_cast<size_t>(length));
+  memory_usage_ += buffer->size();
+
+  bool* success = new bool(false);
+  file_thread_proxy_->PostTaskAndReply(
+      FROM_HERE,
+      base::Bind(&SpillFileWriter::Write, spill.writer, buffer,
+                 spill.length, success),
+      base::Bind(&BlobStorageController::DidSpillData,
+                 weak_factory_.GetWeakPtr(), url,
+                 static_cast<int64>(buffer->size()), base::Owned(success)));
+  ++spill.pending_writes;
+
+  // No modification time is expected, the file is ours and only grows.
+  target_blob_data->AppendFile(spill.reference->path(), spill.length,
+                               length, base::Time());
+  spill.length += length;
+}
+
+void BlobStorageController::DidSpillData(
+    const GURL& url, int64 length, const bool* success) {
+  memory_usage_ -= length;
+  SpillFileMap::iterator found = spill_files_.find(url.spec());
+  if (found == spill_files_.end())
+    return;  // The blob was removed in the meantime.
+  SpillFile& spill = found->second;
+  DCHECK_GT(spill.pending_writes, 0);
+  --spill.pending_writes;
+  if (!*success)
+    spill.failed = true;
+  if (!spill.pending_writes && spill.finish_pending)
+    FinalizeBlob(url, spill.content_type);
+}
+
+void BlobStorageController::CloseSpillFile(const GURL& url) {
+  SpillFileMap::iterator found = spill_files_.find(url.spec());
+  if (found == spill_files_.end())
+    return;
+  // Posted ahead of the deletion that releasing the last reference to the
+  // file may post.
+  file_thread_proxy_->PostTask(
+      FROM_HERE, base::Bind(&SpillFileWriter::Close, found->second.writer));
+  spill_files_.erase(found);
+}
+
+void BlobStorageController::AddSharedBufferUsage(
+    net::IOBufferWithSize* buffer) {
+  if (++shared_buffer_usage_count_[buffer] == 1)
+    memory_usage_ += buffer->size();
+}
+
+void BlobStorageController::ReleaseSharedBuffers(BlobData* blob_data) {
+  for (std::vector<BlobData::Item>::const_iterator iter =
+           blob_data->items().begin();
+       iter != blob_data->items().end(); ++iter) {
+    if (!iter->shared_data)
+      continue;
+    SharedBufferUsageMap::iterator found =
+        shared_buffer_usage_count_.find(iter->shared_data);
+    DCHECK(found != shared_buffer_usage_count_.end());
+    if (--(found->second))
+      continue;  // Still in use
+    memory_usage_ -= found->first->size();
+    shared_buffer_usage_count_.erase(found);
+  }
+}
+
 void BlobStorageController::IncrementBlobDataUsage(BlobData* blob_data) {
   blob_data_usage_count_[blob_data] += 1;
 }
@@ -8,19 +8,22 @@
 #include <map>
 #include <string>
 
+#include "base/file_path.h"
 #include "base/hash_tables.h"
 #include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
 #include "base/process.h"
 #include "webkit/blob/blob_data.h"
 #include "webkit/blob/blob_export.h"
 
 class GURL;
-class FilePath;
 
 namespace base {
+class MessageLoopProxy;
 class Time;
 }
 namespace net {
+class IOBufferWithSize;
 class UploadData;
 }
 
@@ -44,11 +47,60 @@ class BLOB_EXPORT BlobStorageController {
   // and updated in place.
   void ResolveBlobReferencesInUploadData(net::UploadData* upload_data);
 
+  // Once enabled, data that would take the memory held for blobs over
+  // |memory_limit| bytes is written to files in |directory| instead, and is
+  // read back from there.  The files are written and deleted on
+  // |file_thread_proxy|; a blob with spilled data only becomes available
+  // once its writes have completed.  |directory| must exist and be owned by
+  // this controller.
+  void EnableDiskSpill(const FilePath& directory,
+                       int64 memory_limit,
+                       base::MessageLoopProxy* file_thread_proxy);
+
+  int64 memory_usage() const { return memory_usage_; }
+
  private:
   friend class ViewBlobInternalsJob;
 
   typedef base::hash_map<std::string, scoped_refptr<BlobData> > BlobMap;
   typedef std::map<BlobData*, int> BlobDataUsageMap;
+  typedef std::map<net::IOBufferWithSize*, int> SharedBufferUsageMap;
+
+  // Writes the spilled data of one blob on the file thread.
+  class SpillFileWriter;
+
+  // The file that the data of a blob being built is spilled to.  It is kept
+  // open until the blob is finished and its writes have completed.
+  struct SpillFile {
+    SpillFile();
+    ~SpillFile();
+
+    scoped_refptr<ShareableFileReference> reference;
+    scoped_refptr<SpillFileWriter> writer;
+    int64 length;
+    int pending_writes;
+    bool failed;
+
+    // Set once FinishBuildingBlob() is called while writes are pending.
+    bool finish_pending;
+    std::string content_type;
+  };
+  typedef std::map<std::string, SpillFile> SpillFileMap;
+
+  // Appends a copy of |length| bytes of |data| to the blob being built at
+  // |url|, in memory or in the blob's spill file.
+  void AppendDataItem(const GURL& url, BlobData* target_blob_data,
+                      const char* data, uint64 length);
+  void SpillData(const GURL& url, BlobData* target_blob_data,
+                 const char* data, uint64 length);
+  void DidSpillData(const GURL& url, int64 length, const bool* success);
+  void FinalizeBlob(const GURL& url, const std::string& content_type);
+  void CloseSpillFile(const GURL& url);
+
+  // Data items share their buffers with slices of them, so memory is
+  // accounted for per buffer rather than per item.
+  void AddSharedBufferUsage(net::IOBufferWithSize* buffer);
+  void ReleaseSharedBuffers(BlobData* blob_data);
 
   void AppendStorageItems(BlobData* target_blob_data,
                           BlobData* src_blob_data,
@@ -68,14 +120,31 @@ class BLOB_EXPORT BlobStorageController {
   BlobMap unfinalized_blob_map_;
 
   // Used to keep track of how much memory is being utitlized for blob data,
-  // we count only the items of TYPE_DATA which are held in memory and not
-  // items of TYPE_FILE.
+  // we count only the buffers of TYPE_DATA items which are held in memory and
+  // not items of TYPE_FILE.
   int64 memory_usage_;
 
+  // How many items refer to each buffer that holds blob data.
+  SharedBufferUsageMap shared_buffer_usage_count_;
+
   // Multiple urls can refer to the same blob data, this map keeps track of
   // how many urls refer to a BlobData.
   BlobDataUsageMap blob_data_usage_count_;
 
+  // Where data is spilled to once |memory_usage_| would go over
+  // |spill_memory_limit_|.  Spilling is disabled if the directory is empty.
+  FilePath spill_directory_;
+  int64 spill_memory_limit_;
+  scoped_refptr<base::MessageLoopProxy> file_thread_proxy_;
+
+  // Spill files of the blobs in |unfinalized_blob_map_|, by url.
+  SpillFileMap spill_files_;
+
+  // Names the spill files in |spill_directory_|.
+  int64 spill_file_count_;
+
+  base::WeakPtrFactory<BlobStorageController> weak_factory_;
+
   DISALLOW_COPY_AND_ASSIGN(BlobStorageController);
 };
 
@@ -0,0 +1,138 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/message_loop_proxy.h"
+#include "base/perftimer.h"
+#include "base/platform_file.h"
+#include "base/scoped_temp_dir.h"
+#include "base/stringprintf.h"
+#include "base/threading/thread.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webkit/blob/blob_data.h"
+#include "webkit/blob/blob_storage_controller.h"
+
+namespace webkit_blob {
+
+namespace {
+
+// 1GB of blobs, built from 4MB items, under a 100MB memory limit.
+const int kBlobCount = 4;
+const int kItemsPerBlob = 64;
+const int kItemSize = 4 * 1024 * 1024;
+const int64 kMemoryLimit = 100 * 1024 * 1024;
+const double kTotalMegabytes =
+    static_cast<double>(kBlobCount) * kItemsPerBlob * kItemSize /
+    (1024 * 1024);
+
+// Every byte of the |item|th item.
+char ItemByte(int item) {
+  return static_cast<char>('a' + item % 26);
+}
+
+}  // namespace
+
+class BlobStorageControllerPerfTest : public testing::Test {
+ protected:
+  BlobStorageControllerPerfTest() : file_thread_("BlobSpillFileThread") {}
+
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    ASSERT_TRUE(file_thread_.Start());
+    controller_.reset(new BlobStorageController());
+    controller_->EnableDiskSpill(temp_dir_.path(), kMemoryLimit,
+                                 file_thread_.message_loop_proxy());
+  }
+
+  virtual void TearDown() OVERRIDE {
+    controller_.reset();
+    WaitForFileThread();
+    file_thread_.Stop();
+  }
+
+  // Returns once the replies to everything posted to the file thread so far
+  // have run.
+  void WaitForFileThread() {
+    file_thread_.message_loop_proxy()->PostTaskAndReply(
+        FROM_HERE, base::Bind(&base::DoNothing),
+        MessageLoop::QuitClosure());
+    MessageLoop::current()->Run();
+  }
+
+  MessageLoop message_loop_;
+  ScopedTempDir temp_dir_;
+  base::Thread file_thread_;
+  scoped_ptr<BlobStorageController> controller_;
+};
+
+TEST_F(BlobStorageControllerPerfTest, SpillLargeBlobs) {
+  PerfTimer build_timer;
+  int item_index = 0;
+  std::vector<GURL> blob_urls;
+  for (int i = 0; i < kBlobCount; ++i) {
+    GURL blob_url(base::StringPrintf("blob:large_%d", i));
+    controller_->StartBuildingBlob(blob_url);
+    for (int j = 0; j < kItemsPerBlob; ++j) {
+      BlobData::Item item;
+      item.SetToData(std::string(kItemSize, ItemByte(item_index++)));
+      controller_->AppendBlobDataItem(blob_url, item);
+    }
+    controller_->FinishBuildingBlob(blob_url, "");
+    // Renderers send their blobs one message at a time, so the replies to
+    // the writes get to run in between.
+    WaitForFileThread();
+    ASSERT_TRUE(controller_->GetBlobDataFromUrl(blob_url));
+    blob_urls.push_back(blob_url);
+  }
+  LogPerfResult("BlobSpill_Build",
+                kTotalMegabytes / build_timer.Elapsed().InSecondsF(), "MB/s");
+  EXPECT_LE(controller_->memory_usage(), kMemoryLimit);
+
+  // Read everything back, from memory or from the spill files.
+  PerfTimer read_timer;
+  scoped_array<char> buffer(new char[kItemSize]);
+  int64 mismatched_bytes = 0;
+  item_index = 0;
+  for (size_t i = 0; i < blob_urls.size(); ++i) {
+    BlobData* blob_data = controller_->GetBlobDataFromUrl(blob_urls[i]);
+    ASSERT_TRUE(blob_data);
+    for (std::vector<BlobData::Item>::const_iterator iter =
+             blob_data->items().begin();
+         iter != blob_data->items().end(); ++iter) {
+      ASSERT_EQ(static_cast<uint64>(kItemSize), iter->length);
+      const char* data = buffer.get();
+      if (iter->type == BlobData::TYPE_DATA) {
+        data = iter->bytes() + iter->offset;
+      } else {
+        ASSERT_EQ(BlobData::TYPE_FILE, iter->type);
+        base::PlatformFile file = base::CreatePlatformFile(
+            iter->file_path,
+            base::PLATFORM_FILE_OPEN | base::PLATFORM_FILE_READ, NULL, NULL);
+        ASSERT_NE(base::kInvalidPlatformFileValue, file);
+        EXPECT_EQ(kItemSize, base::ReadPlatformFile(
+            file, iter->offset, buffer.get(), kItemSize));
+        base::ClosePlatformFile(file);
+      }
+      char expected = ItemByte(item_index++);
+      for (int k = 0; k < kItemSize; ++k) {
+        if (data[k] != expected)
+          ++mismatched_bytes;
+      }
+    }
+  }
+  LogPerfResult("BlobSpill_Read",
+                kTotalMegabytes / read_timer.Elapsed().InSecondsF(), "MB/s");
+  EXPECT_EQ(kBlobCount * kItemsPerBlob, item_index);
+  EXPECT_EQ(0, mismatched_bytes);
+}
+
+}  // namespace webkit_blob
@@ -3,8 +3,12 @@
 // found in the LICENSE file.
 
 #include "base/file_path.h"
+#include "base/file_util.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/message_loop_proxy.h"
+#include "base/scoped_temp_dir.h"
 #include "base/time.h"
 #include "net/base/upload_data.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -233,4 +237,111 @@ TEST(BlobStorageControllerTest, ResolveBlobReferencesInUploadData) {
   EXPECT_TRUE(upload_data->elements()->at(7) == upload_element2);
 }
 
+TEST(BlobStorageControllerTest, SliceSharesData) {
+  BlobStorageController blob_storage_controller;
+  scoped_refptr<BlobData> blob_data(new BlobData());
+  blob_data->AppendData("0123456789");
+  GURL blob_url1("blob://url_1");
+  blob_storage_controller.AddFinishedBlob(blob_url1, blob_data);
+
+  scoped_refptr<BlobData> slice_data(new BlobData());
+  slice_data->AppendBlob(blob_url1, 2, 5);
+  GURL blob_url2("blob://url_2");
+  blob_storage_controller.AddFinishedBlob(blob_url2, slice_data);
+
+  BlobData* source = blob_storage_controller.GetBlobDataFromUrl(blob_url1);
+  BlobData* slice = blob_storage_controller.GetBlobDataFromUrl(blob_url2);
+  ASSERT_TRUE(source && slice);
+  ASSERT_EQ(1U, slice->items().size());
+  const BlobData::Item& item = slice->items().at(0);
+  EXPECT_EQ(BlobData::TYPE_DATA, item.type);
+  EXPECT_EQ(source->items().at(0).shared_data, item.shared_data);
+  EXPECT_EQ(2U, item.offset);
+  EXPECT_EQ(5U, item.length);
+  EXPECT_EQ("23456", std::string(item.bytes() + item.offset, 5));
+  // The shared bytes are only counted once.
+  EXPECT_EQ(10, blob_storage_controller.memory_usage());
+
+  // Uploads refer to the blob's bytes too.
+  scoped_refptr<UploadData> upload_data(new UploadData());
+  upload_data->AppendBlob(blob_url2);
+  blob_storage_controller.ResolveBlobReferencesInUploadData(upload_data.get());
+  ASSERT_EQ(1U, upload_data->elements()->size());
+  const UploadData::Element& element = upload_data->elements()->at(0);
+  EXPECT_EQ(item.bytes() + item.offset, element.bytes_data());
+  EXPECT_EQ(5, element.bytes_length());
+}
+
+TEST(BlobStorageControllerTest, SpillToDisk) {
+  MessageLoop message_loop;
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  const int64 kMemoryLimit = 16;
+  BlobStorageController blob_storage_controller;
+  blob_storage_controller.EnableDiskSpill(
+      temp_dir.path(), kMemoryLimit, base::MessageLoopProxy::current());
+
+  scoped_refptr<BlobData> blob_data(new BlobData());
+  blob_data->AppendData("0123456789");
+  blob_data->AppendData("abcdefghij");
+  blob_data->AppendData("ABCDEFGHIJ");
+  GURL blob_url("blob://url_1");
+  blob_storage_controller.AddFinishedBlob(blob_url, blob_data);
+
+  // The blob is finished once its spilled data has been written.
+  EXPECT_FALSE(blob_storage_controller.GetBlobDataFromUrl(blob_url));
+  EXPECT_EQ(30, blob_storage_controller.memory_usage());
+  message_loop.RunAllPending();
+
+  // The first item fits in memory, the others go to one file.
+  BlobData* found = blob_storage_controller.GetBlobDataFromUrl(blob_url);
+  ASSERT_TRUE(found != NULL);
+  ASSERT_EQ(3U, found->items().size());
+  EXPECT_EQ(BlobData::TYPE_DATA, found->items().at(0).type);
+  EXPECT_EQ(10, blob_storage_controller.memory_usage());
+  const BlobData::Item& first_spilled = found->items().at(1);
+  const BlobData::Item& second_spilled = found->items().at(2);
+  ASSERT_EQ(BlobData::TYPE_FILE, first_spilled.type);
+  ASSERT_EQ(BlobData::TYPE_FILE, second_spilled.type);
+  EXPECT_EQ(first_spilled.file_path, second_spilled.file_path);
+  EXPECT_EQ(0U, first_spilled.offset);
+  EXPECT_EQ(10U, second_spilled.offset);
+  EXPECT_EQ(10U, second_spilled.length);
+  EXPECT_TRUE(temp_dir.path().IsParent(first_spilled.file_path));
+
+  std::string contents;
+  ASSERT_TRUE(file_util::ReadFileToString(first_spilled.file_path,
+                                          &contents));
+  EXPECT_EQ("abcdefghijABCDEFGHIJ", contents);
+
+  // The file goes away with the last blob that refers to it.
+  FilePath spill_path = first_spilled.file_path;
+  blob_storage_controller.RemoveBlob(blob_url);
+  message_loop.RunAllPending();
+  EXPECT_FALSE(file_util::PathExists(spill_path));
+  EXPECT_EQ(0, blob_storage_controller.memory_usage());
+}
+
+TEST(BlobStorageControllerTest, SpillFailureDropsBlob) {
+  MessageLoop message_loop;
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  // Nothing can be written to a directory that does not exist.
+  BlobStorageController blob_storage_controller;
+  blob_storage_controller.EnableDiskSpill(
+      temp_dir.path().AppendASCII("missing"), 0,
+      base::MessageLoopProxy::current());
+
+  scoped_refptr<BlobData> blob_data(new BlobData());
+  blob_data->AppendData("0123456789");
+  GURL blob_url("blob://url_1");
+  blob_storage_controller.AddFinishedBlob(blob_url, blob_data);
+  message_loop.RunAllPending();
+
+  EXPECT_FALSE(blob_storage_controller.GetBlobDataFromUrl(blob_url));
+  EXPECT_EQ(0, blob_storage_controller.memory_usage());
+}
+
 }  // namespace webkit_blob
@@ -350,7 +350,7 @@ bool BlobURLRequestJob::ReadBytesItem(const BlobData::Item& item,
   DCHECK_GE(read_buf_->BytesRemaining(), bytes_to_read);
 
   memcpy(read_buf_->data(),
-         &item.data.at(0) + item.offset + current_item_offset_,
+         item.bytes() + item.offset + current_item_offset_,
          bytes_to_read);
 
   AdvanceBytesRead(bytes_to_read);
@@ -25,6 +25,7 @@
 #include "net/url_request/url_request_error_job.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webkit/blob/blob_data.h"
+#include "webkit/blob/blob_storage_controller.h"
 #include "webkit/blob/blob_url_request_job.h"
 
 namespace webkit_blob {
@@ -175,6 +176,7 @@ class BlobURLRequestJobTest : public testing::Test {
 
     request_.reset();
     url_request_delegate_.reset();
+    blob_storage_controller_.reset();
 
     DCHECK(!blob_url_request_job_);
     net::URLRequest::Deprecated::RegisterProtocolFactory("blob", NULL);
@@ -371,6 +373,37 @@ class BlobURLRequestJobTest : public testing::Test {
     TestRequest("GET", net::HttpRequestHeaders(), blob_data);
   }
 
+  void TestGetSpilledBlobRequest() {
+    // The second item goes over the limit and is read back from disk.
+    blob_storage_controller_.reset(new BlobStorageController());
+    blob_storage_controller_->EnableDiskSpill(
+        temp_dir_.path(), arraysize(kTestData1) - 1,
+        base::MessageLoopProxy::current());
+    spilled_blob_url_ = GURL("blob:spilled");
+    scoped_refptr<BlobData> blob_data(new BlobData());
+    blob_data->AppendData(kTestData1);
+    blob_data->AppendData(kTestData2);
+    blob_storage_controller_->AddFinishedBlob(spilled_blob_url_, blob_data);
+
+    // The reply follows those of the spill writes posted before it.
+    base::MessageLoopProxy::current()->PostTaskAndReply(
+        FROM_HERE, base::Bind(&base::DoNothing),
+        base::Bind(&BlobURLRequestJobTest::RequestSpilledBlob,
+                   base::Unretained(this)));
+  }
+
+  void RequestSpilledBlob() {
+    BlobData* blob_data =
+        blob_storage_controller_->GetBlobDataFromUrl(spilled_blob_url_);
+    if (!blob_data) {
+      ADD_FAILURE() << "The blob was not finished";
+      TestFinished();
+      return;
+    }
+    EXPECT_EQ(BlobData::TYPE_FILE, blob_data->items().at(1).type);
+    TestSuccessRequest(blob_data, std::string(kTestData1) + kTestData2);
+  }
+
   void VerifyResponseForTestExtraHeaders() {
     EXPECT_TRUE(request_->status().is_success());
     EXPECT_EQ(request_->response_headers()->response_code(), 200);
@@ -399,6 +432,8 @@ class BlobURLRequestJobTest : public testing::Test {
   std::stack<std::pair<base::Closure, bool> > task_stack_;
   scoped_ptr<net::URLRequest> request_;
   scoped_ptr<MockURLRequestDelegate> url_request_delegate_;
+  scoped_ptr<BlobStorageController> blob_storage_controller_;
+  GURL spilled_blob_url_;
   int expected_status_code_;
   std::string expected_response_;
 };
@@ -447,4 +482,8 @@ TEST_F(BlobURLRequestJobTest, TestExtraHeaders) {
   RunTestOnIOThread(&BlobURLRequestJobTest::TestExtraHeaders);
 }
 
+TEST_F(BlobURLRequestJobTest, TestGetSpilledBlobRequest) {
+  RunTestOnIOThread(&BlobURLRequestJobTest::TestGetSpilledBlobRequest);
+}
+
 }  // namespace webkit_blob
@@ -175,8 +175,11 @@ void DatabaseTracker::DatabaseClosed(const string16& origin_identifier,
         quota::kStorageTypeTemporary);
 
   UpdateOpenDatabaseSizeAndNotify(origin_identifier, database_name);
-  if (database_connections_.RemoveConnection(origin_identifier, database_name))
+  if (database_connections_.RemoveConnection(origin_identifier,
+                                             database_name)) {
+    ForgetOpenDatabasePath(origin_identifier, database_name);
     DeleteDatabaseIfNeeded(origin_identifier, database_name);
+  }
 }
 
 void DatabaseTracker::HandleSqliteError(
@@ -219,10 +222,22 @@ void DatabaseTracker::CloseDatabases(const DatabaseConnections& connections) {
   database_connections_.RemoveConnections(connections, &closed_dbs);
   for (std::vector<std::pair<string16, string16> >::iterator it =
            closed_dbs.begin(); it != closed_dbs.end(); ++it) {
+    ForgetOpenDatabasePath(it->first, it->second);
     DeleteDatabaseIfNeeded(it->first, it->second);
   }
 }
 
+void DatabaseTracker::ForgetOpenDatabasePath(const string16& origin_identifier,
+                                             const string16& database_name) {
+  DatabasePathsMap::iterator origin_paths =
+      open_database_paths_.find(origin_identifier);
+  if (origin_paths == open_database_paths_.end())
+    return;
+  origin_paths->second.erase(database_name);
+  if (origin_paths->second.empty())
+    open_database_paths_.erase(origin_paths);
+}
+
 void DatabaseTracker::DeleteDatabaseIfNeeded(const string16& origin_identifier,
                                              const string16& database_name) {
   DCHECK(!database_connections_.IsDatabaseOpened(origin_identifier,
@@ -270,6 +285,7 @@ void DatabaseTracker::RemoveObserver(Observer* observer) {
 
 void DatabaseTracker::CloseTrackerDatabaseAndClearCaches() {
   ClearAllCachedOriginInfo();
+  open_database_paths_.clear();
 
   if (!is_incognito_) {
     meta_table_.reset(NULL);
@@ -302,6 +318,15 @@ FilePath DatabaseTracker::GetFullDBFilePath(
   if (!LazyInit())
     return FilePath();
 
+  DatabasePathsMap::const_iterator origin_paths =
+      open_database_paths_.find(origin_identifier);
+  if (origin_paths != open_database_paths_.end()) {
+    std::map<string16, FilePath>::const_iterator found =
+        origin_paths->second.find(database_name);
+    if (found != origin_paths->second.end())
+      return found->second;
+  }
+
   int64 id = databases_table_->GetDatabaseID(
       origin_identifier, database_name);
   if (id < 0)
@@ -309,8 +334,11 @@ FilePath DatabaseTracker::GetFullDBFilePath(
 
   FilePath file_name = FilePath::FromWStringHack(
       UTF8ToWide(base::Int64ToString(id)));
-  return db_dir_.Append(FilePath::FromWStringHack(
+  FilePath full_path = db_dir_.Append(FilePath::FromWStringHack(
       UTF16ToWide(GetOriginDirectory(origin_identifier)))).Append(file_name);
+  if (database_connections_.IsDatabaseOpened(origin_identifier, database_name))
+    open_database_paths_[origin_identifier][database_name] = full_path;
+  return full_path;
 }
 
 bool DatabaseTracker::GetOriginInfo(const string16& origin_identifier,
@@ -413,6 +441,7 @@ bool DatabaseTracker::DeleteOrigin(const string16& origin_identifier,
   }
 
   origins_info_map_.erase(origin_identifier);
+  open_database_paths_.erase(origin_identifier);
   FilePath origin_dir = db_dir_.Append(FilePath::FromWStringHack(
       UTF16ToWide(origin_identifier)));
 
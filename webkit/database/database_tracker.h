@@ -180,6 +180,7 @@ class DatabaseTracker
       PendingDeletionCallbacks;
   typedef std::map<string16, base::PlatformFile> FileHandlesMap;
   typedef std::map<string16, string16> OriginDirectoriesMap;
+  typedef std::map<string16, std::map<string16, FilePath> > DatabasePathsMap;
 
   class CachedOriginInfo : public OriginInfo {
    public:
@@ -220,6 +221,10 @@ class DatabaseTracker
   void DeleteDatabaseIfNeeded(const string16& origin_identifier,
                               const string16& database_name);
 
+  // Forgets the cached path of a database that no longer has connections.
+  void ForgetOpenDatabasePath(const string16& origin_identifier,
+                              const string16& database_name);
+
   bool LazyInit();
   bool UpgradeToCurrentVersion();
   void InsertOrUpdateDatabaseDetails(const string16& origin_identifier,
@@ -273,6 +278,12 @@ class DatabaseTracker
   std::map<string16, CachedOriginInfo> origins_info_map_;
   DatabaseConnections database_connections_;
 
+  // The full paths of the open databases. Every vfs call a renderer makes
+  // during a transaction maps its file name to a path, so these are kept
+  // while a database has connections instead of querying the tracker
+  // database each time. The connection counts above decide their lifetime.
+  DatabasePathsMap open_database_paths_;
+
   // The set of databases that should be deleted but are still opened
   DatabaseSet dbs_to_be_deleted_;
   PendingDeletionCallbacks deletion_callbacks_;
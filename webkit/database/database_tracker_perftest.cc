@@ -0,0 +1,70 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/perftimer.h"
+#include "base/scoped_temp_dir.h"
+#include "base/utf_string_conversions.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webkit/database/database_tracker.h"
+#include "webkit/database/database_util.h"
+
+namespace webkit_database {
+
+namespace {
+
+const int kTransactions = 10000;
+// A renderer resolves three vfs file names per write transaction: the hot
+// journal check, then the journal's open and delete.
+const int kLookupsPerTransaction = 3;
+const char kOriginUrl[] = "http://perf.example.com";
+
+}  // namespace
+
+class DatabaseTrackerPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    tracker_ = new DatabaseTracker(temp_dir_.path(), false, NULL, NULL, NULL);
+    origin_identifier_ = DatabaseUtil::GetOriginIdentifier(GURL(kOriginUrl));
+    database_name_ = ASCIIToUTF16("perf");
+  }
+
+  // Resolves the journal's vfs file name as often as |kTransactions| write
+  // transactions would, and returns the lookups per second.
+  double RunLookups() {
+    const string16 journal_vfs_file_name = origin_identifier_ +
+        ASCIIToUTF16("/") + database_name_ + ASCIIToUTF16("#") +
+        ASCIIToUTF16(DatabaseUtil::kJournalFileSuffix);
+    PerfTimer timer;
+    for (int i = 0; i < kTransactions; ++i) {
+      for (int call = 0; call < kLookupsPerTransaction; ++call) {
+        EXPECT_FALSE(DatabaseUtil::GetFullFilePathForVfsFile(
+            tracker_, journal_vfs_file_name).empty());
+      }
+    }
+    return kTransactions * kLookupsPerTransaction /
+        timer.Elapsed().InSecondsF();
+  }
+
+  ScopedTempDir temp_dir_;
+  scoped_refptr<DatabaseTracker> tracker_;
+  string16 origin_identifier_;
+  string16 database_name_;
+};
+
+TEST_F(DatabaseTrackerPerfTest, VfsFileNameLookups) {
+  int64 database_size = 0;
+  tracker_->DatabaseOpened(origin_identifier_, database_name_,
+                           ASCIIToUTF16("description"), 0, &database_size);
+  LogPerfResult("DatabaseTracker_OpenLookups", RunLookups(), "lookups/s");
+
+  // Paths of closed databases come from the tracker database every time.
+  tracker_->DatabaseClosed(origin_identifier_, database_name_);
+  LogPerfResult("DatabaseTracker_ClosedLookups", RunLookups(), "lookups/s");
+}
+
+}  // namespace webkit_database
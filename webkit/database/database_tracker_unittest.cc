@@ -433,6 +433,49 @@ class DatabaseTracker_TestHelper_Test {
     EXPECT_EQ(0, origin1_info->TotalSize());
   }
 
+  static void TestOpenDatabasePaths(bool incognito_mode) {
+    ScopedTempDir temp_dir;
+    ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+    scoped_refptr<DatabaseTracker> tracker(
+        new DatabaseTracker(temp_dir.path(), incognito_mode, NULL, NULL, NULL));
+
+    int64 database_size = 0;
+    const string16 kOrigin1 =
+        DatabaseUtil::GetOriginIdentifier(GURL(kOrigin1Url));
+    const string16 kDB1 = ASCIIToUTF16("db1");
+    const string16 kDB2 = ASCIIToUTF16("db2");
+    const string16 kDescription = ASCIIToUTF16("database_description");
+
+    // Paths of open databases are kept across calls.
+    tracker->DatabaseOpened(kOrigin1, kDB1, kDescription, 0, &database_size);
+    tracker->DatabaseOpened(kOrigin1, kDB1, kDescription, 0, &database_size);
+    FilePath db1_path = tracker->GetFullDBFilePath(kOrigin1, kDB1);
+    EXPECT_FALSE(db1_path.empty());
+    EXPECT_EQ(1u, tracker->open_database_paths_[kOrigin1].size());
+    EXPECT_EQ(db1_path, tracker->GetFullDBFilePath(kOrigin1, kDB1));
+
+    // Paths of closed databases are not.
+    tracker->DatabaseOpened(kOrigin1, kDB2, kDescription, 0, &database_size);
+    tracker->DatabaseClosed(kOrigin1, kDB2);
+    FilePath db2_path = tracker->GetFullDBFilePath(kOrigin1, kDB2);
+    EXPECT_FALSE(db2_path.empty());
+    EXPECT_NE(db1_path, db2_path);
+    EXPECT_EQ(1u, tracker->open_database_paths_[kOrigin1].size());
+
+    // The path is kept until the last connection closes.
+    tracker->DatabaseClosed(kOrigin1, kDB1);
+    EXPECT_EQ(1u, tracker->open_database_paths_[kOrigin1].size());
+    tracker->DatabaseClosed(kOrigin1, kDB1);
+    EXPECT_TRUE(tracker->open_database_paths_.empty());
+    EXPECT_EQ(db1_path, tracker->GetFullDBFilePath(kOrigin1, kDB1));
+    EXPECT_TRUE(tracker->open_database_paths_.empty());
+
+    // A deleted database has no path.
+    EXPECT_EQ(net::OK, tracker->DeleteDatabase(kOrigin1, kDB1,
+                                               net::CompletionCallback()));
+    EXPECT_TRUE(tracker->GetFullDBFilePath(kOrigin1, kDB1).empty());
+  }
+
   static void DatabaseTrackerQuotaIntegration() {
     const GURL kOrigin(kOrigin1Url);
     const string16 kOriginId = DatabaseUtil::GetOriginIdentifier(kOrigin);
@@ -919,6 +962,14 @@ TEST(DatabaseTrackerTest, DatabaseTrackerIncognitoMode) {
   DatabaseTracker_TestHelper_Test::TestDatabaseTracker(true);
 }
 
+TEST(DatabaseTrackerTest, OpenDatabasePaths) {
+  DatabaseTracker_TestHelper_Test::TestOpenDatabasePaths(false);
+}
+
+TEST(DatabaseTrackerTest, OpenDatabasePathsIncognitoMode) {
+  DatabaseTracker_TestHelper_Test::TestOpenDatabasePaths(true);
+}
+
 TEST(DatabaseTrackerTest, DatabaseTrackerQuotaIntegration) {
   // There is no difference in behavior between incognito and not.
   DatabaseTracker_TestHelper_Test::DatabaseTrackerQuotaIntegration();
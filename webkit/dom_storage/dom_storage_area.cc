@@ -4,6 +4,8 @@
 
 #include "webkit/dom_storage/dom_storage_area.h"
 
+#include <algorithm>
+
 #include "base/bind.h"
 #include "base/file_util.h"
 #include "base/location.h"
@@ -23,9 +25,15 @@ using webkit_database::DatabaseUtil;
 namespace dom_storage {
 
 static const int kCommitTimerSeconds = 1;
+static const int kMaxCommitTimerSeconds = 5;
+
+// A batch that saw more writes per second than this pushes the next
+// commit out in proportion, up to kMaxCommitTimerSeconds.
+static const double kBusyWritesPerSecond = 1.0;
 
 DomStorageArea::CommitBatch::CommitBatch()
-  : clear_all_first(false) {
+  : clear_all_first(false),
+    write_count(0) {
 }
 DomStorageArea::CommitBatch::~CommitBatch() {}
 
@@ -60,7 +68,8 @@ DomStorageArea::DomStorageArea(
       task_runner_(task_runner),
       map_(new DomStorageMap(kPerAreaQuota)),
       is_initial_import_done_(true),
-      is_shutdown_(false) {
+      is_shutdown_(false),
+      commit_delay_(base::TimeDelta::FromSeconds(kCommitTimerSeconds)) {
   if (namespace_id == kLocalStorageNamespaceId && !directory.empty()) {
     FilePath path = directory.Append(DatabaseFileNameFromOrigin(origin_));
     backing_.reset(new DomStorageDatabase(path));
@@ -103,7 +112,8 @@ bool DomStorageArea::SetItem(const string16& key,
   bool success = map_->SetItem(key, value, old_value);
   if (success && backing_.get()) {
     CommitBatch* commit_batch = CreateCommitBatchIfNeeded();
-    commit_batch->changed_values[key] = NullableString16(value, false);
+    commit_batch->changed_values[key] = NullableString16(true);
+    ++commit_batch->write_count;
   }
   return success;
 }
@@ -118,6 +128,7 @@ bool DomStorageArea::RemoveItem(const string16& key, string16* old_value) {
   if (success && backing_.get()) {
     CommitBatch* commit_batch = CreateCommitBatchIfNeeded();
     commit_batch->changed_values[key] = NullableString16(true);
+    ++commit_batch->write_count;
   }
   return success;
 }
@@ -135,6 +146,7 @@ bool DomStorageArea::Clear() {
     CommitBatch* commit_batch = CreateCommitBatchIfNeeded();
     commit_batch->clear_all_first = true;
     commit_batch->changed_values.clear();
+    ++commit_batch->write_count;
   }
 
   return true;
@@ -197,6 +209,8 @@ void DomStorageArea::PurgeMemory() {
 void DomStorageArea::Shutdown() {
   DCHECK(!is_shutdown_);
   is_shutdown_ = true;
+  if (commit_batch_.get())
+    PopulateCommitBatchValues();
   map_ = NULL;
   if (!backing_.get())
     return;
@@ -233,12 +247,33 @@ DomStorageArea::CommitBatch* DomStorageArea::CreateCommitBatchIfNeeded() {
       task_runner_->PostDelayedTask(
           FROM_HERE,
           base::Bind(&DomStorageArea::OnCommitTimer, this),
-          base::TimeDelta::FromSeconds(kCommitTimerSeconds));
+          commit_delay_);
     }
   }
   return commit_batch_.get();
 }
 
+void DomStorageArea::PopulateCommitBatchValues() {
+  DCHECK(commit_batch_.get());
+  DCHECK(map_.get());
+  ValuesMap::iterator it = commit_batch_->changed_values.begin();
+  for (; it != commit_batch_->changed_values.end(); ++it)
+    it->second = map_->GetItem(it->first);
+}
+
+void DomStorageArea::UpdateCommitDelay(const CommitBatch& batch) {
+  // A page that writes on every keystroke would otherwise rewrite the
+  // same values every second while the user types.
+  double writes_per_second = batch.write_count / commit_delay_.InSecondsF();
+  double scale = std::max(writes_per_second / kBusyWritesPerSecond, 1.0);
+  int64 delay_ms = std::min(
+      static_cast<int64>(scale * kCommitTimerSeconds *
+                         base::Time::kMillisecondsPerSecond),
+      static_cast<int64>(kMaxCommitTimerSeconds) *
+          base::Time::kMillisecondsPerSecond);
+  commit_delay_ = base::TimeDelta::FromMilliseconds(delay_ms);
+}
+
 void DomStorageArea::OnCommitTimer() {
   DCHECK_EQ(kLocalStorageNamespaceId, namespace_id_);
   if (is_shutdown_)
@@ -250,6 +285,8 @@ void DomStorageArea::OnCommitTimer() {
 
   // This method executes on the primary sequence, we schedule
   // a task for immediate execution on the commit sequence.
+  PopulateCommitBatchValues();
+  UpdateCommitDelay(*commit_batch_);
   in_flight_commit_batch_ = commit_batch_.Pass();
   bool success = task_runner_->PostShutdownBlockingTask(
       FROM_HERE,
@@ -280,7 +317,7 @@ void DomStorageArea::OnCommitComplete() {
     task_runner_->PostDelayedTask(
         FROM_HERE,
         base::Bind(&DomStorageArea::OnCommitTimer, this),
-        base::TimeDelta::FromSeconds(kCommitTimerSeconds));
+        commit_delay_);
   }
 }
 
@@ -11,6 +11,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/nullable_string16.h"
 #include "base/string16.h"
+#include "base/time.h"
 #include "googleurl/src/gurl.h"
 #include "webkit/dom_storage/dom_storage_database.h"
 #include "webkit/dom_storage/dom_storage_types.h"
@@ -67,6 +68,7 @@ class DomStorageArea
 
  private:
   friend class DomStorageAreaTest;
+  friend class DomStorageAreaPerfTest;
   FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, DomStorageAreaBasics);
   FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, BackingDatabaseOpened);
   FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, TestDatabaseFilePath);
@@ -74,11 +76,18 @@ class DomStorageArea
   FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, CommitChangesAtShutdown);
   FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, DeleteOrigin);
   FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, PurgeMemory);
+  FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, CoalescedCommit);
+  FRIEND_TEST_ALL_PREFIXES(DomStorageAreaTest, AdaptiveCommitDelay);
   friend class base::RefCountedThreadSafe<DomStorageArea>;
 
   struct CommitBatch {
     bool clear_all_first;
+    // Only the keys are recorded as changes are made, the values are
+    // copied from the map when the batch is committed.  A key that is
+    // changed many times is copied once per commit.
     ValuesMap changed_values;
+    // The number of changes made while the batch was open.
+    int write_count;
     CommitBatch();
     ~CommitBatch();
   };
@@ -94,6 +103,8 @@ class DomStorageArea
   // disk on the commit sequence, and to call back on the primary
   // task sequence when complete.
   CommitBatch* CreateCommitBatchIfNeeded();
+  void PopulateCommitBatchValues();
+  void UpdateCommitDelay(const CommitBatch& batch);
   void OnCommitTimer();
   void CommitChanges();
   void OnCommitComplete();
@@ -110,6 +121,10 @@ class DomStorageArea
   bool is_shutdown_;
   scoped_ptr<CommitBatch> commit_batch_;
   scoped_ptr<CommitBatch> in_flight_commit_batch_;
+
+  // How long changes accrue before they're committed.  Pages that write
+  // continuously have their commits spaced further apart.
+  base::TimeDelta commit_delay_;
 };
 
 }  // namespace dom_storage
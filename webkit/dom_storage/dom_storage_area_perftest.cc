@@ -0,0 +1,125 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop.h"
+#include "base/message_loop_proxy.h"
+#include "base/perftimer.h"
+#include "base/scoped_temp_dir.h"
+#include "base/string_number_conversions.h"
+#include "base/utf_string_conversions.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webkit/dom_storage/dom_storage_area.h"
+#include "webkit/dom_storage/dom_storage_task_runner.h"
+#include "webkit/dom_storage/dom_storage_types.h"
+
+namespace dom_storage {
+
+namespace {
+
+// A page that saves a draft to localStorage on every keystroke.
+const int kKeystrokes = 3000;
+const int kKeystrokesPerSecond = 5;
+
+const int kItemCount = 1000;
+const int kGetItemRounds = 100;
+
+size_t ItemBytes(const string16& key, const string16& value) {
+  return (key.length() + value.length()) * sizeof(char16);
+}
+
+}  // namespace
+
+class DomStorageAreaPerfTest : public testing::Test {
+ protected:
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    // The mock task runner ignores delays, so each RunAllPending() runs
+    // whatever commit is pending.
+    area_ = new DomStorageArea(
+        kLocalStorageNamespaceId, GURL("http://dom_storage/"),
+        temp_dir_.path(),
+        new MockDomStorageTaskRunner(base::MessageLoopProxy::current()));
+  }
+
+  virtual void TearDown() OVERRIDE {
+    area_->Shutdown();
+    MessageLoop::current()->RunAllPending();
+    area_ = NULL;
+  }
+
+  double commit_delay_seconds() const {
+    return area_->commit_delay_.InSecondsF();
+  }
+
+  MessageLoop message_loop_;
+  ScopedTempDir temp_dir_;
+  scoped_refptr<DomStorageArea> area_;
+};
+
+TEST_F(DomStorageAreaPerfTest, KeystrokeDraft) {
+  const string16 key(ASCIIToUTF16("draft"));
+  string16 value;
+  NullableString16 old_value;
+
+  int commits = 0;
+  int64 committed_bytes = 0;
+  // What a commit every kCommitTimerSeconds would have written.
+  int fixed_commits = 0;
+  int64 fixed_committed_bytes = 0;
+
+  PerfTimer timer;
+  int typed = 0;
+  while (typed < kKeystrokes) {
+    // Type for as long as the area waits before committing.
+    int burst = static_cast<int>(kKeystrokesPerSecond *
+                                 commit_delay_seconds());
+    for (int i = 0; i < burst && typed < kKeystrokes; ++i, ++typed) {
+      value.push_back('a' + typed % 26);
+      ASSERT_TRUE(area_->SetItem(key, value, &old_value));
+      if ((typed + 1) % kKeystrokesPerSecond == 0) {
+        ++fixed_commits;
+        fixed_committed_bytes += ItemBytes(key, value);
+      }
+    }
+    MessageLoop::current()->RunAllPending();
+    ASSERT_FALSE(area_->HasUncommittedChanges());
+    ++commits;
+    committed_bytes += ItemBytes(key, value);
+  }
+  double seconds = timer.Elapsed().InSecondsF();
+
+  LogPerfResult("DomStorageKeystroke_SetItem", kKeystrokes / seconds,
+                "items/s");
+  LogPerfResult("DomStorageKeystroke_Commits", commits, "commits");
+  LogPerfResult("DomStorageKeystroke_CommitBytes",
+                static_cast<double>(committed_bytes), "bytes");
+  LogPerfResult("DomStorageKeystroke_FixedDelayCommits", fixed_commits,
+                "commits");
+  LogPerfResult("DomStorageKeystroke_FixedDelayCommitBytes",
+                static_cast<double>(fixed_committed_bytes), "bytes");
+  EXPECT_LT(committed_bytes, fixed_committed_bytes);
+}
+
+TEST_F(DomStorageAreaPerfTest, GetItem) {
+  NullableString16 old_value;
+  std::vector<string16> keys;
+  for (int i = 0; i < kItemCount; ++i) {
+    keys.push_back(ASCIIToUTF16("key" + base::IntToString(i)));
+    ASSERT_TRUE(area_->SetItem(keys.back(), ASCIIToUTF16("value"),
+                               &old_value));
+  }
+  MessageLoop::current()->RunAllPending();
+
+  PerfTimer timer;
+  for (int round = 0; round < kGetItemRounds; ++round) {
+    for (int i = 0; i < kItemCount; ++i)
+      ASSERT_FALSE(area_->GetItem(keys[i]).is_null());
+  }
+  LogPerfResult("DomStorage_GetItem",
+                kGetItemRounds * kItemCount / timer.Elapsed().InSecondsF(),
+                "items/s");
+}
+
+}  // namespace dom_storage
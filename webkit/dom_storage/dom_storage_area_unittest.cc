@@ -403,6 +403,80 @@ TEST_F(DomStorageAreaTest, PurgeMemory) {
   EXPECT_NE(original_map, area->map_.get());
 }
 
+TEST_F(DomStorageAreaTest, CoalescedCommit) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  scoped_refptr<DomStorageArea> area(
+      new DomStorageArea(kLocalStorageNamespaceId, kOrigin,
+          temp_dir.path(),
+          new MockDomStorageTaskRunner(base::MessageLoopProxy::current())));
+  area->backing_.reset(new DomStorageDatabase());
+
+  // Repeated changes to a key are recorded once, and the value committed
+  // is the one in the map at commit time.
+  NullableString16 old_value;
+  string16 removed_value;
+  EXPECT_TRUE(area->SetItem(kKey, kValue, &old_value));
+  EXPECT_TRUE(area->SetItem(kKey, kValue2, &old_value));
+  EXPECT_TRUE(area->SetItem(kKey2, kValue, &old_value));
+  EXPECT_TRUE(area->RemoveItem(kKey2, &removed_value));
+  ASSERT_TRUE(area->commit_batch_.get());
+  EXPECT_EQ(2u, area->commit_batch_->changed_values.size());
+  EXPECT_EQ(4, area->commit_batch_->write_count);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_FALSE(area->HasUncommittedChanges());
+
+  ValuesMap values;
+  area->backing_->ReadAllValues(&values);
+  EXPECT_EQ(1u, values.size());
+  EXPECT_EQ(kValue2, values[kKey].string());
+}
+
+TEST_F(DomStorageAreaTest, AdaptiveCommitDelay) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  scoped_refptr<DomStorageArea> area(
+      new DomStorageArea(kLocalStorageNamespaceId, kOrigin,
+          temp_dir.path(),
+          new MockDomStorageTaskRunner(base::MessageLoopProxy::current())));
+  area->backing_.reset(new DomStorageDatabase());
+  EXPECT_EQ(1, area->commit_delay_.InSeconds());
+
+  // A burst of writes pushes the next commit out, up to the limit.
+  NullableString16 old_value;
+  string16 value;
+  for (int i = 0; i < 20; ++i) {
+    value.push_back('a');
+    EXPECT_TRUE(area->SetItem(kKey, value, &old_value));
+  }
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(5, area->commit_delay_.InSeconds());
+
+  // The delay follows the rate, three writes in five seconds is below
+  // one a second but three writes in one second is not.
+  for (int i = 0; i < 3; ++i) {
+    value.push_back('a');
+    EXPECT_TRUE(area->SetItem(kKey, value, &old_value));
+  }
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(1, area->commit_delay_.InSeconds());
+  for (int i = 0; i < 3; ++i) {
+    value.push_back('a');
+    EXPECT_TRUE(area->SetItem(kKey, value, &old_value));
+  }
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(3, area->commit_delay_.InSeconds());
+
+  // And once the page goes quiet commits happen promptly again.
+  EXPECT_TRUE(area->SetItem(kKey2, kValue2, &old_value));
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(1, area->commit_delay_.InSeconds());
+
+  ValuesMap values;
+  area->backing_->ReadAllValues(&values);
+  EXPECT_EQ(value, values[kKey].string());
+}
+
 TEST_F(DomStorageAreaTest, DatabaseFileNames) {
   struct {
     const char* origin;
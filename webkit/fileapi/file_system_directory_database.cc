@@ -76,6 +76,9 @@ const char kChildLookupSeparator[] = ":";
 const char kLastFileIdKey[] = "LAST_FILE_ID";
 const char kLastIntegerKey[] = "LAST_INTEGER";
 const int64 kMinimumReportIntervalHours = 1;
+// Enough for the directories of any reasonable tree, plus the files of a
+// large directory.
+const size_t kMaxCachedChildIds = 10000;
 const char kInitStatusHistogramLabel[] = "FileSystem.DirectoryDatabaseInit";
 
 enum InitStatus {
@@ -126,7 +129,26 @@ FileSystemDirectoryDatabase::FileInfo::FileInfo() : parent_id(0) {
 FileSystemDirectoryDatabase::FileInfo::~FileInfo() {
 }
 
-FileSystemDirectoryDatabase::FileSystemDirectoryDatabase(const FilePath& path) {
+FileSystemDirectoryDatabase::PendingWrites::PendingWrites() {
+}
+
+FileSystemDirectoryDatabase::PendingWrites::~PendingWrites() {
+}
+
+void FileSystemDirectoryDatabase::PendingWrites::Put(
+    const std::string& key, const std::string& value) {
+  deletes.erase(key);
+  puts[key] = value;
+}
+
+void FileSystemDirectoryDatabase::PendingWrites::Delete(
+    const std::string& key) {
+  puts.erase(key);
+  deletes.insert(key);
+}
+
+FileSystemDirectoryDatabase::FileSystemDirectoryDatabase(const FilePath& path)
+    : batch_depth_(0) {
 #if defined(OS_POSIX)
   path_ = path.value();
 #elif defined(OS_WIN)
@@ -143,9 +165,13 @@ bool FileSystemDirectoryDatabase::GetChildWithName(
     return false;
   DCHECK(child_id);
   std::string child_key = GetChildLookupKey(parent_id, name);
+  ChildIdCache::const_iterator found = child_id_cache_.find(child_key);
+  if (found != child_id_cache_.end()) {
+    *child_id = found->second;
+    return true;
+  }
   std::string child_id_string;
-  leveldb::Status status =
-      db_->Get(leveldb::ReadOptions(), child_key, &child_id_string);
+  leveldb::Status status = ReadValue(child_key, &child_id_string);
   if (status.IsNotFound())
     return false;
   if (status.ok()) {
@@ -153,6 +179,9 @@ bool FileSystemDirectoryDatabase::GetChildWithName(
       LOG(ERROR) << "Hit database corruption!";
       return false;
     }
+    if (child_id_cache_.size() >= kMaxCachedChildIds)
+      child_id_cache_.clear();
+    child_id_cache_[child_key] = *child_id;
     return true;
   }
   HandleError(FROM_HERE, status);
@@ -188,16 +217,30 @@ bool FileSystemDirectoryDatabase::ListChildren(
   scoped_ptr<leveldb::Iterator> iter(db_->NewIterator(leveldb::ReadOptions()));
   iter->Seek(child_key_prefix);
   children->clear();
+  std::vector<std::string> child_id_strings;
   while (iter->Valid() &&
       StartsWithASCII(iter->key().ToString(), child_key_prefix, true)) {
-    std::string child_id_string = iter->value().ToString();
+    // Children the open batch changed are listed from the batch below.
+    std::string key = iter->key().ToString();
+    if (!batch_writes_.puts.count(key) && !batch_writes_.deletes.count(key))
+      child_id_strings.push_back(iter->value().ToString());
+    iter->Next();
+  }
+  for (std::map<std::string, std::string>::const_iterator pending =
+           batch_writes_.puts.lower_bound(child_key_prefix);
+       pending != batch_writes_.puts.end() &&
+       StartsWithASCII(pending->first, child_key_prefix, true);
+       ++pending) {
+    child_id_strings.push_back(pending->second);
+  }
+
+  for (size_t i = 0; i < child_id_strings.size(); ++i) {
     FileId child_id;
-    if (!base::StringToInt64(child_id_string, &child_id)) {
+    if (!base::StringToInt64(child_id_strings[i], &child_id)) {
       LOG(ERROR) << "Hit database corruption!";
       return false;
     }
     children->push_back(child_id);
-    iter->Next();
   }
   return true;
 }
@@ -208,8 +251,7 @@ bool FileSystemDirectoryDatabase::GetFileInfo(FileId file_id, FileInfo* info) {
   DCHECK(info);
   std::string file_key = GetFileLookupKey(file_id);
   std::string file_data_string;
-  leveldb::Status status =
-      db_->Get(leveldb::ReadOptions(), file_key, &file_data_string);
+  leveldb::Status status = ReadValue(file_key, &file_data_string);
   if (status.ok()) {
     return FileInfoFromPickle(
         Pickle(file_data_string.data(), file_data_string.length()), info);
@@ -235,8 +277,7 @@ bool FileSystemDirectoryDatabase::AddFileInfo(
   DCHECK(file_id);
   std::string child_key = GetChildLookupKey(info.parent_id, info.name);
   std::string child_id_string;
-  leveldb::Status status =
-      db_->Get(leveldb::ReadOptions(), child_key, &child_id_string);
+  leveldb::Status status = ReadValue(child_key, &child_id_string);
   if (status.ok()) {
     LOG(ERROR) << "File exists already!";
     return false;
@@ -257,16 +298,13 @@ bool FileSystemDirectoryDatabase::AddFileInfo(
     return false;
   ++temp_id;
 
-  leveldb::WriteBatch batch;
-  if (!AddFileInfoHelper(info, temp_id, &batch))
+  PendingWrites writes;
+  if (!AddFileInfoHelper(info, temp_id, &writes))
     return false;
 
-  batch.Put(LastFileIdKey(), base::Int64ToString(temp_id));
-  status = db_->Write(leveldb::WriteOptions(), &batch);
-  if (!status.ok()) {
-    HandleError(FROM_HERE, status);
+  writes.Put(LastFileIdKey(), base::Int64ToString(temp_id));
+  if (!ApplyWrites(writes))
     return false;
-  }
   *file_id = temp_id;
   return true;
 }
@@ -274,15 +312,10 @@ bool FileSystemDirectoryDatabase::AddFileInfo(
 bool FileSystemDirectoryDatabase::RemoveFileInfo(FileId file_id) {
   if (!Init())
     return false;
-  leveldb::WriteBatch batch;
-  if (!RemoveFileInfoHelper(file_id, &batch))
-    return false;
-  leveldb::Status status = db_->Write(leveldb::WriteOptions(), &batch);
-  if (!status.ok()) {
-    HandleError(FROM_HERE, status);
+  PendingWrites writes;
+  if (!RemoveFileInfoHelper(file_id, &writes))
     return false;
-  }
-  return true;
+  return ApplyWrites(writes);
 }
 
 bool FileSystemDirectoryDatabase::UpdateFileInfo(
@@ -307,16 +340,11 @@ bool FileSystemDirectoryDatabase::UpdateFileInfo(
       return false;
     }
   }
-  leveldb::WriteBatch batch;
-  if (!RemoveFileInfoHelper(file_id, &batch) ||
-      !AddFileInfoHelper(new_info, file_id, &batch))
-    return false;
-  leveldb::Status status = db_->Write(leveldb::WriteOptions(), &batch);
-  if (!status.ok()) {
-    HandleError(FROM_HERE, status);
+  PendingWrites writes;
+  if (!RemoveFileInfoHelper(file_id, &writes) ||
+      !AddFileInfoHelper(new_info, file_id, &writes))
     return false;
-  }
-  return true;
+  return ApplyWrites(writes);
 }
 
 bool FileSystemDirectoryDatabase::UpdateModificationTime(
@@ -328,16 +356,11 @@ bool FileSystemDirectoryDatabase::UpdateModificationTime(
   Pickle pickle;
   if (!PickleFromFileInfo(info, &pickle))
     return false;
-  leveldb::Status status = db_->Put(
-      leveldb::WriteOptions(),
-      GetFileLookupKey(file_id),
-      leveldb::Slice(reinterpret_cast<const char *>(pickle.data()),
-                     pickle.size()));
-  if (!status.ok()) {
-    HandleError(FROM_HERE, status);
-    return false;
-  }
-  return true;
+  PendingWrites writes;
+  writes.Put(GetFileLookupKey(file_id),
+             std::string(reinterpret_cast<const char *>(pickle.data()),
+                         pickle.size()));
+  return ApplyWrites(writes);
 }
 
 bool FileSystemDirectoryDatabase::OverwritingMoveFile(
@@ -351,25 +374,19 @@ bool FileSystemDirectoryDatabase::OverwritingMoveFile(
     return false;
   if (src_file_info.is_directory() || dest_file_info.is_directory())
     return false;
-  leveldb::WriteBatch batch;
+  PendingWrites writes;
   // This is the only field that really gets moved over; if you add fields to
   // FileInfo, e.g. ctime, they might need to be copied here.
   dest_file_info.data_path = src_file_info.data_path;
-  if (!RemoveFileInfoHelper(src_file_id, &batch))
+  if (!RemoveFileInfoHelper(src_file_id, &writes))
     return false;
   Pickle pickle;
   if (!PickleFromFileInfo(dest_file_info, &pickle))
     return false;
-  batch.Put(
-      GetFileLookupKey(dest_file_id),
-      leveldb::Slice(reinterpret_cast<const char *>(pickle.data()),
-                     pickle.size()));
-  leveldb::Status status = db_->Write(leveldb::WriteOptions(), &batch);
-  if (!status.ok()) {
-    HandleError(FROM_HERE, status);
-    return false;
-  }
-  return true;
+  writes.Put(GetFileLookupKey(dest_file_id),
+             std::string(reinterpret_cast<const char *>(pickle.data()),
+                         pickle.size()));
+  return ApplyWrites(writes);
 }
 
 bool FileSystemDirectoryDatabase::GetNextInteger(int64* next) {
@@ -377,8 +394,7 @@ bool FileSystemDirectoryDatabase::GetNextInteger(int64* next) {
     return false;
   DCHECK(next);
   std::string int_string;
-  leveldb::Status status =
-      db_->Get(leveldb::ReadOptions(), LastIntegerKey(), &int_string);
+  leveldb::Status status = ReadValue(LastIntegerKey(), &int_string);
   if (status.ok()) {
     int64 temp;
     if (!base::StringToInt64(int_string, &temp)) {
@@ -386,12 +402,10 @@ bool FileSystemDirectoryDatabase::GetNextInteger(int64* next) {
       return false;
     }
     ++temp;
-    status = db_->Put(leveldb::WriteOptions(), LastIntegerKey(),
-        base::Int64ToString(temp));
-    if (!status.ok()) {
-      HandleError(FROM_HERE, status);
+    PendingWrites writes;
+    writes.Put(LastIntegerKey(), base::Int64ToString(temp));
+    if (!ApplyWrites(writes))
       return false;
-    }
     *next = temp;
     return true;
   }
@@ -406,6 +420,28 @@ bool FileSystemDirectoryDatabase::GetNextInteger(int64* next) {
   return GetNextInteger(next);
 }
 
+void FileSystemDirectoryDatabase::BeginBatch() {
+  ++batch_depth_;
+}
+
+bool FileSystemDirectoryDatabase::CommitBatch() {
+  DCHECK_GT(batch_depth_, 0);
+  if (--batch_depth_)
+    return true;
+
+  PendingWrites writes;
+  writes.puts.swap(batch_writes_.puts);
+  writes.deletes.swap(batch_writes_.deletes);
+  if (writes.puts.empty() && writes.deletes.empty())
+    return true;
+  if (!Init()) {
+    // Lookups may have been cached from the lost writes.
+    child_id_cache_.clear();
+    return false;
+  }
+  return WriteToDatabase(writes);
+}
+
 // static
 bool FileSystemDirectoryDatabase::DestroyDatabase(const FilePath& path) {
   std::string name;
@@ -470,17 +506,14 @@ bool FileSystemDirectoryDatabase::StoreDefaultValues() {
   FileInfo root;
   root.parent_id = 0;
   root.modification_time = base::Time::Now();
-  leveldb::WriteBatch batch;
-  if (!AddFileInfoHelper(root, 0, &batch))
-    return false;
-  batch.Put(LastFileIdKey(), base::Int64ToString(0));
-  batch.Put(LastIntegerKey(), base::Int64ToString(-1));
-  leveldb::Status status = db_->Write(leveldb::WriteOptions(), &batch);
-  if (!status.ok()) {
-    HandleError(FROM_HERE, status);
-    return false;
-  }
-  return true;
+  PendingWrites writes;
+  if (!AddFileInfoHelper(root, 0, &writes))
+    return false;
+  writes.Put(LastFileIdKey(), base::Int64ToString(0));
+  writes.Put(LastIntegerKey(), base::Int64ToString(-1));
+  // Written even within a batch, as the check above reads the database
+  // directly.
+  return WriteToDatabase(writes);
 }
 
 bool FileSystemDirectoryDatabase::GetLastFileId(FileId* file_id) {
@@ -488,8 +521,7 @@ bool FileSystemDirectoryDatabase::GetLastFileId(FileId* file_id) {
     return false;
   DCHECK(file_id);
   std::string id_string;
-  leveldb::Status status =
-      db_->Get(leveldb::ReadOptions(), LastFileIdKey(), &id_string);
+  leveldb::Status status = ReadValue(LastFileIdKey(), &id_string);
   if (status.ok()) {
     if (!base::StringToInt64(id_string, file_id)) {
       LOG(ERROR) << "Hit database corruption!";
@@ -523,7 +555,7 @@ bool FileSystemDirectoryDatabase::VerifyIsDirectory(FileId file_id) {
 
 // This does very few safety checks!
 bool FileSystemDirectoryDatabase::AddFileInfoHelper(
-    const FileInfo& info, FileId file_id, leveldb::WriteBatch* batch) {
+    const FileInfo& info, FileId file_id, PendingWrites* writes) {
   std::string id_string = GetFileLookupKey(file_id);
   if (!file_id) {
     // The root directory doesn't need to be looked up by path from its parent.
@@ -531,21 +563,20 @@ bool FileSystemDirectoryDatabase::AddFileInfoHelper(
     DCHECK(info.data_path.empty());
   } else {
     std::string child_key = GetChildLookupKey(info.parent_id, info.name);
-    batch->Put(child_key, id_string);
+    writes->Put(child_key, id_string);
   }
   Pickle pickle;
   if (!PickleFromFileInfo(info, &pickle))
     return false;
-  batch->Put(
-      id_string,
-      leveldb::Slice(reinterpret_cast<const char *>(pickle.data()),
-                     pickle.size()));
+  writes->Put(id_string,
+              std::string(reinterpret_cast<const char *>(pickle.data()),
+                          pickle.size()));
   return true;
 }
 
 // This does very few safety checks!
 bool FileSystemDirectoryDatabase::RemoveFileInfoHelper(
-    FileId file_id, leveldb::WriteBatch* batch) {
+    FileId file_id, PendingWrites* writes) {
   DCHECK(file_id);  // You can't remove the root, ever.  Just delete the DB.
   FileInfo info;
   if (!GetFileInfo(file_id, &info))
@@ -560,8 +591,59 @@ bool FileSystemDirectoryDatabase::RemoveFileInfoHelper(
       return false;
     }
   }
-  batch->Delete(GetChildLookupKey(info.parent_id, info.name));
-  batch->Delete(GetFileLookupKey(file_id));
+  writes->Delete(GetChildLookupKey(info.parent_id, info.name));
+  writes->Delete(GetFileLookupKey(file_id));
+  return true;
+}
+
+leveldb::Status FileSystemDirectoryDatabase::ReadValue(
+    const std::string& key, std::string* value) {
+  std::map<std::string, std::string>::const_iterator found =
+      batch_writes_.puts.find(key);
+  if (found != batch_writes_.puts.end()) {
+    *value = found->second;
+    return leveldb::Status::OK();
+  }
+  if (batch_writes_.deletes.count(key))
+    return leveldb::Status::NotFound(key);
+  return db_->Get(leveldb::ReadOptions(), key, value);
+}
+
+bool FileSystemDirectoryDatabase::ApplyWrites(const PendingWrites& writes) {
+  std::map<std::string, std::string>::const_iterator put;
+  std::set<std::string>::const_iterator del;
+  for (put = writes.puts.begin(); put != writes.puts.end(); ++put)
+    child_id_cache_.erase(put->first);
+  for (del = writes.deletes.begin(); del != writes.deletes.end(); ++del)
+    child_id_cache_.erase(*del);
+
+  if (!batch_depth_)
+    return WriteToDatabase(writes);
+
+  for (put = writes.puts.begin(); put != writes.puts.end(); ++put)
+    batch_writes_.Put(put->first, put->second);
+  for (del = writes.deletes.begin(); del != writes.deletes.end(); ++del)
+    batch_writes_.Delete(*del);
+  return true;
+}
+
+bool FileSystemDirectoryDatabase::WriteToDatabase(
+    const PendingWrites& writes) {
+  leveldb::WriteBatch batch;
+  for (std::set<std::string>::const_iterator del = writes.deletes.begin();
+       del != writes.deletes.end(); ++del) {
+    batch.Delete(*del);
+  }
+  for (std::map<std::string, std::string>::const_iterator put =
+           writes.puts.begin();
+       put != writes.puts.end(); ++put) {
+    batch.Put(put->first, put->second);
+  }
+  leveldb::Status status = db_->Write(leveldb::WriteOptions(), &batch);
+  if (!status.ok()) {
+    HandleError(FROM_HERE, status);
+    return false;
+  }
   return true;
 }
 
@@ -571,6 +653,7 @@ void FileSystemDirectoryDatabase::HandleError(
   LOG(ERROR) << "FileSystemDirectoryDatabase failed at: "
              << from_here.ToString() << " with error: " << status.ToString();
   db_.reset();
+  child_id_cache_.clear();
 }
 
 }  // namespace fileapi
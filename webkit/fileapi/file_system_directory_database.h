@@ -5,10 +5,13 @@
 #ifndef WEBKIT_FILEAPI_FILE_SYSTEM_DIRECTORY_DATABASE_H_
 #define WEBKIT_FILEAPI_FILE_SYSTEM_DIRECTORY_DATABASE_H_
 
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "base/file_path.h"
+#include "base/hash_tables.h"
 #include "base/memory/scoped_ptr.h"
 #include "base/time.h"
 
@@ -19,7 +22,6 @@ class Location;
 namespace leveldb {
 class DB;
 class Status;
-class WriteBatch;
 }
 
 namespace fileapi {
@@ -85,23 +87,60 @@ class FileSystemDirectoryDatabase {
   // creation/destruction of FileSystemDirectoryDatabase objects.
   bool GetNextInteger(int64* next);
 
+  // While a batch is open, changes are kept in memory, where all of the
+  // methods above see them, and CommitBatch writes them in a single
+  // leveldb::WriteBatch.  This is for operations on many files at once, such
+  // as a recursive copy, which would otherwise do a write per file.  Batches
+  // nest; only the outermost CommitBatch writes.  If it fails, every change
+  // made in the batch is lost.
+  void BeginBatch();
+  bool CommitBatch();
+  bool in_batch() const { return batch_depth_ > 0; }
+
   static bool DestroyDatabase(const FilePath& path);
 
  private:
+  // The puts and deletes made by one operation.  A later put of a key
+  // replaces an earlier delete, and vice versa.
+  struct PendingWrites {
+    PendingWrites();
+    ~PendingWrites();
+
+    void Put(const std::string& key, const std::string& value);
+    void Delete(const std::string& key);
+
+    std::map<std::string, std::string> puts;
+    std::set<std::string> deletes;
+  };
+
   bool Init();
   void ReportInitStatus(const leveldb::Status& status);
   bool StoreDefaultValues();
   bool GetLastFileId(FileId* file_id);
   bool VerifyIsDirectory(FileId file_id);
   bool AddFileInfoHelper(
-      const FileInfo& info, FileId file_id, leveldb::WriteBatch* batch);
-  bool RemoveFileInfoHelper(FileId file_id, leveldb::WriteBatch* batch);
+      const FileInfo& info, FileId file_id, PendingWrites* writes);
+  bool RemoveFileInfoHelper(FileId file_id, PendingWrites* writes);
+  // Reads |key|, as changed by the open batch if there is one.
+  leveldb::Status ReadValue(const std::string& key, std::string* value);
+  // Adds |writes| to the open batch, or writes them if there isn't one.
+  bool ApplyWrites(const PendingWrites& writes);
+  bool WriteToDatabase(const PendingWrites& writes);
   void HandleError(const tracked_objects::Location& from_here,
                    const leveldb::Status& status);
 
   std::string path_;
   scoped_ptr<leveldb::DB> db_;
   base::Time last_reported_time_;
+
+  PendingWrites batch_writes_;
+  int batch_depth_;
+
+  // Child lookups, by lookup key, so that resolving a path doesn't read the
+  // database for every component.
+  typedef base::hash_map<std::string, FileId> ChildIdCache;
+  ChildIdCache child_id_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(FileSystemDirectoryDatabase);
 };
 
@@ -417,4 +417,71 @@ TEST_F(FileSystemDirectoryDatabaseTest, TestGetNextInteger) {
   EXPECT_EQ(4, next);
 }
 
+TEST_F(FileSystemDirectoryDatabaseTest, TestBatch) {
+  FileId dir_id;
+  FileInfo dir_info;
+  dir_info.parent_id = 0;
+  dir_info.name = FILE_PATH_LITERAL("dir");
+  EXPECT_TRUE(db()->AddFileInfo(dir_info, &dir_id));
+  EXPECT_TRUE(AddFileInfo(dir_id, FILE_PATH_LITERAL("committed")));
+
+  db()->BeginBatch();
+  EXPECT_TRUE(db()->in_batch());
+  EXPECT_TRUE(AddFileInfo(dir_id, FILE_PATH_LITERAL("a")));
+  EXPECT_TRUE(AddFileInfo(dir_id, FILE_PATH_LITERAL("b")));
+  EXPECT_FALSE(AddFileInfo(dir_id, FILE_PATH_LITERAL("a")));
+
+  // Batches nest.
+  db()->BeginBatch();
+  FileId committed_id;
+  EXPECT_TRUE(db()->GetChildWithName(
+      dir_id, FILE_PATH_LITERAL("committed"), &committed_id));
+  EXPECT_TRUE(db()->RemoveFileInfo(committed_id));
+  EXPECT_TRUE(db()->CommitBatch());
+  EXPECT_TRUE(db()->in_batch());
+
+  // Pending changes are visible within the batch.
+  std::vector<FileId> children;
+  EXPECT_TRUE(db()->ListChildren(dir_id, &children));
+  EXPECT_EQ(2UL, children.size());
+  EXPECT_FALSE(db()->GetChildWithName(
+      dir_id, FILE_PATH_LITERAL("committed"), &committed_id));
+  FileId b_id;
+  EXPECT_TRUE(db()->GetFileWithPath(
+      FilePath(FILE_PATH_LITERAL("dir")).Append(FILE_PATH_LITERAL("b")),
+      &b_id));
+
+  EXPECT_TRUE(db()->CommitBatch());
+  EXPECT_FALSE(db()->in_batch());
+
+  InitDatabase();
+  EXPECT_TRUE(db()->ListChildren(dir_id, &children));
+  EXPECT_EQ(2UL, children.size());
+  FileId check_id;
+  EXPECT_FALSE(db()->GetChildWithName(
+      dir_id, FILE_PATH_LITERAL("committed"), &check_id));
+  EXPECT_TRUE(db()->GetChildWithName(dir_id, FILE_PATH_LITERAL("b"),
+                                     &check_id));
+  EXPECT_EQ(b_id, check_id);
+
+  // New ids continue from the ones allocated in the batch.
+  FileId c_id;
+  FileInfo c_info;
+  c_info.parent_id = dir_id;
+  c_info.name = FILE_PATH_LITERAL("c");
+  EXPECT_TRUE(db()->AddFileInfo(c_info, &c_id));
+  EXPECT_GT(c_id, b_id);
+}
+
+TEST_F(FileSystemDirectoryDatabaseTest, TestUncommittedBatch) {
+  db()->BeginBatch();
+  EXPECT_TRUE(AddFileInfo(0, FILE_PATH_LITERAL("foo")));
+  FileId file_id;
+  EXPECT_TRUE(db()->GetChildWithName(0, FILE_PATH_LITERAL("foo"), &file_id));
+
+  // Nothing was written.
+  InitDatabase();
+  EXPECT_FALSE(db()->GetChildWithName(0, FILE_PATH_LITERAL("foo"), &file_id));
+}
+
 }  // namespace fileapi
@@ -222,4 +222,15 @@ PlatformFileError FileSystemFileUtil::DeleteSingleDirectory(
   return base::PLATFORM_FILE_ERROR_FAILED;
 }
 
+void FileSystemFileUtil::BeginBatchOperation(
+    FileSystemOperationContext* context,
+    const FileSystemPath& root_path) {
+}
+
+PlatformFileError FileSystemFileUtil::EndBatchOperation(
+    FileSystemOperationContext* context,
+    const FileSystemPath& root_path) {
+  return base::PLATFORM_FILE_OK;
+}
+
 }  // namespace fileapi
@@ -173,6 +173,17 @@ class FileSystemFileUtil {
       FileSystemOperationContext* context,
       const FileSystemPath& path);
 
+  // Bracket an operation on many entries under |root_path|, such as a
+  // recursive copy or delete.  In between, a subclass may hold back metadata
+  // writes and write them all at once in EndBatchOperation.  Calls may nest.
+  // The default implementations do nothing.
+  virtual void BeginBatchOperation(
+      FileSystemOperationContext* context,
+      const FileSystemPath& root_path);
+  virtual PlatformFileError EndBatchOperation(
+      FileSystemOperationContext* context,
+      const FileSystemPath& root_path);
+
  protected:
   FileSystemFileUtil();
   explicit FileSystemFileUtil(FileSystemFileUtil* underlying_file_util);
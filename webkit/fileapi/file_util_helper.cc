@@ -91,9 +91,24 @@ base::PlatformFileError CrossFileUtilHelper::DoWork() {
   base::PlatformFileError error = PerformErrorCheckAndPreparation();
   if (error != base::PLATFORM_FILE_OK)
     return error;
-  if (src_util_->DirectoryExists(context_, src_root_path_))
-    return CopyOrMoveDirectory(src_root_path_, dest_root_path_);
-  return CopyOrMoveFile(src_root_path_, dest_root_path_);
+  if (!src_util_->DirectoryExists(context_, src_root_path_))
+    return CopyOrMoveFile(src_root_path_, dest_root_path_);
+
+  // A directory is copied or moved one entry at a time; let the file utils
+  // write their metadata once for the whole tree.
+  src_util_->BeginBatchOperation(context_, src_root_path_);
+  if (!same_file_system_)
+    dest_util_->BeginBatchOperation(context_, dest_root_path_);
+  error = CopyOrMoveDirectory(src_root_path_, dest_root_path_);
+  PlatformFileError batch_error =
+      src_util_->EndBatchOperation(context_, src_root_path_);
+  if (!same_file_system_) {
+    PlatformFileError dest_batch_error =
+        dest_util_->EndBatchOperation(context_, dest_root_path_);
+    if (batch_error == base::PLATFORM_FILE_OK)
+      batch_error = dest_batch_error;
+  }
+  return error != base::PLATFORM_FILE_OK ? error : batch_error;
 }
 
 PlatformFileError CrossFileUtilHelper::PerformErrorCheckAndPreparation() {
@@ -267,8 +282,12 @@ base::PlatformFileError FileUtilHelper::Delete(
   if (file_util->DirectoryExists(context, path)) {
     if (!recursive)
       return file_util->DeleteSingleDirectory(context, path);
-    else
-      return DeleteDirectoryRecursive(context, file_util, path);
+    file_util->BeginBatchOperation(context, path);
+    PlatformFileError error =
+        DeleteDirectoryRecursive(context, file_util, path);
+    PlatformFileError batch_error =
+        file_util->EndBatchOperation(context, path);
+    return error != base::PLATFORM_FILE_OK ? error : batch_error;
   } else {
     return file_util->DeleteFile(context, path);
   }
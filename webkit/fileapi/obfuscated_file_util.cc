@@ -690,9 +690,7 @@ PlatformFileError ObfuscatedFileUtil::CopyOrMoveFile(
         return base::PLATFORM_FILE_ERROR_FAILED;
       FileSystemPath dest_local_path = DataPathToLocalPath(
           dest_path.origin(), dest_path.type(), dest_file_info.data_path);
-      if (base::PLATFORM_FILE_OK !=
-          underlying_file_util()->DeleteFile(context, dest_local_path))
-        LOG(WARNING) << "Leaked a backing file.";
+      DeleteBackingFile(context, db, dest_local_path);
       UpdatePathQuotaUsage(context, src_path.origin(), src_path.type(),
           -1, -static_cast<int64>(src_file_info.name.size()));
       TouchDirectory(db, src_file_info.parent_id);
@@ -799,9 +797,7 @@ PlatformFileError ObfuscatedFileUtil::DeleteFile(
       -1, -static_cast<int64>(file_info.name.size()));
   FileSystemPath local_path = DataPathToLocalPath(
       virtual_path.origin(), virtual_path.type(), file_info.data_path);
-  if (base::PLATFORM_FILE_OK !=
-      underlying_file_util()->DeleteFile(context, local_path))
-    LOG(WARNING) << "Leaked a backing file.";
+  DeleteBackingFile(context, db, local_path);
   TouchDirectory(db, file_info.parent_id);
   return base::PLATFORM_FILE_OK;
 }
@@ -830,6 +826,41 @@ PlatformFileError ObfuscatedFileUtil::DeleteSingleDirectory(
   return base::PLATFORM_FILE_OK;
 }
 
+void ObfuscatedFileUtil::BeginBatchOperation(
+    FileSystemOperationContext* context,
+    const FileSystemPath& root_path) {
+  FileSystemDirectoryDatabase* db = GetDirectoryDatabase(
+      root_path.origin(), root_path.type(), true);
+  if (db)
+    db->BeginBatch();
+}
+
+PlatformFileError ObfuscatedFileUtil::EndBatchOperation(
+    FileSystemOperationContext* context,
+    const FileSystemPath& root_path) {
+  FileSystemDirectoryDatabase* db = GetDirectoryDatabase(
+      root_path.origin(), root_path.type(), true);
+  if (!db || !db->in_batch())
+    return base::PLATFORM_FILE_ERROR_FAILED;
+  bool committed = db->CommitBatch();
+  if (db->in_batch())
+    return base::PLATFORM_FILE_OK;
+
+  BackingFileMap::iterator found = pending_backing_file_deletes_.find(db);
+  if (found != pending_backing_file_deletes_.end()) {
+    std::vector<FileSystemPath> local_paths;
+    local_paths.swap(found->second);
+    pending_backing_file_deletes_.erase(found);
+    // If the commit failed, the database may still refer to these files.
+    for (size_t i = 0; committed && i < local_paths.size(); ++i) {
+      if (base::PLATFORM_FILE_OK !=
+          underlying_file_util()->DeleteFile(context, local_paths[i]))
+        LOG(WARNING) << "Leaked a backing file.";
+    }
+  }
+  return committed ? base::PLATFORM_FILE_OK : base::PLATFORM_FILE_ERROR_FAILED;
+}
+
 FilePath ObfuscatedFileUtil::GetDirectoryForOriginAndType(
     const GURL& origin, FileSystemType type, bool create) {
   FilePath origin_dir = GetDirectoryForOrigin(origin, create);
@@ -983,6 +1014,7 @@ bool ObfuscatedFileUtil::DestroyDirectoryDatabase(
   if (iter != directories_.end()) {
     FileSystemDirectoryDatabase* database = iter->second;
     directories_.erase(iter);
+    pending_backing_file_deletes_.erase(database);
     delete database;
   }
 
@@ -1237,6 +1269,19 @@ FilePath ObfuscatedFileUtil::GetDirectoryForOrigin(
   return path;
 }
 
+void ObfuscatedFileUtil::DeleteBackingFile(
+    FileSystemOperationContext* context,
+    FileSystemDirectoryDatabase* db,
+    const FileSystemPath& local_path) {
+  if (db->in_batch()) {
+    pending_backing_file_deletes_[db].push_back(local_path);
+    return;
+  }
+  if (base::PLATFORM_FILE_OK !=
+      underlying_file_util()->DeleteFile(context, local_path))
+    LOG(WARNING) << "Leaked a backing file.";
+}
+
 void ObfuscatedFileUtil::MarkUsed() {
   if (timer_.IsRunning())
     timer_.Reset();
@@ -1250,6 +1295,7 @@ void ObfuscatedFileUtil::DropDatabases() {
   STLDeleteContainerPairSecondPointers(
       directories_.begin(), directories_.end());
   directories_.clear();
+  pending_backing_file_deletes_.clear();
 }
 
 bool ObfuscatedFileUtil::InitOriginDatabase(bool create) {
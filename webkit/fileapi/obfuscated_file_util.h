@@ -142,6 +142,16 @@ class ObfuscatedFileUtil : public FileSystemFileUtil,
       FileSystemOperationContext* context,
       const FileSystemPath& path) OVERRIDE;
 
+  // Batches the directory database writes of the origin and type of
+  // |root_path|.  Backing files of entries deleted in the batch are only
+  // deleted once it has been committed.
+  virtual void BeginBatchOperation(
+      FileSystemOperationContext* context,
+      const FileSystemPath& root_path) OVERRIDE;
+  virtual base::PlatformFileError EndBatchOperation(
+      FileSystemOperationContext* context,
+      const FileSystemPath& root_path) OVERRIDE;
+
   // Gets the topmost directory specific to this origin and type.  This will
   // contain both the directory database's files and all the backing file
   // subdirectories.
@@ -246,12 +256,21 @@ class ObfuscatedFileUtil : public FileSystemFileUtil,
   // contain both the filesystem type subdirectories.
   FilePath GetDirectoryForOrigin(const GURL& origin, bool create);
 
+  // Deletes the backing file at |local_path|, or, if |db| is in a batch,
+  // queues it to be deleted when the batch is committed.
+  void DeleteBackingFile(FileSystemOperationContext* context,
+                         FileSystemDirectoryDatabase* db,
+                         const FileSystemPath& local_path);
+
   void MarkUsed();
   void DropDatabases();
   bool InitOriginDatabase(bool create);
 
   typedef std::map<std::string, FileSystemDirectoryDatabase*> DirectoryMap;
   DirectoryMap directories_;
+  typedef std::map<FileSystemDirectoryDatabase*,
+                   std::vector<FileSystemPath> > BackingFileMap;
+  BackingFileMap pending_backing_file_deletes_;
   scoped_ptr<FileSystemOriginDatabase> origin_database_;
   FilePath file_system_directory_;
   base::OneShotTimer<ObfuscatedFileUtil> timer_;
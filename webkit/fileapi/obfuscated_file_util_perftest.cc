@@ -0,0 +1,122 @@
+// Copyright (c) 2012 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/ref_counted.h"
+#include "base/memory/scoped_ptr.h"
+#include "base/message_loop.h"
+#include "base/perftimer.h"
+#include "base/platform_file.h"
+#include "base/scoped_temp_dir.h"
+#include "base/stringprintf.h"
+#include "googleurl/src/gurl.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webkit/fileapi/file_system_operation_context.h"
+#include "webkit/fileapi/file_system_test_helper.h"
+#include "webkit/fileapi/file_util_helper.h"
+#include "webkit/fileapi/native_file_util.h"
+#include "webkit/fileapi/obfuscated_file_util.h"
+
+namespace fileapi {
+
+namespace {
+
+// 50K files, spread over directories of a typical size.
+const int kDirectoryCount = 50;
+const int kFilesPerDirectory = 1000;
+const int kFileCount = kDirectoryCount * kFilesPerDirectory;
+
+}  // namespace
+
+class ObfuscatedFileUtilPerfTest : public testing::Test {
+ protected:
+  ObfuscatedFileUtilPerfTest()
+      : helper_(GURL("http://www.example.com"), kFileSystemTypeTemporary) {
+  }
+
+  virtual void SetUp() OVERRIDE {
+    ASSERT_TRUE(base_dir_.CreateUniqueTempDir());
+    file_util_ = new ObfuscatedFileUtil(base_dir_.path(),
+                                        new NativeFileUtil());
+    helper_.SetUp(base_dir_.path(),
+                  false,  // unlimited quota
+                  NULL,  // quota::QuotaManagerProxy
+                  file_util_.get());
+  }
+
+  virtual void TearDown() OVERRIDE {
+    file_util_ = NULL;
+    helper_.TearDown();
+  }
+
+  FileSystemOperationContext* NewContext() {
+    FileSystemOperationContext* context = helper_.NewOperationContext();
+    // Paths are charged against quota.
+    context->set_allowed_bytes_growth(kint64max);
+    return context;
+  }
+
+  FileSystemPath Path(const std::string& path) {
+    return helper_.CreatePathFromUTF8(path);
+  }
+
+  MessageLoop message_loop_;
+  ScopedTempDir base_dir_;
+  scoped_refptr<ObfuscatedFileUtil> file_util_;
+  FileSystemTestOriginHelper helper_;
+};
+
+TEST_F(ObfuscatedFileUtilPerfTest, RecursiveCopyAndDelete) {
+  scoped_ptr<FileSystemOperationContext> context(NewContext());
+  FileSystemPath src_root = Path("src");
+  ASSERT_EQ(base::PLATFORM_FILE_OK,
+            file_util_->CreateDirectory(context.get(), src_root, true, false));
+
+  // One operation per file, as a page creating them would.
+  PerfTimer create_timer;
+  for (int dir = 0; dir < kDirectoryCount; ++dir) {
+    FileSystemPath dir_path = Path(base::StringPrintf("src/dir%d", dir));
+    context.reset(NewContext());
+    ASSERT_EQ(base::PLATFORM_FILE_OK,
+              file_util_->CreateDirectory(context.get(), dir_path,
+                                          true, false));
+    for (int file = 0; file < kFilesPerDirectory; ++file) {
+      bool created = false;
+      context.reset(NewContext());
+      ASSERT_EQ(base::PLATFORM_FILE_OK, file_util_->EnsureFileExists(
+          context.get(),
+          Path(base::StringPrintf("src/dir%d/file%d", dir, file)),
+          &created));
+      ASSERT_TRUE(created);
+    }
+  }
+  LogPerfResult("ObfuscatedFileUtil_CreateFile",
+                kFileCount / create_timer.Elapsed().InSecondsF(), "files/s");
+
+  FileSystemPath dest_root = Path("dest");
+  context.reset(NewContext());
+  PerfTimer copy_timer;
+  ASSERT_EQ(base::PLATFORM_FILE_OK, FileUtilHelper::Copy(
+      context.get(), file_util_.get(), file_util_.get(), src_root, dest_root));
+  LogPerfResult("ObfuscatedFileUtil_RecursiveCopy",
+                kFileCount / copy_timer.Elapsed().InSecondsF(), "files/s");
+
+  context.reset(NewContext());
+  EXPECT_TRUE(file_util_->PathExists(
+      context.get(),
+      Path(base::StringPrintf("dest/dir%d/file%d", kDirectoryCount - 1,
+                              kFilesPerDirectory - 1))));
+
+  context.reset(NewContext());
+  PerfTimer delete_timer;
+  ASSERT_EQ(base::PLATFORM_FILE_OK, FileUtilHelper::Delete(
+      context.get(), file_util_.get(), src_root, true /* recursive */));
+  LogPerfResult("ObfuscatedFileUtil_RecursiveDelete",
+                kFileCount / delete_timer.Elapsed().InSecondsF(), "files/s");
+
+  context.reset(NewContext());
+  EXPECT_FALSE(file_util_->PathExists(context.get(), src_root));
+  EXPECT_TRUE(file_util_->DirectoryExists(context.get(), dest_root));
+}
+
+}  // namespace fileapi
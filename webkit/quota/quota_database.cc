@@ -4,11 +4,14 @@
 
 #include "webkit/quota/quota_database.h"
 
+#include <string.h>
+
 #include <string>
 
 #include "base/auto_reset.h"
 #include "base/bind.h"
 #include "base/file_util.h"
+#include "base/stringprintf.h"
 #include "base/time.h"
 #include "googleurl/src/gurl.h"
 #include "sql/connection.h"
@@ -23,11 +26,12 @@ namespace {
 
 // Definitions for database schema.
 
-const int kCurrentVersion = 4;
+const int kCurrentVersion = 5;
 const int kCompatibleVersion = 2;
 
 const char kHostQuotaTable[] = "HostQuotaTable";
 const char kOriginInfoTable[] = "OriginInfoTable";
+const char kOriginUsageTable[] = "OriginUsageTable";
 const char kIsOriginTableBootstrapped[] = "IsOriginTableBootstrapped";
 
 class HistogramUniquifier {
@@ -47,6 +51,12 @@ bool VerifyValidQuotaConfig(const char* key) {
 
 const int kCommitIntervalMs = 30000;
 
+// Meta table key for whether the usage journal of a client has been set.
+std::string UsageJournalKey(StorageType type, int client_id) {
+  return base::StringPrintf("UsageJournal.%d.%d",
+                            static_cast<int>(type), client_id);
+}
+
 }  // anonymous namespace
 
 // static
@@ -67,6 +77,12 @@ const QuotaDatabase::TableSchema QuotaDatabase::kTables[] = {
     " last_access_time INTEGER DEFAULT 0,"
     " last_modified_time INTEGER DEFAULT 0,"
     " UNIQUE(origin, type))" },
+  { kOriginUsageTable,
+    "(origin TEXT NOT NULL,"
+    " type INTEGER NOT NULL,"
+    " client_id INTEGER NOT NULL,"
+    " usage INTEGER DEFAULT 0,"
+    " UNIQUE(origin, type, client_id))" },
 };
 
 // static
@@ -400,6 +416,121 @@ bool QuotaDatabase::SetOriginDatabaseBootstrapped(bool bootstrap_flag) {
   return meta_table_->SetValue(kIsOriginTableBootstrapped, bootstrap_flag);
 }
 
+bool QuotaDatabase::GetOriginUsageJournal(
+    StorageType type, int client_id, std::map<GURL, int64>* usage) {
+  DCHECK(usage);
+  if (!LazyOpen(false))
+    return false;
+
+  int flag = 0;
+  if (!meta_table_->GetValue(UsageJournalKey(type, client_id).c_str(),
+                             &flag) || !flag) {
+    return false;
+  }
+
+  const char* kSql = "SELECT origin, usage FROM OriginUsageTable"
+                     " WHERE type = ? AND client_id = ?";
+
+  sql::Statement statement(db_->GetCachedStatement(SQL_FROM_HERE, kSql));
+  statement.BindInt(0, static_cast<int>(type));
+  statement.BindInt(1, client_id);
+
+  usage->clear();
+  while (statement.Step())
+    (*usage)[GURL(statement.ColumnString(0))] = statement.ColumnInt64(1);
+
+  return statement.Succeeded();
+}
+
+bool QuotaDatabase::SetOriginUsageJournal(
+    StorageType type, int client_id, const std::map<GURL, int64>& usage) {
+  if (!LazyOpen(true))
+    return false;
+
+  const char* kDeleteSql = "DELETE FROM OriginUsageTable"
+                           " WHERE type = ? AND client_id = ?";
+  sql::Statement delete_statement(
+      db_->GetCachedStatement(SQL_FROM_HERE, kDeleteSql));
+  delete_statement.BindInt(0, static_cast<int>(type));
+  delete_statement.BindInt(1, client_id);
+  if (!delete_statement.Run())
+    return false;
+
+  typedef std::map<GURL, int64>::const_iterator itr_type;
+  for (itr_type itr = usage.begin(), end = usage.end(); itr != end; ++itr) {
+    const char* kSql =
+        "INSERT INTO OriginUsageTable"
+        " (usage, origin, type, client_id) VALUES (?, ?, ?, ?)";
+    sql::Statement statement(db_->GetCachedStatement(SQL_FROM_HERE, kSql));
+    statement.BindInt64(0, itr->second);
+    statement.BindString(1, itr->first.spec());
+    statement.BindInt(2, static_cast<int>(type));
+    statement.BindInt(3, client_id);
+
+    if (!statement.Run())
+      return false;
+  }
+
+  if (!meta_table_->SetValue(UsageJournalKey(type, client_id).c_str(), 1))
+    return false;
+
+  ScheduleCommit();
+  return true;
+}
+
+bool QuotaDatabase::AddOriginUsageDelta(
+    const GURL& origin, StorageType type, int client_id, int64 delta) {
+  if (!LazyOpen(true))
+    return false;
+
+  // An origin that isn't in the journal yet started out with no usage.
+  const char* kInsertSql =
+      "INSERT OR IGNORE INTO OriginUsageTable"
+      " (origin, type, client_id) VALUES (?, ?, ?)";
+  sql::Statement insert_statement(
+      db_->GetCachedStatement(SQL_FROM_HERE, kInsertSql));
+  insert_statement.BindString(0, origin.spec());
+  insert_statement.BindInt(1, static_cast<int>(type));
+  insert_statement.BindInt(2, client_id);
+  if (!insert_statement.Run())
+    return false;
+
+  const char* kSql =
+      "UPDATE OriginUsageTable"
+      " SET usage = MAX(usage + ?, 0)"
+      " WHERE origin = ? AND type = ? AND client_id = ?";
+  sql::Statement statement(db_->GetCachedStatement(SQL_FROM_HERE, kSql));
+  statement.BindInt64(0, delta);
+  statement.BindString(1, origin.spec());
+  statement.BindInt(2, static_cast<int>(type));
+  statement.BindInt(3, client_id);
+
+  if (!statement.Run())
+    return false;
+
+  ScheduleCommit();
+  return true;
+}
+
+bool QuotaDatabase::DeleteOriginUsage(const GURL& origin, StorageType type) {
+  if (!LazyOpen(false))
+    return false;
+
+  const char* kSql =
+      "DELETE FROM OriginUsageTable"
+      " WHERE origin = ? AND type = ?";
+
+  sql::Statement statement(db_->GetCachedStatement(SQL_FROM_HERE, kSql));
+  statement.BindString(0, origin.spec());
+  statement.BindInt(1, static_cast<int>(type));
+
+  if (!statement.Run())
+    return false;
+
+  ScheduleCommit();
+  return true;
+}
+
 void QuotaDatabase::Commit() {
   if (!db_.get())
     return;
@@ -599,6 +730,19 @@ bool QuotaDatabase::UpgradeSchema(int current_version) {
     Commit();
     return true;
   }
+  if (current_version == 4) {
+    // Version 5 adds the usage journal.
+    std::string sql("CREATE TABLE ");
+    sql += kOriginUsageTable;
+    for (size_t i = 0; i < ARRAYSIZE_UNSAFE(kTables); ++i) {
+      if (!strcmp(kTables[i].table_name, kOriginUsageTable))
+        sql += kTables[i].columns;
+    }
+    if (!db_->Execute(sql.c_str()))
+      return false;
+    meta_table_->SetVersionNumber(kCurrentVersion);
+    return true;
+  }
   return false;
 }
 
@@ -5,6 +5,7 @@
 #ifndef WEBKIT_QUOTA_QUOTA_DATABASE_H_
 #define WEBKIT_QUOTA_QUOTA_DATABASE_H_
 
+#include <map>
 #include <set>
 #include <string>
 
@@ -86,6 +87,23 @@ class QuotaDatabase {
   bool IsOriginDatabaseBootstrapped();
   bool SetOriginDatabaseBootstrapped(bool bootstrap_flag);
 
+  // The usage journal records the usage of each origin by each client,
+  // so that usage need not be gathered from the clients again after a
+  // restart.  It's replaced whenever usage has been gathered from a client,
+  // and updated by deltas as storage is modified in between.
+
+  // Populates |usage| with the journal of |client_id| for |type|.  Returns
+  // false if no journal has been set for them, in which case the journal
+  // may be missing origins.
+  bool GetOriginUsageJournal(StorageType type, int client_id,
+                             std::map<GURL, int64>* usage);
+  bool SetOriginUsageJournal(StorageType type, int client_id,
+                             const std::map<GURL, int64>& usage);
+  bool AddOriginUsageDelta(const GURL& origin, StorageType type,
+                           int client_id, int64 delta);
+  // Removes |origin| from the journals of all clients.
+  bool DeleteOriginUsage(const GURL& origin, StorageType type);
+
  private:
   struct QuotaTableEntry {
     QuotaTableEntry();
@@ -4,12 +4,14 @@
 
 #include <algorithm>
 #include <iterator>
+#include <map>
 #include <set>
 
 #include "base/bind.h"
 #include "base/callback.h"
 #include "base/file_util.h"
 #include "base/scoped_temp_dir.h"
+#include "base/stringprintf.h"
 #include "googleurl/src/gurl.h"
 #include "sql/connection.h"
 #include "sql/meta_table.h"
@@ -24,6 +26,8 @@ namespace {
 
 const base::Time kZeroTime;
 
+const int kJournalOriginCount = 10000;
+
 class TestErrorDelegate : public sql::ErrorDelegate {
  public:
   virtual ~TestErrorDelegate() { }
@@ -312,6 +316,77 @@ class QuotaDatabaseTest : public testing::Test {
     EXPECT_EQ(1, used_count);
   }
 
+  void OriginUsageJournal(const FilePath& kDbFile) {
+    QuotaDatabase db(kDbFile);
+    const int kClient1 = 1;
+    const int kClient2 = 2;
+    const GURL kOrigin1("http://a/");
+    const GURL kOrigin2("http://b/");
+
+    // Nothing is journaled until the journal has been set once.
+    std::map<GURL, int64> usage;
+    EXPECT_FALSE(db.GetOriginUsageJournal(
+        kStorageTypeTemporary, kClient1, &usage));
+    EXPECT_TRUE(db.AddOriginUsageDelta(
+        kOrigin1, kStorageTypeTemporary, kClient1, 10));
+    EXPECT_FALSE(db.GetOriginUsageJournal(
+        kStorageTypeTemporary, kClient1, &usage));
+
+    std::map<GURL, int64> journal;
+    for (int i = 0; i < kJournalOriginCount; ++i)
+      journal[GURL(base::StringPrintf("http://host%d/", i))] = i;
+    EXPECT_TRUE(db.SetOriginUsageJournal(
+        kStorageTypeTemporary, kClient1, journal));
+    EXPECT_TRUE(db.GetOriginUsageJournal(
+        kStorageTypeTemporary, kClient1, &usage));
+    EXPECT_TRUE(journal == usage);
+
+    // Journals are kept per client and per type.
+    EXPECT_FALSE(db.GetOriginUsageJournal(
+        kStorageTypeTemporary, kClient2, &usage));
+    EXPECT_FALSE(db.GetOriginUsageJournal(
+        kStorageTypePersistent, kClient1, &usage));
+
+    // Setting the journal replaces it.
+    journal.clear();
+    journal[kOrigin1] = 100;
+    EXPECT_TRUE(db.SetOriginUsageJournal(
+        kStorageTypeTemporary, kClient1, journal));
+    journal[kOrigin2] = 200;
+    EXPECT_TRUE(db.SetOriginUsageJournal(
+        kStorageTypeTemporary, kClient2, journal));
+    EXPECT_TRUE(db.GetOriginUsageJournal(
+        kStorageTypeTemporary, kClient1, &usage));
+    ASSERT_EQ(1U, usage.size());
+    EXPECT_EQ(100, usage[kOrigin1]);
+
+    // Deltas apply to existing and new origins, and never go below zero.
+    EXPECT_TRUE(db.AddOriginUsageDelta(
+        kOrigin1, kStorageTypeTemporary, kClient1, -30));
+    EXPECT_TRUE(db.AddOriginUsageDelta(
+        kOrigin2, kStorageTypeTemporary, kClient1, 5));
+    EXPECT_TRUE(db.AddOriginUsageDelta(
+        kOrigin2, kStorageTypeTemporary, kClient2, -500));
+    EXPECT_TRUE(db.GetOriginUsageJournal(
+        kStorageTypeTemporary, kClient1, &usage));
+    EXPECT_EQ(70, usage[kOrigin1]);
+    EXPECT_EQ(5, usage[kOrigin2]);
+    EXPECT_TRUE(db.GetOriginUsageJournal(
+        kStorageTypeTemporary, kClient2, &usage));
+    EXPECT_EQ(0, usage[kOrigin2]);
+
+    // Deleting an origin removes it from every client's journal.
+    EXPECT_TRUE(db.DeleteOriginUsage(kOrigin1, kStorageTypeTemporary));
+    EXPECT_TRUE(db.GetOriginUsageJournal(
+        kStorageTypeTemporary, kClient1, &usage));
+    EXPECT_EQ(1U, usage.size());
+    EXPECT_EQ(0U, usage.count(kOrigin1));
+    EXPECT_TRUE(db.GetOriginUsageJournal(
+        kStorageTypeTemporary, kClient2, &usage));
+    EXPECT_EQ(1U, usage.size());
+    EXPECT_EQ(0U, usage.count(kOrigin1));
+  }
+
   template <typename EntryType>
   struct EntryVerifier {
     std::set<EntryType> table;
@@ -548,6 +623,14 @@ TEST_F(QuotaDatabaseTest, RegisterInitialOriginInfo) {
   RegisterInitialOriginInfo(FilePath());
 }
 
+TEST_F(QuotaDatabaseTest, OriginUsageJournal) {
+  ScopedTempDir data_dir;
+  ASSERT_TRUE(data_dir.CreateUniqueTempDir());
+  const FilePath kDbFile = data_dir.path().AppendASCII("quota_manager.db");
+  OriginUsageJournal(kDbFile);
+  OriginUsageJournal(FilePath());
+}
+
 TEST_F(QuotaDatabaseTest, DumpQuotaTable) {
   ScopedTempDir data_dir;
   ASSERT_TRUE(data_dir.CreateUniqueTempDir());
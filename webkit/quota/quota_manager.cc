@@ -671,6 +671,10 @@ class QuotaManager::InitializeTask : public QuotaManager::DatabaseTaskBase {
       : DatabaseTaskBase(manager),
         temporary_quota_override_(-1),
         desired_available_space_(-1) {
+    for (QuotaClientList::const_iterator iter = manager->clients_.begin();
+         iter != manager->clients_.end(); ++iter) {
+      client_ids_.push_back((*iter)->id());
+    }
   }
 
  protected:
@@ -680,18 +684,47 @@ class QuotaManager::InitializeTask : public QuotaManager::DatabaseTaskBase {
                                     &temporary_quota_override_);
     database()->GetQuotaConfigValue(QuotaDatabase::kDesiredAvailableSpaceKey,
                                     &desired_available_space_);
+
+    // Read the usage journaled in the last session, so that the usage
+    // trackers need not ask the clients before answering.
+    const StorageType kTypes[] = {
+      kStorageTypeTemporary, kStorageTypePersistent
+    };
+    for (size_t i = 0; i < arraysize(kTypes); ++i) {
+      for (size_t j = 0; j < client_ids_.size(); ++j) {
+        journals_.push_back(UsageJournal(kTypes[i], client_ids_[j]));
+        if (!database()->GetOriginUsageJournal(
+                kTypes[i], client_ids_[j], &journals_.back().usage))
+          journals_.pop_back();
+      }
+    }
   }
 
   virtual void DatabaseTaskCompleted() OVERRIDE {
     manager()->temporary_quota_override_ = temporary_quota_override_;
     manager()->desired_available_space_ = desired_available_space_;
     manager()->temporary_quota_initialized_ = true;
+    for (std::list<UsageJournal>::const_iterator iter = journals_.begin();
+         iter != journals_.end(); ++iter) {
+      manager()->GetUsageTracker(iter->type)->SeedUsageCache(
+          iter->client_id, iter->usage);
+    }
     manager()->DidRunInitializeTask();
   }
 
  private:
+  struct UsageJournal {
+    UsageJournal(StorageType type, QuotaClient::ID client_id)
+        : type(type), client_id(client_id) {}
+    StorageType type;
+    QuotaClient::ID client_id;
+    std::map<GURL, int64> usage;
+  };
+
   int64 temporary_quota_override_;
   int64 desired_available_space_;
+  std::vector<QuotaClient::ID> client_ids_;
+  std::list<UsageJournal> journals_;
 };
 
 class QuotaManager::UpdateTemporaryQuotaOverrideTask
@@ -862,7 +895,8 @@ class QuotaManager::DeleteOriginInfo
 
  protected:
   virtual void RunOnTargetThread() OVERRIDE {
-    if (!database()->DeleteOriginInfo(origin_, type_)) {
+    if (!database()->DeleteOriginInfo(origin_, type_) ||
+        !database()->DeleteOriginUsage(origin_, type_)) {
       set_db_disabled(true);
     }
   }
@@ -971,12 +1005,16 @@ class QuotaManager::UpdateModifiedTimeTask
  public:
   UpdateModifiedTimeTask(
       QuotaManager* manager,
+      QuotaClient::ID client_id,
       const GURL& origin,
       StorageType type,
+      int64 delta,
       base::Time modified_time)
       : DatabaseTaskBase(manager),
+        client_id_(client_id),
         origin_(origin),
         type_(type),
+        delta_(delta),
         modified_time_(modified_time) {}
 
  protected:
@@ -984,16 +1022,49 @@ class QuotaManager::UpdateModifiedTimeTask
     if (!database()->SetOriginLastModifiedTime(
             origin_, type_, modified_time_)) {
       set_db_disabled(true);
+      return;
+    }
+    if (delta_ && !database()->AddOriginUsageDelta(
+            origin_, type_, client_id_, delta_)) {
+      set_db_disabled(true);
     }
   }
   virtual void DatabaseTaskCompleted() OVERRIDE {}
 
  private:
+  QuotaClient::ID client_id_;
   GURL origin_;
   StorageType type_;
+  int64 delta_;
   base::Time modified_time_;
 };
 
+class QuotaManager::UpdateUsageJournalTask
+    : public QuotaManager::DatabaseTaskBase {
+ public:
+  UpdateUsageJournalTask(
+      QuotaManager* manager,
+      StorageType type,
+      QuotaClient::ID client_id,
+      const std::map<GURL, int64>& usage)
+      : DatabaseTaskBase(manager),
+        type_(type),
+        client_id_(client_id),
+        usage_(usage) {}
+
+ protected:
+  virtual void RunOnTargetThread() OVERRIDE {
+    if (!database()->SetOriginUsageJournal(type_, client_id_, usage_))
+      set_db_disabled(true);
+  }
+  virtual void DatabaseTaskCompleted() OVERRIDE {}
+
+ private:
+  StorageType type_;
+  QuotaClient::ID client_id_;
+  std::map<GURL, int64> usage_;
+};
+
 class QuotaManager::GetModifiedSinceTask
     : public QuotaManager::DatabaseTaskBase {
  public:
@@ -1288,9 +1359,13 @@ void QuotaManager::LazyInitialize() {
   temporary_usage_tracker_.reset(
       new UsageTracker(clients_, kStorageTypeTemporary,
                        special_storage_policy_));
+  temporary_usage_tracker_->set_usage_journal_callback(
+      base::Bind(&QuotaManager::DidGatherUsage, weak_factory_.GetWeakPtr()));
   persistent_usage_tracker_.reset(
       new UsageTracker(clients_, kStorageTypePersistent,
                        special_storage_policy_));
+  persistent_usage_tracker_->set_usage_journal_callback(
+      base::Bind(&QuotaManager::DidGatherUsage, weak_factory_.GetWeakPtr()));
 
   make_scoped_refptr(new InitializeTask(this))->Start();
 }
@@ -1366,6 +1441,9 @@ bool QuotaManager::ResetUsageTracker(StorageType type) {
       temporary_usage_tracker_.reset(
           new UsageTracker(clients_, kStorageTypeTemporary,
                            special_storage_policy_));
+      temporary_usage_tracker_->set_usage_journal_callback(
+          base::Bind(&QuotaManager::DidGatherUsage,
+                     weak_factory_.GetWeakPtr()));
       return true;
     case kStorageTypePersistent:
       if (persistent_usage_tracker_->IsWorking())
@@ -1373,6 +1451,9 @@ bool QuotaManager::ResetUsageTracker(StorageType type) {
       persistent_usage_tracker_.reset(
           new UsageTracker(clients_, kStorageTypePersistent,
                            special_storage_policy_));
+      persistent_usage_tracker_->set_usage_journal_callback(
+          base::Bind(&QuotaManager::DidGatherUsage,
+                     weak_factory_.GetWeakPtr()));
       return true;
     default:
       NOTREACHED();
@@ -1436,7 +1517,16 @@ void QuotaManager::NotifyStorageModifiedInternal(
   LazyInitialize();
   GetUsageTracker(type)->UpdateUsageCache(client_id, origin, delta);
   make_scoped_refptr(new UpdateModifiedTimeTask(
-      this, origin, type, modified_time))->Start();
+      this, client_id, origin, type, delta, modified_time))->Start();
+}
+
+void QuotaManager::DidGatherUsage(StorageType type,
+                                  QuotaClient::ID client_id,
+                                  const std::map<GURL, int64>& usage) {
+  if (db_disabled_)
+    return;
+  make_scoped_refptr(new UpdateUsageJournalTask(
+      this, type, client_id, usage))->Start();
 }
 
 void QuotaManager::GetUsageAndQuotaInternal(
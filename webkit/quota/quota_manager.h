@@ -215,6 +215,7 @@ class QuotaManager : public QuotaTaskObserver,
   class InitializeTemporaryOriginsInfoTask;
   class UpdateAccessTimeTask;
   class UpdateModifiedTimeTask;
+  class UpdateUsageJournalTask;
   class GetModifiedSinceTask;
 
   class GetUsageInfoTask;
@@ -294,6 +295,11 @@ class QuotaManager : public QuotaTaskObserver,
       int64 delta,
       base::Time modified_time);
 
+  // Journals |usage| of |client_id|, as just gathered by a usage tracker.
+  void DidGatherUsage(StorageType type,
+                      QuotaClient::ID client_id,
+                      const std::map<GURL, int64>& usage);
+
   // |origin| can be empty if |global| is true.
   void GetUsageAndQuotaInternal(
       const GURL& origin,
@@ -14,6 +14,7 @@
 #include "base/message_loop_proxy.h"
 #include "base/scoped_temp_dir.h"
 #include "base/stl_util.h"
+#include "base/stringprintf.h"
 #include "base/sys_info.h"
 #include "base/time.h"
 #include "googleurl/src/gurl.h"
@@ -78,6 +79,20 @@ class QuotaManagerTest : public testing::Test {
     quota_manager_->proxy()->RegisterClient(client);
   }
 
+  // Replaces the quota manager with a new one for the same profile, as a
+  // browser restart would.  Clients have to be registered again.
+  void RestartQuotaManager() {
+    quota_manager_ = NULL;
+    MessageLoop::current()->RunAllPending();
+    quota_manager_ = new QuotaManager(
+        false /* is_incognito */,
+        data_dir_.path(),
+        MessageLoopProxy::current(),
+        MessageLoopProxy::current(),
+        mock_special_storage_policy_);
+    quota_manager_->eviction_disabled_ = true;
+  }
+
   void GetUsageInfo() {
     usage_info_.clear();
     quota_manager_->GetUsageInfo(
@@ -2033,4 +2048,62 @@ TEST_F(QuotaManagerTest, DeleteMultipleClientTypesSingleHost) {
   MessageLoop::current()->RunAllPending();
   EXPECT_EQ(predelete_foo_tmp - 8 - 4 - 2 - 1, usage());
 }
+
+TEST_F(QuotaManagerTest, UsageJournal) {
+  const int kOriginCount = 10000;
+  std::vector<std::string> origins;
+  std::vector<MockOriginData> data;
+  for (int i = 0; i < kOriginCount; ++i)
+    origins.push_back(base::StringPrintf("http://host%d/", i));
+  for (int i = 0; i < kOriginCount; ++i) {
+    MockOriginData entry = { origins[i].c_str(), kTemp, 10 };
+    data.push_back(entry);
+  }
+
+  // Gathering the usage from the client journals it, and later
+  // modifications are journaled as they're notified.
+  MockStorageClient* client = CreateClient(&data[0], data.size(),
+      QuotaClient::kFileSystem);
+  RegisterClient(client);
+  GetGlobalUsage(kTemp);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(10 * kOriginCount, usage());
+  client->ModifyOriginAndNotify(GURL(origins[0]), kTemp, 5);
+  MessageLoop::current()->RunAllPending();
+
+  // Behind the quota manager's back, host1 goes away and host2 grows.
+  data[0].usage = 15;
+  data[1].type = kPerm;
+  data[2].usage = 50;
+
+  RestartQuotaManager();
+  RegisterClient(CreateClient(&data[0], data.size(),
+      QuotaClient::kFileSystem));
+
+  // Usage is answered from the journal, without waiting for the client.
+  GetUsageAndQuota(GURL(origins[2]), kTemp);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(kQuotaStatusOk, status());
+  EXPECT_EQ(10, usage());
+
+  // By now the journal has been reconciled with the client.
+  GetHostUsage("host1", kTemp);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(0, usage());
+  GetHostUsage("host2", kTemp);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(50, usage());
+  GetGlobalUsage(kTemp);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(10 * kOriginCount + 5 - 10 + 40, usage());
+
+  // And the reconciled usage is what the next session starts from.
+  RestartQuotaManager();
+  RegisterClient(CreateClient(&data[0], data.size(),
+      QuotaClient::kFileSystem));
+  GetUsageAndQuota(GURL(origins[2]), kTemp);
+  MessageLoop::current()->RunAllPending();
+  EXPECT_EQ(50, usage());
+}
+
 }  // namespace quota
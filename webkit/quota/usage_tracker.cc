@@ -33,6 +33,7 @@ class ClientUsageTracker::GatherUsageTaskBase : public QuotaTask {
       : QuotaTask(tracker),
         client_(client),
         tracker_(tracker),
+        refresh_cached_origins_(false),
         weak_factory_(ALLOW_THIS_IN_INITIALIZER_LIST(this)) {
     DCHECK(tracker_);
     DCHECK(client_);
@@ -44,10 +45,12 @@ class ClientUsageTracker::GatherUsageTaskBase : public QuotaTask {
   // Get total usage for the given |origins|.
   void GetUsageForOrigins(const std::set<GURL>& origins, StorageType type) {
     DCHECK(original_message_loop()->BelongsToCurrentThread());
-    // We do not get usage for origins for which we have valid usage cache.
+    // We do not get usage for origins for which we have valid usage cache,
+    // unless the cache is being refreshed.
     std::vector<GURL> origins_to_gather;
     std::set<GURL> cached_origins;
-    client_tracker()->GetCachedOrigins(&cached_origins);
+    if (!refresh_cached_origins_)
+      client_tracker()->GetCachedOrigins(&cached_origins);
     std::set<GURL> already_added;
     for (std::set<GURL>::const_iterator iter = origins.begin();
          iter != origins.end(); ++iter) {
@@ -89,6 +92,10 @@ class ClientUsageTracker::GatherUsageTaskBase : public QuotaTask {
   UsageTracker* tracker() const { return tracker_; }
   ClientUsageTracker* client_tracker() const { return client_tracker_; }
 
+  void set_refresh_cached_origins(bool refresh_cached_origins) {
+    refresh_cached_origins_ = refresh_cached_origins;
+  }
+
  private:
   void DidGetUsage(int64 usage) {
     DCHECK(original_message_loop()->BelongsToCurrentThread());
@@ -122,6 +129,7 @@ class ClientUsageTracker::GatherUsageTaskBase : public QuotaTask {
   QuotaClient* client_;
   UsageTracker* tracker_;
   ClientUsageTracker* client_tracker_;
+  bool refresh_cached_origins_;
   std::deque<GURL> pending_origins_;
   std::map<GURL, int64> origin_usage_map_;
   base::WeakPtrFactory<GatherUsageTaskBase> weak_factory_;
@@ -130,18 +138,23 @@ class ClientUsageTracker::GatherUsageTaskBase : public QuotaTask {
 };
 
 // A task class for getting the total amount of data used for a given storage
-// type.  This class is self-destructed.
+// type.  If |reconcile| is true the usage of every origin is gathered again,
+// including the cached ones, to reconcile the cache with the client.
+// This class is self-destructed.
 class ClientUsageTracker::GatherGlobalUsageTask
     : public GatherUsageTaskBase {
  public:
   GatherGlobalUsageTask(
       UsageTracker* tracker,
-      QuotaClient* client)
+      QuotaClient* client,
+      bool reconcile)
       : GatherUsageTaskBase(tracker, client),
         client_(client),
+        reconcile_(reconcile),
         weak_factory_(ALLOW_THIS_IN_INITIALIZER_LIST(this)) {
     DCHECK(tracker);
     DCHECK(client);
+    set_refresh_cached_origins(reconcile);
   }
   virtual ~GatherGlobalUsageTask() {}
 
@@ -153,11 +166,15 @@ class ClientUsageTracker::GatherGlobalUsageTask
   }
 
   virtual void Completed() OVERRIDE {
-    client_tracker()->GatherGlobalUsageComplete();
+    if (reconcile_)
+      client_tracker()->ReconcileUsageComplete();
+    else
+      client_tracker()->GatherGlobalUsageComplete();
   }
 
  private:
   QuotaClient* client_;
+  bool reconcile_;
   base::WeakPtrFactory<GatherUsageTaskBase> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(GatherGlobalUsageTask);
@@ -294,6 +311,25 @@ void UsageTracker::GetCachedOrigins(std::set<GURL>* origins) const {
   }
 }
 
+bool UsageTracker::IsWorking() const {
+  if (global_usage_callbacks_.HasCallbacks() ||
+      host_usage_callbacks_.HasAnyCallbacks())
+    return true;
+  for (ClientTrackerMap::const_iterator iter = client_tracker_map_.begin();
+       iter != client_tracker_map_.end(); ++iter) {
+    if (iter->second->is_reconciling())
+      return true;
+  }
+  return false;
+}
+
+void UsageTracker::SeedUsageCache(QuotaClient::ID client_id,
+                                  const std::map<GURL, int64>& usage) {
+  ClientUsageTracker* client_tracker = GetClientTracker(client_id);
+  if (client_tracker)
+    client_tracker->SeedUsageCache(usage);
+}
+
 void UsageTracker::DidGetClientGlobalUsage(StorageType type,
                                            int64 usage,
                                            int64 unlimited_usage) {
@@ -335,6 +371,12 @@ void UsageTracker::DidGetClientHostUsage(const std::string& host,
   }
 }
 
+void UsageTracker::DidGatherClientUsage(QuotaClient::ID client_id,
+                                        const std::map<GURL, int64>& usage) {
+  if (!usage_journal_callback_.is_null())
+    usage_journal_callback_.Run(type_, client_id, usage);
+}
+
 // ClientUsageTracker ----------------------------------------------------
 
 ClientUsageTracker::ClientUsageTracker(
@@ -348,6 +390,7 @@ ClientUsageTracker::ClientUsageTracker(
       global_usage_retrieved_(false),
       global_unlimited_usage_is_valid_(true),
       global_usage_task_(NULL),
+      reconcile_task_(NULL),
       special_storage_policy_(special_storage_policy) {
   DCHECK(tracker_);
   DCHECK(client_);
@@ -367,7 +410,7 @@ void ClientUsageTracker::GetGlobalUsage(const GlobalUsageCallback& callback) {
   }
   DCHECK(!global_usage_callback_.HasCallbacks());
   global_usage_callback_.Add(callback);
-  global_usage_task_ = new GatherGlobalUsageTask(tracker_, client_);
+  global_usage_task_ = new GatherGlobalUsageTask(tracker_, client_, false);
   global_usage_task_->Start();
 }
 
@@ -390,6 +433,8 @@ void ClientUsageTracker::UpdateUsageCache(
     const GURL& origin, int64 delta) {
   std::string host = net::GetHostOrSpecFromURL(origin);
   if (cached_hosts_.find(host) != cached_hosts_.end()) {
+    // The origin is still there, whatever the reconcile task finds.
+    seeded_origins_.erase(origin);
     cached_usage_[host][origin] += delta;
     global_usage_ += delta;
     if (global_unlimited_usage_is_valid_ && IsStorageUnlimited(origin))
@@ -427,8 +472,31 @@ void ClientUsageTracker::GetCachedOrigins(std::set<GURL>* origins) const {
   }
 }
 
+void ClientUsageTracker::SeedUsageCache(const std::map<GURL, int64>& usage) {
+  if (global_usage_retrieved_ || global_usage_task_ || reconcile_task_)
+    return;
+
+  // Hosts gathered in this session already are more recent than the journal.
+  HostSet seeded_hosts;
+  for (UsageMap::const_iterator iter = usage.begin();
+       iter != usage.end(); ++iter) {
+    std::string host = net::GetHostOrSpecFromURL(iter->first);
+    if (cached_hosts_.find(host) != cached_hosts_.end())
+      continue;
+    AddCachedOrigin(iter->first, iter->second);
+    seeded_origins_.insert(iter->first);
+    seeded_hosts.insert(host);
+  }
+  cached_hosts_.insert(seeded_hosts.begin(), seeded_hosts.end());
+  global_usage_retrieved_ = true;
+
+  reconcile_task_ = new GatherGlobalUsageTask(tracker_, client_, true);
+  reconcile_task_->Start();
+}
+
 void ClientUsageTracker::AddCachedOrigin(
     const GURL& origin, int64 usage) {
+  seeded_origins_.erase(origin);
   std::string host = net::GetHostOrSpecFromURL(origin);
   UsageMap::iterator iter = cached_usage_[host].
       insert(UsageMap::value_type(origin, 0)).first;
@@ -463,6 +531,50 @@ void ClientUsageTracker::GatherGlobalUsageComplete() {
     iter->second.Run(iter->first, type_, GetCachedHostUsage(iter->first));
   }
   host_usage_callbacks_.Clear();
+
+  ReportCachedUsage();
+}
+
+void ClientUsageTracker::ReconcileUsageComplete() {
+  DCHECK(reconcile_task_ != NULL);
+  reconcile_task_ = NULL;
+
+  // The client no longer has the seeded origins it didn't report.
+  for (std::set<GURL>::const_iterator iter = seeded_origins_.begin();
+       iter != seeded_origins_.end(); ++iter) {
+    RemoveCachedOrigin(*iter);
+  }
+  seeded_origins_.clear();
+
+  ReportCachedUsage();
+}
+
+void ClientUsageTracker::RemoveCachedOrigin(const GURL& origin) {
+  HostUsageMap::iterator host_iter =
+      cached_usage_.find(net::GetHostOrSpecFromURL(origin));
+  if (host_iter == cached_usage_.end())
+    return;
+  UsageMap::iterator found = host_iter->second.find(origin);
+  if (found == host_iter->second.end())
+    return;
+
+  global_usage_ -= found->second;
+  if (global_unlimited_usage_is_valid_ && IsStorageUnlimited(origin))
+    global_unlimited_usage_ -= found->second;
+  DCHECK_GE(global_usage_, 0);
+
+  host_iter->second.erase(found);
+  if (host_iter->second.empty())
+    cached_usage_.erase(host_iter);
+}
+
+void ClientUsageTracker::ReportCachedUsage() {
+  UsageMap usage;
+  for (HostUsageMap::const_iterator host_iter = cached_usage_.begin();
+       host_iter != cached_usage_.end(); host_iter++) {
+    usage.insert(host_iter->second.begin(), host_iter->second.end());
+  }
+  tracker_->DidGatherClientUsage(client_->id(), usage);
 }
 
 void ClientUsageTracker::GatherHostUsageComplete(const std::string& host) {
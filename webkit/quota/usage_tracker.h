@@ -30,6 +30,13 @@ class ClientUsageTracker;
 // An instance of this class is created per storage type.
 class UsageTracker : public QuotaTaskObserver {
  public:
+  // Called with every origin's usage whenever a client's usage has been
+  // gathered from the client itself, so that it can be journaled.
+  typedef base::Callback<void(StorageType type,
+                              QuotaClient::ID client_id,
+                              const std::map<GURL, int64>& usage)>
+      UsageJournalCallback;
+
   UsageTracker(const QuotaClientList& clients, StorageType type,
                SpecialStoragePolicy* special_storage_policy);
   virtual ~UsageTracker();
@@ -44,9 +51,15 @@ class UsageTracker : public QuotaTaskObserver {
                         int64 delta);
   void GetCachedHostsUsage(std::map<std::string, int64>* host_usage) const;
   void GetCachedOrigins(std::set<GURL>* origins) const;
-  bool IsWorking() const {
-    return global_usage_callbacks_.HasCallbacks() ||
-           host_usage_callbacks_.HasAnyCallbacks();
+  bool IsWorking() const;
+
+  // Populates the usage cache of |client_id| from a journal written in
+  // an earlier session, see ClientUsageTracker::SeedUsageCache.
+  void SeedUsageCache(QuotaClient::ID client_id,
+                      const std::map<GURL, int64>& usage);
+
+  void set_usage_journal_callback(const UsageJournalCallback& callback) {
+    usage_journal_callback_ = callback;
   }
 
  private:
@@ -65,6 +78,8 @@ class UsageTracker : public QuotaTaskObserver {
   void DidGetClientHostUsage(const std::string& host,
                              StorageType type,
                              int64 usage);
+  void DidGatherClientUsage(QuotaClient::ID client_id,
+                            const std::map<GURL, int64>& usage);
 
   const StorageType type_;
   ClientTrackerMap client_tracker_map_;
@@ -74,6 +89,8 @@ class UsageTracker : public QuotaTaskObserver {
   GlobalUsageCallbackQueue global_usage_callbacks_;
   HostUsageCallbackMap host_usage_callbacks_;
 
+  UsageJournalCallback usage_journal_callback_;
+
   base::WeakPtrFactory<UsageTracker> weak_factory_;
   DISALLOW_COPY_AND_ASSIGN(UsageTracker);
 };
@@ -95,6 +112,15 @@ class ClientUsageTracker : public SpecialStoragePolicy::Observer,
   void GetCachedHostsUsage(std::map<std::string, int64>* host_usage) const;
   void GetCachedOrigins(std::set<GURL>* origins) const;
 
+  // Populates the cache with |usage|, as journaled in an earlier session, so
+  // that usage queries are answered without asking the client.  The journal
+  // is then reconciled with the client in the background: origins are
+  // gathered from the client again and the ones it no longer has are
+  // dropped.  Does nothing if the client's global usage has already been
+  // gathered, or is being gathered, since that is more recent.
+  void SeedUsageCache(const std::map<GURL, int64>& usage);
+  bool is_reconciling() const { return reconcile_task_ != NULL; }
+
  private:
   typedef std::set<std::string> HostSet;
   typedef std::map<GURL, int64> UsageMap;
@@ -110,6 +136,10 @@ class ClientUsageTracker : public SpecialStoragePolicy::Observer,
   void AddCachedHost(const std::string& host);
   void GatherGlobalUsageComplete();
   void GatherHostUsageComplete(const std::string& host);
+  void ReconcileUsageComplete();
+
+  void RemoveCachedOrigin(const GURL& origin);
+  void ReportCachedUsage();
 
   int64 GetCachedHostUsage(const std::string& host) const;
   int64 GetCachedGlobalUnlimitedUsage();
@@ -130,6 +160,12 @@ class ClientUsageTracker : public SpecialStoragePolicy::Observer,
   HostUsageMap cached_usage_;
 
   GatherGlobalUsageTask* global_usage_task_;
+  GatherGlobalUsageTask* reconcile_task_;
+
+  // Origins whose cached usage came from the journal and has been neither
+  // confirmed by the reconcile task nor modified since.
+  std::set<GURL> seeded_origins_;
+
   GlobalUsageCallbackQueue global_usage_callback_;
   std::map<std::string, GatherHostUsageTask*> host_usage_tasks_;
   HostUsageCallbackMap host_usage_callbacks_;